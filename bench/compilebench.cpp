@@ -0,0 +1,98 @@
+/*
+ *  compilebench.cpp
+ *  See Copyright Notice in Pika.h
+ *
+ *  Measures how long the compiler takes to compile a single function as the number of statements
+ *  in its body grows. The time per statement should stay flat; if it grows with the size of the
+ *  function some part of the compiler is quadratic.
+ *
+ *  Functions whose bytecode is larger than PIKA_MAX_BYTECODE words are rejected with a syntax error
+ *  once their code has been generated, so the largest sizes still measure the parser and the code
+ *  generator.
+ *
+ *  usage: compilebench [max statements]
+ */
+#include "Pika.h"
+#include "PPlatform.h"
+using namespace pika;
+
+namespace {
+
+const char* const STATEMENT = "    a = a + b\n";
+
+/* Returns the source of a function with the given number of statements. The result must be
+ * freed with Pika_free. */
+char* MakeFunction(size_t statements, size_t& len)
+{
+    const char* head = "function f()\n    local a, b = 0, 1\n";
+    const char* tail = "end\n";
+    size_t headLen = strlen(head);
+    size_t tailLen = strlen(tail);
+    size_t stmtLen = strlen(STATEMENT);
+
+    len = headLen + statements * stmtLen + tailLen;
+    char* src = (char*)Pika_malloc(len);
+    char* curr = src;
+
+    memcpy(curr, head, headLen);
+    curr += headLen;
+    for (size_t i = 0; i < statements; ++i)
+    {
+        memcpy(curr, STATEMENT, stmtLen);
+        curr += stmtLen;
+    }
+    memcpy(curr, tail, tailLen);
+    return src;
+}
+
+/* Compiles the function and returns the time it took in seconds. fits is set to false if the
+ * function was too large to compile. */
+double Compile(Engine* eng, const char* src, size_t len, bool& fits)
+{
+    fits = true;
+    u8 start = Pika_Microseconds();
+    try
+    {
+        eng->CompileString(src, len);
+    }
+    catch (Exception&)
+    {
+        fits = false;
+    }
+    return (double)(Pika_Microseconds() - start) / 1e6;
+}
+
+}// namespace
+
+int main(int argc, char* argv[])
+{
+    size_t maxStatements = argc > 1 ? (size_t)strtoul(argv[1], 0, 0) : 100000;
+    Engine* eng = Engine::Create();
+
+    printf("%12s %12s %14s  %s\n", "statements", "seconds", "us/statement", "bytecode");
+    for (size_t statements = 3125; statements <= maxStatements; statements *= 2)
+    {
+        size_t len  = 0;
+        char*  src  = MakeFunction(statements, len);
+        double best = 0;
+        bool   fits = true;
+
+        // Take the best of three runs.
+        for (int run = 0; run < 3; ++run)
+        {
+            double secs = Compile(eng, src, len, fits);
+            best = run ? Min(best, secs) : secs;
+        }
+        printf("%12u %12.3f %14.2f  %s\n", (unsigned)statements, best, best * 1e6 / statements,
+               fits ? "ok" : "too large");
+        fflush(stdout);
+        Pika_free(src);
+
+        if (statements < maxStatements && statements * 2 > maxStatements)
+        {
+            statements = maxStatements / 2;
+        }
+    }
+    eng->Release();
+    return 0;
+}
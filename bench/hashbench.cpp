@@ -0,0 +1,264 @@
+/*
+ *  hashbench.cpp
+ *  See Copyright Notice in Pika.h
+ *
+ *  Measures the throughput and quality of Pika_StringHash across key lengths. The byte at a
+ *  time djb2 hash that Pika used before is measured alongside it for comparison.
+ *
+ *  usage: hashbench [seed]
+ */
+#include "Pika.h"
+#include "PPlatform.h"
+#include <cmath>
+#include <algorithm>
+using namespace pika;
+
+namespace {
+
+size_t Djb2Hash(const char* str, size_t len, u8)
+{
+    size_t hash = 5381;
+    for (const char* end = str + len; str < end; ++str)
+        hash = ((hash << 5) + hash) + *str;
+    return hash;
+}
+
+size_t SeededHash(const char* str, size_t len, u8 seed)
+{
+    return Pika_StringHash(str, len, seed);
+}
+
+typedef size_t (*HashFn)(const char*, size_t, u8);
+
+struct HashInfo
+{
+    const char* name;
+    HashFn      fn;
+};
+
+const HashInfo hashes[] = {
+    { "wyhash", SeededHash },
+    { "djb2",   Djb2Hash   },
+};
+const size_t NUM_HASHES = sizeof(hashes) / sizeof(hashes[0]);
+
+u8 rngState = 0x853C49E6748FEA9BULL;
+
+u8 NextRandom()
+{
+    // splitmix64
+    u8 z = (rngState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void FillRandom(char* buff, size_t len)
+{
+    for (size_t i = 0; i < len; ++i)
+        buff[i] = (char)NextRandom();
+}
+
+// Throughput //////////////////////////////////////////////////////////////////////////////////////
+
+void Throughput(u8 seed)
+{
+    static const size_t lengths[] = { 1, 3, 4, 8, 12, 16, 24, 32, 48, 64, 128, 256, 1024, 4096, 65536, 1 << 20 };
+    static const size_t NUM_LENGTHS = sizeof(lengths) / sizeof(lengths[0]);
+    static const size_t BYTES_PER_RUN = 256 << 20;
+    static const size_t MIN_CALLS = 1 << 22;
+
+    size_t buffLen = lengths[NUM_LENGTHS - 1] + 64;
+    char*  buff    = (char*)Pika_malloc(buffLen);
+    FillRandom(buff, buffLen);
+
+    printf("throughput\n%10s", "length");
+    for (size_t h = 0; h < NUM_HASHES; ++h)
+        printf("  %8s ns %9s MB/s", hashes[h].name, "");
+    printf("\n");
+
+    size_t sink = 0;
+    for (size_t l = 0; l < NUM_LENGTHS; ++l)
+    {
+        size_t len   = lengths[l];
+        size_t calls = Max<size_t>(BYTES_PER_RUN / len, MIN_CALLS);
+        if (len >= 65536) calls = BYTES_PER_RUN / len;
+
+        printf("%10u", (unsigned)len);
+        for (size_t h = 0; h < NUM_HASHES; ++h)
+        {
+            HashFn fn = hashes[h].fn;
+            u8 start = Pika_Microseconds();
+            for (size_t i = 0; i < calls; ++i)
+            {
+                // Vary the offset so the calls cannot be hoisted out of the loop.
+                sink += fn(buff + (i & 63), len, seed);
+            }
+            double secs = (double)(Pika_Microseconds() - start) / 1e6;
+            printf("  %11.2f %14.1f", secs * 1e9 / calls, (double)len * calls / secs / (1 << 20));
+        }
+        printf("\n");
+    }
+    printf("(checksum %u)\n\n", (unsigned)sink);
+    Pika_free(buff);
+}
+
+// Avalanche ///////////////////////////////////////////////////////////////////////////////////////
+
+/* Flips every input bit of random keys and reports the largest deviation from 50% in the chance
+ * that an output bit flips with it. A good hash stays close to 0. */
+void Avalanche(u8 seed)
+{
+    static const size_t lengths[] = { 3, 4, 8, 16, 32, 64, 256 };
+    static const size_t NUM_LENGTHS = sizeof(lengths) / sizeof(lengths[0]);
+    static const size_t KEYS = 2000;
+    static const size_t OUT_BITS = sizeof(size_t) * 8;
+
+    printf("avalanche (worst output bit bias over %u keys, 0.0 is ideal)\n%10s", (unsigned)KEYS, "length");
+    for (size_t h = 0; h < NUM_HASHES; ++h)
+        printf("  %10s", hashes[h].name);
+    printf("\n");
+
+    for (size_t l = 0; l < NUM_LENGTHS; ++l)
+    {
+        size_t len = lengths[l];
+        size_t inBits = len * 8;
+        u4* flips = (u4*)Pika_malloc(inBits * OUT_BITS * sizeof(u4));
+        char key[256];
+
+        printf("%10u", (unsigned)len);
+        for (size_t h = 0; h < NUM_HASHES; ++h)
+        {
+            HashFn fn = hashes[h].fn;
+            memset(flips, 0, inBits * OUT_BITS * sizeof(u4));
+
+            for (size_t k = 0; k < KEYS; ++k)
+            {
+                FillRandom(key, len);
+                size_t base = fn(key, len, seed);
+                for (size_t b = 0; b < inBits; ++b)
+                {
+                    key[b >> 3] ^= (char)(1 << (b & 7));
+                    size_t diff = base ^ fn(key, len, seed);
+                    key[b >> 3] ^= (char)(1 << (b & 7));
+                    for (size_t o = 0; o < OUT_BITS; ++o)
+                        flips[b * OUT_BITS + o] += (u4)((diff >> o) & 1);
+                }
+            }
+
+            double worst = 0;
+            for (size_t i = 0; i < inBits * OUT_BITS; ++i)
+                worst = Max<double>(worst, fabs((double)flips[i] / KEYS - 0.5));
+            printf("  %10.3f", worst);
+        }
+        printf("\n");
+        Pika_free(flips);
+    }
+    printf("\n");
+}
+
+// Distribution ////////////////////////////////////////////////////////////////////////////////////
+
+enum KeySet
+{
+    KS_names,    // "key0", "key1", ...
+    KS_numbers,  // decimal integers
+    KS_random,   // 8 random bytes
+    KS_flood,    // strings built from "ab" and "bA", which all collide under djb2
+    KS_max
+};
+
+const char* keySetNames[KS_max] = { "key%d", "numbers", "random8", "djb2 flood" };
+
+size_t MakeKey(KeySet ks, size_t i, char* key)
+{
+    switch (ks)
+    {
+    case KS_names:   return (size_t)sprintf(key, "key%u", (unsigned)i);
+    case KS_numbers: return (size_t)sprintf(key, "%u", (unsigned)(i * 7919));
+    case KS_random:  FillRandom(key, 8); return 8;
+    case KS_flood:
+        for (size_t b = 0; b < 20; ++b)
+        {
+            key[b * 2]     = (i >> b) & 1 ? 'b' : 'a';
+            key[b * 2 + 1] = (i >> b) & 1 ? 'A' : 'b';
+        }
+        return 40;
+    default:
+        return 0;
+    }
+}
+
+/* Hashes KEYS keys into 2^16 buckets using both the low and the high bits of the hash and
+ * reports the chi-squared statistic divided by its expected value (1.0 is ideal), and how many
+ * keys share a full hash code with an earlier key. */
+void Distribution(u8 seed)
+{
+    static const size_t KEYS = 1 << 20;
+    static const size_t BUCKET_BITS = 16;
+    static const size_t BUCKETS = 1 << BUCKET_BITS;
+
+    size_t* codes   = (size_t*)Pika_malloc(KEYS * sizeof(size_t));
+    u4*     buckets = (u4*)Pika_malloc(BUCKETS * sizeof(u4));
+    char    key[64];
+
+    printf("distribution (%u keys, %u buckets, chi^2 / expected: 1.0 is ideal)\n%12s",
+           (unsigned)KEYS, (unsigned)BUCKETS, "keys");
+    for (size_t h = 0; h < NUM_HASHES; ++h)
+        printf("  %8s low %8s high %8s same", hashes[h].name, "", "");
+    printf("\n");
+
+    for (int ks = 0; ks < KS_max; ++ks)
+    {
+        printf("%12s", keySetNames[ks]);
+        for (size_t h = 0; h < NUM_HASHES; ++h)
+        {
+            rngState = 0x853C49E6748FEA9BULL;
+            for (size_t i = 0; i < KEYS; ++i)
+            {
+                size_t len = MakeKey((KeySet)ks, i, key);
+                codes[i] = hashes[h].fn(key, len, seed);
+            }
+
+            double chi[2];
+            for (int side = 0; side < 2; ++side)
+            {
+                memset(buckets, 0, BUCKETS * sizeof(u4));
+                for (size_t i = 0; i < KEYS; ++i)
+                {
+                    size_t b = side ? codes[i] >> (sizeof(size_t) * 8 - BUCKET_BITS) : codes[i] & (BUCKETS - 1);
+                    ++buckets[b];
+                }
+                double expected = (double)KEYS / BUCKETS;
+                double sum = 0;
+                for (size_t b = 0; b < BUCKETS; ++b)
+                    sum += (buckets[b] - expected) * (buckets[b] - expected) / expected;
+                chi[side] = sum / (BUCKETS - 1);
+            }
+
+            std::sort(codes, codes + KEYS);
+            size_t same = 0;
+            for (size_t i = 1; i < KEYS; ++i)
+                same += codes[i] == codes[i - 1];
+
+            printf("  %12.2f %13.2f %13u", chi[0], chi[1], (unsigned)same);
+        }
+        printf("\n");
+    }
+    printf("\n");
+    Pika_free(buckets);
+    Pika_free(codes);
+}
+
+}// namespace
+
+int main(int argc, char* argv[])
+{
+    u8 seed = argc > 1 ? (u8)strtoul(argv[1], 0, 0) : Pika_RandomSeed();
+    printf("seed 0x%08x%08x\n\n", (unsigned)(seed >> 32), (unsigned)seed);
+
+    Throughput(seed);
+    Avalanche(seed);
+    Distribution(seed);
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ *  importbench.cpp
+ *  See Copyright Notice in Pika.h
+ *
+ *  Measures how long a large package takes to import with and without its compiled script. The
+ *  package is written to the working directory and imported in a new Engine each time, the way a
+ *  program starting up would import it. A cold import compiles the source and writes the compiled
+ *  script, a warm import reads the compiled script back. A warm import should take a small
+ *  fraction of the time of a cold one; if it does not the code cache is not doing its job.
+ *
+ *  usage: importbench [classes]
+ */
+#include "Pika.h"
+#include "PPlatform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace pika;
+
+namespace {
+
+const char* PACKAGE_PATH  = "importbench_package" PIKA_EXT;
+const char* COMPILED_PATH = "importbench_package" PIKA_COMPILED_EXT;
+
+/* Writes a package with the given number of classes, each with a few methods. Returns the size
+ * of the source in bytes or 0 if it could not be written. */
+size_t WritePackage(size_t classes)
+{
+    FILE* file = fopen(PACKAGE_PATH, "wb");
+    if (!file)
+        return 0;
+
+    for (size_t i = 0; i < classes; ++i)
+    {
+        fprintf(file,
+                "class Shape%u\n"
+                "    function init(x, y)\n"
+                "        self.x = x\n"
+                "        self.y = y\n"
+                "        self.name = 'shape %u'\n"
+                "    end\n"
+                "    \n"
+                "    function area()\n"
+                "        return self.x * self.y + %u\n"
+                "    end\n"
+                "    \n"
+                "    function describe(prefix = '')\n"
+                "        parts = [ prefix, self.name, self.area() ]\n"
+                "        for i = 0 to self.x\n"
+                "            if i mod 2 == 0 then parts.push(i) else parts.push(-i) end\n"
+                "        end\n"
+                "        return parts\n"
+                "    end\n"
+                "end\n"
+                "\n"
+                "function make%u(n)\n"
+                "    return [ Shape%u.new(i, i + %u) for i = 0 to n ]\n"
+                "end\n"
+                "\n",
+                (unsigned)i, (unsigned)i, (unsigned)i, (unsigned)i, (unsigned)i, (unsigned)i);
+    }
+    fprintf(file, "global loaded = true\n");
+
+    long size = ftell(file);
+    if (fclose(file) != 0 || size <= 0)
+        return 0;
+    return (size_t)size;
+}
+
+/* Imports the package in a new Engine and returns the time it took in seconds, or a negative
+ * number if it failed. */
+double Import()
+{
+    u8      start = Pika_Microseconds();
+    Engine* eng   = Engine::Create();
+    bool    ok    = false;
+    try
+    {
+        Script* script = eng->Compile(PACKAGE_PATH);
+        Value   res(NULL_VALUE);
+        ok = script && script->Run(0) && script->GetGlobal(eng->AllocString("loaded"), res);
+    }
+    catch (Exception&)
+    {
+    }
+    eng->Release();
+    return ok ? (double)(Pika_Microseconds() - start) / 1e6 : -1;
+}
+
+/* Returns the best of three imports, removing the compiled script before each one if cold. */
+double BestImport(bool cold)
+{
+    double best = 0;
+    for (int run = 0; run < 3; ++run)
+    {
+        if (cold)
+            remove(COMPILED_PATH);
+
+        double secs = Import();
+        if (secs < 0)
+            return secs;
+        best = run ? Min(best, secs) : secs;
+    }
+    return best;
+}
+
+}// namespace
+
+int main(int argc, char* argv[])
+{
+    size_t classes = argc > 1 ? (size_t)strtoul(argv[1], 0, 0) : 2000;
+    size_t size    = WritePackage(classes);
+
+    if (!size)
+    {
+        fprintf(stderr, "importbench: could not write %s\n", PACKAGE_PATH);
+        return 1;
+    }
+
+    // Time an empty Engine too, so the fixed cost of starting one can be told apart.
+    u8      start = Pika_Microseconds();
+    Engine* eng   = Engine::Create();
+    eng->Release();
+    double  empty = (double)(Pika_Microseconds() - start) / 1e6;
+
+    double cold = BestImport(true);
+    double warm = BestImport(false);
+
+    remove(COMPILED_PATH);
+    remove(PACKAGE_PATH);
+
+    if (cold < 0 || warm < 0)
+    {
+        fprintf(stderr, "importbench: the package failed to import\n");
+        return 1;
+    }
+
+    printf("%u classes, %u bytes of source\n", (unsigned)classes, (unsigned)size);
+    printf("%12s %12s\n", "import", "seconds");
+    printf("%12s %12.4f\n", "engine only", empty);
+    printf("%12s %12.4f\n", "cold",        cold);
+    printf("%12s %12.4f\n", "warm",        warm);
+    printf("warm imports take %.1f%% of the time of cold imports\n", 100.0 * warm / cold);
+    return 0;
+}
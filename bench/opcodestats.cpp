@@ -0,0 +1,219 @@
+/*
+ *  opcodestats.cpp
+ *  See Copyright Notice in Pika.h
+ *
+ *  Runs scripts with an instruction hook and reports the number of instructions dispatched along
+ *  with the most frequent sequences of opcodes. Sequences are ranked by the number of dispatches
+ *  that would be saved if they were fused into a single instruction, see Compiler::Fuse.
+ *
+ *  Only instructions executed one after another without a jump in between, and within the same
+ *  statement, count as a sequence. The numbered forms of pushlocal, pushliteral and setlocal and
+ *  the quickened opcodes are counted as their generic opcode.
+ *
+ *  Run the same scripts at -O2 and -O3 to see how many dispatches the fused opcodes save. The
+ *  hook slows the interpreter down considerably, time the scripts with pika -O<level> instead.
+ *
+ *  usage: opcodestats [-O<level>] [-n count] [-p path]... file...
+ */
+#include "Pika.h"
+#include "PPlatform.h"
+#include <map>
+#include <vector>
+#include <algorithm>
+using namespace pika;
+
+namespace {
+
+const int MAX_SEQUENCE = 4; // Longest sequence counted.
+
+typedef std::map<u8, u8> SequenceMap;
+
+/* Returns the opcode the compiler emitted for oc, before it was narrowed or quickened. */
+Opcode GenericOpcode(Opcode oc)
+{
+    if (oc >= OP_pushliteral0 && oc <= OP_pushliteral4) return OP_pushliteral;
+    if (oc >= OP_pushlocal0   && oc <= OP_pushlocal4)   return OP_pushlocal;
+    if (oc >= OP_setlocal0    && oc <= OP_setlocal4)    return OP_setlocal;
+
+    switch (oc)
+    {
+    case OP_add_ii: case OP_add_rr: return OP_add;
+    case OP_sub_ii: case OP_sub_rr: return OP_sub;
+    case OP_mul_ii: case OP_mul_rr: return OP_mul;
+    case OP_div_rr:                 return OP_div;
+    case OP_eq_ii:                  return OP_eq;
+    case OP_ne_ii:                  return OP_ne;
+    case OP_lt_ii:  case OP_lt_rr:  return OP_lt;
+    case OP_gt_ii:  case OP_gt_rr:  return OP_gt;
+    case OP_lte_ii: case OP_lte_rr: return OP_lte;
+    case OP_gte_ii: case OP_gte_rr: return OP_gte;
+    case OP_cat_ss:                 return OP_cat;
+    default:                        return oc;
+    }
+}
+
+/* Returns true if pc is the first instruction of a line in def. */
+bool StartsLine(Def* def, code_t* pc)
+{
+    size_t lo = 0;
+    size_t hi = def->lineInfo.GetSize();
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        code_t* pos = def->lineInfo[mid].pos;
+        if (pos == pc)
+            return true;
+        if (pos < pc)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return false;
+}
+
+/* Counts every instruction dispatched and the sequences of opcodes ending at it. */
+struct StatsHook : IHook
+{
+    StatsHook() : dispatched(0), last(0), count(0) {}
+
+    virtual bool OnEvent(HookEvent, void* v)
+    {
+        InstructionData* data = (InstructionData*)v;
+        code_t* pc = data->pc - 1; // @OPCODE-LENGTH@
+        Def*   def = data->function->GetDef();
+
+        ++dispatched;
+
+        if (pc != last + 1 || StartsLine(def, pc))
+            count = 0;
+
+        if (count == MAX_SEQUENCE)
+        {
+            for (int i = 1; i < MAX_SEQUENCE; ++i)
+                window[i - 1] = window[i];
+            --count;
+        }
+        window[count++] = GenericOpcode(PIKA_GET_OPCODEOF(*pc));
+        last = pc;
+
+        // Each sequence is keyed by its opcodes, oldest first, one per byte.
+        u8 key = window[count - 1];
+        for (int i = count - 2, n = 2; i >= 0; --i, ++n)
+        {
+            key |= (u8)window[i] << (8 * (n - 1));
+            ++sequences[((u8)n << 56) | key];
+        }
+        return false;
+    }
+
+    virtual void Release(HookEvent) {}
+
+    u8          dispatched;              //!< Number of instructions dispatched.
+    SequenceMap sequences;               //!< Number of times each sequence was executed.
+    code_t*     last;                    //!< Last instruction executed.
+    Opcode      window[MAX_SEQUENCE];    //!< Opcodes of the current sequence.
+    int         count;                   //!< Length of the current sequence.
+};
+
+struct Ranked
+{
+    u8 key;
+    u8 count;
+    u8 saved;
+
+    bool operator<(const Ranked& rhs) const { return saved > rhs.saved; }
+};
+
+void PrintSequence(u8 key)
+{
+    int length = (int)(key >> 56);
+    char buff[128] = { 0 };
+    size_t pos = 0;
+    for (int i = length - 1; i >= 0; --i)
+    {
+        Opcode oc = (Opcode)((key >> (8 * i)) & 0xFF);
+        pos += Pika_snprintf(buff + pos, sizeof(buff) - pos, i ? "%s; " : "%s", OpcodeNames[oc]);
+    }
+    printf("%-56s", buff);
+}
+
+}// namespace
+
+int main(int argc, char* argv[])
+{
+    int    top   = 30;
+    int    level = PIKA_MAX_OPTIMIZE_LEVEL;
+    int    first = 1;
+    Engine* eng  = Engine::Create();
+
+    for (; first < argc && argv[first][0] == '-'; ++first)
+    {
+        const char* opt = argv[first];
+        if (opt[1] == 'O')
+        {
+            level = atoi(opt + 2);
+        }
+        else if (opt[1] == 'n' && first + 1 < argc)
+        {
+            top = atoi(argv[++first]);
+        }
+        else if (opt[1] == 'p' && first + 1 < argc)
+        {
+            eng->AddSearchPath(argv[++first]);
+        }
+        else
+        {
+            first = argc;
+        }
+    }
+
+    if (first >= argc)
+    {
+        fprintf(stderr, "usage: %s [-O<level>] [-n count] [-p path]... file...\n", argv[0]);
+        eng->Release();
+        return 1;
+    }
+
+    StatsHook hook;
+    eng->SetOptimizeLevel(level);
+    eng->AddEnvPath("PIKA_PATH");
+    eng->AddHook(HE_instruction, &hook);
+
+    for (int i = first; i < argc; ++i)
+    {
+        try
+        {
+            Script* script = eng->Compile(argv[i]);
+            if (!script || !script->Run(0))
+                fprintf(stderr, "** Could not run script: %s\n", argv[i]);
+        }
+        catch (Exception& e)
+        {
+            fprintf(stderr, "** %s: %s\n", argv[i], e.GetMessage());
+        }
+    }
+    eng->RemoveHook(HE_instruction, &hook);
+
+    std::vector<Ranked> ranked;
+    for (SequenceMap::iterator it = hook.sequences.begin(); it != hook.sequences.end(); ++it)
+    {
+        Ranked r = { it->first, it->second, it->second * ((it->first >> 56) - 1) };
+        ranked.push_back(r);
+    }
+    std::sort(ranked.begin(), ranked.end());
+
+    double total = hook.dispatched ? (double)hook.dispatched : 1.0;
+    printf("\nlevel -O%d: %llu instructions dispatched\n\n", level, (unsigned long long)hook.dispatched);
+    printf("%-56s  %12s  %12s  %6s\n", "sequence", "executed", "saved", "saved%");
+
+    for (size_t i = 0; i < ranked.size() && i < (size_t)top; ++i)
+    {
+        PrintSequence(ranked[i].key);
+        printf("  %12llu  %12llu  %5.1f%%\n",
+               (unsigned long long)ranked[i].count,
+               (unsigned long long)ranked[i].saved,
+               100.0 * (double)ranked[i].saved / total);
+    }
+    eng->Release();
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ *  optbench.cpp
+ *  See Copyright Notice in Pika.h
+ *
+ *  Compiles scripts at every optimization level and reports the size of their bytecode, counted
+ *  in instructions over every function in the script. Scripts are only compiled, not run; time
+ *  them with pika -O<level> to see the effect on run time.
+ *
+ *  usage: optbench file...
+ */
+#include "Pika.h"
+#include "PPlatform.h"
+using namespace pika;
+
+namespace {
+
+const int NUM_LEVELS = PIKA_MAX_OPTIMIZE_LEVEL + 1;
+
+size_t CountDef(Def* def)
+{
+    return def->bytecode ? def->bytecode->length : 0;
+}
+
+/* Returns the number of instructions in the script's entry point and every function declared in
+ * it. The functions of a script share its LiteralPool. */
+size_t CountScript(Function* entry)
+{
+    Def*         def   = entry->def;
+    LiteralPool* lp    = def->literals;
+    size_t       count = CountDef(def);
+
+    for (size_t i = 0; lp && i < lp->GetSize(); ++i)
+    {
+        const Value& v = lp->Get((u2)i);
+        if (v.IsFunction())
+            count += CountDef(v.val.def);
+    }
+    return count;
+}
+
+/* Reads the file at path. The result must be freed with Pika_free. */
+char* ReadFile(const char* path, size_t& len)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return 0;
+
+    char* buff = 0;
+    long  size = -1;
+
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        buff = (char*)Pika_malloc((size_t)size + 1);
+        len  = fread(buff, 1, (size_t)size, file);
+    }
+    fclose(file);
+    return buff;
+}
+
+}// namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s file...\n", argv[0]);
+        return 1;
+    }
+
+    Engine* eng = Engine::Create();
+    size_t  totals[NUM_LEVELS] = { 0 };
+    u8      times[NUM_LEVELS]  = { 0 };
+
+    printf("%-32s", "script");
+    for (int level = 0; level < NUM_LEVELS; ++level)
+        printf("  %6s%d", "-O", level);
+    printf("\n");
+
+    for (int i = 1; i < argc; ++i)
+    {
+        size_t len  = 0;
+        char*  src  = ReadFile(argv[i], len);
+        size_t counts[NUM_LEVELS] = { 0 };
+        bool   ok   = src != 0;
+
+        for (int level = 0; ok && level < NUM_LEVELS; ++level)
+        {
+            eng->SetOptimizeLevel(level);
+            u8 start = Pika_Microseconds();
+            try
+            {
+                counts[level] = CountScript(eng->CompileString(src, len));
+            }
+            catch (Exception&)
+            {
+                ok = false;
+            }
+            times[level] += Pika_Microseconds() - start;
+        }
+
+        const char* name = Pika_rindex(argv[i], PIKA_PATH_SEP_CHAR);
+        printf("%-32s", name ? name + 1 : argv[i]);
+
+        for (int level = 0; level < NUM_LEVELS; ++level)
+        {
+            if (ok)
+            {
+                printf("  %8u", (unsigned)counts[level]);
+                totals[level] += counts[level];
+            }
+        }
+        printf(ok ? "\n" : "  (could not compile)\n");
+
+        if (src)
+            Pika_free(src);
+    }
+
+    printf("%-32s", "total");
+    for (int level = 0; level < NUM_LEVELS; ++level)
+        printf("  %8u", (unsigned)totals[level]);
+    printf("\n%-32s", "change");
+    for (int level = 0; level < NUM_LEVELS; ++level)
+        printf("  %7.1f%%", totals[0] ? 100.0 * ((double)totals[level] - totals[0]) / totals[0] : 0.0);
+    printf("\n%-32s", "compile seconds");
+    for (int level = 0; level < NUM_LEVELS; ++level)
+        printf("  %8.3f", (double)times[level] / 1e6);
+    printf("\n");
+
+    eng->Release();
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ *  stringbench.cpp
+ *  See Copyright Notice in Pika.h
+ *
+ *  Measures how long the interpreter can be stopped by interning Strings. Creates a number of
+ *  Strings that are kept alive and a number that die straight away, interleaved, and times every
+ *  call to Engine::AllocString. Each call can grow the StringTable and run a step of the
+ *  Collector, which sweeps dead Strings out of the table, so the slowest calls are the pauses a
+ *  script creating the same Strings would see.
+ *
+ *  Only the Engine's public interface is used, so the file can be built against an older tree to
+ *  compare StringTables.
+ *
+ *  usage: stringbench [kept] [temporary]
+ */
+#include "Pika.h"
+#include "PPlatform.h"
+using namespace pika;
+
+namespace {
+
+/* Upper bounds, in microseconds, of the latency buckets reported. The last bucket is unbounded. */
+const u8     bucketLimits[] = { 10, 100, 1000, 10000 };
+const size_t NUM_BUCKETS    = sizeof(bucketLimits) / sizeof(bucketLimits[0]) + 1;
+
+size_t Bucket(u8 usecs)
+{
+    size_t b = 0;
+    while (b < NUM_BUCKETS - 1 && usecs >= bucketLimits[b])
+        ++b;
+    return b;
+}
+
+}// namespace
+
+int main(int argc, char* argv[])
+{
+    size_t kept      = argc > 1 ? (size_t)strtoul(argv[1], 0, 10) : 3000000;
+    size_t temporary = argc > 2 ? (size_t)strtoul(argv[2], 0, 10) : 5000000;
+    size_t total     = kept + temporary;
+    Engine* eng = Engine::Create();
+
+    size_t counts[NUM_BUCKETS] = { 0 };
+    u8     slowest   = 0;
+    size_t slowestAt = 0;
+    char   buff[32];
+
+    u8 start = Pika_Microseconds();
+    for (size_t i = 0; i < total; ++i)
+    {
+        // Spread the kept Strings evenly among the temporary ones. The numbers are scrambled so
+        // that Strings made one after another do not get neighbouring hash codes.
+        bool keep = (i + 1) * kept / total != i * kept / total;
+        sprintf(buff, keep ? "kept%u" : "temp%u", (unsigned)(i * 2654435761u));
+
+        u8 before = Pika_Microseconds();
+        String* str = eng->AllocString(buff);
+        u8 usecs = Pika_Microseconds() - before;
+
+        if (keep)
+            eng->PersistentString(str);
+        counts[Bucket(usecs)]++;
+        if (usecs > slowest)
+        {
+            slowest   = usecs;
+            slowestAt = i;
+        }
+    }
+    double seconds = (double)(Pika_Microseconds() - start) / 1e6;
+
+    printf("%u Strings kept, %u temporary\n", (unsigned)kept, (unsigned)temporary);
+    printf("total %.2f s, slowest call %.3f ms at String %u\n", seconds, (double)slowest / 1e3, (unsigned)slowestAt);
+    printf("calls taking\n");
+    for (size_t b = 0; b < NUM_BUCKETS; ++b)
+    {
+        if (b < NUM_BUCKETS - 1)
+            printf("  < %6u us  %10u\n", (unsigned)bucketLimits[b], (unsigned)counts[b]);
+        else
+            printf("  >= %5u us  %10u\n", (unsigned)bucketLimits[b - 1], (unsigned)counts[b]);
+    }
+    eng->Release();
+    return 0;
+}
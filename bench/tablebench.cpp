@@ -0,0 +1,349 @@
+/*
+ *  tablebench.cpp
+ *  See Copyright Notice in Pika.h
+ *
+ *  Measures Table set, get, remove and iteration from 10 to 10M entries. The chained hash table
+ *  Pika used before is measured alongside it for comparison.
+ *
+ *  Each operation is reported in nanoseconds per entry for four kinds of key: sequential
+ *  integers, multiples of 1024, random integers and interned Strings ("key0", "key1", ...).
+ *  String keys stop at 1M entries to keep memory in check.
+ *
+ *  usage: tablebench [max-entries]
+ */
+#include "Pika.h"
+#include "PPlatform.h"
+using namespace pika;
+
+namespace {
+
+// Chained table ///////////////////////////////////////////////////////////////////////////////////
+
+/* The separately chained Table that open addressing replaced. Each Slot is its own allocation and
+ * rows holds the head of each chain. Integers hash to themselves and the table doubles once
+ * there are more than two Slots per row. */
+class ChainedTable
+{
+    struct Node
+    {
+        Value key;
+        Value val;
+        Node* next;
+        u4    attr;
+    };
+public:
+    ChainedTable() : rows(0), count(0), size(8)
+    {
+        rows = (Node**)Pika_calloc(size, sizeof(Node*));
+    }
+
+    ~ChainedTable()
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            for (Node* n = rows[i]; n; )
+            {
+                Node* next = n->next;
+                Pika_free(n);
+                n = next;
+            }
+        }
+        Pika_free(rows);
+    }
+
+    void Set(const Value& key, Value& val)
+    {
+        size_t row = Hash(key) & (size - 1);
+        for (Node* n = rows[row]; n; n = n->next)
+        {
+            if (n->key == key)
+            {
+                n->val = val;
+                return;
+            }
+        }
+        if (count > (size << 1))
+        {
+            Grow();
+            row = Hash(key) & (size - 1);
+        }
+        Node* n = (Node*)Pika_malloc(sizeof(Node));
+        n->key  = key;
+        n->val  = val;
+        n->attr = 0;
+        n->next = rows[row];
+        rows[row] = n;
+        ++count;
+    }
+
+    bool Get(const Value& key, Value& res) const
+    {
+        for (Node* n = rows[Hash(key) & (size - 1)]; n; n = n->next)
+        {
+            if (n->key == key)
+            {
+                res = n->val;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Remove(const Value& key)
+    {
+        for (Node** link = &rows[Hash(key) & (size - 1)]; *link; link = &(*link)->next)
+        {
+            Node* n = *link;
+            if (n->key == key)
+            {
+                *link = n->next;
+                Pika_free(n);
+                --count;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* Sums the integer values of every entry. */
+    pint_t Iterate() const
+    {
+        pint_t sum = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            for (Node* n = rows[i]; n; n = n->next)
+                sum += n->val.GetInteger();
+        }
+        return sum;
+    }
+private:
+    static size_t Hash(const Value& key)
+    {
+        return key.GetTag() == TAG_string ? key.GetString()->GetHashCode() : (size_t)key.GetInteger();
+    }
+
+    void Grow()
+    {
+        size_t oldSize = size;
+        Node** oldRows = rows;
+        size <<= 1;
+        rows = (Node**)Pika_calloc(size, sizeof(Node*));
+        for (size_t i = 0; i < oldSize; ++i)
+        {
+            for (Node* n = oldRows[i]; n; )
+            {
+                Node*  next = n->next;
+                size_t row  = Hash(n->key) & (size - 1);
+                n->next   = rows[row];
+                rows[row] = n;
+                n = next;
+            }
+        }
+        Pika_free(oldRows);
+    }
+
+    Node** rows;
+    size_t count;
+    size_t size;
+};
+
+/* Gives pika::Table the same interface as ChainedTable. */
+class OpenTable
+{
+public:
+    void Set(const Value& key, Value& val)      { table.Set(key, val); }
+    bool Get(const Value& key, Value& res)      { return table.Get(key, res); }
+    bool Remove(const Value& key)               { return table.Remove(key); }
+
+    pint_t Iterate()
+    {
+        pint_t sum = 0;
+        for (Table::Iterator iter = table.GetIterator(); iter; ++iter)
+            sum += iter->val.GetInteger();
+        return sum;
+    }
+private:
+    Table table;
+};
+
+// Keys ////////////////////////////////////////////////////////////////////////////////////////////
+
+enum KeySet
+{
+    KS_sequential, // 0, 1, 2, ...
+    KS_strided,    // 0, 1024, 2048, ...
+    KS_random,     // random 62 bit integers
+    KS_string,     // "key0", "key1", ...
+    KS_max
+};
+
+const char*  keySetNames[KS_max] = { "sequential int", "strided int", "random int", "string" };
+const size_t MAX_STRING_KEYS     = 1000000;
+const size_t MAX_CHAINED_STRIDE  = 10000; // Strided keys share a few chains, so past this the chained table takes hours.
+
+u8 rngState = 0x853C49E6748FEA9BULL;
+
+u8 NextRandom()
+{
+    // splitmix64
+    u8 z = (rngState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* Fills keys with n keys of the given kind. Strings are made persistent so that the collector
+ * cannot free them while they are only referenced from here. */
+void MakeKeys(Engine* eng, KeySet ks, size_t n, Value* keys)
+{
+    char buff[32];
+    for (size_t i = 0; i < n; ++i)
+    {
+        switch (ks)
+        {
+        case KS_sequential: keys[i] = Value((pint_t)i);                           break;
+        case KS_strided:    keys[i] = Value((pint_t)i << 10);                     break;
+        case KS_random:     keys[i] = Value((pint_t)(NextRandom() >> 2));         break;
+        case KS_string:
+        {
+            sprintf(buff, "key%u", (unsigned)i);
+            String* str = eng->AllocString(buff);
+            eng->PersistentString(str);
+            keys[i] = Value(str);
+            break;
+        }
+        default: break;
+        }
+    }
+}
+
+// Benchmark ///////////////////////////////////////////////////////////////////////////////////////
+
+enum Operation
+{
+    OP_set,     // Insert every key into an empty table.
+    OP_get,     // Look up every key.
+    OP_remove,  // Remove every key.
+    OP_iterate, // Visit every entry.
+    OP_max
+};
+
+const char* operationNames[OP_max] = { "set", "get", "remove", "iterate" };
+
+/* Tables of every size are filled and measured enough times to do about this many operations. */
+const size_t OPS_PER_RUN = 1 << 23;
+
+double Elapsed(u8 start) { return (double)(Pika_Microseconds() - start) * 1e3; }
+
+/* Fills a new table with n keys, then removes them again if remove is true, rounds times. */
+template<typename T>
+double Fill(const Value* keys, size_t n, size_t rounds, bool remove, pint_t& sink)
+{
+    u8 start = Pika_Microseconds();
+    for (size_t r = 0; r < rounds; ++r)
+    {
+        T* table = 0;
+        PIKA_NEW(T, table, ());
+        for (size_t i = 0; i < n; ++i)
+        {
+            Value v((pint_t)i);
+            table->Set(keys[i], v);
+        }
+        if (remove)
+        {
+            for (size_t i = 0; i < n; ++i)
+                sink += table->Remove(keys[i]);
+        }
+        Pika_delete(table);
+    }
+    return Elapsed(start);
+}
+
+/* Measures each Operation over n keys and stores the nanoseconds per entry in ns. Removing is
+ * timed together with filling the table, so the time taken to fill it is subtracted. */
+template<typename T>
+void Measure(const Value* keys, size_t n, double ns[OP_max], pint_t& sink)
+{
+    size_t rounds = Max<size_t>(OPS_PER_RUN / n, 1);
+    double ops    = (double)rounds * n;
+    double fill   = Fill<T>(keys, n, rounds, false, sink);
+    
+    ns[OP_set]    = fill / ops;
+    ns[OP_remove] = Max<double>(Fill<T>(keys, n, rounds, true, sink) - fill, 0) / ops;
+
+    T* table = 0;
+    PIKA_NEW(T, table, ());
+    for (size_t i = 0; i < n; ++i)
+    {
+        Value v((pint_t)i);
+        table->Set(keys[i], v);
+    }
+
+    u8 start = Pika_Microseconds();
+    for (size_t r = 0; r < rounds; ++r)
+    {
+        Value res;
+        for (size_t i = 0; i < n; ++i)
+        {
+            table->Get(keys[i], res);
+            sink += res.GetInteger();
+        }
+    }
+    ns[OP_get] = Elapsed(start) / ops;
+
+    start = Pika_Microseconds();
+    for (size_t r = 0; r < rounds; ++r)
+        sink += table->Iterate();
+    ns[OP_iterate] = Elapsed(start) / ops;
+
+    Pika_delete(table);
+}
+
+}// namespace
+
+int main(int argc, char* argv[])
+{
+    size_t maxEntries = argc > 1 ? (size_t)strtoul(argv[1], 0, 10) : 10000000;
+    Engine* eng = Engine::Create();
+    pint_t  sink = 0;
+
+    printf("ns per entry, chained / open addressing\n");
+    printf("%-16s %10s", "keys", "entries");
+    for (int op = 0; op < OP_max; ++op)
+        printf("  %17s", operationNames[op]);
+    printf("\n");
+
+    for (int ks = 0; ks < KS_max; ++ks)
+    {
+        for (size_t n = 10; n <= maxEntries; n *= 10)
+        {
+            if (ks == KS_string && n > MAX_STRING_KEYS)
+                break;
+
+            Value* keys = (Value*)Pika_malloc(n * sizeof(Value));
+            MakeKeys(eng, (KeySet)ks, n, keys);
+
+            bool   skipChained = ks == KS_strided && n > MAX_CHAINED_STRIDE;
+            double chained[OP_max], open[OP_max];
+            if (!skipChained)
+                Measure<ChainedTable>(keys, n, chained, sink);
+            Measure<OpenTable>(keys, n, open, sink);
+
+            printf("%-16s %10u", keySetNames[ks], (unsigned)n);
+            for (int op = 0; op < OP_max; ++op)
+            {
+                if (skipChained)
+                    printf("  %7s / %7.1f", "-", open[op]);
+                else
+                    printf("  %7.1f / %7.1f", chained[op], open[op]);
+            }
+            printf("\n");
+            fflush(stdout);
+
+            Pika_free(keys);
+        }
+    }
+    printf("(checksum %d)\n", (int)sink);
+    eng->Release();
+    return 0;
+}
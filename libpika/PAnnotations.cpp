@@ -33,9 +33,9 @@ namespace {
         Dictionary* dict = ctx->GetKeywordArgs();
         if (!dict)
             RaiseException("annotation attr called with no named parameters.\n");
-        for (Table::Iterator iter = dict->Elements().GetIterator(); iter; ++iter)
+        for (Dictionary::ElementIterator iter = dict->GetElements(); iter; ++iter)
         {
-            obj->SetSlot(iter->key, iter->val);
+            obj->SetSlot(iter.GetKey(), iter.GetValue());
         }
         ctx->Push(obj);
         return 1;
@@ -124,7 +124,7 @@ namespace {
             Value p(NULL_VALUE);
             if (pkg->GetGlobal(name, p) && eng->Property_Type->IsInstance(p))
             {
-                return p.val.property;
+                return p.GetProperty();
             }
         }
         return 0;
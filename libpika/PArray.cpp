@@ -168,19 +168,19 @@ bool Array::BracketWrite(const Value& key, Value& value, u4 attr)
 
 bool Array::GetIndexOf(const Value& key, size_t &index)
 {
-    if (key.tag == TAG_integer)
+    if (key.GetTag() == TAG_integer)
     {
-        if (key.val.integer < 0)
+        if (key.GetInteger() < 0)
         {
             if (-index < (pint_t)elements.GetSize()) {
-                index = elements.GetSize() + key.val.integer;
+                index = elements.GetSize() + key.GetInteger();
                 return true;
             }
         }
         
-        if ((key.val.integer >= 0) && (key.val.integer < (pint_t)elements.GetSize()))
+        if ((key.GetInteger() >= 0) && (key.GetInteger() < (pint_t)elements.GetSize()))
         {
-            index = (size_t)key.val.integer;
+            index = (size_t)key.GetInteger();
             return true;
         }
     }
@@ -199,16 +199,20 @@ void Array::MarkRefs(Collector* c)
     }
 }
 
+size_t Array::GetExternalBytes() const
+{
+    return ThisSuper::GetExternalBytes() + elements.GetCapacity() * sizeof(Value);
+}
+
 Array* Array::Create(Engine* eng, Type* type, size_t length, Value const* elems)
 {
     if (length > GetMax()) {
         RaiseException("Attempt to create an Array larger than the maximum size allowed "SIZE_T_FMT".", GetMax());
     }
     
-    void* sp = eng->ArrayRawAlloc();
+    Array* v = 0;
     type = type ? type : eng->Array_Type;
-    Array* v = new (sp) Array(eng, type, length, elems);
-    eng->AddToGC(v);
+    GCNEW(eng, Array, v, (eng, type, length, elems));
     return v;
 }
 
@@ -238,6 +242,7 @@ void Array::SetLength(ssize_t slen)
     size_t oldlen = elements.GetSize();
     size_t amt    = (oldlen < len) ? (len - oldlen) : 0;
     
+    GCCHARGE(engine, this);
     elements.SmartResize(len);
     
     for (size_t i = 0 ; i < amt ; ++i)
@@ -252,6 +257,7 @@ Array* Array::Unshift(Value& v)
     }
     WriteBarrier(v);
     
+    GCCHARGE(engine, this);
     elements.SmartResize(elements.GetSize() + 1);
     Pika_memmove(elements.GetAt(1), elements.GetAt(0), (elements.GetSize() - 1) * sizeof(Value));
     elements[0] = v;
@@ -315,6 +321,8 @@ Array* Array::Push(Value& v)
         RaiseException("Max size of "SIZE_T_FMT" reached. Cannot add more elements to the array.", GetMax());
     }
     WriteBarrier(v);
+    
+    GCCHARGE(engine, this);
     elements.Push(v);
     return this;
 }
@@ -327,12 +335,6 @@ Array* Array::Reverse()
 
 Array::~Array() {}
 
-bool Array::Finalize()
-{
-    engine->DelArray(this);
-    return false;
-}
-
 Value Array::Pop()
 {
     size_t len = elements.GetSize();
@@ -369,6 +371,7 @@ Value Array::Zip(Array* rhs)
 Array::Array(Engine* eng, Type* arrType, size_t length, Value const* elems)
         : ThisSuper(eng, arrType)
 {
+    GCCHARGE(engine, this);
     elements.Resize(length);
     
     if (!elems)
@@ -388,6 +391,7 @@ Array::Array(const Array* rhs) :
     ThisSuper(rhs),
     elements(rhs->elements)
 {
+    engine->GetGC()->ChargeExternal(0, elements.GetCapacity() * sizeof(Value));
 }
 
 Iterator* Array::Iterate(String *iter_type)
@@ -402,8 +406,7 @@ Iterator* Array::Iterate(String *iter_type)
     }
     
     Iterator* e = 0;
-    PIKA_NEW(ArrayIterator, e, (engine, engine->Iterator_Type, kind, this));
-    engine->AddToGC(e);
+    GCNEW(engine, ArrayIterator, e, (engine, engine->Iterator_Type, kind, this));
     return e;
 }
 
@@ -636,6 +639,7 @@ Value Array::Foldr(const Value& init, const Value& fn)
 
 Array* Array::Append(Array* other)
 {
+    GCCHARGE(engine, this);
     for (size_t i = 0; i < other->elements.GetSize(); ++i)
     {
         WriteBarrier(other->elements[i]);
@@ -679,7 +683,7 @@ Value Array::CatRhs(Value& lhs)
     Value res(NULL_VALUE);
     if (engine->Array_Type->IsInstance(lhs))
     {
-        Array* arr = Cat((Array*)lhs.val.object, this);
+        Array* arr = Cat((Array*)lhs.GetObject(), this);
         res.Set(arr);
     }
     else 
@@ -688,7 +692,7 @@ Value Array::CatRhs(Value& lhs)
         String* lhstr = engine->emptyString;
         if (lhs.IsString())
         {
-            lhstr = lhs.val.str;
+            lhstr = lhs.GetString();
         }
         else
         {
@@ -707,7 +711,7 @@ Value Array::CatLhs(Value& rhs)
     if (engine->Array_Type->IsInstance(rhs))
     {
         // Concatenate the 2 Arrays together.
-        Array* arr = Cat(this, (Array*)rhs.val.object);
+        Array* arr = Cat(this, (Array*)rhs.GetObject());
         res.Set(arr);
     }
     else
@@ -719,7 +723,7 @@ Value Array::CatLhs(Value& rhs)
         String* rhstr = engine->emptyString;
         if (rhs.IsString())
         {
-            rhstr = rhs.val.str;
+            rhstr = rhs.GetString();
         }
         else
         {
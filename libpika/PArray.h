@@ -50,12 +50,13 @@ protected:
     bool GetIndexOf(const Value& key, size_t &index);
 public:
     virtual ~Array();
-    virtual bool Finalize();
     
     virtual bool BracketRead(const Value&, Value&);
     virtual bool BracketWrite(const Value&, Value&, u4 attr = 0);
     
     virtual void        MarkRefs(Collector*);
+    virtual size_t      GetExternalBytes() const;
+    virtual bool        CanFreeInBackground() { return !members && GetClassInfo() == StaticGetClass(); }
     virtual Object*     Clone();
     virtual Iterator*   Iterate(String*);
     virtual void        Init(Context*);
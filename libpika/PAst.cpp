@@ -45,8 +45,7 @@ void Pika_FunctionResourceCalculation(
     *index = cs.AddConstant((*def));
     (*def)->literals = cs.literals;
     
-    *symtab = 0;
-    PIKA_NEW(SymbolTable, (*symtab), (st, 0));
+    *symtab = cs.CreateSymbolTable(st);
     
     if ((*symtab)->IncrementDepth() > PIKA_MAX_NESTED_FUNCTIONS)
     {
@@ -92,7 +91,8 @@ void Pika_FunctionResourceCalculation(
 
 
 CompileState::CompileState(Engine* eng)
-        : literals(0),
+        : arena(PIKA_COMPILE_ARENA_BLOCK),
+        literals(0),
         engine(eng),
         currDef(0),
         localOffset(0),
@@ -107,29 +107,9 @@ CompileState::CompileState(Engine* eng)
     trystate.inCatch = false;
     trystate.inTry = false;
     trystate.catchVarOffset = (u2)(-1);
-    nodes.SetCapacity(128);
-    instructions.SetCapacity(128);
 }
 
-CompileState::~CompileState()
-{
-    for (Buffer<TreeNode*>::Iterator iter = nodes.Begin(); iter != nodes.End(); ++iter)
-    {
-        TreeNode* i = *iter;
-        Pika_delete(i);
-    }
-    
-    for (Buffer<Instr*>::Iterator iter = instructions.Begin(); iter != instructions.End(); ++iter)
-    {
-        Instr* i = *iter;
-        Pika_delete(i);
-    }
-}
-
-void CompileState::AddNode(TreeNode* n)
-{
-    nodes.Push(n);
-}
+CompileState::~CompileState() {}
 
 int CompileState::GetLocalOffset() const
 {
@@ -163,9 +143,39 @@ void CompileState::SetLineInfo(u2 line)
 
 Instr* CompileState::CreateOp(Opcode oc)
 {
-    Instr* r = Instr::Create(oc);
-    instructions.Push(r);
-    return r;
+    return new (arena.Alloc(sizeof(Instr))) Instr(oc);
+}
+
+void CompileState::DoLoopPatch(size_t first, Instr* breakTarget, Instr* continueTarget, Symbol* label)
+{
+    size_t kept = first;
+    
+    for (size_t i = first; i < loopJumps.GetSize(); ++i)
+    {
+        Instr* ir = loopJumps[i];
+        
+        if (ir->symbol && ir->symbol != label)
+        {
+            loopJumps[kept++] = ir;
+            continue;
+        }
+        ir->target = (ir->opcode == BREAK_LOOP) ? breakTarget : continueTarget;
+        ir->opcode = OP_jump;
+    }
+    loopJumps.Resize(kept);
+}
+
+SymbolTable* CompileState::CreateSymbolTable(SymbolTable* parent, u4 flags)
+{
+    return new (arena.Alloc(sizeof(SymbolTable))) SymbolTable(&arena, parent, flags);
+}
+
+char* CompileState::CopyString(const char* str, size_t len)
+{
+    char* res = (char*)arena.Alloc(len + 1);
+    Pika_memcpy(res, str, len);
+    res[len] = '\0';
+    return res;
 }
 
 bool CompileState::UpdateLineInfo(int line)
@@ -185,15 +195,14 @@ u2 CompileState::AddConstant(pint_t i)
     
     if (literalLookup.Get(v, res))
     {
-        return (u2)res.val.index;
+        return (u2)res.GetIndex();
     }
     
-    res.tag = TAG_index;
-    res.val.index = literals->Add(v);
+    res.Set((size_t)literals->Add(v));
     
     literalLookup.Set(v, res);
     
-    return (u2)res.val.index;
+    return (u2)res.GetIndex();
 }
 
 u2 CompileState::AddConstant(preal_t f)
@@ -203,14 +212,13 @@ u2 CompileState::AddConstant(preal_t f)
     
     if (literalLookup.Get(v, res))
     {
-        return (u2)res.val.index;
+        return (u2)res.GetIndex();
     }
-    res.tag = TAG_index;
-    res.val.index = literals->Add(v);
+    res.Set((size_t)literals->Add(v));
     
     literalLookup.Set(v, res);
     
-    return (u2)res.val.index;
+    return (u2)res.GetIndex();
 }
 
 u2 CompileState::AddConstant(Def *fun)
@@ -227,15 +235,14 @@ u2 CompileState::AddConstant(const char *cstr)
     
     if (literalLookup.Get(v, res))
     {
-        return (u2)res.val.index;
+        return (u2)res.GetIndex();
     }
     
-    res.tag = TAG_index;
-    res.val.index = literals->Add(v);
+    res.Set((size_t)literals->Add(v));
     
     literalLookup.Set(v, res);
     
-    return (u2)res.val.index;
+    return (u2)res.GetIndex();
 }
 
 u2 CompileState::AddConstant(const char *cstr, size_t len)
@@ -246,15 +253,14 @@ u2 CompileState::AddConstant(const char *cstr, size_t len)
     
     if (literalLookup.Get(v, res))
     {
-        return (u2)res.val.index;
+        return (u2)res.GetIndex();
     }
     
-    res.tag = TAG_index;
-    res.val.index = literals->Add(v);
+    res.Set((size_t)literals->Add(v));
     
     literalLookup.Set(v, res);
     
-    return (u2)res.val.index;
+    return (u2)res.GetIndex();
 }
 
 Symbol* CompileState::CreateLocalPlus(SymbolTable* st, const char* name, size_t extra)
@@ -341,12 +347,9 @@ void CompileState::SyntaxErrorSummary()
 
 Id::Id(CompileState* s, char *name) : TreeNode(s), TLinked<Id>(), name(name) {}
 
-Id::~Id() { Pika_free(name); }
-
 void FunctionProg::CalculateResources(SymbolTable* st)
 {
-    symtab = 0;
-    PIKA_NEW(SymbolTable, symtab, (st, ST_function));
+    symtab = state->CreateSymbolTable(st, ST_function);
     
     state->literals = LiteralPool::Create(state->engine);
     
@@ -360,8 +363,7 @@ void FunctionProg::CalculateResources(SymbolTable* st)
 
 void Program::CalculateResources(SymbolTable* st)
 {
-    symtab = 0;
-    PIKA_NEW(SymbolTable, symtab, (st, state->repl_mode ? ST_package : ST_main));
+    symtab = state->CreateSymbolTable(st, state->repl_mode ? ST_package : ST_main);
     
     state->literals = LiteralPool::Create(state->engine);
     
@@ -380,11 +382,6 @@ void Program::CalculateResources(SymbolTable* st)
     def->numLocals = state->localCount; // even though a program defaults to global it might still have lexEnv!
 }
 
-Program::~Program()
-{
-    Pika_delete(symtab);
-}
-
 const char* NamedTarget::GetIdentifierName()
 {
     return name->GetName();
@@ -450,8 +447,6 @@ void FunctionDecl::CalculateResources(SymbolTable* st)
     def->isKeyword = kwArgs ? 1 : 0;
 }
 
-FunctionDecl::~FunctionDecl() { Pika_delete(symtab); }
-
 ParamDecl::ParamDecl(CompileState* s, Id *name, bool rest, bool kw, Expr* val)
         : Decl(s, Decl::DECL_parameter),
         val(val),
@@ -679,6 +674,31 @@ void LabeledStmt::DoStmtResources(SymbolTable* st)
     }
 }
 
+void StmtList::DoStmtResources(SymbolTable* st)
+{
+    // Statement lists nest to the left, one level per statement of a block. Walk down to the
+    // first statement instead of recursing so that long blocks cannot overflow the C stack.
+    Buffer<StmtList*> lists;
+    Stmt* curr = first;
+    
+    while (curr && curr->kind == STMT_list)
+    {
+        StmtList* list = (StmtList*)curr;
+        list->newline = state->UpdateLineInfo(list->line);
+        lists.Push(list);
+        curr = list->first;
+    }
+    
+    if (curr) curr->CalculateResources(st);
+    
+    for (size_t i = lists.GetSize(); i > 0; --i)
+    {
+        Stmt* nxt = lists[i - 1]->second;
+        if (nxt) nxt->CalculateResources(st);
+    }
+    if (second) second->CalculateResources(st);
+}
+
 void ExprStmt::DoStmtResources(SymbolTable* st)
 {
     ExprList* curr = exprList;
@@ -748,11 +768,9 @@ void LoopStmt::DoStmtResources(SymbolTable* st)
     }
 }
 
-ForToStmt::~ForToStmt() { Pika_delete(symtab); }
-
 void ForToStmt::DoStmtResources(SymbolTable* st)
 {
-    PIKA_NEW(SymbolTable, symtab, (st, st->IsWithBlock() ? ST_using : 0));
+    symtab = state->CreateSymbolTable(st, st->IsWithBlock() ? ST_using : 0);
     
     // Create the looping variable's symbol along to extra local variables
     // (for 'to' and 'by'.)
@@ -764,26 +782,21 @@ void ForToStmt::DoStmtResources(SymbolTable* st)
     body->CalculateResources(symtab);
 }
 
-ForeachStmt::~ForeachStmt()
-{
-    Pika_delete(symtab);
-}
-
 void ForeachStmt::DoStmtResources(SymbolTable* st)
 {
-    PIKA_NEW(SymbolTable, symtab, (st, st->IsWithBlock() ? ST_using : 0));
+    symtab = state->CreateSymbolTable(st, st->IsWithBlock() ? ST_using : 0);
         
     iter_offset = state->NextLocalOffset("");
     Id* currid = id;
     do
     {
-        Symbol* symb = state->CreateLocalPlus(symtab, currid->name, 0);
-        symbols.Push(symb);
+        state->CreateLocalPlus(symtab, currid->name, 0);
+        ++numVars;
         currid = currid->next;
         
     } while (currid);
     
-    if (symbols.GetSize() > PIKA_MAX_RETC) {
+    if (numVars > PIKA_MAX_RETC) {
         state->SyntaxException(Exception::ERROR_syntax, line, "Too many 'for in' loop variables.");
     }
     
@@ -807,8 +820,7 @@ void IfStmt::DoStmtResources(SymbolTable* st)
 
 void BlockStmt::DoStmtResources(SymbolTable* st)
 {
-    symtab = 0;
-    PIKA_NEW(SymbolTable, symtab, (st, st->IsWithBlock() ? ST_using : 0));
+    symtab = state->CreateSymbolTable(st, st->IsWithBlock() ? ST_using : 0);
     
     if (stmts)
     {
@@ -817,8 +829,6 @@ void BlockStmt::DoStmtResources(SymbolTable* st)
     }
 }
 
-BlockStmt::~BlockStmt() { Pika_delete(symtab); }
-
 DeclStmt::DeclStmt(CompileState* s, Decl *decl) : Stmt(s, Stmt::STMT_decl), decl(decl) {}
 
 void DeclStmt::DoStmtResources(SymbolTable* st)
@@ -942,8 +952,6 @@ void MemberExpr::CalculateResources(SymbolTable* st)
     index = state->AddConstant(id->name);
 }
 
-StringExpr::~StringExpr() { Pika_free(string); }
-
 void StringExpr::CalculateResources(SymbolTable* st)
 {
     //if (!length)
@@ -974,8 +982,6 @@ void IndexExpr::CalculateResources(SymbolTable* st)
     DotExpr::CalculateResources(st);
 }
 
-FunExpr::~FunExpr() { Pika_delete(symtab); }
-
 void FunExpr::CalculateResources(SymbolTable* st)
 {
     Pika_FunctionResourceCalculation(line, st, *state, args, body, &index, &def, &symtab, (name) ? name->name : 0);
@@ -1151,7 +1157,7 @@ SliceExpr::~SliceExpr() {}
 void SliceExpr::CalculateResources(SymbolTable* st)
 {
     Id* id = 0;
-    char *slice = Pika_strdup(OPSLICE_STR);
+    char *slice = state->CopyString(OPSLICE_STR);
     
     PIKA_NEWNODE(Id, id, (state, slice));
     PIKA_NEWNODE(MemberExpr, slicefun, (state, id));
@@ -1166,16 +1172,11 @@ void SliceExpr::CalculateResources(SymbolTable* st)
     if (to)   to  ->CalculateResources(st);
 }
 
-CatchIsBlock::~CatchIsBlock()
-{
-    Pika_delete(symtab);
-}
-
 void CatchIsBlock::CalculateResources(SymbolTable* st)
 {
     CompileState::TryState trystate = state->trystate;
     
-    PIKA_NEW(SymbolTable, symtab, (st, ST_noinherit));
+    symtab = state->CreateSymbolTable(st, ST_noinherit);
     
     symbol = symtab->Put(catchvar->name);
     symbol->offset = state->NextLocalOffset(catchvar->name);
@@ -1192,17 +1193,11 @@ void CatchIsBlock::CalculateResources(SymbolTable* st)
     if (next) next->CalculateResources(st);
 }
 
-TryStmt::~TryStmt()
-{
-    Pika_delete(tryTab);
-    Pika_delete(catchTab);
-}
-
 void TryStmt::DoStmtResources(SymbolTable* st)
 {
     CompileState::TryState trystate = state->trystate;
     
-    PIKA_NEW(SymbolTable, tryTab, (st, st->IsWithBlock() ? ST_using : 0));
+    tryTab = state->CreateSymbolTable(st, st->IsWithBlock() ? ST_using : 0);
     SymbolTable* scope = st->IsFinally() ? st : tryTab;
     
     state->trystate.inTry = true;
@@ -1218,7 +1213,7 @@ void TryStmt::DoStmtResources(SymbolTable* st)
     
     if (catchBlock)
     {
-        PIKA_NEW(SymbolTable, catchTab, (scope, ST_noinherit));
+        catchTab = state->CreateSymbolTable(scope, ST_noinherit);
         symbol = catchTab->Put(caughtVar->name);
         symbol->offset = state->NextLocalOffset(caughtVar->name);
         
@@ -1287,7 +1282,7 @@ void PropertyDecl::UpdateFunctionName(Expr* e)
     {
         FunExpr* fe = (FunExpr*)e;
         if (!fe->name) {
-           PIKA_NEWNODE(Id, fe->name, (state, Pika_strdup("(prop-accessor)")));
+           PIKA_NEWNODE(Id, fe->name, (state, state->CopyString("(prop-accessor)")));
         }
     }
 }
@@ -1296,7 +1291,7 @@ void PropertyDecl::CalculateResources(SymbolTable* st)
 {
     NamedTarget::CalculateResources(st);
     
-    PIKA_NEWNODE(StringExpr, name_expr, (state, Pika_strdup(name->GetName()), strlen(name->GetName())));
+    PIKA_NEWNODE(StringExpr, name_expr, (state, state->CopyString(name->GetName()), strlen(name->GetName())));
     
     name_expr->CalculateResources(st);
         
@@ -1529,11 +1524,9 @@ FinallyStmt::FinallyStmt(CompileState* s, Stmt* block, Stmt* finalize_block)
         symtab(0),
         finalize_block(finalize_block) {}
         
-FinallyStmt::~FinallyStmt() { Pika_delete(symtab); }
-
 void FinallyStmt::DoStmtResources(SymbolTable* st)
 {
-    PIKA_NEW(SymbolTable, symtab, (st, ST_noinherit|ST_finally));
+    symtab = state->CreateSymbolTable(st, ST_noinherit|ST_finally);
     
     if (block)
         block->CalculateResources(symtab);
@@ -1549,11 +1542,9 @@ UsingStmt::UsingStmt(CompileState* s, Expr* e, Stmt* b)
         symtab(0)
 {}
 
-UsingStmt::~UsingStmt() { Pika_delete(symtab); }
-
 void UsingStmt::DoStmtResources(SymbolTable* st)
 {
-    PIKA_NEW(SymbolTable, symtab, (st, ST_using));
+    symtab = state->CreateSymbolTable(st, ST_using);
     
     if (with)
         with->CalculateResources(st);
@@ -1568,16 +1559,14 @@ PkgDecl::PkgDecl(CompileState* s, NameNode* nnode, Stmt* body, StorageKind sto)
         id(0),
     body(body) {}
     
-PkgDecl::~PkgDecl() { Pika_delete(symtab); }
-
 void PkgDecl::CalculateResources(SymbolTable* st)
 {
     NamedTarget::CalculateResources(st);
-    PIKA_NEWNODE(StringExpr, id, (state, Pika_strdup(name->GetName()), strlen(name->GetName())));
+    PIKA_NEWNODE(StringExpr, id, (state, state->CopyString(name->GetName()), strlen(name->GetName())));
     
     id->CalculateResources(st);
     
-    PIKA_NEW(SymbolTable, symtab, (st, ST_package));
+    symtab = state->CreateSymbolTable(st, ST_package);
     
     body->CalculateResources(symtab);
     
@@ -1619,15 +1608,10 @@ const char* NameNode::GetName()
     return 0;
 }
 
-ClassDecl::~ClassDecl()
-{
-    Pika_delete(symtab);    
-}
-
 void ClassDecl::CalculateResources(SymbolTable* st)
 {
     NamedTarget::CalculateResources(st);
-    PIKA_NEWNODE(StringExpr, stringid, (state, Pika_strdup(name->GetName()), strlen(name->GetName())));
+    PIKA_NEWNODE(StringExpr, stringid, (state, state->CopyString(name->GetName()), strlen(name->GetName())));
     
     stringid->CalculateResources(st);
     
@@ -1638,7 +1622,7 @@ void ClassDecl::CalculateResources(SymbolTable* st)
     
     if (stmts)
     {
-        PIKA_NEW(SymbolTable, symtab, (st, ST_package));
+        symtab = state->CreateSymbolTable(st, ST_package);
         stmts->CalculateResources(symtab);
     }
 }
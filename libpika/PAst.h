@@ -8,20 +8,15 @@
 #include "POpcode.h"
 #include "PLineInfo.h"
 #include "PSymbolTable.h"
+#include "PInstruction.h"
 
+// Nodes are allocated from the CompileState's arena and are never destructed, so a node must not
+// own memory that is not also from the arena.
 #ifndef PIKA_NEWNODE
-#define PIKA_NEWNODE(T, p, args)         \
-do {                                     \
-    void* __v = Pika_malloc(sizeof(T));  \
-    if (__v)                             \
-    {                                    \
-        p = new (__v) T args;            \
-        state->AddNode(p);               \
-    }                                    \
-    else                                 \
-    {                                    \
-        p = 0;                           \
-    }                                    \
+#define PIKA_NEWNODE(T, p, args)                \
+do {                                            \
+    void* __v = state->arena.Alloc(sizeof(T));  \
+    p = new (__v) T args;                       \
 } while (false)
 #endif //PIKA_NEWNODE
 
@@ -114,6 +109,9 @@ enum StorageKind
 
 /** Shared state for used by the Tokenizer, Parser and AST. Keeps track of locals, 
   * literals, AST nodes and error handling when parsing. 
+  *
+  * AST nodes, Instrs, SymbolTables and identifier and string tokens are allocated from arena
+  * and freed together when the CompileState is destroyed.
   */
 struct CompileState
 {
@@ -210,8 +208,17 @@ struct CompileState
     
     void SetParser(Parser* p) { parser = p; }
     
-    void AddNode(TreeNode*);
-    Instr* CreateOp(Opcode oc);
+    Instr*       CreateOp(Opcode oc);
+    
+    /** Turns the break and continue Instrs in loopJumps, starting at index first, into jumps to
+      * breakTarget and continueTarget. Instrs labeled for an enclosing loop are kept for it.
+      */
+    void DoLoopPatch(size_t first, Instr* breakTarget, Instr* continueTarget, Symbol* label);
+    SymbolTable* CreateSymbolTable(SymbolTable* parent, u4 flags = 0);
+    
+    /** Copies len characters of str, plus a terminating null, into the arena. */
+    char* CopyString(const char* str, size_t len);
+    char* CopyString(const char* str) { return CopyString(str, strlen(str)); }
     
     struct TryState
     {
@@ -219,8 +226,7 @@ struct CompileState
         bool inCatch;               //!< Are we in a catch block.
         u2   catchVarOffset;        //!< Location of the caught exception (used to re-raise a caught exception).
     }               trystate;    
-    Buffer<TreeNode*> nodes;          //!< All the nodes we know about.
-    Buffer<Instr*>  instructions;
+    MemPoolMixed    arena;          //!< Memory for everything created while compiling.
     LiteralPool*    literals;       //!< Literals used in this program. Shared by all child functions.
     Table           literalLookup;
     Engine*         engine;
@@ -231,6 +237,7 @@ struct CompileState
     int             errors;         //!< Number of errors found.
     int             warnings;       //!< Number of warnings found.
     Instr*          endOfBlock;     //!< Last Instr of the current block (used to track local variable scope.)
+    Buffer<Instr*>  loopJumps;      //!< Break and continue Instrs that have not been given a target yet.
     Parser*         parser; 
     bool            repl_mode;      //!< Running in REPL mode. Errors should be treated as an exception.
 };
@@ -243,7 +250,7 @@ struct TreeNode
     virtual ~TreeNode() {}
     
     virtual void   CalculateResources(SymbolTable* st) {}
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     CompileState* state;    //!< Our CompileState
     int           line;     //!< Line number in the source script.
@@ -261,11 +268,9 @@ struct Program : TreeNode
             symtab(0),
             scriptBeg(beg),
             scriptEnd(end) {}
-            
-    virtual ~Program();
     
     virtual void   CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     u2           index;     //!< Literal index of the __main function Def.
     Def*         def;       //!< Script's function body.
@@ -293,7 +298,6 @@ struct FunctionProg : Program
 struct Id : TreeNode, TLinked<Id>
 {
     Id(CompileState* s, char* name);
-    virtual ~Id();
     
     char* name;
 };
@@ -338,7 +342,7 @@ struct DeclarationTarget : Decl
     
     virtual const char* GetIdentifierName() = 0;
     virtual void        CreateSymbol(SymbolTable* st);
-    virtual Instr*      GenerateCodeSet();
+    virtual InstrList  GenerateCodeSet();
     
     StorageKind storage;   //!< Type of storage for our Symbol.
     bool        with;      //!< Symbol should be a member.
@@ -352,8 +356,8 @@ struct AnnotationDecl : Decl, TLinked<AnnotationDecl>
     virtual ~AnnotationDecl() {}
     
     virtual void   CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
-    virtual Instr* GenerateCodeWith(Instr*);
+    virtual InstrList GenerateCode();
+    virtual InstrList GenerateCodeWith(InstrList subj);
     
     NameNode* name; //!< Identifier or name of the annotation to call.
     ExprList* args; //!< List of arguments, not including the last which comes from the declaration or a previous annotation.
@@ -367,8 +371,8 @@ struct NamedTarget : DeclarationTarget
     virtual void        CalculateResources(SymbolTable* st);
     virtual void        CalculateSymbols(SymbolTable* st);
     virtual const char* GetIdentifierName();
-    virtual Instr*      GenerateCodeSet();    
-    virtual Instr*      GenerateAnnotationCode(Instr* subj);
+    virtual InstrList  GenerateCodeSet();    
+    virtual InstrList  GenerateAnnotationCode(InstrList subj);
     
     AnnotationDecl* annotations;
     bool already_decl;
@@ -379,11 +383,10 @@ struct NamedTarget : DeclarationTarget
 struct FunctionDecl : NamedTarget
 {
     FunctionDecl(CompileState* s, NameNode*, ParamDecl*, Stmt*, size_t, size_t, StorageKind);
-    virtual ~FunctionDecl();
     
     virtual void        CalculateResources(SymbolTable* st);
-    virtual Instr*      GenerateCode();
-    virtual Instr*      GenerateFunctionCode();
+    virtual InstrList  GenerateCode();
+    virtual InstrList  GenerateFunctionCode();
     virtual const char* GetIdentifierName();
     
     Def*         def;       //!< The function definition.
@@ -429,7 +432,7 @@ struct VarDecl : Decl
     {}
     
     virtual void    CalculateResources(SymbolTable* st);
-    virtual Instr*  GenerateCode();
+    virtual InstrList GenerateCode();
     
     u2       nameIndex; //!< Literal pool index of our name.
     Symbol*  symbol;    //!< Symbol of the variable.
@@ -443,7 +446,7 @@ struct LocalDecl : VarDecl
     LocalDecl(CompileState* s, Id* name) : VarDecl(s, name), newLocal(false) {}
     
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     bool newLocal; //!< True if this variable has not been declared in this scope.
 };
@@ -478,7 +481,7 @@ struct VariableTarget : DeclarationTarget
     {}
     
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     virtual const char* GetIdentifierName() { return curr_decl->name->name; }
     
     VarDecl*  curr_decl;
@@ -521,7 +524,7 @@ struct Stmt : TreeNode
     
     virtual bool    IsLoop() const { return false; }
     virtual void    DoStmtResources(SymbolTable* st) = 0;
-    virtual Instr*  DoStmtCodeGen() = 0;
+    virtual InstrList DoStmtCodeGen() = 0;
     
     // Derived classes of stmt should NOT override CalculateResources, instead they
     // implement DoStmtResources.
@@ -531,7 +534,7 @@ struct Stmt : TreeNode
         this->DoStmtResources(st); // Allow the derived class a chance calculate its resources.
     }
     
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     bool newline; //!< Statement lies on a new line.
     Kind kind;    //!< Type of statement.
@@ -541,10 +544,9 @@ struct Stmt : TreeNode
 struct FinallyStmt : Stmt
 {
     FinallyStmt(CompileState* s, Stmt* block, Stmt* finalize_block);
-    virtual ~FinallyStmt();
     
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     Stmt* block;         //!< The block we are wrapping.
     SymbolTable* symtab; //!< Block's SymbolTable.
@@ -560,7 +562,7 @@ struct RaiseStmt : Stmt
     {}
     
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     u2 reraiseOffset; //!< Offset of the catch variable if doing a re-raise.
     Expr* expr; //!< The expression following the raise statement.
@@ -579,7 +581,6 @@ struct CatchIsBlock : TreeNode, TLinked<CatchIsBlock>
         symtab(0)
     {}
     
-    virtual ~CatchIsBlock();
     virtual void CalculateResources(SymbolTable*);
     
     Id*     catchvar;
@@ -601,11 +602,9 @@ struct TryStmt : Stmt
             catchTab(0),
             catchis(cisb),
             elseblock(elsebody) {}
-            
-    virtual ~TryStmt();
     
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     Stmt*         tryBlock;  // Block containing the try statement(s).
     Stmt*         catchBlock;// Block containing the catch 'all' statement(s).
@@ -629,7 +628,7 @@ struct LabeledStmt : Stmt
     {}
     
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     Id* id;
     Symbol* label;
@@ -658,7 +657,7 @@ struct BreakStmt : Stmt
     {}
     
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     Symbol* label;
     Id* id;
@@ -675,7 +674,7 @@ struct ContinueStmt : Stmt
     {}
     
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     Symbol* label;
     Id* id;
@@ -765,7 +764,7 @@ struct ParenExpr : Expr
     virtual ~ParenExpr();
     
     virtual void   CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     Expr* Unwrap();
     Expr* expr;
 };
@@ -786,8 +785,8 @@ struct PropertyDecl : NamedTarget
     virtual void CalculateResources(SymbolTable* st);
     void UpdateFunctionName(Expr*);
     
-    virtual Instr* GenerateCode();
-    virtual Instr* GeneratePropertyCode();
+    virtual InstrList GenerateCode();
+    virtual InstrList GeneratePropertyCode();
     
     StringExpr* name_expr;
     Expr* getter;
@@ -799,7 +798,7 @@ struct EmptyExpr : Expr
     EmptyExpr(CompileState* s) : Expr(s, Expr::EXPR_empty) {}
     
     virtual void CalculateResources(SymbolTable* st) {}
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
 };
 
 struct LoadExpr : Expr
@@ -817,7 +816,7 @@ struct LoadExpr : Expr
     LoadExpr(CompileState* s, LoadKind k) : Expr(s, Expr::EXPR_load), loadkind(k) {}
     
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     LoadKind loadkind;
 };
@@ -832,8 +831,8 @@ struct CallExpr : Expr
             args(args), argc(0), kwargc(), retc(1), redirectedcall(0), is_apply(0) {}
     
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
-    virtual Instr* GenerateCodeWith(Instr* hijack);
+    virtual InstrList GenerateCode();
+    virtual InstrList GenerateCodeWith(InstrList* hijack);
     
     Expr* left;
     ExprList* args;
@@ -848,7 +847,7 @@ struct HijackExpr : Expr {
     HijackExpr(CompileState* s, Expr* l, CallExpr* c) : Expr(s, Expr::EXPR_hijack), left(l), right(c) {}
     
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     Expr* left;
     CallExpr* right;
@@ -865,7 +864,7 @@ struct CondExpr : Expr
             unless(unless) {}
             
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     Expr* cond;
     Expr* exprA;
@@ -880,7 +879,7 @@ struct NullSelectExpr : Expr
     NullSelectExpr(CompileState* s, Expr* a, Expr* b) : Expr(s, Expr::EXPR_nullselect), exprA(a), exprB(b) {}
     
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     Expr* exprA;
     Expr* exprB;
@@ -901,7 +900,7 @@ struct SliceExpr : Expr
     virtual ~SliceExpr();
     
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     Expr* expr;
     Expr* from;
@@ -918,13 +917,8 @@ struct StmtList : Stmt
             first(first),
             second(second) {}
             
-    virtual void DoStmtResources(SymbolTable* st)
-    {
-        if (first) first->CalculateResources(st);
-        if (second) second->CalculateResources(st);
-    }
-    
-    virtual Instr* DoStmtCodeGen();
+    virtual void DoStmtResources(SymbolTable* st);
+    virtual InstrList DoStmtCodeGen();
     
     Stmt* first;
     Stmt* second;
@@ -937,7 +931,7 @@ struct EmptyStmt : Stmt
     EmptyStmt(CompileState* s) : Stmt(s, Stmt::STMT_empty) {}
     
     virtual void DoStmtResources(SymbolTable* st) {}
-    Instr* DoStmtCodeGen();
+    InstrList DoStmtCodeGen();
 };
 
 ////////////////////////////////////////////// ExprStmt ////////////////////////////////////////////
@@ -947,7 +941,7 @@ struct ExprStmt : Stmt
     ExprStmt(CompileState* s, ExprList* expr) : Stmt(s, Stmt::STMT_expr), exprList(expr), autopop(true) {}
     
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     ExprList* exprList;
     bool autopop;
@@ -960,7 +954,7 @@ struct CtrlStmt : Stmt
     CtrlStmt(CompileState* s, ExprList* el, Stmt::Kind kd) : Stmt(s, kd), exprs(el), count(0), isInTry(false) {}
     
     virtual void    DoStmtResources(SymbolTable* st);
-    virtual Instr*  DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     INLINE Opcode GetNullOp() {
         switch (kind) {
@@ -997,7 +991,7 @@ struct LoopStmt : LoopingStmt
     LoopStmt(CompileState* s, Stmt *body) : LoopingStmt(s, Stmt::STMT_loop), body(body) {}
     
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     Stmt* body;
 };
@@ -1014,7 +1008,7 @@ struct CondLoopStmt : LoopingStmt
             until(until) {}
             
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     Expr* cond;
     Stmt* body;
@@ -1037,10 +1031,8 @@ struct ForToStmt : LoopingStmt
             symbol(0),
             symtab(0) {}
     
-    virtual ~ForToStmt();
-    
     virtual void   DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     Id*          id;
     Expr*        from;
@@ -1061,19 +1053,18 @@ struct ForeachStmt : LoopingStmt
             type_expr(type_expr),
             in(in),
             body(body),
+            numVars(0),
             symtab(0) {}
     
-    virtual ~ForeachStmt();
-    
     virtual void   DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     size_t iter_offset;
     Id*   id;
     Expr* type_expr;   // The set name that will be enumerated.
     Expr* in;          // The subject.
     Stmt* body;        // Loop body.
-    Buffer<Symbol*> symbols;
+    size_t          numVars; // Number of loop variables.
     SymbolTable*    symtab;
 };
 
@@ -1089,7 +1080,7 @@ struct IfStmt : Stmt
             is_unless(unless) {}
             
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     IfStmt* next;
     Expr* cond;
@@ -1129,7 +1120,7 @@ struct ConditionalStmt : Stmt
         if (elsePart) elsePart->CalculateResources(st);
     }
     
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     IfStmt* ifPart;
     Stmt* elsePart;
@@ -1144,9 +1135,8 @@ struct BlockStmt : Stmt
             stmts(stmts),
             symtab(0) {}
             
-    virtual ~BlockStmt();
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     Stmt* stmts;
     SymbolTable* symtab;
@@ -1160,7 +1150,7 @@ struct DeclStmt : Stmt
     
     virtual void DoStmtResources(SymbolTable* st);
     
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     
     Decl* decl;
 };
@@ -1174,7 +1164,7 @@ struct UnaryExpr : Expr
             expr(expr) {}
             
     virtual void   CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     virtual Opcode GetOpcode() const
     {
@@ -1242,7 +1232,7 @@ struct BinaryExpr : Expr
         };
         return OP_nop;
     }
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     Expr* left;
     Expr* right;
@@ -1264,8 +1254,8 @@ struct IdExpr : Expr
     
     virtual void CalculateResources(SymbolTable* st);
     
-    virtual Instr* GenerateCode();
-    virtual Instr* GenerateCodeSet();
+    virtual InstrList GenerateCode();
+    virtual InstrList GenerateCodeSet();
     
     bool ExplicitWith()   const { return !outerwith && symbol && symbol->isWith;     }
     bool ExplicitGlobal() const { return symbol && symbol->isGlobal;                 }
@@ -1292,7 +1282,7 @@ struct ApplyArg : Expr {
     
     virtual void   CalculateResources(SymbolTable* st) { vararg->CalculateResources(st); }
     
-    virtual Instr* GenerateCode() { return vararg->GenerateCode(); }
+    virtual InstrList GenerateCode() { return vararg->GenerateCode(); }
         
     Expr* vararg;
 };
@@ -1305,7 +1295,7 @@ struct ConstantExpr : Expr
             : Expr(s, k),
             index(0) {}
             
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     u2 index;
 };
@@ -1323,11 +1313,9 @@ struct FunExpr : ConstantExpr
     symtab(0),
     scriptBeg(begtxt),
     scriptEnd(endtxt) {}
-            
-    virtual ~FunExpr();
     
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     ParamDecl* args;
     Id* name;
@@ -1347,7 +1335,7 @@ struct PropExpr : Expr
     setter(setfn) {}
     
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     Expr* nameexpr;
     Expr* getter;
@@ -1376,7 +1364,6 @@ struct StringExpr : ConstantExpr
             string(string),
             length(len) {}
             
-    virtual ~StringExpr();
     virtual void CalculateResources(SymbolTable* st);
     
     char* string;
@@ -1422,8 +1409,8 @@ struct DotExpr : BinaryExpr
     
     virtual void    CalculateResources(SymbolTable* st);
     
-    virtual Instr*  GenerateCode();
-    virtual Instr*  GenerateCodeSet();
+    virtual InstrList GenerateCode();
+    virtual InstrList GenerateCodeSet();
     
     virtual Opcode  GetOpcode() const { return OP_dotget; }
     virtual Opcode  SetOpcode() const { return OP_dotset; } 
@@ -1441,8 +1428,8 @@ struct IndexExpr : DotExpr
     }
     virtual void    CalculateResources(SymbolTable* st);
     
-    virtual Instr*  GenerateCode();
-    virtual Instr*  GenerateCodeSet();    
+    virtual InstrList GenerateCode();
+    virtual InstrList GenerateCodeSet();    
     
     virtual Opcode  GetOpcode() const { return OP_subget; }
     virtual Opcode  SetOpcode() const { return OP_subset; }
@@ -1460,8 +1447,8 @@ struct DotBindExpr : DotExpr
         kind = Expr::EXPR_dotbind; 
     }
     
-    virtual Instr* GenerateCode();
-    virtual Instr* GenerateCodeSet();
+    virtual InstrList GenerateCode();
+    virtual InstrList GenerateCodeSet();
     
     virtual Opcode  GetOpcode() const { return is_index ? OP_subget : OP_dotget; }
     virtual Opcode  SetOpcode() const { return is_index ? OP_subset : OP_dotset; }
@@ -1514,7 +1501,7 @@ struct DictionaryExpr : Expr
     DictionaryExpr(CompileState* s, FieldList* fields) : Expr(s, Expr::EXPR_dictionary), fields(fields) {}
     
     virtual void    CalculateResources(SymbolTable* st);
-    virtual Instr*  GenerateCode();
+    virtual InstrList GenerateCode();
     
     FieldList*  fields;     //!< List of members for this object.
 };
@@ -1529,7 +1516,7 @@ struct ArrayExpr : Expr
     ArrayExpr(CompileState* s, ExprList* elements) : Expr(s, Expr::EXPR_array), numElements(0), elements(elements) {}
     
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     size_t      numElements;    //!< Length of the array.
     ExprList*   elements;       //!< elements of the array.
@@ -1599,9 +1586,9 @@ struct ComprExprStmt : Stmt
     ComprExprStmt(CompileState* s, Expr* expr) : Stmt(s, Stmt::STMT_comprexpr), expr(expr) {}
     
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* PreGenerateCode();
-    virtual Instr* PostGenerateCode();
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList PreGenerateCode();
+    virtual InstrList PostGenerateCode();
+    virtual InstrList DoStmtCodeGen();
     
     Expr* expr;
     size_t localOffset;
@@ -1615,7 +1602,7 @@ struct ArrayComprExpr : Expr
     
     void MakeForLoops();
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     Stmt* stmt;
     ComprExprStmt* body;
@@ -1628,7 +1615,7 @@ struct KeywordExpr : Expr
     virtual ~KeywordExpr() {}
     
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     StringExpr* name;
     Expr* value;
 };
@@ -1708,7 +1695,7 @@ struct AssignmentStmt : Stmt
     AssignmentStmt(CompileState* s, ExprList* l, ExprList* r);
     
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoStmtCodeGen();
     Opcode GetOpcode() const;
     
     AssignKind  kind;
@@ -1727,11 +1714,9 @@ struct UsingStmt : Stmt
 {
     UsingStmt(CompileState* s, Expr* e, Stmt* b);
     
-    virtual ~UsingStmt();
-    
     virtual void DoStmtResources(SymbolTable* st);
-    virtual Instr* DoHeader();
-    virtual Instr* DoStmtCodeGen();
+    virtual InstrList DoHeader();
+    virtual InstrList DoStmtCodeGen();
     
     Expr*           with;
     Stmt*           block;
@@ -1744,9 +1729,8 @@ struct PkgDecl : NamedTarget
 {
     PkgDecl(CompileState* s, NameNode*, Stmt* body, StorageKind sto);
     
-    virtual ~PkgDecl();
     virtual void CalculateResources(SymbolTable* st);
-    virtual Instr* GenerateCode();
+    virtual InstrList GenerateCode();
     
     SymbolTable*    symtab;
     StringExpr*     id;
@@ -1764,8 +1748,8 @@ struct NameNode : Expr
     virtual ~NameNode() {}
     
     virtual void    CalculateResources(SymbolTable* st);
-    virtual Instr*  GenerateCode();
-    virtual Instr*  GenerateCodeSet();
+    virtual InstrList GenerateCode();
+    virtual InstrList GenerateCodeSet();
     const char*     GetName();
     
     Expr* GetSelfExpr() { return dotexpr ? dotexpr->left : 0; }
@@ -1785,10 +1769,8 @@ struct ClassDecl : NamedTarget
             symtab(0)
     {}
     
-    virtual ~ClassDecl();
-    
     virtual void    CalculateResources(SymbolTable* st);
-    virtual Instr*  GenerateCode();
+    virtual InstrList GenerateCode();
     
     StringExpr*     stringid;
     Expr*           super;
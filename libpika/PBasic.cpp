@@ -11,6 +11,10 @@
 #include "PFunction.h"
 #include "PProperty.h"
 #include "PContext.h"
+#include "PString.h"
+#include "PObject.h"
+#include "PPackage.h"
+#include "PType.h"
 
 namespace pika {
     
@@ -66,7 +70,7 @@ bool Basic::GetAttr(Context* ctx, const Value& key, Value& result)
         {
             int calls = 0;
             ctx->Push(ToValue());
-            ctx->DoPropertyGet(calls, result.val.property);
+            ctx->DoPropertyGet(calls, result.GetProperty());
             if (calls > 0)
                 ctx->Run();
             result = ctx->PopTop();
@@ -86,7 +90,7 @@ bool Basic::SetAttr(Context* ctx, const Value& key, Value& value, u4 attr)
             ctx->CheckStackSpace(3);
             ctx->Push(key);
             ctx->Push(ToValue());
-            ctx->DoPropertySet(result.val.property);
+            ctx->DoPropertySet(result.GetProperty());
             return true;
         }
         else
@@ -129,8 +133,8 @@ void Basic::WriteBarrier(GCObject* gc_obj)
 
 void Basic::WriteBarrier(const Value& v)
 {
-    if (v.IsCollectible() && v.val.basic)    
-        engine->GetGC()->WriteBarrier(this, v.val.basic);    
+    if (v.IsCollectible() && v.GetBasic())    
+        engine->GetGC()->WriteBarrier(this, v.GetBasic());    
 }
 
 ClassInfo* Basic::StaticCreateClass()
@@ -142,5 +146,16 @@ ClassInfo* Basic::StaticCreateClass()
 
 ClassInfo* Basic::GetClassInfo() { return StaticGetClass(); }
 
+const char* Basic::GetGCName() const
+{
+    Type* type = GetType();
+    if (type)
+    {
+        if (String* name = type->GetName())
+            return name->GetBuffer();
+    }
+    return const_cast<Basic*>(this)->GetClassInfo()->GetName();
+}
+
 }// pika
 
@@ -46,6 +46,9 @@ public:
     virtual ClassInfo* GetClassInfo();
     static  ClassInfo* StaticCreateClass();
     
+    /** Returns the name of the object's Type, or its ClassInfo if it has no Type. */
+    virtual const char* GetGCName() const;
+    
     static  void EnterConstants(Basic*, NamedConstant*, size_t);
     
     /** Returns the Type for this Basic Object.
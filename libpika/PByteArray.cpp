@@ -89,6 +89,7 @@ ByteArray::ByteArray(const ByteArray* rhs) :
     pos(rhs->pos),
     buffer(rhs->buffer)
 {
+    engine->GetGC()->ChargeExternal(0, buffer.GetCapacity());
 }
 
 Object* ByteArray::Clone()
@@ -103,8 +104,7 @@ Iterator* ByteArray::Iterate(String* iter_type)
     if (iter_type == engine->emptyString)
     {
         Iterator* e = 0;
-        PIKA_NEW(ByteArrayIterator, e, (engine, engine->Iterator_Type, this));
-        engine->AddToGC(e);
+        GCNEW(engine, ByteArrayIterator, e, (engine, engine->Iterator_Type, this));
         return e;
     }
     return ThisSuper::Iterate(iter_type);
@@ -112,6 +112,11 @@ Iterator* ByteArray::Iterate(String* iter_type)
 
 ByteArray::~ByteArray() {}
 
+size_t ByteArray::GetExternalBytes() const
+{
+    return ThisSuper::GetExternalBytes() + buffer.GetCapacity();
+}
+
 void ByteArray::Rewind() { pos = 0; }
 
 void ByteArray::SetPosition(pint_t p)
@@ -142,7 +147,7 @@ bool ByteArray::GetSlot(const Value& key, Value& res)
 {
     if (key.IsInteger())
     {
-        pint_t index = key.val.integer;
+        pint_t index = key.GetInteger();
         if (index >= 0 && index < (pint_t)buffer.GetSize())
         {
             res.Set((pint_t)buffer[index]);
@@ -160,34 +165,34 @@ bool ByteArray::SetSlot(const Value& key, Value& value, u4 attr)
 {
     if (key.IsInteger())
     {
-        switch (value.tag)
+        switch (value.GetTag())
         {
         case TAG_null:
         {
-            pint_t index = key.val.integer;
+            pint_t index = key.GetInteger();
             SetPosition(index);
             WriteByte(0x00);
             return true;
         }
         case TAG_boolean:
         {
-            pint_t index = key.val.integer;
+            pint_t index = key.GetInteger();
             SetPosition(index);
-            WriteByte(value.val.index ? 0x01 : 0x00);
+            WriteByte(value.GetIndex() ? 0x01 : 0x00);
             return true;
         }
         case TAG_integer:
         {
-            pint_t index = key.val.integer;
+            pint_t index = key.GetInteger();
             SetPosition(index);
-            WriteByte((u1)(value.val.integer & 0xFF));
+            WriteByte((u1)(value.GetInteger() & 0xFF));
             return true;
         }
         case TAG_string:
         {
-            pint_t index = key.val.integer;
+            pint_t index = key.GetInteger();
             SetPosition(index);
-            WriteString(value.val.str, false);
+            WriteString(value.GetString(), false);
             return true;
         }
         default:
@@ -331,6 +336,7 @@ u8 ByteArray::ReadQword()
 void ByteArray::InitializeWith(u1* v, size_t l)
 {
     ASSERT(v);
+    GCCHARGE(engine, this);
     buffer.Resize(l);
     Pika_memcpy(buffer.GetAt(0), v, l);
     pos = 0;
@@ -359,6 +365,8 @@ void ByteArray::SetLength(ssize_t s)
     
     size_t sz  = s;
     size_t len = buffer.GetSize();
+    
+    GCCHARGE(engine, this);
     buffer.SmartResize(sz);
     
     if (sz > len)
@@ -465,13 +473,13 @@ preal_t ByteArray::ReadReal()
 
 void ByteArray::Write(Value v)
 {
-    switch (v.tag)
+    switch (v.GetTag())
     {
     case TAG_null:      WriteByte(0);                    break;
-    case TAG_boolean:   WriteBoolean(v.val.index != 0);  break;
-    case TAG_integer:   WriteInteger(v.val.integer);     break;
-    case TAG_real:      WriteReal(v.val.real);           break;
-    case TAG_string:    WriteString(v.val.str, true); break;
+    case TAG_boolean:   WriteBoolean(v.GetIndex() != 0);  break;
+    case TAG_integer:   WriteInteger(v.GetInteger());     break;
+    case TAG_real:      WriteReal(v.GetReal());           break;
+    case TAG_string:    WriteString(v.GetString(), true); break;
     default:
         RaiseException("Attempt to write unsupported type");
     }
@@ -489,6 +497,8 @@ void ByteArray::SmartResize(size_t sizeneeded)
             size_t newcap = Max<size_t>(cap_2, sizeneeded);
             if (newcap >= PIKA_BUFFER_MAX_LEN)
                 RaiseException("Maximum ByteArray length reached.");
+            
+            GCCHARGE(engine, this);
             buffer.SetCapacity(newcap);
         }
     }
@@ -531,6 +541,7 @@ void ByteArray::WriteByte(u1 u)
 {
     if (pos == buffer.GetSize())
     {
+        GCCHARGE(engine, this);
         buffer.Push(u);
     }
     buffer[pos++] = u;
@@ -586,7 +597,7 @@ void ByteArray::Init(Context* ctx)
         Value& arg0 = ctx->GetArg(0);        
         if (arg0.IsInteger())
         {
-            pint_t i = arg0.val.integer;
+            pint_t i = arg0.GetInteger();
             SetLength(i);
         }
         else
@@ -625,7 +636,7 @@ Object* ByteArray::Slice(pint_t from, pint_t to)
 
 int ByteArray_nextBytes(Context* ctx, Value& self)
 {
-    ByteArray* ba = static_cast<ByteArray*>(self.val.object);
+    ByteArray* ba = static_cast<ByteArray*>(self.GetObject());
     pint_t nbytes = ctx->GetIntArg(0);
     if (nbytes > PIKA_MAX_RETC)
     {
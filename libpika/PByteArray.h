@@ -37,6 +37,7 @@ public:
     virtual Object*     Clone();
     virtual Iterator*   Iterate(String*);
     virtual String*     ToString();
+    virtual size_t      GetExternalBytes() const;
     
     virtual bool   SetSlot(const Value& key, Value& value, u4 attr = 0);
     virtual bool   GetSlot(const Value& key, Value& res);
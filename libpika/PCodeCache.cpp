@@ -0,0 +1,662 @@
+/*
+ *  PCodeCache.cpp
+ *  See Copyright Notice in Pika.h
+ */
+#include "Pika.h"
+#include "PPlatform.h"
+#include "PCodeCache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace pika {
+
+namespace {
+
+/* Layout of a compiled script. Values are written in the byte order of the machine,
+ * which is recorded in the header.
+ *
+ * Header:
+ *  magic "PIKC", version, byte order mark, sizes of pint_t, preal_t and code_t, optimization level,
+ *  opcode count, source time, source size, source hash, payload length, payload hash.
+ *
+ * Payload:
+ *  literal count, literals, index of the entry point's Def, then one record for each Def literal.
+ *
+ * A Def's source code is normally a span of the script's source, in which case only its offset 
+ * and length are stored.
+ */
+const u1 CODE_CACHE_MAGIC[4]  = { 'P', 'I', 'K', 'C' };
+const u4 CODE_CACHE_ORDER     = 0x01020304;
+const u4 CODE_CACHE_NONE      = 0xFFFFFFFF; // Null string or missing parent.
+const u4 CODE_CACHE_INLINE    = 0xFFFFFFFE; // Def source stored as a string.
+
+enum LiteralKind
+{
+    LK_integer = 'i',
+    LK_real    = 'r',
+    LK_string  = 's',
+    LK_def     = 'd',
+};
+
+enum CachedDefFlags
+{
+    CDF_mustClose   = PIKA_BITFLAG(0),
+    CDF_varArg      = PIKA_BITFLAG(1),
+    CDF_keyword     = PIKA_BITFLAG(2),
+    CDF_strict      = PIKA_BITFLAG(3),
+    CDF_generator   = PIKA_BITFLAG(4),
+};
+
+// 64 bit FNV-1a.
+u8 HashBytes(const u1* bytes, size_t len)
+{
+    u8 hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+struct CodeWriter
+{
+    template<typename T>
+    void Put(const T& t) { PutBytes(&t, sizeof(T)); }
+
+    void PutBytes(const void* v, size_t len)
+    {
+        const u1* bytes = (const u1*)v;
+        for (size_t i = 0; i < len; ++i)
+            out.Push(bytes[i]);
+    }
+
+    void PutString(String* str)
+    {
+        if (!str)
+        {
+            Put(CODE_CACHE_NONE);
+            return;
+        }
+        Put((u4)str->GetLength());
+        PutBytes(str->GetBuffer(), str->GetLength());
+    }
+
+    Buffer<u1> out;
+};
+
+struct CodeReader
+{
+    CodeReader(const u1* buff, size_t len) : pos(buff), end(buff + len), ok(true) {}
+
+    template<typename T>
+    bool Get(T& t) { return GetBytes(&t, sizeof(T)); }
+
+    bool GetBytes(void* v, size_t len)
+    {
+        if (!ok || (size_t)(end - pos) < len)
+            return ok = false;
+        Pika_memcpy(v, pos, len);
+        pos += len;
+        return true;
+    }
+
+    bool GetString(Engine* eng, String*& str)
+    {
+        u4 len = 0;
+        str = 0;
+        if (!Get(len))
+            return false;
+        if (len == CODE_CACHE_NONE)
+            return true;
+        if ((size_t)(end - pos) < len)
+            return ok = false;
+        str = eng->AllocString((const char*)pos, len);
+        pos += len;
+        return true;
+    }
+
+    const u1* pos;
+    const u1* end;
+    bool      ok;
+};
+
+bool FileHasExt(const char* path, size_t len, const char* ext)
+{
+    size_t extlen = strlen(ext);
+    return len >= extlen && strcmp(path + len - extlen, ext) == 0;
+}
+
+// Determines where the compiled version of the script at path is stored. Call Pika_free on the result.
+char* GetCachePath(const char* path, size_t len)
+{
+    const char* ext     = PIKA_COMPILED_EXT;
+    size_t      baselen = len;
+
+    if (FileHasExt(path, len, PIKA_EXT))
+    {
+        baselen -= strlen(PIKA_EXT);
+    }
+    else if (FileHasExt(path, len, PIKA_EXT_ALT))
+    {
+        baselen -= strlen(PIKA_EXT_ALT);
+        ext = PIKA_COMPILED_EXT_ALT;
+    }
+
+    const char* dir = getenv(PIKA_COMPILED_DIR_ENV);
+    char*       res = 0;
+
+    if (dir && *dir)
+    {
+        // Scripts with the same name can live in different directories so the full path is hashed.
+        const char* base = Pika_rindex(path, PIKA_PATH_SEP_CHAR);
+        base = base ? base + 1 : path;
+
+        char   hash[20] = { 0 };
+        size_t dirlen   = strlen(dir);
+        size_t namelen  = baselen - (base - path);
+
+        Pika_snprintf(hash, sizeof(hash), "-%08x", (unsigned)(HashBytes((const u1*)path, len) & 0xFFFFFFFF));
+
+        size_t reslen = dirlen + 1 + namelen + strlen(hash) + strlen(ext);
+        res = (char*)Pika_malloc(reslen + 1);
+        Pika_snprintf(res, reslen + 1, "%s%s%.*s%s%s", dir, PIKA_PATH_SEP, (int)namelen, base, hash, ext);
+    }
+    else
+    {
+        size_t reslen = baselen + strlen(ext);
+        res = (char*)Pika_malloc(reslen + 1);
+        Pika_snprintf(res, reslen + 1, "%.*s%s", (int)baselen, path, ext);
+    }
+    return res;
+}
+
+}// namespace
+
+CodeCache::CodeCache(Engine* eng, String* sourcePath, const char* source, size_t length)
+    : engine(eng),
+    source(source),
+    length(length),
+    cachePath(0),
+    sourceTime(0),
+    sourceSize(0),
+    sourceHash(0)
+{
+    if (Pika_GetFileStamp(sourcePath->GetBuffer(), &sourceTime, &sourceSize))
+    {
+        cachePath  = GetCachePath(sourcePath->GetBuffer(), sourcePath->GetLength());
+        sourceHash = HashBytes((const u1*)source, length);
+    }
+}
+
+CodeCache::~CodeCache()
+{
+    if (cachePath)
+        Pika_free(cachePath);
+}
+
+const char* CodeCache::FindSource(Def* def)
+{
+    const char* text = def->source->GetBuffer();
+    size_t      len  = def->source->GetLength();
+    
+    if (len == 0 || len > length)
+        return 0;
+    
+    // The source of a function starts on the line it is declared so begin the search there.
+    const char* curr = source;
+    const char* end  = source + length - len;
+    
+    for (int line = 1; line < def->line && curr < end; ++curr)
+    {
+        if (*curr == '\n')
+            ++line;
+    }
+    
+    for (; curr <= end; ++curr)
+    {
+        if (*curr == *text && memcmp(curr, text, len) == 0)
+            return curr;
+    }
+    return 0;
+}
+
+bool CodeCache::IsEnabled()
+{
+    return getenv(PIKA_COMPILED_DISABLE_ENV) == 0;
+}
+
+Def* CodeCache::Read(LiteralPool*& literals)
+{
+    literals = 0;
+    if (!cachePath)
+        return 0;
+
+    FILE* file = fopen(cachePath, "rb");
+    if (!file)
+        return 0;
+
+    Buffer<u1> contents;
+    long len = -1;
+
+    if (fseek(file, 0, SEEK_END) == 0 && (len = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        contents.Resize((size_t)len);
+        if (fread(contents.GetAt(0), 1, (size_t)len, file) != (size_t)len)
+            len = -1;
+    }
+    fclose(file);
+
+    if (len <= 0)
+        return 0;
+
+    // Header.
+
+    CodeReader in(contents.GetAt(0), contents.GetSize());
+    u1 magic[4];
+    u4 version = 0, order = 0, opcodes = 0, payloadLength = 0;
+    u1 intSize = 0, realSize = 0, codeSize = 0, optLevel = 0;
+    u8 time = 0, size = 0, hash = 0, payloadHash = 0;
+
+    in.GetBytes(magic, sizeof(magic));
+    in.Get(version);
+    in.Get(order);
+    in.Get(intSize);
+    in.Get(realSize);
+    in.Get(codeSize);
+    in.Get(optLevel);
+    in.Get(opcodes);
+    in.Get(time);
+    in.Get(size);
+    in.Get(hash);
+    in.Get(payloadLength);
+    in.Get(payloadHash);
+
+    if (!in.ok                                              ||
+        memcmp(magic, CODE_CACHE_MAGIC, sizeof(magic)) != 0 ||
+        version  != PIKA_COMPILED_VERSION                   ||
+        order    != CODE_CACHE_ORDER                        ||
+        intSize  != sizeof(pint_t)                          ||
+        realSize != sizeof(preal_t)                         ||
+        codeSize != sizeof(code_t)                          ||
+        optLevel != engine->GetOptimizeLevel()              ||
+        opcodes  != OPCODE_MAX                              ||
+        time     != sourceTime                              ||
+        size     != sourceSize                              ||
+        hash     != sourceHash                              ||
+        payloadLength != (size_t)(in.end - in.pos)          ||
+        payloadHash   != HashBytes(in.pos, payloadLength))
+    {
+        return 0;
+    }
+
+    // Literals.
+
+    GCPAUSE_NORUN(engine);
+
+    LiteralPool* lp = LiteralPool::Create(engine);
+    u4 count = 0;
+
+    if (!in.Get(count) || count > PIKA_MAX_LITERALS)
+        return 0;
+
+    for (u4 i = 0; i < count; ++i)
+    {
+        u1 kind = 0;
+        if (!in.Get(kind))
+            return 0;
+
+        switch (kind)
+        {
+        case LK_integer:
+        {
+            pint_t integer = 0;
+            if (!in.Get(integer))
+                return 0;
+            lp->Add(integer);
+            break;
+        }
+        case LK_real:
+        {
+            preal_t real = 0;
+            if (!in.Get(real))
+                return 0;
+            lp->Add(real);
+            break;
+        }
+        case LK_string:
+        {
+            String* str = 0;
+            if (!in.GetString(engine, str) || !str)
+                return 0;
+            lp->Add(str);
+            break;
+        }
+        case LK_def:
+        {
+            // Filled in below, once every Def a parent could refer to exists.
+            Value def(Def::Create(engine));
+            lp->Add(def);
+            break;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    u4 entry = 0;
+    if (!in.Get(entry) || entry >= count || !lp->Get((u2)entry).IsFunction())
+        return 0;
+
+    // Defs.
+
+    Collector* gc = engine->GetGC();
+
+    for (u4 i = 0; i < count; ++i)
+    {
+        if (!lp->Get((u2)i).IsFunction())
+            continue;
+
+        Def* def = lp->Get((u2)i).GetDef();
+        u4   parent = 0, bytecodeLength = 0, lineCount = 0, localCount = 0;
+        u1   flags = 0;
+
+        in.Get(parent);
+        in.GetString(engine, def->name);
+        u4 sourceOffset = 0;
+        if (!in.Get(sourceOffset))
+            return 0;
+        
+        if (sourceOffset == CODE_CACHE_INLINE)
+        {
+            in.GetString(engine, def->source);
+        }
+        else if (sourceOffset != CODE_CACHE_NONE)
+        {
+            u4 sourceLength = 0;
+            if (!in.Get(sourceLength) || sourceOffset > length || sourceLength > length - sourceOffset)
+                return 0;
+            def->source = engine->AllocString(source + sourceOffset, sourceLength);
+        }
+        in.Get(def->line);
+        in.Get(def->numArgs);
+        in.Get(def->numLocals);
+        in.Get(def->stackLimit);
+        in.Get(flags);
+
+        if (!in.Get(bytecodeLength) || bytecodeLength == 0 || bytecodeLength > 0xFFFF)
+            return 0;
+
+        Buffer<code_t> bytecode;
+        bytecode.Resize(bytecodeLength);
+        if (!in.GetBytes(bytecode.GetAt(0), bytecodeLength * sizeof(code_t)))
+            return 0;
+
+        for (u4 b = 0; b < bytecodeLength; ++b)
+        {
+            if (PIKA_GET_OPCODEOF(bytecode[b]) >= OPCODE_MAX)
+                return 0;
+        }
+
+        if (parent != CODE_CACHE_NONE)
+        {
+            if (parent >= count || !lp->Get((u2)parent).IsFunction())
+                return 0;
+            def->parent = lp->Get((u2)parent).GetDef();
+        }
+
+        def->literals    = lp;
+        def->mustClose   = (flags & CDF_mustClose) != 0;
+        def->isVarArg    = (flags & CDF_varArg)    != 0;
+        def->isKeyword   = (flags & CDF_keyword)   != 0;
+        def->isStrict    = (flags & CDF_strict)    != 0;
+        def->isGenerator = (flags & CDF_generator) != 0;
+        def->SetBytecode(bytecode.GetAt(0), (u2)bytecodeLength);
+
+        // Line info.
+
+        if (!in.Get(lineCount))
+            return 0;
+
+        for (u4 l = 0; l < lineCount; ++l)
+        {
+            LineInfo li;
+            u4 offset = 0;
+            if (!in.Get(li.line) || !in.Get(offset) || offset > bytecodeLength)
+                return 0;
+            li.pos = def->GetBytecode() + offset;
+            def->lineInfo.Push(li);
+        }
+
+        // Local variable info.
+
+        if (!in.Get(localCount))
+            return 0;
+
+        for (u4 v = 0; v < localCount; ++v)
+        {
+            LocalVarInfo lv;
+            s8 beg = 0, end = 0;
+            u1 type = 0;
+
+            if (!in.GetString(engine, lv.name) || !in.Get(beg) || !in.Get(end) || !in.Get(type))
+                return 0;
+
+            lv.beg  = (ptrdiff_t)beg;
+            lv.end  = (ptrdiff_t)end;
+            lv.type = (ELocalVarType)type;
+            def->localsInfo.Push(lv);
+
+            if (lv.name)
+            {
+                gc->WriteBarrier(def, lv.name);
+            }
+
+            if (lv.type == LVT_parameter && lv.name)
+            {
+                // Same as Def::AddLocalVar.
+                Value vname(lv.name);
+                Value index((pint_t)v);
+                def->kwargs.Set(vname, index);
+            }
+        }
+
+        if (!in.ok)
+            return 0;
+
+        if (def->name)   gc->WriteBarrier(def, def->name);
+        if (def->source) gc->WriteBarrier(def, def->source);
+        if (def->parent) gc->WriteBarrier(def, def->parent);
+        gc->WriteBarrier(def, lp);
+    }
+
+    if (in.pos != in.end)
+        return 0;
+
+    literals = lp;
+    return lp->Get((u2)entry).GetDef();
+}
+
+bool CodeCache::Write(Def* entryDef, LiteralPool* literals)
+{
+    if (!cachePath || !entryDef || !literals)
+        return false;
+
+    // Payload.
+
+    CodeWriter payload;
+    size_t     count = literals->GetSize();
+    u4         entry = CODE_CACHE_NONE;
+
+    payload.Put((u4)count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Value& v = literals->Get((u2)i);
+
+        if (v.IsInteger())
+        {
+            payload.Put((u1)LK_integer);
+            payload.Put(v.GetInteger());
+        }
+        else if (v.IsReal())
+        {
+            payload.Put((u1)LK_real);
+            payload.Put(v.GetReal());
+        }
+        else if (v.IsString())
+        {
+            payload.Put((u1)LK_string);
+            payload.PutString(v.GetString());
+        }
+        else if (v.IsFunction())
+        {
+            Def* def = v.GetDef();
+
+            // Every Def must share the script's LiteralPool and have been compiled.
+            if (def->literals != literals || !def->bytecode || def->nativecode)
+                return false;
+
+            if (def == entryDef)
+                entry = (u4)i;
+            payload.Put((u1)LK_def);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if (entry == CODE_CACHE_NONE)
+        return false;
+
+    payload.Put(entry);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Value& v = literals->Get((u2)i);
+        if (!v.IsFunction())
+            continue;
+
+        Def* def    = v.GetDef();
+        u4   parent = CODE_CACHE_NONE;
+        u1   flags  = 0;
+
+        if (def->parent)
+        {
+            for (size_t p = 0; p < count; ++p)
+            {
+                if (literals->Get((u2)p).IsFunction() && literals->Get((u2)p).GetDef() == def->parent)
+                {
+                    parent = (u4)p;
+                    break;
+                }
+            }
+            if (parent == CODE_CACHE_NONE)
+                return false;
+        }
+
+        if (def->mustClose)   flags |= CDF_mustClose;
+        if (def->isVarArg)    flags |= CDF_varArg;
+        if (def->isKeyword)   flags |= CDF_keyword;
+        if (def->isStrict)    flags |= CDF_strict;
+        if (def->isGenerator) flags |= CDF_generator;
+
+        payload.Put(parent);
+        payload.PutString(def->name);
+        
+        if (!def->source)
+        {
+            payload.Put(CODE_CACHE_NONE);
+        }
+        else if (const char* span = FindSource(def))
+        {
+            payload.Put((u4)(span - source));
+            payload.Put((u4)def->source->GetLength());
+        }
+        else
+        {
+            payload.Put(CODE_CACHE_INLINE);
+            payload.PutString(def->source);
+        }
+        payload.Put(def->line);
+        payload.Put(def->numArgs);
+        payload.Put(def->numLocals);
+        payload.Put(def->stackLimit);
+        payload.Put(flags);
+
+        u4 bytecodeLength = def->bytecode->length;
+        payload.Put(bytecodeLength);
+        payload.PutBytes(def->bytecode->code, bytecodeLength * sizeof(code_t));
+
+        payload.Put((u4)def->lineInfo.GetSize());
+        for (size_t l = 0; l < def->lineInfo.GetSize(); ++l)
+        {
+            payload.Put(def->lineInfo[l].line);
+            payload.Put((u4)(def->lineInfo[l].pos - def->GetBytecode()));
+        }
+
+        payload.Put((u4)def->localsInfo.GetSize());
+        for (size_t l = 0; l < def->localsInfo.GetSize(); ++l)
+        {
+            const LocalVarInfo& lv = def->localsInfo[l];
+            payload.PutString(lv.name);
+            payload.Put((s8)lv.beg);
+            payload.Put((s8)lv.end);
+            payload.Put((u1)lv.type);
+        }
+    }
+
+    // Header.
+
+    CodeWriter header;
+    size_t     payloadLength = payload.out.GetSize();
+
+    header.PutBytes(CODE_CACHE_MAGIC, sizeof(CODE_CACHE_MAGIC));
+    header.Put((u4)PIKA_COMPILED_VERSION);
+    header.Put(CODE_CACHE_ORDER);
+    header.Put((u1)sizeof(pint_t));
+    header.Put((u1)sizeof(preal_t));
+    header.Put((u1)sizeof(code_t));
+    header.Put((u1)engine->GetOptimizeLevel());
+    header.Put((u4)OPCODE_MAX);
+    header.Put(sourceTime);
+    header.Put(sourceSize);
+    header.Put(sourceHash);
+    header.Put((u4)payloadLength);
+    header.Put(HashBytes(payload.out.GetAt(0), payloadLength));
+
+    // Write to a temporary file first so that a reader never sees a partial file. The name is
+    // unique to this process and Engine so that concurrent writers of the same cache do not
+    // write into each other's file.
+
+    size_t tmplen  = strlen(cachePath) + 48;
+    char*  tmpPath = (char*)Pika_malloc(tmplen);
+    Pika_snprintf(tmpPath, tmplen, "%s.%lu.%lx.tmp", cachePath,
+                  (unsigned long)Pika_ProcessId(), (unsigned long)(size_t)engine);
+
+    bool  written = false;
+    FILE* file    = fopen(tmpPath, "wb");
+
+    if (file)
+    {
+        written = fwrite(header.out.GetAt(0),  1, header.out.GetSize(), file) == header.out.GetSize() &&
+                  fwrite(payload.out.GetAt(0), 1, payloadLength,        file) == payloadLength;
+        written = (fclose(file) == 0) && written;
+        
+        // rename replaces an existing file atomically on POSIX systems but fails on Windows.
+        if (written && rename(tmpPath, cachePath) != 0)
+        {
+            remove(cachePath);
+            written = rename(tmpPath, cachePath) == 0;
+        }
+
+        if (!written)
+            remove(tmpPath);
+    }
+    Pika_free(tmpPath);
+    return written;
+}
+
+}// pika
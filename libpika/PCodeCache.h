@@ -0,0 +1,63 @@
+/*
+ *  PCodeCache.h
+ *  See Copyright Notice in Pika.h
+ */
+#ifndef PIKA_CODECACHE_HEADER
+#define PIKA_CODECACHE_HEADER
+
+namespace pika {
+
+class Def;
+class Engine;
+class LiteralPool;
+class String;
+
+///////////////////////////////////////////// CodeCache ////////////////////////////////////////////
+
+/** Reads and writes compiled scripts so that an import can skip parsing and code generation.
+  *
+  * A compiled script holds the LiteralPool of the script along with every Def in it: bytecode, line
+  * info, local variable info and the Def's parent. It is stored next to the source file with the
+  * PIKA_COMPILED_EXT extension, or in the directory named by the environment variable 
+  * PIKA_COMPILED_DIR_ENV. The header records the size, modification time and hash of the source 
+  * so a compiled script is only used while the source is unchanged, along with the optimization
+  * level it was compiled at. Any mismatch or damage causes the file to be ignored and the script to
+  * be compiled from source.
+  */
+class PIKA_API CodeCache
+{
+public:
+    CodeCache(Engine* eng, String* sourcePath, const char* source, size_t length);
+    ~CodeCache();
+    
+    /** Loads the compiled script.
+      *
+      * @param  literals [out] The script's LiteralPool.
+      * @result The script's entry point or null if the compiled script is missing or invalid.
+      */
+    Def* Read(LiteralPool*& literals);
+    
+    /** Writes the compiled script. 
+      *
+      * @result True if the file was written.
+      */
+    bool Write(Def* entry, LiteralPool* literals);
+    
+    /** Returns false if the environment variable PIKA_COMPILED_DISABLE_ENV is set. */
+    static bool IsEnabled();
+private:
+    /** Returns the position of def's source code in the script's source or null if it is not found. */
+    const char* FindSource(Def* def);
+    
+    Engine*     engine;
+    const char* source;     //!< Source of the script.
+    size_t      length;     //!< Length of source.
+    char*       cachePath;  //!< Path of the compiled script, null if it could not be determined.
+    u8          sourceTime; //!< Modification time of the source.
+    u8          sourceSize; //!< Size of the source in bytes.
+    u8          sourceHash; //!< Hash of the source's contents.
+};
+
+}// pika
+
+#endif
@@ -3,68 +3,29 @@
  *  See Copyright Notice in Pika.h
  */
 #include "Pika.h"
+#include "PPlatform.h"
+#include "PHashGroup.h"
 
 #define STILL_ITERATING() (!b || NextIteration())
 
 namespace pika {
 
-void GCObject::Unlink()
-{
-    if (gcprev) gcprev->gcnext = gcnext;
-    if (gcnext) gcnext->gcprev = gcprev;
-    
-    gcprev = gcnext = 0;
-}
-
-void GCObject::InsertAfter(GCObject* c)
-{
-    gccolor = c->gccolor;
-    
-    if (c->gcnext)
-    {
-        gcprev = c;
-        gcnext = c->gcnext;
-        c->gcnext->gcprev = this;
-        c->gcnext = this;
-    }
-    else
-    {
-        gcnext = 0;
-        gcprev = c;
-        c->gcnext = this;
-    }
-}
-
-void GCObject::InsertBefore(GCObject* c)
+void GCObject::Mark(Collector* c)
 {
-    if (c->gcprev)
-    {
-        gccolor = c->gcprev->gccolor;
-        gcprev  = c->gcprev;
-        gcnext  = c;
-        c->gcprev->gcnext = this;
-        c->gcprev = this;
-    }
-    else
+    if (c->mode != Collector::MARK_full)
     {
-        gcprev = 0;
-        gcnext = c;
-        c->gcprev = this;
+        c->MarkOther(this);
     }
-}
-
-void GCObject::Mark(Collector* c)
-{
-    if (gccolor == c->whites->gccolor)
+    else if (c->marking)
     {
-        Unlink();
-        InsertAfter(c->scan);
-        MarkRefs(c);
+        c->Shade(this);
     }
 }
 
 void GCObject::MarkRefs(Collector*) { }
 
+const char* GCObject::GetGCName() const { return "GCObject"; }
+
 bool GCObject::Finalize() { return true; }
 
 ////////////////////////////////// RootObject //////////////////////////////////
@@ -129,29 +90,538 @@ protected:
     GCObject*    gcobj;
 };
 
+////////////////////////////////// GCMarker ////////////////////////////////////
+
+/** The work stealing deque of one mark thread. The owner pushes and pops objects at the back, 
+  * which is kept private so that it needs no locking. Whenever the shared front is empty the 
+  * owner moves the oldest half of its objects there for other threads to steal. The shared 
+  * part is guarded by a spin lock.
+  */
+class GCMarker
+{
+public:
+    enum
+    {
+        SHARE_MIN = 64, //!< Fewest private objects before any are shared.
+    };
+    
+    GCMarker(GCMarkPool* p, size_t i) : pool(p), thread(0), index(i), head(0), count(0), lock(0) {}
+    
+    INLINE void Push(GCObject* c)
+    {
+        local.Push(c);
+        if (!count && local.GetSize() >= SHARE_MIN)
+            Share();
+    }
+    
+    INLINE GCObject* Pop()
+    {
+        if (!local.GetSize() && !StealFrom(this))
+            return 0;
+        GCObject* c = local.Back();
+        local.Pop();
+        return c;
+    }
+    
+    /** Moves up to half the shared objects of victim, which can be this marker, into the 
+      * private part of this deque.
+      */
+    bool StealFrom(GCMarker* victim)
+    {
+        if (!victim->count)
+            return false;
+        
+        victim->Lock();
+        size_t amt = (victim->count + 1) / 2;
+        for (size_t i = 0; i < amt; ++i)
+        {
+            local.Push(victim->shared[victim->head++]);
+        }
+        if (!(victim->count -= amt))
+        {
+            victim->shared.Clear();
+            victim->head = 0;
+        }
+        victim->Unlock();
+        return amt != 0;
+    }
+    
+    INLINE bool HasWork() const { return count != 0; }
+    
+    GCMarkPool*  pool;
+    Pika_Thread* thread;
+    size_t       index;  //!< Position in GCMarkPool::markers.
+private:
+    INLINE void Lock()   { while (!Pika_CompareAndSwap(&lock, 0, 1)) Pika_YieldThread(); }
+    INLINE void Unlock() { Pika_CompareAndSwap(&lock, 1, 0); }
+    
+    /** Moves the oldest half of the private objects to the shared part. */
+    void Share()
+    {
+        size_t amt = local.GetSize() / 2;
+        
+        Lock();
+        for (size_t i = 0; i < amt; ++i)
+            shared.Push(local[i]);
+        count += amt;
+        Unlock();
+        
+        Pika_memmove(local.GetAt(0), local.GetAt(amt), (local.GetSize() - amt) * sizeof(GCObject*));
+        local.Resize(local.GetSize() - amt);
+    }
+    
+    Buffer<GCObject*> local;  //!< Private objects, only used by the owner.
+    Buffer<GCObject*> shared; //!< Shared objects, starting at index head.
+    size_t            head;
+    volatile size_t   count;  //!< Objects in shared, can be read without the lock.
+    volatile u4       lock;
+};
+
+////////////////////////////////// GCMarkPool //////////////////////////////////
+
+/** The mark threads used by Collector::ParallelScan. The thread that runs the collector 
+  * always does its share of the work with the first marker, the others wait on a condition 
+  * between scans.
+  */
+class GCMarkPool
+{
+public:
+    GCMarkPool(Collector* c, size_t numThreads);
+    ~GCMarkPool();
+    
+    INLINE size_t GetSize() const { return markers.GetSize(); }
+    
+    /** Hands out the objects Run starts from, round robin. */
+    INLINE void Add(GCObject* c) { markers[next++ % markers.GetSize()]->Push(c); }
+    
+    /** Scans the objects passed to Add and everything they claim, returning when every thread 
+      * has run out of work. 
+      */
+    void Run();
+    
+    /** The marker of the calling thread during Run. */
+    static INLINE GCMarker* Current() { return current; }
+private:
+    static void ThreadMain(void*);
+    
+    /** Scan and steal objects until every marker is out of work. */
+    void Work(GCMarker*);
+    
+    bool AnyWork() const;
+    
+    Collector*        collector;
+    Buffer<GCMarker*> markers;
+    size_t            next;     //!< Marker the next object passed to Add goes to.
+    Pika_Mutex*       mutex;
+    Pika_Condition*   started;  //!< Signaled when round changes or the pool is destroyed.
+    Pika_Condition*   finished; //!< Signaled when the last mark thread finishes a round.
+    size_t            round;
+    size_t            busy;     //!< Mark threads still working on the current round.
+    volatile s4       idle;     //!< Markers out of work.
+    bool              quit;
+    
+    static PIKA_THREAD_LOCAL GCMarker* current;
+};
+
+PIKA_THREAD_LOCAL GCMarker* GCMarkPool::current = 0;
+
+GCMarkPool::GCMarkPool(Collector* c, size_t numThreads)
+        : collector(c),
+        next(0),
+        mutex(Pika_CreateMutex()),
+        started(Pika_CreateCondition()),
+        finished(Pika_CreateCondition()),
+        round(0),
+        busy(0),
+        idle(0),
+        quit(false)
+{
+    GCMarker* first = 0;
+    PIKA_NEW(GCMarker, first, (this, 0));
+    markers.Push(first);
+    
+    for (size_t i = 1; i < numThreads; ++i)
+    {
+        GCMarker* m = 0;
+        PIKA_NEW(GCMarker, m, (this, i));
+        if (!(m->thread = Pika_CreateThread(ThreadMain, m)))
+        {
+            // Carry on with the threads we have.
+            Pika_delete(m);
+            break;
+        }
+        markers.Push(m);
+    }
+}
+
+GCMarkPool::~GCMarkPool()
+{
+    Pika_LockMutex(mutex);
+    quit = true;
+    Pika_BroadcastCondition(started);
+    Pika_UnlockMutex(mutex);
+    
+    for (size_t i = 0; i < markers.GetSize(); ++i)
+    {
+        if (markers[i]->thread)
+            Pika_JoinThread(markers[i]->thread);
+        Pika_delete(markers[i]);
+    }
+    Pika_DestroyCondition(finished);
+    Pika_DestroyCondition(started);
+    Pika_DestroyMutex(mutex);
+}
+
+void GCMarkPool::Run()
+{
+    idle = 0;
+    
+    Pika_LockMutex(mutex);
+    ++round;
+    busy = markers.GetSize() - 1;
+    Pika_BroadcastCondition(started);
+    Pika_UnlockMutex(mutex);
+    
+    Work(markers[0]);
+    
+    Pika_LockMutex(mutex);
+    while (busy)
+        Pika_WaitCondition(finished, mutex);
+    Pika_UnlockMutex(mutex);
+    next = 0;
+}
+
+void GCMarkPool::ThreadMain(void* data)
+{
+    GCMarker*   m    = (GCMarker*)data;
+    GCMarkPool* pool = m->pool;
+    size_t      seen = 0;
+    
+    Pika_LockMutex(pool->mutex);
+    for (;;)
+    {
+        while (seen == pool->round && !pool->quit)
+            Pika_WaitCondition(pool->started, pool->mutex);
+        
+        if (pool->quit)
+            break;
+        seen = pool->round;
+        
+        Pika_UnlockMutex(pool->mutex);
+        pool->Work(m);
+        Pika_LockMutex(pool->mutex);
+        
+        if (!--pool->busy)
+            Pika_SignalCondition(pool->finished);
+    }
+    Pika_UnlockMutex(pool->mutex);
+}
+
+void GCMarkPool::Work(GCMarker* m)
+{
+    const s4 numMarkers = (s4)markers.GetSize();
+    current = m;
+    
+    for (;;)
+    {
+        while (GCObject* c = m->Pop())
+        {
+            c->MarkRefs(collector);
+        }
+        
+        // Steal from the other markers, starting with the next one along.
+        bool found = false;
+        for (size_t i = 1; i < markers.GetSize() && !found; ++i)
+        {
+            size_t pos = (m->index + i) % markers.GetSize();
+            found = m->StealFrom(markers[pos]);
+        }
+        if (found)
+            continue;
+        
+        // A marker only gives up once every marker is idle. Objects are only pushed by busy 
+        // markers so at that point every deque is empty.
+        Pika_AtomicAdd(&idle, 1);
+        for (;;)
+        {
+            if (Pika_AtomicAdd(&idle, 0) == numMarkers)
+            {
+                current = 0;
+                return;
+            }
+            if (AnyWork())
+            {
+                Pika_AtomicAdd(&idle, -1);
+                break;
+            }
+            Pika_YieldThread();
+        }
+    }
+}
+
+bool GCMarkPool::AnyWork() const
+{
+    for (size_t i = 0; i < markers.GetSize(); ++i)
+    {
+        if (markers[i]->HasWork())
+            return true;
+    }
+    return false;
+}
+
+////////////////////////////////// GCSweeper ///////////////////////////////////
+
+/** The sweep thread used for background sweeping. Dead objects are passed to Add by the 
+  * thread running the collector and destroyed by the sweep thread. Their memory is returned 
+  * to the Heap by Reclaim, since only the collector's thread may use the Heap.
+  */
+class GCSweeper
+{
+public:
+    GCSweeper(Heap* h);
+    ~GCSweeper();
+    
+    /** Returns false if the sweep thread could not be started. */
+    INLINE bool IsRunning() const { return thread != 0; }
+    
+    INLINE void Add(GCObject* c)
+    {
+        pendingBytes += heap->SizeOf(c);
+        batch.Push(c);
+        if (batch.GetSize() >= Collector::GC_SWEEP_BATCH)
+            Submit();
+    }
+    
+    /** Hands the current batch to the sweep thread. */
+    void Submit();
+    
+    /** Frees the memory of every object the sweep thread has destroyed. */
+    void Reclaim();
+    
+    /** Waits until every object passed to Add has been destroyed and reclaimed. */
+    void Finish();
+    
+    /** Bytes held by objects passed to Add that have not been reclaimed. */
+    INLINE size_t GetPendingBytes() const { return pendingBytes; }
+private:
+    static void ThreadMain(void*);
+    
+    /** Frees objects, already destroyed, and updates pendingBytes. */
+    void FreeAll(Buffer<GCObject*>& objects);
+    
+    /** Appends the contents of from to to and empties from. */
+    static void MoveAll(Buffer<GCObject*>& from, Buffer<GCObject*>& to);
+    
+    Heap*             heap;
+    Pika_Thread*      thread;
+    Pika_Mutex*       mutex;
+    Pika_Condition*   wake;     //!< Signaled when objects are queued or the sweeper is destroyed.
+    Pika_Condition*   idle;     //!< Signaled when the sweep thread runs out of work.
+    Buffer<GCObject*> batch;    //!< Objects not yet handed to the sweep thread.
+    Buffer<GCObject*> queued;   //!< Objects waiting for the sweep thread.
+    Buffer<GCObject*> done;     //!< Destroyed objects waiting for Reclaim.
+    Buffer<GCObject*> scratch;  //!< Objects being destroyed or reclaimed.
+    Buffer<GCObject*> work;     //!< Used by the sweep thread only.
+    size_t            pendingBytes;
+    bool              working;  //!< Is the sweep thread destroying objects.
+    bool              quit;
+};
+
+GCSweeper::GCSweeper(Heap* h)
+        : heap(h),
+        thread(0),
+        mutex(Pika_CreateMutex()),
+        wake(Pika_CreateCondition()),
+        idle(Pika_CreateCondition()),
+        pendingBytes(0),
+        working(false),
+        quit(false)
+{
+    thread = Pika_CreateThread(ThreadMain, this);
+}
+
+GCSweeper::~GCSweeper()
+{
+    if (thread)
+    {
+        Finish();
+        
+        Pika_LockMutex(mutex);
+        quit = true;
+        Pika_SignalCondition(wake);
+        Pika_UnlockMutex(mutex);
+        
+        Pika_JoinThread(thread);
+    }
+    Pika_DestroyCondition(idle);
+    Pika_DestroyCondition(wake);
+    Pika_DestroyMutex(mutex);
+}
+
+void GCSweeper::Submit()
+{
+    if (!batch.GetSize())
+        return;
+    
+    Pika_LockMutex(mutex);
+    bool full = queued.GetSize() >= Collector::GC_SWEEP_MAX_QUEUED;
+    if (!full)
+    {
+        MoveAll(batch, queued);
+        Pika_SignalCondition(wake);
+    }
+    Pika_UnlockMutex(mutex);
+    
+    if (full)
+    {
+        // The sweep thread is falling behind, destroy the batch here instead.
+        for (size_t i = 0; i < batch.GetSize(); ++i)
+            Pika_destruct<GCObject>(batch[i]);
+        FreeAll(batch);
+    }
+}
+
+void GCSweeper::Reclaim()
+{
+    Pika_LockMutex(mutex);
+    MoveAll(done, scratch);
+    Pika_UnlockMutex(mutex);
+    
+    FreeAll(scratch);
+}
+
+void GCSweeper::Finish()
+{
+    Submit();
+    
+    Pika_LockMutex(mutex);
+    while (working || queued.GetSize())
+        Pika_WaitCondition(idle, mutex);
+    Pika_UnlockMutex(mutex);
+    
+    Reclaim();
+}
+
+void GCSweeper::FreeAll(Buffer<GCObject*>& objects)
+{
+    size_t before = heap->GetBytesInUse();
+    for (size_t i = 0; i < objects.GetSize(); ++i)
+        heap->Free(objects[i]);
+    pendingBytes -= before - heap->GetBytesInUse();
+    objects.Clear();
+}
+
+void GCSweeper::MoveAll(Buffer<GCObject*>& from, Buffer<GCObject*>& to)
+{
+    size_t pos = to.GetSize();
+    if (from.GetSize())
+    {
+        to.Resize(pos + from.GetSize());
+        Pika_memcpy(to.GetAt(pos), from.GetAt(0), from.GetSize() * sizeof(GCObject*));
+        from.Clear();
+    }
+}
+
+void GCSweeper::ThreadMain(void* data)
+{
+    GCSweeper* s = (GCSweeper*)data;
+    
+    Pika_LockMutex(s->mutex);
+    for (;;)
+    {
+        while (!s->queued.GetSize() && !s->quit)
+            Pika_WaitCondition(s->wake, s->mutex);
+        
+        if (!s->queued.GetSize())
+            break;
+        MoveAll(s->queued, s->work);
+        s->working = true;
+        Pika_UnlockMutex(s->mutex);
+        
+        for (size_t i = 0; i < s->work.GetSize(); ++i)
+            Pika_destruct<GCObject>(s->work[i]);
+        
+        Pika_LockMutex(s->mutex);
+        MoveAll(s->work, s->done);
+        if (!s->queued.GetSize())
+        {
+            s->working = false;
+            Pika_BroadcastCondition(s->idle);
+        }
+    }
+    Pika_UnlockMutex(s->mutex);
+}
+
 ////////////////////////////////// Collector ///////////////////////////////////
 
+static const size_t GC_EMPTY_SLOT = (size_t)-1; //!< Unused slot in GetLiveCounts' table.
+
+/** Fills pages with every page of heap. */
+static void GetHeapPages(Heap* heap, Buffer<Heap::Page*>& pages)
+{
+    pages.Resize(heap->GetNumPages());
+    if (pages.GetSize())
+        heap->GetPages(pages.GetAt(0));
+}
+
 Collector::Collector(Engine* eng)
         : numObjects(0),
         maxObjects(0),
         totalObjects(0),
         iteration(0),
+        stepWork(0),
+        stepStart(0),
+        stepDeadline(0),
+        pause(GC_PAUSE),
+        stepMul(GC_STEP_MUL),
+        maxPause(GC_MAX_PAUSE),
+        markThreads(1),
+        threshold(GC_MIN_HEAP),
+        stopped(false),
+        sliceStart(0),
+        lapStart(0),
+        externalBytes(0),
+        externalAllocated(0),
+        minorExternal(0),
+        numYoung(0),
+        nurserySize(GC_NURSERY_SIZE),
+        minorCycles(0),
+        majorCycles(0),
+        numPromoted(0),
+        marking(false),
+        mode(MARK_full),
+        visitor(0),
+        markPool(0),
+        sweeper(0),
+        sweepClass(0),
         engine(eng),
         activeCtx(0),
-        blacks(0),
-        grays(0),
-        whites(0),
         head(0)
 {
+    Pika_memzero(&stats, sizeof(stats));
     Initialize();
+    
+    if (const char* threads = getenv(PIKA_GC_MARK_THREADS_ENV))
+        SetMarkThreads((size_t)Max<long>(atol(threads), 0));
+    
+    if (const char* nursery = getenv(PIKA_GC_NURSERY_SIZE_ENV))
+        SetNurserySize((size_t)Max<long>(atol(nursery), 0));
+    
+    const char* sweep = getenv(PIKA_GC_BACKGROUND_SWEEP_ENV);
+    SetBackgroundSweep(sweep ? atol(sweep) != 0 : Pika_NumProcessors() > 1);
 }
 
 Collector::~Collector()
 {
+    engine->GetHeap()->SetCollector(0);
     FreeAll();
+    if (markPool)
+        Pika_delete(markPool);
 #if defined(PIKA_DEBUG_OUTPUT)
     std::cout << "\n*******************************\n";
     std::cout << "Number of gc objects: " << totalObjects;
+    std::cout << "\nNumber of minor collections: " << minorCycles;
+    std::cout << "\nNumber of full cycles: " << majorCycles;
     std::cout << "\n*******************************\n";
 #endif
 }
@@ -182,7 +652,7 @@ void Collector::Resume()
     {
         pauseDepth = 0;
         state = savedState;
-        if (numAllocations == 0)
+        if (!stopped && (marking ? StepDue() : MinorDue()))
         {
             IncrementalRun();
         }
@@ -205,8 +675,7 @@ void Collector::ChangeContext(GCObject* c)
 void Collector::AddAsRoot(GCObject* c)
 {
     if (!c) return;
-    c->Unlink();
-    c->InsertAfter(grays);
+    Regray(c);
     
     RootObject* robj = new RootObject(c);
     robj->InsertAfter(head);
@@ -220,8 +689,11 @@ bool Collector::RemoveAsRoot(GCObject* c)
         {
             curr->Unlink();
             delete curr;
-            c->Unlink();
-            c->InsertAfter(grays);
+            Regray(c);
+            
+            // It is no longer scanned as a root.
+            if (!marking)
+                Remember(c);
             return true;
         }
     }
@@ -230,7 +702,7 @@ bool Collector::RemoveAsRoot(GCObject* c)
 
 void Collector::Check()
 {
-    if ( state != SUSPENDED )//if ((numAllocations == 0) && (state != SUSPENDED))
+    if (state != SUSPENDED && !stopped)
     {
         IncrementalRun();
     }
@@ -238,7 +710,7 @@ void Collector::Check()
 
 void Collector::CheckIf()
 {
-    if ( state != SUSPENDED && (numAllocations == 0) )
+    if (state != SUSPENDED && !stopped && (marking ? StepDue() : MinorDue()))
     {
         IncrementalRun();
     }    
@@ -246,31 +718,45 @@ void Collector::CheckIf()
 
 void Collector::Add(GCObject* c)
 {
-    c->Unlink();
-    
-    if (numAllocations == 0)
+    if (state != SUSPENDED && !stopped)
     {
-        if (state != SUSPENDED)
+        if (!marking)
+        {
+            if (MinorDue())
+            {
+                // Nothing references c yet, so it is passed on as a root. Otherwise whatever its 
+                // constructor allocated would be swept.
+                
+                AddNoRun(c);
+                MinorRun(c); // May start a full cycle.
+                return;
+            }
+        }
+        else if (StepDue())
         {
             IncrementalRun();
         }
     }
-    else
-    {
-        --numAllocations;
-    }
-    c->InsertAfter(whites);
-    ++numObjects; ++totalObjects;
+    AddNoRun(c);
 }
 
 void Collector::AddNoRun(GCObject* c)
 {
-    c->Unlink();
-    c->InsertAfter(whites);
+    Heap::SetObject(c);
     
-    if (numAllocations != 0)
+    if (marking)
     {
-        --numAllocations;
+        // Once the sweep has started every unmarked object is garbage, so new objects are 
+        // marked as they are added.
+        c->gcgen = GEN_old;
+        if (GetPhase() == SWEEP)
+            Heap::SetMarked(c);
+    }
+    else
+    {
+        c->gcgen = GEN_young;
+        nursery.Push(c);
+        ++numYoung;
     }
     ++numObjects; ++totalObjects;
 }
@@ -279,8 +765,15 @@ void Collector::IncrementalRun()
 {
     if (state != SUSPENDED)
     {
+        if (!marking)
+        {
+            MinorRun();
+            return;
+        }
+        BeginSlice();
+        BeginStep();
         IncrementalMoveRoots(true);
-        numAllocations = GC_NUM_ALLOCS;
+        EndSlice();
     }
 }
 
@@ -288,65 +781,255 @@ void Collector::FullRun()
 {
     if (state != SUSPENDED)
     {
+        BeginSlice();
         IncrementalMoveRoots(false);
+        if (sweeper)
+            FinishSweep();
+        EndSlice();
     }
 }
 
-void Collector::MoveToGray(GCObject* c)
+void Collector::MinorRun(GCObject* newborn)
 {
-    if (c && (c->gccolor == whites->gccolor))
+    if (state == SUSPENDED || marking || mode != MARK_full)
+        return;
+    
+    BeginSlice();
+    mode = MARK_minor;
+    
+    // The roots, the active context and the remembered set are scanned for young 
+    // objects. Engine::ScanRoots calls ForceToGray which does the same during a 
+    // minor collection.
+    
+    engine->ScanRoots(this);
+    
+    for (RootObject* robj = head->next; robj != head; robj = robj->next)
+    {
+        if (GCObject* t = robj->GetObj())
+            ScanYoungRefs(t);
+    }
+    
+    if (activeCtx)
+        ScanYoungRefs(activeCtx);
+    
+    if (newborn)
+        ScanYoungRefs(newborn);
+    
+    for (size_t i = 0; i < remembered.GetSize(); ++i)
+    {
+        GCObject* t = remembered[i];
+        t->gcflags &= ~GCObject::Remembered;
+        ScanYoungRefs(t);
+    }
+    remembered.Clear();
+    
+    // Scan every promoted object. A stack is used so that long chains of young
+    // objects do not recurse.
+    
+    while (promoted.GetSize())
+    {
+        GCObject* t = promoted.Back();
+        promoted.Pop();
+        t->MarkRefs(this);
+    }
+    mode = MARK_full;
+    
+    SweepNursery();
+    ReleaseSwept();
+    minorExternal = externalAllocated;
+    ++minorCycles;
+    Lap(stats.minorTime);
+    
+    if (GetLiveBytes() >= threshold)
     {
-        c->Unlink();
-        c->InsertAfter(grays);
+        // Only count what is allocated once the cycle has started.
+        stepStart = GetBytesAllocated();
+        BeginStep();
+        IncrementalMoveRoots(true);
     }
+    EndSlice();
 }
 
-void Collector::ForceToGray(GCObject* c)
+void Collector::ScanYoungRefs(GCObject* c)
 {
-    if (!c) return;
-    
-    c->Unlink();
-    c->InsertAfter(grays);
+    if (c->IsYoung())
+    {
+        c->Mark(this);
+    }
+    else
+    {
+        c->MarkRefs(this);
+    }
 }
 
-void Collector::WriteBarrier(GCObject* oldC,
-                             GCObject* newC)
+void Collector::Promote(GCObject* c)
+{
+    // Objects still being constructed are reached too, they are not in the nursery yet.
+    if (Heap::IsObject(c))
+        --numYoung;
+    c->gcgen = GEN_old;
+    ++numPromoted;
+    promoted.Push(c);
+}
+
+void Collector::SweepNursery()
+{
+    for (size_t i = 0; i < nursery.GetSize(); ++i)
+    {
+        GCObject* curr = nursery[i];
+        
+        if (!curr->IsYoung()) // Promoted
+            continue;
+        
+        if (curr->IsPersistent()) // Don't free a persistent object
+        {
+            curr->gcgen = GEN_old;
+            continue;
+        }
+        --numObjects;
+        Heap::ClearObject(curr);
+        
+        if (curr->Finalize()) // Free this object if it finalizes
+        {
+            ChargeExternal(curr->GetExternalBytes(), 0);
+            FreeDead(curr);
+        }
+        else if (curr->gcflags & GCObject::ReadyToCollect)
+        {
+            // Only Strings are collected by the StringTable.
+            engine->SweepString((String*)curr);
+        }
+    }
+    nursery.Clear();
+    numYoung = 0;
+}
+
+void Collector::FlushNursery()
 {
-    if ((oldC->gccolor == blacks->gccolor) &&
-            (newC->gccolor == whites->gccolor))
+    for (size_t i = 0; i < nursery.GetSize(); ++i)
+    {
+        nursery[i]->gcgen = GEN_old;
+    }
+    nursery.Clear();
+    numYoung = 0;
+    
+    for (size_t i = 0; i < remembered.GetSize(); ++i)
     {
-        newC->Unlink();
-        newC->InsertAfter(grays);
+        remembered[i]->gcflags &= ~GCObject::Remembered;
     }
+    remembered.Clear();
 }
 
-void Collector::MoveToGray(Value& v)
+void Collector::Register(GCObject* c)
 {
-    if (v.tag >= TAG_gcobj)
+    if (!Heap::IsObject(c))
     {
-        MoveToGray(v.val.gcobj);
+        Heap::SetObject(c);
+        ++numObjects; ++totalObjects;
     }
 }
 
-void Collector::Initialize()
+void Collector::Regray(GCObject* c)
 {
-    numAllocations  = GC_NUM_ALLOCS;
-    pauseDepth = 0;
-    savedState = state = ROOT_SCAN;
-    
-    blacks = Pika_new<GCObject>();
-    grays  = Pika_new<GCObject>();
-    whites = Pika_new<GCObject>();
+    if (c->IsYoung())
+    {
+        // The nursery still lists it, SweepNursery skips it now that it is old.
+        if (Heap::IsObject(c))
+            --numYoung;
+        c->gcgen = GEN_old;
+    }
+    Register(c);
     
-    blacks->gcnext = blacks;
-    blacks->gcprev = blacks;
+    if (marking)
+    {
+        Heap::SetMarked(c);
+        grays.Push(c);
+    }
+}
+
+void Collector::Remember(GCObject* c)
+{
+    if (!(c->gcflags & GCObject::Remembered) && Heap::IsObject(c))
+    {
+        c->gcflags |= GCObject::Remembered;
+        remembered.Push(c);
+    }
+}
+
+void Collector::MoveToGray(GCObject* c)
+{
+    if (!c) return;
     
-    grays->InsertAfter(blacks);
-    whites->InsertAfter(grays);
+    if (marking)
+    {
+        Shade(c);
+    }
+    else if (!c->IsYoung())
+    {
+        Remember(c);
+    }
+}
+
+void Collector::ForceToGray(GCObject* c)
+{
+    if (!c) return;
     
-    blacks->SetBlack();
-    grays->SetGray();
-    whites->SetWhite();
+    if (mode == MARK_minor)
+    {
+        ScanYoungRefs(c);
+        return;
+    }
+    else if (mode == MARK_visit)
+    {
+        visitor->Visit(c);
+        return;
+    }
+    Regray(c);
+    
+    if (!marking)
+    {
+        Remember(c);
+    }
+}
+
+void Collector::WriteBarrier(GCObject* oldC,
+                             GCObject* newC)
+{
+    // While marking every object the collector owns is old, a young one is still being built.
+    if (newC->IsYoung())
+    {
+        if (!marking && !oldC->IsYoung())
+            Remember(oldC);
+    }
+    else if (marking && Heap::IsMarked(oldC) && !Heap::IsMarked(newC))
+    {
+        Shade(newC);
+    }
+}
+
+void Collector::WriteBarrier(GCObject* oldC, const Value& v)
+{
+    if (v.GetTag() >= TAG_gcobj && v.GetGCObject())
+    {
+        WriteBarrier(oldC, v.GetGCObject());
+    }
+}
+
+void Collector::MoveToGray(Value& v)
+{
+    if (v.GetTag() >= TAG_gcobj)
+    {
+        MoveToGray(v.GetGCObject());
+    }
+}
+
+void Collector::Initialize()
+{
+    pauseDepth = 0;
+    savedState = state = ROOT_SCAN;
+    
+    // Let the heap sweep pages before it takes fresh ones.
+    engine->GetHeap()->SetCollector(this);
     
     /**************/
     head = new RootObject(0);
@@ -363,9 +1046,17 @@ bool Collector::IncrementalMoveRoots(bool b)
         return IncrementalScan(b);
     }
     //
+    // Young objects are collected by this cycle.
+    //
+    FlushNursery();
+    marking = true;
+    ++majorCycles;
+    
+    engine->GetHeap()->ClearMarks();
+    grays.Clear();
+    //
     // Stage 1
     //
-    scan = grays;
     engine->ScanRoots(this);
     //
     // Stage 2
@@ -383,8 +1074,13 @@ bool Collector::IncrementalMoveRoots(bool b)
     // Time to start the scanning the grays.
     //
     state = GRAY_SCAN;
-    scan  = grays->gcnext;
     iteration = 0;
+    Lap(stats.rootTime);
+    
+    if (UseParallelScan())
+    {
+        ParallelScan();
+    }
     if (!b)
     {
         return IncrementalScan(b);
@@ -397,42 +1093,187 @@ bool Collector::IncrementalScan(bool b)
     if (state != GRAY_SCAN)
         return IncrementalSweep(b);
     
-    while ((scan->gccolor == grays->gccolor) && // Loop while there are still objs in the gray list
-            STILL_ITERATING())                  // and while we still have some iterations left.
-    {        
-        GCObject* next = scan->gcnext; // Save the next object.
-        scan->MarkRefs(this);          // Mark it.
-        scan->Unlink();                // Remove it from the gray list.
-        scan->InsertAfter(blacks);     // Add it to the black list.
-        scan = next;                   // Move to the next object.
+    if (!b && UseParallelScan())
+    {
+        ParallelScan();
     }
-
+    
+    ScanGrays(b);
+    
     // If its time to start sweeping.
-    if ((scan->gccolor != grays->gccolor))
+    if (!grays.GetSize())
     {
+        // Rescan the active context(s) before sweeping. This needs to be atomic. Objects 
+        // added from now on are marked so this is only needed once.
+        
+        ForceToGray(activeCtx);
+        ScanGrays(false);
+        Lap(stats.scanTime);
+        
         state = SWEEP;
-        sweep = whites->gcnext;
+        BeginSweep();
         return IncrementalSweep(b);
     }
+    Lap(stats.scanTime);
     // Otherwise we will finish scanning at a later time.
     iteration = 0;
     return false;
 }
 
+bool Collector::UseParallelScan() const
+{
+    return markThreads > 1 && numObjects >= GC_PARALLEL_MIN && mode == MARK_full;
+}
+
+void Collector::ParallelScan()
+{
+    if (!markPool)
+    {
+        PIKA_NEW(GCMarkPool, markPool, (this, markThreads));
+    }
+    
+    // Every gray object is already marked, hand them all out.
+    for (size_t i = 0; i < grays.GetSize(); ++i)
+    {
+        markPool->Add(grays[i]);
+    }
+    grays.Clear();
+    
+    mode = MARK_parallel;
+    markPool->Run();
+    mode = MARK_full;
+    
+    Lap(stats.scanTime);
+}
+
+void Collector::MarkShared(GCObject* c)
+{
+    if (Heap::SetMarkedAtomic(c))
+        GCMarkPool::Current()->Push(c);
+}
+
+void Collector::ScanGrays(bool b)
+{
+    while (grays.GetSize() &&  // Loop while there are still gray objects
+           STILL_ITERATING())  // and while we still have some iterations left.
+    {
+        GCObject* c = grays.Back();
+        grays.Pop();
+        c->MarkRefs(this);
+    }
+}
+
+void Collector::BeginSweep()
+{
+    Buffer<Heap::Page*> pages;
+    GetHeapPages(engine->GetHeap(), pages);
+    
+    for (size_t i = 0; i < pages.GetSize(); ++i)
+    {
+        unswept[pages[i]->sizeClass].Push(pages[i]);
+    }
+    sweepClass = 0;
+    maxObjects = Max<size_t>(maxObjects, numObjects);
+}
+
+size_t Collector::SweepPage(Heap::Page* page, bool lazy)
+{
+    // A large page is returned to the OS along with its object, so it must not be touched 
+    // after that.
+    bool   large = page->sizeClass == Heap::LARGE_CLASS;
+    size_t freed = 0;
+    
+    for (size_t w = 0; w < Heap::BITMAP_WORDS; ++w)
+    {
+        u4 dead = page->objects[w] & ~page->marks[w];
+        while (dead)
+        {
+            size_t    bit  = w * 32 + Pika_CountTrailingZeros(dead);
+            GCObject* curr = (GCObject*)Heap::CellAt(page, bit);
+            dead &= dead - 1;
+            
+            if (curr->IsPersistent()) // Don't free a persistent object
+                continue;
+            
+            --numObjects;
+            ++freed;
+            Heap::ClearObject(curr);
+            
+            if (curr->Finalize()) // Free this object if it finalizes
+            {
+                ChargeExternal(curr->GetExternalBytes(), 0);
+                if (lazy)
+                    FreeObject(curr);
+                else
+                    FreeDead(curr);
+            }
+            else if (curr->gcflags & GCObject::ReadyToCollect)
+            {
+                engine->SweepString((String*)curr);
+            }
+            
+            if (large)
+                return freed;
+        }
+    }
+    return freed;
+}
+
+bool Collector::SweepClass(size_t sizeClass)
+{
+    // Not while paused: whatever is being built has not been added yet.
+    if (state != SWEEP || !unswept[sizeClass].GetSize())
+        return false;
+    
+    // Finalizers must not start another slice.
+    Pause();
+    ScanGrays(false);
+    
+    bool freed = false;
+    while (!freed && unswept[sizeClass].GetSize())
+    {
+        Heap::Page* page = unswept[sizeClass].Back();
+        unswept[sizeClass].Pop();
+        freed = SweepPage(page, true) != 0;
+    }
+    ResumeNoRun();
+    return freed;
+}
+
+size_t Collector::SetMarkThreads(size_t n)
+{
+    size_t old = markThreads;
+    markThreads = n ? n : Pika_NumProcessors();
+    
+    if (markPool && markPool->GetSize() != markThreads)
+    {
+        Pika_delete(markPool);
+        markPool = 0;
+    }
+    return old;
+}
+
+size_t Collector::SetNurserySize(size_t n)
+{
+    size_t old = nurserySize;
+    nurserySize = n ? n : (size_t)GC_NURSERY_SIZE;
+    return old;
+}
+
 void Collector::FreeAll()
 {
-    // Delete all RootObjects and
-    // add the GCObject to the black list.
+    if (sweeper)
+    {
+        FinishSweep();
+        Pika_delete(sweeper);
+        sweeper = 0;
+    }
+    
+    // Delete all RootObjects, the objects are freed with the rest.
     RootObject* robj = head->next;
     while (robj != head)
     {
         RootObject* next = robj->next;
-        GCObject* t = robj->GetObj();
-        if (t)
-        {
-            t->Unlink();
-            t->InsertAfter(blacks);
-        }
         delete robj;
         robj = next;
     }
@@ -442,44 +1283,54 @@ void Collector::FreeAll()
     delete head;
     head = 0;
     
-    // Free each list.
-    FreeList(whites);
-    FreeList(blacks);
-    FreeList(grays);
+    FlushNursery();
+    grays.Clear();
+    for (size_t i = 0; i <= Heap::NUM_CLASSES; ++i)
+    {
+        unswept[i].Clear();
+    }
     
-    // Free each list marker.
-    FreeObject(whites);
-    FreeObject(blacks);
-    FreeObject(grays);
+    // Free every object by its object bit, live or not.
+    Buffer<Heap::Page*> pages;
+    GetHeapPages(engine->GetHeap(), pages);
     
-    whites = blacks = grays = scan = sweep = 0;
-}
-
-void Collector::FreeList(GCObject *list)
-{
-    GCObject* curr = list->gcnext;
-    GCObject* next = 0;
-    
-    while (curr->gccolor == list->gccolor)
+    for (size_t i = 0; i < pages.GetSize(); ++i)
     {
-        next = curr->gcnext;
-        curr->Unlink();
+        Heap::Page* page  = pages[i];
+        bool        large = page->sizeClass == Heap::LARGE_CLASS;
+        bool        freed = false;
         
-        if (curr->Finalize())
+        for (size_t w = 0; w < Heap::BITMAP_WORDS && !freed; ++w)
         {
-            FreeObject(curr);
+            for (u4 bits = page->objects[w]; bits; bits &= bits - 1)
+            {
+                GCObject* curr = (GCObject*)Heap::CellAt(page, w * 32 + Pika_CountTrailingZeros(bits));
+                Heap::ClearObject(curr);
+                
+                if (curr->Finalize())
+                {
+                    FreeObject(curr);
+                    if ((freed = large))
+                        break;
+                }
+            }
         }
-        curr = next;
     }
+    numObjects = numYoung = 0;
+    externalBytes = 0;
 }
 
 void Collector::Reset()
 {
-    Swap(blacks, whites);
-    
     state = ROOT_SCAN;
-    numAllocations = GC_NUM_ALLOCS;
     iteration = 0;
+    marking = false;
+    grays.Clear();
+    minorExternal = externalAllocated;
+    
+    // Give pages emptied by the sweep back to the OS.
+    engine->GetHeap()->ReleaseEmptyPages();
+    SetThreshold();
 }
 
 bool Collector::IncrementalSweep(bool b)
@@ -487,58 +1338,353 @@ bool Collector::IncrementalSweep(bool b)
     if (state != SWEEP)
         return false;    
     
-    // Rescan the active context(s) before sweeping.
-    // This needs to be atomic.
+    // Objects marked since the sweep started, by ForceToGray for instance, are scanned first.
+    ScanGrays(false);
     
-    ForceToGray(activeCtx);
-    scan = grays->gcnext;
-    while (scan->gccolor == grays->gccolor)
+    // Sweep a page at a time. Every page costs one iteration plus one per object freed.
+    while (sweepClass <= Heap::NUM_CLASSES)
     {
-        GCObject* next = scan->gcnext;
-        scan->MarkRefs(this);
-        scan->Unlink();
-        scan->InsertAfter(blacks);
-        scan = next;
-    }
-    
-    // Start sweeping from the first white object.
-    
-    sweep = whites->gcnext;
-    maxObjects = Max<size_t>(maxObjects, numObjects);
-    
-    while ((sweep->gccolor == whites->gccolor) && STILL_ITERATING())
-    {
-        GCObject* next = sweep->gcnext;
-        sweep->Unlink();
-        --numObjects;
-        
-        if (sweep->IsPersistent()) // Don't free a persistent object
+        Buffer<Heap::Page*>& pages = unswept[sweepClass];
+        if (!pages.GetSize())
         {
-            sweep->InsertAfter(blacks);
+            ++sweepClass;
+            continue;
         }
-        else if (sweep->Finalize()) // Free this object if it finalizes
-        {
-            FreeObject(sweep);
-        }
-        sweep = next;
+        if (b && (iteration >= stepWork || OverBudget()))
+            break;
+        
+        Heap::Page* page = pages.Back();
+        pages.Pop();
+        iteration += SweepPage(page, false) + 1;
     }
     
+    ReleaseSwept();
+    
     // If we finished reset the collector
-    if (sweep->gccolor != whites->gccolor)
+    if (sweepClass > Heap::NUM_CLASSES)
     {
-        engine->SweepStringTable();
-        state = ROOT_SCAN;
         Reset();
+        Lap(stats.sweepTime);
         return true;
     }
+    Lap(stats.sweepTime);
     // Otherwise we will continue at a later time.
     iteration = 0;
     return false;
 }
 
+void Collector::SetThreshold()
+{
+    size_t live = GetLiveBytes();
+    size_t grow = (live / 100) * pause;
+    
+    // Guard against overflow for very large pauses.
+    threshold = (grow / pause == live / 100) ? Max<size_t>(grow, GC_MIN_HEAP) : (size_t)-1;
+}
+
+size_t Collector::SetPause(size_t pct)
+{
+    size_t old = pause;
+    pause = Max<size_t>(pct, 100);
+    
+    if (!marking)
+        SetThreshold();
+    return old;
+}
+
+size_t Collector::SetStepMul(size_t pct)
+{
+    size_t old = stepMul;
+    stepMul = Max<size_t>(pct, 1);
+    return old;
+}
+
+size_t Collector::SetMaxPause(size_t usecs)
+{
+    size_t old = maxPause;
+    maxPause = usecs;
+    return old;
+}
+
+void Collector::Stop()
+{
+    stopped = true;
+}
+
+void Collector::Restart()
+{
+    stopped = false;
+}
+
+u8 Collector::GetBytesAllocated() const
+{
+    return engine->GetHeap()->GetBytesAllocated() + externalAllocated;
+}
+
+bool Collector::StepDue() const
+{
+    return GetBytesAllocated() - stepStart >= GC_STEP_SIZE;
+}
+
+void Collector::BeginStep()
+{
+    u8     debt  = GetBytesAllocated() - stepStart;
+    size_t inUse = engine->GetHeap()->GetBytesInUse() + externalBytes;
+    
+    // Convert the bytes allocated into a number of objects using the average object size.
+    size_t avgSize = numObjects ? Max<size_t>(inUse / numObjects, (size_t)Heap::GRANULE) : (size_t)Heap::GRANULE;
+    u8     work    = Max<u8>(debt, GC_STEP_SIZE) / avgSize * stepMul / 100;
+    
+    stepWork     = (size_t)Min<u8>(Max<u8>(work, GC_MIN_STEP), (size_t)-1);
+    stepStart    = GetBytesAllocated();
+    stepDeadline = maxPause ? Pika_Microseconds() + maxPause : 0;
+}
+
+bool Collector::OverBudget() const
+{
+    return stepDeadline && Pika_Microseconds() >= stepDeadline;
+}
+
+void Collector::VisitObjects(GCVisitor* v)
+{
+    Buffer<Heap::Page*> pages;
+    GetHeapPages(engine->GetHeap(), pages);
+    
+    for (size_t i = 0; i < pages.GetSize(); ++i)
+    {
+        Heap::Page* page = pages[i];
+        for (size_t w = 0; w < Heap::BITMAP_WORDS; ++w)
+        {
+            for (u4 bits = page->objects[w]; bits; bits &= bits - 1)
+            {
+                GCObject* c = (GCObject*)Heap::CellAt(page, w * 32 + Pika_CountTrailingZeros(bits));
+                
+                // Skip objects the sweep in progress has yet to free.
+                if (!IsDead(c))
+                    v->Visit(c);
+            }
+        }
+    }
+}
+
+/** Collects the objects passed to Visit. */
+class GCObjectList : public GCVisitor
+{
+public:
+    virtual void Visit(GCObject* c) { objects.Push(c); }
+    
+    Buffer<GCObject*> objects;
+};
+
+void Collector::VisitRoots(GCVisitor* v)
+{
+    if (mode != MARK_full)
+        return;
+    
+    mode = MARK_visit;
+    visitor = v;
+    
+    engine->ScanRoots(this);
+    for (RootObject* robj = head->next; robj != head; robj = robj->next)
+    {
+        if (GCObject* t = robj->GetObj())
+            v->Visit(t);
+    }
+    if (activeCtx)
+        v->Visit(activeCtx);
+    
+    mode = MARK_full;
+    visitor = 0;
+}
+
+void Collector::VisitRefs(GCObject* c, GCVisitor* v)
+{
+    if (mode != MARK_full)
+        return;
+    
+    mode = MARK_visit;
+    visitor = v;
+    c->MarkRefs(this);
+    mode = MARK_full;
+    visitor = 0;
+}
+
+void Collector::BeginSlice()
+{
+    sliceStart = lapStart = Pika_Microseconds();
+}
+
+void Collector::EndSlice()
+{
+    u8 pause = Pika_Microseconds() - sliceStart;
+    size_t bucket = 0;
+    
+    for (u8 x = pause >> 1; x && bucket < GCStats::NUM_BUCKETS - 1; x >>= 1)
+        ++bucket;
+    
+    ++stats.histogram[bucket];
+    ++stats.numSlices;
+    stats.pauseTotal += pause;
+    stats.pauseMax = Max<u8>(stats.pauseMax, pause);
+}
+
+void Collector::Lap(u8& phaseTime)
+{
+    u8 now = Pika_Microseconds();
+    phaseTime += now - lapStart;
+    lapStart = now;
+}
+
+void Collector::GetStats(GCStats& out) const
+{
+    Heap* heap = engine->GetHeap();
+    
+    out = stats;
+    out.minorCycles      = minorCycles;
+    out.majorCycles      = majorCycles;
+    out.numPromoted      = numPromoted;
+    out.objectsAllocated = totalObjects;
+    out.objectsFreed     = totalObjects - numObjects;
+    out.numObjects       = numObjects;
+    out.numYoung         = numYoung;
+    out.bytesAllocated   = heap->GetBytesAllocated();
+    out.bytesFreed       = heap->GetBytesFreed();
+    out.bytesInUse       = heap->GetBytesInUse();
+    out.externalBytes    = externalBytes;
+    out.numPages         = heap->GetNumPages();
+    out.threshold        = threshold;
+}
+
+void Collector::GetLiveCounts(Buffer<GCTypeCount>& counts)
+{
+    Heap* heap = engine->GetHeap();
+    
+    // Names are grouped by address. Type names are interned Strings and the rest are 
+    // string literals so equal names share an address.
+    Buffer<size_t> table;
+    table.Resize(64);
+    for (size_t i = 0; i < table.GetSize(); ++i)
+        table[i] = GC_EMPTY_SLOT;
+    counts.Clear();
+    
+    GCObjectList live;
+    VisitObjects(&live);
+    
+    for (size_t n = 0; n < live.objects.GetSize(); ++n)
+    {
+        GCObject*   c    = live.objects[n];
+        const char* name = c->GetGCName();
+        size_t      pos  = FindCount(table, counts, name);
+        size_t      idx  = table[pos];
+        
+        if (idx == GC_EMPTY_SLOT)
+        {
+            GCTypeCount entry = { name, 0, 0 };
+            idx = table[pos] = counts.GetSize();
+            counts.Push(entry);
+            
+            // Keep the table at most half full.
+            if (counts.GetSize() * 2 > table.GetSize())
+            {
+                table.Resize(table.GetSize() * 2);
+                for (size_t i = 0; i < table.GetSize(); ++i)
+                    table[i] = GC_EMPTY_SLOT;
+                for (size_t i = 0; i < counts.GetSize(); ++i)
+                    table[FindCount(table, counts, counts[i].name)] = i;
+            }
+        }
+        ++counts[idx].count;
+        counts[idx].bytes += heap->SizeOf(c);
+    }
+}
+
+size_t Collector::FindCount(Buffer<size_t>& table, Buffer<GCTypeCount>& counts, const char* name)
+{
+    size_t mask = table.GetSize() - 1;
+    size_t pos  = ((size_t)name >> 3) & mask;
+    
+    while (table[pos] != GC_EMPTY_SLOT && counts[table[pos]].name != name)
+        pos = (pos + 1) & mask;
+    return pos;
+}
+
 void Collector::FreeObject(GCObject *t)
 {
-    Pika_delete(t);
+    engine->GetHeap()->Delete(t);
+}
+
+void Collector::FreeDead(GCObject* c)
+{
+    if (!sweeper)
+    {
+        FreeObject(c);
+    }
+    else if (c->CanFreeInBackground())
+    {
+        sweeper->Add(c);
+    }
+    else
+    {
+        finalizing.Push(c);
+    }
+}
+
+void Collector::ReleaseSwept()
+{
+    if (!sweeper)
+        return;
+    
+    sweeper->Submit();
+    sweeper->Reclaim();
+    
+    // Take at least half the queue so that it cannot grow without bound.
+    size_t amt = Min<size_t>(finalizing.GetSize(), Max<size_t>(GC_FINALIZE_STEP, finalizing.GetSize() / 2));
+    while (amt--)
+    {
+        GCObject* c = finalizing.Back();
+        finalizing.Pop();
+        FreeObject(c);
+    }
+}
+
+void Collector::FinishSweep()
+{
+    sweeper->Finish();
+    
+    while (finalizing.GetSize())
+    {
+        GCObject* c = finalizing.Back();
+        finalizing.Pop();
+        FreeObject(c);
+    }
+}
+
+size_t Collector::GetLiveBytes() const
+{
+    size_t inUse = engine->GetHeap()->GetBytesInUse();
+    return (sweeper ? inUse - sweeper->GetPendingBytes() : inUse) + externalBytes;
+}
+
+bool Collector::SetBackgroundSweep(bool on)
+{
+    bool old = sweeper != 0;
+    
+    if (on && !sweeper)
+    {
+        PIKA_NEW(GCSweeper, sweeper, (engine->GetHeap()));
+        if (!sweeper->IsRunning())
+        {
+            Pika_delete(sweeper);
+            sweeper = 0;
+        }
+    }
+    else if (!on && sweeper)
+    {
+        FinishSweep();
+        Pika_delete(sweeper);
+        sweeper = 0;
+    }
+    return old;
 }
 
 }// pika
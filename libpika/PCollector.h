@@ -7,6 +7,12 @@
 #ifndef PIKA_VALUE_HEADER
 #   include "PValue.h"
 #endif
+#ifndef PIKA_BUFFER_HEADER
+#   include "PBuffer.h"
+#endif
+#ifndef PIKA_HEAP_HEADER
+#   include "PHeap.h"
+#endif
 namespace pika {
 
 class Collector;
@@ -14,12 +20,13 @@ class GCObject;
 class Engine;
 class Context;
 class RootObject;
+class GCMarkPool;
+class GCSweeper;
 
-enum EGCColor
+enum EGCGeneration
 {
-    COLOR_gray,
-    COLOR_black,
-    COLOR_white,
+    GEN_young, //!< Created since the last minor collection.
+    GEN_old,   //!< Survived a minor collection or created during a full cycle.
 };
 
 // GCObject /////////////////////////////////////////////////////////////////////////////////////
@@ -33,17 +40,38 @@ public:
         ReadyToCollect  = (1 << 0),
         Persistent      = (1 << 1),
         Root            = (1 << 2),
-        UserFlagsStart  = Root,
+        Remembered      = (1 << 3),
+        UserFlagsStart  = Remembered,
     };
     
-    INLINE   GCObject() : gcprev(0), gcnext(0), gcextra(0) { }
+    // Objects start out young so that a WriteBarrier performed before Collector::Add remembers
+    // the old object.
+    INLINE   GCObject() : gcgen(GEN_young), gcflags(0) {}
     virtual ~GCObject() {}
     
     virtual void MarkRefs(Collector*);
     
+    /** Name used to group live objects in Collector::GetLiveCounts. */
+    virtual const char* GetGCName() const;
+    
+    /** Text shown next to the object in heap snapshots. Returns null if there is none, 
+      * otherwise the argument is set to the length of the text.
+      */
+    virtual const char* GetGCPreview(size_t&) const { return 0; }
+    
+    /** Bytes the object owns outside the Heap, such as the elements of an Array. The Collector
+      * paces itself by these as well as the Heap, see Collector::ChargeExternal.
+      */
+    virtual size_t GetExternalBytes() const { return 0; }
+    
     // Can the Collector free the object? Return false only if you need to free the object manually.
     virtual bool Finalize(); 
     
+    /** Can the object be destroyed by the collector's sweep thread, see Collector::SetBackgroundSweep.
+      * Only return true if the destructor does nothing but Pika_free memory the object owns.
+      */
+    virtual bool CanFreeInBackground() { return false; }
+    
 	INLINE bool IsPersistent() const { return (gcflags & Persistent) ? true : false; }
     
     virtual void Mark(Collector*);
@@ -51,58 +79,126 @@ protected:
     friend class Collector;
     friend class Engine;
     
-    INLINE bool IsLinked() const { return gcprev != 0 && gcnext != 0; }
-    void Unlink();
+    INLINE bool IsYoung() const { return gcgen == GEN_young; }
     
-    // If this object is already linked it MUST be unlinked before re-inserting it.
-    void InsertAfter(GCObject*);
-    void InsertBefore(GCObject*);
-    
-    INLINE void SetBlack() { gccolor = COLOR_black; }
-    INLINE void SetWhite() { gccolor = COLOR_white; }
-    INLINE void SetGray()  { gccolor = COLOR_gray;  }
-    
-    GCObject* gcprev;
-    GCObject* gcnext;
-    
-    union 
-    {
-        u4 gcextra;
-        struct 
-        {
-            u1 gccolor;
-            u2 gcflags;
-        };
-    };
+    // Marks are kept in the Heap's page bitmaps, so the header is just the vtable and these.
+    u1 gcgen;
+    u2 gcflags;
+};
+
+// GCStats //////////////////////////////////////////////////////////////////////////////////////
+
+/** Counters kept by the Collector, see Collector::GetStats. Times are in microseconds. 
+  * A slice is one uninterrupted run of the collector: a minor collection, an incremental 
+  * step or a FullRun.
+  */
+struct PIKA_API GCStats
+{
+    enum { NUM_BUCKETS = 24 };
+    
+    u8     numSlices;
+    u8     pauseTotal;                   //!< Time spent in slices.
+    u8     pauseMax;                     //!< Longest slice.
+    u8     histogram[NUM_BUCKETS];       //!< Bucket i counts slices of [2^i, 2^(i+1)) microseconds. Bucket 0 also counts shorter slices.
+    
+    u8     minorTime;                    //!< Time spent in minor collections.
+    u8     rootTime;                     //!< Time spent in IncrementalMoveRoots.
+    u8     scanTime;                     //!< Time spent in IncrementalScan.
+    u8     sweepTime;                    //!< Time spent in IncrementalSweep.
+    
+    size_t minorCycles;
+    size_t majorCycles;
+    size_t numPromoted;
+    
+    u8     objectsAllocated;
+    u8     objectsFreed;
+    size_t numObjects;                   //!< Live objects, young and old.
+    size_t numYoung;
+    
+    u8     bytesAllocated;               //!< Bytes allocated from the Heap over its lifetime.
+    u8     bytesFreed;                   //!< Bytes freed into the Heap over its lifetime.
+    size_t bytesInUse;
+    size_t externalBytes;                //!< Bytes owned by objects outside the Heap, see GCObject::GetExternalBytes.
+    size_t numPages;
+    size_t threshold;                    //!< Heap size that starts the next full cycle.
+};
+
+/** Live objects and bytes sharing a GCObject::GetGCName. */
+struct PIKA_API GCTypeCount
+{
+    const char* name;
+    size_t      count;
+    size_t      bytes;
+};
+
+/** Receives objects from Collector::VisitObjects, Collector::VisitRoots and 
+  * Collector::VisitRefs. 
+  */
+class PIKA_API GCVisitor
+{
+public:
+    virtual ~GCVisitor() {}
+    virtual void Visit(GCObject*) = 0;
 };
 
 /** A tri-color, incremental, mark and sweep garbage collector.
   * The collector is proactive, meaning it will invoke itself as objects are 
   * added without the need to explicitly call Check.
+  *
+  * Objects are not linked together. Every object the collector owns has its object bit set 
+  * in the Heap page that holds it, and an object is black or gray once its mark bit in the 
+  * same page is set. Gray objects are the marked objects still on the gray stack.
   * <pre>
   * The collection phases is divided into three major parts.
   * 
   * 1. move-roots stage:
-  *         Currently the only atomic operation. The black-list and gray-list 
-  *         will be empty. The white-list will contain all objects that the 
-  *         collector controls. All root objects are then moved into the gray
-  *         list in preparation of the scanning phase.
+  *         Currently the only atomic operation. Every mark bit is cleared and
+  *         the root objects are marked and pushed onto the gray stack in
+  *         preparation of the scanning phase.
   * 2. scan-grays stage:
-  *         All objects in the gray list are marked and moved into the black-list. 
-  *         Any white object that can be reached from a gray object is moved to 
-  *         the end of the gray list so that it can be scanned. When there are 
-  *         no more objects in the gray-list we move to the sweep-whites stage.
-  * 3. sweep-whites stage:
-  *         Ideally at this point all whites would be considered garbage an could 
-  *         be freed. But for performance reasons the active-context does not 
-  *         perform a write barrier as objects are pushed onto its stack or 
-  *         functions are called (etc.) Therefore before each sweep iteration we
-  *         need to remark the active-context to ensure that any recently created
-  *         objects that are still visible from the roots do not get destroyed. 
-  *         Once every white-list object is destroyed the collector resets, moves
-  *         all black-list objects into the white-list and starts over with the 
-  *         move-roots stage.
+  *         Objects are popped off the gray stack and their references are 
+  *         marked. Any unmarked object that is reached is marked and pushed. 
+  *         Objects added during this stage start out unmarked. When the gray 
+  *         stack is empty we move to the sweep stage.
+  * 3. sweep stage:
+  *         The active-context does not perform a write barrier as objects are
+  *         pushed onto its stack or functions are called (etc.) so it is 
+  *         marked once more before sweeping starts. From then on new objects
+  *         are marked as they are added, so every unmarked object is garbage.
+  *         The pages of the heap are swept one at a time, freeing each object
+  *         whose object bit is set but whose mark bit is not. The allocator 
+  *         also sweeps the pages of a size class before it takes a fresh page 
+  *         for it. Once every page is swept the collector resets and starts 
+  *         over with the move-roots stage.
   * </pre>
+  * Between cycles new objects are recorded in the nursery. When the nursery is full a 
+  * minor collection marks the young objects reachable from the roots, the active context 
+  * and the remembered set. Marked objects are promoted by changing their generation, 
+  * everything left young in the nursery is freed. Objects are never moved in memory. The 
+  * remembered set holds old objects that obtained a reference to a young object, it is 
+  * fed by WriteBarrier, MoveToGray and ForceToGray. 
+  * 
+  * The collector is paced by the number of bytes in the Engine's Heap plus the bytes objects 
+  * own outside of it, which are reported with ChargeExternal. A full cycle starts once that 
+  * has grown by the pause percentage since the last one finished. A minor collection also 
+  * starts early once GC_NURSERY_BYTES have been charged since the previous one. While a full 
+  * cycle is running new objects skip the nursery and a step is taken every GC_STEP_SIZE bytes 
+  * allocated. Each step processes enough objects to 
+  * cover the bytes allocated since the previous step, scaled by the step multiplier and 
+  * cut short if it exceeds the max pause.
+  *
+  * With more than one mark thread, see SetMarkThreads, the scan-grays stage is done all at 
+  * once at the end of the move-roots stage and by FullRun. The gray objects are shared 
+  * between the threads, each with its own work stealing deque. An unmarked object is claimed 
+  * by atomically setting its mark bit and the thread that claims it calls its MarkRefs. The 
+  * same objects survive no matter how the work was divided.
+  *
+  * With background sweeping on, see SetBackgroundSweep, dead objects that allow it are handed 
+  * in batches to a sweep thread which runs their destructors. Their memory is given back to 
+  * the Heap by the collector's own thread at the start of the next slice. Other dead objects 
+  * are finalized as usual but are destroyed a few at a time, at the end of each slice, from 
+  * a finalization queue. Pages swept by the allocator destroy their dead objects right away.
+  *
   * @note   Root objects are destroyed liked ordinary objects; The only difference 
   *         is that there is no need to mark a root object.
   */
@@ -111,22 +207,48 @@ class PIKA_API Collector
 public:
     enum 
     {
-        // These values can be adjusted as needed, but only at compile time.
+        /** Default pause, in percent. A full cycle starts once the heap has grown to this 
+          * percentage of its size at the end of the previous cycle. See SetPause.
+          */
+        GC_PAUSE = 200,
         
-        /** Number of allocation between gc runs.
-          * A value of 1 means the it runs on each allocation (don't do that!)
-          * Higher values mean more garbage is accumulated. How that
-          * affects performance depends on the script the objects in use.
+        /** Default step multiplier, in percent. Each incremental step does this percentage of 
+          * the work needed to keep up with the bytes allocated since the last step. 
+          * See SetStepMul.
           */
-        GC_NUM_ALLOCS = 256,
+        GC_STEP_MUL = 200,
         
-        /** Number of iterations to perform per run.
-          * Setting this too low (< 25-50 or so) can affect performance
-          * more than setting it too high because of the overhead involved
-          * (particularly in the sweep stage where the active context is marked
-          * before each run).
+        /** Default time budget of an incremental step in microseconds. Zero means steps are 
+          * only limited by the step multiplier. See SetMaxPause.
           */
-        GC_NUM_ITERATIONS = 2048,
+        GC_MAX_PAUSE = 0,
+        
+        /** Number of bytes allocated between incremental steps during a full cycle. */
+        GC_STEP_SIZE = 16 * 1024,
+        
+        /** Smallest heap size, in bytes, that starts a full cycle. */
+        GC_MIN_HEAP = 2 * 1024 * 1024,
+        
+        /** Fewest objects an incremental step will process. */
+        GC_MIN_STEP = 64,
+        
+        /** Default number of young objects that triggers a minor collection. See SetNurserySize. */
+        GC_NURSERY_SIZE = 8192,
+        
+        /** External bytes charged since the last minor collection that trigger another. */
+        GC_NURSERY_BYTES = 1024 * 1024,
+        
+        /** Fewest objects the collector must own before marking is done in parallel. */
+        GC_PARALLEL_MIN = 4096,
+        
+        /** Number of dead objects handed to the sweep thread at once. */
+        GC_SWEEP_BATCH = 256,
+        
+        /** Most objects waiting for the sweep thread. Past this the objects are freed directly. */
+        GC_SWEEP_MAX_QUEUED = 64 * 1024,
+        
+        /** Fewest objects taken from the finalization queue at the end of a slice. */
+        GC_FINALIZE_STEP = 256,
     };
     
     enum ECollectorState 
@@ -176,7 +298,7 @@ public:
     /** Add a root object to this collector. */
     void AddAsRoot(GCObject*);
         
-    /** Remove a root object. The Object will be reinserted into the GC in the gray list. */
+    /** Remove a root object. The Object stays alive until the end of the current cycle. */
     bool RemoveAsRoot(GCObject*);
         
     /** Add an object to this collector.
@@ -187,24 +309,36 @@ public:
     /** Add an object to this collector without running the collector. */
     void AddNoRun(GCObject*);
     
-    /** Perform an incremental gc cycle, even if its not time to do so. 
+    /** Perform an incremental gc cycle, even if its not time to do so. Between 
+      * cycles this performs a minor collection instead.
       * @note You should never need to call this directly. 
       */
     void IncrementalRun();
     
+    /** Collect the nursery, promoting every young object that is still reachable.
+      * May start a full cycle if enough objects have been promoted. The object being
+      * added, newborn, is treated as a root.
+      */
+    void MinorRun(GCObject* newborn = 0);
+    
     /** Perform a complete gc cycle or finishes the current incremental cycle. */    
     void FullRun();
     
-    /** Move the passed argument to the gray list if its in the white list. */    
+    /** Mark the passed argument if it is unmarked and scan its references again. 
+      * Between cycles the object is remembered instead, so that the next minor 
+      * collection scans it.
+      */
     void MoveToGray(GCObject*);
     void MoveToGray(Value& v);    
     
-    /** Move the passed argument to the gray list no matter what list its in. */    
+    /** Mark the passed argument and scan its references again, even if it was never added
+      * to the collector. A young object is promoted and remembered.
+      */
     void ForceToGray(GCObject*);
     
     /** Call this method when adding a new reference (new_ref) to and existing 
       * object (old_ref). This is necessary in order to maintain the invariant 
-      * that no black object points to any white objects. If you do not perform 
+      * that no scanned object points to an unmarked object. If you do not perform 
       * a write barrier new_ref might be freed while old_ref still points to it.
       *   
       * @note   Is is only necessary to call WriteBarrier after an object has been 
@@ -216,36 +350,325 @@ public:
       * @param new_ref  [in] The reference being added.
       */
     void WriteBarrier(GCObject* old_ref, GCObject* new_ref);
+    void WriteBarrier(GCObject* old_ref, const Value& new_ref);
+    
+    /** Returns true if c was not reached by the last mark and the sweep in progress will free it.
+      * Weak references, like a Shape's children, must not hand out such an object.
+      */
+    INLINE bool IsDead(const GCObject* c) const
+    {
+        return GetPhase() == SWEEP && !Heap::IsMarked(c) && !c->IsPersistent();
+    }
+    
+    /** Keeps c, found through a weak reference, from being freed by the sweep in progress. 
+      * Only valid for objects without references, like Strings.
+      */
+    INLINE void Revive(GCObject* c)
+    {
+        if (IsDead(c))
+            Heap::SetMarked(c);
+    }
+    
+    /** Sets the percentage the heap has to grow by, relative to its size after the last full
+      * cycle, before a new cycle starts. 100 starts the next cycle right away, 200 waits for 
+      * the heap to double. Returns the previous value.
+      */
+    size_t SetPause(size_t pct);
+    
+    /** Sets how much work each incremental step does relative to the rate of allocation, in 
+      * percent. Larger values finish a cycle in fewer, longer steps. Returns the previous value.
+      */
+    size_t SetStepMul(size_t pct);
+    
+    /** Sets the most time, in microseconds, an incremental step should take. The step checks 
+      * the clock periodically so it can overrun slightly. Zero removes the limit. Returns the 
+      * previous value.
+      */
+    size_t SetMaxPause(size_t usecs);
+    
+    /** Sets the number of threads, counting the one running the collector, that mark objects 
+      * during a full cycle. Zero uses one thread per processor and one turns parallel marking 
+      * off. The threads are started the first time they are needed. Returns the previous value.
+      */
+    size_t SetMarkThreads(size_t n);
+    
+    /** Turns background sweeping on or off. When off every dead object is destroyed as soon as 
+      * it is swept. Turning it off waits for the sweep thread to finish. Returns the previous 
+      * setting.
+      */
+    bool SetBackgroundSweep(bool on);
+    
+    /** Sets the number of young objects that triggers a minor collection. Zero restores 
+      * GC_NURSERY_SIZE. A tiny nursery promotes objects almost as soon as they are created, which
+      * is useful for finding missing write barriers. Returns the previous value.
+      */
+    size_t SetNurserySize(size_t n);
     
-    INLINE bool IsGray (const GCObject* c) const { return c->gccolor == grays ->gccolor; }    
-    INLINE bool IsBlack(const GCObject* c) const { return c->gccolor == blacks->gccolor; }    
-    INLINE bool IsWhite(const GCObject* c) const { return c->gccolor == whites->gccolor; }
+    INLINE bool GetBackgroundSweep() const { return sweeper != 0; }
+    INLINE size_t GetPause()       const { return pause;       }
+    INLINE size_t GetStepMul()     const { return stepMul;     }
+    INLINE size_t GetMaxPause()    const { return maxPause;    }
+    INLINE size_t GetMarkThreads() const { return markThreads; }
+    INLINE size_t GetNurserySize() const { return nurserySize; }
+    
+    /** Stops the collector from running on its own. Explicit calls to FullRun still collect.
+      * Unlike Pause this does not nest.
+      */
+    void Stop();
+    
+    /** Lets the collector run on its own again after Stop. */
+    void Restart();
+    
+    INLINE bool IsStopped() const { return stopped; }
+    
+    /** Heap size, in bytes, at which the next full cycle starts. */
+    INLINE size_t GetThreshold() const { return threshold; }
     
     size_t GetNumObjects() const { return numObjects; }
     
+    /** Fills stats with the collector's counters. Cheap enough to call at any time. */
+    void GetStats(GCStats& stats) const;
+    
+    /** Counts every live object by GCObject::GetGCName. Visits every object so the cost is 
+      * proportional to the size of the heap. The names belong to the objects and are only 
+      * valid until the collector next runs.
+      */
+    void GetLiveCounts(Buffer<GCTypeCount>& counts);
+    
+    /** Calls v->Visit for every object the collector owns. */
+    void VisitObjects(GCVisitor* v);
+    
+    /** Calls v->Visit for every root: the root list, the objects passed to ForceToGray by 
+      * Engine::ScanRoots and the active context. Objects may be visited more than once.
+      */
+    void VisitRoots(GCVisitor* v);
+    
+    /** Calls v->Visit for every object c references, using c's MarkRefs. Nothing is marked. */
+    void VisitRefs(GCObject* c, GCVisitor* v);
+    
+    size_t GetNumYoung()       const { return numYoung;    } //!< Number of objects in the nursery.
+    size_t GetNumMinorCycles() const { return minorCycles; } //!< Number of minor collections performed.
+    size_t GetNumMajorCycles() const { return majorCycles; } //!< Number of full cycles started.
+    size_t GetNumPromoted()    const { return numPromoted; } //!< Number of young objects promoted.
+    
     void FreeObject(GCObject* t);
+    
+    /** Tells the collector that the external bytes of an object, see GCObject::GetExternalBytes,
+      * changed from before to after. Growth is paced like memory allocated from the Heap.
+      */
+    INLINE void ChargeExternal(size_t before, size_t after)
+    {
+        if (after > before)
+        {
+            externalAllocated += after - before;
+            externalBytes     += after - before;
+        }
+        else
+        {
+            externalBytes -= Min(before - after, externalBytes);
+        }
+    }
+    
+    /** External bytes charged by objects that are still alive. */
+    INLINE size_t GetExternalBytes() const { return externalBytes; }
+    
+    /** Sweeps pages of sizeClass until one has a free cell. Called by the Heap before it takes 
+      * a fresh page. Returns true if cells were freed.
+      */
+    bool SweepClass(size_t sizeClass);
 private:
     friend class GCObject;
     
     void Initialize();
     
-    INLINE bool NextIteration() { return(iteration++ < GC_NUM_ITERATIONS); }
+    INLINE bool NextIteration() 
+    {
+        // The clock is only read every 256 objects.
+        return iteration++ < stepWork && ((iteration & 0xFF) || !OverBudget());
+    }
+    
+    bool OverBudget() const;
+    
+    /** Has enough been allocated since the last step that another step is due. */
+    bool StepDue() const;
+    
+    /** Is a minor collection due, because of the number of young objects or the external bytes
+      * charged since the last one.
+      */
+    INLINE bool MinorDue() const
+    {
+        return numYoung >= nurserySize || externalAllocated - minorExternal >= GC_NURSERY_BYTES;
+    }
+    
+    /** Bytes allocated from the Heap plus external bytes charged, over the collector's lifetime. */
+    u8 GetBytesAllocated() const;
+    
+    /** Work out how many objects the next step processes and when it has to stop. */
+    void BeginStep();
+    
+    /** The state the collector is in, or was in before it was paused. */
+    INLINE ECollectorState GetPhase() const { return state == SUSPENDED ? savedState : state; }
     
     bool IncrementalMoveRoots(bool);
     bool IncrementalScan(bool);
     bool IncrementalSweep(bool);
     
+    /** Is the heap large enough, and are there threads enough, to mark in parallel. */
+    bool UseParallelScan() const;
+    
+    /** Empty the gray stack by marking everything reachable from it on the mark threads. */
+    void ParallelScan();
+    
+    /** Claim an unmarked object during ParallelScan. Called from the mark threads. */
+    void MarkShared(GCObject*);
+    
+    /** Pop objects off the gray stack and mark their references, until it is empty or, if b is
+      * true, the step runs out.
+      */
+    void ScanGrays(bool b);
+    
+    /** Start the sweep: remember every page of the heap as unswept. */
+    void BeginSweep();
+    
+    /** Free the dead objects of page. If lazy, the objects are destroyed right away so their 
+      * cells can be reused. Returns the number of objects freed.
+      */
+    size_t SweepPage(Heap::Page* page, bool lazy);
+    
+    /** Mark c and push it onto the gray stack, if it is not marked yet. */
+    INLINE void Shade(GCObject* c)
+    {
+        if (Heap::SetMarked(c))
+            grays.Push(c);
+    }
+    
+    /** Set c's object bit if the collector does not own it yet. */
+    void Register(GCObject* c);
+    
     void FreeAll();
-    void FreeList(GCObject* list);
+    
+    /** Destroy an object whose Finalize returned true, now, on the sweep thread or from the 
+      * finalization queue. 
+      */
+    void FreeDead(GCObject*);
+    
+    /** Give the Heap back the memory of the objects the sweep thread has destroyed and empty 
+      * part of the finalization queue. Called at the end of each slice that sweeps.
+      */
+    void ReleaseSwept();
+    
+    /** Wait for the sweep thread, then empty the finalization queue. */
+    void FinishSweep();
+    
+    /** Heap bytes in use, not counting dead objects waiting for the sweep thread, plus the 
+      * external bytes of live objects. 
+      */
+    size_t GetLiveBytes() const;
     
     void Reset();
     
+    /** Start timing a slice. */
+    void BeginSlice();
+    
+    /** Record the length of the slice started by BeginSlice. */
+    void EndSlice();
+    
+    /** Returns the slot of table that holds, or should hold, the index of name in counts. */
+    static size_t FindCount(Buffer<size_t>& table, Buffer<GCTypeCount>& counts, const char* name);
+    
+    /** Add the time since the last lap to phaseTime. */
+    void Lap(u8& phaseTime);
+    
+    /** Work out the heap size that starts the next full cycle. */
+    void SetThreshold();
+    
+    /** Make c old and, while marking, mark and rescan it. Registers c if needed. */
+    void Regray(GCObject* c);
+    
+    /** Add an old object to the remembered set. */
+    void Remember(GCObject*);
+    
+    /** Mark the young objects referenced by c during a minor collection. */
+    void ScanYoungRefs(GCObject* c);
+    
+    /** Promote a young object reached during a minor collection. */
+    void Promote(GCObject*);
+    
+    void SweepNursery();
+    
+    /** Make every young object old. Called before a full cycle starts. */
+    void FlushNursery();
+    
     size_t numObjects;
     size_t maxObjects;
     size_t totalObjects;
     
-    size_t numAllocations;
     size_t iteration;
+    size_t stepWork;        //!< Number of objects the current step may process.
+    u8     stepStart;       //!< GetBytesAllocated when the last step was taken.
+    u8     stepDeadline;    //!< Time, from Pika_Microseconds, the current step should end by.
+    
+    size_t pause;           //!< See SetPause.
+    size_t stepMul;         //!< See SetStepMul.
+    size_t maxPause;        //!< See SetMaxPause.
+    size_t markThreads;     //!< See SetMarkThreads.
+    size_t threshold;       //!< Heap size that starts the next full cycle.
+    bool   stopped;         //!< See Stop.
+    
+    GCStats stats;
+    u8      sliceStart;     //!< Time the current slice started.
+    u8      lapStart;       //!< Time the current phase of the slice started.
+    
+    size_t externalBytes;      //!< See GetExternalBytes.
+    u8     externalAllocated;  //!< External bytes charged over the collector's lifetime.
+    u8     minorExternal;      //!< externalAllocated at the end of the last minor collection or full cycle.
+    
+    size_t numYoung;        //!< Objects in the nursery.
+    size_t nurserySize;     //!< See SetNurserySize.
+    size_t minorCycles;
+    size_t majorCycles;
+    size_t numPromoted;
+    bool   marking;         //!< Is a full cycle in progress.
+    
+    enum EMarkMode
+    {
+        MARK_full,  //!< Marking, if a cycle is running, is done by GCObject::Mark.
+        MARK_minor, //!< A minor collection is in progress.
+        MARK_visit, //!< MarkRefs and ScanRoots report objects to visitor.
+        MARK_parallel, //!< ParallelScan is running, objects are claimed by MarkShared.
+    };
+    EMarkMode   mode;
+    GCVisitor*  visitor;
+    GCMarkPool* markPool;   //!< Mark threads used by ParallelScan, started on demand.
+    GCSweeper*  sweeper;    //!< Sweep thread, null when background sweeping is off.
+    
+    Buffer<GCObject*> finalizing; //!< Dead objects waiting to be destroyed by ReleaseSwept.
+    
+    /** Handles GCObject::Mark when mode is not MARK_full. */
+    INLINE void MarkOther(GCObject* c)
+    {
+        if (mode == MARK_minor)
+        {
+            if (c->IsYoung())
+                Promote(c);
+        }
+        else if (mode == MARK_parallel)
+        {
+            MarkShared(c);
+        }
+        else
+        {
+            visitor->Visit(c);
+        }
+    }
+    
+    Buffer<GCObject*> remembered; //!< Old objects that may reference young objects.
+    Buffer<GCObject*> promoted;   //!< Promoted objects that still need to be scanned.
+    Buffer<GCObject*> nursery;    //!< Objects added since the last minor collection. Promoted ones are skipped.
+    Buffer<GCObject*> grays;      //!< Marked objects whose references have not been scanned.
+    
+    Buffer<Heap::Page*> unswept[Heap::NUM_CLASSES + 1]; //!< Pages left to sweep, by size class.
+    size_t              sweepClass; //!< Size class the incremental sweep is working on.
     
     int pauseDepth;
     
@@ -262,29 +685,6 @@ private:
     GCObject* activeCtx;
     
     /*  
-        Circular list of all GCObjects we are resposible for.
-        
-        :::::::::::::::::::::::::::::::::::::::::::::::::::::
-        ::              Collector layout                   ::
-        :::::::::::::::::::::::::::::::::::::::::::::::::::::
-        
-                             black 
-                     .----> /    \
-             sweep--/      /      \
-                   /      ^        v
-                  /      /          \
-                  '---> /            \
-                      white <--<--< gray 
-                            ^     ^
-                            |     |
-                            '--+--'
-                               |
-                             scan 
-        
-        Scan object moves from gray list during the scan phase.
-        Sweep object moves through the white list freeing each 
-        un-reachable object during the sweep phase.
-        
         :::::::::::::::::::::::::::::::::::::::::::::::::::::
         ::                 Root objects                    ::
         :::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -298,20 +698,15 @@ private:
                            '---<------<---'
     
     */
-    GCObject* blacks; //!< All objects seen and marked.
-    GCObject* grays;  //!< All objects seen but not marked.
-    GCObject* whites; //!< All objects unmarked and unseen; Potential garbage.
-    GCObject* scan;   //!< Points to the next object to be marked. Can point anywhere between grays and whites.
-    GCObject* sweep;  //!< Used during sweep phase, point to the next object to be freed.    
     RootObject* head; //!< Circular list of all root objects.
 };
 
 INLINE void MarkValue(Collector* c, Value& v)
 {
-    ASSERT(v.tag < MAX_TAG);
+    ASSERT(v.GetTag() < MAX_TAG);
 
-    if (v.tag >= TAG_gcobj && v.val.gcobj)
-        v.val.gcobj->Mark(c);
+    if (v.GetTag() >= TAG_gcobj && v.GetGCObject())
+        v.GetGCObject()->Mark(c);
 }
 
 INLINE void MarkValues(Collector* c, Value *begin, Value* end)
@@ -5,227 +5,29 @@
 #include "Pika.h"
 #include "PAst.h"
 #include "PCompiler.h"
-#include "PContext_Ops.inl"
+#include "POptimizer.h"
 
-#define BINARY_FOLD(op, fun)                                                                         \
-case op:                                                                                             \
-{                                                                                                    \
-            if ((res1.tag == TAG_integer || res1.tag == TAG_real) &&                                 \
-                (res2.tag == TAG_integer || res2.tag == TAG_real))                                   \
-            {                                                                                        \
-                                                                                                     \
-                prevprev->opcode = OP_pushliteral;                                                   \
-                prev->Unattach(); curr->Unattach();                                                  \
-                                                                                                     \
-                if (res1.tag == TAG_integer && res2.tag == TAG_integer)                              \
-                {                                                                                    \
-                    if (op == OP_div && (res1.val.integer % res2.val.integer != 0))                  \
-                    {                                                                                \
-                        preal_t const ra = (preal_t)res1.val.integer;                                \
-                        preal_t const rb = (preal_t)res2.val.integer;                                \
-                        res1.Set((preal_t)(ra/rb));                                                  \
-                        prevprev->operand = lp->Add(res1.val.real);                                  \
-                    }                                                                                \
-                    else                                                                             \
-                    {                                                                                \
-                        fun(res1.val.integer, res2.val.integer);                                     \
-                        prevprev->operand = lp->Add(res1.val.integer);                               \
-                    }                                                                                \
-                }                                                                                    \
-                else                                                                                 \
-                {                                                                                    \
-                    if (res1.tag == TAG_integer)                                                     \
-                        res1.Set((float)res1.val.integer);                                           \
-                    if (res2.tag == TAG_integer)                                                     \
-                        res2.Set((float)res2.val.integer);                                           \
-                                                                                                     \
-                    fun(res1.val.real, res2.val.real);                                               \
-                    if (op == OP_idiv)                                                               \
-                    {                                                                                \
-                        prevprev->operand = lp->Add(Pika_RealToInteger(res1.val.real));              \
-                    }                                                                                \
-                    else                                                                             \
-                    {                                                                                \
-                        prevprev->operand = lp->Add(res1.val.real);                                  \
-                    }                                                                                \
-                }                                                                                    \
-                                                                                                     \
-                                                                                                     \
-                /*Pika_delete(prev);Pika_delete(curr);*/                                             \
-                curr = prevprev;                                                                     \
-                                                                                                     \
-            }                                                                                        \
-    }break;
-
-
-#define CONTINUE_FOLD_LOOP()  \
-    curr = curr->next; continue;
-
-// Folds constant arithmetic|bit operations.
-//
-// We don't want to do any non-trivial conversions or report Type-Errors on operations.
-// Basically do the most we can do without changing the result of the program.
 namespace pika {
 
-void DoConstantFold(Instr* ir, LiteralPool* lp)
-{
-    Instr* curr = ir;
-
-    ir->label = true; /* not really needed. */
-
-    while (curr)
-    {
-        bool prevIsConst = false;
-        bool prevprevIsConst = false;
-        Instr* prev = curr->prev;
-        Instr* prevprev = 0;
-
-        if (prev)
-        {
-            prevIsConst = (prev->opcode == OP_pushliteral);
-            prevprev = prev->prev;
-
-            if (prevprev)
-            {
-                prevprevIsConst = (prevprev->opcode == OP_pushliteral);
-            }
-        }
-
-        // A conditional jump.
-        // If the condition is always met (ie is a literal), we turn it into a unconditional jump.
-
-        if (((curr->opcode == OP_jumpiftrue) || (curr->opcode == OP_jumpiffalse))
-            && (prevIsConst || (prev && (prev->opcode == OP_pushtrue || prev->opcode == OP_pushfalse || prev->opcode == OP_pushnull)))
-            && !curr->label)
-        {
-            bool jmp = (curr->opcode == OP_jumpiftrue);
-
-            switch (prev->opcode)
-            {
-            case OP_pushnull:  jmp = !jmp; break;
-            case OP_pushtrue:  /* jmp =  jmp; */ break; // noop
-            case OP_pushfalse: jmp = !jmp; break;
-
-            case OP_pushliteral:
-            {
-                u2 index = prev->operand;
-                Value res = lp->Get(index);
-
-                if (res.tag == TAG_integer)
-                {
-                    jmp = (res.val.integer != 0) == jmp;
-                    break;
-                }
-                else if (res.tag == TAG_real)
-                {
-                    jmp = (Pika_RealToBoolean(res.val.real) == jmp);
-                    break;
-                }
-            }
-
-            //  Fall Through
-            //  |
-            //  V
-
-            default:
-                CONTINUE_FOLD_LOOP();
-            }
-
-            prev->operand = prev->operandu1 = prev->operandu2 = 0;
-            prev->target  = 0;
-
-            if (jmp)
-            {
-                prev->opcode = OP_jump;
-                prev->target = curr->target;
-            }
-            else
-            {
-                prev->opcode = OP_nop;
-            }
-
-            curr->Unattach();
-            //Pika_delete(curr);
-            curr = prev;
-        }
-        else if (curr->opcode == OP_neg && prevIsConst && !curr->label)
-        {
-            u2 index = prev->operand;
-            Value res = lp->Get(index);
-
-            if (res.tag == TAG_integer)
-            {
-                prev->operand = lp->Add(-res.val.integer);
-                curr->Unattach();
-                //Pika_delete(curr);
-                curr = prev;
-            }
-            else if (res.tag == TAG_real)
-            {
-                prev->operand = lp->Add(-res.val.real);
-                curr->Unattach();
-                //Pika_delete(curr);
-                curr = prev;
-            }
-        }
-        else if ((curr->opcode >= OP_add && curr->opcode <= OP_mod) &&
-                 prevIsConst     &&
-                 prevprevIsConst &&
-                 !curr->label    &&
-                 !prev->label)
-        {
-            u2 idx2 = prev->operand;
-            u2 idx1 = prevprev->operand;
-            Value res1 = lp->Get(idx1);
-            Value res2 = lp->Get(idx2);
-
-
-            if (curr->opcode == OP_div || curr->opcode == OP_idiv || curr->opcode == OP_mod)
-            {
-                if (res2.tag == TAG_integer && res2.val.integer == 0)
-                {
-                    /* division/modulo by zero is a RuntimeError so we skip this operator and let the interpreter
-                     * raise an exception.
-                     *
-                     * TODO: provide a compile time error or warning for division by zero.
-                     */
-                    CONTINUE_FOLD_LOOP();
-                }
-            }
-            
-            switch (curr->opcode)
-            {
-                BINARY_FOLD(OP_add,  add_num)
-                BINARY_FOLD(OP_sub,  sub_num)
-                BINARY_FOLD(OP_mul,  mul_num)
-                BINARY_FOLD(OP_div,  div_num)
-                BINARY_FOLD(OP_idiv, div_num)
-                BINARY_FOLD(OP_mod,  mod_num)
-                default: break;
-            }
-        }
-        CONTINUE_FOLD_LOOP();
-    }
-}
-
-Compiler::Compiler(CompileState* state, Instr *ir, Def* d, LiteralPool* lp)
+Compiler::Compiler(CompileState* state, const InstrList& ir, Def* d, LiteralPool* lp)
         : max_stack(0),
         def(d),
-        start(ir),
-        state(state)
-{
-    DoConstantFold(ir, lp);
-}
+        code(ir),
+        literals(lp),
+        state(state) {}
 
 Compiler::~Compiler() {}
 
 void Compiler::DoCompile()
 {
-    if (!start)
+    Optimizer opt(code, literals, state->engine->GetOptimizeLevel());
+    opt.Run();
+    
+    if (!code.head)
         return;
 
     max_stack    = 0;
-    Instr* icurr = start;
+    Instr* icurr = code.head;
     int    space = 0;
 
     while (icurr)
@@ -237,6 +39,9 @@ void Compiler::DoCompile()
     }
 
     Emit();
+    
+    if (state->engine->GetOptimizeLevel() >= PIKA_FUSE_LEVEL)
+        Fuse();
 }
 
 void Compiler::AddWord(code_t w)
@@ -246,9 +51,14 @@ void Compiler::AddWord(code_t w)
 
 void Compiler::Emit()
 {
-    start->CalcPos();
-    Instr* curr = start;
+    if (code.CalcPos() > PIKA_MAX_BYTECODE)
+    {
+        state->SyntaxException(Exception::ERROR_syntax, def->line,
+                               "function is too large, its bytecode exceeds %d words.", PIKA_MAX_BYTECODE);
+    }
+    Instr* curr = code.head;
     Instr* next = 0;
+    Instr* prev = 0;
 
     while (curr)
     {
@@ -275,6 +85,21 @@ void Compiler::Emit()
                 }
             }
             break;
+        case OP_dotget:
+        case OP_dotset:
+            {
+                // Tag the member access with the literal index of the member's name so
+                // that its inline cache can be found. (see Context::GetMemberCache)
+                if (prev && prev->opcode >= OP_pushliteral0 && prev->opcode <= OP_pushliteral4)
+                {
+                    curr->operand = (u2)(prev->opcode - OP_pushliteral0);
+                }
+                else if (prev && prev->opcode == OP_pushliteral)
+                {
+                    curr->operand = prev->operand;
+                }
+            }
+            break;
         default: break;
         }
         
@@ -331,10 +156,144 @@ void Compiler::Emit()
         }
         break;
         }
+        if (fmt != OF_zero)
+        {
+            prev = curr;
+        }
         curr = next;
     }
 }
 
+namespace {
+
+const int MAX_FUSED = 4; // Longest sequence of instructions a superinstruction replaces.
+
+struct FusedSequence
+{
+    Opcode fused;                   //!< Superinstruction that replaces the first instruction.
+    int    length;                  //!< Number of instructions in the sequence.
+    Opcode sequence[MAX_FUSED];     //!< Generic opcodes of the sequence.
+};
+
+/* Sequences were picked from the output of bench/opcodestats. Longer sequences come first so that
+ * they are preferred over their prefixes. */
+const FusedSequence FusedSequences[] = {
+    { OP_add_ll_sl,  4, { OP_pushlocal, OP_pushlocal,   OP_add, OP_setlocal    } },
+    { OP_add_lk_sl,  4, { OP_pushlocal, OP_pushliteral, OP_add, OP_setlocal    } },
+    { OP_sub_lk_sl,  4, { OP_pushlocal, OP_pushliteral, OP_sub, OP_setlocal    } },
+    { OP_eq_ll_jf,   4, { OP_pushlocal, OP_pushlocal,   OP_eq,  OP_jumpiffalse } },
+    { OP_ne_ll_jf,   4, { OP_pushlocal, OP_pushlocal,   OP_ne,  OP_jumpiffalse } },
+    { OP_lt_ll_jf,   4, { OP_pushlocal, OP_pushlocal,   OP_lt,  OP_jumpiffalse } },
+    { OP_gt_ll_jf,   4, { OP_pushlocal, OP_pushlocal,   OP_gt,  OP_jumpiffalse } },
+    { OP_lte_ll_jf,  4, { OP_pushlocal, OP_pushlocal,   OP_lte, OP_jumpiffalse } },
+    { OP_gte_ll_jf,  4, { OP_pushlocal, OP_pushlocal,   OP_gte, OP_jumpiffalse } },
+    { OP_eq_lk_jf,   4, { OP_pushlocal, OP_pushliteral, OP_eq,  OP_jumpiffalse } },
+    { OP_ne_lk_jf,   4, { OP_pushlocal, OP_pushliteral, OP_ne,  OP_jumpiffalse } },
+    { OP_lt_lk_jf,   4, { OP_pushlocal, OP_pushliteral, OP_lt,  OP_jumpiffalse } },
+    { OP_gt_lk_jf,   4, { OP_pushlocal, OP_pushliteral, OP_gt,  OP_jumpiffalse } },
+    { OP_lte_lk_jf,  4, { OP_pushlocal, OP_pushliteral, OP_lte, OP_jumpiffalse } },
+    { OP_gte_lk_jf,  4, { OP_pushlocal, OP_pushliteral, OP_gte, OP_jumpiffalse } },
+    
+    { OP_add_ll,     3, { OP_pushlocal, OP_pushlocal,   OP_add    } },
+    { OP_sub_ll,     3, { OP_pushlocal, OP_pushlocal,   OP_sub    } },
+    { OP_mul_ll,     3, { OP_pushlocal, OP_pushlocal,   OP_mul    } },
+    { OP_add_lk,     3, { OP_pushlocal, OP_pushliteral, OP_add    } },
+    { OP_sub_lk,     3, { OP_pushlocal, OP_pushliteral, OP_sub    } },
+    { OP_mul_lk,     3, { OP_pushlocal, OP_pushliteral, OP_mul    } },
+    { OP_dotget_lk,  3, { OP_pushlocal, OP_pushliteral, OP_dotget } },
+    { OP_dotget_dk,  3, { OP_dup,       OP_pushliteral, OP_dotget } },
+    
+    { OP_pushll,              2, { OP_pushlocal, OP_pushlocal   } },
+    { OP_pushlk,              2, { OP_pushlocal, OP_pushliteral } },
+    { OP_add_sl,              2, { OP_add,       OP_setlocal    } },
+    { OP_setlocal_jump,       2, { OP_setlocal,  OP_jump        } },
+    { OP_pushnull_pushglobal, 2, { OP_pushnull,  OP_pushglobal  } },
+    { OP_ret_l,               2, { OP_pushlocal, OP_ret         } },
+    { OP_nop, 0, { OP_nop } },
+};
+
+/* Returns the generic opcode of a narrowed pushlocal, pushliteral or setlocal. The index it
+ * refers to is returned in operand. Any other opcode is returned as is. */
+Opcode GetGenericOpcode(const Instr* ir, u2& operand)
+{
+    Opcode oc = ir->opcode;
+    operand = ir->operand;
+    
+    if (oc >= OP_pushlocal0 && oc < OP_pushlocal)
+    {
+        operand = (u2)(oc - OP_pushlocal0);
+        return OP_pushlocal;
+    }
+    else if (oc >= OP_pushliteral0 && oc < OP_pushliteral)
+    {
+        operand = (u2)(oc - OP_pushliteral0);
+        return OP_pushliteral;
+    }
+    else if (oc >= OP_setlocal0 && oc < OP_setlocal)
+    {
+        operand = (u2)(oc - OP_setlocal0);
+        return OP_setlocal;
+    }
+    return oc;
+}
+
+}// namespace
+
+void Compiler::Fuse()
+{
+    Instr* parts[MAX_FUSED];
+    u2     line = 0; // Line of the current position, see CompileFunction.
+    
+    for (Instr* curr = code.head; curr; curr = curr->next)
+    {
+        if (curr->line)
+            line = curr->line;
+        
+        if (OpcodeLength(curr->opcode) == 0)
+            continue;
+        
+        // Gather the instructions that follow in the same line.
+        
+        int count = 0;
+        for (Instr* ir = curr; ir && count < MAX_FUSED; ir = ir->next)
+        {
+            if (ir != curr && ir->line && ir->line != line)
+                break;
+            if (OpcodeLength(ir->opcode) != 0)
+                parts[count++] = ir;
+        }
+        
+        for (const FusedSequence* seq = FusedSequences; seq->length; ++seq)
+        {
+            if (seq->length > count)
+                continue;
+            
+            u2  operand = 0;
+            int i = 0;
+            for (; i < seq->length && GetGenericOpcode(parts[i], operand) == seq->sequence[i]; ++i) {}
+            
+            if (i != seq->length)
+                continue;
+            
+            // Superinstructions read the operands of the other instructions from their words, so
+            // narrowed instructions are widened.
+            
+            for (i = 1; i < seq->length; ++i)
+            {
+                Opcode oc = GetGenericOpcode(parts[i], operand);
+                if (oc != parts[i]->opcode)
+                    bytecode[parts[i]->pos] = PIKA_MAKE_W(oc, operand);
+            }
+            
+            GetGenericOpcode(curr, operand);
+            bytecode[curr->pos] = OpcodeFormats[seq->fused] == OF_w ? PIKA_MAKE_W(seq->fused, operand)
+                                                                   : PIKA_MAKE_B(seq->fused);
+            curr = parts[seq->length - 1];
+            break;
+        }
+    }
+}
+
 void PrintBytecode(const u1* bc, size_t len)// OPCODE-CHANGE
 {
     const u1* curr = bc;
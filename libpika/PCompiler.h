@@ -12,13 +12,15 @@ namespace pika {
 struct CompileState;
 typedef Buffer<code_t> CodeBuff;
 
-/** Compiles the intermediate representation (aka the Instr class) into bytecode.
+/** Compiles the intermediate representation (aka the Instr class) into bytecode. The code is first
+  * run through the Optimizer at the Engine's optimization level. From PIKA_FUSE_LEVEL on the
+  * bytecode then gets superinstructions.
   */
 class Compiler
 {
 public:
     Compiler(CompileState*, 
-             Instr*, 
+             const InstrList&, 
 	         Def*,
              LiteralPool*);
 
@@ -29,16 +31,26 @@ public:
     code_t* GetBytecode()       { return (bytecode.GetSize()) ? &bytecode[0] : 0; }    
 	u2      GetBytecodeLength() { return (u2)bytecode.GetSize(); }    
 	int     GetStackLimit()     { return max_stack; }
+    
+    /** The code that was compiled. Only valid after DoCompile since the Optimizer may change it. */
+    const InstrList& GetCode() const { return code; }
 
 private:
     void Emit();
     void AddWord(code_t w);
     
-    int max_stack;       //!< max space the operand stack needs.
-    Def* def;            //!< def that this code belongs to.
-    Instr* start;        //!< def that this code belongs to.
-    CompileState* state; //!< Compile state we are compiling from.
-    CodeBuff bytecode;   //!< Byte code result of the compilation.
+    /** Replaces the first word of each common sequence of instructions in the bytecode with a
+      * superinstruction. The words that follow are kept so that the bytecode's length, line
+      * information and jump targets do not change. Only sequences within a single line are fused.
+      */
+    void Fuse();
+    
+    int max_stack;         //!< max space the operand stack needs.
+    Def* def;              //!< def that this code belongs to.
+    InstrList code;        //!< Code being compiled.
+    LiteralPool* literals; //!< Literals used by the code.
+    CompileState* state;   //!< Compile state we are compiling from.
+    CodeBuff bytecode;     //!< Byte code result of the compilation.
 };
 
 void PrintBytecode(const u1* bc, size_t len);
@@ -35,10 +35,6 @@
 /* Print debug trace calls to stdout. */
 #define PIKA_ENABLE_TRACE
 
-/* Use mem-pools for Slot creation.
-   Sometimes it can be faster but it is not thread safe. */
-/* #define PIKA_USE_SLOT_POOL */
-
 /* Use doubles instead of floats for the type Real. */
 #define PIKA_64BIT_REAL
 
@@ -48,6 +44,11 @@
 /* Disable the calling of hooks. Speeds up execution but debugging becomes impossible. */
 /* #define PIKA_NO_HOOKS */
 
+/* Dispatch every instruction through each function's direct-threaded code instead of the opcode
+ * jump table. Only used with labels as values dispatch, see PContext_Run.inl. Off by default since
+ * it makes call heavy code slower. */
+/* #define PIKA_THREADED_CODE */
+
 /* Incorrect number of arguments passed to a function will cause an exception */
 /* #define PIKA_STRICT_ARGC */
 
@@ -65,13 +66,11 @@
 
 /* Member Tables are created from mem-pools instead of new/delete. */
 #define PIKA_USE_TABLE_POOL
-#define PIKA_USE_ARRAY_POOL
 
 /* Size of each mempool block or arena. By default there are <100 Object that 
  * need a table before any script is executed. Its recommended that you do not
  * lower it below 256 unless you are pressed for memory. */
 #define TABLE_POOL_SIZE 1024
-#define ARRAY_POOL_SIZE
 // Shared library configuration ////////////////////////////////////////////////////////////////////
 
 #if defined(_MSC_VER)//         Visual Studio
@@ -110,6 +109,14 @@
 #   include     "PConfig_Platform.h"
 #endif
 
+/* NaN-boxed Values hold reals as doubles and integers in 32 bits. */
+#if defined(PIKA_NANBOX)
+#   if !defined(PIKA_64BIT_REAL)
+#       error PIKA_NANBOX requires PIKA_64BIT_REAL.
+#   endif
+#   undef PIKA_64BIT_INT
+#endif
+
 // File Ext & Path config //////////////////////////////////////////////////////////////////////////
 
 #define PIKA_EXT                      ".pika"
@@ -118,6 +125,16 @@
 #define PIKA_EXT_ALT                  ".pi"
 #define PIKA_COMPILED_EXT_ALT         ".cpi"
 
+#define PIKA_COMPILED_VERSION         3         // Increment when the compiled script format changes.
+#define PIKA_COMPILED_DIR_ENV         "PIKA_CACHE_DIR"
+#define PIKA_COMPILED_DISABLE_ENV     "PIKA_NO_CACHE"
+#define PIKA_GC_MARK_THREADS_ENV      "PIKA_GC_MARK_THREADS" // Default for Collector::SetMarkThreads.
+#define PIKA_GC_BACKGROUND_SWEEP_ENV  "PIKA_GC_BACKGROUND_SWEEP" // Default for Collector::SetBackgroundSweep.
+#define PIKA_GC_NURSERY_SIZE_ENV      "PIKA_GC_NURSERY_SIZE" // Default for Collector::SetNurserySize.
+#define PIKA_STRING_INTERN_LIMIT_ENV  "PIKA_STRING_INTERN_LIMIT" // Overrides PIKA_STRING_INTERN_LIMIT.
+#define PIKA_HASH_SEED_ENV            "PIKA_HASH_SEED" // Fixed seed for String hash codes instead of a random one.
+#define PIKA_OPTIMIZE_LEVEL_ENV       "PIKA_OPTIMIZE" // Overrides PIKA_OPTIMIZE_LEVEL.
+
 #if defined(PIKA_WIN)
 #   define PIKA_PATH_SEP_CHAR         '\\'
 #   define PIKA_PATH_SEP              "\\"
@@ -191,6 +208,10 @@ Keep in mind the range specified [min .. max ] and the limits of the data type u
 #define PIKA_MAX_OPERAND_STACK      1048575     // Maximum size an operand stack can grow to.          PIKA_INIT_OPERAND_STACK .. max(size_t)
 #define PIKA_STACK_GROWTH_RATE      1.5         // Growth Rate of an operand stack.                    Must be > 1.0.
 #define PIKA_MAX_STACKLIMIT         0x7FFF      // Maximum operand stack limit for a single function.
+#define PIKA_MAX_BYTECODE           0xFFFF      // Maximum length, in words, of a single function's bytecode. Jump targets are u2 positions.
+#define PIKA_OPTIMIZE_LEVEL         3           // Default optimization level of the compiler, see Optimizer.
+#define PIKA_MAX_OPTIMIZE_LEVEL     3           // Highest optimization level.
+#define PIKA_FUSE_LEVEL             3           // Lowest optimization level that emits superinstructions, see Compiler::Fuse.
 #define PIKA_OPERAND_STACK_EXTRA    8           // Extra space added to a context's operand stack in-order to support type conversions and override operator calls.
 #define PIKA_NATIVE_STACK_EXTRA     16          // Amount you can safely push without checking for an operand stack overflow. Should be at least PIKA_OPERAND_STACK_EXTRA.
 #define PIKA_MAX_NATIVE_RECURSION   128         // Maximum number of recursive native calls allowed. And the number of interpreter calls allowed.
@@ -198,8 +219,14 @@ Keep in mind the range specified [min .. max ] and the limits of the data type u
 #define PIKA_MAX_ARGS               128
 #define PIKA_MAX_KWARGS             128
 #define PIKA_MAX_NESTED_FUNCTIONS   255
+#define PIKA_MEMBER_CACHE_SIZE      4           // Number of receiver types cached by each member access inline cache. 1 .. max( u1 )
+#define PIKA_MAX_SHAPE_SLOTS        32          // Instance variables an object can have before it moves from a Shape to a Table. 0 .. max( u2 ) - 1
+#define PIKA_MAX_SHAPE_CHILDREN     64          // Transitions a Shape can have. Objects adding any other variable move to a Table. 1 .. max( u2 )
 #define PIKA_BUFFER_MAX_LEN         (PINT_MAX)              // Max length a vector or other buffer may be.
 #define PIKA_STRING_MAX_LEN         (PIKA_BUFFER_MAX_LEN)   // Max length a string may be.
+#define PIKA_STRING_INTERN_LIMIT    (64 * 1024)             // Longer strings are not interned and hash lazily.
+#define PIKA_STRING_INTERN_MIN      256                     // Smallest intern limit allowed. Names the engine compares by pointer must stay interned.
+#define PIKA_COMPILE_ARENA_BLOCK    (64 * 1024)             // Size of the blocks the AST, Instrs and SymbolTables of a compilation are allocated from.
 #define PIKA_MAX_SLOTS              (0xFFFF)                // Max number of slots an object can have. doesn't effect vectors or strings.
 
 
@@ -20,6 +20,7 @@ typedef signed   __int32                s4;
 typedef signed   __int64                s8;
 
 #define PIKA_FORCE_INLINE               inline
+#define PIKA_THREAD_LOCAL               __thread
 #define PIKA_32
 #define PIKA_ALIGN                      8
 
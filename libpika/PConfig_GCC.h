@@ -57,6 +57,7 @@ typedef signed   long long  s8;
 #endif
 
 #define PIKA_FORCE_INLINE   __inline__
+#define PIKA_THREAD_LOCAL   __thread
 
 /* Are we using a 64bit arch. */
 #if defined(__amd64) || defined(__x86_64__)
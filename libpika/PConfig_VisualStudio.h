@@ -35,6 +35,7 @@ typedef signed   __int64                s8;
 #endif
 
 #define PIKA_ALIGN                      8
+#define PIKA_THREAD_LOCAL               __declspec(thread)
 
 #define PIKA_STRUCT_ALIGN(n, name)      __declspec(align(n)) struct PIKA_API name
 #define PIKA_CLASS_ALIGN(n, name)       __declspec(align(n)) class  PIKA_API name
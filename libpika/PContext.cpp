@@ -12,6 +12,7 @@
 #include "PEngine.h"
 #include "PDictionary.h"
 #include "PNativeBind.h"
+#include "PProfiler.h"
 #include "PContext_Ops.inl"
 
 #include "PGenerator.h"
@@ -34,7 +35,7 @@ const char* GetContextStateName(Context::EState state)
 
 int Context_next(Context* ctx, Value& self)
 {
-    Context* callee = (Context*)self.val.object;
+    Context* callee = (Context*)self.GetObject();
     /*
      * call the context with the expected number of args
      */
@@ -57,7 +58,7 @@ Setup this Context so that it can be [next called]. The arguments given will be
 /* TODO { Context.setup should be changed to accept keyword Dictionary. } */
 int Context_setup(Context* ctx, Value& self)
 {
-    Context* callee = (Context*)self.val.object;
+    Context* callee = (Context*)self.GetObject();
     
     callee->Setup(ctx);
     if (callee->IsDead())
@@ -186,13 +187,13 @@ bool GetOverrideFrom(Engine* eng, Basic* obj, OpOverride ovr, Value& res)
 
 Iterator* GetIteratorFrom(Context* ctx, Value& val, String* kind)
 {
-    if (!(val.tag >= TAG_basic))
+    if (!(val.GetTag() >= TAG_basic))
         return 0;
     
     Engine* eng = ctx->GetEngine();
     Value result(NULL_VALUE);
     
-    if (GetOverrideFrom(eng, val.val.basic, OVR_iterate, result))
+    if (GetOverrideFrom(eng, val.GetBasic(), OVR_iterate, result))
     {            
         ctx->Push(kind ? kind : eng->emptyString);
         ctx->Push(val);
@@ -205,7 +206,7 @@ Iterator* GetIteratorFrom(Context* ctx, Value& val, String* kind)
         result = ctx->PopTop();
         if (eng->Iterator_Type->IsInstance(result))
         {
-            return (Iterator*)result.val.object;
+            return (Iterator*)result.GetObject();
         }
     }
     return 0;
@@ -213,6 +214,87 @@ Iterator* GetIteratorFrom(Context* ctx, Value& val, String* kind)
 
 PIKA_IMPL(Context)
 
+/* Jump tables for Run. Both are filled in the first time Run is called. Every entry of the hook
+ * table leads to the instruction hook, which then jumps through the fast table. */
+static const void* const* Pika_FastDispatch = 0;
+static const void* const* Pika_HookDispatch = 0;
+
+/* Direct-threaded code.
+ * Each Bytecode has a side array holding the handler of every instruction, so that Run can jump
+ * straight to the next instruction's handler without decoding its opcode. The array runs parallel
+ * to the bytecode, which stays the only copy of the instructions and their operands. Line
+ * information, the debugger, generators and the code cache only ever look at the bytecode.
+ *
+ * threadedBias is chosen so that threadedBias + pc * PIKA_THREADED_SCALE is the address of the
+ * handler for pc. See PIKA_THREADED_HANDLER in PContext_Run.inl.
+ */
+#define PIKA_THREADED_SCALE ((ptrdiff_t)(sizeof(void*) / sizeof(code_t)))
+
+INLINE void Context::ThreadCode()
+{
+#if defined(PIKA_THREADED_CODE)
+    Bytecode* bc = closure ? closure->def->bytecode : 0;
+    if (bc && bc->handlers && dispatchTable == Pika_FastDispatch)
+    {
+        threadedBias = (ptrdiff_t)bc->handlers - (ptrdiff_t)bc->code * PIKA_THREADED_SCALE;
+    }
+    else if (bc)
+    {
+        ThreadNewCode(bc);
+    }
+#endif
+}
+
+#if defined(PIKA_THREADED_CODE)
+void Context::ThreadNewCode(Bytecode* bc)
+{
+    if (!Pika_FastDispatch)
+        return;
+    
+    if (!bc->handlers)
+    {
+        bc->handlers = (const void**)Pika_malloc(sizeof(void*) * bc->length);
+        if (!bc->handlers)
+            RaiseException("Context::ThreadNewCode memory allocation failed.");
+        for (u2 i = 0; i < bc->length; ++i)
+        {
+            Opcode oc = PIKA_GET_OPCODEOF(bc->code[i]);
+            ASSERT(oc < OPCODE_MAX);
+            bc->handlers[i] = Pika_FastDispatch[oc];
+        }
+    }
+    
+    const void* const* handlers = bc->handlers;
+#   if !defined(PIKA_NO_HOOKS)
+    if (dispatchTable == Pika_HookDispatch)
+    {
+        // Every opcode leads to the hook, which then jumps through the fast table.
+        size_t const oldSize = hookHandlers.GetSize();
+        if (oldSize < bc->length)
+        {
+            hookHandlers.Resize(bc->length);
+            for (size_t i = oldSize; i < bc->length; ++i)
+            {
+                hookHandlers[i] = Pika_HookDispatch[OP_nop];
+            }
+        }
+        handlers = hookHandlers.GetAt(0);
+    }
+#   endif
+    threadedBias = (ptrdiff_t)handlers - (ptrdiff_t)bc->code * PIKA_THREADED_SCALE;
+}
+#endif
+
+void Context::UpdateDispatch()
+{
+#if !defined(PIKA_NO_HOOKS)
+    dispatchTable = engine->HasHook(HE_instruction) ? Pika_HookDispatch : Pika_FastDispatch;
+#else
+    dispatchTable = Pika_FastDispatch;
+#endif
+    ThreadCode();
+}
+
 void Context::PushCallScope()
 {
     ScopeInfo& currA = *scopesTop;
@@ -230,6 +312,10 @@ void Context::PushCallScope()
     currA.numTailCalls = numTailCalls;
     currA.package = package;
     currA.kind = SCOPE_call;
+#if defined(PIKA_THREADED_CODE)
+    // Only the fast dispatch code is shared by every Context and stays put, see PopCallScope.
+    currA.threadedBias = dispatchTable == Pika_FastDispatch ? threadedBias : 0;
+#endif
     if (++scopesTop >= scopesEnd)
         GrowScopeStack();
 }
@@ -240,6 +326,7 @@ void Context::PushWithScope()
     
     // We only care about the self and kind fields but we want to null
     // anything the gc may want to mark.
+    currA.kwargs    = 0;
     currA.env       = 0;
     currA.closure   = 0;
     currA.generator = 0;
@@ -272,6 +359,14 @@ void Context::PopCallScope()
     retCount = currA.retCount;
     numTailCalls = currA.numTailCalls;
     package = currA.package;
+#if defined(PIKA_THREADED_CODE)
+    // Returning to the caller's own code does not need to look it up again. The hook's code is
+    // rebuilt when it grows, so that and a scope pushed under a different dispatch are threaded anew.
+    if (currA.threadedBias && dispatchTable == Pika_FastDispatch)
+        threadedBias = currA.threadedBias;
+    else
+        ThreadCode();
+#endif
 }
 
 void Context::PopWithScope()
@@ -304,6 +399,7 @@ void Context::PushPackageScope()
 {
     ScopeInfo& currA = *scopesTop;
     
+    currA.kwargs    = 0;
     currA.env       = 0;
     currA.closure   = 0;
     currA.generator = 0;    
@@ -332,8 +428,7 @@ Iterator* Context::Iterate(String* iterkind)
         return ThisSuper::Iterate(iterkind);
     }
     ContextIterator* c;
-    PIKA_NEW(ContextIterator, c, (engine, engine->Iterator_Type, this));
-    engine->AddToGC(c);
+    GCNEW(engine, ContextIterator, c, (engine, engine->Iterator_Type, this));
     return c;
 }
 
@@ -356,6 +451,10 @@ Context::Context(Engine* eng, Type* obj_type)
       numTailCalls(0),
       numRuns(0),
       nativeCallDepth(0),
+      dispatchTable(0),
+#if defined(PIKA_THREADED_CODE)
+      threadedBias(0),
+#endif
       acc(NULL_VALUE),
       quiet(false)
 {
@@ -501,10 +600,10 @@ bool Context::OpComp(const Opcode op)
     Value& a = Top1();
     bool res = false;
     bool called = false;
-    bool isrhs = b.tag == TAG_object || b.tag == TAG_userdata;
+    bool isrhs = b.GetTag() == TAG_object || b.GetTag() == TAG_userdata;
     if (isrhs)
     {
-       Basic* obj = b.val.basic;
+       Basic* obj = b.GetBasic();
        if (SetupOverrideRhs(obj, OVR_comp, &called))
        {
            Run();
@@ -512,7 +611,7 @@ bool Context::OpComp(const Opcode op)
     }
     else
     {
-        Basic* obj = a.val.basic;
+        Basic* obj = a.GetBasic();
         if (SetupOverrideLhs(obj, OVR_comp, &called))
         {
             Run();
@@ -524,7 +623,7 @@ bool Context::OpComp(const Opcode op)
         
         if (top.IsInteger())
         {
-            pint_t comp = top.val.integer;                
+            pint_t comp = top.GetInteger();                
             switch (op)
             {
             case OP_eq:  res = comp == 0; break;
@@ -554,10 +653,10 @@ void Context::OpCompBinary(const Opcode op, const OpOverride ovr, const OpOverri
     Value& b = Top();
     Value& a = Top1();
     bool res = false;
-    int const atag = a.tag;
-    int const btag = b.tag;
+    int const atag = a.GetTag();
+    int const btag = b.GetTag();
     
-    switch (a.tag)
+    switch (a.GetTag())
     {
     case TAG_null:
     case TAG_boolean:
@@ -567,13 +666,13 @@ void Context::OpCompBinary(const Opcode op, const OpOverride ovr, const OpOverri
         if (btag == TAG_real)
         {
             // convert a to a Real
-            a.Set((preal_t)a.val.integer);
+            a.Set((preal_t)a.GetInteger());
             switch (op)
             {
-            case OP_lt:  res =  le_num(a.val.real, b.val.real); break;
-            case OP_gt:  res =  gr_num(a.val.real, b.val.real); break;
-            case OP_lte: res = lte_num(a.val.real, b.val.real); break;
-            case OP_gte: res = gte_num(a.val.real, b.val.real); break;
+            case OP_lt:  res =  le_num(a.GetReal(), b.GetReal()); break;
+            case OP_gt:  res =  gr_num(a.GetReal(), b.GetReal()); break;
+            case OP_lte: res = lte_num(a.GetReal(), b.GetReal()); break;
+            case OP_gte: res = gte_num(a.GetReal(), b.GetReal()); break;
             default: break;
             }
             a.SetBool(res);
@@ -587,10 +686,10 @@ void Context::OpCompBinary(const Opcode op, const OpOverride ovr, const OpOverri
         
         switch (op)
         {
-        case OP_lt:  res =  le_num(a.val.integer, b.val.integer); break;
-        case OP_gt:  res =  gr_num(a.val.integer, b.val.integer); break;
-        case OP_lte: res = lte_num(a.val.integer, b.val.integer); break;
-        case OP_gte: res = gte_num(a.val.integer, b.val.integer); break;
+        case OP_lt:  res =  le_num(a.GetInteger(), b.GetInteger()); break;
+        case OP_gt:  res =  gr_num(a.GetInteger(), b.GetInteger()); break;
+        case OP_lte: res = lte_num(a.GetInteger(), b.GetInteger()); break;
+        case OP_gte: res = gte_num(a.GetInteger(), b.GetInteger()); break;
         default: break;
         }
         
@@ -603,7 +702,7 @@ void Context::OpCompBinary(const Opcode op, const OpOverride ovr, const OpOverri
         if (btag == TAG_integer)
         {
             // convert b to a Real
-            b.Set((preal_t)b.val.integer);
+            b.Set((preal_t)b.GetInteger());
         }
         else if (btag != TAG_real)
         {
@@ -612,10 +711,10 @@ void Context::OpCompBinary(const Opcode op, const OpOverride ovr, const OpOverri
         
         switch (op)
         {
-        case OP_lt:  res =  le_num(a.val.real, b.val.real); break;
-        case OP_gt:  res =  gr_num(a.val.real, b.val.real); break;
-        case OP_lte: res = lte_num(a.val.real, b.val.real); break;
-        case OP_gte: res = gte_num(a.val.real, b.val.real); break;
+        case OP_lt:  res =  le_num(a.GetReal(), b.GetReal()); break;
+        case OP_gt:  res =  gr_num(a.GetReal(), b.GetReal()); break;
+        case OP_lte: res = lte_num(a.GetReal(), b.GetReal()); break;
+        case OP_gte: res = gte_num(a.GetReal(), b.GetReal()); break;
         default: break;
         }
         
@@ -629,10 +728,10 @@ void Context::OpCompBinary(const Opcode op, const OpOverride ovr, const OpOverri
             break;
         switch (op)
         {
-        case OP_lt:  res =  le_num(*a.val.str, *b.val.str); break;
-        case OP_gt:  res =  gr_num(*a.val.str, *b.val.str); break;
-        case OP_lte: res = lte_num(*a.val.str, *b.val.str); break;
-        case OP_gte: res = gte_num(*a.val.str, *b.val.str); break;
+        case OP_lt:  res =  le_num(*a.GetString(), *b.GetString()); break;
+        case OP_gt:  res =  gr_num(*a.GetString(), *b.GetString()); break;
+        case OP_lte: res = lte_num(*a.GetString(), *b.GetString()); break;
+        case OP_gte: res = gte_num(*a.GetString(), *b.GetString()); break;
         default: break;
         }
         
@@ -643,7 +742,7 @@ void Context::OpCompBinary(const Opcode op, const OpOverride ovr, const OpOverri
     case TAG_userdata:
     case TAG_object:
     {
-        Basic* obj = a.val.basic;
+        Basic* obj = a.GetBasic();
         bool called = false;
         
         if (SetupOverrideLhs(obj, ovr, &called))
@@ -656,7 +755,7 @@ void Context::OpCompBinary(const Opcode op, const OpOverride ovr, const OpOverri
     
     if (btag == TAG_object || btag == TAG_userdata)
     {
-        Basic* obj = b.val.basic;
+        Basic* obj = b.GetBasic();
         bool called = false;
         
         if (SetupOverrideRhs(obj, ovr_r, &called))
@@ -684,31 +783,35 @@ void Context::OpCompBinary(const Opcode op, const OpOverride ovr, const OpOverri
 INLINE void Context::OpArithUnary(const Opcode op, const OpOverride ovr, int& numcalls)
 {
     Value& a = Top();
-    if (a.tag == TAG_integer)
+    if (a.GetTag() == TAG_integer)
     {
+        pint_t ia = a.GetInteger();
         switch (op)
         {
-        case OP_inc: inc_num(a.val.integer); break;
-        case OP_dec: dec_num(a.val.integer); break;
-        case OP_pos: pos_num(a.val.integer); break;
-        case OP_neg: neg_num(a.val.integer); break;
+        case OP_inc: inc_num(ia); break;
+        case OP_dec: dec_num(ia); break;
+        case OP_pos: pos_num(ia); break;
+        case OP_neg: neg_num(ia); break;
         default: break;
         }
+        a.Set(ia);
     }
-    else if (a.tag == TAG_real)
+    else if (a.GetTag() == TAG_real)
     {
+        preal_t ra = a.GetReal();
         switch (op)
         {
-        case OP_inc: inc_num(a.val.real); break;
-        case OP_dec: dec_num(a.val.real); break;
-        case OP_pos: pos_num(a.val.real); break;
-        case OP_neg: neg_num(a.val.real); break;
+        case OP_inc: inc_num(ra); break;
+        case OP_dec: dec_num(ra); break;
+        case OP_pos: pos_num(ra); break;
+        case OP_neg: neg_num(ra); break;
         default: break;
         }
+        a.Set(ra);
     }
-    else if (a.tag >= TAG_basic)
+    else if (a.GetTag() >= TAG_basic)
     {
-        Basic* bas = a.val.basic;
+        Basic* bas = a.GetBasic();
         if (SetupOverrideUnary(bas, ovr))
             ++numcalls;
     }
@@ -726,26 +829,29 @@ INLINE void Context::OpBitBinary(const Opcode op, const OpOverride ovr, const Op
     Value& b = Top();
     Value& a = Top1();
     
-    if (a.tag == TAG_integer && b.tag == TAG_integer)
+    if (a.GetTag() == TAG_integer && b.GetTag() == TAG_integer)
     {
+        pint_t ia = a.GetInteger();
+        pint_t ib = b.GetInteger();
         switch (op)
         {
-        case OP_bitand: band_num(a.val.integer, b.val.integer); break;
-        case OP_bitor:  bor_num (a.val.integer, b.val.integer); break;
-        case OP_bitxor: bxor_num(a.val.integer, b.val.integer); break;
-        case OP_lsh:    lsh_num (a.val.integer, b.val.integer); break;
-        case OP_rsh:    rsh_num (a.val.integer, b.val.integer); break;
-        case OP_ursh:   ursh_num(a.val.integer, b.val.integer); break;
+        case OP_bitand: band_num(ia, ib); break;
+        case OP_bitor:  bor_num (ia, ib); break;
+        case OP_bitxor: bxor_num(ia, ib); break;
+        case OP_lsh:    lsh_num (ia, ib); break;
+        case OP_rsh:    rsh_num (ia, ib); break;
+        case OP_ursh:   ursh_num(ia, ib); break;
         default: break;
         }
+        a.Set(ia);
         Pop();
         return;
     }
     
     // Check for override from the lhs operand
-    if (a.tag >= TAG_basic)
+    if (a.GetTag() >= TAG_basic)
     {
-        Basic* basic = a.val.basic;
+        Basic* basic = a.GetBasic();
         bool res = false;
         
         if (SetupOverrideLhs(basic, ovr, &res))
@@ -755,9 +861,9 @@ INLINE void Context::OpBitBinary(const Opcode op, const OpOverride ovr, const Op
     }
     
     // Check for override from the rhs operand
-    if (b.tag >= TAG_basic)
+    if (b.GetTag() >= TAG_basic)
     {
-        Basic* basic = b.val.basic;
+        Basic* basic = b.GetBasic();
         bool    res = false;
         
         if (SetupOverrideRhs(basic, ovr_r, &res))
@@ -779,27 +885,28 @@ INLINE void Context::OpArithBinary(const Opcode op, const OpOverride ovr, const
     Value& b = Top();
     Value& a = Top1();
     
-    switch (a.tag)
+    switch (a.GetTag())
     {
     case TAG_integer:
     {
-        switch (b.tag)
+        switch (b.GetTag())
         {
         case TAG_integer:
         {
             // integer op integer
+            pint_t ia = a.GetInteger();
+            pint_t ib = b.GetInteger();
             switch (op)
             {
-            case OP_add: add_num(a.val.integer, b.val.integer); break;
-            case OP_sub: sub_num(a.val.integer, b.val.integer); break;
-            case OP_mul: mul_num(a.val.integer, b.val.integer); break;
+            case OP_add: add_num(ia, ib); a.Set(ia); break;
+            case OP_sub: sub_num(ia, ib); a.Set(ia); break;
+            case OP_mul: mul_num(ia, ib); a.Set(ia); break;
             case OP_div:
             {
 #       if defined(USE_INTEGER_DIVISION)
-                div_num(a.val.integer, b.val.integer);
+                div_num(ia, ib);
+                a.Set(ia);
 #       else
-                pint_t const ia = a.val.integer;
-                pint_t const ib = b.val.integer;
 #       ifndef NO_DIVIDEBYZERO_ERROR
                 if (ib == 0)
                 {
@@ -808,23 +915,23 @@ INLINE void Context::OpArithBinary(const Opcode op, const OpOverride ovr, const
 #       endif                
                 if (ia % ib == 0)
                 {
-                    a.val.integer = ia / ib;
+                    a.Set((pint_t)(ia / ib));
                 }
                 else
                 {
-                    preal_t const ra = (preal_t)a.val.integer;
-                    preal_t const rb = (preal_t)b.val.integer;
+                    preal_t const ra = (preal_t)ia;
+                    preal_t const rb = (preal_t)ib;
                     a.Set((preal_t)(ra / rb));
                 }
 #       endif
                 break;
             }
-            case OP_idiv: div_num(a.val.integer, b.val.integer); break;
-            case OP_mod:  mod_num(a.val.integer, b.val.integer); break;
+            case OP_idiv: div_num(ia, ib); a.Set(ia); break;
+            case OP_mod:  mod_num(ia, ib); a.Set(ia); break;
             case OP_pow:  
                 {
-                    preal_t ai = a.val.integer;
-                    preal_t bi = b.val.integer;
+                    preal_t ai = (preal_t)ia;
+                    preal_t bi = (preal_t)ib;
                     
                     
                     pow_num(ai, bi);
@@ -847,19 +954,21 @@ INLINE void Context::OpArithBinary(const Opcode op, const OpOverride ovr, const
         case TAG_real:
         {
             // integer op real
-            a.Set((preal_t)a.val.integer);
+            a.Set((preal_t)a.GetInteger());
+            preal_t ra = a.GetReal();
+            preal_t rb = b.GetReal();
             switch (op)
             {
-            case OP_add:  add_num(a.val.real, b.val.real); break;
-            case OP_sub:  sub_num(a.val.real, b.val.real); break;
-            case OP_mul:  mul_num(a.val.real, b.val.real); break;
-            case OP_div:  div_num(a.val.real, b.val.real); break;
+            case OP_add:  add_num(ra, rb); a.Set(ra); break;
+            case OP_sub:  sub_num(ra, rb); a.Set(ra); break;
+            case OP_mul:  mul_num(ra, rb); a.Set(ra); break;
+            case OP_div:  div_num(ra, rb); a.Set(ra); break;
             case OP_idiv:
-                div_num(a.val.real, b.val.real);
-                a.Set(Pika_RealToInteger(a.val.real)); // TODO: convert integer to real
+                div_num(ra, rb);
+                a.Set(Pika_RealToInteger(ra)); // TODO: convert integer to real
                 break;
-            case OP_mod:  mod_num(a.val.real, b.val.real); break;
-            case OP_pow:  pow_num(a.val.real, b.val.real); break;
+            case OP_mod:  mod_num(ra, rb); a.Set(ra); break;
+            case OP_pow:  pow_num(ra, rb); a.Set(ra); break;
             default: break;
             }
             Pop();
@@ -869,8 +978,8 @@ INLINE void Context::OpArithBinary(const Opcode op, const OpOverride ovr, const
         {
             if (op == OP_mul)
             {
-                pint_t i = a.val.integer;
-                String* str = b.val.str;
+                pint_t i = a.GetInteger();
+                String* str = b.GetString();
                 String* res = String::Multiply(str, i);
                 a.Set(res);
                 Pop();
@@ -883,24 +992,26 @@ INLINE void Context::OpArithBinary(const Opcode op, const OpOverride ovr, const
     break;
     case TAG_real:
     {
-        switch (b.tag)
+        switch (b.GetTag())
         {
         case TAG_integer:
         {
             // real op integer
-            b.Set((preal_t)b.val.integer);
+            b.Set((preal_t)b.GetInteger());
+            preal_t ra = a.GetReal();
+            preal_t rb = b.GetReal();
             switch (op)
             {
-            case OP_add: add_num(a.val.real, b.val.real); break;
-            case OP_sub: sub_num(a.val.real, b.val.real); break;
-            case OP_mul: mul_num(a.val.real, b.val.real); break;
-            case OP_div: div_num(a.val.real, b.val.real); break;
+            case OP_add:  add_num(ra, rb); a.Set(ra); break;
+            case OP_sub:  sub_num(ra, rb); a.Set(ra); break;
+            case OP_mul:  mul_num(ra, rb); a.Set(ra); break;
+            case OP_div:  div_num(ra, rb); a.Set(ra); break;
             case OP_idiv:
-                div_num(a.val.real, b.val.real);
-                a.Set(Pika_RealToInteger(a.val.real));
+                div_num(ra, rb);
+                a.Set(Pika_RealToInteger(ra));
                 break;
-            case OP_mod: mod_num(a.val.real, b.val.real); break;
-            case OP_pow: pow_num(a.val.real, b.val.real); break;
+            case OP_mod:  mod_num(ra, rb); a.Set(ra); break;
+            case OP_pow:  pow_num(ra, rb); a.Set(ra); break;
             default: break;
             }
             Pop();
@@ -909,18 +1020,20 @@ INLINE void Context::OpArithBinary(const Opcode op, const OpOverride ovr, const
         case TAG_real:
         {
             // real op real
+            preal_t ra = a.GetReal();
+            preal_t rb = b.GetReal();
             switch (op)
             {
-            case OP_add: add_num(a.val.real, b.val.real); break;
-            case OP_sub: sub_num(a.val.real, b.val.real); break;
-            case OP_mul: mul_num(a.val.real, b.val.real); break;
-            case OP_div: div_num(a.val.real, b.val.real); break;
+            case OP_add:  add_num(ra, rb); a.Set(ra); break;
+            case OP_sub:  sub_num(ra, rb); a.Set(ra); break;
+            case OP_mul:  mul_num(ra, rb); a.Set(ra); break;
+            case OP_div:  div_num(ra, rb); a.Set(ra); break;
             case OP_idiv:
-                div_num(a.val.real, b.val.real);
-                a.Set(Pika_RealToInteger(a.val.real));
+                div_num(ra, rb);
+                a.Set(Pika_RealToInteger(ra));
                 break;
-            case OP_mod: mod_num(a.val.real, b.val.real); break;
-            case OP_pow: pow_num(a.val.real, b.val.real); break;
+            case OP_mod:  mod_num(ra, rb); a.Set(ra); break;
+            case OP_pow:  pow_num(ra, rb); a.Set(ra); break;
             default: break;
             }
             Pop();
@@ -931,9 +1044,9 @@ INLINE void Context::OpArithBinary(const Opcode op, const OpOverride ovr, const
     break; // TAG_real
     }
     // Check for override from the lhs operand
-    if (a.tag >= TAG_basic)
+    if (a.GetTag() >= TAG_basic)
     {
-        Basic* basic = a.val.basic;
+        Basic* basic = a.GetBasic();
         bool res = false;
         
         if (SetupOverrideLhs(basic, ovr, &res)) {
@@ -943,9 +1056,9 @@ INLINE void Context::OpArithBinary(const Opcode op, const OpOverride ovr, const
             return;
     }
     
-    if (b.tag >= TAG_basic)
+    if (b.GetTag() >= TAG_basic)
     {
-        Basic* basic = b.val.basic;
+        Basic* basic = b.GetBasic();
         bool res = false;
         if (SetupOverrideRhs(basic, ovr_r, &res)) {
             ++numcalls;
@@ -1014,7 +1127,7 @@ bool Context::OpApply(u1 argc, u1 retc, u1 kwargc, bool tailcall)
     {
         if (engine->Array_Type->IsInstance(var_arg))
         {
-            array = static_cast<Array*>(var_arg.val.object);            
+            array = static_cast<Array*>(var_arg.GetObject());            
             size_t array_size = array->GetLength();
             
             if (array_size > PIKA_MAX_ARGS)
@@ -1037,8 +1150,8 @@ bool Context::OpApply(u1 argc, u1 retc, u1 kwargc, bool tailcall)
     {
         if (engine->Dictionary_Type->IsInstance(kw_arg))
         {
-            dict = static_cast<Dictionary*>(kw_arg.val.object);
-            dict_size = dict->Elements().Count();
+            dict = static_cast<Dictionary*>(kw_arg.GetObject());
+            dict_size = dict->GetLength();
             
             if (dict_size > PIKA_MAX_KWARGS)
             {
@@ -1087,11 +1200,11 @@ bool Context::OpApply(u1 argc, u1 retc, u1 kwargc, bool tailcall)
     if (dict)
     {
         start += kwargc * 2; // skip past explicitly specified keyword arguments.
-        for (Table::Iterator iter = dict->Elements().GetIterator(); iter; ++iter)
+        for (Dictionary::ElementIterator iter = dict->GetElements(); iter; ++iter)
         {
             // Copy both key and value.
-            *start++ = iter->key;
-            *start++ = iter->val;
+            *start++ = iter.GetKey();
+            *start++ = iter.GetValue();
         }
     }
     
@@ -1240,6 +1353,11 @@ bool Context::SetupCall(u2 argc, u2 retc, u2 kwargc, bool tailcall)
         [ self  ]
         [ func  ] < sp
     */
+    if (Profiler::pending)
+    {
+        ProfileSample();
+    }
+    
     Value frameVar = PopTop();
     Value selfVar  = PopTop();
     /*  
@@ -1255,7 +1373,7 @@ bool Context::SetupCall(u2 argc, u2 retc, u2 kwargc, bool tailcall)
     if (engine->Function_Type->IsInstance(frameVar))
     {
         u2 const provided_argc = argc;
-        Function* fun = frameVar.val.function;
+        Function* fun = frameVar.GetClosure();
         Def* def = fun->GetDef();
         
         if (kwargc)
@@ -1319,8 +1437,8 @@ bool Context::SetupCall(u2 argc, u2 retc, u2 kwargc, bool tailcall)
                 {
                     // TODO: Check that argument is not double specified BUT
                     //       We need a way to make sure it wasn't set as a default value.                    
-                    ASSERT(idx.tag == TAG_integer);
-                    pint_t the_index = idx.val.integer;
+                    ASSERT(idx.GetTag() == TAG_integer);
+                    pint_t the_index = idx.GetInteger();
                     ASSERT(the_index < argc);
                     *(args_start + the_index) = *(curr + 1);
                 }
@@ -1384,6 +1502,12 @@ bool Context::SetupCall(u2 argc, u2 retc, u2 kwargc, bool tailcall)
             }
         }
         
+        // Make sure the local variables fit before they are initialized below.
+        if ((int)def->numLocals > param_count)
+        {
+            CheckStackSpace(def->numLocals - param_count + 1);
+        }
+        
         Value* newsp;
         Value* argv;
         
@@ -1440,6 +1564,7 @@ bool Context::SetupCall(u2 argc, u2 retc, u2 kwargc, bool tailcall)
         package   = fun->GetLocation();
         argCount  = argc;
         acc.SetNull();
+        ThreadCode();
         ASSERT(closure);
         ASSERT(package);
         /*
@@ -1527,7 +1652,7 @@ bool Context::SetupCall(u2 argc, u2 retc, u2 kwargc, bool tailcall)
     else
     {
         // object or userdata that may contain a call override method.
-        if (frameVar.tag >= TAG_basic)
+        if (frameVar.GetTag() >= TAG_basic)
         {
             if (frameVar.IsDerivedFrom(Generator::StaticGetClass()))
             {
@@ -1535,14 +1660,14 @@ bool Context::SetupCall(u2 argc, u2 retc, u2 kwargc, bool tailcall)
                     ReportRuntimeError(Exception::ERROR_runtime,
                         "Attempt resume a generator by calling it with positional and/or keyword arguments.");
                 }
-                Generator* gen = static_cast<Generator*>(frameVar.val.object);
+                Generator* gen = static_cast<Generator*>(frameVar.GetObject());
                 gen->Resume(this, retc ? retc : 1, tailcall);
                 return true;
             }
             else
             {
                 Push(frameVar);
-                return SetupOverride(argc, retc, kwargc, tailcall, frameVar.val.basic, OVR_call);
+                return SetupOverride(argc, retc, kwargc, tailcall, frameVar.GetBasic(), OVR_call);
             }
         }
         else
@@ -1754,7 +1879,7 @@ void Context::OpUsing()
     self = v;                
     Pop();
     
-    if (v.tag >= TAG_basic)
+    if (v.GetTag() >= TAG_basic)
     {
         Value res(NULL_VALUE);
         Type* basicType = engine->GetTypeOf(v);
@@ -1776,6 +1901,20 @@ void Context::OpUsing()
 
 void Context::Activate()   { engine->ChangeContext(this); }
 
+void Context::ProfileSample()
+{
+    Profiler* profiler = engine->GetProfilerSafe();
+    
+    if (profiler && profiler->IsRunning())
+    {
+        profiler->Sample(this);
+    }
+    else
+    {
+        Profiler::pending = 0;
+    }
+}
+
 void Context::Deactivate() { engine->ChangeContext(0); }
 
 void Context::ReportRuntimeError(Exception::Kind kind, const char* msg, ...)
@@ -1829,7 +1968,17 @@ void Context::ReportRuntimeError(Exception::Kind kind, const char* msg, ...)
     }
 }
 
-void Context::OpDotSet(Opcode oc, OpOverride ovr)
+MemberCache* Context::GetMemberCache(u2 index, const Value& name)
+{
+    Def* def = closure->GetDef();
+    if (index < def->literals->GetSize() && def->literals->Get(index) == name)
+    {
+        return &def->GetMemberCache(index);
+    }
+    return 0;
+}
+
+void Context::OpDotSet(Opcode oc, OpOverride ovr, MemberCache* ic)
 {
     // [ ...      ]
     // [ value    ]
@@ -1842,13 +1991,21 @@ void Context::OpDotSet(Opcode oc, OpOverride ovr)
     Value& obj  = Top1();
     Value& val  = Top2();
     
-    if (obj.tag >= TAG_basic)
+    if (obj.GetTag() >= TAG_basic)
     {
+        // The cache only succeeds if there is no opSet override.
+        
+        if (ic && obj.GetTag() == TAG_object && obj.GetObject()->SetSlotCached(prop, val, *ic))
+        {
+            Pop(3);
+            return;
+        }
+        
         // Call the opSet override method if present.
     
         Value setfn(NULL_VALUE);
         
-        if (GetOverrideFrom(engine, obj.val.basic, ovr, setfn))
+        if (GetOverrideFrom(engine, obj.GetBasic(), ovr, setfn))
         {
             Swap(prop, obj);
             Swap(obj, val);
@@ -1867,7 +2024,7 @@ void Context::OpDotSet(Opcode oc, OpOverride ovr)
         bool success = true;
         if (oc == OP_subset)
         {
-            if (!(success = obj.val.basic->BracketWrite(prop, val)))
+            if (!(success = obj.GetBasic()->BracketWrite(prop, val)))
             {
                 //  Member cannot be written.
                 ReportRuntimeError(Exception::ERROR_index,
@@ -1879,7 +2036,7 @@ void Context::OpDotSet(Opcode oc, OpOverride ovr)
         }
         else
         {
-            success = obj.val.basic->SetSlot(prop, val);
+            success = obj.GetBasic()->SetSlot(prop, val);
         }
         
         if (!success)
@@ -1887,11 +2044,11 @@ void Context::OpDotSet(Opcode oc, OpOverride ovr)
             // If we couldn't write it might be because prop is a property.
             
             Value res;
-            if (obj.val.basic->GetSlot(prop, res) && res.tag == TAG_property)
+            if (obj.GetBasic()->GetSlot(prop, res) && res.GetTag() == TAG_property)
             {
                 // res is a Property; So we auto-magically call it.
                 
-                Property* pprop = res.val.property;
+                Property* pprop = res.GetProperty();
                 
                 // IF the Property supports writing.
                 if (pprop && pprop->CanWrite())
@@ -1957,7 +2114,7 @@ void Context::OpDotSet(Opcode oc, OpOverride ovr)
     }
 }
 
-void Context::OpDotGet(int& numcalls, Opcode oc, OpOverride ovr)
+void Context::OpDotGet(int& numcalls, Opcode oc, OpOverride ovr, MemberCache* ic)
 {
     // [ ...      ]
     // [ object   ]
@@ -1969,13 +2126,13 @@ void Context::OpDotGet(int& numcalls, Opcode oc, OpOverride ovr)
     Value& obj  = Top1();
     Value  res(NULL_VALUE);
     
-    if (obj.tag < TAG_basic)
+    if (obj.GetTag() < TAG_basic)
     {
         // Null, Integer, Real, Boolean
         
         Type* value_type = 0;
         
-        switch (obj.tag)
+        switch (obj.GetTag())
         {
         case TAG_null:    value_type = engine->Null_Type;    break;
         case TAG_boolean: value_type = engine->Boolean_Type; break;
@@ -1993,12 +2150,12 @@ void Context::OpDotGet(int& numcalls, Opcode oc, OpOverride ovr)
         
         if (!value_type->GetField(prop, res))
         {
-            if (res.tag == TAG_property)
+            if (res.GetTag() == TAG_property)
             {
                 // The result is a Property
                 // So we need to call its accessor function.
                 
-                Property* property = res.val.property;
+                Property* property = res.GetProperty();
                 
                 // If the Property supports reading
                 if (property && property->CanRead())
@@ -2049,12 +2206,16 @@ void Context::OpDotGet(int& numcalls, Opcode oc, OpOverride ovr)
         // Object, Property, String
         
         // Call the opGet override method if present.
-        Basic* basic = obj.val.basic;
+        Basic* basic = obj.GetBasic();
         bool success;
         if (oc == OP_subget)
         {
             success = basic->BracketRead(prop, res);
         }
+        else if (ic && obj.GetTag() == TAG_object)
+        {
+            success = obj.GetObject()->GetSlotCached(prop, res, *ic);
+        }
         else
         {
             success = basic->GetSlot(prop, res);
@@ -2062,12 +2223,12 @@ void Context::OpDotGet(int& numcalls, Opcode oc, OpOverride ovr)
         
         if (!success)
         {
-            if (obj.tag >= TAG_basic)
+            if (obj.GetTag() >= TAG_basic)
             {
                 Value getfn;
                 getfn.SetNull();
                 
-                if (GetOverrideFrom(engine, obj.val.basic, ovr, getfn))
+                if (GetOverrideFrom(engine, obj.GetBasic(), ovr, getfn))
                 {
                     Swap(prop, obj);
                     Push(getfn);
@@ -2098,12 +2259,12 @@ void Context::OpDotGet(int& numcalls, Opcode oc, OpOverride ovr)
         }
     }
     
-    if (res.tag == TAG_property && oc != OP_subget)
+    if (res.GetTag() == TAG_property && oc != OP_subget)
     {
         // The result is a Property
         // So we need to call its accessor function.
         
-        Property* property = res.val.property;
+        Property* property = res.GetProperty();
         
         // If the Property supports reading
         if (property && property->CanRead())
@@ -2226,7 +2387,7 @@ void Context::OpReturn(u4 retc)
     Value* const top = GetStackPtr();
                 
     if (env && !env->IsAllocated())
-        env->EndCall(); 
+        env->EndCall(engine->GetGC()); 
         
     PopCallScope();
 
@@ -2316,7 +2477,7 @@ bool Context::OpUnpack(u4 expected)
     else if (t.IsDerivedFrom(Array::StaticGetClass()))
     {
         Pop();
-        Array* v = (Array*)t.val.object;
+        Array* v = (Array*)t.GetObject();
         Value* start = GetStackPtr();
         StackAlloc(expected);
         
@@ -2343,18 +2504,18 @@ bool Context::OpBind()
     // bind b.a 
     // bind b[a]
     
-    if (a.tag >= TAG_basic)
+    if (a.GetTag() >= TAG_basic)
     {
         if (a.IsDerivedFrom(Function::StaticGetClass()))
         {
-            Function* c = ((Function*)a.val.function)->BindWith(b);
+            Function* c = ((Function*)a.GetClosure())->BindWith(b);
             Pop();
             Top().Set(c);
             return false;
         }
         else
         {
-            Basic* basic = a.val.basic;
+            Basic* basic = a.GetBasic();
             OpOverride ovr = OVR_bind;
             bool res = false;
             
@@ -2369,9 +2530,9 @@ bool Context::OpBind()
         }
     }
     
-    if (b.tag >= TAG_basic)
+    if (b.GetTag() >= TAG_basic)
     {
-        Basic* basic = b.val.basic;
+        Basic* basic = b.GetBasic();
         OpOverride ovr = OVR_bind_r;
         bool res = false;
         
@@ -2396,9 +2557,9 @@ bool Context::OpCat(bool sp)
     Value& b = Top();
     Value& a = Top1();
     
-    if (a.tag == TAG_object)
+    if (a.GetTag() == TAG_object)
     {
-        Object* obj = a.val.object;
+        Object* obj = a.GetObject();
         OpOverride ovr = sp ? OVR_catsp : OVR_cat;
         bool res = false;
         if (SetupOverrideLhs(obj, ovr, &res))
@@ -2410,9 +2571,9 @@ bool Context::OpCat(bool sp)
             return false;
         }
     }
-    if (b.tag == TAG_object)
+    if (b.GetTag() == TAG_object)
     {
-        Object* obj = b.val.object;
+        Object* obj = b.GetObject();
         OpOverride ovr = sp ? OVR_catsp_r : OVR_cat_r;
         bool res = false;
         if (SetupOverrideRhs(obj, ovr, &res))
@@ -2428,19 +2589,18 @@ bool Context::OpCat(bool sp)
     String* strb = engine->ToString(this, b);
     
     Value res;
-    res.tag = TAG_string;
     
     if (stra->GetLength() == 0)
     {
-        res.val.str = strb;
+        res.Set(strb);
     }
     else if (strb->GetLength() == 0)
     {
-        res.val.str = stra;
+        res.Set(stra);
     }
     else
     {
-        res.val.str = sp ? String::ConcatSpace(stra, strb) : String::Concat(stra, strb);
+        res.Set(sp ? String::ConcatSpace(stra, strb) : String::Concat(stra, strb));
     }
     Pop();
     Top() = res;
@@ -2454,11 +2614,11 @@ bool Context::OpIs()
     
     if (b.IsDerivedFrom(Type::StaticGetClass()))
     {
-        Type* typeObj = static_cast<Type*>(b.val.object);
+        Type* typeObj = static_cast<Type*>(b.GetObject());
         
-        if (a.tag >= TAG_basic)
+        if (a.GetTag() >= TAG_basic)
         {
-            Basic* obja  = a.val.basic;
+            Basic* obja  = a.GetBasic();
             Type*  typea = obja->GetType();
             
             for (Type* curr = typea; curr; curr = curr->GetBase())
@@ -2472,7 +2632,7 @@ bool Context::OpIs()
         }
         else
         {
-            switch (a.tag)
+            switch (a.GetTag())
             {
             case TAG_null:    return(typeObj == engine->Null_Type);
             case TAG_boolean: return(typeObj == engine->Boolean_Type);
@@ -2490,13 +2650,13 @@ bool Context::OpHas()
     Value& b = Top();
     Value& a = Top1();
     Basic* obj = 0;
-    switch (a.tag)
+    switch (a.GetTag())
     {
     case TAG_null:    obj = engine->Null_Type;    break;
     case TAG_boolean: obj = engine->Boolean_Type; break;
     case TAG_integer: obj = engine->Integer_Type; break;
     case TAG_real:    obj = engine->Real_Type;    break;
-    default:          obj = a.val.basic;
+    default:          obj = a.GetBasic();
     }
     if (obj && obj->HasSlot(b))
         return true;
@@ -2525,6 +2685,11 @@ void Context::GrowScopeStack()
 }
 
 Value& Context::GetOuter(u2 idx, u1 depth)
+{
+    return GetOuterEnv(idx, depth)->At(idx);
+}
+
+LexicalEnv* Context::GetOuterEnv(u2 idx, u1 depth)
 {
     Function* curr = closure;
     int n = depth;
@@ -2550,13 +2715,14 @@ Value& Context::GetOuter(u2 idx, u1 depth)
                        idx);
     }
 #endif
-    return curr->lexEnv->At(idx);
+    return curr->lexEnv;
 }
 
 void Context::SetOuter(const Value& outer, u2 idx, u1 depth)
 {
-    Value& outv = GetOuter(idx, depth);
-    outv = outer;
+    LexicalEnv* outerEnv = GetOuterEnv(idx, depth);
+    outerEnv->At(idx) = outer;
+    engine->GetGC()->WriteBarrier(outerEnv, outer);
 }
 
 void Context::DoClosure(Def* fun, Value& retframe, Value* mself)
@@ -2572,7 +2738,7 @@ void Context::DoClosure(Def* fun, Value& retframe, Value* mself)
     }
     else if (mself && (mself->IsDerivedFrom(Type::StaticGetClass())))
     {
-        f = ClassMethod::Create(engine, 0, closure, fun, package, mself->IsNull() ? self.val.type : mself->val.type);
+        f = ClassMethod::Create(engine, 0, closure, fun, package, mself->IsNull() ? self.GetType() : mself->GetType());
     }
     else if (currA.kind == SCOPE_package && package->IsDerivedFrom(Type::StaticGetClass()))
     {
@@ -2590,7 +2756,7 @@ void Context::DoClosure(Def* fun, Value& retframe, Value* mself)
 Context* Context::Create(Engine* eng, Type* obj_type)
 {
     Context* newco = 0;
-    PIKA_NEW(Context, newco, (eng, obj_type));
+    GCALLOC(eng, Context, newco, (eng, obj_type));
     eng->GetGC()->ForceToGray(newco);
     return newco;
 }
@@ -2844,147 +3010,147 @@ pint_t Context::GetIntArg(u2 arg)
 {
     Value& v = GetArg(arg);
     
-    if (v.tag != TAG_integer)
+    if (v.GetTag() != TAG_integer)
     {
-        if (v.tag == TAG_real && Pika_RealIsInteger(v.val.real))
+        if (v.GetTag() == TAG_real && Pika_RealIsInteger(v.GetReal()))
         {
-            return Pika_RealToInteger(v.val.real);
+            return Pika_RealToInteger(v.GetReal());
         }
-        ArgumentTagError(arg, (ValueTag)v.tag, TAG_integer);
+        ArgumentTagError(arg, (ValueTag)v.GetTag(), TAG_integer);
     }
     
-    return v.val.integer;
+    return v.GetInteger();
 }
 
 preal_t Context::GetRealArg(u2 arg)
 {
     Value& v = GetArg(arg);
     
-    if (v.tag != TAG_real)
+    if (v.GetTag() != TAG_real)
     {
-        if (v.tag == TAG_integer)
+        if (v.GetTag() == TAG_integer)
         {
-            return (preal_t)v.val.integer;
+            return (preal_t)v.GetInteger();
         }
-        ArgumentTagError(arg, (ValueTag)v.tag, TAG_real);
+        ArgumentTagError(arg, (ValueTag)v.GetTag(), TAG_real);
     }
     
-    return v.val.real;
+    return v.GetReal();
 }
 
 bool Context::GetBoolArg(u2 arg)
 {
     Value& v = GetArg(arg);
     
-    if (v.tag != TAG_boolean)
+    if (v.GetTag() != TAG_boolean)
     {
-        ArgumentTagError(arg, (ValueTag)v.tag, TAG_boolean);
+        ArgumentTagError(arg, (ValueTag)v.GetTag(), TAG_boolean);
     }
-    return v.val.index ? true : false;
+    return v.GetIndex() ? true : false;
 }
 
 String* Context::GetStringArg(u2 arg)
 {
     Value& v = GetArg(arg);
     
-    if (v.tag != TAG_string)
+    if (v.GetTag() != TAG_string)
     {
-        ArgumentTagError(arg, (ValueTag)v.tag, TAG_string);
+        ArgumentTagError(arg, (ValueTag)v.GetTag(), TAG_string);
     }
-    return v.val.str;
+    return v.GetString();
 }
 
 Object* Context::GetObjectArg(u2 arg)
 {
     Value& v = GetArg(arg);
     
-    if (v.tag != TAG_object)
+    if (v.GetTag() != TAG_object)
     {
-        ArgumentTagError(arg, (ValueTag)v.tag, TAG_object);
+        ArgumentTagError(arg, (ValueTag)v.GetTag(), TAG_object);
     }
-    return v.val.object;
+    return v.GetObject();
 }
 
 Property* Context::GetPropertyArg(u2 arg)
 {
     Value& v = GetArg(arg);
     
-    if (v.tag != TAG_property)
+    if (v.GetTag() != TAG_property)
     {
-        ArgumentTagError(arg, (ValueTag)v.tag, TAG_property);
+        ArgumentTagError(arg, (ValueTag)v.GetTag(), TAG_property);
     }
-    return v.val.property;
+    return v.GetProperty();
 }
 
 void* Context::GetUserDataArg(u2 arg, UserDataInfo* info)
 {
     Value& v = GetArg(arg);
     
-    if (v.tag != TAG_userdata)
+    if (v.GetTag() != TAG_userdata)
     {
-        ArgumentTagError(arg, (ValueTag)v.tag, TAG_userdata);
+        ArgumentTagError(arg, (ValueTag)v.GetTag(), TAG_userdata);
     }
-    else if (v.val.userdata->GetInfo() != info)
+    else if (v.GetUserData()->GetInfo() != info)
     {
-        ReportRuntimeError(Exception::ERROR_type, "incorrect type '%s' for argument %d. expecting type '%s'.", v.val.userdata->GetInfo()->name, info->name, arg);
+        ReportRuntimeError(Exception::ERROR_type, "incorrect type '%s' for argument %d. expecting type '%s'.", v.GetUserData()->GetInfo()->name, info->name, arg);
     }
-    return v.val.userdata->GetData();
+    return v.GetUserData()->GetData();
 }
 
 pint_t Context::ArgToInt(u2 arg)
 {
     Value& v = GetArg(arg);
     
-    if (v.tag != TAG_integer)
+    if (v.GetTag() != TAG_integer)
     {
         Value temp = v;
         if (!engine->ToIntegerExplicit(this, temp))
         {
-            ArgumentTagError(arg, (ValueTag)temp.tag, TAG_integer);
+            ArgumentTagError(arg, (ValueTag)temp.GetTag(), TAG_integer);
         }
-        return temp.val.integer;
+        return temp.GetInteger();
     }
-    return v.val.integer;
+    return v.GetInteger();
 }
 
 preal_t Context::ArgToReal(u2 arg)
 {
     Value& v = GetArg(arg);
     
-    if (v.tag != TAG_real)
+    if (v.GetTag() != TAG_real)
     {
         Value temp = v;
         if (!engine->ToRealExplicit(this, temp))
         {
-            ArgumentTagError(arg, (ValueTag)temp.tag, TAG_real);
+            ArgumentTagError(arg, (ValueTag)temp.GetTag(), TAG_real);
         }
-        return temp.val.real;
+        return temp.GetReal();
     }
-    return v.val.real;
+    return v.GetReal();
 }
 
 bool Context::ArgToBool(u2 arg)
 {
     Value& v = GetArg(arg);
     
-    if (v.tag != TAG_boolean)
+    if (v.GetTag() != TAG_boolean)
     {
         Value temp = v;
         return engine->ToBoolean(this, temp);
     }
-    return v.val.index ? true : false;
+    return v.GetIndex() ? true : false;
 }
 
 String* Context::ArgToString(u2 arg)
 {
     Value& v = GetArg(arg);
     
-    if (v.tag != TAG_string)
+    if (v.GetTag() != TAG_string)
     {
         Value temp = v;
         return engine->ToString(this, temp);
     }
-    return v.val.str;
+    return v.GetString();
 }
 
 void Context::ParseArgs(const char *args, u2 count, ...)
@@ -3011,7 +3177,7 @@ void Context::ParseArgs(const char *args, u2 count, ...)
         case 'B':
         case 'b':
         {
-            if (currVar->tag != TAG_boolean)
+            if (currVar->GetTag() != TAG_boolean)
             {
                 u2 argpos = (u2)(currVar - bsp);
                 
@@ -3022,18 +3188,18 @@ void Context::ParseArgs(const char *args, u2 count, ...)
                 }
                 else
                 {
-                    ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_boolean);
+                    ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_boolean);
                 }
             }
             bool *bp = va_arg(va, bool*);
-            *bp = currVar->val.index ? true : false;
+            *bp = currVar->GetIndex() ? true : false;
         }
         break;
         /* ================ c string ================ */
         case 'C':
         case 'c':
         {
-            if (currVar->tag != TAG_string)
+            if (currVar->GetTag() != TAG_string)
             {
                 u2 argpos = (u2)(currVar - bsp);
                 
@@ -3042,63 +3208,63 @@ void Context::ParseArgs(const char *args, u2 count, ...)
                     String* str = engine->ToString(this, *currVar);
                     
                     if (!str)
-                        ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_string);
+                        ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_string);
                     else
                         currVar->Set(str);
                 }
             }
             const char** strpp = va_arg(va, const char**);
-            *strpp = currVar->val.str->GetBuffer();
+            *strpp = currVar->GetString()->GetBuffer();
         }
         break;
         /* ================ Integer ================ */
         case 'I':
         case 'i':
         {
-            if (currVar->tag != TAG_integer)
+            if (currVar->GetTag() != TAG_integer)
             {
                 u2 argpos = (u2)(currVar - bsp);
                 
                 if (a == 'I' && !engine->ToIntegerExplicit(this, *currVar))
                 {
-                    ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_integer);
+                    ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_integer);
                 }
             }
             
             pint_t* intp = va_arg(va, pint_t*);
-            *intp = currVar->val.integer;
+            *intp = currVar->GetInteger();
         }
         break;
         /* ================ Object ================ */
         case 'O':
         case 'o':
         {
-            if (currVar->tag != TAG_object)
+            if (currVar->GetTag() != TAG_object)
             {
                 u2 argpos = (u2)(currVar - bsp);
-                ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_object);
+                ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_object);
             }
             
             Object** objpp = va_arg(va, Object**);
-            *objpp = currVar->val.object;
+            *objpp = currVar->GetObject();
         }
         break;
         /* ================ Real ================ */
         case 'R':
         case 'r':
         {
-            if (currVar->tag != TAG_real)
+            if (currVar->GetTag() != TAG_real)
             {
                 u2 argpos = (u2)(currVar - bsp);
                 
                 if (a == 'r' && !engine->ToRealExplicit(this, *currVar))
                 {
-                    ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_real);
+                    ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_real);
                 }
             }
             
             preal_t* fltp = va_arg(va, preal_t*);
-            *fltp = currVar->val.real;
+            *fltp = currVar->GetReal();
         }
         break;
         
@@ -3106,7 +3272,7 @@ void Context::ParseArgs(const char *args, u2 count, ...)
         case 'S':
         case 's':
         {
-            if (currVar->tag != TAG_string)
+            if (currVar->GetTag() != TAG_string)
             {
                 u2 argpos = (u2)(currVar - bsp);
                 
@@ -3115,28 +3281,28 @@ void Context::ParseArgs(const char *args, u2 count, ...)
                     String* str = engine->ToString(this, *currVar);
                     
                     if (!str)
-                        ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_string);
+                        ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_string);
                     else
                         currVar->Set(str);
                 }
             }
             
             String** strpp = va_arg(va, String**);
-            *strpp = currVar->val.str;
+            *strpp = currVar->GetString();
         }
         break;
         
         case 'U':
         case 'u':
         {
-            if (currVar->tag != TAG_userdata)
+            if (currVar->GetTag() != TAG_userdata)
             {
                 u2 argpos = (u2)(currVar - bsp);
-                ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_userdata);
+                ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_userdata);
             }
             
             UserData** userdatapp = va_arg(va, UserData**);
-            *userdatapp = currVar->val.userdata;
+            *userdatapp = currVar->GetUserData();
         }
         break;
         
@@ -3168,7 +3334,7 @@ void Context::ParseArgsInPlace(const char *args, u2 count)
         
         if (a < 0)
         {
-            if (currVar->tag == TAG_null)
+            if (currVar->GetTag() == TAG_null)
             {
                 currVar++;
                 a = *currArg++;
@@ -3184,7 +3350,7 @@ void Context::ParseArgsInPlace(const char *args, u2 count)
         case 'B':
         case 'b':
         {
-            if (currVar->tag != TAG_boolean)
+            if (currVar->GetTag() != TAG_boolean)
             {
                 u2 argpos = (u2)(currVar - bsp);
                 Value v = *currVar;
@@ -3196,7 +3362,7 @@ void Context::ParseArgsInPlace(const char *args, u2 count)
                 }
                 else
                 {
-                    ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_boolean);
+                    ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_boolean);
                 }
                 
                 currVar = bsp + argpos;
@@ -3209,7 +3375,7 @@ void Context::ParseArgsInPlace(const char *args, u2 count)
         case 'I':
         case 'i':
         {
-            if (currVar->tag != TAG_integer)
+            if (currVar->GetTag() != TAG_integer)
             {
                 u2 argpos = (u2)(currVar - bsp);
                 
@@ -3219,12 +3385,12 @@ void Context::ParseArgsInPlace(const char *args, u2 count)
                 {
                     if (!engine->ToInteger(v))
                     {
-                        ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_integer);
+                        ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_integer);
                     }
                 }
                 else
                 {
-                    ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_integer);
+                    ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_integer);
                 }
                 currVar = bsp + argpos;
                 *currVar = v;
@@ -3236,10 +3402,10 @@ void Context::ParseArgsInPlace(const char *args, u2 count)
         case 'O':
         case 'o':
         {
-            if (currVar->tag != TAG_object)
+            if (currVar->GetTag() != TAG_object)
             {
                 u2 argpos = (u2)(currVar - bsp);
-                ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_object);
+                ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_object);
             }
         }
         break;
@@ -3248,7 +3414,7 @@ void Context::ParseArgsInPlace(const char *args, u2 count)
         case 'R':
         case 'r':
         {
-            if (currVar->tag != TAG_real)
+            if (currVar->GetTag() != TAG_real)
             {
                 u2 argpos = (u2)(currVar - bsp);
                 
@@ -3258,12 +3424,12 @@ void Context::ParseArgsInPlace(const char *args, u2 count)
                 {
                     if (!engine->ToReal(v))
                     {
-                        ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_real);
+                        ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_real);
                     }
                 }
                 else
                 {
-                    ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_real);
+                    ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_real);
                 }
                 
                 currVar = bsp + argpos;
@@ -3276,7 +3442,7 @@ void Context::ParseArgsInPlace(const char *args, u2 count)
         case 'S':
         case 's':
         {
-            if (currVar->tag != TAG_string)
+            if (currVar->GetTag() != TAG_string)
             {
                 u2 argpos = (u2)(currVar - bsp);
                 Value v = *currVar;
@@ -3288,12 +3454,12 @@ void Context::ParseArgsInPlace(const char *args, u2 count)
                     
                     if (!str)
                     {
-                        ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_string);
+                        ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_string);
                     }
                 }
                 else
                 {
-                    ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_string);
+                    ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_string);
                 }
                 
                 currVar = bsp + argpos;
@@ -3306,10 +3472,10 @@ void Context::ParseArgsInPlace(const char *args, u2 count)
         case 'U':
         case 'u':
         {
-            if (currVar->tag != TAG_userdata)
+            if (currVar->GetTag() != TAG_userdata)
             {
                 u2 argpos = (u2)(currVar - bsp);
-                ArgumentTagError(argpos, (ValueTag)currVar->tag, TAG_userdata);
+                ArgumentTagError(argpos, (ValueTag)currVar->GetTag(), TAG_userdata);
             }
         }
         break;
@@ -3418,9 +3584,9 @@ Context::EErrRes Context::OpException(Exception& e, bool caught)
             const char* const msg = e.GetMessage();
             String* const errorStr = msg ? engine->GetString(msg) : engine->emptyString;
             
-            if (thrown.IsObject() && thrown.val.object)
+            if (thrown.IsObject() && thrown.GetObject())
             {
-                Object* error_obj = thrown.val.object;
+                Object* error_obj = thrown.GetObject();
                 error_obj->SetSlot(engine->message_String, errorStr);
                 error_obj->SetSlot(engine->GetString("name"), engine->GetString(e.GetErrorKind(engine)));
             }
@@ -3443,7 +3609,7 @@ Context::EErrRes Context::OpException(Exception& e, bool caught)
             
             if (env)
             {
-                env->EndCall();
+                env->EndCall(engine->GetGC());
             }
             if (generator)
             {
@@ -3496,7 +3662,7 @@ Context::EErrRes Context::OpException(Exception& e, bool caught)
                     else if (scopes[a].env)
                     {
                         currently_native = false;
-                        scopes[a].env->EndCall();
+                        scopes[a].env->EndCall(engine->GetGC());
                     }
                     else {
                         currently_native = false;
@@ -3535,6 +3701,8 @@ Context::EErrRes Context::OpException(Exception& e, bool caught)
         SafePush(thrown);
         handlers.Pop();
         
+        // The exception may have come from a context that deactivated itself when it died.
+        Activate();
         return ER_continue;
     }
     else
@@ -28,8 +28,10 @@ class Package;
 class Value;
 class Context;
 struct UserDataInfo;
+struct MemberCache;
 class Dictionary;
 class Generator;
+class Bytecode;
 
 /** Type of scope. */
 enum ScopeKind
@@ -56,6 +58,9 @@ struct ScopeInfo
     u4           argCount;     //!< Argument count (can vary from the functions parameter count).
     u4           retCount;     //!< Expected # of return values  >= 1.
     u4           numTailCalls; //!< Number of tail calls performed.
+#if defined(PIKA_THREADED_CODE)
+    ptrdiff_t    threadedBias; //!< threadedBias of the closure or 0, see Context::PopCallScope.
+#endif
     ScopeKind    kind;         //!< Type of scope we are (tell us which fields we are concerned with).
 };
 
@@ -79,6 +84,7 @@ template class PIKA_API Buffer<size_t>;
 template class PIKA_API Buffer<ExceptionBlock>;
 template class PIKA_API Buffer<ScopeInfo>;
 template class PIKA_API Buffer<ScopeInfo>::Iterator;
+template class PIKA_API Buffer<const void*>;
 #endif
 
 typedef Buffer<size_t>           AddressStack;
@@ -101,6 +107,7 @@ class PIKA_API Context : public Object
 protected:
     friend class ContextIterator;
     friend class Generator;
+    friend class Profiler;
     
     Context(Engine*, Type*);
 public:
@@ -140,6 +147,16 @@ public:
     void ClearAcc()         { acc.SetNull(); }
     bool IsQuiet()          { return this->quiet; }
     void SetQuiet(bool q)   { this->quiet = q;    }
+    
+    /** Selects the jump table Run dispatches through, based on whether an HE_instruction hook
+      * is registered. Called by the Engine when that hook changes. */
+    void UpdateDispatch();
+    
+    /** Returns the Context that resumed this one, if any. */
+    INLINE Context* GetPrev() const { return prev; }
+    
+    /** Records a sample of the call stack with the running Profiler. Called when Profiler::pending is set. */
+    void ProfileSample();
 protected:   
     int AdjustArgs(Function* fun, Def* def, int const param_count, u4 const argc, int const argdiff, bool const nativecall);
     Buffer<Value>  keywords;
@@ -168,6 +185,11 @@ protected:
     s4             numRuns;         //!< Number of non-inlined calls to Run() made.
     int            nativeCallDepth; //!< Number of native calls currently in the scopes stack.
     u4             callsCount;      //!< The number of inlined calls for a suspended context.
+    const void* const* dispatchTable; //!< Jump table used by Run when labels as values dispatch is enabled.
+#if defined(PIKA_THREADED_CODE)
+    ptrdiff_t      threadedBias;    //!< Offset that maps pc to its handler in the current closure's direct-threaded code, see ThreadCode.
+    Buffer<const void*> hookHandlers; //!< Direct-threaded code used while an HE_instruction hook is registered. Every entry leads to the hook.
+#endif
     Value          acc;             //!< The Value of the last expression executed. Used for implicit returns (ie a return with no specified expression).
     bool           quiet;           //!< No traceback on unhandled exceptions.
 protected:
@@ -181,6 +203,17 @@ protected:
     
     void PushCallScope();       //!< Pushes a new call scope onto the scopes stack. Storing the current call.
     void PopCallScope();        //!< Pops a call scope off the scopes stack. Restoring the previous call.
+    
+    /** Points threadedBias at the direct-threaded code of the current closure. Called whenever
+      * the closure changes. */
+    void ThreadCode();
+    
+#if defined(PIKA_THREADED_CODE)
+    /** Creates the direct-threaded code for bc the first time it is run, and handles the code used
+      * while an HE_instruction hook is registered. */
+    void ThreadNewCode(Bytecode* bc);
+#endif
+    
     void PushPackageScope();    //!< Pushes a new package scope onto the scopes stack. Storing the current package.
     void PopPackageScope();     //!< Pops a package scope off the scopes stack. Restoring the previous package.
     void PushWithScope();       //!< Pushes a new with scope onto the scopes stack. Storing the current self object.
@@ -206,6 +239,11 @@ protected:
     /** Decode an return the short operand of the given instruction. */
     PIKA_FORCE_INLINE u2 GetShortOperand(const code_t instr) { return PIKA_GET_SHORTOF(instr); }
     
+    /** Returns the member inline cache of the current function for the literal at index, or null 
+      * if name is not that literal.
+      */
+    MemberCache* GetMemberCache(u2 index, const Value& name);
+    
     /** Create a new function closure at the current point in the script.
       * @param  def     The function definition for the closure.
       * @param  ret     The Value that will contain the closure.
@@ -300,6 +338,11 @@ public:
     /** Reads a member variable from an object. Calls any operator overrides or properties
       * as needed. Depending on the object in question, a missing member may
       * cause an exception.
+      *
+      * @param numcalls [in|out] Number of calls made by the interpreter.
+      * @param oc       [in]     Current opcode.
+      * @param ovr      [in]     Override relative to oc.
+      * @param ic       [in]     Inline cache for the member's name (may be null.)
       * @note
       * <pre>
       * The top of the stack should look like:
@@ -315,12 +358,13 @@ public:
       * when OpDotGet is called by a native function.
       * </pre>
       */
-    void OpDotGet(int& numcalls, Opcode oc, OpOverride ovr);
+    void OpDotGet(int& numcalls, Opcode oc, OpOverride ovr, MemberCache* ic = 0);
     
     /** Sets an object's slot.
       *
       * @param oc       [in]     Current opcode.
       * @param ovr      [in]     Override relative to oc.
+      * @param ic       [in]     Inline cache for the member's name (may be null.)
       * @note 
       * <pre>
       * The top of the stack should look like:
@@ -334,7 +378,7 @@ public:
       * [ result ] < Top
       * </pre>
       */
-    void OpDotSet(Opcode oc, OpOverride ovr);    
+    void OpDotSet(Opcode oc, OpOverride ovr, MemberCache* ic = 0);    
 protected:
     void OpReturn(u4);
     void OpYield(u4);
@@ -496,6 +540,9 @@ public:
       */
     Value& GetOuter(u2 idx, u1 depth);
     
+    /** Returns the LexicalEnv that holds an outer variable of the current scope. */
+    LexicalEnv* GetOuterEnv(u2 idx, u1 depth);
+    
     /** Set a local variable of the current scope.
       *
       * @param val  [in] The Value to set the local variable to.
@@ -645,7 +692,7 @@ INLINE T* Context::GetArgT(u2 arg)
     {
         RaiseException(Exception::ERROR_type, "excepted %s for argument %d.\n", T::StaticGetClass()->GetName() , arg);
     }
-    return (T*)v.val.index;
+    return (T*)v.GetIndex();
 }
 
 bool GetOverrideFrom(Engine* eng, Basic* obj, OpOverride ovr, Value& res);
@@ -3,23 +3,51 @@
  *  See Copyright Notice in Pika.h
  */
 
-PIKA_OPCODE(OP_add)  OpArithBinary(OP_add,  OVR_add,  OVR_add_r,  numcalls); PIKA_NEXT()
-PIKA_OPCODE(OP_sub)  OpArithBinary(OP_sub,  OVR_sub,  OVR_sub_r,  numcalls); PIKA_NEXT()
-PIKA_OPCODE(OP_mul)  OpArithBinary(OP_mul,  OVR_mul,  OVR_mul_r,  numcalls); PIKA_NEXT()
-PIKA_OPCODE(OP_div)  OpArithBinary(OP_div,  OVR_div,  OVR_div_r,  numcalls); PIKA_NEXT()
+/* Quickening.
+ * The first time a generic arithmetic or comparison opcode sees two integers or two reals it
+ * replaces itself in the bytecode with a version specialized for those types. The specialized
+ * opcode checks both tags and when they do not match it puts the generic opcode back and
+ * executes that instead. The instruction is rewritten before the generic opcode runs since
+ * an override call will change pc.
+ */
+#define PIKA_REWRITE(XOP)   PIKA_REWRITE_INSTR(pc - 1, PIKA_MAKE_B(XOP))
+
+#define PIKA_QUICKEN_II(XOP)                                    \
+    if (Top1().IsInteger() && Top().IsInteger())                \
+        PIKA_REWRITE(XOP##_ii);
+
+#define PIKA_QUICKEN_RR(XOP)                                    \
+    if (Top1().IsReal() && Top().IsReal())                      \
+        PIKA_REWRITE(XOP##_rr);
+
+#define PIKA_QUICKEN(XOP)                                       \
+    if (Top1().GetTag() == Top().GetTag())                      \
+    {                                                           \
+        if (Top().IsInteger())                                  \
+            PIKA_REWRITE(XOP##_ii);                             \
+        else if (Top().IsReal())                                \
+            PIKA_REWRITE(XOP##_rr);                             \
+    }
+
+PIKA_OPCODE(OP_add)  PIKA_QUICKEN(OP_add);    OpArithBinary(OP_add,  OVR_add,  OVR_add_r,  numcalls); PIKA_NEXT()
+PIKA_OPCODE(OP_sub)  PIKA_QUICKEN(OP_sub);    OpArithBinary(OP_sub,  OVR_sub,  OVR_sub_r,  numcalls); PIKA_NEXT()
+PIKA_OPCODE(OP_mul)  PIKA_QUICKEN(OP_mul);    OpArithBinary(OP_mul,  OVR_mul,  OVR_mul_r,  numcalls); PIKA_NEXT()
+PIKA_OPCODE(OP_div)  PIKA_QUICKEN_RR(OP_div); OpArithBinary(OP_div,  OVR_div,  OVR_div_r,  numcalls); PIKA_NEXT()
 PIKA_OPCODE(OP_idiv) OpArithBinary(OP_idiv, OVR_idiv, OVR_idiv_r, numcalls); PIKA_NEXT()
 PIKA_OPCODE(OP_mod)  OpArithBinary(OP_mod,  OVR_mod,  OVR_mod_r,  numcalls); PIKA_NEXT()
 PIKA_OPCODE(OP_pow)  OpArithBinary(OP_pow,  OVR_pow,  OVR_pow_r,  numcalls); PIKA_NEXT()
 
 PIKA_OPCODE(OP_eq)
 {
+    PIKA_QUICKEN_II(OP_eq);
+    
     Value& b = Top();
     Value& a = Top1();
 
     bool res = false;
-    if (a.tag == TAG_object)
+    if (a.GetTag() == TAG_object)
     {
-        Object* obj = a.val.object;
+        Object* obj = a.GetObject();
         bool ovr_called = false;
         if (SetupOverrideLhs(obj, OVR_eq, &ovr_called))
         {
@@ -32,9 +60,9 @@ PIKA_OPCODE(OP_eq)
         }
     }
     
-    if (b.tag == TAG_object)
+    if (b.GetTag() == TAG_object)
     {
-        Object* obj = b.val.object;
+        Object* obj = b.GetObject();
         bool ovr_called = false;
         if (SetupOverrideRhs(obj, OVR_eq, &ovr_called))
         {
@@ -47,31 +75,31 @@ PIKA_OPCODE(OP_eq)
         }
     }
         
-    if (a.tag == TAG_integer)
+    if (a.GetTag() == TAG_integer)
     {
-        if (b.tag == TAG_integer)
+        if (b.GetTag() == TAG_integer)
         {
-            res = (a.val.integer == b.val.integer);
+            res = (a.GetInteger() == b.GetInteger());
         }
-        else if (b.tag == TAG_real)
+        else if (b.GetTag() == TAG_real)
         {
-            res = (((preal_t)a.val.integer) == b.val.real);
+            res = (((preal_t)a.GetInteger()) == b.GetReal());
         }
     }
-    else if (a.tag == TAG_real)
+    else if (a.GetTag() == TAG_real)
     {
-        if (b.tag == TAG_real)
+        if (b.GetTag() == TAG_real)
         {
-            res = (a.val.real == b.val.real);
+            res = (a.GetReal() == b.GetReal());
         }
-        else if (b.tag == TAG_integer)
+        else if (b.GetTag() == TAG_integer)
         {
-            res = (a.val.real == ((preal_t)b.val.integer));
+            res = (a.GetReal() == ((preal_t)b.GetInteger()));
         }
     }
-    else if (a.tag == b.tag)
+    else if (a.GetTag() == b.GetTag())
     {
-        res = (a.val.index == b.val.index);
+        res = (a.GetIndex() == b.GetIndex()) || (a.GetTag() == TAG_string && Pika_StringsEqual(a.GetString(), b.GetString()));
     }
 
     a.SetBool(res);
@@ -81,14 +109,16 @@ PIKA_NEXT()
 
 PIKA_OPCODE(OP_ne)
 {
+    PIKA_QUICKEN_II(OP_ne);
+    
     Value& b = Top();
     Value& a = Top1();
 
     bool res = true;
 
-    if (a.tag == TAG_object)
+    if (a.GetTag() == TAG_object)
     {
-        Object* obj = a.val.object;
+        Object* obj = a.GetObject();
 
         bool ovr_called = false;
         if (SetupOverrideLhs(obj, OVR_ne, &ovr_called))
@@ -102,9 +132,9 @@ PIKA_OPCODE(OP_ne)
         }
     }
     
-    if (b.tag == TAG_object)
+    if (b.GetTag() == TAG_object)
     {
-        Object* obj = b.val.object;
+        Object* obj = b.GetObject();
 
         bool ovr_called = false;
         if (SetupOverrideRhs(obj, OVR_ne, &ovr_called)) 
@@ -118,40 +148,40 @@ PIKA_OPCODE(OP_ne)
         }
     }
         
-    if (a.tag == TAG_integer) 
+    if (a.GetTag() == TAG_integer) 
     {
-        if (b.tag == TAG_integer) 
+        if (b.GetTag() == TAG_integer) 
         {
-            res = (a.val.integer != b.val.integer);
+            res = (a.GetInteger() != b.GetInteger());
         }
-        else if (b.tag == TAG_real) {
-            res = (((preal_t)a.val.integer) != b.val.real);
+        else if (b.GetTag() == TAG_real) {
+            res = (((preal_t)a.GetInteger()) != b.GetReal());
         }
     }
-    else if (a.tag == TAG_real) 
+    else if (a.GetTag() == TAG_real) 
     {
-        if (b.tag == TAG_real) 
+        if (b.GetTag() == TAG_real) 
         {
-            res = (a.val.real != b.val.real);
+            res = (a.GetReal() != b.GetReal());
         }
-        else if (b.tag == TAG_integer) 
+        else if (b.GetTag() == TAG_integer) 
         {
-            res = (a.val.real != ((preal_t)b.val.integer));
+            res = (a.GetReal() != ((preal_t)b.GetInteger()));
         }
     }
-    else if (a.tag == b.tag) 
+    else if (a.GetTag() == b.GetTag()) 
     {
-        res = (a.val.index != b.val.index);
+        res = (a.GetIndex() != b.GetIndex()) && !(a.GetTag() == TAG_string && Pika_StringsEqual(a.GetString(), b.GetString()));
     }
     a.SetBool(res);
     Pop();
 }
 PIKA_NEXT()
 
-PIKA_OPCODE(OP_lt)  OpCompBinary(OP_lt,  OVR_lt,  OVR_lt_r,  numcalls); PIKA_NEXT()
-PIKA_OPCODE(OP_gt)  OpCompBinary(OP_gt,  OVR_gt,  OVR_gt_r,  numcalls); PIKA_NEXT()
-PIKA_OPCODE(OP_lte) OpCompBinary(OP_lte, OVR_lte, OVR_lte_r, numcalls); PIKA_NEXT()
-PIKA_OPCODE(OP_gte) OpCompBinary(OP_gte, OVR_gte, OVR_gte_r, numcalls); PIKA_NEXT()
+PIKA_OPCODE(OP_lt)  PIKA_QUICKEN(OP_lt);  OpCompBinary(OP_lt,  OVR_lt,  OVR_lt_r,  numcalls); PIKA_NEXT()
+PIKA_OPCODE(OP_gt)  PIKA_QUICKEN(OP_gt);  OpCompBinary(OP_gt,  OVR_gt,  OVR_gt_r,  numcalls); PIKA_NEXT()
+PIKA_OPCODE(OP_lte) PIKA_QUICKEN(OP_lte); OpCompBinary(OP_lte, OVR_lte, OVR_lte_r, numcalls); PIKA_NEXT()
+PIKA_OPCODE(OP_gte) PIKA_QUICKEN(OP_gte); OpCompBinary(OP_gte, OVR_gte, OVR_gte_r, numcalls); PIKA_NEXT()
 
 PIKA_OPCODE(OP_bitand)  OpBitBinary(OP_bitand, OVR_bitand,  OVR_bitand_r,   numcalls); PIKA_NEXT()
 PIKA_OPCODE(OP_bitor)   OpBitBinary(OP_bitor,  OVR_bitor,   OVR_bitor_r,    numcalls); PIKA_NEXT()
@@ -163,8 +193,7 @@ PIKA_OPCODE(OP_xor)
     Value& a = Top1();
 
     Pop();
-    a.val.index = engine->ToBoolean(this, a) != engine->ToBoolean(this, b);
-    a.tag = TAG_boolean;
+    a.SetBool(engine->ToBoolean(this, a) != engine->ToBoolean(this, b));
 }
 PIKA_NEXT()
 
@@ -193,9 +222,9 @@ PIKA_OPCODE(OP_not)
     Value& a = Top();
     OpOverride ovr = OVR_not;
 
-    if (a.tag >= TAG_basic) 
+    if (a.GetTag() >= TAG_basic) 
     {
-        Basic* bobj = a.val.basic;
+        Basic* bobj = a.GetBasic();
         bool handled = false;
 
         if (SetupOverrideUnary(bobj, ovr, &handled)) 
@@ -221,13 +250,13 @@ PIKA_OPCODE(OP_bitnot)
     Value& a = Top();
     OpOverride ovr = OVR_bitnot;
 
-    if (a.tag == TAG_integer) 
+    if (a.GetTag() == TAG_integer) 
     {
-        a.val.integer = ~a.val.integer;
+        a.Set((pint_t)~a.GetInteger());
     }
-    else if (a.tag >= TAG_object) 
+    else if (a.GetTag() >= TAG_object) 
     {
-        Basic* bobj = a.val.basic;
+        Basic* bobj = a.GetBasic();
         if (SetupOverrideUnary(bobj, ovr)) 
         {
             ++numcalls;
@@ -279,6 +308,11 @@ PIKA_NEXT()
 
 PIKA_OPCODE(OP_cat) 
 {
+    if (Top1().IsString() && Top().IsString())
+    {
+        PIKA_REWRITE(OP_cat_ss);
+    }
+    
     if (OpCat(false)) 
     {
         ++numcalls;
@@ -304,3 +338,133 @@ PIKA_OPCODE(OP_unpack)
     }
 }
 PIKA_NEXT()
+
+// Quickened arithmetic ////////////////////////////////////////////////////////////////////////////
+
+#define PIKA_QUICK_ARITH(XOP, XGENERIC, XOVR, XTYPE, XIS, XGET, XFUN)                               \
+PIKA_OPCODE(XOP)                                                                                    \
+{                                                                                                   \
+    Value& b = Top();                                                                               \
+    Value& a = Top1();                                                                              \
+    if (a.XIS() && b.XIS())                                                                         \
+    {                                                                                               \
+        XTYPE x = a.XGET();                                                                         \
+        XTYPE y = b.XGET();                                                                         \
+        XFUN(x, y);                                                                                 \
+        a.Set(x);                                                                                   \
+        Pop();                                                                                      \
+    }                                                                                               \
+    else                                                                                            \
+    {                                                                                               \
+        PIKA_REWRITE(XGENERIC);                                                                     \
+        OpArithBinary(XGENERIC, XOVR, XOVR##_r, numcalls);                                          \
+    }                                                                                               \
+}                                                                                                   \
+PIKA_NEXT()
+
+PIKA_QUICK_ARITH(OP_add_ii, OP_add, OVR_add, pint_t,  IsInteger, GetInteger, add_num)
+PIKA_QUICK_ARITH(OP_add_rr, OP_add, OVR_add, preal_t, IsReal,    GetReal,    add_num)
+PIKA_QUICK_ARITH(OP_sub_ii, OP_sub, OVR_sub, pint_t,  IsInteger, GetInteger, sub_num)
+PIKA_QUICK_ARITH(OP_sub_rr, OP_sub, OVR_sub, preal_t, IsReal,    GetReal,    sub_num)
+PIKA_QUICK_ARITH(OP_mul_ii, OP_mul, OVR_mul, pint_t,  IsInteger, GetInteger, mul_num)
+PIKA_QUICK_ARITH(OP_mul_rr, OP_mul, OVR_mul, preal_t, IsReal,    GetReal,    mul_num)
+PIKA_QUICK_ARITH(OP_div_rr, OP_div, OVR_div, preal_t, IsReal,    GetReal,    div_num)
+
+// Quickened comparison ////////////////////////////////////////////////////////////////////////////
+
+#define PIKA_QUICK_COMP(XOP, XGENERIC, XOVR, XIS, XGET, XFUN)                                       \
+PIKA_OPCODE(XOP)                                                                                    \
+{                                                                                                   \
+    Value& b = Top();                                                                               \
+    Value& a = Top1();                                                                              \
+    if (a.XIS() && b.XIS())                                                                         \
+    {                                                                                               \
+        a.SetBool(XFUN(a.XGET(), b.XGET()));                                                        \
+        Pop();                                                                                      \
+    }                                                                                               \
+    else                                                                                            \
+    {                                                                                               \
+        PIKA_REWRITE(XGENERIC);                                                                     \
+        OpCompBinary(XGENERIC, XOVR, XOVR##_r, numcalls);                                           \
+    }                                                                                               \
+}                                                                                                   \
+PIKA_NEXT()
+
+PIKA_QUICK_COMP(OP_lt_ii,  OP_lt,  OVR_lt,  IsInteger, GetInteger,  le_num)
+PIKA_QUICK_COMP(OP_lt_rr,  OP_lt,  OVR_lt,  IsReal,    GetReal,     le_num)
+PIKA_QUICK_COMP(OP_gt_ii,  OP_gt,  OVR_gt,  IsInteger, GetInteger,  gr_num)
+PIKA_QUICK_COMP(OP_gt_rr,  OP_gt,  OVR_gt,  IsReal,    GetReal,     gr_num)
+PIKA_QUICK_COMP(OP_lte_ii, OP_lte, OVR_lte, IsInteger, GetInteger, lte_num)
+PIKA_QUICK_COMP(OP_lte_rr, OP_lte, OVR_lte, IsReal,    GetReal,    lte_num)
+PIKA_QUICK_COMP(OP_gte_ii, OP_gte, OVR_gte, IsInteger, GetInteger, gte_num)
+PIKA_QUICK_COMP(OP_gte_rr, OP_gte, OVR_gte, IsReal,    GetReal,    gte_num)
+
+// Quickened equality. On a mismatch the instruction is fetched again as the generic opcode.
+
+PIKA_OPCODE(OP_eq_ii)
+{
+    Value& b = Top();
+    Value& a = Top1();
+    if (a.IsInteger() && b.IsInteger())
+    {
+        a.SetBool(a.GetInteger() == b.GetInteger());
+        Pop();
+        PIKA_NEXT()
+    }
+    PIKA_REWRITE(OP_eq);
+    --pc;
+}
+PIKA_NEXT()
+
+PIKA_OPCODE(OP_ne_ii)
+{
+    Value& b = Top();
+    Value& a = Top1();
+    if (a.IsInteger() && b.IsInteger())
+    {
+        a.SetBool(a.GetInteger() != b.GetInteger());
+        Pop();
+        PIKA_NEXT()
+    }
+    PIKA_REWRITE(OP_ne);
+    --pc;
+}
+PIKA_NEXT()
+
+// Quickened concat ////////////////////////////////////////////////////////////////////////////////
+
+PIKA_OPCODE(OP_cat_ss)
+{
+    Value& b = Top();
+    Value& a = Top1();
+    if (a.IsString() && b.IsString())
+    {
+        String* stra = a.GetString();
+        String* strb = b.GetString();
+        if (stra->GetLength() == 0)
+        {
+            a.Set(strb);
+        }
+        else if (strb->GetLength() != 0)
+        {
+            a.Set(String::Concat(stra, strb));
+        }
+        Pop();
+    }
+    else
+    {
+        PIKA_REWRITE(OP_cat);
+        if (OpCat(false))
+        {
+            ++numcalls;
+        }
+    }
+}
+PIKA_NEXT()
+
+#undef PIKA_QUICK_COMP
+#undef PIKA_QUICK_ARITH
+#undef PIKA_QUICKEN
+#undef PIKA_QUICKEN_RR
+#undef PIKA_QUICKEN_II
+#undef PIKA_REWRITE
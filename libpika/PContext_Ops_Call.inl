@@ -10,7 +10,7 @@ PIKA_OPCODE(OP_tailapply)
     if (env) {
         // Before we replace the current call stack we need to allow the LexicalEnv
         // a chance to copy the local variables.
-        env->EndCall();
+        env->EndCall(engine->GetGC());
     }
     u1 argc = GetByteOperand(instr);
     u1 kwargc = GetByte2Operand(instr);
@@ -44,7 +44,7 @@ PIKA_OPCODE(OP_tailcall)
     if (env) {
         // Before we replace the current call stack we need to allow the LexicalEnv
         // a chance to copy the local variables.
-        env->EndCall();
+        env->EndCall(engine->GetGC());
     }
     const u1 argc = GetByteOperand(instr);
     const u1 kwargc = GetByte2Operand(instr);
@@ -0,0 +1,209 @@
+/*
+ *  PContext_Ops_Fused.inl
+ *  See Copyright Notice in Pika.h
+ */
+
+/* Superinstructions.
+ * A superinstruction takes the place of the first instruction of a common sequence while the
+ * rest of the sequence stays in the bytecode after it (see Compiler::Fuse). It reads the operands
+ * of the sequence from those words and skips past them once the whole sequence has executed.
+ * Since only the first word changes, jumps into the sequence, line information, the debugger and
+ * generators all still see the original instructions.
+ *
+ * Arithmetic and comparisons are only done in place for two integers or two reals. For anything
+ * else the superinstruction performs the first instruction of the sequence and continues with the
+ * second one, so that overrides and errors are handled by the generic opcodes.
+ */
+
+#define PIKA_OPERAND_AT(N)  GetShortOperand(pc[N])              // Operand of the word N places after the superinstruction.
+#define PIKA_LOCAL_AT(N)    GetLocal(PIKA_OPERAND_AT(N))
+#define PIKA_LITERAL_AT(N)  closure->GetLiteral(PIKA_OPERAND_AT(N))
+
+/* Continues with the next word as the opcode XOP without dispatching it. */
+#define PIKA_CONTINUE(XOP)  \
+    {                       \
+        instr = *pc++;      \
+        oc = XOP;           \
+        goto lbl_##XOP;     \
+    }
+
+#define PIKA_PUSH_RESULT(R)     Push(R)
+#define PIKA_STORE_RESULT(R)    PIKA_LOCAL_AT(-1).Set(R)    // The setlocal is the last word skipped.
+
+// Pushes //////////////////////////////////////////////////////////////////////////////////////////
+
+PIKA_OPCODE(OP_pushll)
+{
+    Push(GetLocal(GetShortOperand(instr)));
+    Push(PIKA_LOCAL_AT(0));
+    ++pc;
+}
+PIKA_NEXT()
+
+PIKA_OPCODE(OP_pushlk)
+{
+    Push(GetLocal(GetShortOperand(instr)));
+    Push(PIKA_LITERAL_AT(0));
+    ++pc;
+}
+PIKA_NEXT()
+
+// Arithmetic //////////////////////////////////////////////////////////////////////////////////////
+
+/* pushlocal; XVALUE; XARITH and, when XLENGTH is 3, setlocal. */
+#define PIKA_FUSED_ARITH(XOP, XVALUE, XVALUEOP, XFUN, XLENGTH, XRESULT)                             \
+PIKA_OPCODE(XOP)                                                                                    \
+{                                                                                                   \
+    Value&       a = GetLocal(GetShortOperand(instr));                                              \
+    const Value& b = XVALUE(0);                                                                     \
+    if (a.IsInteger() && b.IsInteger())                                                             \
+    {                                                                                               \
+        pint_t x = a.GetInteger();                                                                  \
+        pint_t y = b.GetInteger();                                                                  \
+        pc += XLENGTH;                                                                              \
+        XFUN(x, y);                                                                                 \
+        XRESULT(x);                                                                                 \
+    }                                                                                               \
+    else if (a.IsReal() && b.IsReal())                                                              \
+    {                                                                                               \
+        preal_t x = a.GetReal();                                                                    \
+        preal_t y = b.GetReal();                                                                    \
+        pc += XLENGTH;                                                                              \
+        XFUN(x, y);                                                                                 \
+        XRESULT(x);                                                                                 \
+    }                                                                                               \
+    else                                                                                            \
+    {                                                                                               \
+        Push(a);                                                                                    \
+        PIKA_CONTINUE(XVALUEOP)                                                                     \
+    }                                                                                               \
+}                                                                                                   \
+PIKA_NEXT()
+
+PIKA_FUSED_ARITH(OP_add_ll,    PIKA_LOCAL_AT,   OP_pushlocal,   add_num, 2, PIKA_PUSH_RESULT)
+PIKA_FUSED_ARITH(OP_sub_ll,    PIKA_LOCAL_AT,   OP_pushlocal,   sub_num, 2, PIKA_PUSH_RESULT)
+PIKA_FUSED_ARITH(OP_mul_ll,    PIKA_LOCAL_AT,   OP_pushlocal,   mul_num, 2, PIKA_PUSH_RESULT)
+PIKA_FUSED_ARITH(OP_add_lk,    PIKA_LITERAL_AT, OP_pushliteral, add_num, 2, PIKA_PUSH_RESULT)
+PIKA_FUSED_ARITH(OP_sub_lk,    PIKA_LITERAL_AT, OP_pushliteral, sub_num, 2, PIKA_PUSH_RESULT)
+PIKA_FUSED_ARITH(OP_mul_lk,    PIKA_LITERAL_AT, OP_pushliteral, mul_num, 2, PIKA_PUSH_RESULT)
+PIKA_FUSED_ARITH(OP_add_ll_sl, PIKA_LOCAL_AT,   OP_pushlocal,   add_num, 3, PIKA_STORE_RESULT)
+PIKA_FUSED_ARITH(OP_add_lk_sl, PIKA_LITERAL_AT, OP_pushliteral, add_num, 3, PIKA_STORE_RESULT)
+PIKA_FUSED_ARITH(OP_sub_lk_sl, PIKA_LITERAL_AT, OP_pushliteral, sub_num, 3, PIKA_STORE_RESULT)
+
+PIKA_OPCODE(OP_add_sl)
+{
+    Value& b = Top();
+    Value& a = Top1();
+    if (a.IsInteger() && b.IsInteger())
+    {
+        pint_t x = a.GetInteger();
+        pint_t y = b.GetInteger();
+        ++pc;
+        add_num(x, y);
+        Pop(2);
+        PIKA_STORE_RESULT(x);
+    }
+    else if (a.IsReal() && b.IsReal())
+    {
+        preal_t x = a.GetReal();
+        preal_t y = b.GetReal();
+        ++pc;
+        add_num(x, y);
+        Pop(2);
+        PIKA_STORE_RESULT(x);
+    }
+    else
+    {
+        OpArithBinary(OP_add, OVR_add, OVR_add_r, numcalls);
+    }
+}
+PIKA_NEXT()
+
+// Comparison and branch ///////////////////////////////////////////////////////////////////////////
+
+/* pushlocal; XVALUE; XCOMP; jumpiffalse */
+#define PIKA_FUSED_COMPJUMP(XOP, XVALUE, XVALUEOP, XFUN)                                            \
+PIKA_OPCODE(XOP)                                                                                    \
+{                                                                                                   \
+    Value&       a = GetLocal(GetShortOperand(instr));                                              \
+    const Value& b = XVALUE(0);                                                                     \
+    bool res = false;                                                                               \
+    if (a.IsInteger() && b.IsInteger())                                                             \
+    {                                                                                               \
+        res = XFUN(a.GetInteger(), b.GetInteger());                                                 \
+    }                                                                                               \
+    else if (a.IsReal() && b.IsReal())                                                              \
+    {                                                                                               \
+        res = XFUN(a.GetReal(), b.GetReal());                                                       \
+    }                                                                                               \
+    else                                                                                            \
+    {                                                                                               \
+        Push(a);                                                                                    \
+        PIKA_CONTINUE(XVALUEOP)                                                                     \
+    }                                                                                               \
+    pc = res ? pc + 3 : closure->GetBytecode() + PIKA_OPERAND_AT(2);                                \
+}                                                                                                   \
+PIKA_NEXT()
+
+PIKA_FUSED_COMPJUMP(OP_eq_ll_jf,  PIKA_LOCAL_AT,   OP_pushlocal,    eq_num)
+PIKA_FUSED_COMPJUMP(OP_ne_ll_jf,  PIKA_LOCAL_AT,   OP_pushlocal,   neq_num)
+PIKA_FUSED_COMPJUMP(OP_lt_ll_jf,  PIKA_LOCAL_AT,   OP_pushlocal,    le_num)
+PIKA_FUSED_COMPJUMP(OP_gt_ll_jf,  PIKA_LOCAL_AT,   OP_pushlocal,    gr_num)
+PIKA_FUSED_COMPJUMP(OP_lte_ll_jf, PIKA_LOCAL_AT,   OP_pushlocal,   lte_num)
+PIKA_FUSED_COMPJUMP(OP_gte_ll_jf, PIKA_LOCAL_AT,   OP_pushlocal,   gte_num)
+PIKA_FUSED_COMPJUMP(OP_eq_lk_jf,  PIKA_LITERAL_AT, OP_pushliteral,  eq_num)
+PIKA_FUSED_COMPJUMP(OP_ne_lk_jf,  PIKA_LITERAL_AT, OP_pushliteral, neq_num)
+PIKA_FUSED_COMPJUMP(OP_lt_lk_jf,  PIKA_LITERAL_AT, OP_pushliteral,  le_num)
+PIKA_FUSED_COMPJUMP(OP_gt_lk_jf,  PIKA_LITERAL_AT, OP_pushliteral,  gr_num)
+PIKA_FUSED_COMPJUMP(OP_lte_lk_jf, PIKA_LITERAL_AT, OP_pushliteral, lte_num)
+PIKA_FUSED_COMPJUMP(OP_gte_lk_jf, PIKA_LITERAL_AT, OP_pushliteral, gte_num)
+
+// Sequences ending in an opcode that may call, raise or return ////////////////////////////////////
+
+PIKA_OPCODE(OP_setlocal_jump)
+{
+    SetLocal(PopTop(), GetShortOperand(instr));
+    PIKA_CONTINUE(OP_jump)
+}
+PIKA_NEXT()
+
+PIKA_OPCODE(OP_pushnull_pushglobal)
+{
+    PushNull();
+    PIKA_CONTINUE(OP_pushglobal)
+}
+PIKA_NEXT()
+
+PIKA_OPCODE(OP_dotget_lk)
+{
+    Push(GetLocal(GetShortOperand(instr)));
+    Push(PIKA_LITERAL_AT(0));
+    ++pc;
+    PIKA_CONTINUE(OP_dotget)
+}
+PIKA_NEXT()
+
+PIKA_OPCODE(OP_dotget_dk)
+{
+    Push(Top());
+    Push(PIKA_LITERAL_AT(0));
+    ++pc;
+    PIKA_CONTINUE(OP_dotget)
+}
+PIKA_NEXT()
+
+PIKA_OPCODE(OP_ret_l)
+{
+    Push(GetLocal(GetShortOperand(instr)));
+    PIKA_CONTINUE(OP_ret)
+}
+PIKA_NEXT()
+
+#undef PIKA_FUSED_COMPJUMP
+#undef PIKA_FUSED_ARITH
+#undef PIKA_STORE_RESULT
+#undef PIKA_PUSH_RESULT
+#undef PIKA_CONTINUE
+#undef PIKA_LITERAL_AT
+#undef PIKA_LOCAL_AT
+#undef PIKA_OPERAND_AT
@@ -31,7 +31,13 @@ PIKA_NEXT()
 PIKA_OPCODE(OP_jump)
 {
     u2 jmppos = GetShortOperand(instr);
-    pc = closure->GetBytecode() + jmppos;
+    code_t* target = closure->GetBytecode() + jmppos;
+    
+    if (target < pc) // Loops jump backwards.
+    {
+        PIKA_CHECK_PROFILER();
+    }
+    pc = target;
 }
 PIKA_NEXT()
 /*
@@ -42,9 +48,9 @@ PIKA_OPCODE(OP_jumpiffalse)
     Value& t = PopTop();
     u2 jmppos = GetShortOperand(instr);
     
-    if (t.tag == TAG_boolean)
+    if (t.GetTag() == TAG_boolean)
     {
-        if (!t.val.index)
+        if (!t.GetIndex())
         {
             pc = closure->GetBytecode() + jmppos;
         }
@@ -63,9 +69,9 @@ PIKA_OPCODE(OP_jumpiftrue)
     Value& t = PopTop();
     u2 jmppos = GetShortOperand(instr);
     
-    if (t.tag == TAG_boolean)
+    if (t.GetTag() == TAG_boolean)
     {
-        if (t.val.index)
+        if (t.GetIndex())
         {
             pc = closure->GetBytecode() + jmppos;
         }
@@ -140,6 +146,7 @@ PIKA_OPCODE(OP_pushlocal)
 PIKA_NEXT()
 /*
  * Gets a global variable from the current package and pushes it onto the stack.
+ * The lookup is cached per function and name, see Package::GetGlobalCached.
  */
 PIKA_OPCODE(OP_pushglobal)
 {
@@ -147,12 +154,12 @@ PIKA_OPCODE(OP_pushglobal)
     
     const Value& name = closure->GetLiteral(index);
     Value res(NULL_VALUE);
-    if (package && package->GetGlobal(name, res))
+    if (package && package->GetGlobalCached(name, res, closure->GetDef()->GetGlobalCache(index)))
     {
-        if (res.tag == TAG_property)
+        if (res.GetTag() == TAG_property)
         {
             Push(this->package);
-            if (DoPropertyGet(numcalls, res.val.property))
+            if (DoPropertyGet(numcalls, res.GetProperty()))
             {
                 PIKA_NEXT()
             }
@@ -192,7 +199,7 @@ PIKA_OPCODE(OP_pushmember)
     Push(self);
     Push(name);
     
-    OpDotGet(numcalls, oc, OVR_get);
+    OpDotGet(numcalls, oc, OVR_get, &closure->GetDef()->GetMemberCache(index));
 }
 PIKA_NEXT()
 /*
@@ -234,13 +241,13 @@ PIKA_OPCODE(OP_setglobal)
     
     const Value& name = closure->GetLiteral(index);
     Value& val = Top();
-    if (!this->package->SetGlobal(name, val))
+    if (!this->package->SetGlobalCached(name, val, closure->GetDef()->GetGlobalCache(index)))
     {
         Value res(NULL_VALUE);
-        if (this->package->GetGlobal(name, res) && res.tag == TAG_property)
+        if (this->package->GetGlobal(name, res) && res.GetTag() == TAG_property)
         {
             Push(this->package);
-            if (DoPropertySet(res.val.property))
+            if (DoPropertySet(res.GetProperty()))
             {
                 PIKA_NEXT()
             }
@@ -276,7 +283,7 @@ PIKA_OPCODE(OP_setmember)
     Push( self );
     Push( name );
     
-    OpDotSet(oc, OVR_set);
+    OpDotSet(oc, OVR_set, &closure->GetDef()->GetMemberCache(index));
 }
 PIKA_NEXT()
 /*
@@ -56,6 +56,13 @@
 #   define PIKA_CHECK_INSTR_HOOK()
 #endif
 
+/** This macro samples the call stack if the Profiler's timer has fired since the last check. */
+#define PIKA_CHECK_PROFILER()   \
+    if (Profiler::pending)      \
+    {                           \
+        ProfileSample();        \
+    }
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // TODO: Check what version of GCC introduced the labels as values extension and check for that version.
@@ -73,25 +80,64 @@
  * Removes the overhead of the switch statement dispatch by performing an array index
  * followed by a jump directly to the next opcode. Enabling this usually provides 
  * a performace increase so its enabled by default if the compiler is GCC.
+ *
+ * The jump goes through dispatchTable, which is either the table of opcode labels or a table
+ * where every entry leads to the instruction hook. Without an HE_instruction hook the dispatch
+ * does no hook check at all. See Context::UpdateDispatch.
  */
 #   define PIKA_OPCODE(x)           lbl_##x:
-#   define PIKA_NEXT()                                  \
-    {                                                   \
-        if (state != RUNNING)                           \
-            break;                                      \
-        instr = *pc++;                                  \
-        oc = PIKA_GET_OPCODEOF(instr);                  \
-        PIKA_CHECK_INSTR_HOOK()                         \
-        goto *static_jmp_addresses[oc];  /*the jump */  \
-    }
+#   if defined(PIKA_THREADED_CODE)
+/* Direct-threaded dispatch.
+ * The handler of the next instruction is read from the current closure's threaded code, which
+ * only depends on pc and not on the instruction itself. The opcode is still decoded for the
+ * handlers that need it. While an HE_instruction hook is registered threadedBias points to code
+ * where every entry leads to the hook. See Context::ThreadCode.
+ */
+#       define PIKA_THREADED_HANDLER(P) \
+            (*(const void* const*)(threadedBias + (ptrdiff_t)(P) * PIKA_THREADED_SCALE))
+#       define PIKA_NEXT()                              \
+        {                                               \
+            if (state != RUNNING)                       \
+                break;                                  \
+            instr = *pc;                                \
+            oc = PIKA_GET_OPCODEOF(instr);              \
+            goto *PIKA_THREADED_HANDLER(pc++);          \
+        }
+#       define PIKA_BEGIN_DISPATCH()    goto *PIKA_THREADED_HANDLER(pc - 1);
+/* Rewrites the instruction at P and the handler for it in the threaded code. */
+#       define PIKA_REWRITE_INSTR(P, W)                                                         \
+        do {                                                                                    \
+            code_t*   at = (P);                                                                 \
+            Bytecode* bc = closure->def->bytecode;                                              \
+            *at = (W);                                                                          \
+            if (bc->handlers)                                                                   \
+                bc->handlers[at - bc->code] = static_jmp_addresses[PIKA_GET_OPCODEOF(*at)];     \
+        } while (0)
+#   else
+#       define PIKA_NEXT()                              \
+        {                                               \
+            if (state != RUNNING)                       \
+                break;                                  \
+            instr = *pc++;                              \
+            oc = PIKA_GET_OPCODEOF(instr);              \
+            goto *dispatchTable[oc];  /*the jump */     \
+        }
+#       define PIKA_BEGIN_DISPATCH()    goto *dispatchTable[oc];
+#       define PIKA_REWRITE_INSTR(P, W) (*(P) = (W))
+#   endif
+#   define PIKA_SWITCH_INSTR_HOOK()
 #   define PIKA_END_DISPATCH()
-#   define PIKA_BEGIN_DISPATCH()    goto *static_jmp_addresses[oc];
 #else
-/* Switch dispatch. Will work with any compiler. */
-#   define PIKA_OPCODE(x)           case x:
+/* Switch dispatch. Will work with any compiler.
+ * Every opcode is also labeled so that superinstructions can continue with another opcode
+ * without going through the switch. See PContext_Ops_Fused.inl.
+ */
+#   define PIKA_OPCODE(x)           case x: lbl_##x:
 #   define PIKA_NEXT()              continue;
+#   define PIKA_SWITCH_INSTR_HOOK() PIKA_CHECK_INSTR_HOOK()
 #   define PIKA_END_DISPATCH()      default: RaiseException("unknown opcode"); }
 #   define PIKA_BEGIN_DISPATCH()    switch (oc) {
+#   define PIKA_REWRITE_INSTR(P, W) (*(P) = (W))
 #endif
 /*
  *  This is main workhorse of the interpreter. Opcode dispatch and execution is all handled here.
@@ -122,6 +168,17 @@ void Context::Run()
         {
 #       include "POpcodeDef.inl" // Initialize this once, the first time Run is called.
         };
+#       if !defined(PIKA_NO_HOOKS)
+#           undef DECL_OP
+#           define DECL_OP(XOP, XNAME, XLENGTH, XFORMAT, XDESCR) &&lbl_instr_hook,
+    static const void* static_hook_addresses[] =
+        {
+#       include "POpcodeDef.inl"
+        };
+        Pika_HookDispatch = static_hook_addresses;
+#       endif
+        Pika_FastDispatch = static_jmp_addresses;
+        UpdateDispatch(); // The instruction hook may have changed while we were suspended.
 #   endif
         
     if (++numRuns > PIKA_MAX_NATIVE_RECURSION)
@@ -147,12 +204,12 @@ void Context::Run()
             
             //  Pika_PrintInstruction(instr);
             
-            //  PIKA_CHECK_INSTR_HOOK
-            //  We check for the existance of the instruction hook (typically used by debuggers).
-            //  If you are concerned about speed and don't care about supporting debugging you
-            //  can remove this check.
+            //  PIKA_SWITCH_INSTR_HOOK
+            //  With switch dispatch we check for the existance of the instruction hook (typically
+            //  used by debuggers). With labels as values the hook is reached through the jump
+            //  table instead.
             
-            PIKA_CHECK_INSTR_HOOK()
+            PIKA_SWITCH_INSTR_HOOK()
             
             PIKA_BEGIN_DISPATCH()
             
@@ -165,17 +222,22 @@ void Context::Run()
             //  Call & apply operations
 #           include "PContext_Ops_Call.inl"
             
+            //  Superinstructions
+#           include "PContext_Ops_Fused.inl"
+            
             //  dot get|set
             
             PIKA_OPCODE(OP_dotget)
             {
-                OpDotGet(numcalls, oc, OVR_get);
+                u2 index = GetShortOperand(instr);
+                OpDotGet(numcalls, oc, OVR_get, GetMemberCache(index, Top()));
             }
             PIKA_NEXT()
             
             PIKA_OPCODE(OP_dotset)
             {
-                OpDotSet(oc, OVR_set);
+                u2 index = GetShortOperand(instr);
+                OpDotSet(oc, OVR_set, GetMemberCache(index, Top()));
             }
             PIKA_NEXT()
             
@@ -222,19 +284,20 @@ void Context::Run()
                 Value& vdef  = TopN(defaultArgc);
                 Value& vself = TopN(defaultArgc + 1);
                 
-                if (vdef.tag == TAG_def)
+                if (vdef.GetTag() == TAG_def)
                 {
                     // create a new function closure.
-                    Def* fun = vdef.val.def;
+                    Def* fun = vdef.GetDef();
                     
                     DoClosure(fun, vdef, &vself);
                     SET_PARENTPC(fun);
-                    Function* function = vdef.val.function;
+                    Function* function = vdef.GetClosure();
                     
                     if (defaultArgc)
                     {
                         u4 num = Min(defaultArgc, (u2)fun->numArgs);
                         function->defaults = Defaults::Create(engine, GetStackPtr() - num, num);
+                        engine->GetGC()->WriteBarrier(function, function->defaults);
                     }
                     
                     Swap(vdef, vself);
@@ -267,7 +330,7 @@ void Context::Run()
                 
                 if (name.IsString())
                 {
-                    propname = name.val.str;
+                    propname = name.GetString();
                 }
                 else if (name.IsNull())
                 {
@@ -308,20 +371,20 @@ void Context::Run()
                 {
                     p = Property::CreateReadWrite(engine,
                                                   propname,
-                                                  getter.val.function,
-                                                  setter.val.function);
+                                                  getter.GetClosure(),
+                                                  setter.GetClosure());
                 }
                 else if (hasGet)
                 {
                     p = Property::CreateRead(engine,
                                              propname,
-                                             getter.val.function);
+                                             getter.GetClosure());
                 }
                 else if (hasSet)
                 {
                     p = Property::CreateWrite(engine,
                                               propname,
-                                              setter.val.function);
+                                              setter.GetClosure());
                 }
                 else
                 {
@@ -359,7 +422,7 @@ void Context::Run()
                 Value&   vpkg   = Top2();
                 Value&   vname  = TopN(3);
                 
-                String*  name   = vname.val.str;
+                String*  name   = vname.GetString();
                 Type*    newtype   = 0;
                 Package* superPkg  = 0;
                 bool     nullbase  = vbase.IsNull();
@@ -368,7 +431,7 @@ void Context::Run()
                 
                 if (vpkg.IsDerivedFrom(Package::StaticGetClass()))
                 {
-                    superPkg = vpkg.val.package;
+                    superPkg = vpkg.GetPackage();
                     specified_pkg = true;
                 }
                 else
@@ -379,7 +442,7 @@ void Context::Run()
                 if (vbase.IsDerivedFrom(Type::StaticGetClass()) || nullbase)
                 {
                     // Super is a valid type object.
-                    Type* super = nullbase ? engine->Object_Type : vbase.val.type;
+                    Type* super = nullbase ? engine->Object_Type : vbase.GetType();
                     
                     if (super->IsFinal())
                     {
@@ -478,7 +541,7 @@ void Context::Run()
                           
 
                 engine->Dictionary_Type->CreateInstance(vobj);
-                Object* obj = vobj.val.object;
+                Object* obj = vobj.GetObject();
                 
                 if (!(vobj.IsObject() && obj))
                 {
@@ -525,7 +588,7 @@ void Context::Run()
                  *
                  * TODO { Should we convert reals to integers here or not? }
                  */
-                if ((from.tag != TAG_integer) || (to.tag   != TAG_integer) || (step.tag != TAG_integer))
+                if ((from.GetTag() != TAG_integer) || (to.GetTag()   != TAG_integer) || (step.GetTag() != TAG_integer))
                 {
                     ReportRuntimeError(Exception::ERROR_runtime,
                                        "for loop type error: expecting integer.");
@@ -534,12 +597,13 @@ void Context::Run()
                 /* To avoid an infinite loop we make sure the step variable points in the same
                  * direction as the range. Then we adjust the step's sign accordingly.
                  */
-                pint_t  diff  = to.val.integer - from.val.integer;
-                pint_t& istep = step.val.integer;
+                pint_t  diff  = to.GetInteger() - from.GetInteger();
+                pint_t  istep = step.GetInteger();
                 
                 if (!istep)
                 {
                     istep = (diff < 0) ? -1 : 1;
+                    step.Set(istep);
                 }
                 
                 /* WARNING {
@@ -548,14 +612,24 @@ void Context::Run()
                  * We need to do this EVERY time because another run through the code might
                  * yield a different comparison test.
                  * }
+                 *
+                 * The bounds are known to be integers so the quickened comparison is used.
                  */
                 if (istep < 0)
                 {
-                    *(pc + PIKA_FORTO_COMP_OFFSET) = PIKA_MAKE_B(OP_gt); // Set the op to >
+                    PIKA_REWRITE_INSTR(pc + PIKA_FORTO_COMP_OFFSET, PIKA_MAKE_B(OP_gt_ii)); // Set the op to >
                 }
                 else
                 {
-                    *(pc + PIKA_FORTO_COMP_OFFSET) = PIKA_MAKE_B(OP_lt); // Set the op to <
+                    PIKA_REWRITE_INSTR(pc + PIKA_FORTO_COMP_OFFSET, PIKA_MAKE_B(OP_lt_ii)); // Set the op to <
+                }
+                
+                // The comparison may also be part of a superinstruction. (see Compiler::Fuse)
+                
+                Opcode comp = PIKA_GET_OPCODEOF(*pc);
+                if (comp == OP_lt_ll_jf || comp == OP_gt_ll_jf)
+                {
+                    PIKA_REWRITE_INSTR(pc, PIKA_MAKE_W((istep < 0) ? OP_gt_ll_jf : OP_lt_ll_jf, localOffset));
                 }
                 
                 /* Set the loop variables: 'from', 'to' and 'step'. 
@@ -577,7 +651,7 @@ void Context::Run()
                 
                 if (local.IsDerivedFrom(Array::StaticGetClass()))
                 {
-                    Array* array = static_cast<Array*>(local.val.object);
+                    Array* array = static_cast<Array*>(local.GetObject());
                     array->Push(top);
                 }
                 else
@@ -660,7 +734,7 @@ void Context::Run()
                 Value res(NULL_VALUE);
                 bool success = false;
                 
-                if (iter.tag >= TAG_basic && GetOverrideFrom(engine, iter.val.basic, OVR_next, res))
+                if (iter.GetTag() >= TAG_basic && GetOverrideFrom(engine, iter.GetBasic(), OVR_next, res))
                 {
                     this->Push(iter);
                     this->Push(res);
@@ -707,9 +781,9 @@ void Context::Run()
                 }
                 
                 // If this is a Basic derived object.
-                if (object.tag >= TAG_basic)
+                if (object.GetTag() >= TAG_basic)
                 {
-                    if (field.val.str == engine->emptyString && 
+                    if (field.GetString() == engine->emptyString && 
                         (engine->Iterator_Type->IsInstance(object)))
                     {
                         result = object;
@@ -717,12 +791,12 @@ void Context::Run()
                     else
                     {
                         // Find out if the field exists.
-                        Object* subj = object.val.object;
+                        Object* subj = object.GetObject();
                         if (subj->GetSlot(field, result))
                         {
                             // If its a generator function
                             if (engine->Function_Type->IsInstance(result) &&
-                                result.val.function->GetDef()->isGenerator)
+                                result.GetClosure()->GetDef()->isGenerator)
                             {
                                 // Push object and function
                                 Push(object);
@@ -748,10 +822,10 @@ void Context::Run()
                         }
                         else
                         {
-                            Iterator* iterator = GetIteratorFrom(this, object, field.val.str);
+                            Iterator* iterator = GetIteratorFrom(this, object, field.GetString());
                             if (!iterator)
                             {
-                                if (field.val.str == engine->emptyString)
+                                if (field.GetString() == engine->emptyString)
                                 {
                                     ReportRuntimeError(Exception::ERROR_runtime,
                                                        "Cannot find iterator for object of type %s.",
@@ -761,7 +835,7 @@ void Context::Run()
                                 {
                                     ReportRuntimeError(Exception::ERROR_runtime, 
                                                        "Cannot find iterator '%s' for object of type %s.",
-                                                       field.val.str->GetBuffer(), 
+                                                       field.GetString()->GetBuffer(), 
                                                        engine->GetTypenameOf(object)->GetBuffer());    
                                 }
 
@@ -772,7 +846,7 @@ void Context::Run()
                 }
                 else
                 {
-                    if (field.val.str == engine->emptyString)
+                    if (field.GetString() == engine->emptyString)
                     {
                         ReportRuntimeError(Exception::ERROR_runtime,
                                            "Cannot find iterator for object of type %s.",
@@ -782,7 +856,7 @@ void Context::Run()
                     {
                         ReportRuntimeError(Exception::ERROR_runtime, 
                                            "Cannot find iterator '%s' for object of type %s.",
-                                           field.val.str->GetBuffer(), 
+                                           field.GetString()->GetBuffer(), 
                                            engine->GetTypenameOf(object)->GetBuffer());    
                     }
                 }                
@@ -795,10 +869,10 @@ void Context::Run()
                 Value& a = Top();
                 Value& b = Top1();
                 
-                if (a.tag != b.tag)
+                if (a.GetTag() != b.GetTag())
                     b.SetFalse();
                 else
-                    b.SetBool(a.val.index == b.val.index);
+                    b.SetBool(a.GetIndex() == b.GetIndex() || (a.GetTag() == TAG_string && Pika_StringsEqual(a.GetString(), b.GetString())));
                     
                 Pop();
             }
@@ -809,10 +883,10 @@ void Context::Run()
                 Value& a = Top();
                 Value& b = Top1();
                 
-                if (a.tag != b.tag)
+                if (a.GetTag() != b.GetTag())
                     b.SetTrue();
                 else
-                    b.SetBool(a.val.index != b.val.index);
+                    b.SetBool(a.GetIndex() != b.GetIndex() && !(a.GetTag() == TAG_string && Pika_StringsEqual(a.GetString(), b.GetString())));
                     
                 Pop();
             }
@@ -897,7 +971,7 @@ void Context::Run()
             {                
                 Value oldself = self;
                 PopWithScope();
-                if (oldself.tag >= TAG_basic)
+                if (oldself.GetTag() >= TAG_basic)
                 {
                     Value res(NULL_VALUE);
                     Type* basicType = engine->GetTypeOf(oldself);
@@ -956,13 +1030,13 @@ void Context::Run()
                 // Otherwise we use the current package in this scope.
                 
                 super = (engine->Package_Type->IsInstance(super_pkg)) ?
-                         super_pkg.val.package :
+                         super_pkg.GetPackage() :
                          this->package;
                                 
                 if (super)
                 {                    
                     Object* newpkg = 0;
-                    newpkg = Package::Create(engine, pkg_name.val.str, super);
+                    newpkg = Package::Create(engine, pkg_name.GetString(), super);
                     
                     if (newpkg)
                     {
@@ -972,7 +1046,7 @@ void Context::Run()
                     {
                         ReportRuntimeError(Exception::ERROR_runtime, 
                                            "Unable to create package %s as child of package %s",
-                                           pkg_name.val.str->GetBuffer(),
+                                           pkg_name.GetString()->GetBuffer(),
                                            super->GetDotName()->GetBuffer());
                     }
                 }
@@ -1005,7 +1079,7 @@ void Context::Run()
                                        typeEnv->GetBuffer(),
                                        engine->Package_Type->GetDotName()->GetBuffer());
                 }
-                Package* pkg = the_env.val.package;
+                Package* pkg = the_env.GetPackage();
                 PushPackageScope();
                 this->package = pkg;
             }
@@ -1033,6 +1107,24 @@ void Context::Run()
             }
             PIKA_NEXT()
             
+#   if defined(PIKA_LABELS_AS_VALUES) && !defined(PIKA_NO_HOOKS)
+            // Every entry of the hook table leads here. The hook is called and then the
+            // instruction is dispatched normally. Once the last hook is removed we switch back
+            // to the fast table.
+            lbl_instr_hook:
+            {
+                if (engine->HasHook(HE_instruction))
+                {
+                    PIKA_CHECK_INSTR_HOOK()
+                }
+                else
+                {
+                    UpdateDispatch();
+                }
+                goto *static_jmp_addresses[oc];
+            }
+#   endif
+            
             PIKA_END_DISPATCH()
         }
         catch (Exception& e)
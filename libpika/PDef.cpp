@@ -10,11 +10,17 @@
 #include "PEngine.h"
 #include "PString.h"
 #include "PLiteralPool.h"
+#include "PPackage.h"
+#include "PType.h"
+#include "PShape.h"
 
 namespace pika {
 
 Bytecode::Bytecode(code_t* cd, u2 len)
     : code(0),
+#if defined(PIKA_THREADED_CODE)
+    handlers(0),
+#endif
     length(0)
 {
     code = (code_t*)Pika_malloc(sizeof(code_t) * len);
@@ -25,6 +31,9 @@ Bytecode::Bytecode(code_t* cd, u2 len)
 Bytecode::~Bytecode()
 {
     Pika_free(code);
+#if defined(PIKA_THREADED_CODE)
+    Pika_free(handlers);
+#endif
 }
 
 void Def::SetSource(Engine* eng, const char* buff, size_t len)
@@ -36,16 +45,14 @@ void Def::SetSource(Engine* eng, const char* buff, size_t len)
 Def* Def::Create(Engine* eng)
 {
     Def* fn = 0;
-    PIKA_NEW(Def, fn, ());
-    
-    eng->AddToGC(fn);
+    GCNEW(eng, Def, fn, ());
     return fn;
 }
 
 Def* Def::CreateWith(Engine* eng, String* name, Nativecode_t fn, u2 argc, u4 flags, Def* parent, const char* doc)
 {
     Def* def = 0;
-    PIKA_NEW(Def, def, (name, fn, argc, PIKA_FLAG2FIELD(flags, DEF_VAR_ARGS), PIKA_FLAG2FIELD(flags, DEF_STRICT), PIKA_FLAG2FIELD(flags, DEF_KEYWORD_ARGS), parent));
+    GCALLOC(eng, Def, def, (name, fn, argc, PIKA_FLAG2FIELD(flags, DEF_VAR_ARGS), PIKA_FLAG2FIELD(flags, DEF_STRICT), PIKA_FLAG2FIELD(flags, DEF_KEYWORD_ARGS), parent));
     if (doc) {
         def->__native_doc__ = doc;
     }
@@ -56,6 +63,13 @@ Def* Def::CreateWith(Engine* eng, String* name, Nativecode_t fn, u2 argc, u4 fla
 Def::~Def()
 {
     Pika_delete(bytecode);
+    Pika_free(globalCache);
+    
+    for (size_t i = 0; i < numMemberCache; ++i)
+    {
+        Pika_free(memberCache[i]);
+    }
+    Pika_free(memberCache);
 }
 
 void Def::SetGenerator()
@@ -78,6 +92,68 @@ void Def::MarkRefs(Collector* c)
         }
     }
     kwargs.DoMark(c);
+    
+    for (size_t i = 0; i < numGlobalCache; ++i)
+    {
+        if (globalCache[i].package)
+        {
+            globalCache[i].package->Mark(c);
+        }
+    }
+    
+    for (size_t i = 0; i < numMemberCache; ++i)
+    {
+        if (MemberCache* mc = memberCache[i])
+        {
+            for (u4 e = 0; e < mc->count; ++e)
+            {
+                mc->entries[e].type->Mark(c);
+                if (mc->entries[e].shape)
+                    mc->entries[e].shape->Mark(c);
+            }
+        }
+    }
+}
+
+GlobalCache& Def::AllocGlobalCache(u2 idx)
+{
+    size_t oldSize = numGlobalCache;
+    size_t newSize = literals ? literals->GetSize() : 0;
+    
+    if (newSize <= idx)
+        newSize = idx + 1;
+    
+    globalCache = (GlobalCache*)Pika_realloc(globalCache, newSize * sizeof(GlobalCache));
+    Pika_memzero(globalCache + oldSize, (newSize - oldSize) * sizeof(GlobalCache));
+    
+    for (size_t i = oldSize; i < newSize; ++i)
+    {
+        globalCache[i].owner = this;
+    }
+    numGlobalCache = newSize;
+    return globalCache[idx];
+}
+
+MemberCache& Def::AllocMemberCache(u2 idx)
+{
+    if (idx >= numMemberCache)
+    {
+        size_t oldSize = numMemberCache;
+        size_t newSize = literals ? literals->GetSize() : 0;
+        
+        if (newSize <= idx)
+            newSize = idx + 1;
+        
+        memberCache = (MemberCache**)Pika_realloc(memberCache, newSize * sizeof(MemberCache*));
+        Pika_memzero(memberCache + oldSize, (newSize - oldSize) * sizeof(MemberCache*));
+        numMemberCache = newSize;
+    }
+    
+    MemberCache* mc = (MemberCache*)Pika_malloc(sizeof(MemberCache));
+    Pika_memzero(mc, sizeof(MemberCache));
+    mc->owner = this;
+    memberCache[idx] = mc;
+    return *mc;
 }
 
 void Def::SetBytecode(code_t* bc, u2 len)
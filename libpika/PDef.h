@@ -28,6 +28,10 @@ template class PIKA_API Buffer<LocalVarInfo>;
 class Context;
 class Function;
 class LiteralPool;
+class Package;
+class Type;
+class ClassInfo;
+class Shape;
 
 /** The proto-type for a native function callable by Pika.
   *
@@ -79,14 +83,65 @@ struct RegisterProperty
     const char*  __doc;
 };
 
+/** Inline cache for OP_pushglobal and OP_setglobal. 
+  * A cache entry is valid while the versions of the Tables walked to find the 
+  * global are unchanged.
+  * @see Package::GetGlobalCached
+  */
+struct GlobalCache
+{
+    GCObject* owner;   //!< Object the cache belongs to (used for the write barrier.)
+    Package*  package; //!< Package the lookup started from.
+    Slot*     slot;    //!< Slot the global was found in.
+    size_t    stamp;   //!< Sum of the Table versions from package to the package owning slot.
+    u2        depth;   //!< Number of super packages walked to reach slot.
+};
+
+/** Flags describing how a MemberCacheEntry's receiver can be accessed. */
+enum MemberCacheFlags
+{
+    MCF_get = 1 << 0, //!< Receiver's slots are read through Object::GetSlot.
+    MCF_set = 1 << 1, //!< Receiver's slots are written through Object::SetSlot, it has no opSet and the member can be set.
+};
+
+/** A single receiver of a MemberCache. */
+struct MemberCacheEntry
+{
+    ClassInfo* info;  //!< Native class of the receiver.
+    Type*      type;  //!< Type of the receiver.
+    Slot*      slot;  //!< Slot of the member in type or one of its base types. Null if the type chain does not have the member.
+    size_t     stamp; //!< Engine::GetTypeEpoch when the entry was filled.
+    u4         flags; //!< MemberCacheFlags that apply to the receiver.
+    Shape*     shape; //!< Last Shape seen for receivers in shape mode.
+    u2         index; //!< Index of the member in shape or Shape::NO_INDEX.
+};
+
+/** Polymorphic inline cache for OP_dotget, OP_dotset, OP_pushmember and OP_setmember.
+  * Up to PIKA_MEMBER_CACHE_SIZE receiver types are cached. An entry is valid while 
+  * its type's hierarchy version is unchanged.
+  * @see Object::GetSlotCached
+  */
+struct MemberCache
+{
+    GCObject*        owner;                            //!< Object the cache belongs to (used for the write barrier.)
+    MemberCacheEntry entries[PIKA_MEMBER_CACHE_SIZE];  //!< Cached receivers.
+    u4               count;                            //!< Number of entries in use.
+    u4               hits;                             //!< Number of lookups resolved by an entry.
+    u4               misses;                           //!< Number of lookups that had to fill an entry.
+    u4               megamorphic;                      //!< Number of lookups that missed when every entry was in use.
+};
+
 class Bytecode
 {
 public:
     Bytecode(code_t* code, u2 length);
     ~Bytecode();
     
-    code_t* code;
-    u2      length;
+    code_t*      code;
+#if defined(PIKA_THREADED_CODE)
+    const void** handlers; //!< Direct-threaded form of code: the address in Context::Run of each instruction's handler. Created the first time the code is run.
+#endif
+    u2           length;
 };
 
 // Def /////////////////////////////////////////////////////////////////////////////////////
@@ -109,7 +164,11 @@ class PIKA_API Def : public GCObject
             isStrict(false),
             isGenerator(false),
             line(-1),
-            __native_doc__(0) {}
+            __native_doc__(0),
+            globalCache(0),
+            numGlobalCache(0),
+            memberCache(0),
+            numMemberCache(0) {}
     
     Def(String* declname, Nativecode_t fn, u2 argc, 
         bool varargs, bool strict, bool kwas, Def* parent_def) : name(declname),
@@ -128,11 +187,16 @@ class PIKA_API Def : public GCObject
             isStrict(strict),
             isGenerator(false),
             line(-1),
-            __native_doc__(0) {}
+            __native_doc__(0),
+            globalCache(0),
+            numGlobalCache(0),
+            memberCache(0),
+            numMemberCache(0) {}
 public:
     virtual ~Def();
     
     virtual void MarkRefs(Collector* c);
+    virtual const char* GetGCName() const { return "Def"; }
     
     static Def* CreateWith(Engine* eng, String* name, Nativecode_t fn, u2 argc, 
                            u4 flags, Def* parent, const char* doc=0);
@@ -148,6 +212,27 @@ public:
     void SetLocalRange(size_t local, size_t start, size_t end);
     void SetSource(Engine* eng, const char* buff, size_t len);
     void SetGenerator();
+    
+    /** Returns the global inline cache for the name at literal index idx. */
+    INLINE GlobalCache& GetGlobalCache(u2 idx)
+    {
+        return (idx < numGlobalCache) ? globalCache[idx] : AllocGlobalCache(idx);
+    }
+    
+    /** Returns the member inline cache for the name at literal index idx. */
+    INLINE MemberCache& GetMemberCache(u2 idx)
+    {
+        return (idx < numMemberCache && memberCache[idx]) ? *memberCache[idx] : AllocMemberCache(idx);
+    }
+    
+    /** Returns the member inline cache at literal index idx if it has been created, otherwise null. */
+    INLINE MemberCache* FindMemberCache(u2 idx) const
+    {
+        return (idx < numMemberCache) ? memberCache[idx] : 0;
+    }
+    
+    INLINE size_t GetMemberCacheCount() const { return numMemberCache; }
+    
     String*          name;        //!< Declared name.
     String*          source;      //!< Source code.
     Def*             parent;      //!< Parent function.
@@ -173,6 +258,16 @@ public:
     bool         isGenerator; //!< Function has yield statement.
     int          line;        //!< Line in the script this def is declared or -1 for native defs.
     const char*  __native_doc__;
+private:
+    GlobalCache& AllocGlobalCache(u2 idx);
+    
+    GlobalCache* globalCache;    //!< Global variable inline caches, indexed by literal.
+    size_t       numGlobalCache; //!< Length of globalCache.
+    
+    MemberCache& AllocMemberCache(u2 idx);
+    
+    MemberCache** memberCache;    //!< Member inline caches, indexed by literal and created on first use.
+    size_t        numMemberCache; //!< Length of memberCache.
 };
 
 }// pika
@@ -7,15 +7,79 @@
 
 namespace pika {
 
+namespace {
+
+// Holes in the array part use a tag that no script value can have.
+INLINE bool IsHole(const Value& v) { return v.GetTag() == MAX_TAG; }
+INLINE void SetHole(Value& v)      { v.SetNull(); v.SetTag(MAX_TAG); }
+
+// Returns true if key can be stored in an array part of the given size.
+INLINE bool InArray(const Value& key, size_t size)
+{
+    return key.GetTag() == TAG_integer && key.GetInteger() >= 0 && (size_t)key.GetInteger() < size;
+}
+
+// Returns the smallest b where x <= 2^b.
+INLINE size_t Pika_Log2Ceil(size_t x)
+{
+    size_t b = 0;
+    while (((size_t)1 << b) < x)
+        ++b;
+    return b;
+}
+
+}// namespace
+
+/** Iterates over the array part followed by the hash part. */
+class DictionaryIterator : public ObjectIterator
+{
+public:
+    DictionaryIterator(Engine* eng, Type* typ, IterateKind k, Dictionary* d)
+            : ObjectIterator(eng, typ, k, d, &d->elements, true), dict(d)
+    {
+        Rewind();
+    }
+    
+    virtual ~DictionaryIterator() {}
+protected:
+    virtual void CollectKeys(Buffer<Value>& keys)
+    {
+        ObjectIterator::CollectKeys(keys);
+        
+        // Put the array part first, in order.
+        size_t hashKeys = keys.GetSize();
+        keys.Resize(hashKeys + dict->arrayCount);
+        Pika_memmove(keys.GetAt(dict->arrayCount), keys.GetAt(0), hashKeys * sizeof(Value));
+        
+        size_t s = 0;
+        for (size_t i = 0; i < dict->array.GetSize(); ++i)
+        {
+            if (!IsHole(dict->array[i]))
+                keys[s++] = Value((pint_t)i);
+        }
+    }
+    
+    virtual bool GetValue(const Value& key, Value& res)
+    {
+        return dict->BracketRead(key, res);
+    }
+    
+    Dictionary* dict;
+};
+
 PIKA_IMPL(Dictionary)
 
-Dictionary::Dictionary(Engine* eng, Type* t) : ThisSuper(eng, t)
+Dictionary::Dictionary(Engine* eng, Type* t) : ThisSuper(eng, t), arrayCount(0), hashIntKeys(0)
 {
 }
 
 Dictionary::Dictionary(const Dictionary* rhs) : ThisSuper(rhs),
-    elements(rhs->elements)
+    elements(rhs->elements),
+    array(rhs->array),
+    arrayCount(rhs->arrayCount),
+    hashIntKeys(rhs->hashIntKeys)
 {
+    engine->GetGC()->ChargeExternal(0, elements.GetBytes() + array.GetCapacity() * sizeof(Value));
 }
 
 Dictionary::~Dictionary()
@@ -33,6 +97,17 @@ void Dictionary::MarkRefs(Collector* c)
 {
     ThisSuper::MarkRefs(c);
     elements.DoMark(c);
+    
+    for (size_t i = 0; i < array.GetSize(); ++i)
+    {
+        if (!IsHole(array[i]))
+            MarkValue(c, array[i]);
+    }
+}
+
+size_t Dictionary::GetExternalBytes() const
+{
+    return ThisSuper::GetExternalBytes() + elements.GetBytes() + array.GetCapacity() * sizeof(Value);
 }
 
 Iterator* Dictionary::Iterate(String* kind)
@@ -58,7 +133,7 @@ Iterator* Dictionary::Iterate(String* kind)
     {
         GCPAUSE_NORUN(engine);
         Iterator* newEnumerator = 0;
-        GCNEW(engine, ObjectIterator, newEnumerator, (engine, engine->Iterator_Type, k, this, &elements));
+        GCNEW(engine, DictionaryIterator, newEnumerator, (engine, engine->Iterator_Type, k, this));
         return newEnumerator;
     }    
     return ThisSuper::Iterate(kind);
@@ -66,14 +141,197 @@ Iterator* Dictionary::Iterate(String* kind)
 
 bool Dictionary::BracketRead(const Value& key, Value& res)
 {    
+    if (InArray(key, array.GetSize()))
+    {
+        Value& v = array[(size_t)key.GetInteger()];
+        if (IsHole(v))
+            return false;
+        res = v;
+        return true;
+    }
     return elements.Get(key, res);
 }
 
 bool Dictionary::BracketWrite(const Value& key, Value& value, u4 attr)
 {
+    if (key.IsCollectible())
+        WriteBarrier(key);
+    if (value.IsCollectible())
+        WriteBarrier(value);
+    
+    GCCHARGE(engine, this);
+    size_t size = array.GetSize();
+    if (key.GetTag() == TAG_integer && key.GetInteger() >= 0)
+    {
+        size_t idx = (size_t)key.GetInteger();
+        if (attr)
+        {
+            // The array part cannot store attributes.
+            if (idx < size)
+                SpillArray();
+        }
+        else if (idx < size)
+        {
+            Value& v = array[idx];
+            if (IsHole(v))
+                ++arrayCount;
+            v = value;
+            return true;
+        }
+        else if (idx == size && !(elements.Count() && elements.Exists(key)))
+        {
+            array.Push(value);
+            ++arrayCount;
+            if (elements.Count())
+                AppendFromHash();
+            return true;
+        }
+        else if (!elements.Exists(key))
+        {
+            elements.Set(key, value, attr);
+            
+            // Check the density whenever the number of integer keys doubles.
+            ++hashIntKeys;
+            if (hashIntKeys >= 4 && !(hashIntKeys & (hashIntKeys - 1)))
+                Rebalance();
+            return true;
+        }
+    }
     return elements.Set(key, value, attr);
 }
 
+Dictionary::ElementIterator::ElementIterator(Dictionary* d) : dict(d), index(0)
+{
+    Seek();
+}
+
+Dictionary::ElementIterator& Dictionary::ElementIterator::operator++()
+{
+    if (index < dict->array.GetSize())
+    {
+        ++index;
+        Seek();
+    }
+    else
+    {
+        ++hash;
+    }
+    return *this;
+}
+
+Value Dictionary::ElementIterator::GetKey() const
+{
+    return index < dict->array.GetSize() ? Value((pint_t)index) : hash.pos->key;
+}
+
+Value& Dictionary::ElementIterator::GetValue()
+{
+    return index < dict->array.GetSize() ? dict->array[index] : hash->val;
+}
+
+void Dictionary::ElementIterator::Seek()
+{
+    while (index < dict->array.GetSize() && IsHole(dict->array[index]))
+        ++index;
+    
+    if (index == dict->array.GetSize())
+        hash = dict->elements.GetIterator();
+}
+
+void Dictionary::SpillArray()
+{
+    for (size_t i = 0; i < array.GetSize(); ++i)
+    {
+        if (!IsHole(array[i]))
+            elements.Set(Value((pint_t)i), array[i]);
+    }
+    hashIntKeys += arrayCount;
+    arrayCount = 0;
+    array.ClearAll();
+}
+
+void Dictionary::AppendFromHash()
+{
+    Value key((pint_t)array.GetSize());
+    Slot* s = 0;
+    while ((s = elements.GetSlot(key)) && !s->attr)
+    {
+        array.Push(s->val);
+        ++arrayCount;
+        elements.Remove(key);
+        if (hashIntKeys)
+            --hashIntKeys;
+        key.Set(key.GetInteger() + 1);
+    }
+}
+
+void Dictionary::Rebalance()
+{
+    // nums[b] is the number of keys k where 2^(b-1) <= k < 2^b, with nums[0] counting the key 0.
+    enum { MAX_BITS = sizeof(size_t) * 8 };
+    size_t nums[MAX_BITS + 1] = { 0 };
+    size_t limit = (size_t)-1; // Keys with attributes must stay in the hash part.
+    size_t found = 0;
+    
+    for (size_t i = 0; i < array.GetSize(); ++i)
+    {
+        if (!IsHole(array[i]))
+            nums[Pika_Log2Ceil(i + 1)]++;
+    }
+    for (Table::Iterator iter = elements.GetIterator(); iter; ++iter)
+    {
+        if (iter->key.GetTag() == TAG_integer && iter->key.GetInteger() >= 0)
+        {
+            size_t k = (size_t)iter->key.GetInteger();
+            if (iter->attr)
+            {
+                limit = Min(limit, k);
+            }
+            else
+            {
+                nums[Pika_Log2Ceil(k + 1)]++;
+            }
+            ++found;
+        }
+    }
+    hashIntKeys = found;
+    
+    // Find the largest power of two that would be more than half full.
+    size_t total = 0;
+    size_t nsize = array.GetSize();
+    for (size_t b = 0; b < MAX_BITS; ++b)
+    {
+        size_t n = (size_t)1 << b;
+        total += nums[b];
+        if (n > limit)
+            break;
+        if (total > n / 2)
+            nsize = Max(nsize, n);
+    }
+    
+    if (nsize <= array.GetSize())
+        return;
+    
+    size_t oldSize = array.GetSize();
+    array.Resize(nsize);
+    for (size_t i = oldSize; i < nsize; ++i)
+    {
+        SetHole(array[i]);
+    }
+    
+    for (size_t i = oldSize; i < nsize && hashIntKeys; ++i)
+    {
+        Value key((pint_t)i);
+        if (elements.Get(key, array[i]))
+        {
+            elements.Remove(key);
+            ++arrayCount;
+            --hashIntKeys;
+        }
+    }
+    AppendFromHash();
+}
+
 // TODO: Dictionary and Array ToString could easily go over String's MAX size allowed.
 String* Dictionary::ToString()
 {
@@ -88,6 +346,25 @@ String* Dictionary::ToString()
     
     // Opening brace {
     String* res = brace_l;
+    size_t remaining = GetLength();
+    
+    for (size_t i = 0; i < array.GetSize(); ++i)
+    {
+        if (IsHole(array[i]))
+            continue;
+        
+        String* str_key = engine->SafeToString(ctx, Value((pint_t)i));
+        String* str_val = engine->SafeToString(ctx, array[i]);
+        
+        res = String::Concat(res, str_key); // key
+        res = String::Concat(res, colon);   // :
+        res = String::Concat(res, str_val); // value
+        
+        if (--remaining)
+        {
+            res = String::Concat(res, comma);
+        }
+    }
     
     for (Table::Iterator i = elements.GetIterator(); i; )
     {
@@ -131,8 +408,13 @@ Dictionary* Dictionary::Create(Engine* eng, Type* type)
 Array* Dictionary::Keys()
 {
     Array* res = Array::Create(engine, engine->Array_Type, 0, 0);
-    res->SetLength(elements.Count());
+    res->SetLength(GetLength());
     size_t index = 0;
+    for (size_t i = 0; i < array.GetSize(); ++i)
+    {
+        if (!IsHole(array[i]))
+            (*res)[index++] = Value((pint_t)i);
+    }
     for (Table::Iterator i = elements.GetIterator(); i; ++i)
     {
         (*res)[index++] = i->key;
@@ -143,8 +425,13 @@ Array* Dictionary::Keys()
 Array* Dictionary::Values()
 {
     Array* res = Array::Create(engine, engine->Array_Type, 0, 0);
-    res->SetLength(elements.Count());
+    res->SetLength(GetLength());
     size_t index = 0;
+    for (size_t i = 0; i < array.GetSize(); ++i)
+    {
+        if (!IsHole(array[i]))
+            (*res)[index++] = array[i];
+    }
     for (Table::Iterator i = elements.GetIterator(); i; ++i)
     {
         (*res)[index++] = i->val;
@@ -154,19 +441,21 @@ Array* Dictionary::Values()
 
 bool Dictionary::HasSlot(const Value& key)
 {
+    if (InArray(key, array.GetSize()))
+        return !IsHole(array[(size_t)key.GetInteger()]);
     return elements.Exists(key);
 }
 
 bool Dictionary::ToBoolean()
 {
-    return elements.Count() != 0;
+    return GetLength() != 0;
 }
 
 namespace {
     int Dictionary_unzip(Context* ctx, Value& self)
     {
         GCPAUSE_NORUN(ctx->GetEngine());
-        Dictionary* dict = (Dictionary*)self.val.object;
+        Dictionary* dict = (Dictionary*)self.GetObject();
         Array* keys = dict->Keys();
         Array* vals = dict->Values();
         if (!keys || !vals)
@@ -181,7 +470,7 @@ namespace {
     int Dictionary_get(Context* ctx, Value& self)
     {
         Engine* engine = ctx->GetEngine();
-        Dictionary* dict = (Dictionary*)self.val.object;
+        Dictionary* dict = (Dictionary*)self.GetObject();
         Value& key = ctx->GetArg(0);
         u2 argc = ctx->GetArgCount();
         Value res(NULL_VALUE);
@@ -203,7 +492,7 @@ namespace {
     int Dictionary_set(Context* ctx, Value& self)
     {
         Engine* engine = ctx->GetEngine();
-        Dictionary* dict = (Dictionary*)self.val.object;
+        Dictionary* dict = (Dictionary*)self.GetObject();
         Value& key = ctx->GetArg(0);
         Value& val = ctx->GetArg(1);
         
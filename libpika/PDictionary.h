@@ -6,6 +6,10 @@
 #define PIKA_DICTIONARY_HEADER
 
 namespace pika {
+    /** An associative array. Non-negative integer keys below GetArraySize() are stored in a 
+      * contiguous array part, every other key is stored in the Table elements. The array part
+      * only grows when more than half of it would be in use.
+      */
     class PIKA_API Dictionary : public Object {
         PIKA_DECL(Dictionary, Object)
     public:
@@ -15,6 +19,8 @@ namespace pika {
         virtual ~Dictionary();
         
         virtual void MarkRefs(Collector* c);
+        virtual size_t GetExternalBytes() const;
+        virtual bool CanFreeInBackground() { return !members && GetClassInfo() == StaticGetClass(); }
         virtual Object* Clone();
         
         virtual bool BracketRead(const Value& key, Value& res);
@@ -29,13 +35,51 @@ namespace pika {
         static Dictionary* Create(Engine* eng, Type* type);
         static void Constructor(Engine* eng, Type* type, Value& res);
         static void StaticInitType(Engine*);
-        size_t GetLength() const { return elements.Count(); }
+        size_t GetLength() const { return elements.Count() + arrayCount; }
         virtual bool ToBoolean();
         
-        Table& Elements() { return elements; }
-        const Table& Elements() const { return elements; }
+        /** Walks every element, the array part in order followed by the hash part.
+          * @note Changing the Dictionary may invalidate the iterator. */
+        class PIKA_API ElementIterator
+        {
+        public:
+            ElementIterator(Dictionary* d);
+            
+            INLINE operator bool()  const { return index < dict->array.GetSize() || hash; }
+            INLINE bool operator!() const { return !(bool)*this; }
+            
+            ElementIterator& operator++();
+            
+            Value  GetKey() const;
+            Value& GetValue();
+        private:
+            void Seek();
+            
+            Dictionary*     dict;
+            size_t          index; //!< Position in the array part.
+            Table::Iterator hash;  //!< Position in the hash part once the array part is done.
+        };
+        
+        INLINE ElementIterator GetElements() { return ElementIterator(this); }
+        
+        INLINE size_t GetArraySize() const { return array.GetSize(); }
     protected:
-        Table elements;
+        friend class DictionaryIterator;
+        
+        /** Moves every element of the array part into elements. */
+        void SpillArray();
+        
+        /** Resizes the array part to the largest power of two that is more than half full and 
+          * moves any integer keys that now fit from the hash part into it. */
+        void Rebalance();
+        
+        /** Moves keys that directly follow the array part from the hash part into it. */
+        void AppendFromHash();
+        
+        Table         elements;    //!< Hash part.
+        Buffer<Value> array;       //!< Array part, element i holds the key i or a hole.
+        size_t        arrayCount;  //!< Number of elements in the array part that are not holes.
+        size_t        hashIntKeys; //!< Approximate number of non-negative integer keys in the hash part.
     };
 }// pika
 #endif
@@ -7,6 +7,8 @@
 #include "PAst.h"
 #include "PParser.h"
 #include "PStringTable.h"
+#include "PProfiler.h"
+#include "PCodeCache.h"
 
 namespace pika {
 namespace  {
@@ -81,6 +83,14 @@ void Engine::RemoveAllHooks()
     }
 }
 
+void Engine::UpdateInstructionHook()
+{
+    for (Context* ctx = active_context; ctx; ctx = ctx->GetPrev())
+    {
+        ctx->UpdateDispatch();
+    }
+}
+
 bool Engine::CallHook(HookEvent he, void* data)
 {
     HookEntry* curr = hooks[he];
@@ -101,6 +111,9 @@ void Engine::AddHook(HookEvent he, hook_t h)
     hook->hook = h;
     hook->next = hooks[he];
     hooks[he] = hook;
+    
+    if (he == HE_instruction)
+        UpdateInstructionHook();
 }
 
 #if defined(PIKA_USE_TABLE_POOL)
@@ -124,20 +137,6 @@ void Engine::DelTable(Table* t)
 
 #endif
 
-#if defined(PIKA_USE_ARRAY_POOL)
-
-void* Engine::ArrayRawAlloc()
-{
-    return Array_Pool.RawAlloc();
-}
-
-void Engine::DelArray(Array* t)
-{
-    Array_Pool.Delete(t);
-}
-
-#endif
-
 bool Engine::RemoveHook(HookEvent he, hook_t h)
 {
     HookEntry** pointerTo = &(hooks[he]);
@@ -151,6 +150,9 @@ bool Engine::RemoveHook(HookEvent he, hook_t h)
             if (h)
                 h->Release(he);                
             Pika_free(current);            
+            
+            if (he == HE_instruction)
+                UpdateInstructionHook();
             return true;
         }
         pointerTo = &(current->next);
@@ -179,19 +181,31 @@ Engine::Engine()
         null_Function(0),
 #if defined(PIKA_USE_TABLE_POOL)
         Table_Pool(TABLE_POOL_SIZE),
-#endif
-#if defined(PIKA_USE_ARRAY_POOL)
-        Array_Pool(ARRAY_POOL_SIZE),
 #endif
         paths(0),
         string_table(0),
+        hash_seed(0),
+        type_epoch(0),
+        optimize_level(PIKA_OPTIMIZE_LEVEL),
         Pkg_World(0), Pkg_Imports(0), Pkg_Types(0),
         active_context(0),
         dbg(0),
+        profiler(0),
         gc(0)
 {
     InitHooks();
-    PIKA_NEW(StringTable, string_table, (this));
+    if (const char* seed = getenv(PIKA_HASH_SEED_ENV))
+        hash_seed = (u8)strtoul(seed, 0, 0);
+    else
+        hash_seed = Pika_RandomSeed();
+    
+    if (const char* level = getenv(PIKA_OPTIMIZE_LEVEL_ENV))
+        SetOptimizeLevel(atoi(level));
+    
+    size_t internLimit = PIKA_STRING_INTERN_LIMIT;
+    if (const char* limit = getenv(PIKA_STRING_INTERN_LIMIT_ENV))
+        internLimit = (size_t)Max<long>(atol(limit), 0);
+    PIKA_NEW(StringTable, string_table, (this, internLimit));
     PIKA_NEW(Collector, gc, (this));
     InitializeWorld();
 }
@@ -200,11 +214,22 @@ Engine::~Engine()
 {
     RemoveAllHooks();
     
+    if (profiler)
+        Pika_delete(profiler);
     Pika_delete(gc);    
     Pika_delete(string_table);
     UnloadAllModules();
 }
 
+Profiler* Engine::GetProfiler()
+{
+    if (!profiler)
+    {
+        PIKA_NEW(Profiler, profiler, (this));
+    }
+    return profiler;
+}
+
 void Engine::Release()
 {
     Pika_delete(this);
@@ -220,7 +245,7 @@ void Engine::UnloadAllModules()
     for (ModuleIterator iter = modules.Begin(); iter != modules.End(); ++iter)
     {
         (*iter)->Shutdown();
-        Pika_delete(*iter);
+        gc_heap.Delete(*iter);
     }
     modules.Clear();
 }
@@ -236,7 +261,7 @@ Package* Engine::OpenPackage(String* name, Package* where, bool overwrite_always
         {
             if (pkgvar.IsDerivedFrom(Package::StaticGetClass()))
             {
-                return pkgvar.val.package;
+                return pkgvar.GetPackage();
             }
             else
             {
@@ -414,7 +439,7 @@ void Engine::ReadExecutePrintLoop()
                                                  entry_def, // Type's body
                                                  script);   // Set the Type the package
                 
-                script->Initialize(literals, context, closure.val.function, 0);
+                script->Initialize(literals, context, closure.GetClosure(), 0);
                 
                 // Make sure we don't get GC sweeped the first time around.
                 gc->ForceToGray(script);
@@ -482,7 +507,7 @@ Script* Engine::Compile(String* name, Context* parent)
     {
         if (pkgDotVar.IsDerivedFrom(Script::StaticGetClass()))
         {
-            return (Script*)pkgDotVar.val.object;
+            return (Script*)pkgDotVar.GetObject();
         }
         else
         {
@@ -504,36 +529,70 @@ Script* Engine::Compile(String* name, Context* parent)
         }
         LiteralPool* literals  = 0;
         
-        // Create the CompileStste and Parser.
-        std::auto_ptr<CompileState> comp_state(new CompileState(this));   
-        std::auto_ptr<Parser>       parser(new Parser(comp_state.get(), &yyin));
+        // Read the source, it is needed to validate the compiled script.
+        Buffer<char> source;
+        yyin.seekg(0, std::ios_base::end);
+        std::streamoff source_len = yyin.tellg();
+        yyin.seekg(0, std::ios_base::beg);
         
-        // Try to compile the script.
-        try
+        if (source_len < 0 || !yyin)
+        {
+            RaiseException(Exception::ERROR_system, "bad file or input stream.");
+        }
+        source.Resize((size_t)source_len);
+        if (source_len && !yyin.read(source.GetAt(0), source_len))
         {
-            Program* tree = parser->DoParse();
-            tree->CalculateResources(0);
+            RaiseException(Exception::ERROR_system, "bad file or input stream.");
+        }
+        yyin.close();
+        
+        // Try to load the compiled script.
+        bool      use_cache = CodeCache::IsEnabled();
+        CodeCache cache(this, name, source.GetAt(0), source.GetSize());
+        
+        if (use_cache)
+        {
+            entry_def = cache.Read(literals);
+        }
+        
+        if (!entry_def)
+        {
+            // Create the CompileStste and Parser.
+            std::auto_ptr<CompileState> comp_state(new CompileState(this));   
+            std::auto_ptr<Parser>       parser(new Parser(comp_state.get(), source.GetAt(0), source.GetSize()));
             
-            if (comp_state->HasErrors())
+            // Try to compile the script.
+            try
+            {
+                Program* tree = parser->DoParse();
+                tree->CalculateResources(0);
+                
+                if (comp_state->HasErrors())
+                {
+                    RaiseException(Exception::ERROR_syntax, "Attempt to compile script %s.\n", name->GetBuffer());
+                }
+                
+                tree->GenerateCode();
+                
+                if (comp_state->HasErrors())
+                {
+                    RaiseException(Exception::ERROR_syntax, "Attempt to generate code for script %s.\n", name->GetBuffer());
+                }
+                
+                literals = comp_state->literals;
+                entry_def = tree->def;
+            }
+            catch (Exception&)
             {
-                RaiseException(Exception::ERROR_syntax, "Attempt to compile script %s.\n", name->GetBuffer());
+                comp_state->SyntaxErrorSummary();            
+                PutImport(str_dot_name, Value(AllocString("invalid")));
+                return 0;
             }
             
-            tree->GenerateCode();
-            
-            if (comp_state->HasErrors())
+            if (use_cache)
             {
-                RaiseException(Exception::ERROR_syntax, "Attempt to generate code for script %s.\n", name->GetBuffer());
+                cache.Write(entry_def, literals);
             }
-            
-            literals = comp_state->literals;
-            entry_def = tree->def;
-        }
-        catch (Exception&)
-        {
-            comp_state->SyntaxErrorSummary();            
-            PutImport(str_dot_name, Value(AllocString("invalid")));
-            return 0;
         }
         
         // Create the Script Object.
@@ -547,7 +606,7 @@ Script* Engine::Compile(String* name, Context* parent)
                                          entry_def, // Type's body
                                          script);   // Set the Type the package
         
-        script->Initialize(literals, context, closure.val.function, name);
+        script->Initialize(literals, context, closure.GetClosure(), name);
         
         // Make sure we don't get GC sweeped the first time around.
         gc->ForceToGray(script);
@@ -675,14 +734,14 @@ void Engine::PersistentString(String* str)
 
 bool Engine::ToBoolean(Context* ctx, const Value& v)
 {
-    switch (v.tag)
+    switch (v.GetTag())
     {
     case TAG_null:        return false;
-    case TAG_boolean:     return v.val.index != 0;
-    case TAG_integer:     return v.val.integer != 0;
-    case TAG_real:        return Pika_RealToBoolean(v.val.real);
+    case TAG_boolean:     return v.GetIndex() != 0;
+    case TAG_integer:     return v.GetInteger() != 0;
+    case TAG_real:        return Pika_RealToBoolean(v.GetReal());
     case TAG_def:         return true;
-    case TAG_string:      return v.val.str->GetLength() != 0;
+    case TAG_string:      return v.GetString()->GetLength() != 0;
     case TAG_property:    return true;    
     case TAG_userdata:    return true;
     case TAG_object:
@@ -690,15 +749,15 @@ bool Engine::ToBoolean(Context* ctx, const Value& v)
         if (ctx)
         {
             Value res;
-            CallConversionFunction(ctx, toBoolean_String, v.val.object, res);
+            CallConversionFunction(ctx, toBoolean_String, v.GetObject(), res);
             
-            if (res.tag != TAG_boolean)
+            if (res.GetTag() != TAG_boolean)
             {
                 RaiseException(Exception::ERROR_runtime, "conversion operator %s failed. For object of type %s.", toBoolean_String->GetBuffer());
             }
-            return res.val.index != 0;
+            return res.GetIndex() != 0;
         }
-        return v.val.index != 0;
+        return v.GetIndex() != 0;
     }
     }
     return false;
@@ -706,23 +765,23 @@ bool Engine::ToBoolean(Context* ctx, const Value& v)
 
 bool Engine::ToInteger(Value& v)
 {
-    switch (v.tag)
+    switch (v.GetTag())
     {
     case TAG_null:    v.Set((pint_t)0);                      return true;
-    case TAG_boolean: v.Set((pint_t)(v.val.index ? 1 : 0));  return true;
+    case TAG_boolean: v.Set((pint_t)(v.GetIndex() ? 1 : 0));  return true;
     case TAG_integer:                                        return true;
-    case TAG_real:    v.Set((pint_t)v.val.real);             return true;
+    case TAG_real:    v.Set((pint_t)v.GetReal());             return true;
     }
     return false;
 }
 
 bool Engine::ToReal(Value& v)
 {
-    switch (v.tag)
+    switch (v.GetTag())
     {
     case TAG_null:    v.Set((preal_t)0.0);                       return true;
-    case TAG_boolean: v.Set((preal_t)(v.val.index ? 1.0 : 0.0)); return true;
-    case TAG_integer: v.Set((preal_t)v.val.integer);             return true;
+    case TAG_boolean: v.Set((preal_t)(v.GetIndex() ? 1.0 : 0.0)); return true;
+    case TAG_integer: v.Set((preal_t)v.GetInteger());             return true;
     case TAG_real:                                               return true;
     }
     return false;
@@ -730,16 +789,16 @@ bool Engine::ToReal(Value& v)
 
 bool Engine::ToIntegerExplicit(Context* ctx, Value& v)
 {
-    switch (v.tag)
+    switch (v.GetTag())
     {
     case TAG_null:    v.Set((pint_t)0);                      return true;
-    case TAG_boolean: v.Set((pint_t)(v.val.index ? 1 : 0));  return true;
+    case TAG_boolean: v.Set((pint_t)(v.GetIndex() ? 1 : 0));  return true;
     case TAG_integer:                                        return true;
-    case TAG_real:    v.Set((pint_t)v.val.real);             return true;
+    case TAG_real:    v.Set((pint_t)v.GetReal());             return true;
     case TAG_string:
     {
         pint_t i;
-        if (v.val.str && v.val.str->ToInteger(i))
+        if (v.GetString() && v.GetString()->ToInteger(i))
         {
             v.Set(i);
             return true;
@@ -749,9 +808,9 @@ bool Engine::ToIntegerExplicit(Context* ctx, Value& v)
     case TAG_object:
     {
         Value res;
-        CallConversionFunction(ctx, toInteger_String, v.val.object, res);
+        CallConversionFunction(ctx, toInteger_String, v.GetObject(), res);
         
-        if (res.tag != TAG_integer)
+        if (res.GetTag() != TAG_integer)
             RaiseException(Exception::ERROR_runtime, "conversion operator %s failed.", toInteger_String->GetBuffer());
         v = res;    
         return true;
@@ -762,16 +821,16 @@ bool Engine::ToIntegerExplicit(Context* ctx, Value& v)
 
 bool Engine::ToRealExplicit(Context* ctx, Value& v)
 {
-    switch (v.tag)
+    switch (v.GetTag())
     {
     case TAG_null:    v.Set((preal_t)0.0);                       return true;
-    case TAG_boolean: v.Set((preal_t)(v.val.index ? 1.0 : 0.0)); return true;
-    case TAG_integer: v.Set((preal_t)v.val.integer);             return true;
+    case TAG_boolean: v.Set((preal_t)(v.GetIndex() ? 1.0 : 0.0)); return true;
+    case TAG_integer: v.Set((preal_t)v.GetInteger());             return true;
     case TAG_real:                                               return true;
     case TAG_string:
     {
         preal_t r;
-        if (v.val.str && v.val.str->ToReal(r))
+        if (v.GetString() && v.GetString()->ToReal(r))
         {
             v.Set(r);
             return true;
@@ -781,9 +840,9 @@ bool Engine::ToRealExplicit(Context* ctx, Value& v)
     case TAG_object:
     {
         Value res;
-        CallConversionFunction(ctx, toReal_String, v.val.object, res);
+        CallConversionFunction(ctx, toReal_String, v.GetObject(), res);
         
-        if (res.tag != TAG_real)
+        if (res.GetTag() != TAG_real)
             RaiseException(Exception::ERROR_runtime, "conversion operator %s failed.", toReal_String->GetBuffer());
             
         return true;
@@ -794,35 +853,35 @@ bool Engine::ToRealExplicit(Context* ctx, Value& v)
 
 String* Engine::ToString(Context* ctx, const Value& v)
 {
-    switch (v.tag)
+    switch (v.GetTag())
     {
     case TAG_null:    return null_String;
-    case TAG_boolean: return v.val.index ? true_String : false_String;
+    case TAG_boolean: return v.GetIndex() ? true_String : false_String;
     case TAG_integer:
     case TAG_real:
     case TAG_index:  return NumberToString(this, v);
     case TAG_gcobj:  return AllocString("<gcobj>");
     case TAG_def:    return AllocString("<def>");
-    case TAG_string: return v.val.str ? v.val.str : emptyString;
+    case TAG_string: return v.GetString() ? v.GetString() : emptyString;
     
-    case TAG_property:   return String::ConcatSep(Property_String, v.val.property->Name(), ':');
+    case TAG_property:   return String::ConcatSep(Property_String, v.GetProperty()->Name(), ':');
     
     case TAG_userdata:
     case TAG_object:
     {
         Value res;
-        CallConversionFunction(ctx, toString_String, v.val.object, res);
-        if (res.tag != TAG_string) {
-            if (v.tag == TAG_userdata) {
-                if (v.val.userdata && v.val.userdata->GetType()) {
-                    return AllocStringFmt("<userdata %s : %p>", v.val.userdata->GetType()->GetName()->GetBuffer());
+        CallConversionFunction(ctx, toString_String, v.GetObject(), res);
+        if (res.GetTag() != TAG_string) {
+            if (v.GetTag() == TAG_userdata) {
+                if (v.GetUserData() && v.GetUserData()->GetType()) {
+                    return AllocStringFmt("<userdata %s : %p>", v.GetUserData()->GetType()->GetName()->GetBuffer());
                 } else {
-                    return AllocStringFmt("<userdata : %p>", v.val.userdata);
+                    return AllocStringFmt("<userdata : %p>", v.GetUserData());
                 }
             }
             RaiseException("Conversion operator %s failed.", toString_String->GetBuffer());
         }    
-        return res.val.str;
+        return res.GetString();
     }
     }
     return emptyString;
@@ -837,14 +896,14 @@ String* Engine::SafeToString(Context* ctx, const Value& el)
     }
     else if (el.IsString())
     {
-        return el.val.str;
+        return el.GetString();
     }
-    else if (el.tag >= TAG_basic)
+    else if (el.GetTag() >= TAG_basic)
     {
         // Same danger with array elements can occur if an basic Object element and this Array have a cyclical references.
         return this->AllocStringFmt("<instance %s : %p>", 
-                                     el.val.basic->GetType()->GetName()->GetBuffer(), 
-                                     el.val.object);
+                                     el.GetBasic()->GetType()->GetName()->GetBuffer(), 
+                                     el.GetObject());
     }
     else
     {
@@ -886,7 +945,7 @@ Type* Engine::GetBaseType(String* name)
     Value key(name);
     Value res(NULL_VALUE);
     Pkg_Types->GetSlot(key, res);
-    return res.val.type;
+    return res.GetType();
 }
 
 void Engine::AddBaseType(String* name, Type* btype)
@@ -903,7 +962,7 @@ Type* Engine::GetTypeFor(ClassInfo* ci)
     Value res(NULL_VALUE);
     
     if (types_table.Get(key, res)) {
-        return res.val.type;
+        return res.GetType();
     }
     return 0;
 }
@@ -1029,7 +1088,8 @@ void Engine::ScanRoots(Collector *c)
     }
 }
 
-void Engine::SweepStringTable() { string_table->Sweep(); }
+
+void Engine::SweepString(String* s) { string_table->Sweep(s); }
 
 void Engine::ChangeContext(Context* t)
 {
@@ -1039,7 +1099,7 @@ void Engine::ChangeContext(Context* t)
 
 Type* Engine::GetTypeOf(Value& v)
 {
-    switch (v.tag)
+    switch (v.GetTag())
     {
     case TAG_null:       return Null_Type;
     case TAG_boolean:    return Boolean_Type;
@@ -1050,8 +1110,8 @@ Type* Engine::GetTypeOf(Value& v)
     case TAG_userdata:
     case TAG_object:
     {
-        ASSERT(v.val.basic);        
-        Basic* obj = v.val.basic;
+        ASSERT(v.GetBasic());        
+        Basic* obj = v.GetBasic();
         Type* objType = obj->GetType();
         return objType;
     }
@@ -1061,7 +1121,7 @@ Type* Engine::GetTypeOf(Value& v)
 
 String* Engine::GetTypenameOf(Value const& v)
 {
-    switch (v.tag)
+    switch (v.GetTag())
     {
     case TAG_null:       return Null_Type->GetName();
     case TAG_boolean:    return Boolean_Type->GetName();
@@ -1071,16 +1131,16 @@ String* Engine::GetTypenameOf(Value const& v)
     case TAG_property:   return Property_Type->GetName();
     case TAG_userdata:
     {
-        ASSERT(v.val.userdata);
-        UserData* ud = v.val.userdata;
+        ASSERT(v.GetUserData());
+        UserData* ud = v.GetUserData();
         if (ud->GetInfo() && ud->GetInfo()->name)
             return AllocString(ud->GetInfo()->name);
         return userdata_String;
     }
     case TAG_object:
     {
-        ASSERT(v.val.object);        
-        Object* obj = v.val.object;
+        ASSERT(v.GetObject());        
+        Object* obj = v.GetObject();
         Type* objType = obj->GetType();
         if (objType)
             return objType->GetName();
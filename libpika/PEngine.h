@@ -22,12 +22,16 @@
 #   include "PObject.h"
 #endif
 
-#if defined(PIKA_USE_TABLE_POOL) || defined(PIKA_USE_ARRAY_POOL)
+#if defined(PIKA_USE_TABLE_POOL)
 #   ifndef PIKA_MEMPOOL_HEADER
 #       include "PMemPool.h"
 #   endif
 #endif
 
+#ifndef PIKA_HEAP_HEADER
+#   include "PHeap.h"
+#endif
+
 namespace pika {
 class Script;
 class Object;
@@ -35,6 +39,7 @@ class String;
 class Context;
 class Engine;
 class Debugger;
+class Profiler;
 class Package;
 class Collector;
 class Module;
@@ -49,9 +54,6 @@ template class PIKA_API Buffer<Value>;
 #   if defined(PIKA_USE_TABLE_POOL)
 template class PIKA_API  MemObjPool<Table>;
 #   endif
-#   if defined(PIKA_USE_ARRAY_POOL)
-template class PIKA_API  MemObjPool<Array>;
-#   endif
 #endif
 
 typedef Buffer<char> TStringBuffer;
@@ -68,6 +70,7 @@ public:
 #ifdef PIKA_BORLANDC
     struct CollectorPause;
     struct CollectorPauseNoRun;
+    struct ExternalCharge;
 #endif
     struct CollectorPause
     {
@@ -100,9 +103,30 @@ public:
         Engine* engine;
     };
     
+    /** Charges the change in obj's external bytes, see GCObject::GetExternalBytes, between 
+      * construction and destruction to the collector. 
+      */
+    struct ExternalCharge
+    {
+        PIKA_FORCE_INLINE ExternalCharge(Engine* eng, GCObject* o) : engine(eng), obj(o), before(o->GetExternalBytes())
+        {
+            ASSERT(engine);
+        }
+        
+        PIKA_FORCE_INLINE ~ExternalCharge()
+        {
+            engine->gc->ChargeExternal(before, obj->GetExternalBytes());
+        }
+    private:
+        Engine*   engine;
+        GCObject* obj;
+        size_t    before;
+    };
+    
 #ifdef PIKA_BORLANDC
     friend CollectorPause;
     friend CollectorPauseNoRun;
+    friend ExternalCharge;
 #endif
     
 protected:
@@ -123,6 +147,10 @@ private:
     
     /** Removes all hook entries. */
     void RemoveAllHooks();
+    
+    /** Switches the active Context, and every Context waiting on it, to the jump table that
+      * matches the current HE_instruction hooks. */
+    void UpdateInstructionHook();
 public:
     /** Determines if a particular HookEvent contains an entry. */
     INLINE bool HasHook(HookEvent ev) const { return hooks[ev] != 0; }
@@ -180,6 +208,29 @@ public:
     INLINE Package*   GetWorld() { return Pkg_World; }
     INLINE Collector* GetGC()    { return gc; }
     
+    /** Seed passed to Pika_StringHash for every String this Engine creates. It is chosen at 
+      * random when the Engine is created unless PIKA_HASH_SEED is set in the environment.
+      */
+    INLINE u8         GetHashSeed() const { return hash_seed; }
+    
+    /** Changes whenever a field is added to, removed from or has its attributes changed in any
+      * Type's members, or a Type's base changes. Member caches compare it on every hit.
+      */
+    INLINE size_t     GetTypeEpoch() const { return type_epoch; }
+    INLINE size_t*    GetTypeEpochPtr()    { return &type_epoch; }
+    
+    /** Optimization level, from 0 to PIKA_MAX_OPTIMIZE_LEVEL, of the code compiled by this Engine. 
+      * See Optimizer for what each level does. The default is PIKA_OPTIMIZE_LEVEL unless 
+      * PIKA_OPTIMIZE is set in the environment. SetOptimizeLevel returns the previous level.
+      */
+    INLINE int GetOptimizeLevel() const { return optimize_level; }
+    INLINE int SetOptimizeLevel(int level)
+    {
+        int old = optimize_level;
+        optimize_level = Clamp<int>(level, 0, PIKA_MAX_OPTIMIZE_LEVEL);
+        return old;
+    }
+    
     INLINE void AddToGC(GCObject* gcobj)      { gc->Add(gcobj); }
     INLINE void AddToGCNoRun(GCObject* gcobj) { gc->AddNoRun(gcobj); }
     INLINE void AddToRoots(GCObject *gcobj)   { gc->AddAsRoot(gcobj); }
@@ -188,6 +239,22 @@ public:
     INLINE void ResumeGC()      { gc->Resume(); }
     INLINE void ResumeGCNoRun() { gc->ResumeNoRun(); }
     
+    /** Garbage collector tuning, see Collector::SetPause, Collector::SetStepMul, 
+      * Collector::SetMaxPause, Collector::SetMarkThreads and Collector::SetBackgroundSweep. Each 
+      * returns the previous value.
+      */
+    INLINE size_t SetGCPause(size_t pct)       { return gc->SetPause(pct); }
+    INLINE size_t SetGCStepMul(size_t pct)     { return gc->SetStepMul(pct); }
+    INLINE size_t SetGCMaxPause(size_t usecs)  { return gc->SetMaxPause(usecs); }
+    INLINE size_t SetGCMarkThreads(size_t n)   { return gc->SetMarkThreads(n); }
+    INLINE bool   SetGCBackgroundSweep(bool on) { return gc->SetBackgroundSweep(on); }
+    
+    INLINE void StopGC()    { gc->Stop(); }    //!< Stops automatic collection.
+    INLINE void RestartGC() { gc->Restart(); } //!< Restarts automatic collection.
+    
+    /** Finishes the current collection cycle or performs a complete one. */
+    INLINE void CollectGarbage() { gc->FullRun(); }
+    
     void AddModule(Module* so);
     
     /** Open of a package from the given dot-path.
@@ -239,11 +306,17 @@ public:
         
     void CreateRoots();
     void ScanRoots(Collector* c);
-    void SweepStringTable();
+    void SweepString(String*);
     
     Debugger* GetDebugger()            { return dbg; }
     Debugger* SetDebugger(Debugger* d) { Debugger* old = dbg; dbg = d; return old; }
     
+    /** Returns the engine's sampling Profiler, creating it on first use. */
+    Profiler* GetProfiler();
+    
+    /** Returns the Profiler if it exists, otherwise null. */
+    INLINE Profiler* GetProfilerSafe() const { return profiler; }
+    
     INLINE Context* GetActiveContext()     const { return active_context; }
     INLINE Context* GetActiveContextSafe() const
     {
@@ -352,13 +425,10 @@ public:
 private:
     MemObjPool<Table> Table_Pool;
 #endif
-#if defined(PIKA_USE_ARRAY_POOL)
 public:
-    void*   ArrayRawAlloc();
-    void    DelArray(Array*);
+    INLINE Heap* GetHeap() { return &gc_heap; } //!< Heap that GCObjects are allocated from.
 private:
-    MemObjPool<Array> Array_Pool;
-#endif
+    Heap gc_heap;
 public:
     Type*           GetTypeFor(ClassInfo*);
     void            SetTypeFor(ClassInfo*, Type*);
@@ -367,11 +437,15 @@ private:
     PathManager*    paths;          //!< Paths used for importing
     String*         override_strings[NUM_OVERRIDES]; //!<
     StringTable*    string_table;   //!< String table
+    u8              hash_seed;      //!< Seed for String hash codes
+    size_t          type_epoch;     //!< See GetTypeEpoch.
+    int             optimize_level; //!< Optimization level of the compiler.
     Package*        Pkg_World;      //!< Parent Package of all Packages
     Package*        Pkg_Imports;    //!< Package containing base types
     Package*        Pkg_Types;      //!< Package containing 
     Context*        active_context; //!< The current active Context
     Debugger*       dbg;            //!< The Debugger
+    Profiler*       profiler;       //!< The sampling Profiler, created on demand.
     Collector*      gc;             //!< The Garbage Collector
     Buffer<Module*> modules;        //!< All The Modules imported
     Buffer<Script*> scripts;        //!< All The Scripts imported
@@ -382,6 +456,7 @@ private:
 
 #define GCPAUSE(eng)       Engine::CollectorPause       pauser(eng)
 #define GCPAUSE_NORUN(eng) Engine::CollectorPauseNoRun  pauser(eng)
+#define GCCHARGE(eng, obj) Engine::ExternalCharge       charger(eng, obj)
 
 
 #endif
@@ -319,8 +319,7 @@ bool File::Write(Context* ctx)
 File* File::Create(Engine* eng, Type* obj_type)
 {
     File* f;
-    PIKA_NEW(File, f, (eng, obj_type));
-    eng->AddToGC(f);
+    GCNEW(eng, File, f, (eng, obj_type));
     return f;
 }
 
@@ -71,12 +71,15 @@ void LexicalEnv::Deallocate()
     values = 0;
 }
 
-void LexicalEnv::EndCall()
+void LexicalEnv::EndCall(Collector* c)
 {
     if (mustClose)
     {
         ASSERT(!IsAllocated());
         Allocate();
+        
+        // The copied variables are new references so rescan this object.
+        c->MoveToGray(this);
     }
     else
     {
@@ -87,16 +90,14 @@ void LexicalEnv::EndCall()
 LexicalEnv* LexicalEnv::Create(Engine* eng, bool close)
 {
     LexicalEnv* ov;
-    PIKA_NEW(LexicalEnv, ov, (close));
-    eng->AddToGC(ov);
+    GCNEW(eng, LexicalEnv, ov, (close));
     return ov;
 }
 
 LexicalEnv* LexicalEnv::Create(Engine* eng, LexicalEnv* lex)
 {
     LexicalEnv* env=0;
-    PIKA_NEW(LexicalEnv, env, (lex));
-    eng->AddToGC(env);
+    GCNEW(eng, LexicalEnv, env, (lex));
     return env;
 }
 
@@ -152,8 +153,7 @@ Function::Function(const Function* rhs) : ThisSuper(rhs),
 Function* Function::Create(Engine* eng, Def* def, Package* loc, Function* parent)
 {
     Function* cl = 0;
-    PIKA_NEW(Function, cl, (eng, eng->Function_Type, def, loc ? loc : eng->GetWorld(), parent, 0));
-    eng->AddToGC(cl);
+    GCNEW(eng, Function, cl, (eng, eng->Function_Type, def, loc ? loc : eng->GetWorld(), parent, 0));
     return cl;
 }
 
@@ -520,8 +520,7 @@ BoundFunction::~BoundFunction() {}
 BoundFunction* BoundFunction::Create(Engine* eng, Type* type, Function* c, Value& bound)
 {
     BoundFunction* b = 0;
-    PIKA_NEW(BoundFunction, b, (eng, type ? type : eng->BoundFunction_Type, c, bound));
-    eng->AddToGC(b);
+    GCNEW(eng, BoundFunction, b, (eng, type ? type : eng->BoundFunction_Type, c, bound));
     return b;
 }
 
@@ -709,6 +708,26 @@ int Function_printLiterals(Context* ctx, Value& self)
     return 0;
 }
 
+int Function_printMemberCaches(Context* ctx, Value& self)
+{
+    GETSELF(Function, f, "Function");
+    Def* def = f->GetDef();
+    GCPAUSE(f->GetEngine());
+    if (def)
+    {
+        for (size_t i = 0; i < def->GetMemberCacheCount(); ++i)
+        {
+            MemberCache* mc = def->FindMemberCache((u2)i);
+            if (!mc)
+                continue;
+            String* s = f->GetEngine()->ToString(ctx, def->literals->Get(i));
+            printf("%-24s types: %u hits: %u misses: %u megamorphic: %u\n", 
+                   s->GetBuffer(), mc->count, mc->hits, mc->misses, mc->megamorphic);
+        }
+    }
+    return 0;
+}
+
 /* A native, do nothing function. */
 int null_Function(Context*, Value&) { return 0; }
 
@@ -727,13 +746,13 @@ int Function_name(Context* ctx, Value& self)
     // we do this.
     if (self.IsDerivedFrom(Function::StaticGetClass()))
     {
-        Function* fn = (Function*)self.val.object;
+        Function* fn = (Function*)self.GetObject();
         ctx->Push(fn->GetName());
         return 1;        
     }
     else if (self.IsDerivedFrom(Type::StaticGetClass()))
     {
-        Type* t = (Type*)self.val.object;
+        Type* t = (Type*)self.GetObject();
         ctx->Push(t->GetName());   
         return 1;
     }    
@@ -745,13 +764,13 @@ int Function_parent(Context* ctx, Value& self)
 {
     if (self.IsDerivedFrom(Function::StaticGetClass()))
     {
-        Function* fn = (Function*)self.val.object;
+        Function* fn = (Function*)self.GetObject();
         ctx->Push(fn->GetParent());
         return 1;        
     }
     else if (self.IsDerivedFrom(Type::StaticGetClass()))
     {
-        Type* t = (Type*)self.val.object;
+        Type* t = (Type*)self.GetObject();
         ctx->Push(t->GetSuper());   
         return 1;
     }    
@@ -763,13 +782,13 @@ int Function_location(Context* ctx, Value& self)
 {
     if (self.IsDerivedFrom(Function::StaticGetClass()))
     {
-        Function* fn = (Function*)self.val.object;
+        Function* fn = (Function*)self.GetObject();
         ctx->Push(fn->GetLocation());
         return 1;        
     }
     else if (self.IsDerivedFrom(Type::StaticGetClass()))
     {
-        Type* t = (Type*)self.val.object;
+        Type* t = (Type*)self.GetObject();
         ctx->Push(t->GetLocation());   
         return 1;
     }    
@@ -878,6 +897,7 @@ void Function::StaticInitType(Engine* eng)
     .RegisterMethod(Function_setLocal,      "setLocal")    
     .RegisterMethod(Function_getLocalCount, "getLocalCount")
     .RegisterMethod(Function_printLiterals, "printLiterals")
+    .RegisterMethod(Function_printMemberCaches, "printMemberCaches")
     .RegisterClassMethod(Function_printBytecode,    "printBytecode")
     .Constant((pint_t)PIKA_MAX_RETC,             "MAX_RET_COUNT")
     .Constant((pint_t)PIKA_MAX_NESTED_FUNCTIONS, "MAX_FUNCTION_DEPTH")
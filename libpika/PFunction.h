@@ -28,6 +28,8 @@ public:
     virtual ~LexicalEnv();
     
     virtual void MarkRefs(Collector* c);
+    virtual const char* GetGCName() const { return "LexicalEnv"; }
+    virtual bool CanFreeInBackground() { return true; }
     
     INLINE void Set(Value* v, size_t l)
     {
@@ -37,7 +39,8 @@ public:
         length = l;
     }
     
-    void EndCall();
+    /** Copies the local variables off of the Context's stack if they must survive the call. */
+    void EndCall(Collector* c);
     
     INLINE bool IsValid()     const { return values != 0; }
     INLINE bool IsAllocated() const { return allocated;   }
@@ -73,6 +76,8 @@ public:
     virtual ~Defaults();
     
     virtual void MarkRefs(Collector* c);
+    virtual const char* GetGCName() const { return "Defaults"; }
+    virtual bool CanFreeInBackground() { return true; }
     
     INLINE size_t Length() const { return length; }
     
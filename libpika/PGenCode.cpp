@@ -88,13 +88,9 @@ void HandleBlockBreaks(CompileState* state, Instr*  start, Instr*  end, Opcode
     }
 }
 
-// TODO: overload operator new for Instr
-// TODO: use an auto pointer so we do not have to have try-catch blocks.
-// TODO: make sure all Instr instances are released with operator delete.
-
 void CompileFunction(int line, CompileState* state, Stmt* body, Def* def)
 {
-    Instr* ibody = 0;
+    size_t loopJumps = state->loopJumps.GetSize();
     try
     {
         Def* old = state->currDef;
@@ -103,13 +99,16 @@ void CompileFunction(int line, CompileState* state, Stmt* body, Def* def)
         Instr* iretnull = state->CreateOp(OP_retacc);
         PIKA_BLOCKSTART(state, iretnull);
         
-        ibody = body->GenerateCode();
+        InstrList ibody = body->GenerateCode();
         
         PIKA_BLOCKEND(state);
         
+        // Any break or continue left is outside of a loop and will be reported by the Compiler.
+        state->loopJumps.Resize(loopJumps);
+        
         // Add an explicit return.
         
-        ibody->Attach(iretnull);
+        ibody.Append(iretnull);
         
         // Compile the function body.
         
@@ -120,7 +119,7 @@ void CompileFunction(int line, CompileState* state, Stmt* body, Def* def)
         
         for (size_t i = 0; i < def->numArgs; ++i)
         {
-            def->SetLocalRange(i, 0, iretnull->pos);
+            def->SetLocalRange(i, 0, cc.GetBytecodeLength());
         }
         
         int maxstack = cc.GetStackLimit();
@@ -131,7 +130,7 @@ void CompileFunction(int line, CompileState* state, Stmt* body, Def* def)
         
         // Calculate debug line information.
         
-        Instr* last = ibody;
+        Instr* last = cc.GetCode().head;
         code_t* byte_code_start = def->GetBytecode();
         u2 currline = 0;
         
@@ -152,18 +151,11 @@ void CompileFunction(int line, CompileState* state, Stmt* body, Def* def)
             last = last->next;
         }
         
-        // Cleanup.
-        
-        //Pika_delete(ibody);
-        ibody = 0;
         state->currDef = old;
     }
     catch(...) 
     {
-        // Cleanup in case of exception.
-       // if (ibody)
-         //   Pika_delete(ibody);
-        ibody = 0;
+        state->loopJumps.Resize(loopJumps);
         throw; // re-throw the exception.
     }
 }
@@ -172,7 +164,7 @@ void CompileFunction(int line, CompileState* state, Stmt* body, Def* def)
  * certain boolean value. This is used for both the "and" and "or" boolean
  * operators.
  */
-Instr* GenerateShortCircuitOp(CompileState* state, Expr* exprA, Expr* exprB, bool isand)
+InstrList GenerateShortCircuitOp(CompileState* state, Expr* exprA, Expr* exprB, bool isand)
 {
     if (exprA->kind == Expr::EXPR_load)
     {
@@ -183,19 +175,19 @@ Instr* GenerateShortCircuitOp(CompileState* state, Expr* exprA, Expr* exprB, boo
         if (!isand && (lkind == LoadExpr::LK_true))
             return exprA->GenerateCode();
     }
-    Instr* ia    = exprA->GenerateCode();
-    Instr* ib    = exprB->GenerateCode();
+    InstrList ia = exprA->GenerateCode();
+    InstrList ib = exprB->GenerateCode();
     Instr* idup  = state->CreateOp(OP_dup);
     Instr* icond = state->CreateOp(isand ? OP_jumpiffalse : OP_jumpiftrue);
     Instr* itgt  = state->CreateOp(JMP_TARGET);
     Instr* ipop  = state->CreateOp(OP_pop);
     
-    ia->
-    Attach(idup)->
-    Attach(icond)->
-    Attach(ipop)->
-    Attach(ib)->
-    Attach(itgt);
+    ia.
+    Append(idup).
+    Append(icond).
+    Append(ipop).
+    Append(ib).
+    Append(itgt);
     
     icond->SetTarget(itgt);
     
@@ -292,25 +284,25 @@ void ErrorYieldInFinally(CompileState* state, Instr* start, Instr* end, int line
 
 }// anonymous namespace
 
-Instr* TreeNode::GenerateCode()
+InstrList TreeNode::GenerateCode()
 {
     SHOULD_NEVER_HAPPEN();
-    return 0;
+    return InstrList();
 }
 
-Instr* EmptyStmt::DoStmtCodeGen()
+InstrList EmptyStmt::DoStmtCodeGen()
 {
     Instr* inop = state->CreateOp(OP_nop);
     return inop;
 }
 
-Instr* EmptyExpr::GenerateCode()
+InstrList EmptyExpr::GenerateCode()
 {
     Instr* inop = state->CreateOp(OP_nop);
     return inop;
 }
 
-Instr* Program::GenerateCode()
+InstrList Program::GenerateCode()
 {
     CompileFunction(line, state, stmts, def);
     
@@ -318,25 +310,25 @@ Instr* Program::GenerateCode()
     {
         def->SetSource(state->engine, GetSourceOf(state) + scriptBeg, scriptEnd - scriptBeg);
     }
-    return 0;
+    return InstrList();
 }
 
-Instr* NamedTarget::GenerateCodeSet()
+InstrList NamedTarget::GenerateCodeSet()
 {
     return name->GenerateCodeSet();
 }
 
-Instr* AnnotationDecl::GenerateCode()
+InstrList AnnotationDecl::GenerateCode()
 {
     SHOULD_NEVER_HAPPEN();
-    return 0;   
+    return InstrList();   
 }
 
-Instr* AnnotationDecl::GenerateCodeWith(Instr* subj)
+InstrList AnnotationDecl::GenerateCodeWith(InstrList subj)
 {
-    Instr* iname = name->GenerateCode();    
-    Instr* iargs = next ? next->GenerateCodeWith(subj) : subj;
-    Instr* iself = state->CreateOp(OP_pushnull);
+    InstrList iname = name->GenerateCode();    
+    InstrList iargs = next ? next->GenerateCodeWith(subj) : subj;
+    Instr*    iself = state->CreateOp(OP_pushnull);
     // TODO: Check argc and keyword argc < MAX_ARG_COUNT
     
     // Start at 1 since we *always* have 1 extra argument, either the next annotation or the declaration.
@@ -350,8 +342,8 @@ Instr* AnnotationDecl::GenerateCodeWith(Instr* subj)
             ++kwargc;
         else
             ++argc;
-        Instr* icurr_arg = expr->GenerateCode();        
-        iargs->Attach(icurr_arg);
+        InstrList icurr_arg = expr->GenerateCode();        
+        iargs.Append(icurr_arg);
         curr_arg = curr_arg->next;
     }
     
@@ -361,30 +353,30 @@ Instr* AnnotationDecl::GenerateCodeWith(Instr* subj)
     icall->operandu2 = 1;
        
     
-    iargs->
-    Attach(iself)->
-    Attach(iname)->
-    Attach(icall);
+    iargs.
+    Append(iself).
+    Append(iname).
+    Append(icall);
     
     return iargs;
 }
 
-Instr* FunctionDecl::GenerateCode()
+InstrList FunctionDecl::GenerateCode()
 {
-    Instr* fun = GenerateFunctionCode();
+    InstrList fun = GenerateFunctionCode();
     
-    Instr* annotations = GenerateAnnotationCode(fun);
-    Instr* set = NamedTarget::GenerateCodeSet();
+    InstrList annotations = GenerateAnnotationCode(fun);
+    InstrList set = NamedTarget::GenerateCodeSet();
     
-    annotations->
-    Attach(set);
+    annotations.
+    Append(set);
     return annotations;
 }
 
-Instr* FunctionDecl::GenerateFunctionCode()
+InstrList FunctionDecl::GenerateFunctionCode()
 {
-    Instr* iinst = 0;
-    Instr* idefs = 0;
+    InstrList iinst;
+    InstrList idefs;
     
     ParamDecl* arg = args;
     u2 numdefs = 0;
@@ -393,31 +385,29 @@ Instr* FunctionDecl::GenerateFunctionCode()
     {
         if (arg->val)
         {
-            if (!idefs)
-                idefs = arg->val->GenerateCode();
-            else
-                idefs->Attach(arg->val->GenerateCode());
+            idefs.Append(arg->val->GenerateCode());
             ++numdefs;
         }
         arg = arg->next;
     }
     
     // push the function
-    Instr* ifun = state->CreateOp(OP_pushliteral);
-    ifun->operand = index;
+    Instr* ipushfun = state->CreateOp(OP_pushliteral);
+    ipushfun->operand = index;
     
-    iinst = state->CreateOp(OP_method);
-    iinst->operand = numdefs;
+    Instr* imethod = state->CreateOp(OP_method);
+    imethod->operand = numdefs;
     
     // Generate the self object if its a dot expr
     bool isdotexpr = name->dotexpr ? true : false;
+    InstrList ifun;
     
     if (isdotexpr)
     {
-        Instr* iprep = name->dotexpr->left->GenerateCode(); // self
+        InstrList iprep = name->dotexpr->left->GenerateCode(); // self
         Instr* idup = state->CreateOp(OP_dup);
-        iprep->Attach(idup);
-        iprep->Attach(ifun);
+        iprep.Append(idup);
+        iprep.Append(ipushfun);
         
         ifun = iprep;
     }
@@ -425,20 +415,13 @@ Instr* FunctionDecl::GenerateFunctionCode()
     {
         Instr* ipushnull = state->CreateOp(OP_pushnull);
         
-        ipushnull->Attach(ifun);
-        ifun = ipushnull;
+        ifun.Append(ipushnull).Append(ipushfun);
     }
     
-    if (idefs)
-    {
-        idefs->Attach(iinst);
-        iinst = idefs;
-    }
-        
+    iinst = idefs.Append(imethod);
     
-    
-    ifun->
-    Attach(iinst)
+    ifun.
+    Append(iinst)
     ;
     try
     {
@@ -462,7 +445,6 @@ Instr* FunctionDecl::GenerateFunctionCode()
         else
         {
             // rethrow
-            //Pika_delete(ifun);
             throw;
         }
     }
@@ -470,14 +452,14 @@ Instr* FunctionDecl::GenerateFunctionCode()
     return ifun;
 }
 
-Instr* VarDecl::GenerateCode()
+InstrList VarDecl::GenerateCode()
 {
     return state->CreateOp(OP_nop);
 }
 
-Instr* LocalDecl::GenerateCode()
+InstrList LocalDecl::GenerateCode()
 {
-    Instr* irep = 0;
+    InstrList irep;
     
     if (!newLocal || !name)
     {
@@ -494,70 +476,71 @@ Instr* LocalDecl::GenerateCode()
         iset->operandu1 = 1;
         iset->target    = state->endOfBlock;
         
-        ipushnull->Attach(iset);
-        irep = ipushnull;
+        irep.Append(ipushnull).Append(iset);
     }
     
     if (next)
     {
-        Instr* inext = next->GenerateCode();
-        irep->Attach(inext);
+        InstrList inext = next->GenerateCode();
+        irep.Append(inext);
     }
     return irep;
 }
 
-Instr* HijackExpr::GenerateCode()
+InstrList HijackExpr::GenerateCode()
 {
-    Instr* ileft = left->GenerateCode();
-    Instr* icall = right->GenerateCodeWith(ileft);
+    InstrList ileft = left->GenerateCode();
+    InstrList icall = right->GenerateCodeWith(&ileft);
     return icall;
 }
 
-Instr* CallExpr::GenerateCode()
+InstrList CallExpr::GenerateCode()
 {
     return GenerateCodeWith(0);
 }
 
-Instr* CallExpr::GenerateCodeWith(Instr* hijack)
+InstrList CallExpr::GenerateCodeWith(InstrList* hijack)
 {
     Expr::Kind k = left->kind;
-    Instr* ilvalue = 0;
-    Instr* iargs = state->CreateOp(OP_nop);
+    InstrList ilvalue;
+    InstrList iargs = state->CreateOp(OP_nop);
     
     if (!hijack && k == Expr::EXPR_dot)
     {
         DotExpr* de = static_cast<DotExpr*>(left);
         Instr* idup = state->CreateOp(OP_dup); // duplicate 'self'
         Instr* idotget = state->CreateOp(de->GetOpcode());
-        Instr* dotleft = de->left->GenerateCode();
-        Instr* dotright = de->right->GenerateCode();
+        InstrList dotleft = de->left->GenerateCode();
+        InstrList dotright = de->right->GenerateCode();
         
         if (redirectedcall)
         {
             Instr* ipushthis = state->CreateOp(OP_pushself);
-            ipushthis->
-            Attach(dotleft)->
-            Attach(dotright)->
-            Attach(idotget)
+            ilvalue.
+            Append(ipushthis).
+            Append(dotleft).
+            Append(dotright).
+            Append(idotget)
             ;
-            ilvalue = ipushthis;
         }
         else
         {
-            dotleft->
-            Attach(idup)->
-            Attach(dotright)->
-            Attach(idotget)
+            dotleft.
+            Append(idup).
+            Append(dotright).
+            Append(idotget)
             ;
             ilvalue = dotleft;
         }
     }
     else
     {
-        ilvalue = left->GenerateCode();
-        Instr* ipushthis = hijack ? hijack : state->CreateOp(redirectedcall ? OP_pushself : OP_pushnull);        
-        ipushthis->Attach(ilvalue);
-        ilvalue = ipushthis;
+        InstrList icallee = left->GenerateCode();
+        if (hijack)
+            ilvalue = *hijack;
+        else
+            ilvalue = state->CreateOp(redirectedcall ? OP_pushself : OP_pushnull);
+        ilvalue.Append(icallee);
     }
     
     ExprList* curr = args;
@@ -570,9 +553,9 @@ Instr* CallExpr::GenerateCodeWith(Instr* hijack)
             break;
     
         Expr* expr = curr->expr;
-        Instr* iexpr = expr->GenerateCode();
+        InstrList iexpr = expr->GenerateCode();
         
-        iargs->Attach(iexpr);                
+        iargs.Append(iexpr);                
         curr = curr->next;
     }
         
@@ -582,9 +565,9 @@ Instr* CallExpr::GenerateCodeWith(Instr* hijack)
             curr->expr->kind == Expr::EXPR_apply_kw)
             break;
         Expr* expr = curr->expr;
-        Instr* iexpr = expr->GenerateCode();
+        InstrList iexpr = expr->GenerateCode();
         
-        iargs->Attach(iexpr);                
+        iargs.Append(iexpr);                
         curr = curr->next;
     }
     
@@ -593,23 +576,23 @@ Instr* CallExpr::GenerateCodeWith(Instr* hijack)
         ASSERT(curr);
         
         if (curr->expr->kind == Expr::EXPR_apply_va) {
-            Instr* iapply = curr->expr->GenerateCode();
-            iargs->Attach(iapply);
+            InstrList iapply = curr->expr->GenerateCode();
+            iargs.Append(iapply);
             has_va = true;
             curr = curr->next;
         }
         
         if (curr && curr->expr->kind == Expr::EXPR_apply_kw) {
             Instr* ipushnull = state->CreateOp(has_va ? OP_nop : OP_pushnull);
-            Instr* iapply = curr->expr->GenerateCode();
-            iargs->
-            Attach(ipushnull)->
-            Attach(iapply)
+            InstrList iapply = curr->expr->GenerateCode();
+            iargs.
+            Append(ipushnull).
+            Append(iapply)
             ;
             curr = curr->next;
         } else {
             Instr* ipushnull = state->CreateOp(OP_pushnull);
-            iargs->Attach(ipushnull);
+            iargs.Append(ipushnull);
         }
         
         ASSERT(!curr);
@@ -619,18 +602,14 @@ Instr* CallExpr::GenerateCodeWith(Instr* hijack)
     icall->operand   = argc;
     icall->operandu1 = static_cast<u1>(kwargc);
     icall->operandu2 = retc ? retc : 1;
-    if (iargs)
-    {
-        iargs->Attach(ilvalue);
-        ilvalue->Attach(icall);
-        return iargs;
-    }
     
-    ilvalue->Attach(icall);
-    return ilvalue;
+    iargs.
+    Append(ilvalue).
+    Append(icall);
+    return iargs;
 }
 
-Instr* BinaryExpr::GenerateCode()
+InstrList BinaryExpr::GenerateCode()
 {
     if (kind == EXPR_and)
     {
@@ -644,21 +623,21 @@ Instr* BinaryExpr::GenerateCode()
     {
         Opcode op = GetOpcode();
         Instr* iop = state->CreateOp(op);
-        Instr* ileft = left->GenerateCode();
-        Instr* iright = right->GenerateCode();
+        InstrList ileft = left->GenerateCode();
+        InstrList iright = right->GenerateCode();
         
-        ileft->Attach(iright);
-        iright->Attach(iop);
+        ileft.Append(iright);
+        ileft.Append(iop);
         
         return ileft;
     }
 }
 
-Instr* UnaryExpr::GenerateCode()
+InstrList UnaryExpr::GenerateCode()
 {
-    Opcode op    = GetOpcode();
-    Instr* iexpr = expr->GenerateCode();
-    Instr* iop   = state->CreateOp(op);
+    Opcode    op    = GetOpcode();
+    InstrList iexpr = expr->GenerateCode();
+    Instr*    iop   = state->CreateOp(op);
     
     if (kind == EXPR_preincr || kind == EXPR_postincr || 
         kind == EXPR_predecr || kind == EXPR_postdecr)
@@ -670,28 +649,28 @@ Instr* UnaryExpr::GenerateCode()
         if (kind == EXPR_preincr || kind == EXPR_predecr)
         {
             // prefix
-            iexpr->Attach(iop)->Attach(idup);
+            iexpr.Append(iop).Append(idup);
         }
         else
         {
             // postfix
-            iexpr->Attach(idup)->Attach(iop);
+            iexpr.Append(idup).Append(iop);
         }
         
         if (k == EXPR_dot)
         {
             DotExpr *leftdot = (DotExpr*)exprres;
-            Instr* dotset = leftdot->GenerateCodeSet();
+            InstrList dotset = leftdot->GenerateCodeSet();
             
-            iexpr->Attach(dotset);
+            iexpr.Append(dotset);
             return iexpr;
         }
         else if (k == EXPR_identifier)
         {
             IdExpr *idexpr = (IdExpr *)exprres;
-            Instr* setleft = idexpr->GenerateCodeSet();
+            InstrList setleft = idexpr->GenerateCodeSet();
             
-            iexpr->Attach(setleft);
+            iexpr.Append(setleft);
             return iexpr;
         }
         else
@@ -700,11 +679,11 @@ Instr* UnaryExpr::GenerateCode()
         }
     }
     
-    iexpr->Attach(iop);
+    iexpr.Append(iop);
     return iexpr;
 }
 
-Instr* IdExpr::GenerateCode()
+InstrList IdExpr::GenerateCode()
 {
     Opcode oc = OP_nop;
     Instr* irep = 0;
@@ -754,7 +733,7 @@ Instr* IdExpr::GenerateCode()
     return irep;
 }
 
-Instr* IdExpr::GenerateCodeSet()
+InstrList IdExpr::GenerateCodeSet()
 {
     Opcode oc = OP_nop;
     Instr* irep = 0;
@@ -795,7 +774,7 @@ Instr* IdExpr::GenerateCodeSet()
         oc = OP_setglobal;
     }
     
-    PIKA_NEW(Instr, irep, (oc));
+    irep = state->CreateOp(oc);
     
     irep->operand = index;
     irep->operandu1 = depthindex;
@@ -808,7 +787,7 @@ Instr* IdExpr::GenerateCodeSet()
     return irep;
 }
 
-Instr* ConstantExpr::GenerateCode()
+InstrList ConstantExpr::GenerateCode()
 {
     Instr* iloadc = state->CreateOp(OP_pushliteral);
     
@@ -820,18 +799,18 @@ Instr* ConstantExpr::GenerateCode()
     return iloadc;
 }
 
-Instr* Stmt::GenerateCode()
+InstrList Stmt::GenerateCode()
 {
-    Instr* ir = DoStmtCodeGen();
+    InstrList ir = DoStmtCodeGen();
     
-    if (newline && ir)
+    if (newline && ir.head)
     {
-        ir->line = line;
+        ir.head->line = line;
     }
     return ir;
 }
 
-Instr* TryStmt::DoStmtCodeGen()
+InstrList TryStmt::DoStmtCodeGen()
 {
     /*      [ OP_pushtry    ]
      *      [ try block     ]
@@ -848,21 +827,21 @@ Instr* TryStmt::DoStmtCodeGen()
     Instr* ijmptarget = state->CreateOp(JMP_TARGET);
     Instr* ijmptarget2 = state->CreateOp(JMP_TARGET);
     PIKA_BLOCKSTART(state, ifinishtry);
-    Instr* itry = tryBlock->GenerateCode();
+    InstrList itry = tryBlock->GenerateCode();
     PIKA_BLOCKEND(state);
-    Instr* ielse = elseblock ? elseblock->GenerateCode() : state->CreateOp(OP_nop);
-    ipushtry->
-    Attach(itry)->
-    Attach(ipoptry)->
-    Attach(ielse)->
-    Attach(ifinishtry);
+    InstrList ielse = elseblock ? elseblock->GenerateCode() : state->CreateOp(OP_nop);
+    InstrList code = ipushtry;
+    code.
+    Append(itry).
+    Append(ipoptry).
+    Append(ielse).
+    Append(ifinishtry);
     
     ifinishtry->SetTarget(ijmptarget2);
     
     ipushtry->operand = 0;
     ipoptry->operand  = 0;
     bool settarget    = false;
-    Instr* icurr      = ipoptry;
     Instr* prevtarget = 0;
     
     // catch ex is type
@@ -881,8 +860,8 @@ Instr* TryStmt::DoStmtCodeGen()
             Instr* ijump       = state->CreateOp(OP_jump);
             Instr* ijumpf      = state->CreateOp(OP_jumpiffalse);
             Instr* iopis       = state->CreateOp(OP_is);
-            Instr* icatch      = curr->block->GenerateCode();
-            Instr* iis         = curr->isexpr->GenerateCode();
+            InstrList icatch   = curr->block->GenerateCode();
+            InstrList iis      = curr->isexpr->GenerateCode();
             Instr* iassign     = state->CreateOp(OP_setlocal); // set catch var
             iassign->operandu1 = 1;
             iassign->target    = ijmptarget;
@@ -892,16 +871,16 @@ Instr* TryStmt::DoStmtCodeGen()
             
             iassign->operand = curr->symbol->offset;
             
-            icurr->
-            Attach(idup)->
-            Attach(iis)->
-            Attach(iopis)->
-            Attach(ijumpf)->
-            Attach(iassign)->
-            Attach(icatch)->
-            Attach(ijump)->
-            Attach(ireraise)->
-            Attach(icatchtarget)
+            code.
+            Append(idup).
+            Append(iis).
+            Append(iopis).
+            Append(ijumpf).
+            Append(iassign).
+            Append(icatch).
+            Append(ijump).
+            Append(ireraise).
+            Append(icatchtarget)
             ;
             ijumpf->target = icatchtarget;
             ijump->target  = ijmptarget;
@@ -931,7 +910,7 @@ Instr* TryStmt::DoStmtCodeGen()
     {
         PIKA_BLOCKSTART(state, ijmptarget); // Start a local block
         
-        Instr* icatch = catchBlock->GenerateCode();
+        InstrList icatch = catchBlock->GenerateCode();
         
         // Set the catch variable.
         Instr* iassign     = state->CreateOp(OP_setlocal);
@@ -940,9 +919,9 @@ Instr* TryStmt::DoStmtCodeGen()
         
         PIKA_BLOCKEND(state);               // End a local block
         
-        icurr->
-        Attach(iassign)->
-        Attach(icatch)
+        code.
+        Append(iassign).
+        Append(icatch)
         ;
         if (!settarget)
         {
@@ -956,55 +935,79 @@ Instr* TryStmt::DoStmtCodeGen()
     }
     
     {
-        ipushtry->Attach(ijmptarget2)->Attach( ijmptarget );
+        code.Append(ijmptarget2).Append( ijmptarget );
     }
     
     HandleBlockBreaks(state, ipushtry, ipoptry, OP_pophandler);
     
-    return ipushtry;
+    return code;
 }
 
-Instr* RaiseStmt::DoStmtCodeGen()
+InstrList RaiseStmt::DoStmtCodeGen()
 {
-    Instr* iexpr  = 0;
-    Instr* ithrow = state->CreateOp(OP_raise);
+    InstrList iexpr;
+    Instr*    ithrow = state->CreateOp(OP_raise);
     
     if (!expr)
     {
         // no expression given so we reraise the current exception.
-        iexpr = state->CreateOp(OP_pushlocal);
-        iexpr->operand = reraiseOffset;
+        Instr* ipushex = state->CreateOp(OP_pushlocal);
+        ipushex->operand = reraiseOffset;
+        iexpr = ipushex;
     }
     else
     {
         iexpr = expr->GenerateCode();
     }
     
-    iexpr->Attach(ithrow);
+    iexpr.Append(ithrow);
     return iexpr;
 }
 
-Instr* StmtList::DoStmtCodeGen()
+InstrList StmtList::DoStmtCodeGen()
 {
-    Instr* ifirst  = first->GenerateCode();
-    Instr* isecond = second->GenerateCode();
+    // Statement lists nest to the left, one level per statement of a block. Walk down to the
+    // first statement instead of recursing so that long blocks cannot overflow the C stack.
+    Buffer<StmtList*> lists;
+    Stmt* curr = first;
+    
+    while (curr->kind == STMT_list)
+    {
+        StmtList* list = (StmtList*)curr;
+        lists.Push(list);
+        curr = list->first;
+    }
     
-    ifirst->Attach(isecond);
+    InstrList ifirst = curr->GenerateCode();
+    
+    for (size_t i = lists.GetSize(); i > 0; --i)
+    {
+        StmtList* list = lists[i - 1];
+        
+        if (list->newline && ifirst.head)
+        {
+            ifirst.head->line = list->line;
+        }
+        ifirst.Append(list->second->GenerateCode());
+    }
+    
+    InstrList isecond = second->GenerateCode();
+    
+    ifirst.Append(isecond);
     return ifirst;
 }
 
-Instr* LabeledStmt::DoStmtCodeGen()
+InstrList LabeledStmt::DoStmtCodeGen()
 {
     return stmt->GenerateCode();
 }
 
-static bool MakeTailcall(bool intry, Instr* icurr)
+static bool MakeTailcall(bool intry, const InstrList& code)
 {
     if (intry)
         return false;
-    // Find the last instruction in this list.
-    while (icurr && icurr->next)
-        icurr = icurr->next;
+    // Look at the last instruction in this list.
+    Instr* icurr = code.tail;
         
     // If its a valid call opcode
     if (icurr)
@@ -1021,7 +1024,7 @@ static bool MakeTailcall(bool intry, Instr* icurr)
     return false;
 }
 
-Instr* CtrlStmt::DoStmtCodeGen()
+InstrList CtrlStmt::DoStmtCodeGen()
 {
     if (!exprs || count == 0)
     {
@@ -1029,142 +1032,133 @@ Instr* CtrlStmt::DoStmtCodeGen()
         return iretnull;
     }
     
-    Instr* iexpr = 0;
-    Instr* last  = 0;
+    InstrList iexpr;
     for (ExprList* curr = exprs; curr != 0; curr = curr->next)
     {
         ASSERT(curr->expr);
         
-        Instr* inext = curr->expr->GenerateCode();
-        if (!iexpr)
-            iexpr = inext;
-        else
-            iexpr->Attach(inext);
-            
-        last = iexpr;
+        InstrList inext = curr->expr->GenerateCode();
+        iexpr.Append(inext);
     }
     
     if (count == 1)
     {
-        ASSERT(iexpr);
+        ASSERT(!iexpr.IsEmpty());
         
         if (kind == Stmt::STMT_return)
         {
-            if (MakeTailcall(isInTry, last))
+            if (MakeTailcall(isInTry, iexpr))
                 return iexpr;
         }
         
         Instr* iret  = state->CreateOp(GetOneOp());
-        iexpr->Attach(iret);
+        iexpr.Append(iret);
         return iexpr;
     }
     else
     {
         Instr* iret  = state->CreateOp(GetVarOp());
         iret->operand = count;
-        iexpr->Attach(iret);
+        iexpr.Append(iret);
         return iexpr;
     }
 }
 
-Instr* ExprStmt::DoStmtCodeGen()
+InstrList ExprStmt::DoStmtCodeGen()
 {
     ExprList* curr = exprList;
-    Instr* ifirst = 0;
+    InstrList ifirst;
     
     while (curr)
     {
-        Expr*   expr = curr->expr;
-        Instr* iexpr = expr->GenerateCode();
+        Expr*     expr  = curr->expr;
+        InstrList iexpr = expr->GenerateCode();
         if (autopop)
         {
             Instr* ipop  = state->CreateOp(OP_acc);
-            iexpr->Attach(ipop);
-        }
-        if (ifirst)
-        {
-            ifirst->Attach(iexpr);
-        }
-        else
-        {
-            ifirst = iexpr;
+            iexpr.Append(ipop);
         }
+        ifirst.Append(iexpr);
         curr = curr->next;
     }
     return ifirst;
 }
 
-Instr* DeclStmt::DoStmtCodeGen()
+InstrList DeclStmt::DoStmtCodeGen()
 {
     return decl->GenerateCode();
 }
 
-Instr* BlockStmt::DoStmtCodeGen()
+InstrList BlockStmt::DoStmtCodeGen()
 {
     Instr* iend = state->CreateOp(JMP_TARGET);
     
     PIKA_BLOCKSTART(state, iend);
     
-    Instr* iblock = stmts->GenerateCode();
+    InstrList iblock = stmts->GenerateCode();
     
     PIKA_BLOCKEND(state);
     
-    iblock->Attach(iend);
+    iblock.Append(iend);
     return  iblock;
 }
 
-Instr* IfStmt::DoStmtCodeGen()
+InstrList IfStmt::DoStmtCodeGen()
 {
-    Instr* icond      = cond->GenerateCode();
-    Instr* ijmpFalse  = (is_unless) ? state->CreateOp(OP_jumpiftrue) : state->CreateOp(OP_jumpiffalse) ;
-    Instr* ithen      = then_part->GenerateCode();
-    Instr* ijmpTarget = state->CreateOp(JMP_TARGET);
+    InstrList icond      = cond->GenerateCode();
+    Instr*    ijmpFalse  = (is_unless) ? state->CreateOp(OP_jumpiftrue) : state->CreateOp(OP_jumpiffalse) ;
+    InstrList ithen      = then_part->GenerateCode();
+    Instr*    ijmpTarget = state->CreateOp(JMP_TARGET);
     
-    icond->Attach(ijmpFalse);
-    ijmpFalse->Attach(ithen);
-    ithen->Attach(ijmpTarget);
+    icond.
+    Append(ijmpFalse).
+    Append(ithen).
+    Append(ijmpTarget);
     
     ijmpFalse->SetTarget(ijmpTarget);
     
     return icond;
 }
 
-Instr* LoopStmt::DoStmtCodeGen()
+InstrList LoopStmt::DoStmtCodeGen()
 {
-    Instr* ibody      = body->GenerateCode();
-    Instr* ijmpTarget = state->CreateOp(JMP_TARGET);
-    Instr* ijmpBack   = state->CreateOp(OP_jump);
+    size_t    loopJumps  = state->loopJumps.GetSize();
+    InstrList ibody      = body->GenerateCode();
+    Instr*    ijmpTarget = state->CreateOp(JMP_TARGET);
+    Instr*    ijmpBack   = state->CreateOp(OP_jump);
+    Instr*    ibodyStart = ibody.head;
     
-    ibody->
-    Attach(ijmpBack)->
-    Attach(ijmpTarget);
+    ibody.
+    Append(ijmpBack).
+    Append(ijmpTarget);
     
-    ijmpBack->SetTarget(ibody);
+    ijmpBack->SetTarget(ibodyStart);
     
-    ibody->DoLoopPatch(ijmpTarget, ibody, label);
+    state->DoLoopPatch(loopJumps, ijmpTarget, ibodyStart, label);
     
     return ibody;
 }
 
-Instr* ForToStmt::DoStmtCodeGen()
+InstrList ForToStmt::DoStmtCodeGen()
 {
     Instr* ijmpTarget = state->CreateOp(JMP_TARGET);
     PIKA_BLOCKSTART(state, ijmpTarget);
     
-    Instr* ifrom      = from->GenerateCode();
-    Instr* ito        = to->GenerateCode();
-    Instr* istep      = step->GenerateCode();
-    Instr* iforto     = state->CreateOp(OP_forto);
-    Instr* ibody      = body->GenerateCode();
-    Instr* ijmp       = state->CreateOp(OP_jump);
-    Instr* ijmpFalse  = state->CreateOp(OP_jumpiffalse);
-    Instr* ipushlvar1 = state->CreateOp(OP_pushlocal);
-    Instr* ipushlvar2 = state->CreateOp(OP_pushlocal);
-    Instr* ipushto    = state->CreateOp(OP_pushlocal);
-    Instr* ipushstep  = state->CreateOp(OP_pushlocal);
-    Instr* iless      = state->CreateOp(down ? OP_gt : OP_lt);
-    Instr* iadd       = state->CreateOp(OP_add);
-    Instr* iset       = state->CreateOp(OP_setlocal);
+    InstrList ifrom      = from->GenerateCode();
+    InstrList ito        = to->GenerateCode();
+    InstrList istep      = step->GenerateCode();
+    Instr*    iforto     = state->CreateOp(OP_forto);
+    size_t    loopJumps  = state->loopJumps.GetSize();
+    InstrList ibody      = body->GenerateCode();
+    Instr*    ijmp       = state->CreateOp(OP_jump);
+    Instr*    ijmpFalse  = state->CreateOp(OP_jumpiffalse);
+    Instr*    ipushlvar1 = state->CreateOp(OP_pushlocal);
+    Instr*    ipushlvar2 = state->CreateOp(OP_pushlocal);
+    Instr*    ipushto    = state->CreateOp(OP_pushlocal);
+    Instr*    ipushstep  = state->CreateOp(OP_pushlocal);
+    Instr*    iless      = state->CreateOp(down ? OP_gt : OP_lt);
+    Instr*    iadd       = state->CreateOp(OP_add);
+    Instr*    iset       = state->CreateOp(OP_setlocal);
     
     PIKA_BLOCKEND(state);
     
@@ -1173,26 +1167,27 @@ Instr* ForToStmt::DoStmtCodeGen()
     // Any changes to the order and the value of PIKA_FORTO_COMP_OFFSET (defined in "gOpcode.h")
     // needs to be changed as well.
     
-    ifrom ->
-    Attach(ito) ->
-    Attach(istep) ->
-    Attach(iforto) ->
-    Attach(ipushlvar1)->    // 0
-    Attach(ipushto) ->      // 1
-    Attach(iless) ->        // 2 = PIKA_FORTO_COMP_OFFSET
-    Attach(ijmpFalse) ->
-    Attach(ibody) ->
-    Attach(ipushlvar2)->
-    Attach(ipushstep) ->
-    Attach(iadd) ->
-    Attach(iset) ->
-    Attach(ijmp) ->
-    Attach(ijmpTarget);
+    ifrom .
+    Append(ito) .
+    Append(istep) .
+    Append(iforto) .
+    Append(ipushlvar1).    // 0
+    Append(ipushto) .      // 1
+    Append(iless) .        // 2 = PIKA_FORTO_COMP_OFFSET
+    Append(ijmpFalse) .
+    Append(ibody) .
+    Append(ipushlvar2).
+    Append(ipushstep) .
+    Append(iadd) .
+    Append(iset) .
+    Append(ijmp) .
+    Append(ijmpTarget);
     
     ijmp->SetTarget(ipushlvar1);
     ijmpFalse->SetTarget(ijmpTarget);
     
-    ibody->DoLoopPatch(ijmpTarget,
+    state->DoLoopPatch(loopJumps,
+                       ijmpTarget,
                        ipushlvar2,
                        this->label);
                        
@@ -1206,51 +1201,56 @@ Instr* ForToStmt::DoStmtCodeGen()
     return ifrom;
 }
 
-Instr* ForeachStmt::DoStmtCodeGen()
+InstrList ForeachStmt::DoStmtCodeGen()
 {
     Instr* ijmpTarget = state->CreateOp(JMP_TARGET);
     PIKA_BLOCKSTART(state, ijmpTarget);
         
-    Instr* iin       = in->GenerateCode();
-    Instr* ibody     = body->GenerateCode();
-    Instr* ikind     = type_expr->GenerateCode();
-    Instr* iforeach  = state->CreateOp(OP_foreach);
-    Instr* ijmpfalse = state->CreateOp(OP_jumpiffalse);
-    Instr* ijmpback  = state->CreateOp(OP_jump);
+    InstrList iin       = in->GenerateCode();
+    size_t    loopJumps = state->loopJumps.GetSize();
+    InstrList ibody     = body->GenerateCode();
+    InstrList ikind     = type_expr->GenerateCode();
+    Instr*    iforeach  = state->CreateOp(OP_foreach);
+    Instr*    ijmpfalse = state->CreateOp(OP_jumpiffalse);
+    Instr*    ijmpback  = state->CreateOp(OP_jump);
     
-    Instr* iopiter   = state->CreateOp(OP_itercall); // TODO
+    Instr*    iopiter   = state->CreateOp(OP_itercall); // TODO
     
     PIKA_BLOCKEND(state);
     
-    iin->
-    Attach( ikind )->
-    Attach( iforeach )-> // iin.ikind    
-    Attach( iopiter )->
-    Attach( ijmpfalse )->
-    Attach( ibody )->    
-    Attach( ijmpback )->
-    Attach( ijmpTarget )
+    iin.
+    Append( ikind ).
+    Append( iforeach ). // iin.ikind    
+    Append( iopiter ).
+    Append( ijmpfalse ).
+    Append( ibody ).    
+    Append( ijmpback ).
+    Append( ijmpTarget )
     ;
     
-    ibody->DoLoopPatch(ijmpTarget,
+    state->DoLoopPatch(loopJumps,
+                       ijmpTarget,
                        iopiter,
                        this->label);
     
     ijmpback->SetTarget(iopiter);
     ijmpfalse->SetTarget(ijmpTarget);
     iopiter->operand = iter_offset;
-    iopiter->operandu1 = (u1)symbols.GetSize();
+    iopiter->operandu1 = (u1)numVars;
     iforeach->operand = iter_offset;
     return iin;
 }
 
-Instr* CondLoopStmt::DoStmtCodeGen()
+InstrList CondLoopStmt::DoStmtCodeGen()
 {
-    Instr* icond    = cond->GenerateCode();
-    Instr* ibody    = body->GenerateCode();
-    Instr* ijmpCond = (until) ? state->CreateOp(OP_jumpiftrue) : state->CreateOp(OP_jumpiffalse);
-    Instr* itarget  = state->CreateOp(JMP_TARGET);
-    Instr* ijmpBack = state->CreateOp(OP_jump);
+    InstrList icond     = cond->GenerateCode();
+    size_t    loopJumps = state->loopJumps.GetSize();
+    InstrList ibody     = body->GenerateCode();
+    Instr*    ijmpCond  = (until) ? state->CreateOp(OP_jumpiftrue) : state->CreateOp(OP_jumpiffalse);
+    Instr*    itarget   = state->CreateOp(JMP_TARGET);
+    Instr*    ijmpBack  = state->CreateOp(OP_jump);
+    Instr*    ibodyStart = ibody.head;
+    Instr*    icondStart = icond.head;
     
     if (repeat)
     {
@@ -1262,15 +1262,16 @@ Instr* CondLoopStmt::DoStmtCodeGen()
          * |     jmpBack ---------'
          * '---> target
          */
-        ibody->Attach(icond);
-        icond->Attach(ijmpCond);
-        ijmpCond->Attach(ijmpBack);
-        ijmpBack->Attach(itarget);
+        ibody.
+        Append(icond).
+        Append(ijmpCond).
+        Append(ijmpBack).
+        Append(itarget);
         
         ijmpCond->SetTarget(itarget);
-        ijmpBack->SetTarget(ibody);
+        ijmpBack->SetTarget(ibodyStart);
         
-        ibody->DoLoopPatch(itarget, ibody, label);
+        state->DoLoopPatch(loopJumps, itarget, ibodyStart, label);
         return ibody;
     }
     else
@@ -1283,77 +1284,67 @@ Instr* CondLoopStmt::DoStmtCodeGen()
          * |     jmpBack ---------'
          * '---> target
          */
-        icond->Attach(ijmpCond);
-        ijmpCond->Attach(ibody);
-        ibody->Attach(ijmpBack);
-        ijmpBack->Attach(itarget);
+        icond.
+        Append(ijmpCond).
+        Append(ibody).
+        Append(ijmpBack).
+        Append(itarget);
         
         ijmpCond->SetTarget(itarget);
-        ijmpBack->SetTarget(icond);
+        ijmpBack->SetTarget(icondStart);
         
-        ibody->DoLoopPatch(itarget, icond, label);
+        state->DoLoopPatch(loopJumps, itarget, icondStart, label);
         return icond;
     }
 }
 
-Instr* ConditionalStmt::DoStmtCodeGen()
+InstrList ConditionalStmt::DoStmtCodeGen()
 {
     bool bElse = elsePart != 0;
     
-    Instr*  itarget  = state->CreateOp(JMP_TARGET);
-    Instr*  istart   = 0;
-    IfStmt* currIf   = ifPart;
-    Instr*  iprev    = 0;
-    Instr*  ijmpprev = 0;
+    Instr*    itarget  = state->CreateOp(JMP_TARGET);
+    InstrList code;
+    IfStmt*   currIf   = ifPart;
+    Instr*    ijmpprev = 0;
     
     while (currIf)
     {
-        Instr* icond = currIf->cond->GenerateCode();
-        icond->line = currIf->cond->line;
+        InstrList icond = currIf->cond->GenerateCode();
+        icond.head->line = currIf->cond->line;
         
-        Instr* ijmpfalse = (currIf->is_unless) ? state->CreateOp(OP_jumpiftrue) : state->CreateOp(OP_jumpiffalse) ;
-        Instr* ithen     = currIf->then_part->GenerateCode();
-        Instr* ijmp      = (bElse || currIf->next) ? state->CreateOp(OP_jump) : 0;
+        Instr*    ijmpfalse = (currIf->is_unless) ? state->CreateOp(OP_jumpiftrue) : state->CreateOp(OP_jumpiffalse) ;
+        InstrList ithen     = currIf->then_part->GenerateCode();
+        Instr*    ijmp      = (bElse || currIf->next) ? state->CreateOp(OP_jump) : 0;
         
-        if (iprev)
+        if (ijmpprev)
         {
-            iprev->Attach(icond);
+            ijmpprev->SetTarget(icond.head);
         }
         
-        icond->Attach(ijmpfalse);
-        ijmpfalse->Attach(ithen);
+        code.
+        Append(icond).
+        Append(ijmpfalse).
+        Append(ithen);
         
         if (ijmp)
         {
-            ithen->Attach(ijmp);
+            code.Append(ijmp);
             ijmp->SetTarget(itarget);
         }
         
-        if (ijmpprev)
-        {
-            ijmpprev->SetTarget(icond);
-        }
-        
         ijmpprev = ijmpfalse;
-        iprev = icond;
-        
-        if (currIf == ifPart)
-        {
-            istart = icond;
-        }
-        
         currIf = (IfStmt*)currIf->next;
     }
     
     if (bElse)
     {
-        Instr* ielse = elsePart->GenerateCode();
-        ielse->line = elsePart->line;
-        iprev->Attach(ielse);
+        InstrList ielse = elsePart->GenerateCode();
+        ielse.head->line = elsePart->line;
+        code.Append(ielse);
         
         if (ijmpprev)
         {
-            ijmpprev->SetTarget(ielse);
+            ijmpprev->SetTarget(ielse.head);
         }
     }
     else if (ijmpprev)
@@ -1361,11 +1352,11 @@ Instr* ConditionalStmt::DoStmtCodeGen()
         ijmpprev->SetTarget(itarget);
     }
     
-    istart->Attach(itarget);
-    return istart;
+    code.Append(itarget);
+    return code;
 }
 
-Instr* LoadExpr::GenerateCode()
+InstrList LoadExpr::GenerateCode()
 {
     switch (loadkind)
     {
@@ -1380,7 +1371,7 @@ Instr* LoadExpr::GenerateCode()
     return state->CreateOp(OP_nop);
 }
 
-Instr* DotExpr::GenerateCode()
+InstrList DotExpr::GenerateCode()
 {
     if (left->kind  == Expr::EXPR_load && (((LoadExpr*)left)->loadkind == LoadExpr::LK_self) &&
             right->kind == Expr::EXPR_member)
@@ -1395,19 +1386,19 @@ Instr* DotExpr::GenerateCode()
     }
     else
     {
-        Instr* iop    = state->CreateOp(OP_dotget);
-        Instr* ileft  = left->GenerateCode();
-        Instr* iright = right->GenerateCode();
+        Instr*    iop    = state->CreateOp(OP_dotget);
+        InstrList ileft  = left->GenerateCode();
+        InstrList iright = right->GenerateCode();
         
-        ileft->
-        Attach(iright)->
-        Attach(iop);
+        ileft.
+        Append(iright).
+        Append(iop);
         
         return ileft;
     }
 }
 
-Instr* DotExpr::GenerateCodeSet()
+InstrList DotExpr::GenerateCodeSet()
 {
     if (left->kind  == Expr::EXPR_load && (((LoadExpr*)left)->loadkind == LoadExpr::LK_self) &&
             right->kind == Expr::EXPR_member)
@@ -1422,97 +1413,97 @@ Instr* DotExpr::GenerateCodeSet()
     }
     else
     {
-        Instr* iop = state->CreateOp(OP_dotset);
-        Instr* ileft = left->GenerateCode();
-        Instr* iright = right->GenerateCode();
+        Instr*    iop    = state->CreateOp(OP_dotset);
+        InstrList ileft  = left->GenerateCode();
+        InstrList iright = right->GenerateCode();
         
-        ileft->Attach(iright);
-        iright->Attach(iop);
+        ileft.Append(iright);
+        ileft.Append(iop);
         
         return ileft;
     }
 }
 
-Instr* IndexExpr::GenerateCode()
+InstrList IndexExpr::GenerateCode()
 { 
-    Instr* iop    = state->CreateOp(OP_subget);
-    Instr* ileft  = left->GenerateCode();
-    Instr* iright = right->GenerateCode();
+    Instr*    iop    = state->CreateOp(OP_subget);
+    InstrList ileft  = left->GenerateCode();
+    InstrList iright = right->GenerateCode();
     
-    ileft->
-    Attach(iright)->
-    Attach(iop);
+    ileft.
+    Append(iright).
+    Append(iop);
     
     return ileft;
 }
 
-Instr* IndexExpr::GenerateCodeSet()
+InstrList IndexExpr::GenerateCodeSet()
 { 
-        Instr* iop = state->CreateOp(OP_subset);
-        Instr* ileft = left->GenerateCode();
-        Instr* iright = right->GenerateCode();
+        Instr*    iop    = state->CreateOp(OP_subset);
+        InstrList ileft  = left->GenerateCode();
+        InstrList iright = right->GenerateCode();
         
-        ileft->Attach(iright);
-        iright->Attach(iop);
+        ileft.Append(iright);
+        ileft.Append(iop);
         
         return ileft; 
 }
 
-Instr* DotBindExpr::GenerateCode()
+InstrList DotBindExpr::GenerateCode()
 {
-    Instr* iop    = state->CreateOp(GetOpcode()); // TODO: OP_subget
-    Instr* ileft  = left->GenerateCode();
-    Instr* idup   = state->CreateOp(OP_dup);
-    Instr* iright = right->GenerateCode();
-    Instr* ibind  = state->CreateOp(OP_bind);
-    Instr* iswap  = state->CreateOp(OP_swap);
+    Instr*    iop    = state->CreateOp(GetOpcode()); // TODO: OP_subget
+    InstrList ileft  = left->GenerateCode();
+    Instr*    idup   = state->CreateOp(OP_dup);
+    InstrList iright = right->GenerateCode();
+    Instr*    ibind  = state->CreateOp(OP_bind);
+    Instr*    iswap  = state->CreateOp(OP_swap);
     
-    ileft->
-    Attach(idup)->
-    Attach(iright)->
-    Attach(iop)->
-    Attach(iswap)->
-    Attach(ibind);
+    ileft.
+    Append(idup).
+    Append(iright).
+    Append(iop).
+    Append(iswap).
+    Append(ibind);
     
     return ileft;
 }
 
-Instr* DotBindExpr::GenerateCodeSet()
+InstrList DotBindExpr::GenerateCodeSet()
 {
-    Instr* iop    = state->CreateOp(SetOpcode()); // TODO: OP_subset
-    Instr* ileft  = left->GenerateCode();
-    Instr* idup   = state->CreateOp(OP_dup);
-    Instr* iright = right->GenerateCode();
-    Instr* ibind  = state->CreateOp(OP_bind);
-    Instr* iswap  = state->CreateOp(OP_swap);
+    Instr*    iop    = state->CreateOp(SetOpcode()); // TODO: OP_subset
+    InstrList ileft  = left->GenerateCode();
+    Instr*    idup   = state->CreateOp(OP_dup);
+    InstrList iright = right->GenerateCode();
+    Instr*    ibind  = state->CreateOp(OP_bind);
+    Instr*    iswap  = state->CreateOp(OP_swap);
     
-    ileft->
-    Attach(idup)->
-    Attach(iright)->
-    Attach(iop)->
-    Attach(iswap)->
-    Attach(ibind);
+    ileft.
+    Append(idup).
+    Append(iright).
+    Append(iop).
+    Append(iswap).
+    Append(ibind);
     
     return ileft;
 }
 
-Instr* PropExpr::GenerateCode()
+InstrList PropExpr::GenerateCode()
 {
     Instr* iprop = state->CreateOp(OP_property);
     
-    Instr* iname   = (nameexpr) ? nameexpr->GenerateCode() : state->CreateOp(OP_pushnull);
-    Instr* igetter = (getter)   ? getter->GenerateCode()   : state->CreateOp(OP_pushnull);
-    Instr* isetter = (setter)   ? setter->GenerateCode()   : state->CreateOp(OP_pushnull);
+    InstrList iname   = (nameexpr) ? nameexpr->GenerateCode() : state->CreateOp(OP_pushnull);
+    InstrList igetter = (getter)   ? getter->GenerateCode()   : state->CreateOp(OP_pushnull);
+    InstrList isetter = (setter)   ? setter->GenerateCode()   : state->CreateOp(OP_pushnull);
     
-    iname->line   = (nameexpr) ? nameexpr->line : line;
-    isetter->line = (setter)   ? setter->line    : line;
-    igetter->line = (getter)   ? getter->line    : line;
+    iname.head->line   = (nameexpr) ? nameexpr->line : line;
+    isetter.head->line = (setter)   ? setter->line    : line;
+    igetter.head->line = (getter)   ? getter->line    : line;
     
-    if (isetter->line >= igetter->line)
+    if (isetter.head->line >= igetter.head->line)
     {
-        iname->Attach(igetter);
-        igetter->Attach(isetter);
-        isetter->Attach(iprop);
+        iname.Append(igetter);
+        iname.Append(isetter);
+        iname.Append(iprop);
     }
     else
     {
@@ -1525,46 +1516,39 @@ Instr* PropExpr::GenerateCode()
         // OP_property recieves its name | getter | setter in the correct order.
         //
         Instr* iswap = state->CreateOp(OP_swap);
-        iname->Attach(isetter);
-        isetter->Attach(igetter);
-        igetter->Attach(iswap);
-        iswap->Attach(iprop);
+        iname.Append(isetter);
+        iname.Append(igetter);
+        iname.Append(iswap);
+        iname.Append(iprop);
     }
     return iname;
 }
 
-Instr* FunExpr::GenerateCode()
+InstrList FunExpr::GenerateCode()
 {
     u2 numdefs = 0;
     ParamDecl* arg = args;
-    Instr* idefs = 0;
+    InstrList idefs;
     
     while (arg)
     {
         if (arg->val)
         {
-            if (!idefs) idefs = arg->val->GenerateCode();
-            else idefs->Attach(arg->val->GenerateCode());
+            idefs.Append(arg->val->GenerateCode());
             
             ++numdefs;
         }
         arg = arg->next;
     }
     
-    Instr* iinst = state->CreateOp(OP_method);
-    iinst->operand = numdefs;
-    
-    if (idefs)
-    {
-        idefs->Attach(iinst);
-        iinst = idefs;
-    }
+    Instr* imethod = state->CreateOp(OP_method);
+    imethod->operand = numdefs;
+    idefs.Append(imethod);
     
-    Instr* ifun = ConstantExpr::GenerateCode(); // push the function
-    ifun->Attach(iinst);
+    InstrList ifun = ConstantExpr::GenerateCode(); // push the function
+    ifun.Append(idefs);
     Instr* ipushnull = state->CreateOp(OP_pushnull);
-    ipushnull->Attach(ifun);
-    ifun = ipushnull;
+    ifun.Prepend(ipushnull);
     try
     {
         CompileFunction(line, state, body, def);
@@ -1584,124 +1568,99 @@ Instr* FunExpr::GenerateCode()
         }
         else
         {
-            //Pika_delete(ifun);
             throw;
         }
     }
     return ifun;
 }
 
-Instr* BreakStmt::DoStmtCodeGen()
+InstrList BreakStmt::DoStmtCodeGen()
 {
     Instr* ir = state->CreateOp(BREAK_LOOP);
     ir->symbol = label;
+    state->loopJumps.Push(ir);
     return ir;
 }
 
-Instr* ContinueStmt::DoStmtCodeGen()
+InstrList ContinueStmt::DoStmtCodeGen()
 {
     Instr* ir = state->CreateOp(CONTINUE_LOOP);
     ir->symbol = label;
+    state->loopJumps.Push(ir);
     return ir;
 }
 
-Instr* DictionaryExpr::GenerateCode()
+InstrList DictionaryExpr::GenerateCode()
 {
     Instr*     inewObj = state->CreateOp(OP_dictionary);
     FieldList* curr    = fields;
-    Instr*     icurr   = 0;
-    Instr*     ifirst  = 0;
+    InstrList  ifields;
     u2         count   = 0;
     
     while (curr)
     {
-        Instr* ival  = curr->value->GenerateCode();
-        Instr* iprop = (curr->name) ? curr->name->GenerateCode() : state->CreateOp(OP_pushnull);
+        InstrList ival  = curr->value->GenerateCode();
+        InstrList iprop = (curr->name) ? curr->name->GenerateCode() : state->CreateOp(OP_pushnull);
         
-        ival->Attach(iprop);
+        ifields.
+        Append(ival).
+        Append(iprop);
         
-        if (icurr)
-        {
-            icurr->Attach(ival);
-        }
-        icurr = iprop;
-        
-        if (!ifirst)
-        {
-            ifirst = ival;
-        }        
         ++count;
         curr = curr->next;
     }
     
-    if (icurr && icurr != inewObj)
-    {
-        icurr->Attach(inewObj);
-    }
-    
     inewObj->operand = count;
     
-    return ifirst ? ifirst : inewObj;
+    ifields.Append(inewObj);
+    return ifields;
 }
 
-Instr* ArrayExpr::GenerateCode()
+InstrList ArrayExpr::GenerateCode()
 {
-    Instr* ibeg      = 0;
-    Instr* inewArray = state->CreateOp(OP_array);
-    ExprList*    curr      = elements;
-    u2           count     = 0;
+    InstrList ibeg;
+    Instr*    inewArray = state->CreateOp(OP_array);
+    ExprList* curr      = elements;
+    u2        count     = 0;
     
     while (curr)
     {
         Expr *expr = curr->expr;
-        Instr* iexpr = expr->GenerateCode();
+        InstrList iexpr = expr->GenerateCode();
         
-        if (ibeg)
-        {
-            ibeg->Attach(iexpr);
-        }
-        else
-        {
-            ibeg = iexpr;
-        }
+        ibeg.Append(iexpr);
         ++count;
         curr = curr->next;
     }
     
     inewArray->operand = count;
     
-    if (ibeg)
-    {
-        ibeg->Attach(inewArray);
-    }
-    else
-    {
-        ibeg = inewArray;
-    }
+    ibeg.Append(inewArray);
     return ibeg;
 }
 
-Instr* ArrayComprExpr::GenerateCode()
+InstrList ArrayComprExpr::GenerateCode()
 {
-    Instr* iprecompr = body->PreGenerateCode();
-    Instr* icompr = stmt->GenerateCode();
-    Instr* ipostcompr = body->PostGenerateCode();
+    InstrList iprecompr = body->PreGenerateCode();
+    InstrList icompr = stmt->GenerateCode();
+    InstrList ipostcompr = body->PostGenerateCode();
     
-    iprecompr->
-    Attach(icompr)->
-    Attach(ipostcompr);
+    iprecompr.
+    Append(icompr).
+    Append(ipostcompr);
     
     return iprecompr;
 }
 
-Instr* ComprExprStmt::PreGenerateCode()
+InstrList ComprExprStmt::PreGenerateCode()
 {
     /* Create the array and the local variable with the result. */
     Instr* iarray = state->CreateOp(OP_array);
     Instr* isetLocal = state->CreateOp(OP_setlocal);
     
-    iarray->
-    Attach(isetLocal);
+    InstrList code = iarray;
+    code.
+    Append(isetLocal);
     
     isetLocal->operand = localOffset;
     isetLocal->operandu1 = 1;
@@ -1709,10 +1668,10 @@ Instr* ComprExprStmt::PreGenerateCode()
     
     iarray->operand = 0; // No Elements.
     
-    return iarray;
+    return code;
 }
 
-Instr* ComprExprStmt::PostGenerateCode()
+InstrList ComprExprStmt::PostGenerateCode()
 {
     Instr* ipushLocal = state->CreateOp(OP_pushlocal);
     ipushLocal->operand = localOffset;
@@ -1720,38 +1679,38 @@ Instr* ComprExprStmt::PostGenerateCode()
     return ipushLocal;
 }
 
-Instr* ComprExprStmt::DoStmtCodeGen()
+InstrList ComprExprStmt::DoStmtCodeGen()
 {
-    Instr* iexpr = expr->GenerateCode();
-    Instr* icompr = state->CreateOp(OP_compr);
+    InstrList iexpr = expr->GenerateCode();
+    Instr*    icompr = state->CreateOp(OP_compr);
     
-    iexpr->
-    Attach(icompr);
+    iexpr.
+    Append(icompr);
     
     icompr->operand = localOffset;
     return iexpr;
 }
 
-Instr* KeywordExpr::GenerateCode()
+InstrList KeywordExpr::GenerateCode()
 {
-    Instr* iname = name->GenerateCode();
-    Instr* ivalue = value->GenerateCode();
+    InstrList iname = name->GenerateCode();
+    InstrList ivalue = value->GenerateCode();
 
-    iname->
-    Attach(ivalue)
+    iname.
+    Append(ivalue)
     ;
     
     return iname;
 }
 
-Instr* CondExpr::GenerateCode()
+InstrList CondExpr::GenerateCode()
 {
-    Instr* icond      = cond->GenerateCode();
-    Instr* ia         = exprA->GenerateCode();
-    Instr* ib         = exprB->GenerateCode();
-    Instr* ijmpfalse  = state->CreateOp(unless ? OP_jumpiftrue : OP_jumpiffalse);
-    Instr* ijmp       = state->CreateOp(OP_jump);
-    Instr* ijmptarget = state->CreateOp(JMP_TARGET);
+    InstrList icond      = cond->GenerateCode();
+    InstrList ia         = exprA->GenerateCode();
+    InstrList ib         = exprB->GenerateCode();
+    Instr*    ijmpfalse  = state->CreateOp(unless ? OP_jumpiftrue : OP_jumpiffalse);
+    Instr*    ijmp       = state->CreateOp(OP_jump);
+    Instr*    ijmptarget = state->CreateOp(JMP_TARGET);
     /*
      *    condition
      *    jump if false -.
@@ -1761,20 +1720,20 @@ Instr* CondExpr::GenerateCode()
      * '->jump target
      */
     
-    icond->
-    Attach(ijmpfalse)->
-    Attach(ia)->
-    Attach(ijmp)->
-    Attach(ib)->
-    Attach(ijmptarget);
+    icond.
+    Append(ijmpfalse).
+    Append(ia).
+    Append(ijmp).
+    Append(ib).
+    Append(ijmptarget);
     
-    ijmpfalse->SetTarget(ib);
+    ijmpfalse->SetTarget(ib.head);
     ijmp->SetTarget(ijmptarget);
     
     return icond;
 }
 
-Instr* NullSelectExpr::GenerateCode()
+InstrList NullSelectExpr::GenerateCode()
 {
     /*
      *  a ?? b:
@@ -1792,30 +1751,30 @@ Instr* NullSelectExpr::GenerateCode()
      *                 |     [   ]      eval expression b
      *  [ a ]      <---'     [ b ]
      */
-    Instr* ia         = exprA->GenerateCode();
-    Instr* ib         = exprB->GenerateCode();
-    Instr* idup       = state->CreateOp(OP_dup);
-    Instr* ijmpfalse  = state->CreateOp(OP_jumpiffalse);
-    Instr* ijmptarget = state->CreateOp(JMP_TARGET);
-    Instr* ipop       = state->CreateOp(OP_pop);
-    Instr* ipushnull  = state->CreateOp(OP_pushnull);
-    Instr* ieq        = state->CreateOp(OP_eq);
-    
-    ia->
-    Attach(idup)->
-    Attach(ipushnull)->
-    Attach(ieq)->
-    Attach(ijmpfalse)->
-    Attach(ipop)->
-    Attach(ib)->
-    Attach(ijmptarget);
+    InstrList ia         = exprA->GenerateCode();
+    InstrList ib         = exprB->GenerateCode();
+    Instr*    idup       = state->CreateOp(OP_dup);
+    Instr*    ijmpfalse  = state->CreateOp(OP_jumpiffalse);
+    Instr*    ijmptarget = state->CreateOp(JMP_TARGET);
+    Instr*    ipop       = state->CreateOp(OP_pop);
+    Instr*    ipushnull  = state->CreateOp(OP_pushnull);
+    Instr*    ieq        = state->CreateOp(OP_eq);
+    
+    ia.
+    Append(idup).
+    Append(ipushnull).
+    Append(ieq).
+    Append(ijmpfalse).
+    Append(ipop).
+    Append(ib).
+    Append(ijmptarget);
     
     ijmpfalse->SetTarget(ijmptarget);
     
     return ia;
 }
 
-Instr* SliceExpr::GenerateCode()
+InstrList SliceExpr::GenerateCode()
 {
     /*
      * The slice operator (expr[from..to]), grabs the function 'opSlice' from
@@ -1830,27 +1789,27 @@ Instr* SliceExpr::GenerateCode()
      * [ from to expr expr.opSlice ]    call expr.opSlice( from, to )
      * [ result ]
      */
-    Instr* iexpr   = expr->GenerateCode();
-    Instr* ifrom   = (from) ? from->GenerateCode() : state->CreateOp(OP_pushnull);
-    Instr* ito     = (to)   ? to->GenerateCode()   : state->CreateOp(OP_pushnull);
-    Instr* icall   = state->CreateOp(OP_call);
-    Instr* idup    = state->CreateOp(OP_dup); // duplicate iexpr
-    Instr* islice  = slicefun->GenerateCode();
-    Instr* idotget = state->CreateOp(OP_dotget);
-    
-    ifrom->
-    Attach(ito)->
-    Attach(iexpr)->
-    Attach(idup)->
-    Attach(islice)->
-    Attach(idotget)->
-    Attach(icall);
+    InstrList iexpr   = expr->GenerateCode();
+    InstrList ifrom   = (from) ? from->GenerateCode() : state->CreateOp(OP_pushnull);
+    InstrList ito     = (to)   ? to->GenerateCode()   : state->CreateOp(OP_pushnull);
+    Instr*    icall   = state->CreateOp(OP_call);
+    Instr*    idup    = state->CreateOp(OP_dup); // duplicate iexpr
+    InstrList islice  = slicefun->GenerateCode();
+    Instr*    idotget = state->CreateOp(OP_dotget);
+    
+    ifrom.
+    Append(ito).
+    Append(iexpr).
+    Append(idup).
+    Append(islice).
+    Append(idotget).
+    Append(icall);
     
     icall->operand = 2;
     return ifrom;
 }
 
-Instr* DeclarationTarget::GenerateCodeSet()
+InstrList DeclarationTarget::GenerateCodeSet()
 {
     if (with)
     {
@@ -1872,34 +1831,34 @@ Instr* DeclarationTarget::GenerateCodeSet()
         isetLocal->target = state->endOfBlock;
         return isetLocal;
     }
-    return 0;
+    return InstrList();
 }
 
-Instr* NamedTarget::GenerateAnnotationCode(Instr* subj)
+InstrList NamedTarget::GenerateAnnotationCode(InstrList subj)
 {
     if (annotations)
         return annotations->GenerateCodeWith(subj);    
     return subj;
 }
 
-Instr* PropertyDecl::GeneratePropertyCode()
+InstrList PropertyDecl::GeneratePropertyCode()
 {
     Instr* iprop = state->CreateOp(OP_property);
     
-    Instr* iname   = (name_expr) ? name_expr->GenerateCode() : state->CreateOp(OP_pushnull);
-    Instr* igetter = (getter)    ? getter->GenerateCode()    : state->CreateOp(OP_pushnull);
-    Instr* isetter = (setter)    ? setter->GenerateCode()    : state->CreateOp(OP_pushnull);
+    InstrList iname   = (name_expr) ? name_expr->GenerateCode() : state->CreateOp(OP_pushnull);
+    InstrList igetter = (getter)    ? getter->GenerateCode()    : state->CreateOp(OP_pushnull);
+    InstrList isetter = (setter)    ? setter->GenerateCode()    : state->CreateOp(OP_pushnull);
     
-    iname->line   = (name_expr) ? name_expr->line : line;
-    isetter->line = (setter)    ? setter->line    : line;
-    igetter->line = (getter)    ? getter->line    : line;
+    iname.head->line   = (name_expr) ? name_expr->line : line;
+    isetter.head->line = (setter)    ? setter->line    : line;
+    igetter.head->line = (getter)    ? getter->line    : line;
     
-    if (isetter->line >= igetter->line)
+    if (isetter.head->line >= igetter.head->line)
     {
-        iname->
-        Attach(igetter)->
-        Attach(isetter)->
-        Attach(iprop)
+        iname.
+        Append(igetter).
+        Append(isetter).
+        Append(iprop)
         ;
     }
     else
@@ -1912,30 +1871,30 @@ Instr* PropertyDecl::GeneratePropertyCode()
          * OP_property recieves its name | getter | setter in the correct order.
          */
         Instr* iswap = state->CreateOp(OP_swap);
-        iname->
-        Attach(isetter)->
-        Attach(igetter)->
-        Attach(iswap)->
-        Attach(iprop)
+        iname.
+        Append(isetter).
+        Append(igetter).
+        Append(iswap).
+        Append(iprop)
         ;
     }    
     return iname;
 }
 
-Instr* PropertyDecl::GenerateCode()
+InstrList PropertyDecl::GenerateCode()
 {
-    Instr* prop = GeneratePropertyCode();
-    Instr* annotations = GenerateAnnotationCode(prop);
-    Instr* set = NamedTarget::GenerateCodeSet();    
+    InstrList prop = GeneratePropertyCode();
+    InstrList annotations = GenerateAnnotationCode(prop);
+    InstrList set = NamedTarget::GenerateCodeSet();    
     
-    annotations->
-    Attach(set);
+    annotations.
+    Append(set);
     return annotations;
 }
 
-Instr* AssignmentStmt::DoStmtCodeGen()
+InstrList AssignmentStmt::DoStmtCodeGen()
 {
-    Instr*    assgn = state->CreateOp(OP_nop);
+    InstrList assgn = state->CreateOp(OP_nop);
     ReverseExprList(&right); // Reverse the list so everything is in the correct order for assignment.
     
     ExprList* curr  = right;
@@ -1948,11 +1907,11 @@ Instr* AssignmentStmt::DoStmtCodeGen()
          * We want to unpack the right hand operand and then assign those values to the
          * left hand operands.
          */
-        Instr* iright    = right->expr->GenerateCode();
-        Instr* iunpack   = state->CreateOp(OP_unpack);
-        iunpack->operand = unpackCount;
+        InstrList iright  = right->expr->GenerateCode();
+        Instr*    iunpack = state->CreateOp(OP_unpack);
+        iunpack->operand  = unpackCount;
         
-        assgn->Attach(iright)->Attach(iunpack);
+        assgn.Append(iright).Append(iunpack);
     }
     else
     {
@@ -1965,13 +1924,14 @@ Instr* AssignmentStmt::DoStmtCodeGen()
             
             while (curr && lcurr)
             {
-                Instr* irep  = curr->expr->GenerateCode();
-                Instr* ilrep = lcurr->expr->GenerateCode();
-                Instr* iop   = state->CreateOp(oc);
+                InstrList irep  = curr->expr->GenerateCode();
+                InstrList ilrep = lcurr->expr->GenerateCode();
+                Instr*    iop   = state->CreateOp(oc);
                 
-                assgn->Attach(ilrep);
-                ilrep->Attach(irep);
-                irep->Attach(iop);
+                assgn.
+                Append(ilrep).
+                Append(irep).
+                Append(iop);
                 
                 curr  = curr->next;
                 lcurr = lcurr->next;
@@ -1983,8 +1943,8 @@ Instr* AssignmentStmt::DoStmtCodeGen()
         {
             while (curr)
             {
-                Instr* irep = curr->expr->GenerateCode();
-                assgn->Attach(irep);
+                InstrList irep = curr->expr->GenerateCode();
+                assgn.Append(irep);
                 curr = curr->next;
             }
         }
@@ -2004,35 +1964,35 @@ Instr* AssignmentStmt::DoStmtCodeGen()
             Expr::Kind k = curr->expr->kind;
             if (k == Expr::EXPR_identifier)
             {
-                IdExpr* ide  = (IdExpr*)curr->expr;
-                Instr*  iget = ide->GenerateCode();
-                Instr*  iop  = state->CreateOp(oc);
-                Instr*  iswap  = state->CreateOp(OP_swap);
-                Instr*  irep = ide->GenerateCodeSet();
+                IdExpr*   ide   = (IdExpr*)curr->expr;
+                InstrList iget  = ide->GenerateCode();
+                Instr*    iop   = state->CreateOp(oc);
+                Instr*    iswap = state->CreateOp(OP_swap);
+                InstrList irep  = ide->GenerateCodeSet();
                 
-                iget->
-                Attach(iswap)->
-                Attach(iop)->
-                Attach(irep)
+                iget.
+                Append(iswap).
+                Append(iop).
+                Append(irep)
                 ;
                 
-                assgn->Attach(iget);
+                assgn.Append(iget);
             }
             else if (k == Expr::EXPR_dot)
             {
-                DotExpr*ide  = (DotExpr*)curr->expr;
-                Instr*  iget = ide->GenerateCode();
-                Instr*  iswap  = state->CreateOp(OP_swap);
-                Instr*  iop  = state->CreateOp(oc);
-                Instr*  irep = ide->GenerateCodeSet();
+                DotExpr*  ide   = (DotExpr*)curr->expr;
+                InstrList iget  = ide->GenerateCode();
+                Instr*    iswap = state->CreateOp(OP_swap);
+                Instr*    iop   = state->CreateOp(oc);
+                InstrList irep  = ide->GenerateCodeSet();
                 
-                iget->Attach(iswap)->Attach(iop)->Attach(irep);
-                assgn->Attach(iget);
+                iget.Append(iswap).Append(iop).Append(irep);
+                assgn.Append(iget);
             }
             else if (k == Expr::EXPR_load)
             {
                 Instr* ipop = state->CreateOp(OP_pop);
-                assgn->Attach(ipop);
+                assgn.Append(ipop);
             }
             else
             {
@@ -2048,20 +2008,20 @@ Instr* AssignmentStmt::DoStmtCodeGen()
             Expr::Kind k = curr->expr->kind;
             if (k == Expr::EXPR_identifier)
             {
-                IdExpr* ide = (IdExpr*)curr->expr;
-                Instr* irep = ide->GenerateCodeSet();
-                assgn->Attach(irep);
+                IdExpr*   ide  = (IdExpr*)curr->expr;
+                InstrList irep = ide->GenerateCodeSet();
+                assgn.Append(irep);
             }
             else if (k == Expr::EXPR_dot)
             {
-                DotExpr* ide = (DotExpr*)curr->expr;
-                Instr* irep = ide->GenerateCodeSet();
-                assgn->Attach(irep);
+                DotExpr*  ide  = (DotExpr*)curr->expr;
+                InstrList irep = ide->GenerateCodeSet();
+                assgn.Append(irep);
             }
             else if (k == Expr::EXPR_load)
             {
                 Instr* ipop = state->CreateOp(OP_pop);
-                assgn->Attach(ipop);
+                assgn.Append(ipop);
             }
             else
             {
@@ -2083,7 +2043,7 @@ Instr* AssignmentStmt::DoStmtCodeGen()
     return assgn;
 }
 
-Instr* FinallyStmt::DoStmtCodeGen()
+InstrList FinallyStmt::DoStmtCodeGen()
 {
     /*
      * There are 3 situations we want to deal with.
@@ -2132,24 +2092,22 @@ Instr* FinallyStmt::DoStmtCodeGen()
      *      raise
      * finished:
      */
-    Instr* ibegin     = state->CreateOp(OP_nop);
-    Instr* iblock     = block ? block->GenerateCode() : state->CreateOp(OP_nop);
-    Instr* iretfinally = state->CreateOp(OP_retfinally);
+    InstrList ibegin      = state->CreateOp(OP_nop);
+    InstrList iblock      = block ? block->GenerateCode() : state->CreateOp(OP_nop);
+    Instr*    iretfinally = state->CreateOp(OP_retfinally);
     
     PIKA_BLOCKSTART(state, iretfinally);
     // START BLOCK----------------------------------------------------------------------------------
     
-    Instr* ifinalize_block = finalize_block ? finalize_block->GenerateCode() : state->CreateOp(OP_nop);
+    InstrList ifinalize_block = finalize_block ? finalize_block->GenerateCode() : state->CreateOp(OP_nop);
     
     if (block->kind == Stmt::STMT_with)
     {
-        Instr* ientry = ((UsingStmt*)block)->DoHeader();
-        ientry->Attach(ibegin);
-        ibegin = ientry;
+        InstrList ientry = ((UsingStmt*)block)->DoHeader();
+        ibegin.Prepend(ientry);
         
         Instr* ipopwith = state->CreateOp(OP_popwith);
-        ipopwith->Attach(ifinalize_block);
-        ifinalize_block = ipopwith;
+        ifinalize_block.Prepend(ipopwith);
     }
     
     // END BLOCK------------------------------------------------------------------------------------
@@ -2163,35 +2121,37 @@ Instr* FinallyStmt::DoStmtCodeGen()
     Instr* invoke_finally = state->CreateOp(OP_callfinally);
     Instr* reraise       = state->CreateOp(OP_raise);
     
-    ibegin->
-    Attach(ipushfinally)->
-    Attach(iblock)->
-    Attach(ipopfinally)->
-    Attach(icallfinally)->       // stack call -> pop finally
-    Attach(ijmptoend)->
-    Attach(ifinalize_block)->
-    Attach(iretfinally)->        // jsr
-    Attach(invoke_finally)->
-    Attach(reraise)->
-    Attach(ifinished);
+    Instr* ifinalize = ifinalize_block.head;
+    
+    ibegin.
+    Append(ipushfinally).
+    Append(iblock).
+    Append(ipopfinally).
+    Append(icallfinally).        // stack call -> pop finally
+    Append(ijmptoend).
+    Append(ifinalize_block).
+    Append(iretfinally).         // jsr
+    Append(invoke_finally).
+    Append(reraise).
+    Append(ifinished);
     
     ipushfinally->SetTarget(invoke_finally);
-    invoke_finally->SetTarget(ifinalize_block);
-    icallfinally->SetTarget(ifinalize_block);
+    invoke_finally->SetTarget(ifinalize);
+    icallfinally->SetTarget(ifinalize);
     ijmptoend->SetTarget(ifinished);
     
     FinallyBlockBreaks(state,
-                       ibegin,          // Start of the block.
-                       ifinalize_block,  // End of the block.
-                       ifinalize_block); // Target for OP_callfinally, the beginning of the finally block.
+                       ibegin.head, // Start of the block.
+                       ifinalize,   // End of the block.
+                       ifinalize);  // Target for OP_callfinally, the beginning of the finally block.
 
     ErrorYieldInFinally(state,
-                    ifinalize_block,
+                    ifinalize,
                     iretfinally,
                     line);
 #if defined(ENABLE_SYNTAX_WARNINGS)                      
     WarnNonLocalJumps(state,
-                      ifinalize_block,
+                      ifinalize,
                       iretfinally,
                       line);
 #endif
@@ -2215,25 +2175,25 @@ INLINE VarDecl* ReverseDeclarations(VarDecl** l)
     return *l;
 }
 
-Instr* VariableTarget::GenerateCode()
+InstrList VariableTarget::GenerateCode()
 {
-    Instr* assgn = state->CreateOp(OP_nop);
+    InstrList assgn = state->CreateOp(OP_nop);
     ExprList* curr = exprs;
     
     if (isUnpack && !isCall)
     {
-        Instr* iright = curr->expr->GenerateCode();
-        Instr* iunpack = state->CreateOp(OP_unpack);
-        iunpack->operand = unpackCount;
+        InstrList iright  = curr->expr->GenerateCode();
+        Instr*    iunpack = state->CreateOp(OP_unpack);
+        iunpack->operand  = unpackCount;
         
-        assgn->Attach(iright)->Attach(iunpack);
+        assgn.Append(iright).Append(iunpack);
     }
     else
     {
         while (curr)
         {
-            Instr* irep = curr->expr->GenerateCode();
-            assgn->Attach(irep);
+            InstrList irep = curr->expr->GenerateCode();
+            assgn.Append(irep);
             curr = curr->next;
         }
     }
@@ -2252,8 +2212,8 @@ Instr* VariableTarget::GenerateCode()
             with      = curr_decl->symbol->isWith;
             nameindex = curr_decl->nameIndex;
         
-            Instr* iset = GenerateCodeSet();
-            assgn->Attach(iset);
+            InstrList iset = GenerateCodeSet();
+            assgn.Append(iset);
         } else {
             /* 
                Otherwise, the curr_decl was not specified (null was used). This
@@ -2265,7 +2225,7 @@ Instr* VariableTarget::GenerateCode()
                a, null, b, c = 1, 2, 3, 4
              */
             Instr* ipop = state->CreateOp(OP_pop);
-            assgn->Attach(ipop);
+            assgn.Append(ipop);
         }
         curr_decl = curr_decl->next;
     }
@@ -2274,16 +2234,16 @@ Instr* VariableTarget::GenerateCode()
     return assgn;
 }
 
-Instr* UsingStmt::DoHeader()
+InstrList UsingStmt::DoHeader()
 {
-    Instr* iwith = with->GenerateCode();
+    InstrList iwith = with->GenerateCode();
     Instr* ipushwith = state->CreateOp(OP_pushwith);
-    iwith->
-    Attach(ipushwith);
+    iwith.
+    Append(ipushwith);
     return iwith;
 }
 
-Instr* UsingStmt::DoStmtCodeGen()
+InstrList UsingStmt::DoStmtCodeGen()
 {
     // A <using> statement is always wrapped inside of an finally block.
     // The finally-block will handle any cleanup required even from a return / break / or continue.
@@ -2291,11 +2251,11 @@ Instr* UsingStmt::DoStmtCodeGen()
     Instr* ipopwith = state->CreateOp(OP_nop);
     
     PIKA_BLOCKSTART(state, ipopwith);
-    Instr* iblock = block->GenerateCode();
+    InstrList iblock = block->GenerateCode();
     PIKA_BLOCKEND(state);
     
-    iblock->
-    Attach(ipopwith);
+    iblock.
+    Append(ipopwith);
     
     /*HandleBlockBreaks(state,iblock,
                       ipopwith,
@@ -2303,39 +2263,38 @@ Instr* UsingStmt::DoStmtCodeGen()
     return iblock;
 }
 
-Instr* PkgDecl::GenerateCode()
+InstrList PkgDecl::GenerateCode()
 {
-    Instr* insideof  = name->GetSelfExpr() ? name->GetSelfExpr()->GenerateCode() : state->CreateOp(OP_pushnull);
-    Instr* ipkgname  = id->GenerateCode();
-    Instr* ipush_pkg = state->CreateOp(OP_pushpkg);
-    Instr* inew_pkg  = state->CreateOp(OP_newpkg);
-    Instr* ipop_pkg  = state->CreateOp(OP_poppkg);
+    InstrList insideof  = name->GetSelfExpr() ? name->GetSelfExpr()->GenerateCode() : state->CreateOp(OP_pushnull);
+    InstrList ipkgname  = id->GenerateCode();
+    Instr*    ipush_pkg = state->CreateOp(OP_pushpkg);
+    Instr*    inew_pkg  = state->CreateOp(OP_newpkg);
+    Instr*    ipop_pkg  = state->CreateOp(OP_poppkg);
     
     PIKA_BLOCKSTART(state, ipop_pkg);
-    Instr* ibody = body->GenerateCode();
+    InstrList ibody = body->GenerateCode();
     PIKA_BLOCKEND(state);
     
-    Instr* iassign = NamedTarget::GenerateCodeSet();
-    Instr* idup    = state->CreateOp(OP_dup);
-    //Instr* annotations   = GenerateAnnotationCode();
+    InstrList iassign = NamedTarget::GenerateCodeSet();
+    Instr*    idup    = state->CreateOp(OP_dup);
     
-    ipkgname         ->
-    Attach(insideof) ->
-    Attach(inew_pkg) 
+    ipkgname         .
+    Append(insideof) .
+    Append(inew_pkg) 
     ;
     
     ipkgname = GenerateAnnotationCode(ipkgname);
     
-    ipkgname->
-    Attach(idup)     -> // duplicate it     
-    Attach(iassign)  -> // set the variable
-    Attach(ipush_pkg)-> // enter package scope
-    Attach(ibody)    -> // execute body
-    Attach(ipop_pkg)    // exit package scope
+    ipkgname.
+    Append(idup)     . // duplicate it     
+    Append(iassign)  . // set the variable
+    Append(ipush_pkg). // enter package scope
+    Append(ibody)    . // execute body
+    Append(ipop_pkg)   // exit package scope
     ;
     
     HandleBlockBreaks(state,
-                      ibody,
+                      ibody.head,
                       ipop_pkg,
                       OP_poppkg,
                       true);
@@ -2345,7 +2304,7 @@ Instr* PkgDecl::GenerateCode()
 
 // NameNode ////////////////////////////////////////////////////////////////////////////////////////
 
-Instr* NameNode::GenerateCode()
+InstrList NameNode::GenerateCode()
 {
     if (idexpr)
     {
@@ -2356,10 +2315,10 @@ Instr* NameNode::GenerateCode()
         return dotexpr->GenerateCode();
     }
     SHOULD_NEVER_HAPPEN();
-    return 0;
+    return InstrList();
 }
 
-Instr* NameNode::GenerateCodeSet()
+InstrList NameNode::GenerateCodeSet()
 {
     if (idexpr)
     {
@@ -2370,53 +2329,53 @@ Instr* NameNode::GenerateCodeSet()
         return dotexpr->GenerateCodeSet();
     }
     SHOULD_NEVER_HAPPEN();
-    return 0;
+    return InstrList();
 }
 
-Instr* ClassDecl::GenerateCode()
+InstrList ClassDecl::GenerateCode()
 {
     Opcode const popcode = OP_poppkg;
     Opcode const pushcode = OP_pushpkg;
-    Instr* insideof  = name->GetSelfExpr() ? name->GetSelfExpr()->GenerateCode() : state->CreateOp(OP_pushnull);
-    Instr* exitWith  = state->CreateOp(popcode);
-    Instr* typeName  = stringid->GenerateCode();
-    Instr* enterWith = state->CreateOp(pushcode);
-    Instr* newType   = state->CreateOp(OP_subclass);
-    Instr* superType = super ? super->GenerateCode() : state->CreateOp(OP_pushnull);
-    Instr* metaType  = meta  ? meta->GenerateCode()  : state->CreateOp(OP_pushnull);
+    InstrList insideof  = name->GetSelfExpr() ? name->GetSelfExpr()->GenerateCode() : state->CreateOp(OP_pushnull);
+    Instr*    exitWith  = state->CreateOp(popcode);
+    InstrList typeName  = stringid->GenerateCode();
+    Instr*    enterWith = state->CreateOp(pushcode);
+    Instr*    newType   = state->CreateOp(OP_subclass);
+    InstrList superType = super ? super->GenerateCode() : state->CreateOp(OP_pushnull);
+    InstrList metaType  = meta  ? meta->GenerateCode()  : state->CreateOp(OP_pushnull);
     
     Instr* dup = state->CreateOp(OP_dup);
     
     PIKA_BLOCKSTART(state, exitWith);
     
-    Instr* doStmts = stmts->GenerateCode();
+    InstrList doStmts = stmts->GenerateCode();
     
     PIKA_BLOCKEND(state);
     
-    Instr* iassign = NamedTarget::GenerateCodeSet();
+    InstrList iassign = NamedTarget::GenerateCodeSet();
     
-    typeName         ->
-    Attach(insideof) -> // Push the literal contains the typename.
-    Attach(superType)-> // Push the result of the super expression.
-    Attach(metaType)->  // Push the meta type.
-    Attach(newType)     // Create a new Type from the super and typename given.
+    typeName         .
+    Append(insideof) . // Push the literal contains the typename.
+    Append(superType). // Push the result of the super expression.
+    Append(metaType).  // Push the meta type.
+    Append(newType)    // Create a new Type from the super and typename given.
     ;
     // Generate the code for annotations, which will use the Type we create
     // as a argument.
-    insideof = GenerateAnnotationCode(insideof);
+    typeName = GenerateAnnotationCode(typeName);
     
     
-    insideof         ->
-    Attach(dup)      -> // Need two copies one to assign the variable, the other to set up a pkg scope.
-    Attach(iassign)  -> // Assign: We need to do this encase there are any
-                        //         references to it in the class body.
-    Attach(enterWith)-> // Enter a with frame using the Type.
-    Attach(doStmts)  -> // Execute the class body.
-    Attach(exitWith);   // Exit the with block.
+    typeName         .
+    Append(dup)      . // Need two copies one to assign the variable, the other to set up a pkg scope.
+    Append(iassign)  . // Assign: We need to do this encase there are any
+                       //         references to it in the class body.
+    Append(enterWith). // Enter a with frame using the Type.
+    Append(doStmts)  . // Execute the class body.
+    Append(exitWith);  // Exit the with block.
     
     // Handle any breaks out of the with block.
     HandleBlockBreaks(state,
-                      doStmts,
+                      doStmts.head,
                       exitWith,
                       popcode,
                       true);
@@ -2424,7 +2383,7 @@ Instr* ClassDecl::GenerateCode()
     return typeName;
 }
 
-Instr* ParenExpr::GenerateCode()
+InstrList ParenExpr::GenerateCode()
 {
     return expr->GenerateCode();
 }
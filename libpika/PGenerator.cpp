@@ -90,8 +90,9 @@ void Generator::Return()
 
 Object* Generator::Clone()
 {
+    GCPAUSE_NORUN(engine); // The copy constructor allocates environments that only gen references.
     Generator* gen = 0;
-    PIKA_NEW(Generator, gen, (this));
+    GCALLOC(engine, Generator, gen, (this));
     engine->AddToGCNoRun(gen);
     return gen;
 }
@@ -167,7 +168,7 @@ void Generator::Constructor(Engine* eng, Type* type, Value& res)
 Generator* Generator::Create(Engine* eng, Type* type, Function* function)
 {
     Generator* gen = 0;
-    PIKA_NEW(Generator, gen, (eng, type, function));
+    GCALLOC(eng, Generator, gen, (eng, type, function));
     eng->AddToGCNoRun(gen);
     return gen;
 }
@@ -306,7 +307,7 @@ It will be one of the following values:\n\
 
 int Generator_state(Context* ctx, Value& self)
 {
-    Generator* gen = static_cast<Generator*>(self.val.object);
+    Generator* gen = static_cast<Generator*>(self.GetObject());
     ctx->Push((pint_t)gen->GetState());
     return 1;
 }
@@ -316,7 +317,7 @@ PIKA_DOC(Generator_function, "The [Function function] this generator is using.")
 
 int Generator_function(Context* ctx, Value& self)
 {
-    Generator* gen = static_cast<Generator*>(self.val.object);
+    Generator* gen = static_cast<Generator*>(self.GetObject());
     Function* func = gen->GetFunction();
     if (func)
         ctx->Push(func);
@@ -335,7 +336,7 @@ If values returned are from a '''return''' statement [toBoolean] will be '''fals
 
 int Generator_next(Context* ctx, Value& self)
 {
-    Generator* gen = static_cast<Generator*>(self.val.object);
+    Generator* gen = static_cast<Generator*>(self.GetObject());
     ctx->PushNull();
     ctx->Push(gen);
     u4 retc = ctx->GetRetCount();
@@ -0,0 +1,119 @@
+/*
+ *  PHashGroup.h
+ *  See Copyright Notice in Pika.h
+ */
+#ifndef PIKA_HASHGROUP_HEADER
+#define PIKA_HASHGROUP_HEADER
+
+/* Helpers shared by the open addressed hash tables, Table and StringTable. Each slot has a 
+ * control byte that is Table::CTRL_EMPTY, Table::CTRL_DELETED or the low 7 bits of the mixed 
+ * hash code. Control bytes are probed Table::GROUP_WIDTH at a time. 
+ */
+
+#ifndef PIKA_TABLE_HEADER
+#   include "PTable.h"
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define PIKA_TABLE_SSE2
+#   include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace pika {
+
+/* Mixes the bits of a hashcode so that keys with similar bit patterns, like small integers and 
+ * aligned pointers, are spread over the entire table. The low 7 bits are stored in the control
+ * byte and the remaining bits select the group a probe starts at. */
+#if defined(PIKA_64)
+INLINE size_t Pika_MixHash(u8 x)
+{
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return (size_t)x;
+}
+#else
+INLINE size_t Pika_MixHash(u8 X)
+{
+    u4 x = (u4)X ^ (u4)(X >> 32);
+    x ^= x >> 16;
+    x *= 0x85EBCA6B;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35;
+    x ^= x >> 16;
+    return (size_t)x;
+}
+#endif
+
+INLINE u4 Pika_CountTrailingZeros(u4 bits)
+{
+#if defined(__GNUC__)
+    return (u4)__builtin_ctz(bits);
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, bits);
+    return (u4)idx;
+#else
+    u4 n = 0;
+    while (!(bits & 1))
+    {
+        bits >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/* Returns a mask with bit i set if the control byte group[i] equals h. */
+INLINE u4 Pika_GroupMatch(const u1* group, u1 h)
+{
+#if defined(PIKA_TABLE_SSE2)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (u4)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)h)));
+#else
+    u4 bits = 0;
+    for (u4 i = 0; i < Table::GROUP_WIDTH; ++i)
+    {
+        if (group[i] == h)
+            bits |= 1 << i;
+    }
+    return bits;
+#endif
+}
+
+/* Returns a mask with bit i set if the control byte group[i] is empty or deleted. */
+INLINE u4 Pika_GroupMatchFree(const u1* group)
+{
+#if defined(PIKA_TABLE_SSE2)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    u4 special   = (u4)_mm_movemask_epi8(ctrl);
+    u4 unused    = (u4)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)Table::CTRL_UNUSED)));
+    return special & ~unused;
+#else
+    u4 bits = 0;
+    for (u4 i = 0; i < Table::GROUP_WIDTH; ++i)
+    {
+        if (group[i] == Table::CTRL_EMPTY || group[i] == Table::CTRL_DELETED)
+            bits |= 1 << i;
+    }
+    return bits;
+#endif
+}
+
+/* Does the control byte belong to a slot in use. */
+INLINE bool Pika_CtrlIsFull(u1 c) { return c < Table::CTRL_EMPTY; }
+
+INLINE size_t Pika_GroupMask(size_t capacity)
+{
+    return capacity > Table::GROUP_WIDTH ? (capacity / Table::GROUP_WIDTH) - 1 : 0;
+}
+
+}// pika
+
+#endif
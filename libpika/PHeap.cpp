@@ -0,0 +1,317 @@
+/*
+ *  PHeap.cpp
+ *  See Copyright Notice in Pika.h
+ */
+#include "Pika.h"
+#include "PPlatform.h"
+
+namespace pika {
+
+namespace {
+
+INLINE size_t HeaderSize() { return (sizeof(Heap::Page) + Heap::GRANULE - 1) & ~((size_t)Heap::GRANULE - 1); }
+
+}// namespace
+
+Heap::Heap() : pageMap(0), collector(0), mapSize(0), numPages(0), bytesInUse(0), bytesAllocated(0), bytesFreed(0)
+{
+    for (size_t i = 0; i < NUM_CLASSES; ++i)
+        avail[i] = 0;
+}
+
+Heap::~Heap()
+{
+    for (size_t i = 0; i < mapSize; ++i)
+    {
+        if (pageMap[i])
+            Pika_FreePages(pageMap[i], pageMap[i]->size);
+    }
+    Pika_free(pageMap);
+}
+
+size_t Heap::MediumClass(size_t sz)
+{
+    // Four classes for every doubling: split [2^b, 2^(b+1)) into quarters.
+    size_t s = sz - 1;
+    size_t b = 10;
+    while (s >> (b + 1))
+        ++b;
+    return SMALL_SIZE / GRANULE + (b - 10) * 4 + ((s >> (b - 2)) & 3);
+}
+
+size_t Heap::ClassSize(size_t sizeClass)
+{
+    if (sizeClass < SMALL_SIZE / GRANULE)
+        return (sizeClass + 1) * GRANULE;
+
+    size_t medium = sizeClass - SMALL_SIZE / GRANULE;
+    return (5 + medium % 4) << (medium / 4 + 8);
+}
+
+Heap::Page* Heap::FirstFree(size_t sizeClass)
+{
+    // Skip over full pages at the front of the list.
+    Page* page = avail[sizeClass];
+
+    while (page && !page->freeList && page->bump >= page->end)
+    {
+        UnlinkPage(page);
+        page = avail[sizeClass];
+    }
+    return page;
+}
+
+void* Heap::AllocateSlow(size_t sizeClass)
+{
+    Page* page = FirstFree(sizeClass);
+
+    if (!page && collector && collector->SweepClass(sizeClass))
+        page = FirstFree(sizeClass);
+
+    if (!page)
+    {
+        page = NewPage(sizeClass, PAGE_SIZE, ClassSize(sizeClass));
+        if (!page)
+            RaiseException("Heap::Allocate memory allocation failed.");
+        LinkPage(page);
+    }
+    return AllocateFrom(page);
+}
+
+void* Heap::LargeAllocate(size_t sz)
+{
+    size_t size = (HeaderSize() + sz + PAGE_SIZE - 1) & ~((size_t)PAGE_SIZE - 1);
+    if (size < sz)
+        RaiseException("Heap::Allocate memory allocation failed.");
+
+    Page* page = NewPage(LARGE_CLASS, size, size - HeaderSize());
+    if (!page)
+        RaiseException("Heap::Allocate memory allocation failed.");
+    return AllocateFrom(page);
+}
+
+void Heap::Free(void* v)
+{
+    if (!v)
+        return;
+
+    Page* page = PageOf(v);
+    Cell* cell = (Cell*)v;
+
+    ClearObject(v);
+
+    if (page->sizeClass == LARGE_CLASS)
+    {
+        bytesInUse -= page->cellSize;
+        bytesFreed += page->cellSize;
+        FreePage(page);
+        return;
+    }
+
+    cell->next = page->freeList;
+    page->freeList = cell;
+    --page->live;
+    bytesInUse -= page->cellSize;
+    bytesFreed += page->cellSize;
+
+    if (!page->available)
+        LinkPage(page);
+}
+
+bool Heap::Owns(const void* v) const
+{
+    if (!numPages)
+        return false;
+
+    Page* page = PageOf(v);
+    for (size_t i = MapIndex(page); pageMap[i]; i = (i + 1) & (mapSize - 1))
+    {
+        if (pageMap[i] == page)
+            return true;
+    }
+    return false;
+}
+
+void Heap::ReleaseEmptyPages()
+{
+    for (size_t i = 0; i < NUM_CLASSES; ++i)
+    {
+        Page* page = avail[i];
+        while (page)
+        {
+            Page* next = page->next;
+
+            // Keep the page we are allocating from.
+            if (!page->live && page != avail[i])
+            {
+                UnlinkPage(page);
+                FreePage(page);
+            }
+            page = next;
+        }
+    }
+}
+
+void Heap::ClearMarks()
+{
+    for (size_t i = 0; i < mapSize; ++i)
+    {
+        if (Page* page = pageMap[i])
+            Pika_memzero(page->marks, sizeof(page->marks));
+    }
+}
+
+void Heap::GetPages(Page** pages) const
+{
+    for (size_t i = 0; i < mapSize; ++i)
+    {
+        if (pageMap[i])
+            *pages++ = pageMap[i];
+    }
+}
+
+bool Heap::SetMarkedAtomic(const void* v)
+{
+    size_t bit  = BitOf(v);
+    u4*    word = &PageOf(v)->marks[bit / 32];
+    u4     mask = 1u << (bit % 32);
+    for (;;)
+    {
+        u4 curr = *(volatile u4*)word;
+        if (curr & mask)
+            return false;
+        if (Pika_CompareAndSwap(word, curr, curr | mask))
+            return true;
+    }
+}
+
+Heap::Page* Heap::NewPage(size_t sizeClass, size_t size, size_t cellSize)
+{
+    // Make room in the map first so that a failure cannot leak the page.
+    if ((numPages + 1) * 2 > mapSize)
+        GrowMap();
+
+    Page* page = (Page*)Pika_AllocPages(size);
+    if (!page)
+        return 0;
+
+    size_t numCells = (size - HeaderSize()) / cellSize;
+
+    page->next      = 0;
+    page->prev      = 0;
+    page->freeList  = 0;
+    page->bump      = (char*)page + HeaderSize();
+    page->end       = page->bump + numCells * cellSize;
+    page->size      = size;
+    page->cellSize  = cellSize;
+    page->live      = 0;
+    page->sizeClass = (u4)sizeClass;
+    page->available = false;
+    Pika_memzero(page->objects, sizeof(page->objects));
+    Pika_memzero(page->marks,   sizeof(page->marks));
+
+    AddToMap(page);
+    return page;
+}
+
+void Heap::FreePage(Page* page)
+{
+    RemoveFromMap(page);
+    Pika_FreePages(page, page->size);
+}
+
+void Heap::LinkPage(Page* page)
+{
+    // Pages are added to the front so that recently freed cells are reused first.
+    Page*& head = avail[page->sizeClass];
+    page->prev = 0;
+    page->next = head;
+    if (head)
+        head->prev = page;
+    head = page;
+    page->available = true;
+}
+
+void Heap::UnlinkPage(Page* page)
+{
+    if (page->prev)
+        page->prev->next = page->next;
+    else
+        avail[page->sizeClass] = page->next;
+
+    if (page->next)
+        page->next->prev = page->prev;
+
+    page->next = page->prev = 0;
+    page->available = false;
+}
+
+void Heap::AddToMap(Page* page)
+{
+    // Keep the load factor at or below one half.
+    if ((numPages + 1) * 2 > mapSize)
+        GrowMap();
+
+    size_t i = MapIndex(page);
+    while (pageMap[i])
+        i = (i + 1) & (mapSize - 1);
+
+    pageMap[i] = page;
+    ++numPages;
+}
+
+void Heap::RemoveFromMap(Page* page)
+{
+    size_t i = MapIndex(page);
+    while (pageMap[i] != page)
+        i = (i + 1) & (mapSize - 1);
+
+    pageMap[i] = 0;
+    --numPages;
+
+    // Shift back any entries that would now be unreachable.
+    for (size_t j = (i + 1) & (mapSize - 1); pageMap[j]; j = (j + 1) & (mapSize - 1))
+    {
+        Page*  curr = pageMap[j];
+        size_t home = MapIndex(curr);
+
+        // Move curr into the hole unless its home lies cyclically within (i, j].
+        bool reachable = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (!reachable)
+        {
+            pageMap[i] = curr;
+            pageMap[j] = 0;
+            i = j;
+        }
+    }
+}
+
+void Heap::GrowMap()
+{
+    size_t  oldSize = mapSize;
+    Page**  oldMap  = pageMap;
+
+    mapSize = oldSize ? oldSize * 2 : 64;
+    pageMap = (Page**)Pika_calloc(mapSize, sizeof(Page*));
+
+    if (!pageMap)
+    {
+        mapSize = oldSize;
+        pageMap = oldMap;
+        RaiseException("Heap::GrowMap memory allocation failed.");
+    }
+
+    for (size_t i = 0; i < oldSize; ++i)
+    {
+        if (Page* page = oldMap[i])
+        {
+            size_t j = MapIndex(page);
+            while (pageMap[j])
+                j = (j + 1) & (mapSize - 1);
+            pageMap[j] = page;
+        }
+    }
+    Pika_free(oldMap);
+}
+
+}// pika
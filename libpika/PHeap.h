@@ -0,0 +1,238 @@
+/*
+ *  PHeap.h
+ *  See Copyright Notice in Pika.h
+ */
+#ifndef PIKA_HEAP_HEADER
+#define PIKA_HEAP_HEADER
+
+namespace pika {
+
+class Collector;
+
+// Heap /////////////////////////////////////////////////////////////////////////////////////////
+
+/** A page based heap with size classes. Used by the Engine to allocate GCObjects.
+  *
+  * Memory is requested from the OS in pages of PAGE_SIZE bytes, aligned to PAGE_SIZE. Each page
+  * holds cells of a single size class. Up to SMALL_SIZE bytes the size classes are multiples of
+  * GRANULE, above that there are four classes for every doubling up to MAX_CELL_SIZE. The header
+  * of the page holding a cell is found by masking the cell's address so freeing never needs to
+  * know the size of the allocation.
+  *
+  * Fresh pages are carved out with a bump pointer. Freed cells are pushed onto the free list of
+  * their page and reused first. While the Collector is sweeping, the pages of a size class it 
+  * has not reached yet are swept before a fresh page is taken. Pages that become completely 
+  * empty are returned to the OS by ReleaseEmptyPages.
+  *
+  * Allocations larger than MAX_CELL_SIZE get a page of their own, rounded up to a multiple of
+  * PAGE_SIZE, which is returned to the OS as soon as the allocation is freed.
+  *
+  * Every page header holds two bitmaps with one bit per GRANULE of the page. The Collector sets
+  * the object bit of each GCObject it manages and uses the mark bits in place of colors, so a
+  * GCObject needs no list links. Freeing a cell clears both of its bits.
+  *
+  * The heap counts the bytes it hands out and takes back, which the Collector uses to pace
+  * itself.
+  */
+class PIKA_API Heap
+{
+public:
+    enum
+    {
+        PAGE_SIZE     = 64 * 1024, //!< Size and alignment of a page.
+        GRANULE       = 16,        //!< Small size classes are multiples of this.
+        SMALL_SIZE    = 1024,      //!< Largest allocation with a size class per GRANULE.
+        MAX_CELL_SIZE = 16 * 1024, //!< Largest allocation that shares a page with others.
+        NUM_CLASSES   = SMALL_SIZE / GRANULE + 16,
+        LARGE_CLASS   = NUM_CLASSES, //!< sizeClass of a page holding a single large allocation.
+        BITMAP_WORDS  = PAGE_SIZE / GRANULE / 32,
+    };
+
+    struct Cell { Cell* next; };
+
+    /** Header at the start of every page. */
+    struct Page
+    {
+        Page*  next;       //!< Next page with free cells in the same size class.
+        Page*  prev;
+        Cell*  freeList;   //!< Freed cells.
+        char*  bump;       //!< First cell that has never been allocated.
+        char*  end;        //!< End of the last cell.
+        size_t size;       //!< Bytes reserved from the OS for the page.
+        size_t cellSize;
+        u4     live;       //!< Number of allocated cells.
+        u4     sizeClass;
+        bool   available;  //!< Is the page in its size class's list.
+        u4     objects[BITMAP_WORDS]; //!< Object bit of each cell, set by the Collector.
+        u4     marks[BITMAP_WORDS];   //!< Mark bit of each cell.
+    };
+
+    Heap();
+    ~Heap();
+
+    /** Allocates sz bytes aligned to GRANULE. */
+    INLINE void* Allocate(size_t sz)
+    {
+        size_t sizeClass;
+        if (sz <= SMALL_SIZE)
+            sizeClass = sz ? (sz - 1) / GRANULE : 0;
+        else if (sz <= MAX_CELL_SIZE)
+            sizeClass = MediumClass(sz);
+        else
+            return LargeAllocate(sz);
+
+        Page* page = avail[sizeClass];
+        if (page)
+        {
+            if (void* cell = AllocateFrom(page))
+                return cell;
+        }
+        return AllocateSlow(sizeClass);
+    }
+
+    /** Frees memory returned by Allocate. v must not come from anywhere else. */
+    void Free(void* v);
+
+    /** Destructs and frees an object allocated from this heap. */
+    template<typename T>
+    INLINE void Delete(T* t)
+    {
+        if (!t)
+            return;
+        Pika_destruct<T>(t);
+        Free((void*)t);
+    }
+
+    /** Returns the number of bytes reserved for v, which must have come from Allocate. */
+    INLINE static size_t SizeOf(const void* v) { return PageOf(v)->cellSize; }
+    
+    /** Returns true if v points into one of this heap's pages. */
+    bool Owns(const void* v) const;
+
+    /** Returns every empty page to the OS. */
+    void ReleaseEmptyPages();
+
+    /** Sets the Collector asked to sweep pages before a fresh one is taken, see 
+      * Collector::SweepClass. 
+      */
+    INLINE void SetCollector(Collector* c) { collector = c; }
+    
+    /** Clears the mark bit of every cell. */
+    void ClearMarks();
+
+    /** Stores a pointer to each page in pages, which must have room for GetNumPages entries. */
+    void GetPages(Page** pages) const;
+
+    INLINE static Page* PageOf(const void* v) { return (Page*)((size_t)v & ~((size_t)PAGE_SIZE - 1)); }
+
+    /** Index of the bit belonging to the cell at v. */
+    INLINE static size_t BitOf(const void* v) { return ((size_t)v & ((size_t)PAGE_SIZE - 1)) / GRANULE; }
+
+    /** Address of the cell whose bit is bit. */
+    INLINE static void* CellAt(Page* page, size_t bit) { return (char*)page + bit * GRANULE; }
+
+    INLINE static bool IsMarked(const void* v)
+    {
+        size_t bit = BitOf(v);
+        return (PageOf(v)->marks[bit / 32] & (1u << (bit % 32))) != 0;
+    }
+
+    /** Sets the mark bit of v. Returns false if it was already set. */
+    INLINE static bool SetMarked(const void* v)
+    {
+        size_t bit  = BitOf(v);
+        u4&    word = PageOf(v)->marks[bit / 32];
+        u4     mask = 1u << (bit % 32);
+        if (word & mask)
+            return false;
+        word |= mask;
+        return true;
+    }
+
+    /** SetMarked for use by several threads at once. */
+    static bool SetMarkedAtomic(const void* v);
+
+    INLINE static bool IsObject(const void* v)
+    {
+        size_t bit = BitOf(v);
+        return (PageOf(v)->objects[bit / 32] & (1u << (bit % 32))) != 0;
+    }
+
+    INLINE static void SetObject(const void* v)
+    {
+        size_t bit = BitOf(v);
+        PageOf(v)->objects[bit / 32] |= 1u << (bit % 32);
+    }
+
+    /** Clears the object and the mark bit of v. */
+    INLINE static void ClearObject(const void* v)
+    {
+        size_t bit  = BitOf(v);
+        Page*  page = PageOf(v);
+        u4     mask = ~(1u << (bit % 32));
+        page->objects[bit / 32] &= mask;
+        page->marks[bit / 32]   &= mask;
+    }
+
+    INLINE size_t GetNumPages()       const { return numPages;       } //!< Number of pages held by the heap.
+    INLINE size_t GetBytesInUse()     const { return bytesInUse;     } //!< Bytes currently allocated.
+    INLINE u8     GetBytesAllocated() const { return bytesAllocated; } //!< Bytes allocated over the heap's lifetime.
+    INLINE u8     GetBytesFreed()     const { return bytesFreed;     } //!< Bytes freed over the heap's lifetime.
+private:
+    INLINE void* AllocateFrom(Page* page)
+    {
+        void* cell = page->freeList;
+        if (cell)
+        {
+            page->freeList = page->freeList->next;
+        }
+        else if (page->bump < page->end)
+        {
+            cell = page->bump;
+            page->bump += page->cellSize;
+        }
+        else
+        {
+            return 0;
+        }
+        ++page->live;
+        bytesInUse += page->cellSize;
+        bytesAllocated += page->cellSize;
+        return cell;
+    }
+
+    static size_t MediumClass(size_t sz);
+    static size_t ClassSize(size_t sizeClass);
+
+    void* AllocateSlow(size_t sizeClass);
+    Page* FirstFree(size_t sizeClass);
+    void* LargeAllocate(size_t sz);
+
+    Page* NewPage(size_t sizeClass, size_t size, size_t cellSize);
+    void  FreePage(Page* page);
+
+    void  LinkPage(Page* page);
+    void  UnlinkPage(Page* page);
+
+    void  AddToMap(Page* page);
+    void  RemoveFromMap(Page* page);
+    void  GrowMap();
+
+    INLINE size_t MapIndex(const Page* page) const
+    {
+        return (((size_t)page / PAGE_SIZE) * (size_t)2654435761u) & (mapSize - 1);
+    }
+
+    Page*   avail[NUM_CLASSES]; //!< Pages with free cells for each size class.
+    Page**  pageMap;            //!< Open addressed hash set of every page.
+    Collector* collector;
+    size_t  mapSize;
+    size_t  numPages;
+    size_t  bytesInUse;
+    u8      bytesAllocated;
+    u8      bytesFreed;
+};
+
+}// pika
+
+#endif
@@ -0,0 +1,623 @@
+/*
+ *  PHeapSnapshot.cpp
+ *  See Copyright Notice in Pika.h
+ */
+#include "Pika.h"
+#include "PHeapSnapshot.h"
+#include "PikaSort.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace pika {
+
+namespace {
+
+/* Layout of a heap snapshot. Values are written in the byte order of the machine, which is
+ * recorded in the header.
+ *
+ *  magic "PIKH", version, byte order mark,
+ *  name count, then each name's length and bytes,
+ *  node count, then each node's name index, size, preview length and preview bytes,
+ *  edge count, then each edge's source and target node,
+ *  root count, then each root node.
+ *
+ * A node's index is its position in the node list.
+ */
+const u1 SNAPSHOT_MAGIC[4] = { 'P', 'I', 'K', 'H' };
+const u4 SNAPSHOT_VERSION  = 1;
+const u4 SNAPSHOT_ORDER    = 0x01020304;
+const u4 SNAPSHOT_NONE     = 0xFFFFFFFF;
+
+/** Maps addresses to indices. */
+class AddressMap
+{
+public:
+    AddressMap() : count(0) { Rehash(64); }
+
+    u4 Find(const void* key) const
+    {
+        size_t pos = Slot(key);
+        return keys[pos] ? vals[pos] : SNAPSHOT_NONE;
+    }
+
+    void Insert(const void* key, u4 val)
+    {
+        // Keep the table at most half full.
+        if ((count + 1) * 2 > keys.GetSize())
+            Rehash(keys.GetSize() * 2);
+
+        size_t pos = Slot(key);
+        if (!keys[pos])
+        {
+            keys[pos] = key;
+            ++count;
+        }
+        vals[pos] = val;
+    }
+private:
+    size_t Slot(const void* key) const
+    {
+        size_t mask = keys.GetSize() - 1;
+        size_t pos  = (((size_t)key >> 3) * (size_t)2654435761u) & mask;
+        while (keys[pos] && keys[pos] != key)
+            pos = (pos + 1) & mask;
+        return pos;
+    }
+
+    void Rehash(size_t newSize)
+    {
+        Buffer<const void*> oldKeys(keys);
+        Buffer<u4>          oldVals(vals);
+
+        keys.Resize(newSize);
+        vals.Resize(newSize);
+        for (size_t i = 0; i < newSize; ++i)
+            keys[i] = 0;
+
+        for (size_t i = 0; i < oldKeys.GetSize(); ++i)
+        {
+            if (oldKeys[i])
+            {
+                size_t pos = Slot(oldKeys[i]);
+                keys[pos] = oldKeys[i];
+                vals[pos] = oldVals[i];
+            }
+        }
+    }
+
+    Buffer<const void*> keys;
+    Buffer<u4>          vals;
+    size_t              count;
+};
+
+class SnapshotWriter : public GCVisitor
+{
+public:
+    SnapshotWriter(Engine* eng) : gc(eng->GetGC()), heap(eng->GetHeap()), phase(PHASE_nodes), from(0) {}
+
+    virtual ~SnapshotWriter() {}
+
+    virtual void Visit(GCObject* c)
+    {
+        if (phase == PHASE_nodes)
+        {
+            ids.Insert(c, (u4)nodes.GetSize());
+            nodes.Push(c);
+            return;
+        }
+
+        // Objects that are not owned by the collector are left out.
+        u4 id = ids.Find(c);
+        if (id == SNAPSHOT_NONE)
+            return;
+
+        if (phase == PHASE_edges)
+        {
+            if (id != from)
+            {
+                edges.Push(from);
+                edges.Push(id);
+            }
+        }
+        else
+        {
+            roots.Push(id);
+        }
+    }
+
+    bool Write(const char* path)
+    {
+        phase = PHASE_nodes;
+        gc->VisitObjects(this);
+
+        phase = PHASE_edges;
+        for (size_t i = 0; i < nodes.GetSize(); ++i)
+        {
+            from = (u4)i;
+            gc->VisitRefs(nodes[i], this);
+        }
+
+        phase = PHASE_roots;
+        gc->VisitRoots(this);
+
+        // Names are shared by address, see Collector::GetLiveCounts.
+        AddressMap        nameIds;
+        Buffer<const char*> names;
+        Buffer<u4>        nodeNames;
+        nodeNames.Resize(nodes.GetSize());
+
+        for (size_t i = 0; i < nodes.GetSize(); ++i)
+        {
+            const char* name = nodes[i]->GetGCName();
+            u4 id = nameIds.Find(name);
+            if (id == SNAPSHOT_NONE)
+            {
+                id = (u4)names.GetSize();
+                nameIds.Insert(name, id);
+                names.Push(name);
+            }
+            nodeNames[i] = id;
+        }
+
+        Put(SNAPSHOT_MAGIC[0]); Put(SNAPSHOT_MAGIC[1]); Put(SNAPSHOT_MAGIC[2]); Put(SNAPSHOT_MAGIC[3]);
+        Put(SNAPSHOT_VERSION);
+        Put(SNAPSHOT_ORDER);
+
+        Put((u4)names.GetSize());
+        for (size_t i = 0; i < names.GetSize(); ++i)
+        {
+            u4 len = (u4)strlen(names[i]);
+            Put(len);
+            PutBytes(names[i], len);
+        }
+
+        Put((u4)nodes.GetSize());
+        for (size_t i = 0; i < nodes.GetSize(); ++i)
+        {
+            size_t      len     = 0;
+            const char* preview = nodes[i]->GetGCPreview(len);
+
+            if (!preview)
+                len = 0;
+            len = Min<size_t>(len, HeapSnapshot::PREVIEW_LENGTH);
+
+            Put(nodeNames[i]);
+            Put((u4)Min<size_t>(heap->SizeOf(nodes[i]) + nodes[i]->GetExternalBytes(), 0xFFFFFFFF));
+            Put((u4)len);
+            PutBytes(preview, len);
+        }
+
+        Put((u4)(edges.GetSize() / 2));
+        PutBytes(edges.GetAt(0), edges.GetSize() * sizeof(u4));
+
+        Put((u4)roots.GetSize());
+        PutBytes(roots.GetAt(0), roots.GetSize() * sizeof(u4));
+
+        FILE* file = fopen(path, "wb");
+        if (!file)
+            return false;
+
+        bool ok = fwrite(out.GetAt(0), 1, out.GetSize(), file) == out.GetSize();
+        return (fclose(file) == 0) && ok;
+    }
+private:
+    template<typename T>
+    void Put(const T& t) { PutBytes(&t, sizeof(T)); }
+
+    void PutBytes(const void* v, size_t len)
+    {
+        const u1* bytes = (const u1*)v;
+        for (size_t i = 0; i < len; ++i)
+            out.Push(bytes[i]);
+    }
+
+    enum EPhase
+    {
+        PHASE_nodes,
+        PHASE_edges,
+        PHASE_roots,
+    };
+
+    Collector*        gc;
+    Heap*             heap;
+    EPhase            phase;
+    u4                from;     //!< Node whose references are being visited.
+    AddressMap        ids;      //!< Node index of each object.
+    Buffer<GCObject*> nodes;
+    Buffer<u4>        edges;    //!< Pairs of source and target.
+    Buffer<u4>        roots;
+    Buffer<u1>        out;
+};
+
+struct SnapshotReader
+{
+    SnapshotReader(const u1* b, size_t len) : pos(b), end(b + len) {}
+
+    bool Get(u4& x)
+    {
+        if ((size_t)(end - pos) < sizeof(u4))
+            return false;
+        Pika_memcpy(&x, pos, sizeof(u4));
+        pos += sizeof(u4);
+        return true;
+    }
+
+    const char* GetBytes(size_t len)
+    {
+        if ((size_t)(end - pos) < len)
+            return 0;
+        const char* bytes = (const char*)pos;
+        pos += len;
+        return bytes;
+    }
+
+    const u1* pos;
+    const u1* end;
+};
+
+/** A snapshot read back from a file. The strings point into the file's contents. */
+struct Snapshot
+{
+    Buffer<const char*> names;
+    Buffer<u4>          nameLengths;
+    Buffer<u4>          nodeNames;
+    Buffer<u4>          nodeSizes;
+    Buffer<const char*> previews;
+    Buffer<u4>          previewLengths;
+    Buffer<u4>          edges;
+    Buffer<u4>          roots;
+
+    bool Read(SnapshotReader& in)
+    {
+        u4 version, order, count;
+        const char* magic = in.GetBytes(4);
+
+        if (!magic || memcmp(magic, SNAPSHOT_MAGIC, 4) != 0 ||
+            !in.Get(version) || version != SNAPSHOT_VERSION ||
+            !in.Get(order)   || order   != SNAPSHOT_ORDER)
+        {
+            return false;
+        }
+
+        if (!in.Get(count))
+            return false;
+        for (u4 i = 0; i < count; ++i)
+        {
+            u4 len;
+            const char* name;
+            if (!in.Get(len) || !(name = in.GetBytes(len)))
+                return false;
+            names.Push(name);
+            nameLengths.Push(len);
+        }
+
+        if (!in.Get(count))
+            return false;
+        for (u4 i = 0; i < count; ++i)
+        {
+            u4 name, size, len;
+            const char* preview;
+            if (!in.Get(name) || name >= names.GetSize() || !in.Get(size) || !in.Get(len) || !(preview = in.GetBytes(len)))
+                return false;
+            nodeNames.Push(name);
+            nodeSizes.Push(size);
+            previews.Push(preview);
+            previewLengths.Push(len);
+        }
+
+        if (!in.Get(count))
+            return false;
+        for (u4 i = 0; i < count * 2; ++i)
+        {
+            u4 node;
+            if (!in.Get(node) || node >= nodeNames.GetSize())
+                return false;
+            edges.Push(node);
+        }
+
+        if (!in.Get(count))
+            return false;
+        for (u4 i = 0; i < count; ++i)
+        {
+            u4 node;
+            if (!in.Get(node) || node >= nodeNames.GetSize())
+                return false;
+            roots.Push(node);
+        }
+        return true;
+    }
+};
+
+/** Sorts indices by decreasing key. */
+struct ByLargest
+{
+    ByLargest(const Buffer<u8>& k) : keys(k) {}
+    bool operator()(u4 a, u4 b) const { return keys[a] > keys[b]; }
+    const Buffer<u8>& keys;
+};
+
+/** Adjacency lists in compressed form: the neighbours of v are list[start[v]] to list[start[v+1]]. */
+struct Adjacency
+{
+    void Build(size_t numNodes, const Buffer<u4>& from, const Buffer<u4>& to)
+    {
+        start.Resize(numNodes + 1);
+        for (size_t i = 0; i <= numNodes; ++i)
+            start[i] = 0;
+        for (size_t i = 0; i < from.GetSize(); ++i)
+            ++start[from[i] + 1];
+        for (size_t i = 0; i < numNodes; ++i)
+            start[i + 1] += start[i];
+
+        Buffer<u4> fill(start);
+        list.Resize(from.GetSize());
+        for (size_t i = 0; i < from.GetSize(); ++i)
+            list[fill[from[i]]++] = to[i];
+    }
+
+    Buffer<u4> start;
+    Buffer<u4> list;
+};
+
+void PrintNode(FILE* out, const Snapshot& snap, u4 v)
+{
+    fprintf(out, "%.*s", (int)snap.nameLengths[snap.nodeNames[v]], snap.names[snap.nodeNames[v]]);
+
+    if (snap.previewLengths[v])
+    {
+        fputs(" \"", out);
+        for (u4 i = 0; i < snap.previewLengths[v]; ++i)
+        {
+            char ch = snap.previews[v][i];
+            fputc((ch >= ' ' && ch <= '~') ? ch : '.', out);
+        }
+        fputc('"', out);
+    }
+}
+
+}// namespace
+
+bool HeapSnapshot::Write(Engine* eng, const char* path)
+{
+    GCPAUSE_NORUN(eng);
+    SnapshotWriter writer(eng);
+    return writer.Write(path);
+}
+
+bool HeapSnapshot::Report(const char* path, FILE* out)
+{
+    Buffer<u1> contents;
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    u1 chunk[4096];
+    size_t amt;
+    while ((amt = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        for (size_t i = 0; i < amt; ++i)
+            contents.Push(chunk[i]);
+    }
+    fclose(file);
+
+    Snapshot       snap;
+    SnapshotReader in(contents.GetAt(0), contents.GetSize());
+    if (!snap.Read(in))
+        return false;
+
+    // The roots hang off of an extra node, root, so that the graph has a single entry.
+    const u4 numNodes = (u4)snap.nodeNames.GetSize();
+    const u4 root     = numNodes;
+
+    Buffer<u4> from, to;
+    for (size_t i = 0; i < snap.edges.GetSize(); i += 2)
+    {
+        from.Push(snap.edges[i]);
+        to.Push(snap.edges[i + 1]);
+    }
+    for (size_t i = 0; i < snap.roots.GetSize(); ++i)
+    {
+        from.Push(root);
+        to.Push(snap.roots[i]);
+    }
+
+    Adjacency succs, preds;
+    succs.Build(numNodes + 1, from, to);
+    preds.Build(numNodes + 1, to, from);
+
+    // Depth first search from root, giving each reachable node its post order number.
+    Buffer<u4> postNum(numNodes + 1);
+    Buffer<u4> postOrder;
+    Buffer<u4> stack, stackEdge;
+    for (u4 v = 0; v <= numNodes; ++v)
+        postNum[v] = SNAPSHOT_NONE;
+
+    Buffer<u1> seen(numNodes + 1);
+    for (u4 v = 0; v <= numNodes; ++v)
+        seen[v] = 0;
+
+    seen[root] = 1;
+    stack.Push(root);
+    stackEdge.Push(succs.start[root]);
+    while (stack.GetSize())
+    {
+        u4  v = stack.Back();
+        u4& e = stackEdge.Back();
+        if (e < succs.start[v + 1])
+        {
+            u4 w = succs.list[e++];
+            if (!seen[w])
+            {
+                seen[w] = 1;
+                stack.Push(w);
+                stackEdge.Push(succs.start[w]);
+            }
+        }
+        else
+        {
+            postNum[v] = (u4)postOrder.GetSize();
+            postOrder.Push(v);
+            stack.Pop();
+            stackEdge.Pop();
+        }
+    }
+
+    // Immediate dominators, from "A Simple, Fast Dominance Algorithm" by Cooper, Harvey and Kennedy.
+    Buffer<u4> idom(numNodes + 1);
+    for (u4 v = 0; v <= numNodes; ++v)
+        idom[v] = SNAPSHOT_NONE;
+    idom[root] = root;
+
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+        for (size_t i = postOrder.GetSize(); i-- > 0;)
+        {
+            u4 v = postOrder[i];
+            if (v == root)
+                continue;
+
+            u4 newIdom = SNAPSHOT_NONE;
+            for (u4 e = preds.start[v]; e < preds.start[v + 1]; ++e)
+            {
+                u4 p = preds.list[e];
+                if (idom[p] == SNAPSHOT_NONE)
+                    continue;
+
+                if (newIdom == SNAPSHOT_NONE)
+                {
+                    newIdom = p;
+                    continue;
+                }
+
+                u4 a = p, b = newIdom;
+                while (a != b)
+                {
+                    while (postNum[a] < postNum[b]) a = idom[a];
+                    while (postNum[b] < postNum[a]) b = idom[b];
+                }
+                newIdom = a;
+            }
+
+            if (idom[v] != newIdom)
+            {
+                idom[v] = newIdom;
+                changed = true;
+            }
+        }
+    }
+
+    // A node's dominator comes after it in post order.
+    Buffer<u8> retained(numNodes + 1);
+    for (u4 v = 0; v < numNodes; ++v)
+        retained[v] = snap.nodeSizes[v];
+    retained[root] = 0;
+
+    for (size_t i = 0; i < postOrder.GetSize(); ++i)
+    {
+        u4 v = postOrder[i];
+        if (v != root)
+            retained[idom[v]] += retained[v];
+    }
+
+    // Breadth first search from root for the shortest path to each node.
+    Buffer<u4> parent(numNodes + 1);
+    Buffer<u4> queue;
+    for (u4 v = 0; v <= numNodes; ++v)
+        parent[v] = SNAPSHOT_NONE;
+
+    parent[root] = root;
+    queue.Push(root);
+    for (size_t head = 0; head < queue.GetSize(); ++head)
+    {
+        u4 v = queue[head];
+        for (u4 e = succs.start[v]; e < succs.start[v + 1]; ++e)
+        {
+            u4 w = succs.list[e];
+            if (parent[w] == SNAPSHOT_NONE)
+            {
+                parent[w] = v;
+                queue.Push(w);
+            }
+        }
+    }
+
+    // Totals for each type.
+    size_t     numNames = snap.names.GetSize();
+    Buffer<u8> typeCount(numNames), typeShallow(numNames), typeRetained(numNames);
+    u8         totalSize   = 0;
+    u4         unreachable = 0;
+
+    for (size_t i = 0; i < numNames; ++i)
+        typeCount[i] = typeShallow[i] = typeRetained[i] = 0;
+
+    for (u4 v = 0; v < numNodes; ++v)
+    {
+        u4 name = snap.nodeNames[v];
+        ++typeCount[name];
+        typeShallow[name] += snap.nodeSizes[v];
+        totalSize += snap.nodeSizes[v];
+
+        if (idom[v] == SNAPSHOT_NONE)
+            ++unreachable;
+        else if (idom[v] == root || snap.nodeNames[idom[v]] != name)
+            typeRetained[name] += retained[v];
+    }
+
+    fprintf(out, "%lu objects, %lu references, %llu bytes, %lu unreachable\n\n",
+            (unsigned long)numNodes, (unsigned long)(snap.edges.GetSize() / 2),
+            (unsigned long long)totalSize, (unsigned long)unreachable);
+
+    Buffer<u4> types(numNames);
+    for (size_t i = 0; i < numNames; ++i)
+        types[i] = (u4)i;
+    pika_sort(types.BeginPointer(), types.EndPointer(), ByLargest(typeRetained));
+
+    fprintf(out, "%-24s %10s %14s %14s\n", "type", "count", "bytes", "retained");
+    for (size_t i = 0; i < numNames && i < NUM_TYPES; ++i)
+    {
+        u4 t = types[i];
+        fprintf(out, "%-24.*s %10llu %14llu %14llu\n", (int)Min<u4>(snap.nameLengths[t], 24), snap.names[t],
+                (unsigned long long)typeCount[t], (unsigned long long)typeShallow[t], (unsigned long long)typeRetained[t]);
+    }
+
+    // The largest retainers, leaving out the roots themselves.
+    Buffer<u1> isRoot(numNodes);
+    for (u4 v = 0; v < numNodes; ++v)
+        isRoot[v] = 0;
+    for (size_t i = 0; i < snap.roots.GetSize(); ++i)
+        isRoot[snap.roots[i]] = 1;
+
+    Buffer<u4> candidates;
+    for (u4 v = 0; v < numNodes; ++v)
+    {
+        if (idom[v] != SNAPSHOT_NONE && !isRoot[v])
+            candidates.Push(v);
+    }
+    pika_sort(candidates.BeginPointer(), candidates.EndPointer(), ByLargest(retained));
+
+    fprintf(out, "\nlargest retainers:\n");
+    for (size_t i = 0; i < candidates.GetSize() && i < NUM_RETAINERS; ++i)
+    {
+        u4 v = candidates[i];
+        fprintf(out, "%14llu  ", (unsigned long long)retained[v]);
+        PrintNode(out, snap, v);
+        fputc('\n', out);
+
+        Buffer<u4> path;
+        for (u4 w = v; w != root; w = parent[w])
+            path.Push(w);
+
+        fputs("                <root>", out);
+        for (size_t j = path.GetSize(); j-- > 0;)
+        {
+            fputs(" -> ", out);
+            PrintNode(out, snap, path[j]);
+        }
+        fputc('\n', out);
+    }
+    return true;
+}
+
+}// pika
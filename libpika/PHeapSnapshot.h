@@ -0,0 +1,56 @@
+/*
+ *  PHeapSnapshot.h
+ *  See Copyright Notice in Pika.h
+ */
+#ifndef PIKA_HEAPSNAPSHOT_HEADER
+#define PIKA_HEAPSNAPSHOT_HEADER
+
+#include <stdio.h>
+
+namespace pika {
+
+class Engine;
+
+////////////////////////////////////////// HeapSnapshot ////////////////////////////////////////////
+
+/** Writes the object graph of an Engine to a file and reports on it.
+  *
+  * Every object owned by the Collector becomes a node with its GCObject::GetGCName, its size
+  * and the start of its GCObject::GetGCPreview. The size is the bytes the Heap reserved for the
+  * object plus its GCObject::GetExternalBytes, so the elements of an Array are included. Edges
+  * are found by running each object's MarkRefs through Collector::VisitRefs and the roots come
+  * from Collector::VisitRoots.
+  *
+  * Report reads a snapshot back and prints the objects and bytes of each type, the size retained
+  * by each type and the shortest path from a root to each of the largest retainers. An object
+  * retains everything that can only be reached through it, found from the graph's dominator tree.
+  * A type's retained size adds up the objects of the type whose immediate dominator is of a
+  * different type, so that chains of a single type are not counted twice.
+  */
+class PIKA_API HeapSnapshot
+{
+public:
+    enum
+    {
+        PREVIEW_LENGTH = 40, //!< Most bytes of preview stored for each object.
+        NUM_TYPES      = 25, //!< Types listed by Report.
+        NUM_RETAINERS  = 10, //!< Retainers listed by Report.
+    };
+
+    /** Writes a snapshot of eng's heap to path. The collector does not run while the snapshot
+      * is taken.
+      *
+      * @result True if the file was written.
+      */
+    static bool Write(Engine* eng, const char* path);
+
+    /** Reads the snapshot at path and prints a report to out.
+      *
+      * @result False if the file could not be read.
+      */
+    static bool Report(const char* path, FILE* out);
+};
+
+}// pika
+
+#endif
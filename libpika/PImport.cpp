@@ -230,7 +230,7 @@ int Global_import(Context* ctx, Value& self)
              // module was imported already or is in the process of being imported
             if (eng->Module_Type->IsInstance(res))
             {
-                Module* module = (Module*)res.val.object;
+                Module* module = (Module*)res.GetObject();
                 ctx->SafePush(module->GetImportResult());
                 continue;
             }
@@ -260,7 +260,7 @@ int Global_import(Context* ctx, Value& self)
                     return 0;                    
                 }
             }
-            else if (res.IsString() && (res.val.str == eng->loading_String || res.val.str == eng->GetString("compiling")))
+            else if (res.IsString() && (res.GetString() == eng->loading_String || res.GetString() == eng->GetString("compiling")))
             {
                 RaiseException("Attempt to import '%s' failed. Circular dependency detected.", name->GetBuffer());
             }
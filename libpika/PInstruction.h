@@ -10,6 +10,7 @@
 namespace pika {
 
 struct TreeNode;
+struct Symbol;
 
 struct Instr
 {
@@ -28,54 +29,6 @@ struct Instr
             
     ~Instr() {}
     
-    // patches break and continue jump targets which are optional matched by the symbol
-    // given.
-    
-    void DoLoopPatch(Instr* breakTarget, Instr* continueTarget, struct Symbol* sym)
-    {
-        Instr* n = this;
-        do
-        {
-            if (n->opcode == BREAK_LOOP)
-            {
-                if ((n->symbol && (sym == n->symbol)) || !n->symbol)
-                {
-                    n->opcode = OP_jump;
-                    n->target = breakTarget;
-                }
-            }
-            else if (n->opcode == CONTINUE_LOOP)
-            {
-                if ((n->symbol && (sym == n->symbol)) || !n->symbol)
-                {
-                    n->opcode = OP_jump;
-                    n->target = continueTarget;
-                }
-            }
-        }
-        while ( (n = n->next) );
-    }
-    
-    // Attaches the given Instr to end of this Instr chain.
-    
-    Instr* Attach(Instr* nxt)
-    {
-        if (!next)
-        {
-            next = nxt;
-            nxt->prev = this;
-        }
-        else
-        {
-            Instr* curr = next;
-            while (curr->next)
-                curr = curr->next;
-            curr->next = nxt;
-            nxt->prev = curr;
-        }
-        return nxt;
-    }
-    
     void Unattach()
     {
         if (prev) prev->next = next;
@@ -84,24 +37,6 @@ struct Instr
         prev = next = 0;
     }
     
-    // Calculates the byte-code position of this Instr chain.
-    
-    void CalcPos()
-    {
-        pos = 0;
-        Instr* curr = next;
-        Instr* nxt = 0;
-        u2 currpos = pos + OpcodeLength(opcode);
-        
-        while (curr)
-        {
-            nxt       = curr->next;
-            curr->pos = currpos;
-            currpos  += OpcodeLength(curr->opcode);
-            curr      = nxt;
-        }
-    }
-    
     // Sets a jump target, making the given Instr a label.
     
     void SetTarget(Instr* t)
@@ -114,13 +49,6 @@ struct Instr
         }
     }
     
-    static Instr* Create(Opcode oc)
-    {
-        Instr* ir = 0;
-        PIKA_NEW(Instr, ir, (oc));
-        return ir;
-    }
-    
     Opcode  opcode;
     
     u1  operandu2;  // second byte if OP_bw, OP_bb, OP_bbb
@@ -139,6 +67,78 @@ struct Instr
     };
 };
 
+/** A doubly linked list of Instrs that knows both of its ends, so code can be appended in
+  * constant time. Each AST node generates its code into one and returns it to its parent.
+  */
+struct InstrList
+{
+    InstrList() : head(0), tail(0) {}
+    
+    /** Creates a list holding the single, unattached Instr ir. */
+    InstrList(Instr* ir) : head(ir), tail(ir)
+    {
+        ASSERT(!ir || (!ir->next && !ir->prev));
+    }
+    
+    bool IsEmpty() const { return head == 0; }
+    
+    /** Appends the Instrs of code to the end of this list. */
+    InstrList& Append(const InstrList& code)
+    {
+        if (code.IsEmpty())
+            return *this;
+        
+        if (!head)
+        {
+            head = code.head;
+        }
+        else
+        {
+            tail->next = code.head;
+            code.head->prev = tail;
+        }
+        tail = code.tail;
+        return *this;
+    }
+    
+    /** Inserts the Instrs of code at the beginning of this list. */
+    InstrList& Prepend(const InstrList& code)
+    {
+        if (code.IsEmpty())
+            return *this;
+        
+        if (!head)
+        {
+            tail = code.tail;
+        }
+        else
+        {
+            code.tail->next = head;
+            head->prev = code.tail;
+        }
+        head = code.head;
+        return *this;
+    }
+    
+    /** Calculates the byte-code position of every Instr in the list and returns the total
+      * length. The positions are only valid if the result fits in a u2.
+      */
+    size_t CalcPos()
+    {
+        size_t currpos = 0;
+        
+        for (Instr* curr = head; curr; curr = curr->next)
+        {
+            curr->pos = (u2)currpos;
+            currpos  += OpcodeLength(curr->opcode);
+        }
+        return currpos;
+    }
+    
+    Instr* head;
+    Instr* tail;
+};
+
 // We need to know how much stack space each operand produces so that we can limit
 // reallocations. Also keep pointers and references from being invalided when we do
 // realloc. It also saves cycles because we do not have to constantly check every time
@@ -314,6 +314,25 @@ INLINE int OpcodeStackChange(Instr *ir)
     case OP_newpkg:         return -1;
     case OP_pushpkg:        return -1;
     case OP_poppkg:         return  0;
+    
+    case OP_add_ii:
+    case OP_add_rr:
+    case OP_sub_ii:
+    case OP_sub_rr:
+    case OP_mul_ii:
+    case OP_mul_rr:
+    case OP_div_rr:
+    case OP_eq_ii:
+    case OP_ne_ii:
+    case OP_lt_ii:
+    case OP_lt_rr:
+    case OP_gt_ii:
+    case OP_gt_rr:
+    case OP_lte_ii:
+    case OP_lte_rr:
+    case OP_gte_ii:
+    case OP_gte_rr:
+    case OP_cat_ss:         return -1;
 
     
     case BREAK_LOOP:        return  0;
@@ -33,7 +33,7 @@ Value IterateHelper::Next()
 {
     Value iter(iterator);
     Value res(NULL_VALUE);
-    if (GetOverrideFrom(context->GetEngine(), iter.val.basic, OVR_next, res))
+    if (GetOverrideFrom(context->GetEngine(), iter.GetBasic(), OVR_next, res))
     {
         context->CheckStackSpace(3);
         context->Push(iter);
@@ -75,13 +75,13 @@ Iterator* Iterator::Create(Engine* eng, Type* typ)
 {
     Value res(NULL_VALUE);
     Iterator::Constructor(eng, typ, res);
-    return (Iterator*)res.val.object;
+    return (Iterator*)res.GetObject();
 }
 
 void Iterator::Constructor(Engine* eng, Type* type, Value& res)
 {
     Iterator* iter = 0;
-    PIKA_NEW(Iterator, iter, (eng, type));
+    GCALLOC(eng, Iterator, iter, (eng, type));
     eng->AddToGCNoRun(iter);
     res.Set(iter);
 }
@@ -105,7 +105,7 @@ the values returned are part of the sequence."
 
 int Iterator_next(Context* ctx, Value& self)
 {
-    Iterator* iter = (Iterator*)self.val.object;
+    Iterator* iter = (Iterator*)self.GetObject();
     return iter->Next(ctx);
 }
 
@@ -13,24 +13,19 @@ LiteralPool::~LiteralPool() {}
 LiteralPool* LiteralPool::Create(Engine* eng)
 {
     LiteralPool* litpool = 0;
-    PIKA_NEW(LiteralPool, litpool, (eng));
-    eng->AddToGC(litpool);
+    GCNEW(eng, LiteralPool, litpool, (eng));
     return litpool;
 }
 
 u2 LiteralPool::Add(pint_t i)
 {
-    Value v;
-    v.tag = TAG_integer;
-    v.val.integer = i;
+    Value v(i);
     return Add(v);
 }
 
 u2 LiteralPool::Add(preal_t r)
 {
-    Value v;
-    v.tag = TAG_real;
-    v.val.real = r;
+    Value v(r);
     return Add(v);
 }
 
@@ -50,7 +45,7 @@ u2 LiteralPool::Add(const Value& v)
     }
 
     if (v.IsCollectible())
-        engine->GetGC()->WriteBarrier(this, v.val.basic);
+        engine->GetGC()->WriteBarrier(this, v.GetBasic());
 
     literals.Push(v);
 
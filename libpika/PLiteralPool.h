@@ -26,6 +26,7 @@ public:
     static LiteralPool* Create(Engine* eng);
 
     virtual void    MarkRefs(Collector*);
+    virtual const char* GetGCName() const { return "LiteralPool"; }
     const Value&    Get(u2 idx) const;
     size_t          GetSize()   const;
     
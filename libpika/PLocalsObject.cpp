@@ -97,7 +97,7 @@ bool LocalsObject::GetSlot(const Value& key, Value& result)
 {
     if (key.IsString() && indices.Get(key, result) && result.IsInteger())
     {
-        pint_t indexof = result.val.integer;
+        pint_t indexof = result.GetInteger();
         
         if (lexEnv && indexof >= 0 && indexof < (pint_t)lexEnv->Length())
         {
@@ -113,7 +113,7 @@ bool LocalsObject::HasSlot(const Value& key)
     Value result = NULL_VALUE;
     if (key.IsString() && indices.Get(key, result) && result.IsInteger())
     {
-        pint_t indexof = result.val.integer;
+        pint_t indexof = result.GetInteger();
         
         if (lexEnv && indexof >= 0 && indexof < (pint_t)lexEnv->Length())
         {     
@@ -130,7 +130,7 @@ bool LocalsObject::SetSlot(const Value& key, Value& value, u4 attr)
     Value result;
     if (key.IsString() && indices.Get(key, result) && result.IsInteger())
     {
-        pint_t indexof = result.val.integer;
+        pint_t indexof = result.GetInteger();
         
         if (lexEnv && indexof >= 0 && indexof < (pint_t)lexEnv->Length())
         {
@@ -157,8 +157,7 @@ String* LocalsObject::ToString()
 LocalsObject* LocalsObject::Create(Engine* eng, Type* type, Function* function, LexicalEnv* env, ptrdiff_t pc)
 {
     LocalsObject* obj;
-    PIKA_NEW(LocalsObject, obj, (eng, type, function, env, pc));
-    eng->AddToGC(obj);
+    GCNEW(eng, LocalsObject, obj, (eng, type, function, env, pc));
     return obj;
 }
 
@@ -175,7 +174,7 @@ int LocalsObject_getParent(Context* ctx, Value& self)
 {
     if (self.IsDerivedFrom(LocalsObject::StaticGetClass()))
     {
-        LocalsObject* obj = (LocalsObject*)self.val.object;    
+        LocalsObject* obj = (LocalsObject*)self.GetObject();    
         Object* parent = obj->GetParent();        
         if (parent)
         {
@@ -189,7 +188,7 @@ int LocalsObject_getParent(Context* ctx, Value& self)
     }
     else if (self.IsDerivedFrom(Type::StaticGetClass()))
     {
-        Type* t = (Type*)self.val.object;
+        Type* t = (Type*)self.GetObject();
         ctx->Push(t->GetSuper());   
         return 1;
     }    
@@ -199,7 +198,7 @@ int LocalsObject_getParent(Context* ctx, Value& self)
 
 int LocalsObject_getLength(Context* ctx, Value& self)
 {
-    LocalsObject* obj = static_cast<LocalsObject*>(self.val.object);
+    LocalsObject* obj = static_cast<LocalsObject*>(self.GetObject());
     pint_t sz = static_cast<pint_t>(obj->GetLength());
     ctx->Push(sz);
     return 1;    
@@ -207,7 +206,7 @@ int LocalsObject_getLength(Context* ctx, Value& self)
 
 int LocalsObject_getDepth(Context* ctx, Value& self)
 {
-    LocalsObject* obj = static_cast<LocalsObject*>(self.val.object);
+    LocalsObject* obj = static_cast<LocalsObject*>(self.GetObject());
     Function* fn = obj->GetFunction();
     pint_t depth = 0;
     if (fn)
@@ -229,7 +228,7 @@ int LocalsObject_getDepth(Context* ctx, Value& self)
 
 int LocalsObject_getClosure(Context* ctx, Value& self)
 {
-    LocalsObject* obj = static_cast<LocalsObject*>(self.val.object);
+    LocalsObject* obj = static_cast<LocalsObject*>(self.GetObject());
     Function* fn = obj->GetFunction();
     if (fn)
     {
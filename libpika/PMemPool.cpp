@@ -27,12 +27,18 @@ void MemPoolMixed::Destroy()
         Pika_free(curr);
         curr = next;
     }
-    Blocks = 0;
+    Blocks   = 0;
+    NextFree = 0;
+    End      = 0;
 }
 
 void* MemPoolMixed::NewBlock(size_t size)
 {
     MixedBlock* curr = (MixedBlock*)(Pika_malloc(sizeof(MixedBlock) + size));
+    if (!curr)
+    {
+        RaiseException("MemPoolMixed::NewBlock memory allocation failed.");
+    }
     curr->Next = Blocks;
     Blocks = curr;
     ++curr;
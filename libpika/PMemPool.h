@@ -15,10 +15,16 @@ class MemPool;
 struct AllocBlock { size_t     Size; };
 struct FreeBlock  { FreeBlock* Next; };
 
-// MemPoolMixed, MemObjPoolMixed and PoolObject are untested and unused!
+// MemObjPoolMixed and PoolObject are untested and unused!
 
 // MemPoolMixed /////////////////////////////////////////////////////////////////////////
 
+/** Bump pointer allocator for objects of any size that all die together. Alloc carves memory 
+  * out of the current block and there is no way to free a single allocation, every block is 
+  * freed at once by Destroy or the destructor. Nothing allocated from the pool is destructed.
+  *
+  * Used by CompileState for the AST, Instr chains and SymbolTables of a compilation.
+  */
 struct MemPoolMixed
 {
     union MixedBlock
@@ -50,7 +50,22 @@ do                                              \
 }                                               \
 while (false)
 
-/** Calls placement new and adds the object to the GC.
+/** Calls placement new on memory from the Engine's Heap. The object is <b>not</b> added 
+  * to the GC.
+  * @param eng  Pointer to the Engine.
+  * @param T    Type of object.
+  * @param p    Variable to store the object in.
+  * @param args Arguments inclosed in parentheses.
+  */  
+#define GCALLOC(eng, T, p, args)                                \
+do                                                              \
+{                                                               \
+    void* ptrvoid##p_ = eng->GetHeap()->Allocate(sizeof(T));    \
+    p = new (ptrvoid##p_) T args;                               \
+}                                                               \
+while (false)
+
+/** Calls placement new on memory from the Engine's Heap and adds the object to the GC.
   * @param eng  Pointer to the Engine.
   * @param T    Type of object.
   * @param p    Variable to store the object in.
@@ -59,8 +74,7 @@ while (false)
 #define GCNEW(eng, T, p, args)                  \
 do                                              \
 {                                               \
-    void* ptrvoid##p_ = Pika_malloc(sizeof(T)); \
-    p = new (ptrvoid##p_) T args;               \
+    GCALLOC(eng, T, p, args);                   \
     eng->AddToGC(p);                            \
 }                                               \
 while (false)
@@ -79,7 +79,7 @@ void Module::Shutdown()
 Module* Module::Create(Engine* eng, String* name, String* path, String* fun, String* ver)
 {
     Module* nl = 0;
-    PIKA_NEW(Module, nl, (eng, eng->Module_Type, name, path, fun, ver));
+    GCALLOC(eng, Module, nl, (eng, eng->Module_Type, name, path, fun, ver));
     eng->AddModule(nl);
     eng->AddToGC(nl);
     return nl;
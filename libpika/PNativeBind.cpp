@@ -43,8 +43,8 @@ HookedFunction* HookedFunction::Create(Engine* eng,
 {
     HookedFunction* bm = 0;
     NativeDef* cnf;
-    PIKA_NEW(NativeDef, cnf, (ndef));
-    PIKA_NEW(HookedFunction, bm, (eng, type, def, cnf, info, pkg));
+    GCALLOC(eng, NativeDef, cnf, (ndef));
+    GCALLOC(eng, HookedFunction, bm, (eng, type, def, cnf, info, pkg));
     eng->AddToGCNoRun(cnf);
     eng->AddToGCNoRun(bm);
     return bm;
@@ -95,7 +95,7 @@ int HookedFunction::Hook(Context* ctx, Value& self)
                        bm->info->GetName());
     }
     
-    Basic* obj = self.val.basic;
+    Basic* obj = self.GetBasic();
     bm->Invoke(obj, ctx);
     return bm->GetRetCount();
 }
@@ -49,7 +49,7 @@ struct VarType<Object*>
 
     INLINE VarType() { }
     INLINE VarType(Context* ctx, u2 arg) { val = ctx->GetObjectArg(arg); }
-    INLINE VarType(Value* args, u2 arg) { val = args[arg].val.object; }
+    INLINE VarType(Value* args, u2 arg) { val = args[arg].GetObject(); }
 
     INLINE operator Object*() { return val; }
 
@@ -121,7 +121,7 @@ struct VarType<Array*>
 
     INLINE VarType() {}
     INLINE VarType(Context* ctx, u2 arg) { val = ctx->GetObjectArg(arg); }
-    INLINE VarType(Value* args, u2 arg) { val = args[arg].val.object; }
+    INLINE VarType(Value* args, u2 arg) { val = args[arg].GetObject(); }
 
     INLINE operator Array*()
     {
@@ -144,7 +144,7 @@ struct VarType<Array&>
 
     INLINE VarType() { }
     INLINE VarType(Context* ctx, u2 arg) { val = ctx->GetObjectArg(arg); }
-    INLINE VarType(Value* args, u2 arg) { val = args[arg].val.object; }
+    INLINE VarType(Value* args, u2 arg) { val = args[arg].GetObject(); }
 
     INLINE operator Array&()
     {
@@ -167,7 +167,7 @@ struct VarType<float>
 
     INLINE VarType() { }
     INLINE VarType(Context* ctx, u2 arg) { val = (float)ctx->ArgToReal(arg); }
-    INLINE VarType(Value* args, u2 arg)  { val = (float)args[arg].val.real;  }
+    INLINE VarType(Value* args, u2 arg)  { val = (float)args[arg].GetReal();  }
     INLINE operator float() { return val; }
 
     float val;
@@ -184,7 +184,7 @@ struct VarType<double>
 
     INLINE VarType() { }
     INLINE VarType(Context* ctx, u2 arg) { val = (double)ctx->ArgToReal(arg); }
-    INLINE VarType(Value* args, u2 arg)  { val = (double)args[arg].val.real;  }
+    INLINE VarType(Value* args, u2 arg)  { val = (double)args[arg].GetReal();  }
     INLINE operator double() { return val; }
 
     double val;
@@ -201,7 +201,7 @@ struct VarType<bool>
 
     INLINE VarType() { }
     INLINE VarType(Context* ctx, u2 arg) { val = ctx->ArgToBool(arg); }
-    INLINE VarType(Value* args, u2 arg) { val = args[arg].val.index != 0; }
+    INLINE VarType(Value* args, u2 arg) { val = args[arg].GetIndex() != 0; }
     INLINE operator bool() { return val; }
 
     bool val;
@@ -218,7 +218,7 @@ struct VarType<const char*>
 
     INLINE VarType() { }
     INLINE VarType(Context* ctx, u2 arg) { val = ctx->GetStringArg(arg); }
-    INLINE VarType(Value* args, u2 arg) { val = args[arg].val.str; }
+    INLINE VarType(Value* args, u2 arg) { val = args[arg].GetString(); }
     INLINE operator const char*() { return val->GetBuffer(); }
 
     String* val;
@@ -235,7 +235,7 @@ struct VarType<String*>
 
     INLINE VarType() { }
     INLINE VarType(Context* ctx, u2 arg) { val = ctx->GetStringArg(arg); }
-    INLINE VarType(Value* args, u2 arg) { val = args[arg].val.str; }
+    INLINE VarType(Value* args, u2 arg) { val = args[arg].GetString(); }
     INLINE operator String*() { return val; }
 
     String* val;
@@ -754,7 +754,7 @@ NativeMethodBase* MakeStaticMethod(TRet(*func)(TParam0, TParam1, TParam2, TParam
                                                                                                    \
         INLINE VarType() { }                                                                       \
         INLINE VarType(Context* ctx, u2 arg) { val = (TYPE)ctx->ArgToInt(arg); }                   \
-        INLINE VarType(Value* args,  u2 arg) { val = (TYPE)args[arg].val.integer; }                \
+        INLINE VarType(Value* args,  u2 arg) { val = (TYPE)args[arg].GetInteger(); }               \
                                                                                                    \
         INLINE operator TYPE() { return val; }                                                     \
                                                                                                    \
@@ -784,7 +784,7 @@ struct VarType<TCLASS*>
     };                                                                                          \
     INLINE VarType() { }                                                                        \
     INLINE VarType(Context* ctx, u2 arg) { val = ctx->GetObjectArg(arg); }                      \
-    INLINE VarType(Value* args, u2 arg) { val = args[arg].val.object; }                         \
+    INLINE VarType(Value* args, u2 arg) { val = args[arg].GetObject(); }                        \
     INLINE operator TCLASS*()                                                                   \
     {                                                                                           \
         if (!val->IsDerivedFrom(TCLASS::StaticGetClass()))                                      \
@@ -804,7 +804,7 @@ struct VarType<const TCLASS*>
     };                                                                                          \
     INLINE VarType() { }                                                                        \
     INLINE VarType(Context* ctx, u2 arg) { val = ctx->GetObjectArg(arg); }                      \
-    INLINE VarType(Value* args, u2 arg) { val = args[arg].val.object; }                         \
+    INLINE VarType(Value* args, u2 arg) { val = args[arg].GetObject(); }                        \
     INLINE operator const TCLASS*()                                                             \
     {                                                                                           \
         if (!val->IsDerivedFrom(TCLASS::StaticGetClass()))                                      \
@@ -825,7 +825,7 @@ struct VarType<TCLASS&>
     };                                                                                          \
     INLINE VarType() { }                                                                        \
     INLINE VarType(Context* ctx, u2 arg) { val = ctx->GetObjectArg(arg); }                      \
-    INLINE VarType(Value* args, u2 arg) { val = args[arg].val.object; }                         \
+    INLINE VarType(Value* args, u2 arg) { val = args[arg].GetObject(); }                        \
     INLINE operator TCLASS&()                                                                   \
     {                                                                                           \
         if (!val->IsDerivedFrom(TCLASS::StaticGetClass()))                                      \
@@ -921,7 +921,7 @@ struct VarType<Function*>
     
     INLINE VarType(Context* ctx, u2 arg) { val = ctx->GetObjectArg(arg); }
     
-    INLINE VarType(Value* args, u2 arg) { val = args[arg].val.object; }
+    INLINE VarType(Value* args, u2 arg) { val = args[arg].GetObject(); }
     
     INLINE operator Function*()
     {
@@ -930,7 +930,7 @@ struct VarType<Function*>
             Value res;
             if (GetOverrideFrom(val->GetEngine(), val, OVR_call, res))
             {
-                return (Function*)res.val.object;
+                return (Function*)res.GetObject();
             }
             else
             {
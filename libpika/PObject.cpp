@@ -15,6 +15,9 @@
 #include "PNativeBind.h"
 #include "PObjectIterator.h"
 #include "PProxy.h"
+#include "PLocalsObject.h"
+#include "PByteArray.h"
+#include "PShape.h"
 
 
 /////////////////////////////////////////////// pika ///////////////////////////////////////////////
@@ -31,10 +34,72 @@ Iterator* CreateSlotEnumerator(Engine* engine, IterateKind kind, Object* self, T
     GCNEW(engine, ObjectIterator, newEnumerator, (engine, engine->Iterator_Type, kind, self, table));
     return newEnumerator;
 }
+
+/** Iterates over the instance variables of an object in shape mode without moving them into a 
+  * Table. Keys are taken from the Shape and values are read through Object::GetMember.
+  */
+class ShapeIterator : public ObjectIterator
+{
+public:
+    ShapeIterator(Engine* eng, Type* typ, IterateKind k, Object* obj)
+            : ObjectIterator(eng, typ, k, obj, 0, true), object(obj)
+    {
+        Rewind();
+    }
+protected:
+    virtual void CollectKeys(Buffer<Value>& keys)
+    {
+        keys.Clear();
+        if (Shape* shape = object->GetShape())
+        {
+            for (u2 i = 0; i < shape->GetCount(); ++i)
+            {
+                if (!(shape->GetAttr(i) & Slot::ATTR_noenum))
+                    keys.Push(Value(shape->GetKey(i)));
+            }
+        }
+        else if (Table* table = object->MembersPtr())
+        {
+            // The object has left shape mode since the iterator was created.
+            for (Table::Iterator curr = table->GetIterator(); curr; ++curr)
+            {
+                if (!(curr->attr & Slot::ATTR_noenum))
+                    keys.Push(curr->key);
+            }
+        }
+    }
+    
+    virtual bool GetValue(const Value& key, Value& res)
+    {
+        return object->GetMember(key, res);
+    }
+    
+    Object* object;
+};
 ////////////////////////////////////////////// Object //////////////////////////////////////////////
 
 PIKA_IMPL(Object)
 
+Object::Object(const Object* rhs)
+        : Basic(rhs->engine), type(rhs->type), members(0), shape(0), slots(0)
+{ 
+    if (rhs->members)
+    {
+        Members(*(rhs->members));
+    }
+    else if (rhs->shape)
+    {
+        size_t capacity = Shape::GetCapacity(rhs->shape->GetCount());
+        if (capacity)
+        {
+            slots = (Value*)Pika_malloc(capacity * sizeof(Value));
+            Pika_memcpy(slots, rhs->slots, rhs->shape->GetCount() * sizeof(Value));
+        }
+        shape = rhs->shape;
+    }
+    engine->GetGC()->ChargeExternal(0, Object::GetExternalBytes());
+}
+
 Object::~Object()
 {
 #if defined(PIKA_USE_TABLE_POOL) 
@@ -43,12 +108,21 @@ Object::~Object()
 #else
     delete members;
 #endif
+    Pika_free(slots);
 }
 
 Object* Object::StaticNew(Engine* eng, Type* type)
 {
+    // Create the shape first so that it is reachable from type if the
+    // allocation of the object runs the collector.
+    Shape* shape = type ? type->GetInstanceShape() : 0;
     Object* newObject = 0;
     GCNEW(eng, Object, newObject, (eng, type));
+    if (shape)
+    {
+        newObject->shape = shape;
+        newObject->WriteBarrier(shape);
+    }
     return newObject;
 }
 
@@ -56,6 +130,19 @@ void Object::MarkRefs(Collector* c)
 {
     if (members) members->DoMark(c);
     if (type)    type->Mark(c);
+    if (shape)
+    {
+        shape->Mark(c);
+        MarkValues(c, slots, slots + shape->GetCount());
+    }
+}
+
+size_t Object::GetExternalBytes() const
+{
+    size_t bytes = members ? members->GetBytes() : 0;
+    if (shape)
+        bytes += Shape::GetCapacity(shape->GetCount()) * sizeof(Value);
+    return bytes;
 }
 
 String* Object::ToString()
@@ -134,15 +221,103 @@ bool Object::SetSlot(const Value& key, Value& val, u4 attr)
         WriteBarrier(key);
     if (val.IsCollectible())
         WriteBarrier(val);
-    if (!Members().Set(key, val, attr))
+    return SetMember(key, val, attr);
+}
+
+bool Object::SetMember(const Value& key, Value& val, u4 attr)
+{
+    if (shape)
     {
+        // ATTR_forcewrite only affects this write so we do not store it in the shape.
+        u4 shapeAttr = attr & ~Slot::ATTR_forcewrite;
+        u2 index = 0;
+        if (key.GetTag() == TAG_string)
+        {
+            if (shape->Find(key.GetString(), index))
+            {
+                if (!shapeAttr || shapeAttr == shape->GetAttr(index))
+                {
+                    slots[index] = val;
+                    return true;
+                }
+            }
+            else if (shape->GetCount() < PIKA_MAX_SHAPE_SLOTS && key.GetString()->IsInterned())
+            {
+                if (Shape* next = shape->AddKey(key.GetString(), shapeAttr))
+                {
+                    size_t count    = shape->GetCount();
+                    size_t capacity = Shape::GetCapacity(count + 1);
+                    
+                    if (capacity != Shape::GetCapacity(count))
+                    {
+                        slots = (Value*)Pika_realloc(slots, capacity * sizeof(Value));
+                        engine->GetGC()->ChargeExternal(Shape::GetCapacity(count) * sizeof(Value), capacity * sizeof(Value));
+                    }
+                    slots[count] = val;
+                    shape = next;
+                    WriteBarrier(next);
+                    return true;
+                }
+            }
+        }
+        // Non-string keys, Strings that are not interned, changed attributes, large objects and
+        // Shapes with too many transitions use a Table.
+        ToDictionary();
+    }
+    GCCHARGE(engine, this);
+    return Members().Set(key, val, attr);
+}
+
+void Object::ToDictionary()
+{
+    if (!shape)
+        return;
+    
+    GCCHARGE(engine, this);
+    Shape* oldShape = shape;
+    Value* oldSlots = slots;
+    
+    shape = 0;
+    slots = 0;
+    
+    if (!oldShape->GetCount())
+        return;
+        
+    Table& table = Members();
+    for (u2 i = 0; i < oldShape->GetCount(); ++i)
+    {
+        table.Set(Value(oldShape->GetKey(i)), oldSlots[i], oldShape->GetAttr(i));
+    }
+    Pika_free(oldSlots);
+}
+
+bool Object::GetMember(const Value& key, Value& result)
+{
+    if (shape)
+    {
+        u2 index = 0;
+        if (key.GetTag() == TAG_string && shape->Find(key.GetString(), index))
+        {
+            result = slots[index];
+            return true;
+        }
         return false;
     }
-    return true;
+    return members && members->Get(key, result);
 }
 
 bool Object::GetSlot(const Value& key, Value& result)
 {
+    if (shape)
+    {
+        u2 index = 0;
+        if (key.GetTag() == TAG_string && shape->Find(key.GetString(), index))
+        {
+            result = slots[index];
+            return true;
+        }
+        return type && type->GetField(key, result);
+    }
     if (!members || !members->Get(key, result))
     {
         if (!type || !type->GetField(key, result))
@@ -153,12 +328,190 @@ bool Object::GetSlot(const Value& key, Value& result)
     return true;
 }
 
+/* Returns true if instances of the native class info read and write their 
+ * slots through Object::GetSlot and Object::SetSlot. */
+static bool UsesObjectSlots(ClassInfo* info)
+{
+    return !info->IsDerivedFrom(Package::StaticGetClass())      &&
+           !info->IsDerivedFrom(LocalsObject::StaticGetClass()) &&
+           !info->IsDerivedFrom(ByteArray::StaticGetClass());
+}
+
+MemberCacheEntry* Object::FindCacheEntry(MemberCache& ic)
+{
+    ClassInfo* info = GetClassInfo();
+    for (u4 i = 0; i < ic.count; ++i)
+    {
+        if (ic.entries[i].type == type && ic.entries[i].info == info)
+        {
+            return &ic.entries[i];
+        }
+    }
+    return 0;
+}
+
+MemberCacheEntry* Object::GetCacheEntry(const Value& key, MemberCache& ic, MemberCacheEntry* entry)
+{
+    if (!type)
+        return 0;
+        
+    size_t stamp = engine->GetTypeEpoch();
+    
+    if (entry && entry->stamp == stamp)
+    {
+        ++ic.hits;
+        return entry;
+    }
+    
+    if (!entry)
+    {
+        if (ic.count == PIKA_MEMBER_CACHE_SIZE)
+        {
+            ++ic.megamorphic;
+            return 0;
+        }
+        entry = &ic.entries[ic.count++];
+        engine->GetGC()->WriteBarrier(ic.owner, type);
+    }
+    ++ic.misses;
+    
+    entry->info  = GetClassInfo();
+    entry->type  = type;
+    entry->stamp = stamp;
+    entry->slot  = 0;
+    entry->flags = 0;
+    entry->shape = 0;
+    entry->index = Shape::NO_INDEX;
+    
+    if (UsesObjectSlots(entry->info))
+    {
+        Value setfn(NULL_VALUE);
+        
+        entry->slot   = type->GetFieldSlot(key);
+        entry->flags |= MCF_get;
+        
+        if (type->CanSetField(key) && !type->GetField(engine->GetOverrideString(OVR_set), setfn))
+        {
+            entry->flags |= MCF_set;
+        }
+    }
+    return entry;
+}
+
+u2 Object::GetShapeIndex(const Value& key, MemberCache& ic, MemberCacheEntry& entry)
+{
+    if (entry.shape != shape)
+    {
+        u2 index = 0;
+        entry.shape = shape;
+        entry.index = (key.GetTag() == TAG_string && shape->Find(key.GetString(), index)) ? index : (u2)Shape::NO_INDEX;
+        engine->GetGC()->WriteBarrier(ic.owner, shape);
+    }
+    return entry.index;
+}
+
+bool Object::GetSlotCached(const Value& key, Value& result, MemberCache& ic)
+{
+    MemberCacheEntry* entry = FindCacheEntry(ic);
+    bool searchedMembers = false;
+    
+    // Instance variables do not depend on the type hierarchy, so the entry
+    // does not need to be validated.
+    if (entry && (entry->flags & MCF_get))
+    {
+        if (shape)
+        {
+            u2 index = GetShapeIndex(key, ic, *entry);
+            if (index != Shape::NO_INDEX)
+            {
+                ++ic.hits;
+                result = slots[index];
+                return true;
+            }
+        }
+        else if (members && members->Get(key, result))
+        {
+            ++ic.hits;
+            return true;
+        }
+        searchedMembers = true;
+    }
+    
+    entry = GetCacheEntry(key, ic, entry);
+    
+    if (!entry || !(entry->flags & MCF_get))
+        return GetSlot(key, result);
+    
+    if (!searchedMembers)
+    {
+        if (shape)
+        {
+            u2 index = GetShapeIndex(key, ic, *entry);
+            if (index != Shape::NO_INDEX)
+            {
+                result = slots[index];
+                return true;
+            }
+        }
+        else if (members && members->Get(key, result))
+        {
+            return true;
+        }
+    }
+    
+    if (entry->slot)
+    {
+        result = entry->slot->val;
+        return true;
+    }
+    return false;
+}
+
+bool Object::SetSlotCached(const Value& key, Value& value, MemberCache& ic)
+{
+    MemberCacheEntry* entry = GetCacheEntry(key, ic, FindCacheEntry(ic));
+    
+    if (!entry || !(entry->flags & MCF_set))
+        return false;
+    
+    if (shape)
+    {
+        u2 index = GetShapeIndex(key, ic, *entry);
+        if (index != Shape::NO_INDEX)
+        {
+            if (slots[index].GetTag() == TAG_property || (shape->GetAttr(index) & Slot::ATTR_final))
+                return false;
+            if (value.IsCollectible())
+                WriteBarrier(value);
+            slots[index] = value;
+            return true;
+        }
+    }
+    else if (Slot* slot = members ? members->GetSlot(key) : 0)
+    {
+        if (slot->val.GetTag() == TAG_property || (slot->attr & Slot::ATTR_final))
+            return false;
+        if (value.IsCollectible())
+            WriteBarrier(value);
+        slot->val = value;
+        return true;
+    }
+    if (key.IsCollectible())
+        WriteBarrier(key);
+    if (value.IsCollectible())
+        WriteBarrier(value);
+    return SetMember(key, value, 0);
+}
+
 bool Object::HasSlot(const Value& key)
 {
+    u2 index = 0;
+    if (shape && key.GetTag() == TAG_string && shape->Find(key.GetString(), index))
+        return true;
     if (members && members->Exists(key))
         return true;
     Value res(NULL_VALUE);
-    if (type->GetField(key, res) && res.tag == TAG_property) {
+    if (type->GetField(key, res) && res.GetTag() == TAG_property) {
         // TODO: Check that property.reader.location == type or property.writer.location == type
         return true;
     }
@@ -167,12 +520,28 @@ bool Object::HasSlot(const Value& key)
 
 bool Object::DeleteSlot(const Value& key)
 {
+    if (shape)
+    {
+        u2 index = 0;
+        if (key.GetTag() != TAG_string || !shape->Find(key.GetString(), index))
+            return false;
+        // Shapes only describe variables that are added, so removing one requires a Table.
+        ToDictionary();
+    }
     return members ? members->Remove(key) : false;
 }
 
 bool Object::CanSetSlot(const Value& key)
 {
     Table::ESlotState ss = members ? members->CanSet(key) : Table::SS_nil;
+    if (shape)
+    {
+        u2 index = 0;
+        if (key.GetTag() == TAG_string && shape->Find(key.GetString(), index))
+        {
+            ss = (slots[index].GetTag() != TAG_property) && !(shape->GetAttr(index) & Slot::ATTR_final) ? Table::SS_yes : Table::SS_no;
+        }
+    }
     switch (ss)
     {
     case Table::SS_yes: return true;
@@ -193,7 +562,7 @@ bool Object::BracketWrite(const Value& key, Value& val, u4 attr)
         WriteBarrier(key);
     if (val.IsCollectible())
         WriteBarrier(val);
-    return Members().Set(key, val, attr | Slot::ATTR_forcewrite);
+    return SetMember(key, val, attr | Slot::ATTR_forcewrite);
 }
 
 Object* Object::Clone()
@@ -205,7 +574,7 @@ Object* Object::Clone()
 
 Iterator* Object::Iterate(String* enumType)
 {
-    if (!members)
+    if (!members && !(shape && shape->GetCount()))
     {
         return Iterator::Create(engine, engine->Iterator_Type);
     }
@@ -219,6 +588,13 @@ Iterator* Object::Iterate(String* enumType)
     {
         k = IK_keys;
     }
+    
+    if (shape)
+    {
+        Iterator* newEnumerator = 0;
+        GCNEW(engine, ShapeIterator, newEnumerator, (engine, engine->Iterator_Type, k, this));
+        return newEnumerator;
+    }
     Iterator* newEnumerator = CreateSlotEnumerator(engine, k, this, this->members);
     return newEnumerator;
 }
@@ -336,6 +712,10 @@ Table& Object::Members(const Table& other)
 
 Table& Object::Members()
 {
+    if (shape)
+    {
+        ToDictionary();
+    }
     if (!members)
     {
 #if defined(PIKA_USE_TABLE_POOL)    
@@ -353,7 +733,7 @@ int Object_remove(Context* ctx, Value& self)
 {
     u2      argc = ctx->GetArgCount();
     Value*  argv = ctx->GetArgs();
-    Object* obj  = self.val.object;
+    Object* obj  = self.GetObject();
     
     for (u2 a = 0; a < argc; ++a)
     {
@@ -364,7 +744,7 @@ int Object_remove(Context* ctx, Value& self)
 
 int Object_getEnumerator(Context* ctx, Value& self)
 {
-    Object* obj = self.val.object;
+    Object* obj = self.GetObject();
     String* iter_type = 0;
     u2 argc = ctx->GetArgCount();
     
@@ -393,7 +773,7 @@ int Object_getEnumerator(Context* ctx, Value& self)
 
 int Object_clone(Context* ctx, Value& self)
 {
-    Object* obj = self.val.object;
+    Object* obj = self.GetObject();
     Object* newobj = obj->Clone();
     
     if (newobj)
@@ -406,7 +786,7 @@ int Object_clone(Context* ctx, Value& self)
 
 int Object_init(Context* ctx, Value& self)
 {
-    Object* obj = self.val.object;
+    Object* obj = self.GetObject();
     obj->Init(ctx);
     ctx->Push(self);
     return 1;
@@ -414,7 +794,7 @@ int Object_init(Context* ctx, Value& self)
 
 int Object_toString(Context* ctx, Value& self)
 {
-    Object* obj = self.val.object;
+    Object* obj = self.GetObject();
     String* rep = obj->ToString();
     ctx->Push(rep);
     return 1;
@@ -473,7 +853,7 @@ int Object_setElement(Context* ctx, Value& self)
 int Property_toString(Context* ctx, Value& self)
 {
     Engine*   eng    = ctx->GetEngine();
-    Property* prop   = self.val.property;
+    Property* prop   = self.GetProperty();
     String*   type   = prop->GetType()->GetName();
     String*   name   = prop->Name();
     String*   result = eng->AllocStringFmt("%s %s", type->GetBuffer(), name->GetBuffer());
@@ -24,6 +24,9 @@ class Array;
 class Type;
 class Object;
 class Iterator;
+class Shape;
+struct MemberCache;
+struct MemberCacheEntry;
 
 /** Instance creation function used by types. */
 typedef void (*Type_NewFn)(Engine*, Type*, Value&);
@@ -41,16 +44,9 @@ public:
 #   endif
     friend class ObjectIterator;
 protected:
-    INLINE Object(Engine* eng, Type* typeObj) : Basic(eng), type(typeObj), members(0) {}
-    
-    INLINE Object(const Object* rhs)
-            : Basic(rhs->engine), type(rhs->type), members(0)
-    { 
-        if (rhs->members)
-        {
-            Members(*(rhs->members));
-        }
-    }
+    INLINE Object(Engine* eng, Type* typeObj) : Basic(eng), type(typeObj), members(0), shape(0), slots(0) {}
+    
+    Object(const Object* rhs);
 public:
     virtual ~Object();
     
@@ -65,6 +61,25 @@ public:
     
     virtual bool  GetSlot(const Value& key, Value& result);
     
+    /** Equivalent to GetSlot but uses the inline cache ic to skip searching the 
+      * type hierarchy. Used by the interpreter for member access.
+      *
+      * @param key      [in]  The slot's name.
+      * @param result   [out] The slot's value.
+      * @param ic       [in]  The inline cache of the member access site.
+      */
+    bool GetSlotCached(const Value& key, Value& result, MemberCache& ic);
+    
+    /** Sets an instance variable using the inline cache ic. Unlike SetSlot this
+      * will fail if the type has an opSet override or if the slot cannot be 
+      * cached, in which case the caller must perform the full member set.
+      *
+      * @param key      [in] The slot's name.
+      * @param value    [in] The value to set the slot to.
+      * @param ic       [in] The inline cache of the member access site.
+      */
+    bool SetSlotCached(const Value& key, Value& value, MemberCache& ic);
+    
     virtual bool  HasSlot(const Value& key);
     
     virtual bool  DeleteSlot(const Value& key);
@@ -73,6 +88,12 @@ public:
     virtual bool  BracketWrite(const Value& key, Value& value, u4 attr = 0);
     
     virtual void  MarkRefs(Collector*);
+    virtual size_t GetExternalBytes() const;
+    
+    /** Only plain Objects, without a member Table, can be destroyed by the sweep thread. The 
+      * Engine's Table pool is not thread safe.
+      */
+    virtual bool  CanFreeInBackground() { return !members && GetClassInfo() == StaticGetClass(); }
 
     virtual Object* Clone();
     virtual String* ToString();
@@ -128,10 +149,27 @@ public:
     static void Constructor(Engine* eng, Type* obj_type, Value& res);
     static void StaticInitType(Engine* eng);
 
-    Table* MembersPtr() { return members; }
+    /** Returns this object's members Table or null if it has not been created. 
+      * An object in shape mode is converted to dictionary mode first.
+      */
+    Table* MembersPtr() { if (shape) ToDictionary(); return members; }
+    
+    /** Returns true if the object's instance variables are stored in a slot array
+      * described by a Shape rather than a Table.
+      */
+    INLINE bool IsShaped() const { return shape != 0; }
+    
+    /** Returns the Shape describing the object's slot array or null if it is in dictionary mode. */
+    INLINE Shape* GetShape() const { return shape; }
+    
+    /** Reads one of this object's own instance variables, ignoring its type. Unlike 
+      * MembersPtr this leaves an object in shape mode alone.
+      */
+    bool GetMember(const Value& key, Value& result);
 protected:
     /** Return a reference to this object's members Table. If the table does not
-      * exist it will be created.
+      * exist it will be created. An object in shape mode is converted to dictionary 
+      * mode first, so only use this to write. Readers should use GetMember.
       */
     Table& Members();
     
@@ -142,6 +180,29 @@ protected:
       */
     Table& Members(const Table& other);
     
+    /** Sets an instance variable without checking whether it can be set. Objects 
+      * in shape mode will add the variable to their Shape if possible.
+      */
+    bool SetMember(const Value& key, Value& val, u4 attr);
+    
+    /** Moves the instance variables of an object in shape mode into its members 
+      * Table. The object is not put back into shape mode.
+      */
+    void ToDictionary();
+    
+    /** Returns the index of key in this object's slot array, or Shape::NO_INDEX. The index is 
+      * remembered by entry until a different shape is seen.
+      */
+    u2 GetShapeIndex(const Value& key, MemberCache& ic, MemberCacheEntry& entry);
+    
+    /** Returns the entry of ic for this object's type without validating it, or null. */
+    MemberCacheEntry* FindCacheEntry(MemberCache& ic);
+    
+    /** Validates entry, the result of FindCacheEntry, filling it or a new entry if needed. 
+      * Returns null if the cache is megamorphic.
+      */
+    MemberCacheEntry* GetCacheEntry(const Value& key, MemberCache& ic, MemberCacheEntry* entry);
+    
     /** This object's type. 
       *
       * @warning All object should have a type so make sure when you create an
@@ -160,6 +221,17 @@ protected:
       * existing first, do not create it unless you are writing to it.
       */
     Table* members; // Instance Variables
+    
+    /** Shape describing slots. When null the object is in dictionary mode and 
+      * its instance variables are kept in members. Only instances of Object
+      * itself are created in shape mode.
+      */
+    Shape* shape;
+    
+    /** Values of the instance variables described by shape. 
+      * Its length is Shape::GetCapacity(shape->GetCount()).
+      */
+    Value* slots;
 };
 
 #define GETSELF(TYPE, OBJ, TYPENAME)                                                \
@@ -169,7 +241,7 @@ if ( !self.IsDerivedFrom(TYPE::StaticGetClass()) )
                    "Attempt to call function with incorrect type.\n expecting %s",  \
                    TYPENAME);                                                       \
 }                                                                                   \
-TYPE* OBJ = (TYPE*)self.val.object;
+TYPE* OBJ = (TYPE*)self.GetObject();
 
 }// pika
 
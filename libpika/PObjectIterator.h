@@ -19,7 +19,40 @@ public:
     }
     
     virtual ~ObjectIterator() {}
+protected:
+    /** Used by derived classes, which must call Rewind themselves. tab can be null if the 
+      * derived class overrides CollectKeys and GetValue.
+      */
+    ObjectIterator(Engine* eng, Type* typ, IterateKind k, Object* obj, Table* tab, bool)
+            : Iterator(eng, typ), kind(k), valid(false), started(false), owner(obj), table(tab)
+    {
+        key.SetNull();
+        val.SetNull();
+    }
+    
+    /** Fills keys with every enumerable key. */
+    virtual void CollectKeys(Buffer<Value>& keys)
+    {
+        size_t s = 0;
+        keys.Resize(table->count);
+        for (Table::Iterator curr = table->GetIterator(); curr; ++curr)
+        {
+            if (!(curr->attr & Slot::ATTR_noenum))
+            {
+                ASSERT(s < table->count);
+                keys[s++] = curr->key;
+            }
+        }
+        if (s < keys.GetSize())
+            keys.Resize(s);
+    }
     
+    /** Reads the current value of key, returns false if it has been removed. */
+    virtual bool GetValue(const Value& key, Value& res)
+    {
+        return table->Get(key, res);
+    }
+public:
     virtual bool FilterValue(Value& key, Object* obj)
     {
         return true;
@@ -27,36 +60,14 @@ public:
     
     virtual bool Rewind()
     {
-        if (!table)
+        if (!table && !owner)
             return false;
         started = true;
-        Slot* curr = 0;
-        size_t bin = 0;
-        size_t sz  = table->size; // size of table.slots[]
-        size_t count = table->count; // # of elements in table
-        if (owner && sz)
+        if (owner)
         {
             // Build an array of keys so that any changes made to the slot table
             // do not effect us.
-            
-            slots.Resize(count);
-            size_t s = 0;
-            for (bin = 0; bin < sz; ++bin)
-            {
-                curr = table->rows[bin];
-                
-                while (curr)
-                {
-                    if (!(curr->attr & Slot::ATTR_noenum))
-                    {
-                        ASSERT(s < count);
-                        slots[s++] = curr->key;
-                    }
-                    curr = curr->next;
-                }
-            }
-            if (s < count)
-                slots.Resize(s);
+            CollectKeys(slots);
             currSlot = slots.Begin();
             valid = true;
             MoveCurrent();
@@ -119,7 +130,7 @@ public:
     {
         if (started && (currSlot < slots.End()))
         {            
-            if (table->Get(*currSlot, val) && FilterValue(val, owner))
+            if (GetValue(*currSlot, val) && FilterValue(val, owner))
             {
                 key = *currSlot;
                 return;
@@ -90,8 +90,8 @@
     DECL_OP( OP_tailcall,       "tailcall",     3, OF_bb,       "" )
     DECL_OP( OP_call,           "call",         4, OF_bbb,      "" )
     
-    DECL_OP( OP_dotget,         "dotget",       1, OF_none,     "" )
-    DECL_OP( OP_dotset,         "dotset",       1, OF_none,     "" )
+    DECL_OP( OP_dotget,         "dotget",       3, OF_w,        "Gets a member of an object. The operand is the literal index of the member's name, used for caching." )
+    DECL_OP( OP_dotset,         "dotset",       3, OF_w,        "Sets a member of an object. The operand is the literal index of the member's name, used for caching." )
     
     DECL_OP( OP_subget,         "subget",       1, OF_none,     "" )
     DECL_OP( OP_subset,         "subset",       1, OF_none,     "" )
@@ -142,3 +142,68 @@
     DECL_OP( OP_pushpkg,        "pushenv",      1, OF_none,     "" )
     DECL_OP( OP_poppkg,         "popenv",       1, OF_none,     "" )
 
+    
+    // Quickened opcodes. These are never emitted by the compiler. A generic arithmetic or comparison
+    // opcode rewrites itself into one of these after seeing operands of matching types, and the
+    // quickened opcode rewrites itself back when it sees anything else.
+    
+    DECL_OP( OP_add_ii,         "add_ii",       1, OF_none,     "Quickened add for two integers." )
+    DECL_OP( OP_add_rr,         "add_rr",       1, OF_none,     "Quickened add for two reals." )
+    DECL_OP( OP_sub_ii,         "sub_ii",       1, OF_none,     "Quickened sub for two integers." )
+    DECL_OP( OP_sub_rr,         "sub_rr",       1, OF_none,     "Quickened sub for two reals." )
+    DECL_OP( OP_mul_ii,         "mul_ii",       1, OF_none,     "Quickened mul for two integers." )
+    DECL_OP( OP_mul_rr,         "mul_rr",       1, OF_none,     "Quickened mul for two reals." )
+    DECL_OP( OP_div_rr,         "div_rr",       1, OF_none,     "Quickened div for two reals." )
+    
+    DECL_OP( OP_eq_ii,          "eq_ii",        1, OF_none,     "Quickened eq for two integers." )
+    DECL_OP( OP_ne_ii,          "ne_ii",        1, OF_none,     "Quickened ne for two integers." )
+    
+    DECL_OP( OP_lt_ii,          "lt_ii",        1, OF_none,     "Quickened lt for two integers." )
+    DECL_OP( OP_lt_rr,          "lt_rr",        1, OF_none,     "Quickened lt for two reals." )
+    DECL_OP( OP_gt_ii,          "gt_ii",        1, OF_none,     "Quickened gt for two integers." )
+    DECL_OP( OP_gt_rr,          "gt_rr",        1, OF_none,     "Quickened gt for two reals." )
+    DECL_OP( OP_lte_ii,         "lte_ii",       1, OF_none,     "Quickened lte for two integers." )
+    DECL_OP( OP_lte_rr,         "lte_rr",       1, OF_none,     "Quickened lte for two reals." )
+    DECL_OP( OP_gte_ii,         "gte_ii",       1, OF_none,     "Quickened gte for two integers." )
+    DECL_OP( OP_gte_rr,         "gte_rr",       1, OF_none,     "Quickened gte for two reals." )
+    
+    DECL_OP( OP_cat_ss,         "cat_ss",       1, OF_none,     "Quickened cat for two strings." )
+    
+    // Superinstructions. These replace the first instruction of a common sequence, see
+    // Compiler::Fuse. The rest of the sequence stays in the bytecode and supplies the remaining
+    // operands. In the names l is a pushlocal, k a pushliteral, d a dup, jf a jumpiffalse and
+    // sl a setlocal.
+    
+    DECL_OP( OP_pushll,         "pushll",       3, OF_w,        "pushlocal; pushlocal" )
+    DECL_OP( OP_pushlk,         "pushlk",       3, OF_w,        "pushlocal; pushliteral" )
+    
+    DECL_OP( OP_add_ll,         "add_ll",       3, OF_w,        "pushlocal; pushlocal; add" )
+    DECL_OP( OP_sub_ll,         "sub_ll",       3, OF_w,        "pushlocal; pushlocal; sub" )
+    DECL_OP( OP_mul_ll,         "mul_ll",       3, OF_w,        "pushlocal; pushlocal; mul" )
+    DECL_OP( OP_add_lk,         "add_lk",       3, OF_w,        "pushlocal; pushliteral; add" )
+    DECL_OP( OP_sub_lk,         "sub_lk",       3, OF_w,        "pushlocal; pushliteral; sub" )
+    DECL_OP( OP_mul_lk,         "mul_lk",       3, OF_w,        "pushlocal; pushliteral; mul" )
+    
+    DECL_OP( OP_add_ll_sl,      "add_ll_sl",    3, OF_w,        "pushlocal; pushlocal; add; setlocal" )
+    DECL_OP( OP_add_lk_sl,      "add_lk_sl",    3, OF_w,        "pushlocal; pushliteral; add; setlocal" )
+    DECL_OP( OP_sub_lk_sl,      "sub_lk_sl",    3, OF_w,        "pushlocal; pushliteral; sub; setlocal" )
+    DECL_OP( OP_add_sl,         "add_sl",       1, OF_none,     "add; setlocal" )
+    
+    DECL_OP( OP_eq_ll_jf,       "eq_ll_jf",     3, OF_w,        "pushlocal; pushlocal; eq; jumpiffalse" )
+    DECL_OP( OP_ne_ll_jf,       "ne_ll_jf",     3, OF_w,        "pushlocal; pushlocal; ne; jumpiffalse" )
+    DECL_OP( OP_lt_ll_jf,       "lt_ll_jf",     3, OF_w,        "pushlocal; pushlocal; lt; jumpiffalse" )
+    DECL_OP( OP_gt_ll_jf,       "gt_ll_jf",     3, OF_w,        "pushlocal; pushlocal; gt; jumpiffalse" )
+    DECL_OP( OP_lte_ll_jf,      "lte_ll_jf",    3, OF_w,        "pushlocal; pushlocal; lte; jumpiffalse" )
+    DECL_OP( OP_gte_ll_jf,      "gte_ll_jf",    3, OF_w,        "pushlocal; pushlocal; gte; jumpiffalse" )
+    DECL_OP( OP_eq_lk_jf,       "eq_lk_jf",     3, OF_w,        "pushlocal; pushliteral; eq; jumpiffalse" )
+    DECL_OP( OP_ne_lk_jf,       "ne_lk_jf",     3, OF_w,        "pushlocal; pushliteral; ne; jumpiffalse" )
+    DECL_OP( OP_lt_lk_jf,       "lt_lk_jf",     3, OF_w,        "pushlocal; pushliteral; lt; jumpiffalse" )
+    DECL_OP( OP_gt_lk_jf,       "gt_lk_jf",     3, OF_w,        "pushlocal; pushliteral; gt; jumpiffalse" )
+    DECL_OP( OP_lte_lk_jf,      "lte_lk_jf",    3, OF_w,        "pushlocal; pushliteral; lte; jumpiffalse" )
+    DECL_OP( OP_gte_lk_jf,      "gte_lk_jf",    3, OF_w,        "pushlocal; pushliteral; gte; jumpiffalse" )
+    
+    DECL_OP( OP_setlocal_jump,  "setlocal_jump",3, OF_w,        "setlocal; jump" )
+    DECL_OP( OP_pushnull_pushglobal, "pushnull_pushglobal", 1, OF_none, "pushnull; pushglobal" )
+    DECL_OP( OP_dotget_lk,      "dotget_lk",    3, OF_w,        "pushlocal; pushliteral; dotget" )
+    DECL_OP( OP_dotget_dk,      "dotget_dk",    1, OF_none,     "dup; pushliteral; dotget" )
+    DECL_OP( OP_ret_l,          "ret_l",        3, OF_w,        "pushlocal; ret" )
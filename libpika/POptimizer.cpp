@@ -0,0 +1,584 @@
+/*
+ *  POptimizer.cpp
+ *  See Copyright Notice in Pika.h
+ */
+#include "Pika.h"
+#include "POptimizer.h"
+#include "PContext_Ops.inl"
+
+#define BINARY_FOLD(op, fun)                                                                         \
+case op:                                                                                             \
+{                                                                                                    \
+            if ((res1.GetTag() == TAG_integer || res1.GetTag() == TAG_real) &&                       \
+                (res2.GetTag() == TAG_integer || res2.GetTag() == TAG_real))                         \
+            {                                                                                        \
+                                                                                                     \
+                prevprev->opcode = OP_pushliteral;                                                   \
+                Remove(prev); Remove(curr);                                                          \
+                                                                                                     \
+                if (res1.GetTag() == TAG_integer && res2.GetTag() == TAG_integer)                    \
+                {                                                                                    \
+                    if (op == OP_div && (res1.GetInteger() % res2.GetInteger() != 0))                \
+                    {                                                                                \
+                        preal_t const ra = (preal_t)res1.GetInteger();                               \
+                        preal_t const rb = (preal_t)res2.GetInteger();                               \
+                        res1.Set((preal_t)(ra/rb));                                                  \
+                        prevprev->operand = lp->Add(res1.GetReal());                                 \
+                    }                                                                                \
+                    else                                                                             \
+                    {                                                                                \
+                        pint_t ia = res1.GetInteger();                                               \
+                        pint_t ib = res2.GetInteger();                                               \
+                        fun(ia, ib);                                                                 \
+                        prevprev->operand = lp->Add(ia);                                             \
+                    }                                                                                \
+                }                                                                                    \
+                else                                                                                 \
+                {                                                                                    \
+                    if (res1.GetTag() == TAG_integer)                                                \
+                        res1.Set((preal_t)res1.GetInteger());                                        \
+                    if (res2.GetTag() == TAG_integer)                                                \
+                        res2.Set((preal_t)res2.GetInteger());                                        \
+                                                                                                     \
+                    preal_t ra = res1.GetReal();                                                     \
+                    preal_t rb = res2.GetReal();                                                     \
+                    fun(ra, rb);                                                                     \
+                    if (op == OP_idiv)                                                               \
+                    {                                                                                \
+                        prevprev->operand = lp->Add(Pika_RealToInteger(ra));                         \
+                    }                                                                                \
+                    else                                                                             \
+                    {                                                                                \
+                        prevprev->operand = lp->Add(ra);                                             \
+                    }                                                                                \
+                }                                                                                    \
+                changed = true;                                                                      \
+                curr = prevprev;                                                                     \
+                                                                                                     \
+            }                                                                                        \
+    }break;
+
+
+#define CONTINUE_FOLD_LOOP()  \
+    curr = curr->next; continue;
+
+namespace pika {
+
+namespace {
+
+const int MAX_ROUNDS = 8;  // Most times the passes are repeated at optimization level 2.
+const int MAX_HOPS   = 16; // Longest chain of jumps that ThreadJumps will follow.
+
+INLINE bool IsPushLiteral(const Instr* ir)
+{
+    return ir && ir->opcode >= OP_pushliteral0 && ir->opcode <= OP_pushliteral;
+}
+
+INLINE u2 GetLiteralIndex(const Instr* ir)
+{
+    return ir->opcode == OP_pushliteral ? ir->operand : (u2)(ir->opcode - OP_pushliteral0);
+}
+
+INLINE bool IsJump(const Instr* ir)
+{
+    return ir->opcode == OP_jump || ir->opcode == OP_jumpiffalse || ir->opcode == OP_jumpiftrue;
+}
+
+// Returns the local variable index of a pushlocal or setlocal.
+INLINE u2 GetLocalIndex(const Instr* ir, Opcode first, Opcode generic)
+{
+    return ir->opcode == generic ? ir->operand : (u2)(ir->opcode - first);
+}
+
+// Returns true if the Instr only pushes a value, so that it can be removed along with a pop.
+INLINE bool IsPurePush(const Instr* ir)
+{
+    switch (ir->opcode)
+    {
+    case OP_pushnull:
+    case OP_pushself:
+    case OP_pushtrue:
+    case OP_pushfalse:
+        return true;
+    default:
+        return (ir->opcode >= OP_pushliteral0 && ir->opcode <= OP_pushliteral) ||
+               (ir->opcode >= OP_pushlocal0   && ir->opcode <= OP_pushlocal);
+    }
+}
+
+// Returns true and sets truth if the Instr pushes a value whose truth is known.
+bool IsConstantCondition(const Instr* ir, LiteralPool* lp, bool& truth)
+{
+    switch (ir->opcode)
+    {
+    case OP_pushtrue:  truth = true;  return true;
+    case OP_pushfalse:
+    case OP_pushnull:  truth = false; return true;
+    default:
+        if (IsPushLiteral(ir))
+        {
+            Value res = lp->Get(GetLiteralIndex(ir));
+
+            if (res.GetTag() == TAG_integer)
+            {
+                truth = res.GetInteger() != 0;
+                return true;
+            }
+            else if (res.GetTag() == TAG_real)
+            {
+                truth = Pika_RealToBoolean(res.GetReal());
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Returns true if the Instr can continue on to the Instr that follows it.
+bool FallsThrough(const Instr* ir)
+{
+    switch (ir->opcode)
+    {
+    case OP_jump:
+    case OP_ret:
+    case OP_retacc:
+    case OP_retv:
+    case OP_raise:
+    case OP_tailcall:
+    case OP_tailapply:
+    case OP_retfinally:
+        return false;
+    default:
+        return true;
+    }
+}
+
+// Returns true if control can be transfered to the target of the Instr.
+INLINE bool HasBranchTarget(const Instr* ir)
+{
+    return OpcodeFormats[ir->opcode] == OF_target && ir->target;
+}
+
+// Returns true if the target of the Instr refers to another Instr. Besides branches this includes
+// the end of a local variable's range.
+bool HasTarget(const Instr* ir)
+{
+    if (HasBranchTarget(ir))
+        return true;
+
+    if ((ir->opcode >= OP_setlocal0 && ir->opcode <= OP_setlocal) && ir->operandu1)
+        return ir->target != 0;
+
+    return ir->opcode == OP_forto && ir->target;
+}
+
+// Skips past Instrs that do not produce any bytecode.
+INLINE Instr* SkipEmpty(Instr* ir)
+{
+    while (ir && OpcodeLength(ir->opcode) == 0)
+        ir = ir->next;
+    return ir;
+}
+
+}// namespace
+
+const Optimizer::PassInfo Optimizer::Passes[] = {
+    { 1, &Optimizer::FoldConstants     },
+    { 1, &Optimizer::FoldBranches      },
+    { 2, &Optimizer::ThreadJumps       },
+    { 1, &Optimizer::RemoveUnreachable },
+    { 2, &Optimizer::RemovePairs       },
+    { 1, &Optimizer::NarrowLiterals    },
+    { 0, 0 },
+};
+
+Optimizer::Optimizer(InstrList& code, LiteralPool* literals, int level)
+        : code(code),
+        literals(literals),
+        level(level) {}
+
+Optimizer::~Optimizer() {}
+
+void Optimizer::Run()
+{
+    if (level <= 0 || code.IsEmpty())
+        return;
+
+    int rounds = (level >= 2) ? MAX_ROUNDS : 1;
+
+    for (int round = 0; round < rounds; ++round)
+    {
+        bool changed = false;
+
+        for (const PassInfo* info = Passes; info->pass; ++info)
+        {
+            if (info->level > level)
+                continue;
+
+            if (!FindLabels())
+                return;
+
+            if ((this->*info->pass)())
+                changed = true;
+        }
+        if (!changed)
+            break;
+    }
+}
+
+bool Optimizer::FindLabels()
+{
+    for (Instr* curr = code.head; curr; curr = curr->next)
+    {
+        if (curr->opcode == BREAK_LOOP || curr->opcode == CONTINUE_LOOP)
+            return false;
+        curr->label = false;
+    }
+
+    for (Instr* curr = code.head; curr; curr = curr->next)
+    {
+        if (HasTarget(curr))
+            curr->target->label = true;
+    }
+    return true;
+}
+
+void Optimizer::Remove(Instr* ir)
+{
+    // Hand the line down to the next Instr, which now starts at the same position.
+    if (ir->line && ir->next && !ir->next->line)
+    {
+        ir->next->line = ir->line;
+    }
+    ir->line = 0;
+
+    if (ir->label)
+    {
+        // Something still refers to this Instr so keep it as a position in the code.
+        ir->opcode    = JMP_TARGET;
+        ir->operand   = ir->operandu1 = ir->operandu2 = 0;
+        ir->target    = 0;
+        return;
+    }
+
+    if (ir == code.head) code.head = ir->next;
+    if (ir == code.tail) code.tail = ir->prev;
+    ir->Unattach();
+}
+
+// Folds constant arithmetic operations.
+//
+// We don't want to do any non-trivial conversions or report Type-Errors on operations.
+// Basically do the most we can do without changing the result of the program.
+
+bool Optimizer::FoldConstants()
+{
+    LiteralPool* lp = literals;
+    Instr* curr = code.head;
+    bool changed = false;
+
+    while (curr)
+    {
+        Instr* prev = curr->prev;
+        Instr* prevprev = prev ? prev->prev : 0;
+        bool prevIsConst = IsPushLiteral(prev);
+        bool prevprevIsConst = IsPushLiteral(prevprev);
+
+        if (curr->opcode == OP_neg && prevIsConst && !curr->label)
+        {
+            Value res = lp->Get(GetLiteralIndex(prev));
+
+            if (res.GetTag() == TAG_integer || res.GetTag() == TAG_real)
+            {
+                prev->opcode  = OP_pushliteral;
+                prev->operand = (res.GetTag() == TAG_integer) ? lp->Add(-res.GetInteger()) : lp->Add(-res.GetReal());
+                Remove(curr);
+                changed = true;
+                curr = prev;
+            }
+        }
+        else if ((curr->opcode >= OP_add && curr->opcode <= OP_mod) &&
+                 prevIsConst     &&
+                 prevprevIsConst &&
+                 !curr->label    &&
+                 !prev->label)
+        {
+            Value res1 = lp->Get(GetLiteralIndex(prevprev));
+            Value res2 = lp->Get(GetLiteralIndex(prev));
+
+            if (curr->opcode == OP_div || curr->opcode == OP_idiv || curr->opcode == OP_mod)
+            {
+                if ((res2.GetTag() == TAG_integer && res2.GetInteger() == 0) ||
+                    (res2.GetTag() == TAG_real    && res2.GetReal()    == 0))
+                {
+                    /* division/modulo by zero is a RuntimeError so we skip this operator and let the interpreter
+                     * raise an exception.
+                     *
+                     * TODO: provide a compile time error or warning for division by zero.
+                     */
+                    CONTINUE_FOLD_LOOP();
+                }
+            }
+
+            switch (curr->opcode)
+            {
+                BINARY_FOLD(OP_add,  add_num)
+                BINARY_FOLD(OP_sub,  sub_num)
+                BINARY_FOLD(OP_mul,  mul_num)
+                BINARY_FOLD(OP_div,  div_num)
+                BINARY_FOLD(OP_idiv, div_num)
+                BINARY_FOLD(OP_mod,  mod_num)
+                default: break;
+            }
+        }
+        CONTINUE_FOLD_LOOP();
+    }
+    return changed;
+}
+
+// A conditional jump over a constant condition is either always or never taken. If the condition
+// is duplicated first, as the boolean operators do, the constant is left on the stack.
+//
+// [ pushtrue        ]      [ jump L ]
+// [ jumpiftrue L    ]  ->
+//
+// [ pushtrue        ]      [ pushtrue ]
+// [ dup             ]  ->  [ jump L   ]
+// [ jumpiftrue L    ]
+
+bool Optimizer::FoldBranches()
+{
+    bool changed = false;
+    Instr* next = 0;
+
+    for (Instr* curr = code.head; curr; curr = next)
+    {
+        next = curr->next;
+
+        if ((curr->opcode != OP_jumpiftrue && curr->opcode != OP_jumpiffalse) || curr->label)
+            continue;
+
+        Instr* prev = curr->prev;
+        Instr* idup = 0;
+        bool truth  = false;
+
+        if (prev && prev->opcode == OP_dup && !prev->label)
+        {
+            idup = prev;
+            prev = prev->prev;
+        }
+
+        if (!prev || !IsConstantCondition(prev, literals, truth))
+            continue;
+
+        bool jmp = (curr->opcode == OP_jumpiftrue) == truth;
+
+        if (idup)
+        {
+            Remove(idup);
+        }
+        else
+        {
+            Remove(prev);
+        }
+
+        if (jmp)
+        {
+            curr->opcode = OP_jump;
+        }
+        else
+        {
+            Remove(curr);
+        }
+        changed = true;
+    }
+    return changed;
+}
+
+// Replaces pushliteral with the specialized opcode for the first few literals.
+
+bool Optimizer::NarrowLiterals()
+{
+    bool changed = false;
+
+    for (Instr* curr = code.head; curr; curr = curr->next)
+    {
+        if (curr->opcode == OP_pushliteral && curr->operand < PIKA_NUM_SPECIALIZED_OPCODES)
+        {
+            curr->opcode = (Opcode)(OP_pushliteral0 + curr->operand);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Removes the code that cannot be reached from the start of the function or from an exception
+// handler, along with Instrs that produce no bytecode and are not a target.
+
+bool Optimizer::RemoveUnreachable()
+{
+    bool changed = false;
+
+    work.Clear();
+    work.Push(code.head);
+
+    while (work.GetSize())
+    {
+        Instr* curr = work.Back();
+        work.Pop();
+
+        for (; curr && !curr->visited; curr = curr->next)
+        {
+            curr->visited = true;
+
+            if (HasBranchTarget(curr))
+                work.Push(curr->target);
+
+            if (!FallsThrough(curr))
+                break;
+        }
+    }
+
+    Instr* next = 0;
+    for (Instr* curr = code.head; curr; curr = next)
+    {
+        next = curr->next;
+
+        bool live = curr->visited;
+        curr->visited = false;
+
+        if (curr->label && curr->opcode == JMP_TARGET)
+            continue;
+
+        if (!live || (!curr->label && OpcodeLength(curr->opcode) == 0))
+        {
+            Remove(curr);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Shortens chains of jumps and removes jumps that go nowhere.
+//
+// [ jump L1 ]                     [ jump L2 ]
+// ...                             ...
+// L1: [ jump L2 ]             ->  L1: [ jump L2 ]
+//
+// [ jumpiffalse L1 ]              [ jumpiftrue L2 ]
+// [ jump L2        ]          ->  L1: ...
+// L1: ...
+
+bool Optimizer::ThreadJumps()
+{
+    bool changed = false;
+    Instr* next = 0;
+
+    for (Instr* curr = code.head; curr; curr = next)
+    {
+        next = curr->next;
+
+        if (!IsJump(curr) || !curr->target)
+            continue;
+
+        Instr* dest = curr->target;
+
+        for (int hops = 0; hops < MAX_HOPS; ++hops)
+        {
+            Instr* real = SkipEmpty(dest);
+
+            if (!real || real->opcode != OP_jump || real == curr || !real->target)
+                break;
+            dest = real->target;
+        }
+
+        if (dest != curr->target)
+        {
+            curr->SetTarget(dest);
+            changed = true;
+        }
+
+        if (curr->opcode == OP_jump)
+        {
+            if (SkipEmpty(curr->next) == SkipEmpty(curr->target))
+            {
+                Remove(curr);
+                changed = true;
+            }
+        }
+        else if (next && next->opcode == OP_jump && !next->label && next->target &&
+                 SkipEmpty(next->next) == SkipEmpty(curr->target))
+        {
+            curr->opcode = (curr->opcode == OP_jumpiffalse) ? OP_jumpiftrue : OP_jumpiffalse;
+            curr->SetTarget(next->target);
+            next = next->next;
+            Remove(curr->next);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Removes values that are pushed only to be popped, and reuses the value just stored to a local
+// instead of loading it again.
+//
+// [ dup | pushlocal N | pushliteral N | ... ]  ->
+// [ pop                                     ]
+//
+// [ setlocal N  ]      [ dup        ]
+// [ pushlocal N ]  ->  [ setlocal N ]
+//
+// [ pushlocal N ]  ->
+// [ setlocal N  ]
+
+bool Optimizer::RemovePairs()
+{
+    bool changed = false;
+    Instr* next = 0;
+
+    for (Instr* curr = code.head; curr; curr = next)
+    {
+        next = curr->next;
+
+        if (!next || next->label)
+            continue;
+
+        Opcode oc = curr->opcode;
+
+        if (next->opcode == OP_pop && (oc == OP_dup || IsPurePush(curr)))
+        {
+            next = next->next;
+            Remove(curr->next);
+            Remove(curr);
+            changed = true;
+        }
+        else if ((oc >= OP_setlocal0 && oc <= OP_setlocal) &&
+                 (next->opcode >= OP_pushlocal0 && next->opcode <= OP_pushlocal) &&
+                 GetLocalIndex(curr, OP_setlocal0, OP_setlocal) == GetLocalIndex(next, OP_pushlocal0, OP_pushlocal))
+        {
+            // The store moves down one Instr so that anything jumping to it now starts at the dup.
+            next->opcode    = curr->opcode;
+            next->operand   = curr->operand;
+            next->operandu1 = curr->operandu1;
+            next->target    = curr->target;
+
+            curr->opcode    = OP_dup;
+            curr->operand   = curr->operandu1 = 0;
+            curr->target    = 0;
+            next = next->next;
+            changed = true;
+        }
+        else if ((oc >= OP_pushlocal0 && oc <= OP_pushlocal) &&
+                 (next->opcode >= OP_setlocal0 && next->opcode <= OP_setlocal) && !next->operandu1 &&
+                 GetLocalIndex(curr, OP_pushlocal0, OP_pushlocal) == GetLocalIndex(next, OP_setlocal0, OP_setlocal))
+        {
+            next = next->next;
+            Remove(curr->next);
+            Remove(curr);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+}// pika
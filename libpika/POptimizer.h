@@ -0,0 +1,73 @@
+/*
+ *  POptimizer.h
+ *  See Copyright Notice in Pika.h
+ */
+#ifndef PIKA_OPTIMIZER_HEADER
+#define PIKA_OPTIMIZER_HEADER
+
+#include "PBuffer.h"
+#include "PInstruction.h"
+
+namespace pika {
+class LiteralPool;
+
+/** Rewrites the intermediate representation of a single function before it is compiled into
+  * bytecode. The passes run depend on the optimization level:
+  *
+  *  0: None, the code is compiled exactly as it was generated.
+  *  1: Constant folding, conditional jumps over constant conditions, narrowing of pushliteral and
+  *     unreachable code elimination. Each pass runs once.
+  *  2: Also jump threading and the elimination of redundant instruction pairs. All passes are
+  *     repeated until the code stops changing.
+  *  3: Same as 2. The Compiler then also replaces common sequences of instructions with
+  *     superinstructions, see Compiler::Fuse.
+  *
+  * Instrs are only ever removed or rewritten in place. A removed Instr gives its line to the Instr
+  * that follows it, so every remaining Instr maps to the same source line as before. A removed
+  * Instr that is still the target of another Instr stays in the list as a zero length JMP_TARGET.
+  */
+class Optimizer
+{
+public:
+    Optimizer(InstrList& code, LiteralPool* literals, int level);
+    ~Optimizer();
+    
+    /** Runs the passes enabled by the optimization level. Code containing unpatched break or
+      * continue statements is left alone so that the Compiler can report them.
+      */
+    void Run();
+private:
+    typedef bool (Optimizer::*Pass)();
+    
+    struct PassInfo
+    {
+        int  level; //!< Minimum optimization level the pass runs at.
+        Pass pass;  //!< Returns true if the code was changed.
+    };
+    
+    static const PassInfo Passes[];
+    
+    /** Marks every Instr that is the target of another Instr as a label. Returns false if the
+      * code still contains a break or continue.
+      */
+    bool FindLabels();
+    
+    /** Removes the Instr ir from the code. */
+    void Remove(Instr* ir);
+    
+    bool FoldConstants();
+    bool FoldBranches();
+    bool NarrowLiterals();
+    bool RemoveUnreachable();
+    bool ThreadJumps();
+    bool RemovePairs();
+    
+    InstrList&     code;     //!< Code being optimized.
+    LiteralPool*   literals; //!< Literals of the function.
+    int            level;    //!< Optimization level.
+    Buffer<Instr*> work;     //!< Worklist used by RemoveUnreachable.
+};
+
+}// pika
+
+#endif
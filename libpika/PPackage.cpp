@@ -6,6 +6,7 @@
 #include "PString.h"
 #include "PDef.h"
 #include "PPackage.h"
+#include "PType.h"
 #include "PFunction.h"
 #include "PEngine.h"
 #include "PContext.h"
@@ -34,6 +35,7 @@ void Package::SetSuper(Package* super)
     if (super)
         WriteBarrier(super);
     superPackage = super;
+    Members().BumpVersion(); // Cached globals found through the old super package are no longer valid.
     SetName(name);
 }
 
@@ -81,6 +83,91 @@ bool Package::SetGlobal(const Value& key, Value& val, u4 attr)
     return true;
 }
 
+Slot* Package::FindGlobalSlot(const Value& key, u2& depth)
+{
+    depth = 0;
+    for (Package* pkg = this; pkg; pkg = pkg->superPackage, ++depth)
+    {
+        if (pkg->IsDerivedFrom(Type::StaticGetClass()))
+            return 0;
+        
+        Slot* slot = pkg->members ? pkg->members->GetSlot(key) : 0;
+        if (slot)
+            return slot;
+    }
+    return 0;
+}
+
+size_t Package::GetChainStamp(u2 depth)
+{
+    size_t stamp = 0;
+    Package* pkg = this;
+    for (u2 i = 0; pkg && i <= depth; ++i, pkg = pkg->superPackage)
+    {
+        if (pkg->members)
+            stamp += pkg->members->GetVersion();
+    }
+    return stamp;
+}
+
+bool Package::GetGlobalCached(const Value& key, Value& res, GlobalCache& ic)
+{
+    if (ic.package == this && ic.stamp == GetChainStamp(ic.depth))
+    {
+        res = ic.slot->val;
+        return true;
+    }
+    
+    u2 depth = 0;
+    Slot* slot = FindGlobalSlot(key, depth);
+    if (!slot)
+    {
+        return GetGlobal(key, res);
+    }
+    
+    if (ic.package != this)
+        engine->GetGC()->WriteBarrier(ic.owner, this);
+    ic.package = this;
+    ic.slot    = slot;
+    ic.depth   = depth;
+    ic.stamp   = GetChainStamp(depth);
+    res = slot->val;
+    return true;
+}
+
+bool Package::SetGlobalCached(const Value& key, Value& val, GlobalCache& ic)
+{
+    // Globals are always written to this package, so only a slot found in our own 
+    // Table can be written to directly.
+    if (ic.package == this && ic.depth == 0 && ic.stamp == GetChainStamp(0))
+    {
+        Slot* slot = ic.slot;
+        if (slot->val.GetTag() != TAG_property && !(slot->attr & Slot::ATTR_final))
+        {
+            if (val.IsCollectible())
+                WriteBarrier(val);
+            slot->val = val;
+            return true;
+        }
+        return false;
+    }
+    
+    if (!SetGlobal(key, val))
+        return false;
+    
+    Slot* slot = members ? members->GetSlot(key) : 0;
+    if (slot && !IsDerivedFrom(Type::StaticGetClass()))
+    {
+        if (ic.package != this)
+            engine->GetGC()->WriteBarrier(ic.owner, this);
+        ic.package = this;
+        ic.slot    = slot;
+        ic.depth   = 0;
+        ic.stamp   = GetChainStamp(0);
+    }
+    return true;
+}
+
 bool Package::CanSetGlobal(const Value& key)
 {
     Table::ESlotState ss = members ? members->CanSet(key) : Table::SS_nil;
@@ -125,8 +212,7 @@ String* Package::ToString()
 Package* Package::Create(Engine* eng, String* name, Package* superPkg)
 {
     Package *pkg = 0;
-    PIKA_NEW(Package, pkg, (eng, eng->Package_Type, name, superPkg));
-    eng->AddToGC(pkg);
+    GCNEW(eng, Package, pkg, (eng, eng->Package_Type, name, superPkg));
     return pkg;
 }
 
@@ -158,12 +244,14 @@ void Package::Init(Context* ctx)
         }
         superPackage = (Package*)super;
         WriteBarrier(superPackage);
+        Members().BumpVersion();
         this->SetName(nstr);
     }
 }
 
 void Package::SetName(String* n)
 {
+    GCPAUSE_NORUN(engine); // The intermediate strings are not referenced by anything.
     this->name = n;
     this->dotName = name;
     WriteBarrier(this->name);
@@ -200,7 +288,7 @@ Returns the parent of the package.\
 
 int Package_getParent(Context* ctx, Value& self)
 {
-    Package* pkg = self.val.package;
+    Package* pkg = self.GetPackage();
     Package* super = pkg->GetSuper();
     if (super) {
         ctx->Push(super);
@@ -217,7 +305,7 @@ Returns the name of this package.\
 
 int Package_getName(Context* ctx, Value& self)
 {
-    Package* pkg = self.val.package;
+    Package* pkg = self.GetPackage();
     String* name = pkg->GetName() ? pkg->GetName() : ctx->GetEngine()->emptyString;
     ctx->Push(name);
     return 1;
@@ -230,7 +318,7 @@ Returns the full path of this package.\
 
 int Package_getPath(Context* ctx, Value& self)
 {
-    Package* pkg = self.val.package;
+    Package* pkg = self.GetPackage();
     String* name = pkg->GetDotName() ? pkg->GetDotName() : ctx->GetEngine()->emptyString;
     ctx->Push(name);
     return 1;
@@ -244,7 +332,7 @@ Returns the global |name| or '''null''' if it doesn't exist. You can use \
 
 int Package_getGlobal(Context* ctx, Value& self)
 {
-    Package* pkg = self.val.package;
+    Package* pkg = self.GetPackage();
     Value& arg0  = ctx->GetArg(0);
     Value res(NULL_VALUE);
 
@@ -268,7 +356,7 @@ Returns whether or not the global |name| could be set to the value of |val|.\
 
 int Package_setGlobal(Context* ctx, Value& self)
 {
-    Package* pkg  = self.val.package;
+    Package* pkg  = self.GetPackage();
     Value&   arg0 = ctx->GetArg(0);
     Value&   arg1 = ctx->GetArg(1);
     
@@ -293,7 +381,7 @@ scope. \
 
 int Package_hasGlobal(Context* ctx, Value& self)
 {
-    Package* pkg = (Package*)self.val.object;
+    Package* pkg = (Package*)self.GetObject();
     Value&  arg0 = ctx->GetArg(0);
     Value   res(NULL_VALUE);
     
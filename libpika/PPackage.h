@@ -14,6 +14,7 @@
 #endif
 
 namespace pika {
+struct GlobalCache;
 
 ///////////////////////////////////////////// Package //////////////////////////////////////////////
 
@@ -57,8 +58,26 @@ public:
     
     virtual bool GetSlot(const Value& key, Value& res);
     
+    /** Same as GetGlobal except the inline cache, ic, is used to skip the
+      * lookup when possible. The cache is updated on a miss.
+      */
+    bool GetGlobalCached(const Value& key, Value& res, GlobalCache& ic);
+    
+    /** Same as SetGlobal except the inline cache, ic, is used to skip the
+      * lookup when possible. The cache is updated on a miss.
+      */
+    bool SetGlobalCached(const Value& key, Value& val, GlobalCache& ic);
+    
     void AddNative(RegisterFunction* fns, size_t count);
 protected:
+    /** Finds the Slot for the global key without calling any overrides. Returns null if the
+      * global does not exist or if a package with its own lookup rules (ie a Type) is in the way.
+      */
+    Slot* FindGlobalSlot(const Value& key, u2& depth);
+    
+    /** Returns the sum of the Table versions of this package and depth of its super packages. */
+    size_t GetChainStamp(u2 depth);
+    
     String*  name;         //!< The name of this package.
     String*  dotName;      //!< The Package's fully qualified name.
     Package* superPackage; //!< The super package (global scope) for this package.
@@ -1255,7 +1255,6 @@ bool Parser::DoContextualKeyword(const char* key, bool optional)
         }
         else
         {
-            Pika_free(tstream.GetString());
             tstream.Advance();
             return true;
         }
@@ -1380,7 +1379,7 @@ void Parser::DoForEachHeader(ForEachHeader* header)
     else
     {
         StringExpr* of;
-        PIKA_NEWNODE(StringExpr, of, (state, Pika_strdup(""), 0));
+        PIKA_NEWNODE(StringExpr, of, (state, state->CopyString(""), 0));
         of->line = header->head.line;
         header->of = of;
     }
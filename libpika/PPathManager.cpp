@@ -51,7 +51,7 @@ bool PathManager::IsValidFile(const char* path, bool allowDirectories)
 bool PathManager::BracketRead(const Value& key, Value& res)
 {
     if (key.IsInteger()) {
-        pint_t ival = key.val.integer;
+        pint_t ival = key.GetInteger();
         if (ival >= 0) {
             size_t idx = static_cast<size_t>(ival);
             if (idx < searchPaths.GetSize())
@@ -134,6 +134,8 @@ bool PathManager::Finalize()
 
 void PathManager::AddPath(String* path)
 {
+    GCPAUSE_NORUN(engine); // path may be a new String that nothing references yet.
+    
     if ( !EndsWithSeperator(path->GetBuffer(),
                             path->GetLength())
        )
@@ -183,7 +185,7 @@ static int PathManager_findPathOf(Context* ctx, Value& self)
     u2 argc = ctx->GetArgCount();
     bool dirs = false;
     String* fileName = 0;
-    PathManager* pm = static_cast<PathManager*>(self.val.object);
+    PathManager* pm = static_cast<PathManager*>(self.GetObject());
     switch(argc)
     {
     case 2:
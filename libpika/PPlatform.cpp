@@ -10,6 +10,9 @@
 #include <readline/readline.h>
 #include <readline/history.h>
 #endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 ErrorStringHandler::ErrorStringHandler(int err) : buffer(Pika_GetError(err))
 {        
@@ -90,33 +93,134 @@ int Pika_snprintf(char* buff, size_t count, const char* fmt, ...)
     return res;
 }
 
-size_t Pika_StringHash(const char* str)
+// String Hashing //////////////////////////////////////////////////////////////////////////////////
+
+/* Pika_StringHash is based on wyhash by Wang Yi (released into the public domain.) It consumes 
+ * 8 bytes at a time and the seed is mixed into every step, so without the seed a script cannot 
+ * choose keys that collide. */
+
+static const u8 PIKA_HASH_P0 = 0xA0761D6478BD642FULL;
+static const u8 PIKA_HASH_P1 = 0xE7037ED1A0B428DBULL;
+static const u8 PIKA_HASH_P2 = 0x8EBC6AF09C88C6E3ULL;
+static const u8 PIKA_HASH_P3 = 0x589965CC75374CC3ULL;
+
+/* Replaces a and b with the low and high halves of their 128 bit product. */
+static INLINE void Pika_HashMul128(u8& a, u8& b)
 {
-    size_t hash = 5381;
-    int c;
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 u16_t;
+    u16_t r = (u16_t)a * b;
+    a = (u8)r;
+    b = (u8)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#else
+    u8 ha = a >> 32, hb = b >> 32, la = (u4)a, lb = (u4)b;
+    u8 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    u8 t = rl + (rm0 << 32);
+    u8 c = t < rl;
+    u8 lo = t + (rm1 << 32);
+    c += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
 
-    while ( (c = *str++) )
-    {
-        hash = ((hash << 5) + hash) + StrGetChar(c);
-    }
-    return hash;
+/* Multiplies a and b and folds the 128 bit product back into 64 bits. */
+static INLINE u8 Pika_HashMum(u8 a, u8 b)
+{
+    Pika_HashMul128(a, b);
+    return a ^ b;
 }
 
-size_t Pika_StringHash(const char* str, size_t len)
+#if defined(PIKA_STRING_CASE_INSENSITIVE)
+static INLINE u8 Pika_HashRead(const char* p, size_t n)
 {
-    size_t hash = 5381;
-    int c;
+    u8 v = 0;
+    for (size_t i = n; i-- > 0;)
+        v = (v << 8) | (u1)StrGetChar((u1)p[i]);
+    return v;
+}
+static INLINE u8 Pika_HashRead8(const char* p) { return Pika_HashRead(p, 8); }
+static INLINE u8 Pika_HashRead4(const char* p) { return Pika_HashRead(p, 4); }
+#define PIKA_HASH_BYTE(p, i) ((u8)(u1)StrGetChar((u1)(p)[i]))
+#else
+static INLINE u8 Pika_HashRead8(const char* p) { u8 v; memcpy(&v, p, 8); return v; }
+static INLINE u8 Pika_HashRead4(const char* p) { u4 v; memcpy(&v, p, 4); return v; }
+#define PIKA_HASH_BYTE(p, i) ((u8)(u1)(p)[i])
+#endif
 
-    const char* str_end = str + len;
+size_t Pika_StringHash(const char* str)
+{
+    return Pika_StringHash(str, strlen(str));
+}
 
-    while (str < str_end)
+size_t Pika_StringHash(const char* str, size_t len, u8 seed)
+{
+    const char* p = str;
+    u8 a, b;
+    
+    seed ^= PIKA_HASH_P0;
+    
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            size_t mid = (len >> 3) << 2;
+            a = (Pika_HashRead4(p) << 32) | Pika_HashRead4(p + mid);
+            b = (Pika_HashRead4(p + len - 4) << 32) | Pika_HashRead4(p + len - 4 - mid);
+        }
+        else if (len > 0)
+        {
+            a = (PIKA_HASH_BYTE(p, 0) << 16) | (PIKA_HASH_BYTE(p, len >> 1) << 8) | PIKA_HASH_BYTE(p, len - 1);
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
     {
-        c = *str++;
-        hash = ((hash << 5) + hash) + StrGetChar(c);
+        size_t i = len;
+        if (i > 48)
+        {
+            u8 s1 = seed;
+            u8 s2 = seed;
+            do
+            {
+                seed = Pika_HashMum(Pika_HashRead8(p)      ^ PIKA_HASH_P1, Pika_HashRead8(p + 8)  ^ seed);
+                s1   = Pika_HashMum(Pika_HashRead8(p + 16) ^ PIKA_HASH_P2, Pika_HashRead8(p + 24) ^ s1);
+                s2   = Pika_HashMum(Pika_HashRead8(p + 32) ^ PIKA_HASH_P3, Pika_HashRead8(p + 40) ^ s2);
+                p += 48;
+                i -= 48;
+            }
+            while (i > 48);
+            seed ^= s1 ^ s2;
+        }
+        while (i > 16)
+        {
+            seed = Pika_HashMum(Pika_HashRead8(p) ^ PIKA_HASH_P1, Pika_HashRead8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = Pika_HashRead8(p + i - 16);
+        b = Pika_HashRead8(p + i - 8);
     }
-    return hash;
+    
+    a ^= PIKA_HASH_P1;
+    b ^= seed;
+    Pika_HashMul128(a, b);
+    u8 hash = Pika_HashMum(a ^ PIKA_HASH_P0 ^ len, b ^ PIKA_HASH_P1);
+#if defined(PIKA_64)
+    return (size_t)hash;
+#else
+    return (size_t)(hash ^ (hash >> 32));
+#endif
 }
 
+#undef PIKA_HASH_BYTE
+
 #if defined(HAVE_STRTOK_R)
 char* Pika_strtok(char* str, const char* sep, char** last)
 {
@@ -13,8 +13,11 @@ extern void Pika_addhistory(const char* ln);
 /** Compares two strings that might contain non-ascii or null characters. */
 extern int         Pika_StringCompare(const char* a, size_t lena,
                                       const char* b, size_t lenb);
+/** Hashes a null terminated string with a seed of 0. */
 extern size_t      Pika_StringHash(const char* str);
-extern size_t      Pika_StringHash(const char* str, size_t len);
+
+/** Hashes len bytes of str. Different seeds give unrelated hashes for the same characters. */
+extern size_t      Pika_StringHash(const char* str, size_t len, u8 seed = 0);
 extern int         Pika_snprintf(char* buff, size_t count, const char* fmt, ...);
 extern char*       Pika_strtok(char*, const char*, char**);
 extern const char* Pika_index(const char* str, int x);
@@ -41,6 +44,83 @@ extern int Pika_gettimeofday(Pika_timeval*, Pika_timezone*);
 extern void          Pika_Sleep(u4 msecs);
 extern unsigned long Pika_Milliseconds();
 
+/** Microseconds from a monotonic clock with an unspecified starting point. */
+extern u8            Pika_Microseconds();
+
+// ---- Random Numbers ----
+
+/** Returns 64 bits from the operating system's random number source. If it is unavailable the 
+  * result is mixed from the clock, the process id and the address of the stack.
+  */
+extern u8 Pika_RandomSeed();
+
+// ---- Processes ----
+
+/** Id of the calling process. */
+extern size_t Pika_ProcessId();
+
+// ---- Profiling Timer ----
+
+/** Calls tick every usecs microseconds of CPU time until Pika_StopProfileTimer is called. tick may
+  * run inside a signal handler or on another thread so it should only set a flag. Only one timer 
+  * can run at a time.
+  */
+extern bool Pika_StartProfileTimer(u4 usecs, void (*tick)());
+extern void Pika_StopProfileTimer();
+
+// ---- Memory Pages ----
+
+/** Allocates size bytes of memory directly from the operating system. The memory is aligned to
+  * 64KB and size must be a multiple of 64KB.
+  */
+extern void* Pika_AllocPages(size_t size);
+
+/** Returns memory allocated by Pika_AllocPages to the operating system. */
+extern void  Pika_FreePages(void* pages, size_t size);
+
+// ---- Threads ----
+
+struct Pika_Thread;
+struct Pika_Mutex;
+struct Pika_Condition;
+
+/** Starts a new thread that calls run(arg). Returns null if the thread could not be created. */
+extern Pika_Thread*    Pika_CreateThread(void (*run)(void*), void* arg);
+
+/** Waits for the thread to return from run and then frees it. */
+extern void            Pika_JoinThread(Pika_Thread*);
+
+/** Gives the rest of the calling thread's time slice to another thread. */
+extern void            Pika_YieldThread();
+
+/** Number of processors the process can run on, never less than 1. */
+extern size_t          Pika_NumProcessors();
+
+extern Pika_Mutex*     Pika_CreateMutex();
+extern void            Pika_DestroyMutex(Pika_Mutex*);
+extern void            Pika_LockMutex(Pika_Mutex*);
+extern void            Pika_UnlockMutex(Pika_Mutex*);
+
+extern Pika_Condition* Pika_CreateCondition();
+extern void            Pika_DestroyCondition(Pika_Condition*);
+
+/** Unlocks the mutex, waits for the condition to be signaled and locks the mutex again. The 
+  * wait can end without a signal so the caller must check what it is waiting for in a loop.
+  */
+extern void            Pika_WaitCondition(Pika_Condition*, Pika_Mutex*);
+extern void            Pika_SignalCondition(Pika_Condition*);    //!< Wakes one waiting thread.
+extern void            Pika_BroadcastCondition(Pika_Condition*); //!< Wakes every waiting thread.
+
+// ---- Atomic Operations ----
+
+/** Sets *p to newval if it equals oldval as a single atomic operation. Returns true if *p was 
+  * changed. Acts as a full memory barrier.
+  */
+extern bool Pika_CompareAndSwap(volatile u4* p, u4 oldval, u4 newval);
+
+/** Atomically adds x to *p and returns the result. Acts as a full memory barrier. */
+extern s4   Pika_AtomicAdd(volatile s4* p, s4 x);
+
 extern char*  Pika_GetError(int);
 extern void   Pika_FreeErrorString(char*);
 
@@ -76,6 +156,9 @@ extern char*    Pika_GetCurrentDirectory(); // Call Pika_free on the result.
 extern bool     Pika_FileExists(const char* filename);
 
 extern bool     Pika_IsFile(const char* filename);
+
+/** Retrieves the last modification time and size in bytes of a file. */
+extern bool     Pika_GetFileStamp(const char* filename, u8* mtime, u8* size);
 extern bool     Pika_IsDirectory(const char* filename);
 
 extern bool     Pika_GetFullPath(const char* pathname, char* dest, size_t destlen);
@@ -16,8 +16,13 @@
 #include <sys/types.h>
 #include <sys/stat.h>    // stat
 #include <sys/time.h>    // gettimeofday
+#include <time.h>        // clock_gettime
 #include <fcntl.h>
 #include <dirent.h>
+#include <signal.h>      // sigaction
+#include <sys/mman.h>    // mmap
+#include <pthread.h>
+#include <sched.h>       // sched_yield
 
 char* Pika_GetError(int err)
 {
@@ -78,6 +83,206 @@ unsigned long Pika_Milliseconds()
                            tp.tv_sec  * 1000); // s to ms
 }
 
+u8 Pika_Microseconds()
+{
+#if defined(CLOCK_MONOTONIC)
+    timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+        return (u8)ts.tv_sec * 1000000 + (u8)(ts.tv_nsec / 1000);
+#endif
+    timeval tp;
+    gettimeofday(&tp, 0);
+    return (u8)tp.tv_sec * 1000000 + (u8)tp.tv_usec;
+}
+
+u8 Pika_RandomSeed()
+{
+    u8 seed = 0;
+    int fd = open("/dev/urandom", O_RDONLY);
+    if (fd >= 0)
+    {
+        ssize_t n = read(fd, &seed, sizeof(seed));
+        close(fd);
+        if (n == (ssize_t)sizeof(seed))
+            return seed;
+    }
+    seed = Pika_Microseconds() ^ ((u8)getpid() << 32) ^ (u8)(size_t)&seed;
+    return seed * 0x9E3779B97F4A7C15ULL;
+}
+
+size_t Pika_ProcessId()
+{
+    return (size_t)getpid();
+}
+
+static void (*Pika_profileTick)() = 0;
+static struct sigaction Pika_oldProfileAction;
+
+static void Pika_ProfileSignal(int)
+{
+    if (Pika_profileTick)
+        Pika_profileTick();
+}
+
+bool Pika_StartProfileTimer(u4 usecs, void (*tick)())
+{
+    if (Pika_profileTick || !tick || !usecs)
+        return false;
+    
+    struct sigaction act;
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = Pika_ProfileSignal;
+    act.sa_flags   = SA_RESTART;
+    sigemptyset(&act.sa_mask);
+    
+    if (sigaction(SIGPROF, &act, &Pika_oldProfileAction) != 0)
+        return false;
+    
+    Pika_profileTick = tick;
+    
+    struct itimerval timer;
+    timer.it_interval.tv_sec  = usecs / 1000000;
+    timer.it_interval.tv_usec = usecs % 1000000;
+    timer.it_value = timer.it_interval;
+    
+    if (setitimer(ITIMER_PROF, &timer, 0) != 0)
+    {
+        Pika_profileTick = 0;
+        sigaction(SIGPROF, &Pika_oldProfileAction, 0);
+        return false;
+    }
+    return true;
+}
+
+void Pika_StopProfileTimer()
+{
+    if (!Pika_profileTick)
+        return;
+    
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, 0);
+    sigaction(SIGPROF, &Pika_oldProfileAction, 0);
+    Pika_profileTick = 0;
+}
+
+void* Pika_AllocPages(size_t size)
+{
+    // Over allocate so that an aligned block can be cut out of the middle.
+    const size_t align = 64 * 1024;
+    char* base = (char*)mmap(0, size + align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (base == (char*)MAP_FAILED)
+        return 0;
+    
+    char* aligned = (char*)(((size_t)base + align - 1) & ~(align - 1));
+    size_t head = aligned - base;
+    size_t tail = align - head;
+    
+    if (head) munmap(base, head);
+    if (tail) munmap(aligned + size, tail);
+    return aligned;
+}
+
+void Pika_FreePages(void* pages, size_t size)
+{
+    munmap(pages, size);
+}
+
+struct Pika_Thread
+{
+    pthread_t handle;
+    void    (*run)(void*);
+    void*     arg;
+};
+
+struct Pika_Mutex     { pthread_mutex_t handle; };
+struct Pika_Condition { pthread_cond_t  handle; };
+
+static void* Pika_ThreadMain(void* data)
+{
+    Pika_Thread* thread = (Pika_Thread*)data;
+    thread->run(thread->arg);
+    return 0;
+}
+
+Pika_Thread* Pika_CreateThread(void (*run)(void*), void* arg)
+{
+    Pika_Thread* thread = (Pika_Thread*)Pika_malloc(sizeof(Pika_Thread));
+    thread->run = run;
+    thread->arg = arg;
+    
+    if (pthread_create(&thread->handle, 0, Pika_ThreadMain, thread) != 0)
+    {
+        Pika_free(thread);
+        return 0;
+    }
+    return thread;
+}
+
+void Pika_JoinThread(Pika_Thread* thread)
+{
+    pthread_join(thread->handle, 0);
+    Pika_free(thread);
+}
+
+void Pika_YieldThread()
+{
+    sched_yield();
+}
+
+size_t Pika_NumProcessors()
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (size_t)n : 1;
+}
+
+Pika_Mutex* Pika_CreateMutex()
+{
+    Pika_Mutex* mutex = (Pika_Mutex*)Pika_malloc(sizeof(Pika_Mutex));
+    pthread_mutex_init(&mutex->handle, 0);
+    return mutex;
+}
+
+void Pika_DestroyMutex(Pika_Mutex* mutex)
+{
+    pthread_mutex_destroy(&mutex->handle);
+    Pika_free(mutex);
+}
+
+void Pika_LockMutex(Pika_Mutex* mutex)   { pthread_mutex_lock(&mutex->handle);   }
+void Pika_UnlockMutex(Pika_Mutex* mutex) { pthread_mutex_unlock(&mutex->handle); }
+
+Pika_Condition* Pika_CreateCondition()
+{
+    Pika_Condition* cond = (Pika_Condition*)Pika_malloc(sizeof(Pika_Condition));
+    pthread_cond_init(&cond->handle, 0);
+    return cond;
+}
+
+void Pika_DestroyCondition(Pika_Condition* cond)
+{
+    pthread_cond_destroy(&cond->handle);
+    Pika_free(cond);
+}
+
+void Pika_WaitCondition(Pika_Condition* cond, Pika_Mutex* mutex)
+{
+    pthread_cond_wait(&cond->handle, &mutex->handle);
+}
+
+void Pika_SignalCondition(Pika_Condition* cond)    { pthread_cond_signal(&cond->handle);    }
+void Pika_BroadcastCondition(Pika_Condition* cond) { pthread_cond_broadcast(&cond->handle); }
+
+bool Pika_CompareAndSwap(volatile u4* p, u4 oldval, u4 newval)
+{
+    return __sync_bool_compare_and_swap(p, oldval, newval);
+}
+
+s4 Pika_AtomicAdd(volatile s4* p, s4 x)
+{
+    return __sync_add_and_fetch(p, x);
+}
+
 bool Pika_CreateDirectory(const char* pathName)
 {
     return mkdir(pathName, S_IRUSR | S_IWUSR | S_IXUSR) == 0;
@@ -163,6 +368,18 @@ bool Pika_IsFile(const char* filename)
     return false;
 }
 
+bool Pika_GetFileStamp(const char* filename, u8* mtime, u8* size)
+{
+    struct stat ino;
+
+    if (stat(filename, &ino) || !S_ISREG(ino.st_mode))
+        return false;
+
+    *mtime = (u8)ino.st_mtime;
+    *size  = (u8)ino.st_size;
+    return true;
+}
+
 bool Pika_IsDirectory(const char* filename)
 {
     struct stat ino;
@@ -99,6 +99,197 @@ unsigned long Pika_Milliseconds()
     return timeGetTime();
 }
 
+u8 Pika_Microseconds()
+{
+    static LARGE_INTEGER freq = { 0 };
+    LARGE_INTEGER now;
+    
+    if (!freq.QuadPart)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (u8)(now.QuadPart / freq.QuadPart) * 1000000 + 
+           (u8)(now.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart;
+}
+
+u8 Pika_RandomSeed()
+{
+    // RtlGenRandom is exported as SystemFunction036 and does not need the CryptoAPI.
+    typedef BOOLEAN (WINAPI *RtlGenRandomFn)(PVOID, ULONG);
+    
+    u8 seed = 0;
+    if (HMODULE advapi = LoadLibraryA("advapi32.dll"))
+    {
+        RtlGenRandomFn genRandom = (RtlGenRandomFn)GetProcAddress(advapi, "SystemFunction036");
+        bool ok = genRandom && genRandom(&seed, sizeof(seed));
+        FreeLibrary(advapi);
+        if (ok)
+            return seed;
+    }
+    seed = Pika_Microseconds() ^ ((u8)GetCurrentProcessId() << 32) ^ (u8)(size_t)&seed;
+    return seed * 0x9E3779B97F4A7C15ULL;
+}
+
+size_t Pika_ProcessId()
+{
+    return (size_t)GetCurrentProcessId();
+}
+
+static void (*Pika_profileTick)() = 0;
+static HANDLE Pika_profileTimer = 0;
+
+static VOID CALLBACK Pika_ProfileTimerProc(PVOID, BOOLEAN)
+{
+    if (Pika_profileTick)
+        Pika_profileTick();
+}
+
+// Windows has no CPU time timer, so the timer queue is used and samples are taken in wall time.
+bool Pika_StartProfileTimer(u4 usecs, void (*tick)())
+{
+    if (Pika_profileTick || !tick || !usecs)
+        return false;
+    
+    DWORD msecs = usecs < 1000 ? 1 : (DWORD)(usecs / 1000);
+    Pika_profileTick = tick;
+    
+    if (!CreateTimerQueueTimer(&Pika_profileTimer, 0, Pika_ProfileTimerProc, 0, msecs, msecs, WT_EXECUTEDEFAULT))
+    {
+        Pika_profileTick = 0;
+        return false;
+    }
+    return true;
+}
+
+void Pika_StopProfileTimer()
+{
+    if (!Pika_profileTick)
+        return;
+    DeleteTimerQueueTimer(0, Pika_profileTimer, INVALID_HANDLE_VALUE);
+    Pika_profileTimer = 0;
+    Pika_profileTick = 0;
+}
+
+void* Pika_AllocPages(size_t size)
+{
+    // VirtualAlloc aligns to the allocation granularity, which is 64KB.
+    const size_t align = 64 * 1024;
+    void* pages = VirtualAlloc(0, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (pages && ((size_t)pages & (align - 1)))
+    {
+        // Reserve a larger region, release it and then claim the aligned part of it.
+        VirtualFree(pages, 0, MEM_RELEASE);
+        char* base = (char*)VirtualAlloc(0, size + align, MEM_RESERVE, PAGE_NOACCESS);
+        if (!base)
+            return 0;
+        char* aligned = (char*)(((size_t)base + align - 1) & ~(align - 1));
+        VirtualFree(base, 0, MEM_RELEASE);
+        pages = VirtualAlloc(aligned, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+    return pages;
+}
+
+void Pika_FreePages(void* pages, size_t size)
+{
+    VirtualFree(pages, 0, MEM_RELEASE);
+}
+
+struct Pika_Thread
+{
+    HANDLE handle;
+    void (*run)(void*);
+    void*  arg;
+};
+
+struct Pika_Mutex     { CRITICAL_SECTION   handle; };
+struct Pika_Condition { CONDITION_VARIABLE handle; };
+
+static DWORD WINAPI Pika_ThreadMain(LPVOID data)
+{
+    Pika_Thread* thread = (Pika_Thread*)data;
+    thread->run(thread->arg);
+    return 0;
+}
+
+Pika_Thread* Pika_CreateThread(void (*run)(void*), void* arg)
+{
+    Pika_Thread* thread = (Pika_Thread*)Pika_malloc(sizeof(Pika_Thread));
+    thread->run = run;
+    thread->arg = arg;
+    thread->handle = CreateThread(0, 0, Pika_ThreadMain, thread, 0, 0);
+    
+    if (!thread->handle)
+    {
+        Pika_free(thread);
+        return 0;
+    }
+    return thread;
+}
+
+void Pika_JoinThread(Pika_Thread* thread)
+{
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    Pika_free(thread);
+}
+
+void Pika_YieldThread()
+{
+    SwitchToThread();
+}
+
+size_t Pika_NumProcessors()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+}
+
+Pika_Mutex* Pika_CreateMutex()
+{
+    Pika_Mutex* mutex = (Pika_Mutex*)Pika_malloc(sizeof(Pika_Mutex));
+    InitializeCriticalSection(&mutex->handle);
+    return mutex;
+}
+
+void Pika_DestroyMutex(Pika_Mutex* mutex)
+{
+    DeleteCriticalSection(&mutex->handle);
+    Pika_free(mutex);
+}
+
+void Pika_LockMutex(Pika_Mutex* mutex)   { EnterCriticalSection(&mutex->handle); }
+void Pika_UnlockMutex(Pika_Mutex* mutex) { LeaveCriticalSection(&mutex->handle); }
+
+Pika_Condition* Pika_CreateCondition()
+{
+    Pika_Condition* cond = (Pika_Condition*)Pika_malloc(sizeof(Pika_Condition));
+    InitializeConditionVariable(&cond->handle);
+    return cond;
+}
+
+void Pika_DestroyCondition(Pika_Condition* cond)
+{
+    Pika_free(cond);
+}
+
+void Pika_WaitCondition(Pika_Condition* cond, Pika_Mutex* mutex)
+{
+    SleepConditionVariableCS(&cond->handle, &mutex->handle, INFINITE);
+}
+
+void Pika_SignalCondition(Pika_Condition* cond)    { WakeConditionVariable(&cond->handle);    }
+void Pika_BroadcastCondition(Pika_Condition* cond) { WakeAllConditionVariable(&cond->handle); }
+
+bool Pika_CompareAndSwap(volatile u4* p, u4 oldval, u4 newval)
+{
+    return (u4)InterlockedCompareExchange((volatile LONG*)p, (LONG)newval, (LONG)oldval) == oldval;
+}
+
+s4 Pika_AtomicAdd(volatile s4* p, s4 x)
+{
+    return (s4)InterlockedExchangeAdd((volatile LONG*)p, (LONG)x) + x;
+}
+
 bool Pika_CreateDirectory(const char* pathName)
 {
     return CreateDirectory(pathName, 0) != 0;
@@ -169,6 +360,21 @@ bool Pika_IsFile(const char* filename)
     return true;
 }
 
+bool Pika_GetFileStamp(const char* filename, u8* mtime, u8* size)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+
+    if (!GetFileAttributesEx(filename, GetFileExInfoStandard, &data))
+        return false;
+
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        return false;
+
+    *mtime = ((u8)data.ftLastWriteTime.dwHighDateTime << 32) | (u8)data.ftLastWriteTime.dwLowDateTime;
+    *size  = ((u8)data.nFileSizeHigh << 32) | (u8)data.nFileSizeLow;
+    return true;
+}
+
 bool Pika_IsDirectory(const char* filename)
 {
     DWORD attr = GetFileAttributes(filename);
@@ -0,0 +1,244 @@
+/*
+ *  PProfiler.cpp
+ *  See Copyright Notice in Pika.h
+ */
+#include "Pika.h"
+#include "PPlatform.h"
+#include "PProfiler.h"
+
+#include <stdio.h>
+
+namespace pika {
+
+volatile sig_atomic_t Profiler::pending = 0;
+Profiler*             Profiler::running = 0;
+
+Profiler::Profiler(Engine* eng) : engine(eng), stackCount(0), sampleCount(0)
+{
+}
+
+Profiler::~Profiler()
+{
+    Stop();
+    Reset();
+}
+
+void Profiler::Tick()
+{
+    pending = 1;
+}
+
+bool Profiler::Start(u4 usecs)
+{
+    if (running)
+        return running == this;
+
+    if (!Pika_StartProfileTimer(usecs, Profiler::Tick))
+        return false;
+
+    running = this;
+    return true;
+}
+
+void Profiler::Stop()
+{
+    if (running != this)
+        return;
+
+    Pika_StopProfileTimer();
+    running = 0;
+    pending = 0;
+}
+
+void Profiler::Reset()
+{
+    for (size_t i = 0; i < buckets.GetSize(); ++i)
+    {
+        Stack* curr = buckets[i];
+        while (curr)
+        {
+            Stack* next = curr->next;
+            Pika_free(curr->frames);
+            Pika_free(curr);
+            curr = next;
+        }
+    }
+    buckets.Clear();
+    stackCount  = 0;
+    sampleCount = 0;
+}
+
+void Profiler::Sample(Context* ctx)
+{
+    pending = 0;
+    frames.Clear();
+
+    // Gather every Context in the chain so that the outermost one is recorded first.
+    Buffer<Context*> contexts;
+    for (Context* curr = ctx; curr; curr = curr->GetPrev())
+    {
+        contexts.Push(curr);
+    }
+
+    for (size_t i = contexts.GetSize(); i-- > 0;)
+    {
+        Context* curr = contexts[i];
+
+        // The first scope never holds a function, see Context::Traceback.
+        for (ScopeIter iter = curr->scopesBeg + 1; iter < curr->scopesTop; ++iter)
+        {
+            if (iter->kind == SCOPE_call && iter->closure)
+                AddFrame(iter->closure, iter->pc);
+        }
+
+        if (curr->closure)
+            AddFrame(curr->closure, curr->pc);
+    }
+
+    if (frames.GetSize())
+    {
+        AddStack();
+        ++sampleCount;
+    }
+}
+
+void Profiler::AddFrame(Function* fn, code_t* pc)
+{
+    char lineno[32] = { 0 };
+    Def* def = fn->GetDef();
+
+    if (frames.GetSize())
+        frames.Push(';');
+
+    if (Package* pkg = fn->GetLocation())
+    {
+        String* dotname = pkg->GetDotName();
+        for (size_t i = 0; i < dotname->GetLength(); ++i)
+            frames.Push(dotname->GetBuffer()[i]);
+        if (dotname->GetLength())
+            frames.Push('.');
+    }
+
+    if (def->name && def->name->GetLength())
+    {
+        const char* name = def->name->GetBuffer();
+        for (size_t i = 0; i < def->name->GetLength(); ++i)
+        {
+            // ';' separates frames and a newline separates call stacks.
+            char ch = name[i];
+            frames.Push((ch == ';' || ch == '\n') ? '_' : ch);
+        }
+    }
+    else
+    {
+        const char* anon = "(anonymous)";
+        while (*anon)
+            frames.Push(*anon++);
+    }
+
+    if (!fn->IsNative() && pc)
+    {
+        Pika_snprintf(lineno, sizeof(lineno), ":%d", fn->DetermineLineNumber(pc));
+        for (const char* c = lineno; *c; ++c)
+            frames.Push(*c);
+    }
+}
+
+void Profiler::AddStack()
+{
+    const char* buff = frames.GetAt(0);
+    size_t      len  = frames.GetSize();
+    size_t      hash = Pika_StringHash(buff, len);
+
+    if (buckets.GetSize())
+    {
+        for (Stack* curr = buckets[hash & (buckets.GetSize() - 1)]; curr; curr = curr->next)
+        {
+            if (curr->hash == hash && curr->length == len && memcmp(curr->frames, buff, len) == 0)
+            {
+                ++curr->count;
+                return;
+            }
+        }
+    }
+
+    if (stackCount >= buckets.GetSize())
+        Rehash();
+
+    Stack* stack  = (Stack*)Pika_malloc(sizeof(Stack));
+    stack->frames = (char*)Pika_malloc(len);
+    stack->length = len;
+    stack->hash   = hash;
+    stack->count  = 1;
+    Pika_memcpy(stack->frames, buff, len);
+
+    size_t pos = hash & (buckets.GetSize() - 1);
+    stack->next  = buckets[pos];
+    buckets[pos] = stack;
+    ++stackCount;
+}
+
+void Profiler::Rehash()
+{
+    size_t newSize = buckets.GetSize() ? buckets.GetSize() * 2 : 64;
+    Buffer<Stack*> old;
+    old.Resize(buckets.GetSize());
+    for (size_t i = 0; i < buckets.GetSize(); ++i)
+        old[i] = buckets[i];
+
+    buckets.Resize(newSize);
+    for (size_t i = 0; i < newSize; ++i)
+        buckets[i] = 0;
+
+    for (size_t i = 0; i < old.GetSize(); ++i)
+    {
+        Stack* curr = old[i];
+        while (curr)
+        {
+            Stack* next = curr->next;
+            size_t pos  = curr->hash & (newSize - 1);
+            curr->next   = buckets[pos];
+            buckets[pos] = curr;
+            curr = next;
+        }
+    }
+}
+
+String* Profiler::ToFolded()
+{
+    Buffer<char> out;
+    char count[32] = { 0 };
+
+    for (size_t i = 0; i < buckets.GetSize(); ++i)
+    {
+        for (Stack* curr = buckets[i]; curr; curr = curr->next)
+        {
+            for (size_t j = 0; j < curr->length; ++j)
+                out.Push(curr->frames[j]);
+
+            Pika_snprintf(count, sizeof(count), " %lu\n", (unsigned long)curr->count);
+            for (const char* c = count; *c; ++c)
+                out.Push(*c);
+        }
+    }
+    return out.GetSize() ? engine->AllocString(out.GetAt(0), out.GetSize()) : engine->emptyString;
+}
+
+bool Profiler::WriteFolded(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    for (size_t i = 0; i < buckets.GetSize(); ++i)
+    {
+        for (Stack* curr = buckets[i]; curr; curr = curr->next)
+        {
+            fwrite(curr->frames, 1, curr->length, file);
+            fprintf(file, " %lu\n", (unsigned long)curr->count);
+        }
+    }
+    return fclose(file) == 0;
+}
+
+}// pika
@@ -74,4 +74,83 @@ public:
 };
 #endif
 
+#include <signal.h>
+
+namespace pika {
+
+class Context;
+class Function;
+class String;
+
+////////////////////////////////////////////// Profiler ////////////////////////////////////////////
+
+/** A sampling profiler for scripts. While a Profiler runs a timer sets Profiler::pending at a fixed
+  * interval. The interpreter checks the flag at calls and backward jumps and when it is set records 
+  * the call stack of the running Context. Identical call stacks are counted together.
+  *
+  * The samples can be written in the folded stack format read by flamegraph tools: one line per
+  * call stack, outermost function first, frames separated by ';' and followed by the number of
+  * samples.
+  */
+class PIKA_API Profiler
+{
+public:
+    enum { DEFAULT_INTERVAL = 1000 }; //!< Default sample interval in microseconds.
+    
+    Profiler(Engine* eng);
+    ~Profiler();
+    
+    /** Starts sampling every usecs microseconds of CPU time. Only one Profiler can run at a time.
+      *
+      * @result True if the profiler was started.
+      */
+    bool Start(u4 usecs = DEFAULT_INTERVAL);
+    
+    /** Stops sampling. Recorded samples are kept. */
+    void Stop();
+    
+    /** Discards all recorded samples. */
+    void Reset();
+    
+    INLINE bool   IsRunning()      const { return running == this; }
+    INLINE size_t GetSampleCount() const { return sampleCount; } //!< Returns the number of samples taken.
+    
+    /** Records the call stack of ctx, including every Context waiting on it. */
+    void Sample(Context* ctx);
+    
+    /** Returns the samples in the folded stack format. */
+    String* ToFolded();
+    
+    /** Writes the samples in the folded stack format to the file at path. */
+    bool WriteFolded(const char* path);
+    
+    static volatile sig_atomic_t pending; //!< Set by the timer when a sample should be taken.
+private:
+    /** A unique call stack and the number of times it was sampled. */
+    struct Stack
+    {
+        char*   frames;
+        size_t  length;
+        size_t  hash;
+        size_t  count;
+        Stack*  next;
+    };
+    
+    static void Tick();
+    
+    void AddFrame(Function* fn, code_t* pc);
+    void AddStack();
+    void Rehash();
+    
+    static Profiler* running;   //!< The Profiler whose timer is running.
+    
+    Engine*         engine;
+    Buffer<char>    frames;     //!< Call stack being recorded.
+    Buffer<Stack*>  buckets;    //!< Hash table of every unique call stack.
+    size_t          stackCount; //!< Number of unique call stacks.
+    size_t          sampleCount;
+};
+
+}// pika
+
 #endif
@@ -41,16 +41,16 @@ void Proxy::Init(Context* ctx)
         WriteBarrier(object);
         WriteBarrier(name);
         
-        if (object.tag >= TAG_basic)
+        if (object.GetTag() >= TAG_basic)
         {
-            Basic* basic = object.val.basic;
+            Basic* basic = object.GetBasic();
             Value res;
             if (!basic->GetSlot(name, res))
             {
             }
-            if (res.tag == TAG_property)
+            if (res.GetTag() == TAG_property)
             {
-                this->property = res.val.property;
+                this->property = res.GetProperty();
                 WriteBarrier(property);
             }
             else {
@@ -85,7 +85,7 @@ Function* Proxy::Attach(Function* fn)
         GCPAUSE_NORUN(engine);
         if (object.IsDerivedFrom(Type::StaticGetClass()))
         {
-            Type* t = (Type*)object.val.object;
+            Type* t = (Type*)object.GetObject();
             InstanceMethod* im = InstanceMethod::Create(engine, 0, fn, t);
             return im;
         }
@@ -128,7 +128,7 @@ namespace {
 
 int Proxy_getReader(Context* ctx, Value& self)
 {
-    Proxy* proxy = (Proxy*)self.val.object;
+    Proxy* proxy = (Proxy*)self.GetObject();
     Function* f = proxy->Reader();
     if (f) {
         ctx->Push(f);
@@ -140,7 +140,7 @@ int Proxy_getReader(Context* ctx, Value& self)
 
 int Proxy_setReader(Context* ctx, Value& self)
 {
-    Proxy* proxy = (Proxy*)self.val.object;
+    Proxy* proxy = (Proxy*)self.GetObject();
     u2 argc = ctx->GetArgCount();
     Function* fn = 0;
     bool attach = false;
@@ -159,7 +159,7 @@ int Proxy_setReader(Context* ctx, Value& self)
 
 int Proxy_getWriter(Context* ctx, Value& self)
 {
-    Proxy* proxy = (Proxy*)self.val.object;
+    Proxy* proxy = (Proxy*)self.GetObject();
     Function* f = proxy->Writer();
     if (f) {
         ctx->Push(f);
@@ -171,7 +171,7 @@ int Proxy_getWriter(Context* ctx, Value& self)
 
 int Proxy_setWriter(Context* ctx, Value& self)
 {
-    Proxy* proxy = (Proxy*)self.val.object;
+    Proxy* proxy = (Proxy*)self.GetObject();
     u2 argc = ctx->GetArgCount();
     Function* fn = 0;
     bool attach = false;
@@ -218,8 +218,7 @@ static int Script_createWith(Context* ctx, Value& self)
 Script* Script::Create(Engine* eng, String* name, Package* pkg)
 {
     Script* s = 0;
-    PIKA_NEW(Script, s, (eng, eng->Script_Type, name, pkg));
-    eng->AddToGC(s);
+    GCNEW(eng, Script, s, (eng, eng->Script_Type, name, pkg));
     return s;
 }
 
@@ -247,7 +246,7 @@ Runs the script with the optional arguments |args|. The return value will be a \
 
 int Script_run(Context* ctx, Value& self)
 {
-    Script* s = (Script*)self.val.object;
+    Script* s = (Script*)self.GetObject();
     Array* args = 0;
     if (ctx->GetArgCount() == 1) {
         if (!ctx->GetArg(0).IsNull())
@@ -0,0 +1,106 @@
+/*
+ *  PShape.cpp
+ *  See Copyright Notice in Pika.h
+ */
+#include "Pika.h"
+#include "PShape.h"
+
+namespace pika {
+
+Shape::Shape(Engine* eng, Shape* par, String* key, u4 attr)
+        : engine(eng),
+        parent(par),
+        children(0),
+        sibling(0),
+        keys(0),
+        attrs(0),
+        count(0),
+        numChildren(0)
+{
+    if (parent)
+    {
+        count = parent->count + 1;
+        keys  = (String**)Pika_malloc(count * sizeof(String*));
+        attrs = (u4*)Pika_malloc(count * sizeof(u4));
+
+        Pika_memcpy(keys,  parent->keys,  parent->count * sizeof(String*));
+        Pika_memcpy(attrs, parent->attrs, parent->count * sizeof(u4));
+
+        keys[count - 1]  = key;
+        attrs[count - 1] = attr;
+        
+        eng->GetGC()->ChargeExternal(0, GetExternalBytes());
+    }
+}
+
+Shape::~Shape()
+{
+    Pika_free(keys);
+    Pika_free(attrs);
+}
+
+Shape* Shape::Create(Engine* eng)
+{
+    Shape* shape = 0;
+    GCNEW(eng, Shape, shape, (eng, 0, 0, 0));
+    return shape;
+}
+
+void Shape::MarkRefs(Collector* c)
+{
+    // Children are not marked, each one is kept alive by the objects using it or by its own
+    // children.
+    if (parent)
+        parent->Mark(c);
+
+    for (u2 i = 0; i < count; ++i)
+    {
+        keys[i]->Mark(c);
+    }
+}
+
+bool Shape::Finalize()
+{
+    // A live child marks its parent, so every child of a dead Shape is dead too. Whichever of
+    // the two is finalized first unlinks them so the other never sees freed memory.
+    if (parent)
+    {
+        Shape** link = &parent->children;
+        while (*link != this)
+            link = &(*link)->sibling;
+        *link = sibling;
+        --parent->numChildren;
+    }
+    
+    for (Shape* child = children; child; child = child->sibling)
+    {
+        child->parent = 0;
+    }
+    return true;
+}
+
+Shape* Shape::AddKey(String* key, u4 attr)
+{
+    Collector* gc = engine->GetGC();
+    for (Shape* child = children; child; child = child->sibling)
+    {
+        // A dead child is still linked until it is swept, it cannot be brought back.
+        if (child->keys[count] == key && child->attrs[count] == attr && !gc->IsDead(child))
+        {
+            return child;
+        }
+    }
+
+    if (numChildren == PIKA_MAX_SHAPE_CHILDREN)
+        return 0;
+    
+    Shape* child = 0;
+    GCNEW(engine, Shape, child, (engine, this, key, attr));
+
+    child->sibling = children;
+    children = child;
+    ++numChildren;
+    return child;
+}
+
+}// pika
@@ -0,0 +1,97 @@
+/*
+ *  PShape.h
+ *  See Copyright Notice in Pika.h
+ */
+#ifndef PIKA_SHAPE_HEADER
+#define PIKA_SHAPE_HEADER
+
+#ifndef PIKA_COLLECTOR_HEADER
+#   include "PCollector.h"
+#endif
+
+namespace pika {
+
+class String;
+
+////////////////////////////////////////////// Shape ///////////////////////////////////////////////
+
+/** The hidden class of an Object whose instance variables are stored in a compact slot array.
+  * A Shape maps the name of each instance variable to its index in that array. Objects that add
+  * the same instance variables in the same order share a Shape. Adding a variable moves the object
+  * to a child Shape, which is created the first time that variable is added and reused afterwards.
+  * A Shape only keeps its parent alive. Children are weak so that transitions no object uses 
+  * anymore, and their keys, are collected while the root Shape lives on in its Type.
+  *
+  * @see Object::SetSlot
+  */
+class PIKA_API Shape : public GCObject
+{
+    Shape(Engine* eng, Shape* parent, String* key, u4 attr);
+public:
+    enum { NO_INDEX = 0xFFFF }; //!< Index used when a variable is not part of a Shape.
+    
+    virtual ~Shape();
+
+    /** Creates an empty root shape. */
+    static Shape* Create(Engine* eng);
+
+    virtual void MarkRefs(Collector*);
+    virtual bool Finalize();
+    virtual const char* GetGCName() const { return "Shape"; }
+    virtual size_t GetExternalBytes() const { return count * (sizeof(String*) + sizeof(u4)); }
+    virtual bool CanFreeInBackground() { return true; }
+
+    /** Finds the index of an instance variable.
+      *
+      * @param key      [in]  The variable's name.
+      * @param index    [out] Index of the variable in the object's slot array.
+      * @result         True if the variable is part of this Shape.
+      */
+    INLINE bool Find(String* key, u2& index) const
+    {
+        for (u2 i = 0; i < count; ++i)
+        {
+            if (keys[i] == key)
+            {
+                index = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Returns the Shape an object moves to after adding the variable key with the given attributes.
+      * Returns null if the Shape already has PIKA_MAX_SHAPE_CHILDREN other transitions.
+      */
+    Shape* AddKey(String* key, u4 attr);
+
+    INLINE u2      GetCount()       const { return count; }       //!< Returns the number of variables in the Shape.
+    INLINE String* GetKey(u2 idx)   const { return keys[idx]; }   //!< Returns the name of the variable at idx.
+    INLINE u4      GetAttr(u2 idx)  const { return attrs[idx]; }  //!< Returns the attributes of the variable at idx.
+
+    /** Returns the length of the slot array needed by an object with count variables. */
+    static INLINE size_t GetCapacity(size_t count)
+    {
+        size_t capacity = 0;
+        if (count)
+        {
+            capacity = 4;
+            while (capacity < count)
+                capacity <<= 1;
+        }
+        return capacity;
+    }
+private:
+    Engine*  engine;
+    Shape*   parent;   //!< Shape this Shape was created from.
+    Shape*   children; //!< First Shape created from this Shape (weak.)
+    Shape*   sibling;  //!< Next child of parent.
+    String** keys;     //!< Names of every variable, in the order they were added.
+    u4*      attrs;    //!< Attributes of every variable.
+    u2       count;    //!< Length of keys and attrs.
+    u2       numChildren; //!< Length of the children list.
+};
+
+}// pika
+
+#endif
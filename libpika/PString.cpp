@@ -120,11 +120,10 @@ private:
 
 PIKA_IMPL(String)
 
-String::String(Engine* eng, size_t len, const char* s)
+String::String(Engine* eng, size_t len, const char* s, size_t hash)
         : Basic(eng),
-        next(0),
         length(len),
-        hashcode(Pika_StringHash(s, len))
+        hashcode(hash)
 {
     if (length && s)
     {
@@ -133,11 +132,11 @@ String::String(Engine* eng, size_t len, const char* s)
     buffer[length] = 0;
 }
 
-String* String::Create(Engine* eng, const char* str, size_t len, bool norun)
+String* String::Create(Engine* eng, const char* str, size_t len, size_t hash, bool norun)
 {
     size_t totalSize = len + sizeof(String);
-    void* ret = Pika_malloc(totalSize);
-    String* s = new(ret) String(eng, len, str);
+    void* ret = eng->GetHeap()->Allocate(totalSize);
+    String* s = new(ret) String(eng, len, str, hash);
     if (norun)
         eng->AddToGC(s);
     else
@@ -145,6 +144,35 @@ String* String::Create(Engine* eng, const char* str, size_t len, bool norun)
     return s;
 }
 
+String* String::CreateUninterned(Engine* eng, const char* str, size_t len, bool norun)
+{
+    size_t totalSize = len + sizeof(String);
+    void* ret = eng->GetHeap()->Allocate(totalSize);
+    String* s = new(ret) String(eng, len, str, 0);
+    s->gcflags |= NotInterned | HashPending;
+    if (norun)
+        eng->AddToGC(s);
+    else
+        eng->AddToGCNoRun(s);
+    return s;
+}
+
+size_t String::ComputeHashCode() const
+{
+    String* self = const_cast<String*>(this);
+    self->hashcode = Pika_StringHash(buffer, length, engine->GetHashSeed());
+    self->gcflags &= ~HashPending;
+    return hashcode;
+}
+
+bool Pika_StringsEqual(const String* a, const String* b)
+{
+    // Interned Strings are only equal to themselves and an interned String never has the same
+    // characters as one that is not.
+    return !a->IsInterned() && !b->IsInterned() && a->GetLength() == b->GetLength() &&
+           memcmp(a->GetBuffer(), b->GetBuffer(), a->GetLength()) == 0;
+}
+
 int String::Compare(const String* rhs) const
 {
     return Pika_StringCompare(buffer, length, rhs->buffer, rhs->length);
@@ -351,6 +379,8 @@ String::~String() {}
 
 bool String::Finalize()
 {
+    if (gcflags & NotInterned)
+        return true;
     if (!(gcflags & Persistent))
         gcflags |= ReadyToCollect;
     return false;
@@ -363,7 +393,7 @@ Type* String::GetType() const
 
 bool String::GetSlot(const Value& key, Value& result)
 {
-    if (key.tag == TAG_string && key.val.str == engine->length_String)
+    if (key.GetTag() == TAG_string && key.GetString() == engine->length_String)
     {
         result.Set((pint_t)length);
         return true;
@@ -374,10 +404,10 @@ bool String::GetSlot(const Value& key, Value& result)
 
 bool String::BracketRead(const Value& key, Value& result)
 {
-    if ((key.tag == TAG_integer))
+    if ((key.GetTag() == TAG_integer))
     {
         // If its a valid index into the string.
-        pint_t idx = key.val.integer;
+        pint_t idx = key.GetInteger();
         if ((idx >= 0) && (idx < (pint_t)length))
         {
             char buff = buffer[idx];
@@ -415,8 +445,7 @@ Iterator* String::Iterate(String* iter_type)
     }
 
     Iterator* e = 0;
-    PIKA_NEW(StringIterator, e, (engine, engine->Iterator_Type, this, kind));
-    engine->AddToGC(e);
+    GCNEW(engine, StringIterator, e, (engine, engine->Iterator_Type, this, kind));
     return e;
 }
 
@@ -570,8 +599,8 @@ String* String::Escape(Array* entities, Array* replacements)
         {
             RaiseException(Exception::ERROR_type, "String.escape - All elements in both arguments must be of type String.");
         }
-        lookups[i].first = e.val.str;
-        lookups[i].second = r.val.str;
+        lookups[i].first = e.GetString();
+        lookups[i].second = r.GetString();
     }
     
     Buffer<char> buff;
@@ -645,7 +674,7 @@ String* String::Escape(String* entities, Array* replacements)
                 {
                     RaiseException(Exception::ERROR_type, "String.escape replacement Array element %d. Excepted type String.", (pint_t)ent_idx);
                 }
-                cached[ent_idx] = rep = v.val.str;
+                cached[ent_idx] = rep = v.GetString();
             }
             BufferAddString(buff, rep);
         }
@@ -733,7 +762,7 @@ class StringApi
 public:
     static int toInteger(Context* ctx, Value& self)
     {
-        String* str = self.val.str;
+        String* str = self.GetString();
         pint_t i;
         if (str->ToInteger(i))
         {
@@ -749,7 +778,7 @@ public:
     static int replaceChar(Context* ctx, Value& self)
     {
         Engine* engine = ctx->GetEngine();
-        String* str = self.val.str;
+        String* str = self.GetString();
         String* r = ctx->GetStringArg(0);
         String* w = ctx->GetStringArg(1);
         if (r->GetLength() != 1 || w->GetLength() != 1)        
@@ -768,7 +797,7 @@ public:
     
     static int toReal(Context* ctx, Value& self)
     {
-        String* str = self.val.str;
+        String* str = self.GetString();
         preal_t r;
         if (str->ToReal(r))
         {
@@ -783,7 +812,7 @@ public:
     
     static int toUpper(Context* ctx, Value& self)
     {
-        String *str = self.val.str->ToUpper();
+        String *str = self.GetString()->ToUpper();
         
         if (str)
         {
@@ -795,7 +824,7 @@ public:
     
     static int toLower(Context* ctx, Value& self)
     {
-        String *str = self.val.str->ToLower();
+        String *str = self.GetString()->ToLower();
         
         if (str)
         {
@@ -807,7 +836,7 @@ public:
     
     static int splitAt(Context* ctx, Value& self)
     {
-        String* src = self.val.str;
+        String* src = self.GetString();
         pint_t  at  = ctx->GetIntArg(0);
         size_t  len = src->GetLength();
         Engine* eng = ctx->GetEngine();
@@ -841,7 +870,7 @@ public:
         {
             ctx->WrongArgCount();
         }
-        Array* v = self.val.str->Split(searchStr);
+        Array* v = self.GetString()->Split(searchStr);
         if (v) {
             ctx->Push(v);
             return 1;
@@ -852,7 +881,7 @@ public:
     static int slice(Context* ctx, Value& self)
     {
         pint_t from, to;
-        String* str  = self.val.str;
+        String* str  = self.GetString();
         String* res  = 0;
         
         if (ctx->IsArgNull(0)) {
@@ -881,7 +910,7 @@ public:
     
     static int reverse(Context* ctx, Value& self)
     {
-        String* src = self.val.str;
+        String* src = self.GetString();
         String* res = src->Reverse();
         ctx->Push(res);
         return 1;
@@ -889,7 +918,7 @@ public:
     
     static int is_letter(Context* ctx, Value& self)
     {
-        String* src = self.val.str;
+        String* src = self.GetString();
         size_t len = src->GetLength();
         const char* buff = src->GetBuffer();
         if (!len)
@@ -909,7 +938,7 @@ public:
     
     static int is_digit(Context* ctx, Value& self)
     {
-        String* src = self.val.str;
+        String* src = self.GetString();
         size_t len = src->GetLength();
         const char* buff = src->GetBuffer();
         
@@ -933,7 +962,7 @@ public:
     
     static int is_letterOrDigit(Context* ctx, Value& self)
     {
-        String* src = self.val.str;
+        String* src = self.GetString();
         size_t len = src->GetLength();
         const char* buff = src->GetBuffer();
         
@@ -957,7 +986,7 @@ public:
     
     static int is_ascii(Context* ctx, Value& self)
     {
-        String* src = self.val.str;
+        String* src = self.GetString();
         size_t len = src->GetLength();
         const char* buff = src->GetBuffer();
         
@@ -981,7 +1010,7 @@ public:
     
     static int getLength(Context* ctx, Value& self)
     {
-        String* src = self.val.str;
+        String* src = self.GetString();
         size_t len = src->GetLength();
         ctx->Push((pint_t)len);
         return 1;
@@ -989,7 +1018,7 @@ public:
     
     static int is_whitespace(Context* ctx, Value& self)
     {
-        String* src = self.val.str;
+        String* src = self.GetString();
         size_t len = src->GetLength();
         const char* buff = src->GetBuffer();
         
@@ -1025,7 +1054,7 @@ public:
     {
         String* setStr = ctx->GetStringArg(0);
         pint_t start = 0;
-        String* str = self.val.str;
+        String* str = self.GetString();
         
         STARTING_POS()
                 
@@ -1041,7 +1070,7 @@ public:
     {
         String* setStr = ctx->GetStringArg(0);
         pint_t start = 0;
-        String* str = self.val.str;
+        String* str = self.GetString();
         
         STARTING_POS()
         
@@ -1056,7 +1085,7 @@ public:
     static int lastOf(Context* ctx, Value& self)
     {
         String* setStr = ctx->GetStringArg(0);
-        String* str = self.val.str;
+        String* str = self.GetString();
         
         if (str->length != 0 && setStr->length != 0)
         {
@@ -1079,7 +1108,7 @@ public:
     static int lastNotOf(Context* ctx, Value& self)
     {
         String* setStr = ctx->GetStringArg(0);
-        String* str = self.val.str;
+        String* str = self.GetString();
         
         if (str->length != 0 && setStr->length != 0)
         {
@@ -1108,7 +1137,7 @@ public:
     
     static int charAt(Context* ctx, Value& self)
     {
-        String* str = self.val.str;
+        String* str = self.GetString();
         pint_t idx = ctx->GetIntArg(0);
         Engine* eng = ctx->GetEngine();
         
@@ -1125,7 +1154,7 @@ public:
     
     static int toNumber(Context* ctx, Value& self)
     {
-        String* str = self.val.str;
+        String* str = self.GetString();
         Value res = str->ToNumber();
         ctx->Push( res );
         return 1;
@@ -1151,8 +1180,8 @@ public:
         
         if ((argc == 1) && ctx->GetEngine()->ToInteger(argv[0]))
         {
-            pint_t index = argv[0].val.integer;
-            String *str = self.val.str;
+            pint_t index = argv[0].GetInteger();
+            String *str = self.GetString();
             
             if (index >= 0 && index < (pint_t)str->length)
             {
@@ -1215,7 +1244,7 @@ public:
             for (size_t pos = 0; curr != end; curr++)
             {
                 // copy the next string
-                String* currStr = curr->val.str;
+                String* currStr = curr->GetString();
                 Pika_memcpy(buff + pos, currStr->GetBuffer(), currStr->GetLength());
                 pos += currStr->GetLength();
             }
@@ -1280,7 +1309,7 @@ public:
                 //
                 // copy the next string
                 //
-                String* currStr = curr->val.str;
+                String* currStr = curr->GetString();
                 Pika_memcpy(buff + pos, currStr->GetBuffer(), currStr->GetLength());
                 pos += currStr->GetLength();
                 //
@@ -1307,7 +1336,7 @@ public:
     static int chomp(Context* ctx, Value& self)
     {
         GCPAUSE(ctx->GetEngine());
-        String* vstr = self.val.str;
+        String* vstr = self.GetString();
         String* other = (ctx->GetArgCount() == 1 && !ctx->IsArgNull(0)) ?
                     ctx->GetStringArg(0) : 
                     ctx->GetEngine()->AllocString(WHITESPACE_CSTRING); // space,cr,nl,tab,vtab,formfeed
@@ -1322,13 +1351,13 @@ public:
     
     static int escape(Context* ctx, Value& self)
     {
-        String* vstr = self.val.str;
+        String* vstr = self.GetString();
         Array* reps = ctx->GetArgT<Array>(1);
         String* res = 0;
         Value& vent = ctx->GetArg(0);
         
         if (vent.IsString()) {
-            String* ents = vent.val.str;
+            String* ents = vent.GetString();
             res = vstr->Escape(ents, reps);
         } else {
             Array* aents = ctx->GetArgT<Array>(0);
@@ -1342,7 +1371,7 @@ public:
     static int strip(Context* ctx, Value& self)
     {
         u2 argc = ctx->GetArgCount();
-        String* src = self.val.str;
+        String* src = self.GetString();
         String* res = 0;
         const char* what = WHITESPACE_CSTRING;
         if (argc == 1) {
@@ -1359,7 +1388,7 @@ public:
     static int stripLeft(Context* ctx, Value& self)
     {
         u2 argc = ctx->GetArgCount();
-        String* src = self.val.str;
+        String* src = self.GetString();
         String* res = 0;
         const char* what = WHITESPACE_CSTRING;
         if (argc == 1) {
@@ -1376,7 +1405,7 @@ public:
     static int stripRight(Context* ctx, Value& self)
     {
         u2 argc = ctx->GetArgCount();
-        String* src = self.val.str;
+        String* src = self.GetString();
         String* res = 0;
         const char* what = WHITESPACE_CSTRING;
         if (argc == 1) {
@@ -1393,7 +1422,7 @@ public:
     static int times(Context* ctx, Value& self)
     {
         GCPAUSE(ctx->GetEngine());    
-        String* vstr = self.val.str;
+        String* vstr = self.GetString();
         size_t  len  = vstr->length;
         pint_t   rep  = ctx->GetIntArg(0);
         Engine* eng  = ctx->GetEngine();
@@ -1433,7 +1462,7 @@ public:
         GCPAUSE_NORUN(eng);
         
         Value& arg = ctx->GetArg(0);
-        String* res = arg.IsString() ? arg.val.str : eng->ToString(ctx, arg);
+        String* res = arg.IsString() ? arg.GetString() : eng->ToString(ctx, arg);
         ctx->Push(res);
         return 1;
     }
@@ -1451,7 +1480,7 @@ public:
     
     static int iterate(Context* ctx, Value& self)
     {
-        String* obj = self.val.str;
+        String* obj = self.GetString();
         String* iter_type = 0;
         u2 argc = ctx->GetArgCount();
         
@@ -1481,7 +1510,7 @@ public:
     static int join(Context* ctx, Value& self)
     {
         Engine* eng = ctx->GetEngine();
-        String* src_str = self.val.str;
+        String* src_str = self.GetString();
         size_t src_len = src_str->GetLength();
         Value arg = ctx->GetArg(0);
         Value result(NULL_VALUE);
@@ -1489,7 +1518,7 @@ public:
         
         if (eng->Iterator_Type->IsInstance(arg))
         {
-            iterator = (Iterator*)arg.val.object;
+            iterator = (Iterator*)arg.GetObject();
         }
         else if (!(iterator = GetIteratorFrom(ctx, arg, 0)))
         {
@@ -1551,7 +1580,7 @@ public:
     {
         const char* digits = "0123456789abcdef";
         Engine* engine = ctx->GetEngine();
-        String* src_str = self.val.str;
+        String* src_str = self.GetString();
         u2 const argc = ctx->GetArgCount();        
         size_t const src_size = src_str->GetLength();
         const char* orig_buff = src_str->GetBuffer();
@@ -1606,7 +1635,7 @@ public:
     static int search(Context* ctx, Value& self)
     {
         Engine* eng = ctx->GetEngine();
-        String* src_str = self.val.str;
+        String* src_str = self.GetString();
         String* arg = ctx->GetStringArg(0);
         
         const char* res = strstr(src_str->GetBuffer(), arg->GetBuffer());
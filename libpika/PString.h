@@ -29,6 +29,11 @@ static const char* WHITESPACE_CSTRING = " \r\n\t\v\f";
 /** @brief String is a immutable array of characters.
   * Unlike C strings in Pika strings can contain arbitrary data including null characters.
   * To create a string call Engine::AllocString or one of its variants.
+  *
+  * Strings up to the StringTable's intern limit are interned, so two of them are equal only if 
+  * they are the same object. Longer Strings are not interned and compute their hash code the 
+  * first time it is needed. Whether a String is interned depends only on its length, so two 
+  * Strings with the same characters are either both interned or both not.
   */
 class PIKA_API String : public Basic
 {
@@ -38,16 +43,31 @@ protected:
     friend class StringApi;
     friend class StringIterator;
     
-    String(Engine*, size_t, const char*);
+    String(Engine*, size_t, const char*, size_t);
 public:
     virtual ~String();
     
-    /** Do not call this directly unless you know what your doing and how strings behave in Pika. */
-    static String* Create(Engine*, const char*, size_t, bool=false);
+    enum
+    {
+        NotInterned = (UserFlagsStart << 1), //!< The String is not in the StringTable.
+        HashPending = (UserFlagsStart << 2), //!< The hash code has not been computed yet.
+    };
     
-    /** String finalization is handled by the StringTable. */
+    /** Do not call this directly unless you know what your doing and how strings behave in Pika. 
+      * The hash must be the Pika_StringHash of the characters using the Engine's hash seed.
+      */
+    static String* Create(Engine*, const char*, size_t, size_t, bool=false);
+    
+    /** Creates a String that is not interned, see StringTable. */
+    static String* CreateUninterned(Engine*, const char*, size_t, bool=false);
+    
+    /** Finalization of interned Strings is handled by the StringTable. */
     virtual bool Finalize();
     
+    virtual bool CanFreeInBackground() { return !IsInterned(); }
+    
+    virtual const char* GetGCPreview(size_t& len) const { len = length; return buffer; }
+    
     virtual Value ToValue();
     
     /** Returns a StringIterator that can iterate this String. */
@@ -61,7 +81,8 @@ public:
     virtual bool  DeleteSlot(const Value& key);
     
     INLINE size_t      GetLength()   const { return length;   }
-    INLINE size_t      GetHashCode() const { return hashcode; }
+    INLINE size_t      GetHashCode() const { return (gcflags & HashPending) ? ComputeHashCode() : hashcode; }
+    INLINE bool        IsInterned()  const { return !(gcflags & NotInterned); }
     INLINE const char* GetBuffer()   const { return buffer;   }
     
     // a simple positional formatter used by sprintp and printp. not general purpose.
@@ -129,9 +150,10 @@ public:
     
     static void StaticInitType(Engine* eng);    
 protected:
-    String*      next;      //!< Next String in the StringTable. <b>Do Not Modify</b>.
+    size_t ComputeHashCode() const;
+    
     size_t const length;    //!< Length of the String including all null characters except the terminating null.
-    size_t const hashcode;  //!< Computed hashcode.
+    size_t       hashcode;  //!< Computed hashcode, only valid once HashPending is cleared.
     char         buffer[1]; //!< Start of the buffer. The rest of the string is stored after the object.
 };
 
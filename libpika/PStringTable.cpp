@@ -4,6 +4,7 @@
  */
 #include "Pika.h"
 #include "PStringTable.h"
+#include "PHashGroup.h"
 #include "PPlatform.h"
 
 namespace pika {
@@ -13,111 +14,198 @@ PIKA_FORCE_INLINE bool Pika_strsame(const char* a, size_t lena, const char* b, s
     return lena == lenb && StrCmpWithSize(a, b, lena) == 0;
 }
 
-StringTable::StringTable(Engine* eng) : size(ENTRY_SIZE), count(0), engine(eng)
+static size_t const MAX_STRTABLE_SIZE  = GetMaxSize<String*>() / 8;
+
+// StringTable::Slots //////////////////////////////////////////////////////////////////////////////
+
+String* StringTable::Slots::Find(const char* cstr, size_t len, size_t strhash, size_t hash) const
 {
-    entries = (String**)Pika_calloc(size, sizeof(String*));    
+    size_t mask  = Pika_GroupMask(capacity);
+    size_t group = (hash >> 7) & mask;
+    u1     h     = (u1)(hash & 0x7F);
+    
+    for (size_t step = 1; ; ++step)
+    {
+        const u1* base = ctrl + group * Table::GROUP_WIDTH;
+        for (u4 bits = Pika_GroupMatch(base, h); bits; bits &= bits - 1)
+        {
+            String* s = strs[group * Table::GROUP_WIDTH + Pika_CountTrailingZeros(bits)];
+            if (s->hashcode == strhash && Pika_strsame(cstr, len, s->buffer, s->length))
+                return s;
+        }
+        if (Pika_GroupMatch(base, Table::CTRL_EMPTY))
+            return 0;
+        group = (group + step) & mask;
+    }
 }
 
-StringTable::~StringTable()
+bool StringTable::Slots::Remove(String* str, size_t hash)
 {
-    if (entries)
+    size_t mask  = Pika_GroupMask(capacity);
+    size_t group = (hash >> 7) & mask;
+    u1     h     = (u1)(hash & 0x7F);
+    
+    for (size_t step = 1; ; ++step)
     {
-        SweepAll();
-        Pika_free(entries);
-        entries = 0;
+        const u1* base = ctrl + group * Table::GROUP_WIDTH;
+        for (u4 bits = Pika_GroupMatch(base, h); bits; bits &= bits - 1)
+        {
+            size_t idx = group * Table::GROUP_WIDTH + Pika_CountTrailingZeros(bits);
+            if (strs[idx] == str)
+            {
+                ctrl[idx] = Table::CTRL_DELETED;
+                return true;
+            }
+        }
+        if (Pika_GroupMatch(base, Table::CTRL_EMPTY))
+            return false;
+        group = (group + step) & mask;
     }
 }
 
-void StringTable::Clear()
+bool StringTable::Slots::Insert(String* str, size_t hash)
 {
-    Pika_memzero(entries, sizeof(String*) * size);
+    size_t mask  = Pika_GroupMask(capacity);
+    size_t group = (hash >> 7) & mask;
+    
+    for (size_t step = 1; ; ++step)
+    {
+        if (u4 bits = Pika_GroupMatchFree(ctrl + group * Table::GROUP_WIDTH))
+        {
+            size_t idx   = group * Table::GROUP_WIDTH + Pika_CountTrailingZeros(bits);
+            bool   fresh = ctrl[idx] == Table::CTRL_EMPTY;
+            ctrl[idx] = (u1)(hash & 0x7F);
+            strs[idx] = str;
+            return fresh;
+        }
+        group = (group + step) & mask;
+    }
 }
 
-static size_t const MAX_STRTABLE_SIZE  = GetMaxSize<String*>() / 8;
-
-void StringTable::Grow()
+void StringTable::Slots::Allocate(size_t n)
 {
-    size_t nsize = size << 1;
+    ctrl = (u1*)Pika_malloc(n);
+    strs = (String**)Pika_malloc(n * sizeof(String*));
     
-    if (nsize < size ||             // Addition over-flow or
-        nsize >= MAX_STRTABLE_SIZE) // Bigger than max size allowed
+    if (!ctrl || !strs)
     {
-        nsize = MAX_STRTABLE_SIZE;
+        Pika_free(ctrl);
+        Pika_free(strs);
+        ctrl = 0;
+        strs = 0;
+        capacity = 0;
+        RaiseException("StringTable::Grow memory allocation failed.");
     }
+    memset(ctrl, Table::CTRL_EMPTY, n);
+    capacity = n;
+}
+
+void StringTable::Slots::Free()
+{
+    Pika_free(ctrl);
+    Pika_free(strs);
+    ctrl = 0;
+    strs = 0;
+    capacity = 0;
+}
+
+// StringTable /////////////////////////////////////////////////////////////////////////////////////
+
+StringTable::StringTable(Engine* eng, size_t limit) : migrated(0), used(0), count(0), internLimit(Max<size_t>(limit, PIKA_STRING_INTERN_MIN)), engine(eng)
+{
+    oldEntries.ctrl = 0;
+    oldEntries.strs = 0;
+    oldEntries.capacity = 0;
+    entries.Allocate(ENTRY_SIZE);
+}
+
+StringTable::~StringTable()
+{
+    SweepAll();
+    entries.Free();
+}
+
+void StringTable::Grow()
+{
+    // Finish the previous rehash before starting another one.
+    if (oldEntries.capacity)
+        Migrate(oldEntries.capacity);
     
-    size_t oldSize  = size;
-    String** oldEntries = entries;
+    // Size the table so the Strings fill at most half of it. If most of the used slots are 
+    // deleted the size stays the same.
+    size_t nsize = entries.capacity;
+    while (nsize < MAX_STRTABLE_SIZE && (nsize >> 1) <= count)
+        nsize <<= 1;
     
-    size  = nsize;
-    entries = (String**)Pika_calloc(size, sizeof(String*));
+    if ((nsize >> 1) <= count)
+        RaiseException("StringTable::Grow max number of strings reached.");
     
-    if (!entries)
-    {
-        size  = oldSize;
-        entries = oldEntries;
+    Slots nentries;
+    nentries.Allocate(nsize);
+    
+    oldEntries = entries;
+    entries    = nentries;
+    migrated   = 0;
+    used       = 0;
+}
 
-        RaiseException("StringTable::Grow memory allocation failed.");
-    }
+void StringTable::Migrate(size_t n)
+{
+    size_t end = Min<size_t>(migrated + n, oldEntries.capacity);
     
-    for (size_t i = 0; i < oldSize; i++)
+    for (; migrated < end; ++migrated)
     {
-        String* current = oldEntries[i];
-        
-        while (current)
+        if (Pika_CtrlIsFull(oldEntries.ctrl[migrated]))
         {
-            String* next = current->next;
-            
-            size_t hashcode = current->GetHashCode() & (size - 1);
-            
-            current->next = entries[hashcode];
-            entries[hashcode] = current;
-            
-            current = next;
+            String* s = oldEntries.strs[migrated];
+            if (entries.Insert(s, Pika_MixHash(s->hashcode)))
+                ++used;
+            // Deleted, rather than empty, so the remaining old slots can still be found.
+            oldEntries.ctrl[migrated] = Table::CTRL_DELETED;
         }
     }
-    Pika_free(oldEntries);
+    if (migrated == oldEntries.capacity)
+    {
+        oldEntries.Free();
+        migrated = 0;
+    }
 }
 
 void StringTable::SweepAll()
 {
-    for (size_t i = 0; i < size; i++)
+    Slots* all[2] = { &entries, &oldEntries };
+    
+    for (size_t t = 0; t < 2; ++t)
     {
-        String* curr = 0;
-        String* next = 0;
-        
-        curr = entries[i];
-        
-        while (curr)
+        Slots& slots = *all[t];
+        for (size_t i = 0; i < slots.capacity; i++)
         {
-            next = curr->next;
-            Pika_delete(curr);
-            curr = next;
+            if (Pika_CtrlIsFull(slots.ctrl[i]))
+            {
+                engine->GetHeap()->Delete(slots.strs[i]);
+                slots.ctrl[i] = Table::CTRL_EMPTY;
+            }
         }
     }
-    Clear();
+    oldEntries.Free();
+    migrated = used = count = 0;
 }
 
-void StringTable::Sweep()
+String* StringTable::Revive(String* str)
 {
-    for (size_t i = 0; i < size; i++)
+    // The sweep may not have reached a dead String yet, it must not be handed out unmarked.
+    engine->GetGC()->Revive(str);
+    return str;
+}
+
+void StringTable::Sweep(String* str)
+{
+    size_t hash = Pika_MixHash(str->hashcode);
+    
+    if (entries.Remove(str, hash) || (oldEntries.capacity && oldEntries.Remove(str, hash)))
     {
-        String*  curr =  entries[i];
-        String** ptrto = &entries[i];
-        
-        while (curr)
-        {
-            if (!(curr->gcflags & GCObject::Persistent) && (curr->gcflags & GCObject::ReadyToCollect))
-            {
-                *ptrto = curr->next;
-                Pika_delete(curr);
-                curr = *ptrto;
-            }
-            else
-            {
-                ptrto = &curr->next;
-                curr = curr->next;
-            }
-        }
+        engine->GetHeap()->Delete(str);
+        --count;
     }
 }
 
@@ -132,28 +220,34 @@ String* StringTable::Get(const char* cstr, size_t len, bool norun)
     {
         RaiseException("Attempt to create a string of length "SIZE_T_FMT" (max string length %d).", len, PIKA_STRING_MAX_LEN);
     }
-    size_t strhash = Pika_StringHash(cstr, len);
-    size_t hashcode = strhash & (size - 1);
     
-    for (String* s = entries[hashcode]; s; s = (String*)s->next)
+    if (len > internLimit)
+        return String::CreateUninterned(engine, cstr, len, norun);
+    
+    size_t strhash = Pika_StringHash(cstr, len, engine->GetHashSeed());
+    size_t hash    = Pika_MixHash(strhash);
+    
+    if (oldEntries.capacity)
     {
-        if (Pika_strsame(cstr, len, s->buffer, s->length))
+        Migrate(MIGRATE_STEP);
+        if (oldEntries.capacity)
         {
-            if (s->gcflags & GCObject::ReadyToCollect)               // If its a dead string ...
-                s->gcflags = s->gcflags & ~GCObject::ReadyToCollect; // ... then revive it.
-            return s;
+            if (String* s = oldEntries.Find(cstr, len, strhash, hash))
+                return Revive(s);
         }
     }
     
-    if ((size < MAX_STRTABLE_SIZE) && (count > (size << 1)))
-    {
+    if (String* s = entries.Find(cstr, len, strhash, hash))
+        return Revive(s);
+    
+    // Keep the load, including deleted slots, under 7/8 like Table does.
+    if ((used + 1) * 8 > entries.capacity * 7)
         Grow();
-        hashcode = strhash & (size - 1);
-    }
+    
+    String* newstr = String::Create(engine, cstr, len, strhash, norun);
+    if (entries.Insert(newstr, hash))
+        ++used;
     ++count;
-    String* newstr = String::Create(engine, cstr, len, norun);
-    newstr->next = entries[hashcode];
-    entries[hashcode] = newstr;
     return newstr;
 }
 
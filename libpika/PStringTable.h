@@ -9,28 +9,76 @@ namespace pika {
 
 // StringTable /////////////////////////////////////////////////////////////////////////////////////
 
+/** Interns every String created by the Engine. 
+  *
+  * The table is open addressed in the same way as Table: each slot has a control byte holding 7
+  * bits of the String's hash code and probing compares the control bytes a group at a time. When 
+  * the table grows the old slots are kept and moved into the new ones a few at a time by each
+  * call to Get. Until every old slot has been moved both sets of slots are searched.
+  * 
+  * Dead Strings are removed one at a time by Sweep as the Collector finds them, so the table 
+  * never has to be scanned as a whole.
+  *
+  * Strings longer than the intern limit bypass the table, so large buffers such as the 
+  * contents of a file are never hashed unless they are used as a key. The limit is fixed when 
+  * the table is created.
+  */
 class StringTable
 {
-    static size_t const ENTRY_SIZE = 2048;
+    static size_t const ENTRY_SIZE   = 2048; //!< Initial number of slots.
+    static size_t const MIGRATE_STEP = 16;   //!< Old slots moved by each call to Get while the table grows.
 public:
-    StringTable(Engine*);
+    /** @param internLimit Longest String that is interned, never less than PIKA_STRING_INTERN_MIN. */
+    StringTable(Engine*, size_t internLimit = PIKA_STRING_INTERN_LIMIT);
     ~StringTable();
     
     String* Get(const char* cstr, bool = false);
     String* Get(const char*, size_t, bool =false);
+    
+    INLINE size_t GetCount()       const { return count;       } //!< Number of Strings in the table.
+    INLINE size_t GetInternLimit() const { return internLimit; } //!< Longest String that is interned.
 private:
     friend class Engine;
     
+    /** A set of slots, see Table for the meaning of the control bytes. */
+    struct Slots
+    {
+        u1*      ctrl;
+        String** strs;
+        size_t   capacity; //!< Always a power of 2 and a multiple of Table::GROUP_WIDTH.
+        
+        /** Returns the String equal to (cstr, len) or null if there is none. */
+        String* Find(const char* cstr, size_t len, size_t strhash, size_t hash) const;
+        
+        /** Marks the slot holding str as deleted. Returns false if str is not there. */
+        bool Remove(String* str, size_t hash);
+        
+        /** Puts str in the first free slot. Returns true if the slot had never been used. */
+        bool Insert(String* str, size_t hash);
+        
+        void Allocate(size_t n);
+        void Free();
+    };
+    
+    /** Starts moving every String into a new set of slots. */
     void Grow();
     
-    void Sweep();
+    /** Moves up to n of the old slots into the new ones. */
+    void Migrate(size_t n);
+    
+    /** Removes the dead String str and deletes it. */
+    void Sweep(String* str);
     void SweepAll();
     
-    void Clear();
+    /** Keeps a String found in the table from being swept. */
+    String* Revive(String* str);
     
-    size_t size;
-    size_t count;
-    String** entries;
+    Slots   entries;     //!< Slots new Strings are added to.
+    Slots   oldEntries;  //!< Slots being moved into entries. Their capacity is 0 unless the table is growing.
+    size_t  migrated;    //!< Old slots that have been moved.
+    size_t  used;        //!< Slots in entries that are not empty, including deleted ones.
+    size_t  count;       //!< Strings in entries and oldEntries.
+    size_t  internLimit; //!< Longer Strings are created by String::CreateUninterned instead.
     Engine* engine;
 };
 
@@ -10,8 +10,9 @@
 
 namespace pika {
 
-SymbolTable::SymbolTable(SymbolTable* parent, u4 flags)
-    : parent(parent),
+SymbolTable::SymbolTable(MemPoolMixed* pool, SymbolTable* parent, u4 flags)
+    : pool(pool),
+    parent(parent),
     fMain(PIKA_FLAG2FIELD(flags, ST_main)),
     fPackage(PIKA_FLAG2FIELD(flags, ST_package)),
     fFunction(PIKA_FLAG2FIELD(flags, ST_function)),
@@ -23,30 +24,12 @@ SymbolTable::SymbolTable(SymbolTable* parent, u4 flags)
     depth = (parent) ? parent->depth : 0;
 }
 
-SymbolTable::~SymbolTable()
-{
-    for (size_t i = 0; i < HASHSIZE; i++)
-    {
-        Symbol* curr = 0;
-        Symbol* next = 0;
-
-        curr = table[i];
-
-        while (curr)
-        {
-            next = curr->next;
-            Pika_delete<Symbol>(curr);
-            curr = next;
-        }
-    }
-}
-
 Symbol* SymbolTable::Shadow(const char* name)
 {
     size_t  i = Pika_StringHash(name) & (HASHSIZE - 1);
     Symbol* s = 0;
 
-    PIKA_NEW(Symbol, s, (name, this, fPackage || fMain, fUsing ));
+    s = new (pool->Alloc(sizeof(Symbol))) Symbol(name, this, fPackage || fMain, fUsing);
 
     s->next  = table[i];
     table[i] = s;
@@ -67,8 +50,7 @@ Symbol* SymbolTable::Put(const char* name)
             return s;
     }
 
-    s = 0;
-    PIKA_NEW(Symbol, s, (name, this, fPackage || fMain, fUsing));
+    s = new (pool->Alloc(sizeof(Symbol))) Symbol(name, this, fPackage || fMain, fUsing);
 
     s->next = table[i];
     table[i] = s;
@@ -7,6 +7,7 @@
 
 namespace pika {
 class Engine;
+struct MemPoolMixed;
 class SymbolTable;
 
 struct Symbol
@@ -45,11 +46,10 @@ class SymbolTable
 public:
     enum { HASHSIZE = 256 };
 
-    SymbolTable(SymbolTable* parent,
+    SymbolTable(MemPoolMixed* pool,  // Symbols are allocated from pool and freed with it.
+                SymbolTable* parent,
                 u4 flags = 0); // Inherits parent's scope (currently false only for catch & finally blocks).
     
-    ~SymbolTable();
-    
     Symbol* Shadow(const char* name);
     Symbol* Put(const char* name);
     Symbol* Get(const char* name);
@@ -78,6 +78,7 @@ public:
     void Dump(pika::Engine*, class Table* tab);
 private:
     int depth;        
+    MemPoolMixed* pool;
     SymbolTable* parent;
     Symbol* table[HASHSIZE];
     u4 fMain:1;
@@ -43,7 +43,7 @@ int os_sleep(Context* ctx, Value&)
     
     if (arg0.IsReal())
     {
-        amt = (pint_t)(arg0.val.real * 1000.0);
+        amt = (pint_t)(arg0.GetReal() * 1000.0);
     }
     else
     {
@@ -119,13 +119,13 @@ int math_Abs(Context* ctx, Value&)
     
     if (arg0.IsInteger())
     {
-        pint_t res = Pika_Abs(arg0.val.integer);
+        pint_t res = Pika_Abs(arg0.GetInteger());
         ctx->Push(res);
         return 1;
     }
     else if (arg0.IsReal())
     {
-        preal_t res = Pika_Absf(arg0.val.real);
+        preal_t res = Pika_Absf(arg0.GetReal());
         ctx->Push(res);
         return 1;
     }
@@ -232,7 +232,7 @@ int CompareArguments(Context* ctx, const Opcode op, const OpOverride ovr, const
         }
         else
         {
-            is_gr = b.val.index != 0;
+            is_gr = b.GetIndex() != 0;
         }
         
         if (is_gr)
@@ -271,7 +271,7 @@ int math_clamp(Context* ctx, Value&)
 {
     Value& val = ctx->GetArg(0);
     if (val.IsInteger()) {
-        pint_t ival = val.val.integer;
+        pint_t ival = val.GetInteger();
         pint_t minVal = ctx->GetIntArg(1);
         pint_t maxVal = ctx->GetIntArg(2);
         ctx->Push(Min<pint_t>(Max<pint_t>(ival, minVal), maxVal));
@@ -489,6 +489,7 @@ public:
                 if (skip_hidden && strchr(entry, '.') == entry)
                     return Advance();
                 current = engine->GetString(entry);
+                WriteBarrier(current);
             }
             else
             {
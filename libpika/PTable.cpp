@@ -9,158 +9,206 @@
 #include "PBasic.h"
 #include "PString.h"
 #include "PTable.h"
+#include "PHashGroup.h"
 
-#ifdef  PIKA_USE_SLOT_POOL
-#define PIKA_SLOT_POOL_SIZE 2048
-
-#include "PMemPool.h"
+#include <string.h>
 
 namespace pika {
-static MemObjPool<Slot> PropertyPool(PIKA_SLOT_POOL_SIZE);
-}// pika
-
-#endif
 
-namespace pika {
-#if defined(PIKA_32)
-INLINE size_t Pika_Hash64(const u8 X) { return (size_t)X + ((size_t)(X >> 32) * 23); }
-INLINE size_t Pika_Hash32(const u4 X) { return (size_t)X; }
-#else
-INLINE size_t Pika_Hash64(const u8 X) { return (size_t)X; }
-INLINE size_t Pika_Hash32(const u4 X) { return (size_t)X; }
-#endif
+/* Integers keep their order in the table: k >> 3 picks the first group probed and the low 3 bits of
+ * k go into the control byte, so consecutive keys share a group and are stored next to each other.
+ * Keys with colliding groups, such as multiples of a large power of two, are separated by the 
+ * perturbed probe sequence in Pika_NextGroup. */
+INLINE size_t Pika_HashInteger(u8 k)
+{
+    u8 block = k >> 3;
+    return ((size_t)block << 7) | (size_t)((Pika_MixHash(block) & 0xF) << 3) | (size_t)(k & 7);
+}
 
 INLINE size_t Pika_HashValue(const Value& v)
 {
-    switch (v.tag)
+    switch (v.GetTag())
     {
-    case TAG_null:      return v.val.index;
-    case TAG_boolean:   return v.val.index;
-
 #if defined(PIKA_64BIT_INT)
-    case TAG_integer:   Pika_Hash64(*((u8*)&v.val.integer));
+    case TAG_integer:   return Pika_HashInteger((u8)v.GetInteger());
 #else
-    case TAG_integer:   Pika_Hash32(*((u4*)&v.val.integer));
+    case TAG_integer:   return Pika_HashInteger((u4)v.GetInteger());
 #endif
 
+    case TAG_real:
+    {
+        preal_t r = v.GetReal();
 #if defined(PIKA_64BIT_REAL)
-    case TAG_real:      Pika_Hash64(*((u8*)&v.val.real));
+        u8 bits;
 #else
-    case TAG_real:      Pika_Hash32(*((u4*)&v.val.real));
+        u4 bits;
 #endif
+        memcpy(&bits, &r, sizeof(bits));
+        return Pika_MixHash(bits);
+    }
 
-    case TAG_index:     return v.val.index;
-    case TAG_string:    return v.val.str->GetHashCode();
+    case TAG_string:    return Pika_MixHash(v.GetString()->GetHashCode());
     }
-    return v.val.index >> 3;
+    return Pika_MixHash(v.GetIndex() + v.GetTag());
 }
 
 size_t const Table::MAX_TABLE_SLOTS = GetMaxSize<Slot>();
 size_t const Table::MAX_TABLE_SIZE  = GetMaxSize<Slot>() / 2;
 
 Table::Table()
-        : rows(0),
+        : ctrl(0),
+        slots(0),
         count(0),
-        size(8)
-{
-    rows = (Slot**)Pika_calloc(size, sizeof(Slot*));
-    count = 0;
-}
+        capacity(0),
+        deleted(0),
+        version(0),
+        epoch(0)
+{}
 
 Table::Table(const Table& other)
-        : rows(0),
+        : ctrl(0),
+        slots(0),
         count(0),
-        size(other.size)
+        capacity(0),
+        deleted(0),
+        version(0),
+        epoch(0)
 {
-    rows = (Slot**)Pika_calloc(size, sizeof(Slot*));
-    count = other.count;
-
-    for (size_t i = 0; i < size; ++i)
+    if (other.count)
     {
-        Slot* p = other.rows[i];
-
-        while (p)
+        Rehash(other.capacity);
+        for (size_t i = 0; i < other.capacity; ++i)
         {
-#ifdef PIKA_USE_SLOT_POOL
-            void* v = PropertyPool.RawAlloc();
-            Slot* temp = new(v) Slot(p->key, p->val, p->attr);
-#else
-            Slot *temp = 0;
-            PIKA_NEW(Slot, temp, (p->key, p->val, p->attr));
-#endif
-            temp->next = rows[i];
-            rows[i] = temp;
-
-            p = p->next;
+            if (IsFull(other.ctrl[i]))
+            {
+                Slot&  s    = other.slots[i];
+                size_t hash = Pika_HashValue(s.key);
+                size_t pos  = FindInsertPos(hash);
+                
+                ctrl[pos] = (u1)(hash & 0x7F);
+                new (slots + pos) Slot(s.key, s.val, s.attr);
+            }
         }
+        count = other.count;
     }
 }
 
 Table::~Table()
 {
-    Clear();
-    Pika_free(rows);
+    Pika_free(ctrl);
+    Pika_free(slots);
 }
 
-void Table::Grow()
+void Table::Rehash(size_t ncapacity)
 {
-    size_t nsize = size << 1;
-
-    if (nsize < size ||             // Addition over-flow or
-        nsize >= MAX_TABLE_SIZE)    // Bigger than max size allowed
+    if (ncapacity < capacity ||         // Addition over-flow or
+        ncapacity >= MAX_TABLE_SIZE)    // Bigger than max size allowed
     {
-        nsize = MAX_TABLE_SIZE;
+        RaiseException("Table::Set max number of slots reached.");
     }
-
-    size_t oldSize  = size;
-    Slot** oldNodes = rows;
-
-    size  = nsize;
-    rows = (Slot**)Pika_calloc(size, sizeof(Slot*));
-
-    if (!rows)
+    
+    size_t oldCapacity = capacity;
+    u1*    oldCtrl     = ctrl;
+    Slot*  oldSlots    = slots;
+    size_t ctrlSize    = Max<size_t>(ncapacity, GROUP_WIDTH);
+    
+    ctrl  = (u1*)Pika_malloc(ctrlSize);
+    slots = (Slot*)Pika_malloc(ncapacity * sizeof(Slot));
+    
+    if (!ctrl || !slots)
     {
-        size  = oldSize;
-        rows = oldNodes;
-
+        Pika_free(ctrl);
+        Pika_free(slots);
+        ctrl  = oldCtrl;
+        slots = oldSlots;
+        
         RaiseException("Table::Grow memory allocation failed.");
     }
-
-    for (size_t i = 0; i < oldSize; i++)
+    
+    memset(ctrl, CTRL_EMPTY, ncapacity);
+    memset(ctrl + ncapacity, CTRL_UNUSED, ctrlSize - ncapacity);
+    
+    capacity = ncapacity;
+    deleted  = 0;
+    
+    for (size_t i = 0; i < oldCapacity; ++i)
     {
-        Slot* current = oldNodes[i];
-
-        while (current)
+        if (IsFull(oldCtrl[i]))
         {
+            size_t pos = FindInsertPos(Pika_HashValue(oldSlots[i].key));
+            ctrl[pos]  = oldCtrl[i];
+            Pika_memcpy(slots + pos, oldSlots + i, sizeof(Slot));
+        }
+    }
+    Pika_free(oldCtrl);
+    Pika_free(oldSlots);
+}
 
-            Slot* next = current->next;
-
-            size_t hashcode = Pika_HashValue(current->key) & (size - 1);
-
-            current->next = rows[hashcode];
-            rows[hashcode] = current;
+/* Returns the group probed after group. perturb starts as Pika_MixHash(hash) and loses 5 bits every 
+ * step, so keys whose first groups collide soon follow different sequences. Once perturb reaches 
+ * zero, group = 5 * group + 1 visits every group since the number of groups is a power of two. */
+INLINE size_t Pika_NextGroup(size_t group, size_t& perturb, size_t mask)
+{
+    perturb >>= 5;
+    return (group * 5 + 1 + perturb) & mask;
+}
 
-            current = next;
+size_t Table::Find(const Value& key, size_t hash) const
+{
+    if (!count)
+        return capacity;
+    
+    size_t mask    = Pika_GroupMask(capacity);
+    size_t group   = (hash >> 7) & mask;
+    size_t perturb = Pika_MixHash(hash);
+    u1     h       = (u1)(hash & 0x7F);
+    
+    // There is always an empty slot and the probe reaches every group, so the loop terminates.
+    for (;;)
+    {
+        const u1* base = ctrl + group * GROUP_WIDTH;
+        for (u4 bits = Pika_GroupMatch(base, h); bits; bits &= bits - 1)
+        {
+            size_t idx = group * GROUP_WIDTH + Pika_CountTrailingZeros(bits);
+            if (slots[idx].key == key)
+                return idx;
         }
+        if (Pika_GroupMatch(base, CTRL_EMPTY))
+            return capacity;
+        group = Pika_NextGroup(group, perturb, mask);
     }
-    Pika_free(oldNodes);
 }
 
-bool Table::Set(const Value& key, Value& value, u4 attr)
+size_t Table::FindInsertPos(size_t hash) const
 {
-    size_t hashcode = Pika_HashValue(key) & (size - 1);
-    Slot*  current  = rows[hashcode];
+    size_t mask    = Pika_GroupMask(capacity);
+    size_t group   = (hash >> 7) & mask;
+    size_t perturb = Pika_MixHash(hash);
+    
+    for (;;)
+    {
+        u4 bits = Pika_GroupMatchFree(ctrl + group * GROUP_WIDTH);
+        if (bits)
+            return group * GROUP_WIDTH + Pika_CountTrailingZeros(bits);
+        group = Pika_NextGroup(group, perturb, mask);
+    }
+}
 
-    while (current)
+bool Table::Set(const Value& key, Value& value, u4 attr)
+{
+    size_t hash = Pika_HashValue(key);
+    size_t idx  = Find(key, hash);
+    
+    if (idx != capacity)
     {
-        if (key == current->key)
+        Slot& s = slots[idx];
+        s.val = value;
+        if (attr && attr != s.attr)
         {
-            current->val = value;
-            if (attr) 
-                current->attr = attr;
-            return true;
+            s.attr = attr;
+            BumpVersion();
         }
-        current = current->next;
+        return true;
     }
 
     /* If adding another element will exceed the max size allowed. */
@@ -169,176 +217,134 @@ bool Table::Set(const Value& key, Value& value, u4 attr)
     {
         RaiseException("Table::Set max number of slots reached.");
     }
-
-    /* If the load ratio is greater than 2:1 and
-       the table size is not maxed out. */
-    if ((count > (size << 1)) && (size  < MAX_TABLE_SIZE))
+    
+    /* Keep the load, including deleted slots, under 7/8. If most of the load is 
+       deleted slots the table is rebuilt at the same capacity. */
+    if ((count + deleted + 1) * 8 > capacity * 7)
     {
-        Grow();
-        hashcode = Pika_HashValue(key) & (size - 1);
+        size_t ncapacity = capacity;
+        if ((count + 1) * 2 > capacity)
+        {
+            ncapacity = capacity ? capacity << 1 : (size_t)MIN_CAPACITY;
+        }
+        Rehash(ncapacity);
     }
-#ifdef PIKA_USE_SLOT_POOL
-    void* v = PropertyPool.RawAlloc();
-    Slot* temp = new(v) Slot(key, value, attr);
-#else
-    Slot* temp = 0;
-    PIKA_NEW(Slot, temp, (key, value, attr));
-#endif
-
-    temp->next = rows[hashcode];
-    rows[hashcode] = temp;
+    
+    size_t pos = FindInsertPos(hash);
+    if (ctrl[pos] == CTRL_DELETED)
+    {
+        --deleted;
+    }
+    ctrl[pos] = (u1)(hash & 0x7F);
+    new (slots + pos) Slot(key, value, attr);
+    
     ++count;
+    BumpVersion();
 
     return true;
 }
 
 bool Table::SetAttr(const Value& key, u4 attr)
 {
-    size_t hashcode = Pika_HashValue(key) & (size - 1);
-    Slot*  current  = rows[hashcode];
-    
-    while (current)
+    Slot* s = GetSlot(key);
+    if (s)
     {
-        if (key == current->key)
-        {
-            current->attr = attr;
-            return true;
-        }
-        current = current->next;
+        s->attr = attr;
+        BumpVersion();
+        return true;
     }
     return false;
 }
 
 Table::ESlotState Table::CanSet(const Value& key)
 {
-    size_t hashcode = Pika_HashValue(key) & (size - 1);
-    Slot* current = rows[hashcode];
-
-    while (current)
+    Slot* s = GetSlot(key);
+    if (s)
     {
-        if (key == current->key)
-        {
-            return (current->val.tag != TAG_property) && !(current->attr & Slot::ATTR_final) ? SS_yes : SS_no;
-        }
-        current = current->next;
+        return (s->val.GetTag() != TAG_property) && !(s->attr & Slot::ATTR_final) ? SS_yes : SS_no;
     }
     return SS_nil;
 }
 
 bool Table::CanInherit(const Value& key)
 {
-    size_t hashcode = Pika_HashValue(key) & (size - 1);
-    Slot* current = rows[hashcode];
-
-    while (current)
+    Slot* s = GetSlot(key);
+    if (s)
     {
-        if (key == current->key)
-        {
-            return (current->val.tag != TAG_property) && (!(current->attr & Slot::ATTR_final) || (current->attr & Slot::ATTR_virtual));
-        }
-        current = current->next;
+        return (s->val.GetTag() != TAG_property) && (!(s->attr & Slot::ATTR_final) || (s->attr & Slot::ATTR_virtual));
     }
     return true;
 }
 
 bool Table::Exists(const Value& key)
 {
-    size_t hashcode = Pika_HashValue(key) & (size - 1);
-    Slot *current = rows[hashcode];
-
-    while (current)
-    {
-        if (key == current->key)
-            return true;
-        current = current->next;
-    }
-    return false;
+    return Find(key, Pika_HashValue(key)) != capacity;
 }
 
 bool Table::Get(const Value& key, Value& res)
 {
-    size_t hashcode = Pika_HashValue(key) & (size - 1);
-    const Slot* current = rows[hashcode];
-
-    while (current)
+    size_t idx = Find(key, Pika_HashValue(key));
+    if (idx != capacity)
     {
-        if (key == current->key)
-        {
-            res = current->val;
-            return true;
-        }
-        current = current->next;
+        res = slots[idx].val;
+        return true;
     }
-
     return false;
 }
 
-bool Table::Remove(const Value& key)
+Slot* Table::GetSlot(const Value& key)
 {
-    size_t hashcode = Pika_HashValue(key) & (size - 1);
-    Slot** ptr_to   = &(rows[hashcode]);
-    Slot*  current  = rows[hashcode];
+    size_t idx = Find(key, Pika_HashValue(key));
+    return idx != capacity ? slots + idx : 0;
+}
 
-    while (current)
+bool Table::Remove(const Value& key)
+{
+    size_t idx = Find(key, Pika_HashValue(key));
+    
+    if (idx == capacity || (slots[idx].attr & Slot::ATTR_nodelete))
+        return false;
+    
+    // A probe never continues past a group with an empty slot, so in that case no other key
+    // depends on this slot being occupied and it can be made empty again.
+    const u1* base = ctrl + (idx & ~(size_t)(GROUP_WIDTH - 1));
+    if (Pika_GroupMatch(base, CTRL_EMPTY))
     {
-        if (key == current->key)
-        {
-            if (current->attr & Slot::ATTR_nodelete)
-                return false;
-            *ptr_to = current->next;
-
-#ifdef PIKA_USE_SLOT_POOL
-            PropertyPool.Delete(current);
-#else
-            Pika_delete<Slot>(current);
-#endif
-
-            count--;
-            return true;
-        }
-        ptr_to = &(current->next);
-        current = current->next;
+        ctrl[idx] = CTRL_EMPTY;
     }
-    return false;
+    else
+    {
+        ctrl[idx] = CTRL_DELETED;
+        ++deleted;
+    }
+    count--;
+    BumpVersion();
+    return true;
 }
 
 void Table::DoMark(Collector* c)
 {
     if (count == 0) return;
 
-    for (size_t b = 0; b < size ; ++b)
+    for (size_t i = 0; i < capacity; ++i)
     {
-        Slot* e = rows[b];
-
-        while (e)
+        if (IsFull(ctrl[i]))
         {
-            MarkValue(c, e->key);
-            MarkValue(c, e->val);
-            e = e->next;
+            MarkValue(c, slots[i].key);
+            MarkValue(c, slots[i].val);
         }
     }
 }
 
 void Table::Clear()
 {
-    for (size_t i = 0; i < size; ++i)
+    if (capacity)
     {
-        Slot* curr = rows[i];
-
-        while (curr)
-        {
-            Slot* next = curr->next;
-
-#ifdef PIKA_USE_SLOT_POOL
-            PropertyPool.Delete(curr);
-#else
-            Pika_delete<Slot>(curr);
-#endif
-            curr = next;
-        }
-        rows[i] = 0;
+        memset(ctrl, CTRL_EMPTY, capacity);
     }
-    count = 0;
+    count   = 0;
+    deleted = 0;
+    BumpVersion();
 }
 
 }// pika
@@ -28,23 +28,34 @@ struct Slot
     INLINE Slot(const Value& k, Value& v, u4 a)
             : key(k),
             val(v),
-            next(0),
             attr(a)
     {}
     
     Value key;  //!< Lookup key or name of the slot.
     Value val;  //!< Value of the slot.
-    Slot* next; //!< Next chained slot.
     u4 attr;    //!< Bitwise or'ed attributes of the slot.
 };
 
 /** A hash table class used for instance variables and associative arrays in Pika.
-  * The size is always a power of two, which allows us to quickly perform the hash 
-  * function using only a subtraction and a bitwise and.
+  * The table uses open addressing with Slots stored inline in a single array. Each Slot has a 
+  * control byte that is either empty, deleted or holds 7 bits of the key's hash. Lookups probe 
+  * the control bytes a group at a time (16 with SSE2) and only compare keys whose hash bits match.
+  * The capacity is always a power of two. Tables with fewer Slots than a group (MIN_CAPACITY is
+  * smaller than GROUP_WIDTH) pad their control bytes to a whole group with CTRL_UNUSED, so a group
+  * can always be loaded and those bytes never match a key or count as free.
   */
 class PIKA_API Table 
 {
 public:
+    enum
+    {
+        GROUP_WIDTH  = 16,   //!< Number of control bytes probed at once.
+        MIN_CAPACITY = 8,    //!< Smallest number of Slots allocated.
+        CTRL_EMPTY   = 0x80, //!< Control byte of a Slot that has never been used.
+        CTRL_DELETED = 0xFE, //!< Control byte of a removed Slot.
+        CTRL_UNUSED  = 0xFF, //!< Control byte past the end of a table smaller than a group.
+    };
+    
     /*
      * Simple forward iterator that allows you to move throught each slot in a table.
      * Warning: Do not change the key of the slot! You will make it impossible to find
@@ -71,35 +82,17 @@ public:
 
         void Reset()
         {
-            for (index = 0; index < owner->size; ++index) 
-            {
-                pos = owner->rows[index];
-                if (pos) 
-                {
-                    break;
-                }
-            }
+            index = 0;
+            Seek();
         }
 
-        INLINE operator bool()  const { return (index < owner->size) && pos;  }
-        INLINE bool operator!() const { return !((index < owner->size) && pos); }
+        INLINE operator bool()  const { return pos != 0; }
+        INLINE bool operator!() const { return pos == 0; }
 
         INLINE Iterator& operator++()
         {
-            if (pos && pos->next) 
-            {
-                pos = pos->next;
-            }
-            else 
-            {
-                ++index;
-                for (; index < owner->size; ++index) 
-                {
-                    pos = owner->rows[index];
-                    if (pos)
-                        break;
-                }
-            }
+            ++index;
+            Seek();
             return (*this);
         }
         
@@ -111,10 +104,32 @@ public:
         size_t index;
         Slot*  pos;
         Table* owner;
+    private:
+        /* Moves to the first full Slot at or after index. */
+        INLINE void Seek()
+        {
+            for (; index < owner->capacity; ++index) 
+            {
+                if (IsFull(owner->ctrl[index]))
+                {
+                    pos = owner->slots + index;
+                    return;
+                }
+            }
+            pos = 0;
+        }
     };
 private:
-    void Grow();
-
+    /** Rebuilds the table with the given capacity, dropping any deleted Slots. */
+    void Rehash(size_t ncapacity);
+    
+    /** Returns the index of the Slot for key or capacity if it does not exist. */
+    size_t Find(const Value& key, size_t hash) const;
+    
+    /** Returns the index of an empty or deleted Slot for a key that is not in the table. */
+    size_t FindInsertPos(size_t hash) const;
+    
+    static INLINE bool IsFull(u1 c) { return c < CTRL_EMPTY; }
 public:
     Table();
 
@@ -127,6 +142,11 @@ public:
     bool SetAttr(const Value& key, u4 attrs = 0);
     bool Get(const Value& key, Value& res);
     
+    /** Returns the Slot for the given key or null if it does not exist.
+      * @note The Slot remains valid as long as Table::version does not change.
+      */
+    Slot* GetSlot(const Value& key);
+    
     enum ESlotState
     {
         SS_yes = PIKA_BITFLAG(0), // Slot exists and can be set.
@@ -152,14 +172,34 @@ public:
     /** Completely removes all Slots in this table. Will not resize the array though. */
     void Clear();
     
-    Slot** rows;  //!< Linear array of slots. Each position in the array may have more than 1 chained slot.
-    size_t count; //!< The number of elements in the table.
-    size_t size;  //!< The length of the slots member variable.
+    /** Invalidates any cached Slot pointers into this table. */
+    INLINE void BumpVersion()
+    {
+        ++version;
+        if (epoch)
+            ++*epoch;
+    }
+    
+    /** Sets a counter that is bumped along with this table's version. Copies of the table do
+      * not share it. */
+    INLINE void SetEpoch(size_t* e) { epoch = e; }
+    
+    u1*    ctrl;     //!< Control byte for each slot, padded to at least GROUP_WIDTH bytes.
+    Slot*  slots;    //!< Linear array of slots.
+    size_t count;    //!< The number of elements in the table.
+    size_t capacity; //!< The length of the slots member variable.
+    size_t deleted;  //!< The number of deleted slots that have not been reused.
+    size_t version;  //!< Changes whenever a slot is added, removed or has its attributes changed.
+    size_t* epoch;   //!< Shared counter bumped with version, or null. See SetEpoch.
+    
+    INLINE size_t Count()      const { return count; }
     
-    INLINE size_t Count() const { return count; }
+    /** Bytes allocated for the control bytes and Slots. */
+    INLINE size_t GetBytes() const { return capacity ? Max<size_t>(capacity, GROUP_WIDTH) + capacity * sizeof(Slot) : 0; }
+    INLINE size_t GetVersion() const { return version; }
     
     static size_t const MAX_TABLE_SLOTS; //!< Maximum number of slots a table can have.
-    static size_t const MAX_TABLE_SIZE;  //!< Maximum number of rows a table can have.
+    static size_t const MAX_TABLE_SIZE;  //!< Maximum capacity of a table.
 };
 
 }// pika
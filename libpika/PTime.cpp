@@ -148,7 +148,7 @@ void CTime::SetMicroseconds()
 namespace {
     int CTime_mktime(Context* ctx, Value& res)
     {
-        CTime* date = static_cast<CTime*>(res.val.object);
+        CTime* date = static_cast<CTime*>(res.GetObject());
         time_t t = date->MkTime();
         pint_t i = static_cast<pint_t>(t); // TODO: What if time_t is larger than pint_t?
         ctx->Push((pint_t)i);
@@ -632,13 +632,8 @@ void Tokenizer::ReadIdentifier()
     
     // its an identifier, not a keyword.
     size_t len = toklen;
-    char* strtemp = (char*)Pika_malloc((len + 1) * sizeof(char));
-    
-    Pika_memcpy(strtemp, GetBeginPtr(), len*sizeof(char));
-    
-    strtemp[len] = '\0';
     
-    tokenVal.str = strtemp;
+    tokenVal.str = state->CopyString(GetBeginPtr(), len);
     tokenVal.len = len;
     tokenType    = TOK_identifier;
 }
@@ -709,9 +704,11 @@ void Tokenizer::ReadString(bool is_plain)
     Pika_memcpy(strtemp, strbeg, len * sizeof(char));
     
     strtemp[len] = '\0';
-    tokenVal.str = Pika_TransformString(strtemp, len, &tokenVal.len, is_plain);
+    char* str    = Pika_TransformString(strtemp, len, &tokenVal.len, is_plain);
+    tokenVal.str = state->CopyString(str, tokenVal.len);
     tokenType    = str_tok_type;
     
+    Pika_free(str);
     Pika_free(strtemp);
 }
 
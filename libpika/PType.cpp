@@ -8,6 +8,7 @@
 #include "PString.h"
 #include "PProperty.h"
 #include "PType.h"
+#include "PShape.h"
 #include "PArray.h"
 #include "PFunction.h"
 #include "PNativeBind.h"
@@ -56,8 +57,10 @@ Type::Type(Engine*    eng,
         final(false),
         abstract(false),
         subtypes(0),
-        __doc(0)
+        __doc(0),
+        instanceShape(0)
 {
+    Members().SetEpoch(engine->GetTypeEpochPtr());
     if (baseType)
     {
         if (!newfn)
@@ -75,8 +78,10 @@ Type::Type(const Type* rhs)
         final(rhs->final),
         abstract(rhs->abstract),
         subtypes(rhs->subtypes ? (Array*)rhs->subtypes->Clone() : 0),
-        __doc(rhs->__doc)
+        __doc(rhs->__doc),
+        instanceShape(0)
 {
+    Members().SetEpoch(engine->GetTypeEpochPtr());
     if (baseType)
     {
         baseType->AddSubtype(this);
@@ -124,6 +129,17 @@ void Type::MarkRefs(Collector* c)
     if (baseType) baseType->Mark(c);
     if (subtypes) subtypes->Mark(c);
     if (__doc) __doc->Mark(c);
+    if (instanceShape) instanceShape->Mark(c);
+}
+
+Shape* Type::GetInstanceShape()
+{
+    if (!instanceShape)
+    {
+        instanceShape = Shape::Create(engine);
+        WriteBarrier(instanceShape);
+    }
+    return instanceShape;
 }
 
 bool Type::IsSubtype(Type* stype)
@@ -150,14 +166,14 @@ bool Type::IsInstance(Value& inst)
 {
     Type* t = 0;
     
-    if (inst.tag >= TAG_basic)
+    if (inst.GetTag() >= TAG_basic)
     {
-        Basic* obj = inst.val.basic;
+        Basic* obj = inst.GetBasic();
         t = obj->GetType();
     }
     else
     {
-        switch (inst.tag)
+        switch (inst.GetTag())
         {
         case TAG_null:    t = engine->Null_Type;    break;
         case TAG_boolean: t = engine->Boolean_Type; break;
@@ -404,6 +420,17 @@ bool Type::CanSetField(const Value& key)
     return baseType ? baseType->CanSetField(key) : true;
 }
 
+Slot* Type::GetFieldSlot(const Value& key)
+{
+    for (Type* t = this; t; t = t->baseType)
+    {
+        Slot* slot = t->members ? t->members->GetSlot(key) : 0;
+        if (slot)
+            return slot;
+    }
+    return 0;
+}
+
 PIKA_DOC(Type_addMethod, "/(func)\
 \n\
 Adds the function, |func|, as a [InstanceMethod] of this type. The method will \
@@ -501,7 +528,7 @@ int Type_new(Context* ctx, Value& self)
 {
     Engine* engine = ctx->GetEngine();
     u2      argc   = ctx->GetArgCount();
-    Type*   meta   = self.val.type;
+    Type*   meta   = self.GetType();
     Dictionary* dict = ctx->GetKeywordArgs();
     /*
         Argument 0 name
@@ -628,6 +655,7 @@ void Type::Init(Context* ctx)
         baseType = ctx->GetArgT<Type>(2);
         
         WriteBarrier(baseType);
+        Members().BumpVersion(); // Invalidate member caches that saw this type without a base.
         
         if (!newfn)
         {
@@ -683,7 +711,7 @@ null if no types inherit from this type.")
 
 int Type_addMethod(Context* ctx, Value& self)
 {
-    Type* type = static_cast<Type*>(self.val.object);
+    Type* type = static_cast<Type*>(self.GetObject());
     Function* f = ctx->GetArgT<Function>(0);
     u2 argc = ctx->GetArgCount();
     String* name = 0;
@@ -699,7 +727,7 @@ int Type_addMethod(Context* ctx, Value& self)
 
 int Type_addClassMethod(Context* ctx, Value& self)
 {
-    Type* type = static_cast<Type*>(self.val.object);
+    Type* type = static_cast<Type*>(self.GetObject());
     Function* f = ctx->GetArgT<Function>(0);
     u2 argc = ctx->GetArgCount();
     String* name = 0;
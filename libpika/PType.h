@@ -69,6 +69,14 @@ public:
       */
     virtual bool CanSetField(const Value& key);
     
+    /** Returns the Slot of the specified field in this type or one of its base 
+      * types, or null if no type has the field. The Slot remains valid while
+      * Engine::GetTypeEpoch is unchanged.
+      *
+      * @param key      [in]  The name of the field.
+      */
+    Slot* GetFieldSlot(const Value& key);
+    
     /** Add properties to this type.
       *
       * @param rp       [in] Pointer to an array of type RegisterProperty.
@@ -148,6 +156,9 @@ public:
     
     Type_NewFn  GetNewFn() const { return newfn; }
     
+    /** Returns the empty Shape that instances of this type start with. */
+    Shape* GetInstanceShape();
+    
     void SetAllocator(Nullable<Type*> t);
     
     static void Constructor(Engine* eng, Type* obj_type, Value& res);
@@ -162,6 +173,7 @@ protected:
     bool       abstract; // Type cannot create instances.
     Array*     subtypes; // All types that are direct descendence of this type.
     String*    __doc;
+    Shape*     instanceShape; // Shape of newly created instances.
 };
 
 }// pika
@@ -69,8 +69,7 @@ bool UserData::SetSlot(const Value& key, Value& value, u4 attr)
 UserData* UserData::CreateWithPointer(Engine* eng, Type* obj_type, void* data, UserDataInfo* info)
 {
     UserData* ud;
-    PIKA_NEW(UserData, ud, (eng, obj_type, data, info));
-    eng->AddToGC(ud);
+    GCNEW(eng, UserData, ud, (eng, obj_type, data, info));
     return ud;
 }
 
@@ -78,7 +77,8 @@ UserData* UserData::CreateManaged(Engine* eng, Type* obj_type, size_t length, Us
 {
     UserData* ud;
     size_t numBytes = sizeof(UserData) + length;
-    void* ptr  = Pika_calloc(numBytes, 1);
+    void* ptr  = eng->GetHeap()->Allocate(numBytes);
+    Pika_memzero(ptr, numBytes);
     void* data = (void*)(((UserData*)ptr) + 1);
     
     ud = new(ptr) UserData(eng, obj_type, data, info);
@@ -93,14 +93,14 @@ public:
 
 INLINE bool Value::HasUserData(UserDataInfo* info) const
 {
-    return tag == TAG_userdata && (val.userdata->GetInfo() == info);
+    return IsUserData() && (GetUserData()->GetInfo() == info);
 }
 
 INLINE void* Value::GetUserData(UserDataInfo* info) const
 {
     if (HasUserData(info))
     {
-        return val.userdata->GetData();
+        return GetUserData()->GetData();
     }
     else
     {
@@ -110,7 +110,7 @@ INLINE void* Value::GetUserData(UserDataInfo* info) const
 
 INLINE void* Value::GetUserDataFast() const
 {
-    return val.userdata->GetData();
+    return GetUserData()->GetData();
 }
 
 // Used for registering Type's for UserData classes.
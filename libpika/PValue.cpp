@@ -32,7 +32,7 @@ PIKA_API const char* GetTypeString(u2 e)
 
 bool Value::IsDerivedFrom(ClassInfo* c) const
 {
-    return (tag >= TAG_basic) && val.basic && val.basic->IsDerivedFrom(c);
+    return IsBasic() && GetBasic() && GetBasic()->IsDerivedFrom(c);
 }
 
 const char* ScriptException::GetMessage() const
@@ -41,11 +41,11 @@ const char* ScriptException::GetMessage() const
     if (msg)
         return msg;
     else if (var.IsString())
-        return var.val.str->GetBuffer();
-    else if (var.IsObject() && var.val.object->GetSlot(var.val.object->GetEngine()->message_String, res))
+        return var.GetString()->GetBuffer();
+    else if (var.IsObject() && var.GetObject()->GetSlot(var.GetObject()->GetEngine()->message_String, res))
     {
         if (res.IsString())
-            return res.val.str->GetBuffer();
+            return res.GetString()->GetBuffer();
     }
     return "";
 }
@@ -55,11 +55,91 @@ enum ValueTag {
 
 PIKA_API extern const char* GetTypeString(u2 e);
 
+/** Compares the characters of two Strings that are not the same object. See String::IsInterned. */
+PIKA_API extern bool Pika_StringsEqual(const String* a, const String* b);
+
 enum NullEnum { NULL_VALUE = 0 };
 
+#if defined(PIKA_NANBOX)
+/* NaN-boxing packs a Value into 64 bits. Reals are stored as is, with every NaN converted to a 
+ * single canonical NaN. Every other tag is stored in the top 16 bits as 0xFFF0 | (tag + 1), which
+ * is a NaN no real can have, and the payload lives in the low 48 bits. Integers are 32 bits and
+ * pointers must fit into 48 bits. */
+#   define PIKA_NANBOX_TAGGED   0xFFF0000000000000ULL
+#   define PIKA_NANBOX_PAYLOAD  0x0000FFFFFFFFFFFFULL
+#   define PIKA_NANBOX_NAN      0x7FF8000000000000ULL
+#endif
+
 class PIKA_API Value
 {
 public:
+#if defined(PIKA_NANBOX)
+    INLINE  Value() {}
+    INLINE  Value(NullEnum)         { Box(TAG_null, 0); }
+    INLINE  Value(pint_t i)         { Box(TAG_integer, (u4)i); }
+    INLINE  Value(preal_t r)        { SetRealBits(r); }
+    INLINE  Value(Object* c)        { Box(TAG_object, (size_t)c); }
+    INLINE  Value(String* s)        { Box(TAG_string, (size_t)s); }
+    INLINE  Value(bool b)           { Box(TAG_boolean, b ? 1 : 0); }
+    INLINE  Value(size_t i)         { Box(TAG_index, i); }
+    INLINE  Value(Def* f)           { Box(TAG_def, (size_t)f); }
+    INLINE  Value(Property* p)      { Box(TAG_property, (size_t)p); }
+    INLINE  Value(UserData* u)      { Box(TAG_userdata, (size_t)u); }
+    
+    INLINE int GetTag() const
+    {
+        u4 hi = (u4)(bits >> 48);
+        return hi > 0xFFF0 ? (int)(hi & 0xF) - 1 : TAG_real;
+    }
+    
+    /** Changes the tag while keeping the payload. Changing to TAG_real results in 0.0. */
+    INLINE void SetTag(int t)
+    {
+        if (t == TAG_real)
+            bits = 0;
+        else
+            Box(t, (size_t)(IsReal() ? 0 : (bits & PIKA_NANBOX_PAYLOAD)));
+    }
+    
+    INLINE preal_t     GetReal()       const { preal_t r; memcpy(&r, &bits, sizeof(r)); return r; }
+    INLINE pint_t      GetInteger()    const { return (pint_t)(s4)(u4)bits; }
+    INLINE size_t      GetIndex()      const { return (size_t)(bits & PIKA_NANBOX_PAYLOAD); }
+    INLINE u8          GetBits()       const { return bits; }
+    
+    INLINE bool IsCollectible() const { return  bits >= (PIKA_NANBOX_TAGGED | ((u8)(TAG_gcobj + 1) << 48)); } //!< Is the object collectible.
+    
+    friend INLINE bool operator==(const Value& a, const Value& b)
+    {
+        return a.bits == b.bits || (a.GetTag() == TAG_string && b.GetTag() == TAG_string && Pika_StringsEqual(a.GetString(), b.GetString()));
+    }
+private:
+    INLINE void Box(int t, size_t payload) { bits = PIKA_NANBOX_TAGGED | ((u8)(t + 1) << 48) | (u8)payload; }
+    
+    INLINE void SetRealBits(preal_t r)
+    {
+        if (r != r)
+            bits = PIKA_NANBOX_NAN;
+        else
+            memcpy(&bits, &r, sizeof(r));
+    }
+    
+    template<typename T>
+    INLINE T* GetPtr() const { return (T*)(size_t)(bits & PIKA_NANBOX_PAYLOAD); }
+public:
+    INLINE void Set(pint_t i)      { Box(TAG_integer, (u4)i);         }
+    INLINE void Set(preal_t r)     { SetRealBits(r);                  }
+    INLINE void Set(size_t i)      { Box(TAG_index,    i);            }
+    INLINE void Set(Object* c)     { Box(TAG_object,   (size_t)c);    }
+    INLINE void Set(String* s)     { Box(TAG_string,   (size_t)s);    }
+    INLINE void Set(Def* f)        { Box(TAG_def,      (size_t)f);    }
+    INLINE void Set(Property* p)   { Box(TAG_property, (size_t)p);    }
+    INLINE void Set(UserData* u)   { Box(TAG_userdata, (size_t)u);    }
+    
+    INLINE void SetNull()       { Box(TAG_null, 0);    }
+    INLINE void SetTrue()       { Box(TAG_boolean, 1); }
+    INLINE void SetFalse()      { Box(TAG_boolean, 0); }
+    INLINE void SetBool(bool b) { Box(TAG_boolean, b); }
+#else
     INLINE  Value() {}
     INLINE  Value(NullEnum)         : tag(TAG_null)       { val.index = 0; }
     INLINE  Value(pint_t i)         : tag(TAG_integer)    { CLEAR_BITS(); val.integer = i; }
@@ -72,31 +152,35 @@ public:
     INLINE  Value(Property* p)      : tag(TAG_property)   { val.property = p; }
     INLINE  Value(UserData* u)      : tag(TAG_userdata)   { val.userdata = u; }
     
-    INLINE bool IsBoolean()     const { return  tag == TAG_boolean; }
-    INLINE bool IsNull()        const { return  tag == TAG_null; }
-    INLINE bool IsInteger()     const { return  tag == TAG_integer; }
-    INLINE bool IsReal()        const { return  tag == TAG_real; }
-    INLINE bool IsCollectible() const { return  tag >= TAG_gcobj; } //!< Is the object collectible.
-    INLINE bool IsString()      const { return  tag == TAG_string; }
-    INLINE bool IsFunction()    const { return  tag == TAG_def; }
-    INLINE bool IsProperty()    const { return  tag == TAG_property; }
-    INLINE bool IsUserData()    const { return  tag == TAG_userdata; }
-    INLINE bool IsObject()      const { return (tag == TAG_object) && val.object; }
-    
-    bool IsDerivedFrom(ClassInfo* c) const;
+    INLINE int  GetTag() const { return tag; }
+    INLINE void SetTag(int t)  { tag = t;    }
     
     INLINE pint_t      GetInteger()    const { return val.integer; }
     INLINE preal_t     GetReal()       const { return val.real; }
-    INLINE bool        GetBoolean()    const { return val.index != 0; }
-    INLINE Object*     GetObject()     const { return val.object; }
-    INLINE String*     GetString()     const { return val.str; }
-    INLINE Def*        GetFunction()   const { return val.def; }
     INLINE size_t      GetIndex()      const { return val.index; }
     
-    void* GetUserData(UserDataInfo* info) const;
-    void* GetUserDataFast() const;
-    bool  HasUserData(UserDataInfo* info) const;
+    INLINE bool IsCollectible() const { return  tag >= TAG_gcobj; } //!< Is the object collectible.
     
+    friend INLINE bool operator==(const Value& a, const Value& b)
+    {
+#if defined(PIKA_32) && !defined(PIKA_64) && defined(PIKA_64BIT_REAL)
+        if (a.tag != b.tag)
+        {
+            return false;
+        }
+        if (a.tag == TAG_real)
+        {
+            return a.val.real == b.val.real;
+        }
+        return (a.val.index == b.val.index) || (a.tag == TAG_string && Pika_StringsEqual(a.val.str, b.val.str));
+#else
+        return (a.tag == b.tag) && ((a.val.index == b.val.index) || (a.tag == TAG_string && Pika_StringsEqual(a.val.str, b.val.str)));
+#endif
+    }
+private:
+    template<typename T>
+    INLINE T* GetPtr() const { return (T*)val.index; }
+public:
     INLINE void Set(pint_t i)      { tag = TAG_integer; CLEAR_BITS(); val.integer = i; }
     INLINE void Set(preal_t r)     { tag = TAG_real;    CLEAR_BITS(); val.real    = r; }
     INLINE void Set(size_t i)      { tag = TAG_index;       val.index      = i; }
@@ -110,26 +194,41 @@ public:
     INLINE void SetTrue()       { tag = TAG_boolean; val.index = 1; }
     INLINE void SetFalse()      { tag = TAG_boolean; val.index = 0; }
     INLINE void SetBool(bool b) { tag = TAG_boolean; val.index = b; }
+#endif
+    INLINE bool IsBoolean()     const { return  GetTag() == TAG_boolean; }
+    INLINE bool IsNull()        const { return  GetTag() == TAG_null; }
+    INLINE bool IsInteger()     const { return  GetTag() == TAG_integer; }
+    INLINE bool IsReal()        const { return  GetTag() == TAG_real; }
+    INLINE bool IsString()      const { return  GetTag() == TAG_string; }
+    INLINE bool IsFunction()    const { return  GetTag() == TAG_def; }
+    INLINE bool IsProperty()    const { return  GetTag() == TAG_property; }
+    INLINE bool IsUserData()    const { return  GetTag() == TAG_userdata; }
+    INLINE bool IsObject()      const { return (GetTag() == TAG_object) && GetIndex(); }
+    INLINE bool IsBasic()       const { return  GetTag() >= TAG_basic; }
     
-    INLINE int GetTag() const { return tag; }
+    bool IsDerivedFrom(ClassInfo* c) const;
     
-    friend INLINE bool operator==(const Value& a, const Value& b)
-    {
-#if defined(PIKA_32) && !defined(PIKA_64) && defined(PIKA_64BIT_REAL)
-        if (a.tag != b.tag)
-        {
-            return false;
-        }
-        if (a.tag == TAG_real)
-        {
-            return a.val.real == b.val.real;
-        }
-        return (a.val.index == b.val.index);
-#else
-        return (a.tag == b.tag) && (a.val.index == b.val.index);
-#endif
-    }
+    INLINE bool        GetBoolean()    const { return GetIndex() != 0; }
+    INLINE Object*     GetObject()     const { return GetPtr<Object>();   }
+    INLINE String*     GetString()     const { return GetPtr<String>();   }
+    INLINE Def*        GetFunction()   const { return GetPtr<Def>();      }
+    INLINE Def*        GetDef()        const { return GetPtr<Def>();      }
+    INLINE Basic*      GetBasic()      const { return GetPtr<Basic>();    }
+    INLINE GCObject*   GetGCObject()   const { return GetPtr<GCObject>(); }
+    INLINE Property*   GetProperty()   const { return GetPtr<Property>(); }
+    INLINE UserData*   GetUserData()   const { return GetPtr<UserData>(); }
+    INLINE Type*       GetType()       const { return GetPtr<Type>();     }
+    INLINE Package*    GetPackage()    const { return GetPtr<Package>();  }
+    INLINE Context*    GetContext()    const { return GetPtr<Context>();  }
+    INLINE Function*   GetClosure()    const { return GetPtr<Function>(); }
     
+    void* GetUserData(UserDataInfo* info) const;
+    void* GetUserDataFast() const;
+    bool  HasUserData(UserDataInfo* info) const;
+#if defined(PIKA_NANBOX)
+private:
+    u8 bits;
+#else
     union {
         pint_t      integer;
         preal_t     real;
@@ -148,6 +247,7 @@ public:
     }
     val;
     int tag;
+#endif
 };
 
 class PIKA_API ScriptException : public Exception
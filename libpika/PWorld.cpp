@@ -22,21 +22,21 @@ String* Engine::NumberToString(Engine* eng, const Value& v)
     char buff[NUMBER2STRING_BUFF_SIZE + 1];
     buff[0] = buff[NUMBER2STRING_BUFF_SIZE] = '\0';
     
-    if (v.tag == TAG_integer)
+    if (v.GetTag() == TAG_integer)
     {
-        Pika_snprintf(buff, NUMBER2STRING_BUFF_SIZE, PINT_FMT, v.val.integer);
+        Pika_snprintf(buff, NUMBER2STRING_BUFF_SIZE, PINT_FMT, v.GetInteger());
     }
-    else if (v.tag == TAG_real)
+    else if (v.GetTag() == TAG_real)
     {
-        Pika_snprintf(buff, NUMBER2STRING_BUFF_SIZE, PIKA_REAL_FMT, v.val.real);
+        Pika_snprintf(buff, NUMBER2STRING_BUFF_SIZE, PIKA_REAL_FMT, v.GetReal());
     }
-    else if (v.tag == TAG_index)
+    else if (v.GetTag() == TAG_index)
     {
-        Pika_snprintf(buff, NUMBER2STRING_BUFF_SIZE, SIZE_T_FMT, v.val.index);
+        Pika_snprintf(buff, NUMBER2STRING_BUFF_SIZE, SIZE_T_FMT, v.GetIndex());
     }
-    else if (v.tag >= TAG_basic)
+    else if (v.GetTag() >= TAG_basic)
     {
-        Pika_snprintf(buff, NUMBER2STRING_BUFF_SIZE, POINTER_FMT, v.val.basic);
+        Pika_snprintf(buff, NUMBER2STRING_BUFF_SIZE, POINTER_FMT, v.GetBasic());
     }
     return eng->AllocString(&buff[0]);
 }
@@ -172,7 +172,7 @@ int Integer_toString(Context* ctx, Value& self)
     }
     
     Buffer<char> buff;
-    IntegerToString(self.val.integer, radix, buff);
+    IntegerToString(self.GetInteger(), radix, buff);
     String* res = ctx->GetEngine()->AllocString(buff.GetAt(0), buff.GetSize());
     if (res)
     {
@@ -194,7 +194,7 @@ PIKA_DOC(Integer_toReal, "Returns this integer converted to a [Real real number]
 
 int Integer_toReal(Context* ctx, Value& self)
 {
-    ctx->Push((preal_t)(self.val.integer));
+    ctx->Push((preal_t)(self.GetInteger()));
     return 1;
 }
 
@@ -212,7 +212,7 @@ will return false only when the integer is 0.")
 
 int Integer_toBoolean(Context* ctx, Value& self)
 {
-    ctx->PushBool(self.val.integer != 0);
+    ctx->PushBool(self.GetInteger() != 0);
     return 1;
 }
 
@@ -221,17 +221,17 @@ PIKA_DOC(Value_type, "The type for this instance.")
 int Value_getType(Context* ctx, Value& self)
 {
     Engine* eng = ctx->GetEngine();
-    switch (self.tag)
+    switch (self.GetTag())
     {
     case TAG_null:      ctx->Push(eng->Null_Type);    return 1;
     case TAG_boolean:   ctx->Push(eng->Boolean_Type); return 1;
     case TAG_integer:   ctx->Push(eng->Integer_Type); return 1;
     case TAG_real:      ctx->Push(eng->Real_Type);    return 1;
     default:
-        if (self.tag >= TAG_basic)
+        if (self.GetTag() >= TAG_basic)
         {
             Type* type = 0;
-            if ((type = self.val.basic->GetType()))
+            if ((type = self.GetBasic()->GetType()))
             {
                 ctx->Push(type);
                 return 1;
@@ -247,25 +247,22 @@ int Multi_getDoc(Context* ctx, Value& self)
     Engine* eng =ctx->GetEngine();
     String* doc = eng->emptyString;
     if (self.IsDerivedFrom(Type::StaticGetClass())) {
-        Type* type = (Type*)self.val.object;
+        Type* type = (Type*)self.GetObject();
         doc = type->GetDoc();
     } else if (self.IsDerivedFrom(Function::StaticGetClass())) {
-        Function* func = (Function*)self.val.object;
+        Function* func = (Function*)self.GetObject();
         doc = func->GetDoc();
     } else if (self.IsDerivedFrom(Proxy::StaticGetClass())) {
-        Proxy* proxy = (Proxy*)self.val.object;
+        Proxy* proxy = (Proxy*)self.GetObject();
         doc = proxy->GetDoc();
     } else if (self.IsProperty()) {
-        Property* prop = (Property*)self.val.property;
+        Property* prop = (Property*)self.GetProperty();
         doc = prop->GetDoc();
     } else if (self.IsObject()) {
       Value res(NULL_VALUE);
-      if (self.val.object->MembersPtr()) {
-        Table* tab = self.val.object->MembersPtr();
-        if (tab->Get(eng->GetString("__doc"), res) && res.IsString()) {
-            doc = res.val.str;
-        }
-      }  
+      if (self.GetObject()->GetMember(eng->GetString("__doc"), res) && res.IsString()) {
+          doc = res.GetString();
+      }
     } else {
 //        Engine* eng = ctx->GetEngine();
 //        Type* type = eng->GetTypeOf(self);
@@ -282,19 +279,19 @@ int Multi_setDoc(Context* ctx, Value& self)
 {
     String* doc = ctx->GetStringArg(0);
     if (self.IsDerivedFrom(Type::StaticGetClass())) {
-        Type* type = (Type*)self.val.object;
+        Type* type = (Type*)self.GetObject();
         type->SetDoc(doc);
     } else if (self.IsDerivedFrom(Function::StaticGetClass())) {
-        Function* func = (Function*)self.val.object;
+        Function* func = (Function*)self.GetObject();
         func->SetDoc(doc);
     } else if (self.IsDerivedFrom(Proxy::StaticGetClass())) {
-        Proxy* proxy = (Proxy*)self.val.object;
+        Proxy* proxy = (Proxy*)self.GetObject();
         proxy->SetDoc(doc);
     } else if (self.IsProperty()) {
-        Property* prop = (Property*)self.val.property;
+        Property* prop = (Property*)self.GetProperty();
         prop->SetDoc(doc);
     } else if (self.IsObject()) {
-        Object* obj = self.val.object;
+        Object* obj = self.GetObject();
         Engine* eng = ctx->GetEngine();
         obj->SetSlot(eng->GetString("__doc"), doc, Slot::ATTR_forcewrite);
     }
@@ -341,7 +338,7 @@ PIKA_DOC(Real_toInteger, "Returns this real number converted to an [Integer inte
 
 int Real_toInteger(Context* ctx, Value& self)
 {
-    ctx->Push((pint_t)(self.val.real));
+    ctx->Push((pint_t)(self.GetReal()));
     return 1;
 }
 
@@ -366,7 +363,7 @@ will return false only when the real number is 0.0 or [nan? not a number].")
 
 int Real_toBoolean(Context* ctx, Value& self)
 {
-    ctx->PushBool(Pika_RealToBoolean(self.val.real));
+    ctx->PushBool(Pika_RealToBoolean(self.GetReal()));
     return 1;
 }
 
@@ -374,7 +371,7 @@ PIKA_DOC(Real_isnan, "Returns '''true''' if the real is not a valid real number.
 
 int Real_isnan(Context* ctx, Value& self)
 {
-    ctx->PushBool(Pika_isnan(self.val.real) != 0);
+    ctx->PushBool(Pika_isnan(self.GetReal()) != 0);
     return 1;
 }
 
@@ -382,7 +379,7 @@ PIKA_DOC(Real_integer, "Returns the integer portion of this real number.")
 
 int Real_integer(Context* ctx, Value& self)
 {
-    preal_t r = self.val.real;
+    preal_t r = self.GetReal();
     preal_t i = 0.0;
     modf(r, &i);
     ctx->Push(i);
@@ -393,7 +390,7 @@ PIKA_DOC(Real_fraction, "Returns the fraction portion of this real number.")
 
 int Real_fraction(Context* ctx, Value& self)
 {
-    preal_t r = self.val.real;
+    preal_t r = self.GetReal();
     preal_t i = 0.0;
     preal_t f = modf(r, &i);
     ctx->Push(f);
@@ -403,7 +400,7 @@ int Real_fraction(Context* ctx, Value& self)
 /*
 static int Real_IsIntegral(Context* ctx, Value& self)
 {
-    preal_t r = self.val.real;
+    preal_t r = self.GetReal();
     bool integral = Pika_isFinite(r) && Pika_floor(r) == r;
     ctx->PushBool(integral);
     return 1;
@@ -414,7 +411,7 @@ static int Real_IsIntegral(Context* ctx, Value& self)
 
 int Boolean_toString(Context* ctx, Value& self)
 {
-    if (self.val.index)
+    if (self.GetIndex())
     {
         ctx->Push(ctx->GetEngine()->true_String);
     }
@@ -427,19 +424,19 @@ int Boolean_toString(Context* ctx, Value& self)
 
 int Boolean_toInteger(Context* ctx, Value& self)
 {
-    ctx->Push((pint_t)((self.val.index) ? 1 : 0));
+    ctx->Push((pint_t)((self.GetIndex()) ? 1 : 0));
     return 1;
 }
 
 int Boolean_toReal(Context* ctx, Value& self)
 {
-    ctx->Push((preal_t)((self.val.index) ? 1.0 : 0.0));
+    ctx->Push((preal_t)((self.GetIndex()) ? 1.0 : 0.0));
     return 1;
 }
 
 int Boolean_toNumber(Context* ctx, Value& self)
 {
-    ctx->Push((pint_t)((self.val.index) ? 1 : 0));
+    ctx->Push((pint_t)((self.GetIndex()) ? 1 : 0));
     return 1;
 }
 
@@ -594,7 +591,7 @@ int Global_each(Context* ctx, Value&)
 
 int Error_toString(Context* ctx, Value& self)
 {
-    Object* obj = self.val.object;
+    Object* obj = self.GetObject();
     Value vmsg;
     GCPAUSE(ctx->GetEngine());
     
@@ -614,7 +611,7 @@ int Error_init(Context* ctx, Value& self)
 {
     GCPAUSE(ctx->GetEngine());
     
-    Object* obj = self.val.object;
+    Object* obj = self.GetObject();
     String* msg = ctx->GetStringArg(0);
     
     obj->SetSlot(ctx->GetEngine()->message_String, msg);
@@ -640,9 +637,9 @@ int Global_assert(Context* ctx, Value& self)
         Value t  = ctx->GetArg(a);
         bool a_ok = false;
         
-        if (t.tag == TAG_boolean)
+        if (t.GetTag() == TAG_boolean)
         {
-            a_ok = (t.val.index != 0);
+            a_ok = (t.GetIndex() != 0);
         }
         else
         {
@@ -68,6 +68,7 @@ class Table;
 #define PIKA_AUTHOR_STR         "Russell Kyle"
 
 #include "PMemPool.h"
+#include "PHeap.h"
 #include "PBuffer.h"
 
 #include "PClassInfo.h"
@@ -84,6 +85,7 @@ class Table;
 #include "PProperty.h"
 #include "PUserData.h"
 #include "PObject.h"
+#include "PShape.h"
 #include "PPathManager.h"
 #include "PIterator.h"
 #include "PDictionary.h"
@@ -63,28 +63,28 @@ namespace pika {
             Value& arg = ctx->GetArg(0);
             if (arg.IsInteger())
             {
-                pint_t n = arg.val.integer;
+                pint_t n = arg.GetInteger();
                 this->FromInt(n);                
             }
             else if (arg.IsReal())
             {
-                preal_t n = arg.val.real;
+                preal_t n = arg.GetReal();
                 mpz_init_set_d(this->number, n);  
             }
             else if (arg.IsString())
             {
-                String* s = arg.val.str;
+                String* s = arg.GetString();
                 this->FromString(s, 10);
             }
             else if (arg.IsDerivedFrom(BigInteger::StaticGetClass()))
             {
-                BigInteger* bi =  static_cast<BigInteger*>(arg.val.object);
+                BigInteger* bi =  static_cast<BigInteger*>(arg.GetObject());
                 mpz_init_set(this->number, bi->number);
             }
 #ifdef  HAVE_MPFR
             else if (arg.IsDerivedFrom(BigReal::StaticGetClass()))
             {
-                BigReal* br =  static_cast<BigReal*>(arg.val.object);
+                BigReal* br =  static_cast<BigReal*>(arg.GetObject());
                 mpfr_get_z(this->number, br->number, DEFAULT_RND);
             }
 #endif
@@ -148,12 +148,12 @@ namespace pika {
         BigInteger* res = BigInteger::Create(this->engine, this->GetType());
         if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+            BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
             mpz_add(res->number, this->number, rhs->number);
         }
         else if (right.IsInteger())
         {
-            pint_t rhs = right.val.integer;
+            pint_t rhs = right.GetInteger();
             if (rhs >= 0)
             {
                 mpz_add_ui(res->number, this->number, rhs);                
@@ -178,12 +178,12 @@ namespace pika {
          BigInteger* res = BigInteger::Create(this->engine, this->GetType());
          if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
          {
-             BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+             BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
              mpz_mul(res->number, this->number, rhs->number);
          }
          else if (right.IsInteger())
          {
-             pint_t rhs = right.val.integer;
+             pint_t rhs = right.GetInteger();
              mpz_mul_si(res->number, this->number, rhs);  
          }
          else
@@ -216,12 +216,12 @@ namespace pika {
          BigInteger* res = BigInteger::Create(this->engine, this->GetType());
          if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
          {
-             BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+             BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
              mpz_fdiv_q(res->number, this->number, rhs->number);
          }
          else if (right.IsInteger())
          {
-             pint_t rhs = right.val.integer;
+             pint_t rhs = right.GetInteger();
              if (rhs > 0)
              {
                  mpz_fdiv_q_ui(res->number, this->number, rhs);    
@@ -250,12 +250,12 @@ namespace pika {
          BigInteger* res = BigInteger::Create(this->engine, this->GetType());
          if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
          {
-             BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+             BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
              mpz_mod(res->number, this->number, rhs->number);
          }
          else if (right.IsInteger())
          {
-             pint_t rhs = right.val.integer;
+             pint_t rhs = right.GetInteger();
              if (rhs > 0)
              {
                  mpz_mod_ui(res->number, this->number, rhs);    
@@ -284,12 +284,12 @@ namespace pika {
         BigInteger* res = BigInteger::Create(this->engine, this->GetType());
         if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+            BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
             mpz_sub(res->number, this->number, rhs->number);
         }
         else if (right.IsInteger())
         {
-            pint_t rhs = right.val.integer;
+            pint_t rhs = right.GetInteger();
             if (rhs >= 0)
             {
                 mpz_sub_ui(res->number, this->number, rhs);                
@@ -321,17 +321,17 @@ namespace pika {
         int res = 0;
         if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+            BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
             res = mpz_cmp(this->number, rhs->number);
         }
         else if (right.IsInteger())
         {
-            pint_t rhs = right.val.integer;
+            pint_t rhs = right.GetInteger();
             res = mpz_cmp_si(this->number, rhs);
         }
         else if (right.IsReal())
         {
-            preal_t rhs = right.val.real;
+            preal_t rhs = right.GetReal();
             res = mpz_cmp_d(this->number, rhs);
         }
         else
@@ -349,19 +349,19 @@ namespace pika {
         int res = 0;
         if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+            BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
             res = mpz_cmp(this->number, rhs->number);
             return res == 0;
         }
         else if (right.IsInteger())
         {
-            pint_t rhs = right.val.integer;
+            pint_t rhs = right.GetInteger();
             res = mpz_cmp_si(this->number, rhs);
             return res == 0;
         }
         else if (right.IsReal())
         {
-            preal_t rhs = right.val.real;
+            preal_t rhs = right.GetReal();
             res = mpz_cmp_d(this->number, rhs);
             return res == 0;
         }
@@ -378,7 +378,7 @@ namespace pika {
         BigInteger* res = BigInteger::Create(this->engine, this->GetType());
         if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+            BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
             mpz_and(res->number, this->number, rhs->number);
         }
         else
@@ -396,7 +396,7 @@ namespace pika {
         BigInteger* res = BigInteger::Create(this->engine, this->GetType());
         if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+            BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
             mpz_ior(res->number, this->number, rhs->number);
         }
         else
@@ -414,7 +414,7 @@ namespace pika {
         BigInteger* res = BigInteger::Create(this->engine, this->GetType());
         if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+            BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
             mpz_xor(res->number, this->number, rhs->number);
         }
         else
@@ -441,11 +441,11 @@ namespace pika {
         
         if (right.IsInteger())
         {
-            rhs = right.val.integer;
+            rhs = right.GetInteger();
         }
         else if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger* rhs_bi = static_cast<BigInteger*>(right.val.object);
+            BigInteger* rhs_bi = static_cast<BigInteger*>(right.GetObject());
             rhs = rhs_bi->ToInteger();
         }
         else
@@ -474,11 +474,11 @@ namespace pika {
         
         if (right.IsInteger())
         {
-            rhs = right.val.integer;
+            rhs = right.GetInteger();
         }
         else if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger* rhs_bi = static_cast<BigInteger*>(right.val.object);
+            BigInteger* rhs_bi = static_cast<BigInteger*>(right.GetObject());
             rhs = rhs_bi->ToInteger();
         }
         else
@@ -507,11 +507,11 @@ namespace pika {
         
         if (right.IsInteger())
         {
-            rhs = right.val.integer;
+            rhs = right.GetInteger();
         }
         else if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger* rhs_bi = static_cast<BigInteger*>(right.val.object);
+            BigInteger* rhs_bi = static_cast<BigInteger*>(right.GetObject());
             rhs = rhs_bi->ToInteger();
         }
         else
@@ -547,7 +547,7 @@ using namespace pika;
 
 int BigInteger_toInteger(Context* ctx, Value& self)
 {
-    BigInteger* bn = static_cast<BigInteger*>(self.val.object);
+    BigInteger* bn = static_cast<BigInteger*>(self.GetObject());
     pint_t res = bn->ToInteger();
     ctx->Push(res);
     return 1;
@@ -555,7 +555,7 @@ int BigInteger_toInteger(Context* ctx, Value& self)
 
 int BigInteger_toReal(Context* ctx, Value& self)
 {
-    BigInteger* bn = static_cast<BigInteger*>(self.val.object);
+    BigInteger* bn = static_cast<BigInteger*>(self.GetObject());
     preal_t res = bn->ToReal();
     ctx->Push(res);
     return 1;
@@ -563,7 +563,7 @@ int BigInteger_toReal(Context* ctx, Value& self)
 
 int BigInteger_opAdd(Context* ctx, Value& self)
 {
-    BigInteger* lhs = static_cast<BigInteger*>(self.val.object);
+    BigInteger* lhs = static_cast<BigInteger*>(self.GetObject());
     Value& arg = ctx->GetArg(0);
     BigInteger* res = lhs->Add(arg);
     ctx->Push(res);
@@ -572,7 +572,7 @@ int BigInteger_opAdd(Context* ctx, Value& self)
 
 int BigInteger_opDiv(Context* ctx, Value& self)
 {
-    BigInteger* lhs = static_cast<BigInteger*>(self.val.object);
+    BigInteger* lhs = static_cast<BigInteger*>(self.GetObject());
     Value& arg = ctx->GetArg(0);
     BigInteger* res = lhs->Div(arg);
     ctx->Push(res);
@@ -581,7 +581,7 @@ int BigInteger_opDiv(Context* ctx, Value& self)
 
 int BigInteger_opMod(Context* ctx, Value& self)
 {
-    BigInteger* lhs = static_cast<BigInteger*>(self.val.object);
+    BigInteger* lhs = static_cast<BigInteger*>(self.GetObject());
     Value& arg = ctx->GetArg(0);
     BigInteger* res = lhs->Mod(arg);
     ctx->Push(res);
@@ -590,7 +590,7 @@ int BigInteger_opMod(Context* ctx, Value& self)
 
 int BigInteger_opMul(Context* ctx, Value& self)
 {
-    BigInteger* lhs = static_cast<BigInteger*>(self.val.object);
+    BigInteger* lhs = static_cast<BigInteger*>(self.GetObject());
     Value& arg = ctx->GetArg(0);
     BigInteger* res = lhs->Mul(arg);
     ctx->Push(res);
@@ -599,7 +599,7 @@ int BigInteger_opMul(Context* ctx, Value& self)
 
 int BigInteger_opSub(Context* ctx, Value& self)
 {
-    BigInteger* lhs = static_cast<BigInteger*>(self.val.object);
+    BigInteger* lhs = static_cast<BigInteger*>(self.GetObject());
     Value& arg = ctx->GetArg(0);
     BigInteger* res = lhs->Sub(arg);
     ctx->Push(res);
@@ -608,7 +608,7 @@ int BigInteger_opSub(Context* ctx, Value& self)
 
 int BigInteger_opEq(Context* ctx, Value& self)
 {
-    BigInteger* lhs = static_cast<BigInteger*>(self.val.object);
+    BigInteger* lhs = static_cast<BigInteger*>(self.GetObject());
     Value& arg = ctx->GetArg(0);
     bool res = lhs->Equals(arg);
     ctx->PushBool(res);
@@ -617,7 +617,7 @@ int BigInteger_opEq(Context* ctx, Value& self)
 
 int BigInteger_opNe(Context* ctx, Value& self)
 {
-    BigInteger* lhs = static_cast<BigInteger*>(self.val.object);
+    BigInteger* lhs = static_cast<BigInteger*>(self.GetObject());
     Value& arg = ctx->GetArg(0);
     bool res = lhs->NotEquals(arg);
     ctx->PushBool(res);
@@ -626,7 +626,7 @@ int BigInteger_opNe(Context* ctx, Value& self)
 
 int BigInteger_opComp(Context* ctx, Value& self)
 {
-    BigInteger* lhs = static_cast<BigInteger*>(self.val.object);
+    BigInteger* lhs = static_cast<BigInteger*>(self.GetObject());
     Value& arg = ctx->GetArg(0);
     pint_t res = lhs->Comp(arg);
     ctx->Push(res);
@@ -644,7 +644,7 @@ int BigInteger_opSub_r(Context* ctx, Value& self)
         = -BigInteger + Integer   -> Rearrange since addition is associative.
      */
     
-    BigInteger* bigint = static_cast<BigInteger*>(self.val.object);
+    BigInteger* bigint = static_cast<BigInteger*>(self.GetObject());
     pint_t lhs = ctx->GetIntArg(0);
     BigInteger* rhs = bigint->Neg();
     BigInteger* res = rhs->Add(ctx->GetArg(0));
@@ -655,7 +655,7 @@ int BigInteger_opSub_r(Context* ctx, Value& self)
 #define MAKE_BINARY_OP(FN, METHOD) \
     int BigInteger_##FN(Context* ctx, Value& self)\
     {\
-        BigInteger* lhs = static_cast<BigInteger*>(self.val.object);\
+        BigInteger* lhs = static_cast<BigInteger*>(self.GetObject());\
         Value& arg = ctx->GetArg(0);\
         BigInteger* res = lhs->METHOD(arg);\
         ctx->Push(res);\
@@ -677,7 +677,7 @@ MAKE_BINARY_OP(opPow, Pow)
 #define MAKE_UNARY_OP(FN, METHOD) \
     int BigInteger_##FN(Context* ctx, Value& self)\
     {\
-        BigInteger* lhs = static_cast<BigInteger*>(self.val.object);\
+        BigInteger* lhs = static_cast<BigInteger*>(self.GetObject());\
         BigInteger* res = lhs->METHOD();\
         ctx->Push(res);\
         return 1;\
@@ -690,7 +690,7 @@ MAKE_UNARY_OP(opBitNot, BitNot)
 
 int BigInteger_toString(Context* ctx, Value& self)
 {
-    BigInteger* bigint = static_cast<BigInteger*>(self.val.object);
+    BigInteger* bigint = static_cast<BigInteger*>(self.GetObject());
     String* res = 0;
     u2 argc = ctx->GetArgCount();
     
@@ -713,7 +713,7 @@ int BigInteger_toString(Context* ctx, Value& self)
 
 int BigInteger_sign(Context* ctx, Value& self)
 {
-    BigInteger* bi = static_cast<BigInteger*>(self.val.object);
+    BigInteger* bi = static_cast<BigInteger*>(self.GetObject());
     pint_t res = bi->Sign();
     ctx->Push(res);
     return 1;
@@ -33,17 +33,17 @@ namespace pika {
             Value& arg = ctx->GetArg(0);
             if (arg.IsReal())
             {
-                preal_t n = arg.val.real;
+                preal_t n = arg.GetReal();
                 this->FromReal(n);   
             }
             else if (arg.IsInteger())
             {
-                pint_t n = arg.val.integer;
+                pint_t n = arg.GetInteger();
                 mpfr_set_si(this->number, n, DEFAULT_RND);
             }
             else if (arg.IsString())
             {
-                String* s = arg.val.str;
+                String* s = arg.GetString();
                 if (mpfr_set_str(this->number, s->GetBuffer(), 10, DEFAULT_RND) == -1)
                 {
                     mpfr_init(this->number); // Our number might have changed.
@@ -52,12 +52,12 @@ namespace pika {
             }
             else if (arg.IsDerivedFrom(BigReal::StaticGetClass()))
             {
-                BigReal* br =  static_cast<BigReal*>(arg.val.object);
+                BigReal* br =  static_cast<BigReal*>(arg.GetObject());
                 mpfr_set(this->number, br->number, DEFAULT_RND);
             }
             else if (arg.IsDerivedFrom(BigInteger::StaticGetClass()))
             {
-                BigInteger* bigint =  static_cast<BigInteger*>(arg.val.object);
+                BigInteger* bigint =  static_cast<BigInteger*>(arg.GetObject());
                 mpfr_set_z(this->number, bigint->number, DEFAULT_RND);
             }
             else
@@ -134,22 +134,22 @@ namespace pika {
         int res = 0;
         if (right.IsDerivedFrom(BigReal::StaticGetClass()))
         {
-            BigReal const* rhs = static_cast<BigReal const*>(right.val.object);
+            BigReal const* rhs = static_cast<BigReal const*>(right.GetObject());
             res = mpfr_cmp(this->number, rhs->number);
         }
         else if (right.IsReal())
         {
-            preal_t rhs = right.val.real;
+            preal_t rhs = right.GetReal();
             res = mpfr_cmp_d(this->number, rhs);
         }
         else if (right.IsInteger())
         {
-            pint_t rhs = right.val.integer;
+            pint_t rhs = right.GetInteger();
             res = mpfr_cmp_si(this->number, rhs);
         }
         else if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+            BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
             res = mpfr_cmp_z(this->number, rhs->number);
         }
         else
@@ -167,25 +167,25 @@ namespace pika {
         int res = 0;
         if (right.IsDerivedFrom(BigReal::StaticGetClass()))
         {
-            BigReal const* rhs = static_cast<BigReal const*>(right.val.object);
+            BigReal const* rhs = static_cast<BigReal const*>(right.GetObject());
             res = mpfr_cmp(this->number, rhs->number);
             return res == 0;
         }
         else if (right.IsReal())
         {
-            preal_t rhs = right.val.real;
+            preal_t rhs = right.GetReal();
             res = mpfr_cmp_d(this->number, rhs);
             return res == 0;
         }
         else if (right.IsInteger())
         {
-            pint_t rhs = right.val.integer;
+            pint_t rhs = right.GetInteger();
             res = mpfr_cmp_si(this->number, rhs);
             return res == 0;
         }
         else if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+            BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
             res = mpfr_cmp_z(this->number, rhs->number);
             return res == 0;
         }
@@ -207,22 +207,22 @@ namespace pika {
         BigReal* res = BigReal::Create(this->engine, this->GetType());
         if (right.IsDerivedFrom(BigReal::StaticGetClass()))
         {
-            BigReal const* rhs = static_cast<BigReal const*>(right.val.object);
+            BigReal const* rhs = static_cast<BigReal const*>(right.GetObject());
             mpfr_fn(res->number, this->number, rhs->number, DEFAULT_RND);
         }
         else if (right.IsReal())
         {
-            preal_t rhs = right.val.real;
+            preal_t rhs = right.GetReal();
             mpfr_d_fn(res->number, this->number, rhs, DEFAULT_RND);
         }
         else if (right.IsInteger())
         {
-            pint_t rhs = right.val.integer;
+            pint_t rhs = right.GetInteger();
             mpfr_si_fn(res->number, this->number, rhs, DEFAULT_RND);
         }
         else if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+            BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
             mpfr_z_fn(res->number, this->number, rhs->number, DEFAULT_RND);
         }
         else
@@ -252,17 +252,17 @@ namespace pika {
         BigReal* res = BigReal::Create(this->engine, this->GetType());
         if (right.IsReal())
         {
-            preal_t rhs = right.val.real;
+            preal_t rhs = right.GetReal();
             mpfr_d_sub(res->number, rhs, this->number, DEFAULT_RND);
         }
         else if (right.IsInteger())
         {
-            pint_t rhs = right.val.integer;
+            pint_t rhs = right.GetInteger();
             mpfr_si_sub(res->number, rhs, this->number, DEFAULT_RND);
         }
         else if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+            BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
             mpfr_z_sub(res->number, rhs->number, this->number, DEFAULT_RND);
         }
         else
@@ -290,7 +290,7 @@ namespace pika {
         BigReal* res = BigReal::Create(this->engine, this->GetType());
         if (right.IsDerivedFrom(BigReal::StaticGetClass()))
         {
-            BigReal const* rhs = static_cast<BigReal const*>(right.val.object);
+            BigReal const* rhs = static_cast<BigReal const*>(right.GetObject());
             mpfr_fmod(res->number, this->number, rhs->number, DEFAULT_RND);
         }
         else
@@ -308,17 +308,17 @@ namespace pika {
         BigReal* res = BigReal::Create(this->engine, this->GetType());
         if (right.IsDerivedFrom(BigReal::StaticGetClass()))
         {
-            BigReal const* rhs = static_cast<BigReal const*>(right.val.object);
+            BigReal const* rhs = static_cast<BigReal const*>(right.GetObject());
             mpfr_pow(res->number, this->number, rhs->number, DEFAULT_RND);
         }
         else if (right.IsInteger())
         {
-            pint_t rhs = right.val.integer;
+            pint_t rhs = right.GetInteger();
             mpfr_pow_si(res->number, this->number, rhs, DEFAULT_RND);
         }
         else if (right.IsDerivedFrom(BigInteger::StaticGetClass()))
         {
-            BigInteger const* rhs = static_cast<BigInteger const*>(right.val.object);
+            BigInteger const* rhs = static_cast<BigInteger const*>(right.GetObject());
             mpfr_pow_z(res->number, this->number, rhs->number, DEFAULT_RND);
         }
         else
@@ -375,7 +375,7 @@ using namespace pika;
 
 int BigReal_toString(Context* ctx, Value& self)
 {
-    BigReal* bigreal = static_cast<BigReal*>(self.val.object);
+    BigReal* bigreal = static_cast<BigReal*>(self.GetObject());
     String* res = 0;
     u2 argc = ctx->GetArgCount();
     
@@ -398,7 +398,7 @@ int BigReal_toString(Context* ctx, Value& self)
 
 int BigReal_toInteger(Context* ctx, Value& self)
 {
-    BigReal* bn = static_cast<BigReal*>(self.val.object);
+    BigReal* bn = static_cast<BigReal*>(self.GetObject());
     pint_t res = bn->ToInteger();
     ctx->Push(res);
     return 1;
@@ -406,7 +406,7 @@ int BigReal_toInteger(Context* ctx, Value& self)
 
 int BigReal_toReal(Context* ctx, Value& self)
 {
-    BigReal* bn = static_cast<BigReal*>(self.val.object);
+    BigReal* bn = static_cast<BigReal*>(self.GetObject());
     preal_t res = bn->ToReal();
     ctx->Push(res);
     return 1;
@@ -414,7 +414,7 @@ int BigReal_toReal(Context* ctx, Value& self)
 
 int BigReal_opComp(Context* ctx, Value& self)
 {
-    BigReal* bn = static_cast<BigReal*>(self.val.object);
+    BigReal* bn = static_cast<BigReal*>(self.GetObject());
     Value& arg = ctx->GetArg(0);
     pint_t res = (pint_t)bn->Comp(arg);
     ctx->Push(res);
@@ -423,7 +423,7 @@ int BigReal_opComp(Context* ctx, Value& self)
 
 int BigReal_opEq(Context* ctx, Value& self)
 {
-    BigReal* bn = static_cast<BigReal*>(self.val.object);
+    BigReal* bn = static_cast<BigReal*>(self.GetObject());
     Value& arg = ctx->GetArg(0);
     bool res = bn->Equals(arg);
     ctx->PushBool(res);
@@ -432,7 +432,7 @@ int BigReal_opEq(Context* ctx, Value& self)
 
 int BigReal_opNe(Context* ctx, Value& self)
 {
-    BigReal* bn = static_cast<BigReal*>(self.val.object);
+    BigReal* bn = static_cast<BigReal*>(self.GetObject());
     Value& arg = ctx->GetArg(0);
     bool res = bn->NotEquals(arg);
     ctx->PushBool(res);
@@ -442,7 +442,7 @@ int BigReal_opNe(Context* ctx, Value& self)
 #define MAKE_BINARY_OP(FN, METHOD) \
     int BigReal_##FN(Context* ctx, Value& self)\
     {\
-        BigReal* lhs = static_cast<BigReal*>(self.val.object);\
+        BigReal* lhs = static_cast<BigReal*>(self.GetObject());\
         Value& arg = ctx->GetArg(0);\
         BigReal* res = lhs->METHOD(arg);\
         ctx->Push(res);\
@@ -460,7 +460,7 @@ MAKE_BINARY_OP(opPow,   Pow)
 #define MAKE_UNARY_OP(FN, METHOD) \
     int BigReal_##FN(Context* ctx, Value& self)\
     {\
-        BigReal* lhs = static_cast<BigReal*>(self.val.object);\
+        BigReal* lhs = static_cast<BigReal*>(self.GetObject());\
         BigReal* res = lhs->METHOD();\
         ctx->Push(res);\
         return 1;\
@@ -471,7 +471,7 @@ MAKE_UNARY_OP(opNeg, Neg)
 #define MAKE_UNARY_BOOL_METHOD(NAME, METHOD) \
     int BigReal_##NAME(Context* ctx, Value& self)\
     {\
-        BigReal* bi = static_cast<BigReal*>(self.val.object);\
+        BigReal* bi = static_cast<BigReal*>(self.GetObject());\
         bool res = bi->METHOD();\
         ctx->PushBool(res);\
         return 1;\
@@ -486,7 +486,7 @@ MAKE_UNARY_BOOL_METHOD(isRegular,   IsRegular)
 
 int BigReal_sign(Context* ctx, Value& self)
 {
-    BigReal* bi = static_cast<BigReal*>(self.val.object);
+    BigReal* bi = static_cast<BigReal*>(self.GetObject());
     pint_t res = bi->Sign();
     ctx->Push(res);
     return 1;
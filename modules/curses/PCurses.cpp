@@ -30,11 +30,11 @@ BOOL APIENTRY DllMain(HMODULE hModule,
 #define WINDOW_TYPENAME "curses.Window"
 
 #define GETWINDOW(X)                                                                \
-if (!(self.IsUserData() && self.val.userdata->GetInfo() == &Window_Info))           \
+if (!(self.IsUserData() && self.GetUserData()->GetInfo() == &Window_Info))          \
 {                                                                                   \
     RaiseException(Exception::ERROR_type, "Invalid self object, expected Window");  \
 }                                                                                   \
-WINDOW* win = (WINDOW*)self.val.userdata->GetData();
+WINDOW* win = (WINDOW*)self.GetUserData()->GetData();
 
 
 UserDataInfo Window_Info = {
@@ -49,11 +49,11 @@ UserDataInfo Window_Info = {
 
 inline WINDOW* GetWindowFrom(Value& v)
 {
-    if (!(v.IsUserData() && v.val.userdata->GetInfo() == &Window_Info))
+    if (!(v.IsUserData() && v.GetUserData()->GetInfo() == &Window_Info))
     {
         RaiseException(Exception::ERROR_type, "Invalid window object.");
     }
-    WINDOW* win = (WINDOW*)v.val.userdata->GetData();
+    WINDOW* win = (WINDOW*)v.GetUserData()->GetData();
     return win;
 }
 
@@ -151,18 +151,18 @@ pint_t GetCharArg(Value& v)
 {
     if (v.IsString())
     {
-        if (v.val.str->GetLength() == 1)
+        if (v.GetString()->GetLength() == 1)
         {
-            return v.val.str->GetBuffer()[0];
+            return v.GetString()->GetBuffer()[0];
         }
-        else if (v.val.str->GetLength() == 0)
+        else if (v.GetString()->GetLength() == 0)
         {
             return 0;
         }
     }
     else if (v.IsInteger())
     {
-        return v.val.integer;
+        return v.GetInteger();
     }
     RaiseException(Exception::ERROR_type, "Expected character argument");
     return 0;
@@ -159,7 +159,7 @@ using namespace pika;
 
 int Event_add(Context* ctx, Value& self)
 {
-    Event* event = static_cast<Event*>(self.val.object);
+    Event* event = static_cast<Event*>(self.GetObject());
     u2 argc = ctx->GetArgCount();
     preal_t secs = 0.0;
     if (argc == 1)
@@ -176,7 +176,7 @@ int Event_add(Context* ctx, Value& self)
 
 int Event_pending(Context* ctx, Value& self)
 {
-    Event* event = static_cast<Event*>(self.val.object);
+    Event* event = static_cast<Event*>(self.GetObject());
     u2 argc = ctx->GetArgCount();
     preal_t secs = 0.0;
     if (argc == 2)
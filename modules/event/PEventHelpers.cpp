@@ -16,7 +16,7 @@ pint_t GetFilenoFrom(Context* ctx, Value vfile)
     Engine* engine = ctx->GetEngine();
     if (vfile.IsInteger())
     {
-        return vfile.val.integer;
+        return vfile.GetInteger();
     }
 
     Value filenoMethod(NULL_VALUE);
@@ -47,6 +47,6 @@ pint_t GetFilenoFrom(Context* ctx, Value vfile)
             filetype->GetBuffer());
     }
 
-    return retValue.val.integer;
+    return retValue.GetInteger();
 }
 }// pika
\ No newline at end of file
@@ -0,0 +1,189 @@
+/*
+ *  PGCLib.cpp
+ *  See Copyright Notice in Pika.h
+ */
+#include "Pika.h"
+#include "PHeapSnapshot.h"
+
+#if defined(PIKA_WIN)
+#include <windows.h>
+
+BOOL APIENTRY DllMain(HMODULE hModule,
+                      DWORD  ul_reason_for_call,
+                      LPVOID lpReserved)
+{
+    switch (ul_reason_for_call)
+    {
+    case DLL_PROCESS_ATTACH:
+    case DLL_THREAD_ATTACH:
+    case DLL_THREAD_DETACH:
+    case DLL_PROCESS_DETACH: break;
+    }
+    return TRUE;
+}
+
+#endif
+
+using namespace pika;
+
+static size_t gc_GetSizeArg(Context* ctx, const char* name)
+{
+    pint_t x = ctx->GetIntArg(0);
+    if (x < 0)
+        RaiseException(Exception::ERROR_runtime, "gc.%s: argument must not be negative.", name);
+    return (size_t)x;
+}
+
+int gc_setPause(Context* ctx, Value&)
+{
+    size_t pct = gc_GetSizeArg(ctx, "setPause");
+    ctx->Push((pint_t)ctx->GetEngine()->SetGCPause(pct));
+    return 1;
+}
+
+int gc_setStepMul(Context* ctx, Value&)
+{
+    size_t pct = gc_GetSizeArg(ctx, "setStepMul");
+    ctx->Push((pint_t)ctx->GetEngine()->SetGCStepMul(pct));
+    return 1;
+}
+
+int gc_setMaxPause(Context* ctx, Value&)
+{
+    size_t usecs = gc_GetSizeArg(ctx, "setMaxPause");
+    ctx->Push((pint_t)ctx->GetEngine()->SetGCMaxPause(usecs));
+    return 1;
+}
+
+int gc_setMarkThreads(Context* ctx, Value&)
+{
+    size_t n = gc_GetSizeArg(ctx, "setMarkThreads");
+    ctx->Push((pint_t)ctx->GetEngine()->SetGCMarkThreads(n));
+    return 1;
+}
+
+int gc_setBackgroundSweep(Context* ctx, Value&)
+{
+    bool on = ctx->ArgToBool(0);
+    ctx->PushBool(ctx->GetEngine()->SetGCBackgroundSweep(on));
+    return 1;
+}
+
+int gc_collect(Context* ctx, Value&)
+{
+    ctx->GetEngine()->CollectGarbage();
+    return 0;
+}
+
+int gc_stop(Context* ctx, Value&)
+{
+    ctx->GetEngine()->StopGC();
+    return 0;
+}
+
+int gc_restart(Context* ctx, Value&)
+{
+    ctx->GetEngine()->RestartGC();
+    return 0;
+}
+
+int gc_isRunning(Context* ctx, Value&)
+{
+    ctx->PushBool(!ctx->GetEngine()->GetGC()->IsStopped());
+    return 1;
+}
+
+static void gc_SetInt(Engine* eng, Dictionary* dict, const char* key, u8 x)
+{
+    Value k(eng->GetString(key));
+    Value v((pint_t)x);
+    dict->BracketWrite(k, v);
+}
+
+int gc_stats(Context* ctx, Value&)
+{
+    Engine*    eng = ctx->GetEngine();
+    Collector* gc  = eng->GetGC();
+    GCStats    stats;
+    
+    // Pausing keeps the counts below from being collected and the type names valid.
+    GCPAUSE_NORUN(eng);
+    gc->GetStats(stats);
+    
+    Dictionary* dict = Dictionary::Create(eng, eng->Dictionary_Type);
+    gc_SetInt(eng, dict, "slices",           stats.numSlices);
+    gc_SetInt(eng, dict, "pauseTotal",       stats.pauseTotal);
+    gc_SetInt(eng, dict, "pauseMax",         stats.pauseMax);
+    gc_SetInt(eng, dict, "minorTime",        stats.minorTime);
+    gc_SetInt(eng, dict, "rootTime",         stats.rootTime);
+    gc_SetInt(eng, dict, "scanTime",         stats.scanTime);
+    gc_SetInt(eng, dict, "sweepTime",        stats.sweepTime);
+    gc_SetInt(eng, dict, "minorCycles",      stats.minorCycles);
+    gc_SetInt(eng, dict, "majorCycles",      stats.majorCycles);
+    gc_SetInt(eng, dict, "promoted",         stats.numPromoted);
+    gc_SetInt(eng, dict, "objectsAllocated", stats.objectsAllocated);
+    gc_SetInt(eng, dict, "objectsFreed",     stats.objectsFreed);
+    gc_SetInt(eng, dict, "objects",          stats.numObjects);
+    gc_SetInt(eng, dict, "young",            stats.numYoung);
+    gc_SetInt(eng, dict, "bytesAllocated",   stats.bytesAllocated);
+    gc_SetInt(eng, dict, "bytesFreed",       stats.bytesFreed);
+    gc_SetInt(eng, dict, "bytesInUse",       stats.bytesInUse);
+    gc_SetInt(eng, dict, "externalBytes",    stats.externalBytes);
+    gc_SetInt(eng, dict, "pages",            stats.numPages);
+    gc_SetInt(eng, dict, "threshold",        stats.threshold);
+    
+    // histogram[i] counts slices of at least 2^i microseconds.
+    Array* histogram = Array::Create(eng, eng->Array_Type, GCStats::NUM_BUCKETS, 0);
+    for (size_t i = 0; i < GCStats::NUM_BUCKETS; ++i)
+        (*histogram)[i] = Value((pint_t)stats.histogram[i]);
+    Value hk(eng->GetString("histogram"));
+    Value hv(histogram);
+    dict->BracketWrite(hk, hv);
+    
+    // types maps each type name to [count, bytes].
+    Buffer<GCTypeCount> counts;
+    gc->GetLiveCounts(counts);
+    
+    Dictionary* types = Dictionary::Create(eng, eng->Dictionary_Type);
+    for (size_t i = 0; i < counts.GetSize(); ++i)
+    {
+        Value entry[2] = { Value((pint_t)counts[i].count), Value((pint_t)counts[i].bytes) };
+        Value k(eng->AllocString(counts[i].name));
+        Value v(Array::Create(eng, eng->Array_Type, 2, entry));
+        types->BracketWrite(k, v);
+    }
+    Value tk(eng->GetString("types"));
+    Value tv(types);
+    dict->BracketWrite(tk, tv);
+    
+    ctx->Push(dict);
+    return 1;
+}
+
+int gc_dumpHeap(Context* ctx, Value&)
+{
+    String* path = ctx->GetStringArg(0);
+    ctx->PushBool(HeapSnapshot::Write(ctx->GetEngine(), path->GetBuffer()));
+    return 1;
+}
+
+PIKA_MODULE(gc, eng, gc)
+{
+    GCPAUSE(eng);
+
+    static RegisterFunction gc_Functions[] = {
+        { "setPause",    gc_setPause,    1, DEF_STRICT, 0 },
+        { "setStepMul",  gc_setStepMul,  1, DEF_STRICT, 0 },
+        { "setMaxPause", gc_setMaxPause, 1, DEF_STRICT, 0 },
+        { "setMarkThreads", gc_setMarkThreads, 1, DEF_STRICT, 0 },
+        { "setBackgroundSweep", gc_setBackgroundSweep, 1, DEF_STRICT, 0 },
+        { "collect",     gc_collect,     0, DEF_STRICT, 0 },
+        { "stop",        gc_stop,        0, DEF_STRICT, 0 },
+        { "restart",     gc_restart,     0, DEF_STRICT, 0 },
+        { "isRunning",   gc_isRunning,   0, DEF_STRICT, 0 },
+        { "stats",       gc_stats,       0, DEF_STRICT, 0 },
+        { "dumpHeap",    gc_dumpHeap,    1, DEF_STRICT, 0 },
+    };
+    gc->EnterFunctions(gc_Functions, countof(gc_Functions));
+    return gc;
+}
@@ -52,12 +52,12 @@ void JsonEncoder::EncodeDictionary(Dictionary* dict)
     buffer.Push('{');
     ++depth;
     this->Newline();
-    Table& elements = dict->Elements();
-    for (Table::Iterator iter = elements.GetIterator(); iter; )
+    for (Dictionary::ElementIterator iter = dict->GetElements(); iter; )
     {
-        this->EncodeKey(iter->key);
+        Value key = iter.GetKey();
+        this->EncodeKey(key);
         buffer.Push(':'); buffer.Push(' ');
-        this->EncodeElement(iter->val);
+        this->EncodeElement(iter.GetValue());
                 
         if (++iter)
         {
@@ -83,7 +83,7 @@ void JsonEncoder::EncodeKey(Value& key)
 {
     if (key.IsString())
     {
-        this->EncodeString(key.val.str);
+        this->EncodeString(key.GetString());
         return;
     }
     this->InvalidKey(key);
@@ -91,14 +91,14 @@ void JsonEncoder::EncodeKey(Value& key)
 
 void JsonEncoder::EncodeElement(Value& elem)
 {
-    switch(elem.tag)
+    switch(elem.GetTag())
     {
     case TAG_null:
         this->EncodeNull();
         return;
    
     case TAG_boolean:
-        if (elem.val.index)
+        if (elem.GetIndex())
         {
             this->EncodeTrue();
         }
@@ -109,15 +109,15 @@ void JsonEncoder::EncodeElement(Value& elem)
         return;
     
     case TAG_integer:
-        this->EncodeInteger(elem.val.integer);
+        this->EncodeInteger(elem.GetInteger());
         return;
     
     case TAG_real:
-        this->EncodeReal(elem.val.real);
+        this->EncodeReal(elem.GetReal());
         return;
     
     case TAG_string:
-        this->EncodeString(elem.val.str);
+        this->EncodeString(elem.GetString());
         return;
     // case TAG_property:
     // TODO: call property
@@ -125,13 +125,13 @@ void JsonEncoder::EncodeElement(Value& elem)
     case TAG_object:
         if (elem.IsDerivedFrom(Array::StaticGetClass()))
         {
-            Array* array = static_cast<Array*>(elem.val.object);
+            Array* array = static_cast<Array*>(elem.GetObject());
             this->EncodeArray(array);
             return;
         }
         else if (elem.IsDerivedFrom(Dictionary::StaticGetClass()))
         {
-            Dictionary* dict = static_cast<Dictionary*>(elem.val.object);
+            Dictionary* dict = static_cast<Dictionary*>(elem.GetObject());
             this->EncodeDictionary(dict);
             return;
         }
@@ -288,12 +288,12 @@ String* JsonEncoder::Encode(Value& val)
 {
     if (val.IsDerivedFrom(Array::StaticGetClass()))
     {
-        Array* array = static_cast<Array*>(val.val.object);
+        Array* array = static_cast<Array*>(val.GetObject());
         this->EncodeArray(array);
     }
     else if (val.IsDerivedFrom(Dictionary::StaticGetClass()))
     {
-        Dictionary* dict = static_cast<Dictionary*>(val.val.object);
+        Dictionary* dict = static_cast<Dictionary*>(val.GetObject());
         this->EncodeDictionary(dict);
     }
     size_t length = buffer.GetSize();
@@ -0,0 +1,103 @@
+/*
+ *  PProfilerLib.cpp
+ *  See Copyright Notice in Pika.h
+ */
+#include "Pika.h"
+#include "PProfiler.h"
+
+#if defined(PIKA_WIN)
+#include <windows.h>
+
+BOOL APIENTRY DllMain(HMODULE hModule,
+                      DWORD  ul_reason_for_call,
+                      LPVOID lpReserved)
+{
+    switch (ul_reason_for_call)
+    {
+    case DLL_PROCESS_ATTACH:
+    case DLL_THREAD_ATTACH:
+    case DLL_THREAD_DETACH:
+    case DLL_PROCESS_DETACH: break;
+    }
+    return TRUE;
+}
+
+#endif
+
+using namespace pika;
+
+int profiler_start(Context* ctx, Value&)
+{
+    u2     argc     = ctx->GetArgCount();
+    pint_t interval = Profiler::DEFAULT_INTERVAL;
+    
+    if (argc == 1)
+    {
+        interval = ctx->GetIntArg(0);
+        if (interval <= 0)
+            RaiseException(Exception::ERROR_runtime, "profiler.start: interval must be a positive number of microseconds.");
+    }
+    else if (argc != 0)
+    {
+        ctx->WrongArgCount();
+        return 0;
+    }
+    
+    Profiler* profiler = ctx->GetEngine()->GetProfiler();
+    ctx->PushBool(profiler->Start((u4)interval));
+    return 1;
+}
+
+int profiler_stop(Context* ctx, Value&)
+{
+    ctx->GetEngine()->GetProfiler()->Stop();
+    return 0;
+}
+
+int profiler_reset(Context* ctx, Value&)
+{
+    ctx->GetEngine()->GetProfiler()->Reset();
+    return 0;
+}
+
+int profiler_running(Context* ctx, Value&)
+{
+    ctx->PushBool(ctx->GetEngine()->GetProfiler()->IsRunning());
+    return 1;
+}
+
+int profiler_count(Context* ctx, Value&)
+{
+    ctx->Push((pint_t)ctx->GetEngine()->GetProfiler()->GetSampleCount());
+    return 1;
+}
+
+int profiler_folded(Context* ctx, Value&)
+{
+    ctx->Push(ctx->GetEngine()->GetProfiler()->ToFolded());
+    return 1;
+}
+
+int profiler_write(Context* ctx, Value&)
+{
+    String* path = ctx->GetStringArg(0);
+    ctx->PushBool(ctx->GetEngine()->GetProfiler()->WriteFolded(path->GetBuffer()));
+    return 1;
+}
+
+PIKA_MODULE(profiler, eng, profiler)
+{
+    GCPAUSE(eng);
+    
+    static RegisterFunction profiler_Functions[] = {
+        { "start",   profiler_start,   0, DEF_VAR_ARGS, 0 },
+        { "stop",    profiler_stop,    0, DEF_STRICT,   0 },
+        { "reset",   profiler_reset,   0, DEF_STRICT,   0 },
+        { "running", profiler_running, 0, DEF_STRICT,   0 },
+        { "count",   profiler_count,   0, DEF_STRICT,   0 },
+        { "folded",  profiler_folded,  0, DEF_STRICT,   0 },
+        { "write",   profiler_write,   1, DEF_STRICT,   0 },
+    };
+    profiler->EnterFunctions(profiler_Functions, countof(profiler_Functions));
+    return profiler;
+}
@@ -355,7 +355,7 @@ PIKA_IMPL(RegExp)
 namespace {
     int RegExp_exec(Context* ctx, Value& self)
     {
-        RegExp* re = static_cast<RegExp*>(self.val.object);
+        RegExp* re = static_cast<RegExp*>(self.GetObject());
         String* subj = ctx->GetStringArg(0);
         bool objs = false;
         if (ctx->GetArgCount() == 2)
@@ -400,7 +400,7 @@ namespace {
             ctx->Run();
         Value res = ctx->PopTop();
         if (res.IsString())
-            return res.val.str;
+            return res.GetString();
         else        
             RaiseException("Formatting function for String.matchReplace must return a string.");
         return 0;
@@ -411,13 +411,13 @@ namespace {
     {
         Engine* eng = ctx->GetEngine();
                 
-        String* source = self.val.str;
+        String* source = self.GetString();
         RegExp* re = ctx->GetArgT<RegExp>(0);
         
         Value format_val = ctx->GetArg(1);        
         String* format = 0;
         if (format_val.IsString()) {
-            format = format_val.val.str;
+            format = format_val.GetString();
         }
                
         Buffer<char> buff;
@@ -460,7 +460,7 @@ namespace {
                 match_bounds.stop = Max(match_bounds.stop, stop);
                 // check for last index used bound.stop
                 // create String for this match and set 
-                String* match_str = (re->GetMatch(start, stop, source)).val.str;
+                String* match_str = (re->GetMatch(start, stop, source)).GetString();
                 pos_args[ pos_count++ ] = match_str;
                 
                 // We push the string not only for the format function call but
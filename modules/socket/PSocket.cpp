@@ -30,11 +30,11 @@ void Socket::SetSockOpt(pint_t opt, Value val)
     
     if (val.IsBoolean())
     {
-        ival = val.val.index ? 1 : 0;
+        ival = val.GetIndex() ? 1 : 0;
     }
     else if (val.IsInteger())
     {
-        ival = val.val.integer;
+        ival = val.GetInteger();
     }
     else
     {
@@ -130,7 +130,7 @@ void Socket::Connect(Value& addr)
     Pika_address* sockaddr = 0;
     if (addr.IsDerivedFrom(SocketAddress::StaticGetClass()))
     {
-        sockaddr = static_cast<SocketAddress*>(addr.val.object)->GetAddress(); 
+        sockaddr = static_cast<SocketAddress*>(addr.GetObject())->GetAddress(); 
     }
     else
     {
@@ -148,7 +148,7 @@ void Socket::Bind(Value& addr)
     Pika_address* sockaddr = 0;
     if (addr.IsDerivedFrom(SocketAddress::StaticGetClass()))
     {
-        sockaddr = static_cast<SocketAddress*>(addr.val.object)->GetAddress(); 
+        sockaddr = static_cast<SocketAddress*>(addr.GetObject())->GetAddress(); 
     }
     else
     {
@@ -214,7 +214,7 @@ void Socket::SendTo(String* buff, Value& addr)
     
     if (addr.IsDerivedFrom(SocketAddress::StaticGetClass()))
     {
-        sockaddr = static_cast<SocketAddress*>(addr.val.object)->GetAddress(); 
+        sockaddr = static_cast<SocketAddress*>(addr.GetObject())->GetAddress(); 
     }
     else
     {
@@ -329,7 +329,7 @@ using namespace pika;
 
 int Socket_accept(Context* ctx, Value& self)
 {
-    Socket* socket = static_cast<Socket*>(self.val.object);
+    Socket* socket = static_cast<Socket*>(self.GetObject());
     Socket* retSock = 0;
     SocketAddress* retAddr = 0;
     if (socket->Accept(&retSock, &retAddr)) {
@@ -344,7 +344,7 @@ int Socket_accept(Context* ctx, Value& self)
 
 int Socket_recvfrom(Context* ctx, Value& self)
 {
-    Socket* socket = static_cast<Socket*>(self.val.object);
+    Socket* socket = static_cast<Socket*>(self.GetObject());
     SocketAddress* retAddr = 0;
     pint_t len = ctx->GetIntArg(0);
     String* res = socket->RecvFrom(len, &retAddr); 
@@ -291,7 +291,7 @@ namespace pika {
         
         if (files.Get(key, val))
         {
-            this->currentFile = (ZipReaderFile*)val.val.object;
+            this->currentFile = (ZipReaderFile*)val.GetObject();
         }
         else
         {
@@ -334,7 +334,7 @@ namespace pika {
         
     int ZipReader_findFile(Context* ctx, Value& self)
     {
-        ZipReader* z = static_cast<ZipReader*>(self.val.object);
+        ZipReader* z = static_cast<ZipReader*>(self.GetObject());
         u2 argc = ctx->GetArgCount();
         String* name = 0;
         bool cs = false;
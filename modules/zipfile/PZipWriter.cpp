@@ -12,7 +12,7 @@ namespace pika {
     {
         Value res(NULL_VALUE);
         if (obj->GetAttr(ctx, attr, res) && res.IsInteger()) {
-            return res.val.integer;
+            return res.GetInteger();
         } else if (fail) {
             RaiseException("Attempt to read attribute %s failed.", attr);
         }
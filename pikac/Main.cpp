@@ -24,6 +24,8 @@
  *
  */
 #include "Pika.h"
+#include "PProfiler.h"
+#include "PHeapSnapshot.h"
 using namespace pika;
 
 void Pika_DisplayUsage(const char* name)
@@ -34,6 +36,9 @@ void Pika_DisplayUsage(const char* name)
     std::cerr << "\t--arg,  -a    : White space seperated arguments i.e. \"arg1 arg2 arg3\"\n";
     std::cerr << "\t--file, -f    : File to execute.\n";
     std::cerr << "\t--path, -p    : Add a search path. Multiple paths may be specified.\n";
+    std::cerr << "\t-O<level>     : Optimization level of the compiler, from 0 (none) to 3. The default is 3.\n";
+    std::cerr << "\t--profile=out : Sample the script and write its call stacks to out in the folded format.\n";
+    std::cerr << "\t--heap-report=snapshot : Print a report of a snapshot written by gc.dumpHeap and exit.\n";
     std::cerr << "\t--supress, -s : Supress startup banner.\n";
     std::cerr << "\t--version, -v : White space seperated arguments i.e. \"arg1 arg2 arg3\"\n";
     std::cerr << std::endl;
@@ -91,6 +96,34 @@ struct CommandLine
                     {
                         kind = 'v';                        
                     } 
+                    else if (strncmp(curr+2, "profile", 7) == 0)
+                    {
+                        kind = 'P';
+                        if (curr[9] == '=') // --profile=out.folded
+                        {
+                            options = curr[10] ? curr + 10 : 0;
+                            pos++;
+                            return;
+                        }
+                        else if (curr[9] != '\0')
+                        {
+                            kind = '-';
+                        }
+                    }
+                    else if (strncmp(curr+2, "heap-report", 11) == 0)
+                    {
+                        kind = 'H';
+                        if (curr[13] == '=') // --heap-report=out.heap
+                        {
+                            options = curr[14] ? curr + 14 : 0;
+                            pos++;
+                            return;
+                        }
+                        else if (curr[13] != '\0')
+                        {
+                            kind = '-';
+                        }
+                    }
                     
                     if (kind != '-' && kind != 'v') // Should be a space between the kind and option
                     {
@@ -216,12 +249,18 @@ int main(int argc, char* argv[])
         Array* arguments = 0;
         Engine* eng = 0;
         const char* fileName = 0;
+        const char* profileName = 0;
+        const char* heapReport = 0;
         try
         {
             eng = Engine::Create();
             {
                 GCPAUSE_NORUN( eng );
                 arguments = Array::Create(eng, eng->Array_Type, 0, 0);
+                
+                // The options below allocate, so the arguments must be rooted before any of
+                // them are handled.
+                eng->AddToRoots(arguments);
             }
             
             CommandLine cl(argc, argv);
@@ -271,6 +310,21 @@ int main(int argc, char* argv[])
                     AddArgument(eng, cl.Opt(), arguments);
                 }
                 break;
+                /*
+                 * Optimization Level: -O0 through -O3 (PIKA_MAX_OPTIMIZE_LEVEL)
+                 * -------------------------------------------------------------
+                 * Selects the passes the compiler runs over each function.
+                 */
+                case 'O':
+                {
+                    const char* level = cl.Opt();
+                    if (level[0] < '0' || level[0] > '0' + PIKA_MAX_OPTIMIZE_LEVEL || level[1] != '\0')
+                    {
+                        Pika_DisplayUsage(argv[0]);
+                    }
+                    eng->SetOptimizeLevel(level[0] - '0');
+                    break;
+                }
                 /*
                  * Script File: -fFileToExecute
                  */
@@ -279,6 +333,36 @@ int main(int argc, char* argv[])
                     fileName = cl.Opt();
                     break;
                 }
+                /*
+                 * Profile Output: --profile=FileToWrite
+                 * -------------------------------------------------------------
+                 * Samples the script while it runs and writes the call stacks
+                 * in the folded format used by flamegraph tools.
+                 */
+                case 'P':
+                {
+                    if ((cl.Opt() == 0))
+                    {
+                        Pika_DisplayUsage(argv[0]);
+                    }
+                    profileName = cl.Opt();
+                    break;
+                }
+                /*
+                 * Heap Report: --heap-report=Snapshot
+                 * -------------------------------------------------------------
+                 * Prints the types and largest retainers in a snapshot written
+                 * by gc.dumpHeap instead of running a script.
+                 */
+                case 'H':
+                {
+                    if ((cl.Opt() == 0))
+                    {
+                        Pika_DisplayUsage(argv[0]);
+                    }
+                    heapReport = cl.Opt();
+                    break;
+                }
                 /*
                  * Suppress Banner: -s
                  */
@@ -314,19 +398,19 @@ int main(int argc, char* argv[])
                 cl.Next();
             }
             
-            if (!fileName) 
+            if (heapReport)
+            {
+                if (!HeapSnapshot::Report(heapReport, stdout))
+                {
+                    std::cerr << "\n** Could not read heap snapshot: " << heapReport << std::endl;
+                }
+            }
+            else if (!fileName) 
             {
                 ReadExecutePrintLoop(eng);
             }
             else
             {
-                // Depending on the size of the script, arguments might be collected
-                // before Compile returns.
-                //
-                // So we add them to the roots to prevent collection.
-                
-                eng->AddToRoots(arguments);
-                
                 // Add paths defined in $PIKA_PATH to our PathManager.
                 eng->AddEnvPath("PIKA_PATH");
                 
@@ -335,7 +419,24 @@ int main(int argc, char* argv[])
                 
                 if (script)
                 {
+                    Profiler* profiler = profileName ? eng->GetProfiler() : 0;
+                    
+                    if (profiler && !profiler->Start())
+                    {
+                        std::cerr << "\n** Could not start the profiler." << std::endl;
+                        profiler = 0;
+                    }
+                    
                     script->Run(arguments);
+                    
+                    if (profiler)
+                    {
+                        profiler->Stop();
+                        if (!profiler->WriteFolded(profileName))
+                        {
+                            std::cerr << "\n** Could not write profile: " << profileName << std::endl;
+                        }
+                    }
                 }
                 else
                 {
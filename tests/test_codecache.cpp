@@ -0,0 +1,181 @@
+/*
+ *  test_codecache.cpp
+ *  See Copyright Notice in Pika.h
+ *
+ *  Tests that a compiled script is used while its source is unchanged and ignored otherwise. Each
+ *  test writes a script that sets the global 'result', runs it in a new Engine, then changes the
+ *  script or its compiled version and checks whether the compiled version is still used and that
+ *  the script's current code runs.
+ *
+ *  Files are written to the working directory.
+ */
+#include "Pika.h"
+#include "PCodeCache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#if defined(PIKA_WIN)
+#   include <sys/utime.h>
+#else
+#   include <utime.h>
+#endif
+
+using namespace pika;
+
+namespace {
+
+const char* SCRIPT_PATH   = "codecache_script" PIKA_EXT;
+const char* COMPILED_PATH = "codecache_script" PIKA_COMPILED_EXT;
+const int   OPT_LEVEL     = 1;
+
+int numPassed = 0;
+int numFailed = 0;
+
+void Check(bool passed, const char* what)
+{
+    printf("%s %s\n", passed ? "PASS" : "FAIL", what);
+    if (passed)
+        ++numPassed;
+    else
+        ++numFailed;
+}
+
+bool WriteFile(const char* path, const char* contents, size_t len)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+    bool ok = fwrite(contents, 1, len, file) == len;
+    return fclose(file) == 0 && ok;
+}
+
+bool ReadFile(const char* path, Buffer<char>& contents)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return false;
+    char   buff[4096];
+    size_t len;
+    contents.Clear();
+    while ((len = fread(buff, 1, sizeof(buff), file)) > 0)
+    {
+        for (size_t i = 0; i < len; ++i)
+            contents.Push(buff[i]);
+    }
+    fclose(file);
+    return true;
+}
+
+/* Writes a script that sets result to the given value. The modification time is set to mtime so
+ * that only the changes a test makes on purpose are seen. */
+void WriteScript(const char* source, time_t mtime)
+{
+    WriteFile(SCRIPT_PATH, source, strlen(source));
+
+    struct utimbuf times;
+    times.actime  = mtime;
+    times.modtime = mtime;
+    utime(SCRIPT_PATH, &times);
+}
+
+/* Returns true if the compiled script is valid for the script's source and the level. */
+bool IsCached(int level)
+{
+    Buffer<char> source;
+    if (!ReadFile(SCRIPT_PATH, source))
+        return false;
+
+    Engine* eng = Engine::Create();
+    eng->SetOptimizeLevel(level);
+
+    bool cached = false;
+    {
+        GCPAUSE_NORUN(eng);
+        CodeCache    cache(eng, eng->AllocString(SCRIPT_PATH), source.GetAt(0), source.GetSize());
+        LiteralPool* literals = 0;
+        cached = cache.Read(literals) != 0;
+    }
+    eng->Release();
+    return cached;
+}
+
+/* Imports the script in a new Engine and returns the value of result, or -1 if it fails. */
+pint_t RunScript(int level)
+{
+    Engine* eng = Engine::Create();
+    eng->SetOptimizeLevel(level);
+
+    pint_t result = -1;
+    try
+    {
+        Script* script = eng->Compile(SCRIPT_PATH);
+        Value   res(NULL_VALUE);
+        if (script && script->Run(0) && script->GetGlobal(eng->AllocString("result"), res) && res.IsInteger())
+            result = res.GetInteger();
+    }
+    catch (Exception&)
+    {
+    }
+    eng->Release();
+    return result;
+}
+
+time_t GetModifiedTime(const char* path)
+{
+    struct stat ino;
+    return stat(path, &ino) == 0 ? ino.st_mtime : 0;
+}
+
+}// namespace
+
+int main()
+{
+    // Old enough that writing the script again always changes its time.
+    time_t mtime = GetModifiedTime(".") - 1000;
+
+    remove(COMPILED_PATH);
+    WriteScript("global result = 1", mtime);
+    Check(RunScript(OPT_LEVEL) == 1,  "the script runs from source");
+    Check(IsCached(OPT_LEVEL),        "running the script writes a valid compiled script");
+    Check(RunScript(OPT_LEVEL) == 1,  "the script runs from the compiled script");
+
+    WriteScript("global result = 2", mtime);
+    Check(!IsCached(OPT_LEVEL),       "changing the source without changing its size or time is detected");
+    Check(RunScript(OPT_LEVEL) == 2,  "the changed script runs");
+    Check(IsCached(OPT_LEVEL),        "the compiled script is rewritten");
+
+    WriteScript("global result = 33", mtime);
+    Check(!IsCached(OPT_LEVEL),       "changing the size of the source is detected");
+    Check(RunScript(OPT_LEVEL) == 33, "the longer script runs");
+
+    WriteScript("global result = 33", mtime + 10);
+    Check(!IsCached(OPT_LEVEL),       "changing the time of the source is detected");
+    Check(RunScript(OPT_LEVEL) == 33, "the touched script runs");
+    Check(IsCached(OPT_LEVEL),        "the compiled script is rewritten for the new time");
+
+    Check(!IsCached(OPT_LEVEL + 1),   "a different optimization level is detected");
+    Check(RunScript(OPT_LEVEL + 1) == 33, "the script runs at a different optimization level");
+    Check(IsCached(OPT_LEVEL + 1),    "the compiled script is rewritten for the new level");
+
+    Buffer<char> compiled;
+    ReadFile(COMPILED_PATH, compiled);
+    compiled[compiled.GetSize() - 1] ^= 0x5A;
+    WriteFile(COMPILED_PATH, compiled.GetAt(0), compiled.GetSize());
+    Check(!IsCached(OPT_LEVEL + 1),   "a corrupt payload is detected");
+    Check(RunScript(OPT_LEVEL + 1) == 33, "the script runs when the payload is corrupt");
+
+    WriteFile(COMPILED_PATH, compiled.GetAt(0), compiled.GetSize() / 2);
+    Check(!IsCached(OPT_LEVEL + 1),   "a truncated compiled script is detected");
+    Check(RunScript(OPT_LEVEL + 1) == 33, "the script runs when the compiled script is truncated");
+
+    remove(COMPILED_PATH);
+    remove(SCRIPT_PATH);
+
+    if (numFailed)
+        printf("%d Tests Failed.\n", numFailed);
+    else
+        printf("%d/%d Tests Passed.\n", numPassed, numPassed);
+    return numFailed ? 1 : 0;
+}